@@ -0,0 +1,108 @@
+// AllocationTracker.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Subsystems heap allocations are attributed to.
+ */
+enum class AllocationSubsystem : uint8_t {
+    Other,
+    Logger,
+    Mirror,
+    Voicemeeter,
+    Windows,
+    Sound,
+    Config,
+    Devices,
+    Cache,
+    Count
+};
+
+/**
+ * @brief Counts heap allocations per thread and per subsystem.
+ *
+ * In builds configured with VOICEMIRROR_TRACK_ALLOCATIONS the global
+ * operator new is replaced and every allocation is counted against the
+ * calling thread and the subsystem of the innermost AllocationScope on that
+ * thread. In other builds all counters stay at zero and scopes compile away.
+ */
+class AllocationTracker {
+public:
+    struct Counters {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;      ///< Total bytes ever allocated.
+        int64_t liveBytes = 0;   ///< Bytes currently allocated and not yet freed.
+    };
+
+    static constexpr bool IsEnabled() {
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Allocations made so far by the calling thread.
+     */
+    static uint64_t ThreadAllocations();
+
+    /**
+     * @brief Process-wide totals for one subsystem.
+     */
+    static Counters SubsystemCounters(AllocationSubsystem subsystem);
+
+    static const char* SubsystemName(AllocationSubsystem subsystem);
+
+    /**
+     * @brief Live bytes summed over all subsystems.
+     */
+    static int64_t TotalLiveBytes();
+
+    /**
+     * @brief Logs per-subsystem totals. Does nothing in untracked builds.
+     */
+    static void Report();
+
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    // Used by the operator new/delete replacements.
+    static void* Allocate(size_t bytes) noexcept;
+    static void Free(void* memory) noexcept;
+    // Used by the std::align_val_t overloads; alignment is a power of two.
+    static void* AllocateAligned(size_t bytes, size_t alignment) noexcept;
+    static void FreeAligned(void* memory) noexcept;
+#endif
+
+private:
+    friend class AllocationScope;
+
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    static AllocationSubsystem& CurrentSubsystem();
+#endif
+};
+
+/**
+ * @brief Attributes allocations on this thread to a subsystem until destroyed.
+ */
+class AllocationScope {
+public:
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    explicit AllocationScope(AllocationSubsystem subsystem)
+        : previous_(AllocationTracker::CurrentSubsystem()) {
+        AllocationTracker::CurrentSubsystem() = subsystem;
+    }
+    ~AllocationScope() { AllocationTracker::CurrentSubsystem() = previous_; }
+#else
+    explicit AllocationScope(AllocationSubsystem) {}
+#endif
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+private:
+    AllocationSubsystem previous_;
+#endif
+};
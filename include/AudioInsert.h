@@ -0,0 +1,214 @@
+// AudioInsert.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Defconf.h"
+#include "InlineFunction.h"
+#include "Metrics.h"
+
+struct tagVBVMR_AUDIOBUFFER;
+
+/**
+ * @brief One buffer of the bus channels, as seen by an AudioProcessor.
+ *
+ * Buses are AUDIO_CHANNELS_PER_BUS consecutive channels each. Outputs hold
+ * what Voicemeeter sends to the buses and may be modified in place.
+ */
+struct AudioBlock {
+    uint32_t sampleRate = 0;
+    uint32_t frames = 0;
+    uint32_t inputCount = 0;   ///< Strip channels, read-only
+    uint32_t outputCount = 0;  ///< Bus channels
+    const float* const* inputs = nullptr;
+    float* const* outputs = nullptr;
+};
+
+/**
+ * @brief Work done on Voicemeeter's audio thread.
+ *
+ * Process() runs under the audio deadline: no locks, waits, system calls or
+ * allocation. Everything it needs is allocated up front, for
+ * AUDIO_MAX_BUS_CHANNELS channels and AUDIO_MAX_FRAMES frames.
+ */
+class AudioProcessor {
+public:
+    virtual ~AudioProcessor() = default;
+
+    /**
+     * @brief Called on the audio thread before the first buffer of a stream.
+     */
+    virtual void Prepare(uint32_t sampleRate, uint32_t frames) = 0;
+    virtual void Process(const AudioBlock& block) = 0;
+};
+
+/**
+ * @brief Voicemeeter MAIN audio callback running a chain of AudioProcessors.
+ *
+ * The MAIN stream carries every strip input and every bus output. Buses are
+ * passed through unchanged unless a processor modifies them, so attaching
+ * the insert alone never alters the mix. Denormals are flushed to zero
+ * while processors run, and the caller's floating-point mode restored.
+ *
+ * Every buffer is timed against its period (frames / sample rate): the
+ * time spent in the callback and how far the gap since the previous buffer
+ * strays from the period go into histograms as fractions of the period,
+ * and buffers over AUDIO_BUDGET_FRACTION of it or over the whole period
+ * (a deadline miss) are counted. All of it is exported with lock-free
+ * metric updates. After AUDIO_BYPASS_AFTER_BUFFERS buffers over budget in
+ * a row, or any deadline miss, optional processors are skipped for
+ * AUDIO_BYPASS_HOLD_MS and then tried again.
+ *
+ * Processors are added before VoicemeeterManager::StartAudioInsert() and
+ * must outlive VoicemeeterManager::StopAudioInsert().
+ */
+class AudioInsert {
+public:
+    struct Stats {
+        uint64_t buffers = 0;
+        uint64_t restarts = 0;    ///< Streams started
+        uint32_t sampleRate = 0;  ///< Of the current stream; 0 while stopped
+        uint32_t frames = 0;
+        uint64_t overBudget = 0;       ///< Buffers over AUDIO_BUDGET_FRACTION of the period
+        uint64_t deadlineMisses = 0;   ///< Buffers over the whole period
+        uint64_t bypasses = 0;         ///< Times optional processors were bypassed
+        bool bypassed = false;         ///< Optional processors are bypassed right now
+        double maxProcessing = 0.0;    ///< Longest callback, as a fraction of the period
+        double maxJitter = 0.0;        ///< Largest gap error between buffers, as a fraction of the period
+    };
+
+    AudioInsert();
+
+    AudioInsert(const AudioInsert&) = delete;
+    AudioInsert& operator=(const AudioInsert&) = delete;
+
+    /**
+     * @brief Adds a processor, run after the ones added before it.
+     * @param optional Skipped while the callback is over budget; for work
+     *        that can miss buffers, like metering.
+     * @return false once AUDIO_MAX_PROCESSORS are attached.
+     */
+    bool AddProcessor(AudioProcessor& processor, bool optional = false);
+
+    size_t ProcessorCount() const { return processorCount_; }
+
+    /**
+     * @brief Called on the audio thread when Voicemeeter reports a stream
+     *        change; the stream must be stopped and started again. Must not block.
+     */
+    InlineFunction<void()> onStreamChange;
+
+#ifdef _WIN32
+    /**
+     * @brief Callback registered with VBVMR_AudioCallbackRegister, with the insert as user data.
+     */
+    static long __stdcall Callback(void* user, long command, void* data, long synchro);
+#endif
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Drives the insert in real time with an optional processor that
+     *        turns slow on demand, and checks that the monitor counts the
+     *        overruns, bypasses the processor, keeps the others running and
+     *        brings it back.
+     * @param seconds Length of the steady phase the jitter is measured on.
+     */
+    static bool Benchmark(uint32_t seconds);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Start(uint32_t sampleRate, uint32_t frames);
+    void ProcessMain(const tagVBVMR_AUDIOBUFFER& buffer);
+    void Monitor(Clock::time_point start, Clock::time_point end, uint32_t sampleRate, uint32_t frames);
+
+    AudioProcessor* processors_[AUDIO_MAX_PROCESSORS] = {};
+    bool optional_[AUDIO_MAX_PROCESSORS] = {};
+    size_t processorCount_ = 0;
+    size_t optionalCount_ = 0;
+    Clock::duration bypassHold_ = std::chrono::milliseconds(AUDIO_BYPASS_HOLD_MS);
+
+    // Audio thread only
+    bool prepared_ = false;
+    Clock::time_point lastStart_;  ///< Of the previous buffer; default until the first of a stream
+    Clock::time_point bypassUntil_;
+    bool bypassing_ = false;
+    uint32_t overBudgetRun_ = 0;
+
+    std::atomic<uint64_t> buffers_{0};
+    std::atomic<uint64_t> restarts_{0};
+    std::atomic<uint32_t> sampleRate_{0};
+    std::atomic<uint32_t> frames_{0};
+    std::atomic<uint64_t> overBudget_{0};
+    std::atomic<uint64_t> deadlineMisses_{0};
+    std::atomic<uint64_t> bypasses_{0};
+    std::atomic<bool> bypassed_{false};
+    std::atomic<double> maxProcessing_{0.0};
+    std::atomic<double> maxJitter_{0.0};
+
+    Histogram* processingHistogram_ = nullptr;
+    Histogram* jitterHistogram_ = nullptr;
+    Metric* overBudgetCounter_ = nullptr;
+    Metric* deadlineMissCounter_ = nullptr;
+    Metric* bypassCounter_ = nullptr;
+    Metric* bypassedGauge_ = nullptr;
+};
+
+/**
+ * @brief Stands in for Voicemeeter's audio thread in benchmarks.
+ *
+ * Lays out MAIN stream buffers the way the given edition does and drives
+ * AudioInsert::Callback with the same commands Voicemeeter sends. Bus
+ * channels are filled through Bus() before each RunBuffer(); what the
+ * processors leave in them is read back with Output().
+ */
+class SyntheticAudioDriver {
+public:
+    SyntheticAudioDriver(AudioInsert& insert, long voicemeeterType,
+                         uint32_t sampleRate = AUDIO_BENCH_SAMPLE_RATE, uint32_t frames = AUDIO_BENCH_FRAMES);
+    ~SyntheticAudioDriver();
+
+    SyntheticAudioDriver(const SyntheticAudioDriver&) = delete;
+    SyntheticAudioDriver& operator=(const SyntheticAudioDriver&) = delete;
+
+    void Start();
+
+    /**
+     * @brief Runs one buffer through the callback.
+     * @return Time spent in the callback, in microseconds.
+     */
+    double RunBuffer();
+
+    void Stop();
+
+    uint32_t SampleRate() const { return sampleRate_; }
+    uint32_t Frames() const { return frames_; }
+    uint32_t InputChannels() const { return inputs_; }
+    uint32_t BusChannels() const { return buses_; }
+
+    /**
+     * @brief Strip and bus channels the next buffer reads.
+     */
+    float* Input(size_t channel) { return &read_[channel * frames_]; }
+    float* Bus(size_t channel) { return &read_[(inputs_ + channel) * frames_]; }
+
+    /**
+     * @brief Bus channel as the last buffer left it.
+     */
+    const float* Output(size_t channel) const { return &write_[channel * frames_]; }
+
+private:
+    AudioInsert& insert_;
+    uint32_t sampleRate_;
+    uint32_t frames_;
+    uint32_t inputs_ = 0;
+    uint32_t buses_ = 0;
+    std::vector<float> read_;
+    std::vector<float> write_;
+    std::unique_ptr<tagVBVMR_AUDIOBUFFER> buffer_;
+};
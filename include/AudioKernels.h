@@ -0,0 +1,104 @@
+// AudioKernels.h
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Instruction sets the kernels are built for, lowest first.
+ */
+enum class SimdLevel : uint8_t {
+    Scalar,
+    Sse2,
+    Avx2,
+    Avx512
+};
+
+/**
+ * @brief One implementation of every kernel.
+ *
+ * Integer conversions scale by 32768 and saturate; float to int16 rounds to
+ * nearest even. Peak, conversions and gains give the same bits on every
+ * level; sums of squares and dot products are accumulated in double and
+ * differ only in the order of additions.
+ */
+struct KernelTable {
+    float (*peakAbs)(const float* in, size_t count);
+    double (*sumSquares)(const float* in, size_t count);
+    double (*dotProduct)(const float* a, const float* b, size_t count);
+    /// out[i] = in[i] * (start + step * i); in and out may be the same buffer.
+    void (*gainRamp)(const float* in, float* out, size_t count, float start, float step);
+    /// out[i] += in[i] * gain
+    void (*mixAdd)(const float* in, float* out, size_t count, float gain);
+    void (*floatToInt16)(const float* in, int16_t* out, size_t count);
+    void (*int16ToFloat)(const int16_t* in, float* out, size_t count);
+};
+
+/**
+ * @brief Vector kernels for audio buffers, picked for the CPU at run time.
+ *
+ * The program itself is built for plain x64 (SSE2). AVX2 and AVX-512
+ * versions live in translation units of their own, the only ones compiled
+ * with those instruction sets, and are reached only through KernelTable
+ * pointers after cpuid and xgetbv confirm that the CPU and the OS support
+ * them. Those files use intrinsics only, no inline functions from headers,
+ * so the linker can never pick a VEX-encoded copy of a shared inline
+ * function for the rest of the program.
+ *
+ * The level is detected on first use; call Level() once at startup so the
+ * audio thread never runs the detection.
+ */
+namespace AudioKernels {
+
+/**
+ * @brief Kernels for the best level this CPU supports.
+ */
+const KernelTable& Get();
+
+SimdLevel Level();
+const char* LevelName(SimdLevel level);
+
+/**
+ * @brief Kernels of one level.
+ * @return nullptr if the CPU or the OS does not support the level.
+ */
+const KernelTable* Table(SimdLevel level);
+
+inline float PeakAbs(const float* in, size_t count) {
+    return Get().peakAbs(in, count);
+}
+
+inline double SumSquares(const float* in, size_t count) {
+    return Get().sumSquares(in, count);
+}
+
+inline float Rms(const float* in, size_t count) {
+    return count == 0 ? 0.0f : static_cast<float>(std::sqrt(Get().sumSquares(in, count) / count));
+}
+
+inline double DotProduct(const float* a, const float* b, size_t count) {
+    return Get().dotProduct(a, b, count);
+}
+
+inline void GainRamp(const float* in, float* out, size_t count, float start, float step) {
+    Get().gainRamp(in, out, count, start, step);
+}
+
+inline void MixAdd(const float* in, float* out, size_t count, float gain) {
+    Get().mixAdd(in, out, count, gain);
+}
+
+inline void FloatToInt16(const float* in, int16_t* out, size_t count) {
+    Get().floatToInt16(in, out, count);
+}
+
+inline void Int16ToFloat(const int16_t* in, float* out, size_t count) {
+    Get().int16ToFloat(in, out, count);
+}
+
+// Defined in AudioKernelsAvx2.cpp and AudioKernelsAvx512.cpp; use Table() instead.
+const KernelTable& Avx2Kernels();
+const KernelTable& Avx512Kernels();
+
+}  // namespace AudioKernels
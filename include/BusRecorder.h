@@ -0,0 +1,141 @@
+// BusRecorder.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioInsert.h"
+#include "Defconf.h"
+#include "Metrics.h"
+#include "ProfiledMutex.h"
+#include "SpscRing.h"
+
+/**
+ * @brief Bus channels a BusRecorder captures.
+ */
+struct RecordTarget {
+    uint8_t bus = 0;
+    uint8_t firstChannel = 0;
+    uint8_t channelCount = static_cast<uint8_t>(RECORD_MAX_CHANNELS);
+};
+
+class WavFileWriter;
+
+/**
+ * @brief Records what leaves a bus into 32-bit float WAV files.
+ *
+ * The audio thread copies the selected channels, interleaved, into a
+ * lock-free ring allocated up front; it never allocates, locks or makes a
+ * system call. When the ring is too full for a whole buffer, the buffer is
+ * dropped and counted as an overrun, so the file only ever has gaps, never
+ * torn frames.
+ *
+ * A writer thread drains the ring every RECORD_WRITE_INTERVAL_MS and writes
+ * RECORD_WRITE_BLOCK_BYTES blocks, unbuffered, at sector-aligned offsets;
+ * the header is padded to a sector so the samples start aligned. Files
+ * that grow past 4 GiB are closed as RF64. Every audio stream start opens
+ * a new file named after the bus and the local time.
+ */
+class BusRecorder : public AudioProcessor {
+public:
+    struct Stats {
+        uint64_t frames = 0;         ///< Frames put in the ring
+        uint64_t overruns = 0;       ///< Buffers dropped because the ring was full
+        uint64_t droppedFrames = 0;
+        uint64_t bytesWritten = 0;   ///< Sample bytes written to files
+        uint64_t files = 0;
+        uint64_t writeErrors = 0;
+        size_t ringPeakFrames = 0;   ///< Highest ring fill seen by the audio thread
+        double maxWriteMs = 0.0;     ///< Slowest block write
+    };
+
+    BusRecorder();
+    ~BusRecorder() override;
+
+    BusRecorder(const BusRecorder&) = delete;
+    BusRecorder& operator=(const BusRecorder&) = delete;
+
+    /**
+     * @brief Parses "<bus>" or "<bus>:<first>-<last>" with channels 0-7 of the bus.
+     */
+    static bool ParseTarget(const std::string& text, RecordTarget& target);
+
+    /**
+     * @brief Allocates the ring and starts the writer thread. Call before the audio insert starts.
+     * @param directory Where files are created; empty for the working directory.
+     */
+    bool Start(const RecordTarget& target, const std::string& directory);
+
+    /**
+     * @brief Writes what is left in the ring and closes the file. Call after the audio insert stopped.
+     */
+    void Stop();
+
+    void Prepare(uint32_t sampleRate, uint32_t frames) override;
+    void Process(const AudioBlock& block) override;
+
+    /**
+     * @brief Paths of the files written so far, the open one last.
+     */
+    std::vector<std::string> Files() const;
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Drives the recorder from a synthetic real-time callback at
+     *        8 channels and 48 kHz, then stalls the writer to force
+     *        overruns, and checks every frame of the file against what
+     *        went in.
+     * @param seconds Length of the real-time phase.
+     */
+    static bool Benchmark(uint32_t seconds);
+
+private:
+    void WriterProc();
+    size_t Drain(size_t limit);
+    bool WriteBlock();
+    void OpenFile(uint32_t sampleRate);
+    void CloseFile();
+    void PublishMetrics();
+
+    RecordTarget target_;
+    std::string directory_;
+    size_t channels_ = 0;
+
+    std::unique_ptr<SpscRing<float>> ring_;
+
+    // Audio thread state, and the stream the writer should be writing
+    std::atomic<uint32_t> generation_{0};
+    std::atomic<uint32_t> streamRate_{0};
+    std::atomic<size_t> streamStart_{0};  ///< Ring position where the stream begins
+
+    // Writer thread state
+    std::unique_ptr<WavFileWriter> file_;
+    std::vector<uint8_t> blockStorage_;
+    uint8_t* block_ = nullptr;  ///< Sector-aligned view into blockStorage_
+    size_t blockFill_ = 0;
+    uint64_t fileBytes_ = 0;  ///< Sample bytes in the open file
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stallWriter_{false};  ///< Benchmark only: writer stops draining
+
+    mutable ProfiledMutex filesMutex_{"BusRecorder::filesMutex_"};
+    std::vector<std::string> files_;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<uint64_t> fileCount_{0};
+    std::atomic<uint64_t> writeErrors_{0};
+    std::atomic<size_t> ringPeak_{0};
+    std::atomic<double> maxWriteMs_{0.0};
+
+    Metric* frameCounter_ = nullptr;
+    Metric* overrunCounter_ = nullptr;
+    Metric* bytesCounter_ = nullptr;
+};
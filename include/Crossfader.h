@@ -0,0 +1,120 @@
+// Crossfader.h
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "InlineFunction.h"
+#include "ProfiledMutex.h"
+#include "RAIIHandle.h"
+#include "Scene.h"
+
+/**
+ * @brief Timed crossfade from one mixer scene to another.
+ *
+ * A frame thread runs at CROSSFADE_FRAME_INTERVAL_MS. Each frame moves
+ * every strip and bus gain linearly from its start value toward the target.
+ * Mute, routing and label changes switch once, at the midpoint. The
+ * parameters that changed since the previous frame are handed to the sink
+ * as one script, so a frame costs one VBVMR_SetParameters call.
+ *
+ * A new FadeTo() pre-empts a running crossfade and starts from the values
+ * the engine last wrote, so the mixer never jumps back to an old start point.
+ */
+class Crossfader {
+public:
+    // Receives one VBVMR_SetParameters script per frame, on the frame thread.
+    using ScriptSink = InlineFunction<void(const std::string&)>;
+
+    /**
+     * @brief Frame counters and timing. Jitter is how late a frame woke up.
+     */
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t fades = 0;
+        uint64_t preempted = 0;
+        uint64_t missedFrames = 0;   ///< Frames skipped because the thread woke up more than a frame late.
+        double meanJitterMs = 0.0;
+        double maxJitterMs = 0.0;
+    };
+
+    explicit Crossfader(ScriptSink sink);
+    ~Crossfader();
+
+    Crossfader(const Crossfader&) = delete;
+    Crossfader& operator=(const Crossfader&) = delete;
+
+    /**
+     * @brief Starts the frame thread.
+     */
+    bool Start();
+
+    /**
+     * @brief Stops the frame thread; a running crossfade stops where it is.
+     */
+    void Stop();
+
+    /**
+     * @brief Starts a crossfade, pre-empting any running one.
+     *
+     * @param current Mixer state to fade from. Ignored while a crossfade is
+     *                running; that one hands over from the values it last wrote.
+     * @param target Scene to arrive at; must share the layout of current.
+     * @param durationMs Fade time; 0 applies the target in the next frame.
+     */
+    void FadeTo(const Scene& current, const Scene& target, uint32_t durationMs);
+
+    /**
+     * @brief Waits until no crossfade is running.
+     * @return false on timeout.
+     */
+    bool WaitIdle(std::chrono::milliseconds timeout);
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Runs a pre-empted crossfade on a full Potato layout against a
+     *        simulated mixer and logs frame jitter.
+     *
+     * @param durationMs Length of each of the two crossfades.
+     * @return true if the simulated mixer ended exactly on the final target.
+     */
+    static bool RunSimulation(uint16_t durationMs);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void ThreadProc();
+    void WaitUntil(Clock::time_point due);
+
+    /**
+     * @brief Builds the script for the frame at @p now and advances the live state.
+     * @return true once the target has been reached.
+     */
+    bool RenderFrame(Clock::time_point now, std::string& script);
+
+    ScriptSink sink_;
+
+    mutable ProfiledMutex mutex_{"Crossfader::mutex_"};
+    std::condition_variable_any wake_;
+    std::condition_variable_any idle_;
+    std::thread thread_;
+    RAIIHandle timer_;
+    bool running_ = false;
+
+    // Current crossfade, guarded by mutex_
+    bool active_ = false;
+    bool switched_ = false;  ///< Mute, routing and labels already moved to the target.
+    Scene from_;
+    Scene target_;
+    Scene live_;             ///< What the sink has been told so far.
+    Clock::time_point fadeStart_;
+    Clock::duration fadeDuration_{};
+    Clock::time_point nextFrame_;
+
+    Stats stats_;
+    double jitterTotalMs_ = 0.0;
+};
@@ -1,9 +1,12 @@
 // Defconf.h
 #pragma once
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <string>
 #include <cstdint>
+#include <vector>
 
 // -----------------------------
 // Mutex and Event Names
@@ -22,16 +25,20 @@ constexpr const char* DEFAULT_DLL_PATH_32 = "C:\\Program Files (x86)\\VB\\Voicem
 constexpr size_t MAX_CALLBACKS = 3; 
 constexpr const char* DEFAULT_CONFIG_FILE = "VoiceMirror.conf";
 constexpr const char* DEFAULT_LOG_FILE = "VoiceMirror.log";
+constexpr const char* DEFAULT_STATE_FILE = "VoiceMirror.state";
+constexpr const char* DEFAULT_HISTORY_FILE = "VoiceMirror.history";
 constexpr const char* DEFAULT_STARTUP_SOUND_FILE = "o95.wav";
 constexpr const wchar_t* DEFAULT_SYNC_SOUND_FILE = L"C:\\Windows\\Media\\Windows Unlock.wav";
 
 // -----------------------------
 // Voicemeeter Settings and Configuration Defaults
 // -----------------------------
+#ifdef _WIN32
 constexpr WORD DEBUG_COLOR = FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
 constexpr WORD INFO_COLOR = FOREGROUND_GREEN | FOREGROUND_INTENSITY;
 constexpr WORD WARNING_COLOR = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
 constexpr WORD ERROR_COLOR = FOREGROUND_RED | FOREGROUND_INTENSITY;
+#endif
 
 constexpr uint8_t DEFAULT_CHANNEL_INDEX = 3;
 constexpr uint8_t DEFAULT_VOICEMEETER_TYPE = 2;
@@ -81,6 +88,345 @@ constexpr bool DEFAULT_VERSION_FLAG = false;
 
 constexpr uint8_t VOICEMEETER_MANAGER_RETRIES = 10;
 
+// -----------------------------
+// Voicemeeter Executor Settings
+// -----------------------------
+
+constexpr uint16_t VOICEMEETER_COMMAND_DEADLINE_MS = 250;
+constexpr uint16_t VOICEMEETER_INIT_DEADLINE_MS = 30000;
+constexpr uint16_t VOICEMEETER_WATCHDOG_INTERVAL_MS = 100;
+constexpr size_t VOICEMEETER_EXECUTOR_BATCH_SIZE = 64;
+constexpr size_t VOICEMEETER_EXECUTOR_POOL_SIZE = 32;
+// Stop() waits this long for a command stuck in the DLL, then leaves the thread behind
+constexpr uint16_t VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS = 2000;
+constexpr uint32_t EXECUTOR_BENCH_MAX_COMMANDS = 100000;
+constexpr uint32_t DEFAULT_EXECUTOR_BENCH_COMMANDS = 0;  // 0 runs normally
+
+// -----------------------------
+// Mirror Benchmark Settings
+// -----------------------------
+
+// Slider changes --lock-bench drives while fader moves and resyncs run alongside
+constexpr uint32_t LOCK_BENCH_MAX_EVENTS = 1000000;
+constexpr uint32_t DEFAULT_LOCK_BENCH_EVENTS = 0;  // 0 runs normally
+// A longer controlMutex hold means I/O crept under the lock
+constexpr uint32_t LOCK_BENCH_MAX_HOLD_US = 5000;
+// Slider changes --alloc-bench mirrors; every eighth event is a fader move instead
+constexpr uint32_t ALLOC_BENCH_MAX_EVENTS = 1000000;
+constexpr uint32_t DEFAULT_ALLOC_BENCH_EVENTS = 0;  // 0 runs normally
+
+// -----------------------------
+// Steady-State Buffers
+// -----------------------------
+
+// Stack buffers used on the sync path instead of std::string
+constexpr size_t LOG_MESSAGE_LENGTH = 256;
+constexpr size_t DEVICE_ID_LENGTH = 128;
+
+// Sync events allowed to allocate before the allocation check kicks in
+constexpr uint32_t ALLOCATION_WARMUP_EVENTS = 16;
+
+// -----------------------------
+// Metrics and Footprint Settings
+// -----------------------------
+
+constexpr size_t METRICS_MAX_COUNT = 128;
+constexpr size_t METRICS_MAX_COLLECTORS = 16;
+constexpr size_t METRICS_MAX_HISTOGRAMS = 16;
+constexpr size_t METRICS_MAX_BUCKETS = 16;
+// Latency histogram bounds in seconds, 100 us to 1 s
+constexpr double METRICS_LATENCY_BUCKETS_S[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                                0.025, 0.05, 0.1, 0.25, 0.5, 1.0};
+// Exposition text is rendered into a buffer of this size, allocated once
+constexpr size_t METRICS_RENDER_BUFFER_BYTES = 64 * 1024;
+
+// Prometheus endpoint on 127.0.0.1
+constexpr uint16_t DEFAULT_METRICS_PORT = 0;  // 0 disables the endpoint
+constexpr size_t METRICS_HTTP_REQUEST_BYTES = 4096;
+constexpr size_t METRICS_HTTP_HEADER_BYTES = 256;
+constexpr uint32_t METRICS_HTTP_TIMEOUT_MS = 2000;
+constexpr uint32_t METRICS_ACCEPT_POLL_MS = 250;
+constexpr uint32_t DEFAULT_METRICS_BENCH_SCRAPES = 0;  // 0 runs normally
+
+constexpr uint16_t DEFAULT_FOOTPRINT_BUDGET_MB = 0;  // 0 disables the budget check
+constexpr uint16_t DEFAULT_SOAK_MINUTES = 0;         // 0 runs normally
+
+// Soak mode drives the simulated backend every tick and samples the footprint
+constexpr uint16_t SOAK_TICK_INTERVAL_MS = 5;
+constexpr uint16_t SOAK_SAMPLE_INTERVAL_MS = 5000;
+// Growth between the first and last quarter of the run that fails the soak
+constexpr size_t SOAK_GROWTH_LIMIT_BYTES = 1024 * 1024;
+
+// -----------------------------
+// State Cache Settings
+// -----------------------------
+
+// Updates within this window are written back to the state file together
+constexpr uint16_t STATE_CACHE_FLUSH_INTERVAL_MS = 2000;
+
+// -----------------------------
+// Scene Settings
+// -----------------------------
+
+// Sized for Voicemeeter Potato, the largest layout
+constexpr size_t SCENE_MAX_STRIPS = 8;
+constexpr size_t SCENE_MAX_BUSES = 8;
+constexpr size_t SCENE_LABEL_LENGTH = 32;
+// Routing bit of B1; A1..A5 occupy the bits below it
+constexpr int SCENE_VIRTUAL_ROUTING_SHIFT = 5;
+// Gains closer than this are considered equal when diffing scenes
+constexpr float SCENE_GAIN_EPSILON_DB = 0.01f;
+// Capture reads every parameter of the layout in one executor command
+constexpr uint16_t SCENE_COMMAND_DEADLINE_MS = 2000;
+// A full Potato recall with every parameter changed fits without reallocating
+constexpr size_t SCENE_RECALL_SCRIPT_RESERVE = 4096;
+
+// Crossfades update every gain once per frame
+constexpr uint16_t CROSSFADE_FRAME_INTERVAL_MS = 20;
+constexpr uint16_t DEFAULT_CROSSFADE_MS = 0;       // 0 recalls scenes instantly
+constexpr uint16_t DEFAULT_CROSSFADE_SIM_MS = 0;   // 0 runs normally
+
+// -----------------------------
+// MIDI Settings
+// -----------------------------
+
+constexpr size_t MIDI_MAX_MAPPINGS = 32;
+// The MIDI buffer is drained, mapped and answered once per cycle
+constexpr uint16_t MIDI_POLL_INTERVAL_MS = 5;
+// Read size recommended by VoicemeeterRemote.h, and reads per cycle at most
+constexpr size_t MIDI_INPUT_BUFFER_SIZE = 1024;
+constexpr int MIDI_MAX_READS_PER_CYCLE = 16;
+// Largest feedback message VoicemeeterRemote.h recommends sending
+constexpr size_t MIDI_FEEDBACK_BUFFER_SIZE = 4096;
+// A control within this fraction of its travel from the mixer value picks it up
+constexpr float MIDI_TAKEOVER_WINDOW = 0.02f;
+// Cycles a written value may take to read back before it counts as an outside change
+constexpr uint8_t MIDI_SETTLE_CYCLES = 20;
+constexpr uint32_t DEFAULT_MIDI_BENCH_MESSAGES = 0;  // 0 runs normally
+
+// -----------------------------
+// MacroButton Settings
+// -----------------------------
+
+// Logical buttons addressed by VBVMR_MacroButton_GetStatus/SetStatus
+constexpr size_t MACRO_BUTTON_COUNT = 80;
+constexpr size_t MACRO_MAX_BINDINGS = 32;
+// The dirty flag is checked and lit states are pushed once per cycle
+constexpr uint16_t MACRO_POLL_INTERVAL_MS = 20;
+// Cycles a pressed button's target may take to follow before its lit state is corrected
+constexpr uint8_t MACRO_SETTLE_CYCLES = 10;
+
+// -----------------------------
+// OSC Settings
+// -----------------------------
+
+constexpr uint16_t DEFAULT_OSC_PORT = 0;  // 0 disables the OSC server
+// Largest datagram read, and largest feedback bundle sent (one Ethernet frame)
+constexpr size_t OSC_MAX_PACKET_SIZE = 8192;
+constexpr size_t OSC_FEEDBACK_PACKET_SIZE = 1400;
+constexpr int OSC_MAX_BUNDLE_DEPTH = 4;
+constexpr size_t OSC_MAX_CLIENTS = 8;
+// Subscribers that send nothing for this long stop receiving feedback
+constexpr uint32_t OSC_CLIENT_TIMEOUT_S = 300;
+// Feedback is read and sent at most once per interval, as one bundle per client
+constexpr uint16_t OSC_FEEDBACK_INTERVAL_MS = 50;
+// A client moving a control gets no feedback for it until it has been still this long
+constexpr uint16_t OSC_ECHO_HOLD_MS = 300;
+// Datagrams handled before pending writes are applied
+constexpr size_t OSC_MAX_PACKETS_PER_DRAIN = 512;
+constexpr int OSC_RECEIVE_BUFFER_BYTES = 1 << 20;
+constexpr uint32_t DEFAULT_OSC_BENCH_MESSAGES = 0;  // 0 runs normally
+
+// -----------------------------
+// Event Stream Settings
+// -----------------------------
+
+constexpr uint16_t DEFAULT_EVENT_PORT = 0;  // 0 disables the event stream
+constexpr size_t EVENT_MAX_SUBSCRIBERS = 64;
+// Events published but not yet fanned out; the publisher drops rather than waits when it is full
+constexpr size_t EVENT_RING_SIZE = 1024;
+// Per subscriber. Volume and mute coalesce in place; other events are dropped when it is full
+constexpr size_t EVENT_QUEUE_DEPTH = 128;
+constexpr size_t EVENT_TEXT_LENGTH = 64;  // Device id or scene name, truncated
+constexpr size_t EVENT_SEND_BUFFER_BYTES = 4096;
+// How often blocked subscribers are retried and new ones accepted when no event arrives
+constexpr uint16_t EVENT_POLL_INTERVAL_MS = 10;
+constexpr uint32_t DEFAULT_EVENT_BENCH_SUBSCRIBERS = 0;  // 0 runs normally
+constexpr uint16_t EVENT_BENCH_RATE_HZ = 1000;
+constexpr uint16_t EVENT_BENCH_SECONDS = 5;
+
+// -----------------------------
+// VBAN-TEXT Remote Settings
+// -----------------------------
+
+constexpr uint16_t DEFAULT_VBAN_PORT = 6980;
+constexpr const char* DEFAULT_VBAN_STREAM = "Command1";
+// Text is paced to this rate; the remote incoming stream must be set to the same rate
+constexpr uint32_t DEFAULT_VBAN_TEXT_BPS = 115200;
+// VBAN datagrams: a 28-byte header and at most 1408 bytes of data
+constexpr size_t VBAN_HEADER_SIZE = 28;
+constexpr size_t VBAN_MAX_PACKET_SIZE = 1436;
+constexpr size_t VBAN_STREAM_NAME_LENGTH = 16;
+// Queued script text beyond this is dropped instead of growing without bound
+constexpr size_t VBAN_TEXT_QUEUE_BYTES = 64 * 1024;
+// RT packets are requested for this long and renewed well before it runs out
+constexpr uint8_t VBAN_RT_REGISTER_TIMEOUT_S = 15;
+constexpr uint16_t VBAN_RT_RENEW_INTERVAL_MS = 5000;
+// Remote state older than this counts as unavailable
+constexpr uint16_t VBAN_STATE_TIMEOUT_MS = 1000;
+// A written volume is reported until an RT packet shows it, or for this long at most
+constexpr uint16_t VBAN_WRITE_SETTLE_MS = 500;
+// Hotkey and --toggle commands sent as scripts; fits "Strip[N].Gain=-60.00;"
+constexpr size_t CHANNEL_STATEMENT_LENGTH = 32;
+// How often the client thread wakes to send when nothing arrives
+constexpr uint16_t VBAN_POLL_INTERVAL_MS = 5;
+constexpr uint32_t DEFAULT_VBAN_BENCH_STATEMENTS = 0;  // 0 runs normally
+// The stand-in receiver of the benchmark sends RT packets at this rate
+constexpr uint16_t VBAN_BENCH_RT_INTERVAL_MS = 20;
+
+// -----------------------------
+// State Replication Settings
+// -----------------------------
+
+constexpr uint16_t DEFAULT_REPLICA_PORT = 0;  // 0 disables replication
+// Used when no peers are given; TTL 1 keeps it on the local network
+constexpr const char* DEFAULT_REPLICA_GROUP = "239.255.77.77";
+constexpr int REPLICA_MULTICAST_TTL = 1;
+constexpr size_t REPLICA_MAX_PEERS = 16;
+// Every instance sends its full state this often, so lost deltas are repaired
+constexpr uint32_t REPLICA_ANTI_ENTROPY_INTERVAL_MS = 2000;
+constexpr uint16_t REPLICA_POLL_INTERVAL_MS = 20;
+// A local change this close to a recently applied remote state is its echo, not a new write
+constexpr float REPLICA_ECHO_TOLERANCE_PERCENT = 0.05f;
+constexpr size_t REPLICA_ECHO_HISTORY = 4;
+constexpr uint16_t REPLICA_ECHO_WINDOW_MS = 1000;
+constexpr uint32_t DEFAULT_REPLICA_BENCH_INSTANCES = 0;  // 0 runs normally
+constexpr uint32_t REPLICA_BENCH_MAX_INSTANCES = 16;
+constexpr uint32_t REPLICA_BENCH_WRITES = 200;
+constexpr uint32_t REPLICA_BENCH_LOSS_PERCENT = 10;
+constexpr uint32_t REPLICA_BENCH_ANTI_ENTROPY_MS = 100;
+
+// -----------------------------
+// Ducking Settings
+// -----------------------------
+
+constexpr size_t DUCK_MAX_RULES = 16;
+// Levels are read, envelopes advanced and gains written once per cycle
+constexpr uint16_t DUCK_INTERVAL_MS = 10;
+// Used by rules that leave them out
+constexpr float DEFAULT_DUCK_DEPTH_DB = -12.0f;
+constexpr float DEFAULT_DUCK_THRESHOLD_DB = -40.0f;
+constexpr uint16_t DEFAULT_DUCK_ATTACK_MS = 50;
+constexpr uint16_t DEFAULT_DUCK_HOLD_MS = 300;
+constexpr uint16_t DEFAULT_DUCK_RELEASE_MS = 600;
+// Offsets are written in steps of this size; depths are rounded to it
+constexpr float DUCK_WRITE_STEP_DB = 0.1f;
+// VBVMR_GetLevel types: strips post-mute, so a muted trigger never ducks, and buses
+constexpr long DUCK_STRIP_LEVEL_TYPE = 2;
+constexpr long DUCK_BUS_LEVEL_TYPE = 3;
+constexpr int DUCK_PHYSICAL_STRIP_CHANNELS = 2;
+constexpr int DUCK_VIRTUAL_CHANNELS = 8;
+// Cycles a written gain may take to read back before it counts as an outside change
+constexpr uint8_t DUCK_SETTLE_CYCLES = 20;
+constexpr uint32_t DEFAULT_DUCK_BENCH_RULES = 0;  // 0 runs normally
+
+// -----------------------------
+// Audio Insert Settings
+// -----------------------------
+
+// Processors attached to the MAIN audio callback
+constexpr size_t AUDIO_MAX_PROCESSORS = 8;
+// Buses carry 8 channels each; Potato has the most buses
+constexpr size_t AUDIO_CHANNELS_PER_BUS = 8;
+constexpr size_t AUDIO_MAX_BUSES = 8;
+constexpr size_t AUDIO_MAX_BUS_CHANNELS = AUDIO_MAX_BUSES * AUDIO_CHANNELS_PER_BUS;
+// Largest buffer Voicemeeter hands to a callback, in samples per channel
+constexpr uint32_t AUDIO_MAX_FRAMES = 4096;
+// Shown by Voicemeeter when another application holds the callback; at most 63 characters
+constexpr const char* AUDIO_CLIENT_NAME = "VoiceMirror";
+// Stream the synthetic driver runs in benchmarks
+constexpr uint32_t AUDIO_BENCH_SAMPLE_RATE = 48000;
+constexpr uint32_t AUDIO_BENCH_FRAMES = 512;
+// Share of the buffer period VoiceMirror's processing may take; Voicemeeter needs the rest
+constexpr double AUDIO_BUDGET_FRACTION = 0.25;
+// Buffers over budget in a row before optional processors are bypassed, and for how long
+constexpr uint32_t AUDIO_BYPASS_AFTER_BUFFERS = 4;
+constexpr uint32_t AUDIO_BYPASS_HOLD_MS = 5000;
+// Callback time and jitter histogram bounds, as fractions of the buffer period
+constexpr double AUDIO_PERIOD_BUCKETS[] = {0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0};
+constexpr uint32_t AUDIO_BENCH_MAX_SECONDS = 600;
+constexpr uint32_t DEFAULT_AUDIO_BENCH_SECONDS = 0;  // 0 runs normally
+
+// -----------------------------
+// Loudness Settings
+// -----------------------------
+
+// BS.1770 energy is summed in 100 ms steps: 400 ms momentary and gating blocks, 3 s short-term
+constexpr uint32_t LOUDNESS_STEPS_PER_SECOND = 10;
+constexpr size_t LOUDNESS_MOMENTARY_STEPS = 4;
+constexpr size_t LOUDNESS_SHORT_TERM_STEPS = 30;
+// K-weighted samples are buffered per channel in chunks of this many frames, then summed
+constexpr uint32_t LOUDNESS_FILTER_CHUNK_FRAMES = 256;
+// Integrated loudness gates blocks through a histogram of 0.1 LU bins from -70 to +5 LUFS
+constexpr float LOUDNESS_ABSOLUTE_GATE_LUFS = -70.0f;
+constexpr float LOUDNESS_RELATIVE_GATE_LU = -10.0f;
+constexpr float LOUDNESS_HISTOGRAM_STEP_LU = 0.1f;
+constexpr size_t LOUDNESS_HISTOGRAM_BINS = 750;
+// Reported while nothing above the gate was measured; Prometheus has no -inf gauges
+constexpr float LOUDNESS_FLOOR_LUFS = -120.0f;
+
+// -----------------------------
+// Recording Settings
+// -----------------------------
+
+// Channels of one bus recorded into one file
+constexpr size_t RECORD_MAX_CHANNELS = AUDIO_CHANNELS_PER_BUS;
+// Frames buffered between the audio thread and the writer: 2.7 s at 48 kHz
+constexpr size_t RECORD_RING_FRAMES = 131072;
+// Files are written unbuffered in blocks of this size, at sector-aligned offsets
+constexpr size_t RECORD_WRITE_BLOCK_BYTES = 1 << 20;
+constexpr size_t RECORD_SECTOR_BYTES = 4096;
+// The writer drains the ring at this interval; the audio thread never wakes it
+constexpr uint32_t RECORD_WRITE_INTERVAL_MS = 20;
+constexpr const char* DEFAULT_RECORD_DIR = "";  // Empty records into the working directory
+constexpr uint32_t RECORD_BENCH_MAX_SECONDS = 600;
+constexpr uint32_t DEFAULT_RECORD_BENCH_SECONDS = 0;  // 0 runs normally
+
+// -----------------------------
+// Latency Measurement Settings
+// -----------------------------
+
+// Marker: a 255-chip maximum-length sequence, zero-padded to a multiple of the SIMD width
+constexpr size_t LATENCY_MARKER_LENGTH = 256;
+constexpr float LATENCY_MARKER_LEVEL = 0.25f;  // -12 dBFS
+// Longest round trip that can be detected, and the highest sample rate it is sized for
+constexpr uint32_t LATENCY_MAX_MS = 500;
+constexpr uint32_t LATENCY_MAX_SAMPLE_RATE = 192000;
+constexpr size_t LATENCY_CAPTURE_FRAMES =
+    static_cast<size_t>(LATENCY_MAX_SAMPLE_RATE) * LATENCY_MAX_MS / 1000 + LATENCY_MARKER_LENGTH;
+// Normalized cross-correlation the marker must reach to count as detected
+constexpr float LATENCY_DETECT_THRESHOLD = 0.5f;
+// Silence between runs, so a run never sees the previous marker
+constexpr uint32_t LATENCY_RUN_GAP_MS = 100;
+// Jitter histogram: one bin per sample of deviation from the median, this many either side
+constexpr int32_t LATENCY_JITTER_RANGE = 8;
+constexpr uint32_t LATENCY_MAX_RUNS = 1000;
+constexpr uint32_t DEFAULT_LATENCY_RUNS = 20;
+constexpr uint32_t DEFAULT_LATENCY_BENCH_RUNS = 0;  // 0 runs normally
+
+// -----------------------------
+// Volume History Settings
+// -----------------------------
+
+// Entries per series in each tier: every change, then per-second and per-minute buckets
+constexpr size_t HISTORY_RAW_CAPACITY = 2048;
+constexpr size_t HISTORY_SECOND_CAPACITY = 1024;
+constexpr size_t HISTORY_MINUTE_CAPACITY = 1024;
+// Volume is stored in hundredths of a percent
+constexpr float HISTORY_VOLUME_SCALE = 100.0f;
+constexpr uint32_t HISTORY_BENCH_MAX_CHANGES = 1000000;
+constexpr uint32_t DEFAULT_HISTORY_BENCH_CHANGES = 0;  // 0 runs normally
+
 // -----------------------------
 // Command-Line Option Defaults
 // -----------------------------
@@ -165,8 +511,11 @@ enum class ChangeSource : uint8_t {
 // Hotkey Settings
 // -----------------------------
 
-constexpr uint16_t DEFAULT_HOTKEY_MODIFIERS = MOD_CONTROL | MOD_ALT;
+constexpr uint16_t DEFAULT_HOTKEY_MODIFIERS = 0x0003;  // MOD_CONTROL | MOD_ALT
 constexpr uint8_t DEFAULT_HOTKEY_VK = 'R';
+constexpr size_t HOTKEY_MAX_BINDINGS = 32;        // Bindings the dispatch table can hold
+constexpr size_t HOTKEY_MAX_PRESETS = 8;          // Preset scenes addressable by preset:<n>
+constexpr uint32_t DEFAULT_HOTKEY_BENCH_PRESSES = 0;
 
 // -----------------------------
 // Configuration Structure
@@ -221,9 +570,85 @@ struct Config {
     // Hotkey Settings
     ConfigOption<uint16_t> hotkeyModifiers = {DEFAULT_HOTKEY_MODIFIERS, ConfigSource::Default};
     ConfigOption<uint8_t> hotkeyVK = {DEFAULT_HOTKEY_VK, ConfigSource::Default};
+    ConfigOption<std::vector<std::string>> hotkeyBindings = {{}, ConfigSource::Default};
+    ConfigOption<std::vector<std::string>> presetPaths = {{}, ConfigSource::Default};
+    ConfigOption<uint32_t> hotkeyBenchPresses = {DEFAULT_HOTKEY_BENCH_PRESSES, ConfigSource::Default};
+
+    // MIDI Settings
+    ConfigOption<std::vector<std::string>> midiMappings = {{}, ConfigSource::Default};
+    ConfigOption<uint32_t> midiBenchMessages = {DEFAULT_MIDI_BENCH_MESSAGES, ConfigSource::Default};
+
+    // MacroButton Settings
+    ConfigOption<std::vector<std::string>> macroButtonBindings = {{}, ConfigSource::Default};
+
+    // OSC Settings
+    ConfigOption<uint16_t> oscPort = {DEFAULT_OSC_PORT, ConfigSource::Default};
+    ConfigOption<uint32_t> oscBenchMessages = {DEFAULT_OSC_BENCH_MESSAGES, ConfigSource::Default};
+
+    // Metrics Settings
+    ConfigOption<uint16_t> metricsPort = {DEFAULT_METRICS_PORT, ConfigSource::Default};
+    ConfigOption<uint32_t> metricsBenchScrapes = {DEFAULT_METRICS_BENCH_SCRAPES, ConfigSource::Default};
+
+    // Event Stream Settings
+    ConfigOption<uint16_t> eventPort = {DEFAULT_EVENT_PORT, ConfigSource::Default};
+    ConfigOption<uint32_t> eventBenchSubscribers = {DEFAULT_EVENT_BENCH_SUBSCRIBERS, ConfigSource::Default};
+
+    // VBAN-TEXT Remote Settings (an empty host controls the local Voicemeeter)
+    ConfigOption<std::string> vbanHost = {"", ConfigSource::Default};
+    ConfigOption<uint16_t> vbanPort = {DEFAULT_VBAN_PORT, ConfigSource::Default};
+    ConfigOption<std::string> vbanStream = {DEFAULT_VBAN_STREAM, ConfigSource::Default};
+    ConfigOption<uint32_t> vbanTextBps = {DEFAULT_VBAN_TEXT_BPS, ConfigSource::Default};
+    ConfigOption<uint32_t> vbanBenchStatements = {DEFAULT_VBAN_BENCH_STATEMENTS, ConfigSource::Default};
+
+    // State Replication Settings (no peers uses the multicast group)
+    ConfigOption<uint16_t> replicaPort = {DEFAULT_REPLICA_PORT, ConfigSource::Default};
+    ConfigOption<std::vector<std::string>> replicaPeers = {{}, ConfigSource::Default};
+    ConfigOption<uint32_t> replicaBenchInstances = {DEFAULT_REPLICA_BENCH_INSTANCES, ConfigSource::Default};
+
+    // Ducking Settings
+    ConfigOption<std::vector<std::string>> duckRules = {{}, ConfigSource::Default};
+    ConfigOption<uint32_t> duckBenchRules = {DEFAULT_DUCK_BENCH_RULES, ConfigSource::Default};
+
+    // Audio Insert Settings
+    ConfigOption<uint32_t> audioBenchSeconds = {DEFAULT_AUDIO_BENCH_SECONDS, ConfigSource::Default};
+
+    // Loudness Settings
+    ConfigOption<bool> loudness = {false, ConfigSource::Default};
+
+    // Recording Settings (an empty target disables the tap)
+    ConfigOption<std::string> recordTarget = {"", ConfigSource::Default};
+    ConfigOption<std::string> recordDir = {DEFAULT_RECORD_DIR, ConfigSource::Default};
+    ConfigOption<uint32_t> recordBenchSeconds = {DEFAULT_RECORD_BENCH_SECONDS, ConfigSource::Default};
+
+    // Latency Measurement Settings (an empty path runs normally)
+    ConfigOption<std::string> latencyPath = {"", ConfigSource::Default};
+    ConfigOption<uint32_t> latencyRuns = {DEFAULT_LATENCY_RUNS, ConfigSource::Default};
+    ConfigOption<uint32_t> latencyBenchRuns = {DEFAULT_LATENCY_BENCH_RUNS, ConfigSource::Default};
+
+    // Volume History Settings (an empty path keeps the history in memory only)
+    ConfigOption<std::string> historyFilePath = {DEFAULT_HISTORY_FILE, ConfigSource::Default};
+    ConfigOption<uint32_t> historyBenchChanges = {DEFAULT_HISTORY_BENCH_CHANGES, ConfigSource::Default};
 
     // Sound Settings
     ConfigOption<const wchar_t*> syncSoundFilePath = {DEFAULT_SYNC_SOUND_FILE, ConfigSource::Default};
     ConfigOption<const char*> startupSoundFilePath = {DEFAULT_STARTUP_SOUND_FILE, ConfigSource::Default};
     ConfigOption<uint16_t> startupDelay = {DEFAULT_STARTUP_DELAY_MS, ConfigSource::Default};
+
+    // Executor and Mirror Benchmark Settings
+    ConfigOption<uint32_t> executorBenchCommands = {DEFAULT_EXECUTOR_BENCH_COMMANDS, ConfigSource::Default};
+    ConfigOption<uint32_t> lockBenchEvents = {DEFAULT_LOCK_BENCH_EVENTS, ConfigSource::Default};
+    ConfigOption<uint32_t> allocBenchEvents = {DEFAULT_ALLOC_BENCH_EVENTS, ConfigSource::Default};
+
+    // Footprint Settings
+    ConfigOption<uint16_t> footprintBudgetMB = {DEFAULT_FOOTPRINT_BUDGET_MB, ConfigSource::Default};
+    ConfigOption<uint16_t> soakMinutes = {DEFAULT_SOAK_MINUTES, ConfigSource::Default};
+
+    // State Cache Settings (an empty path disables the cache)
+    ConfigOption<std::string> stateFilePath = {DEFAULT_STATE_FILE, ConfigSource::Default};
+
+    // Scene Commands
+    ConfigOption<std::string> sceneSavePath = {"", ConfigSource::Default};
+    ConfigOption<std::string> sceneRecallPath = {"", ConfigSource::Default};
+    ConfigOption<uint16_t> crossfadeMs = {DEFAULT_CROSSFADE_MS, ConfigSource::Default};
+    ConfigOption<uint16_t> crossfadeSimMs = {DEFAULT_CROSSFADE_SIM_MS, ConfigSource::Default};
 };
\ No newline at end of file
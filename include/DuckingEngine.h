@@ -0,0 +1,277 @@
+// DuckingEngine.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+
+/**
+ * @brief Strip or bus a ducking rule listens to or lowers.
+ */
+struct DuckChannel {
+    ChannelType type = ChannelType::Input;
+    uint8_t index = 0;
+
+    bool operator==(const DuckChannel& other) const { return type == other.type && index == other.index; }
+};
+
+/**
+ * @brief Lowers one strip or bus while another one has signal.
+ */
+struct DuckRule {
+    DuckChannel trigger;
+    DuckChannel target;
+    float depthDb = DEFAULT_DUCK_DEPTH_DB;          ///< Offset while ducked; negative, in 0.1 dB steps.
+    float thresholdDb = DEFAULT_DUCK_THRESHOLD_DB;  ///< Trigger peak level that ducks.
+    uint16_t attackMs = DEFAULT_DUCK_ATTACK_MS;     ///< Time to reach the full depth.
+    uint16_t holdMs = DEFAULT_DUCK_HOLD_MS;         ///< Time kept at depth after the signal stops.
+    uint16_t releaseMs = DEFAULT_DUCK_RELEASE_MS;   ///< Time to return to the user gain.
+};
+
+class DuckingEngine;
+
+/**
+ * @brief Where ducking cycles run: Voicemeeter, or the simulated level source.
+ *
+ * RunCycle() reads the peak level of every Triggers() entry and the gain of
+ * every TargetParameters() entry, calls DuckingEngine::Process() once, then
+ * applies its script, so a cycle is one executor command however many
+ * rules there are.
+ */
+class DuckingPort {
+public:
+    virtual ~DuckingPort() = default;
+
+    virtual bool RunCycle(DuckingEngine& engine) = 0;
+
+    /**
+     * @brief Returns once no cycle started by RunCycle() can still touch the engine.
+     */
+    virtual void Close() {}
+
+    /**
+     * @brief Applies a script outside a cycle and returns once it is applied.
+     *        Stop() uses it to give targets still ducked their gain back.
+     */
+    virtual void Restore(const std::string& script) = 0;
+};
+
+/**
+ * @brief Lowers strips and buses while others have signal.
+ *
+ * A cycle thread runs every DUCK_INTERVAL_MS. Each rule has its own
+ * attack/hold/release envelope, driven by the trigger's peak level against
+ * the rule's threshold and ramping linearly in dB. A target lowered by
+ * several rules follows the deepest one. Offsets are written on top of the
+ * gain the user set, in DUCK_WRITE_STEP_DB steps, as one
+ * VBVMR_SetParameters script per cycle for every target that moved.
+ *
+ * The user's gain is never lost: it is kept aside while the target is
+ * ducked and written back exactly once every rule on the target has
+ * released. A gain that changes elsewhere while ducked becomes the new user
+ * gain as it is; the target is left alone until its rules release, so the
+ * move is never pushed down or undone.
+ */
+class DuckingEngine {
+public:
+    /**
+     * @brief Cycle counters.
+     */
+    struct Stats {
+        uint64_t cycles = 0;
+        uint64_t writes = 0;       ///< Gain statements written.
+        uint64_t activations = 0;  ///< Rules whose trigger crossed the threshold.
+        uint64_t overrides = 0;    ///< Gains moved elsewhere while ducked.
+    };
+
+    DuckingEngine();
+    ~DuckingEngine();
+
+    DuckingEngine(const DuckingEngine&) = delete;
+    DuckingEngine& operator=(const DuckingEngine&) = delete;
+
+    /**
+     * @brief Adds a rule.
+     * @return false if the engine is running, full, or the rule is invalid.
+     */
+    bool AddRule(const DuckRule& rule);
+
+    /**
+     * @brief Parses "input:0=input:5:-12" style rules.
+     *
+     * Trigger and target are <input|output>:<index>; the target is followed
+     * by the depth in dB and optionally the threshold in dB, then attack,
+     * hold and release in ms: input:0=input:5:-12:-40:50:300:600.
+     */
+    static bool ParseRule(const std::string& text, DuckRule& rule);
+
+    size_t RuleCount() const { return rules_.size(); }
+    const std::vector<DuckRule>& Rules() const { return rules_; }
+
+    /**
+     * @brief Distinct trigger channels, in first-use order.
+     */
+    const std::vector<DuckChannel>& Triggers() const { return triggers_; }
+
+    /**
+     * @brief Distinct target channels, and the gain parameter of each ("Strip[5].Gain").
+     */
+    const std::vector<DuckChannel>& Targets() const { return targets_; }
+    const std::vector<std::string>& TargetParameters() const { return parameters_; }
+
+    /**
+     * @brief Level meter channels of a strip or bus in a VBVMR_GetLevel() type.
+     *
+     * Physical strips have DUCK_PHYSICAL_STRIP_CHANNELS channels; virtual
+     * strips and buses have DUCK_VIRTUAL_CHANNELS.
+     *
+     * @return false if the edition is unknown or has no such channel.
+     */
+    static bool LevelChannels(long voicemeeterType, const DuckChannel& channel, int& first, int& count);
+
+    /**
+     * @brief Starts the cycle thread on @p port.
+     */
+    bool Start(DuckingPort& port);
+
+    /**
+     * @brief Stops the cycle thread, waits until the port is done with the
+     *        engine and writes the user's gain back to every target still ducked.
+     */
+    void Stop();
+
+    /**
+     * @brief Runs one cycle. Called by the port, on the thread that owns the mixer.
+     *
+     * @param levels Peak level of each Triggers() entry, linear; NaN if unreadable.
+     * @param values Current value of each TargetParameters() entry in dB; NaN if unreadable.
+     */
+    void Process(const float* levels, const float* values);
+
+    /**
+     * @brief Parameter script produced by the last Process(); may be empty.
+     */
+    const std::string& Script() const { return script_; }
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Runs rules at the cycle rate against the simulated level
+     *        source, measures evaluation cost, and checks ducking depth,
+     *        exact restore and that user moves survive.
+     * @param rules Number of rules, 1 to DUCK_MAX_RULES.
+     */
+    static bool Benchmark(uint32_t rules);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Per-rule envelope. Only touched by Process().
+    struct RuleState {
+        uint8_t trigger = 0;      ///< Slot in triggers_.
+        uint8_t target = 0;       ///< Slot in targets_.
+        bool active = false;      ///< Trigger above threshold last cycle.
+        float offsetDb = 0.0f;    ///< Current envelope value, depthDb..0.
+        float holdLeftMs = 0.0f;
+    };
+
+    // Per-target gain bookkeeping. Only touched by Process().
+    struct TargetState {
+        bool known = false;
+        float userDb = 0.0f;      ///< Gain the user set, restored after release.
+        float writtenDb = 0.0f;   ///< Last gain written or adopted.
+        float appliedDb = 0.0f;   ///< Offset contained in writtenDb.
+        bool suspended = false;   ///< Moved elsewhere while ducked; untouched until released.
+        uint8_t settleCycles = 0; ///< Cycles left for a written value to read back.
+    };
+
+    void ThreadProc();
+    void ObserveValues(const float* values);
+    void AdvanceEnvelopes(const float* levels, float elapsedMs);
+    size_t WriteScript();
+
+    static uint8_t AddChannel(std::vector<DuckChannel>& channels, const DuckChannel& channel);
+
+    std::vector<DuckRule> rules_;
+    std::vector<RuleState> ruleStates_;
+    std::vector<DuckChannel> triggers_;
+    std::vector<DuckChannel> targets_;
+    std::vector<std::string> parameters_;
+    std::vector<TargetState> targetStates_;
+    std::vector<float> targetOffsets_;
+
+    std::string script_;
+    Clock::time_point lastProcess_;
+    bool processed_ = false;
+    uint64_t cycleActivations_ = 0;
+    uint64_t cycleOverrides_ = 0;
+
+    // Thread state
+    DuckingPort* port_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    mutable ProfiledMutex statsMutex_{"DuckingEngine::statsMutex_"};
+    Stats stats_;
+};
+
+/**
+ * @brief Simulated level source and mixer, for benchmarks.
+ *
+ * Levels and gains set from any thread are seen on the next cycle; scripts
+ * are applied to the simulated gains. Records the cost of every Process()
+ * call and the writes made to each target.
+ */
+class SimulatedLevelPort : public DuckingPort {
+public:
+    SimulatedLevelPort(const std::vector<DuckChannel>& triggers, const std::vector<std::string>& parameters);
+
+    void SetLevel(size_t trigger, float level);
+
+    /**
+     * @brief Changes a simulated gain as if it was moved on the mixer.
+     */
+    void SetValue(size_t target, float value);
+    float GetValue(size_t target) const;
+
+    /**
+     * @brief Lowest gain each target reached, and the writes each target received.
+     */
+    float MinimumValue(size_t target) const;
+    uint64_t Writes(size_t target) const;
+
+    bool RunCycle(DuckingEngine& engine) override;
+    void Restore(const std::string& script) override;
+
+    /**
+     * @brief Process() durations in microseconds, and the time between cycle starts in ms.
+     */
+    std::vector<double> ProcessMicros() const;
+    std::vector<double> CycleIntervalsMs() const;
+    uint64_t Scripts() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void ApplyScript(const std::string& script);
+
+    std::vector<std::string> parameters_;
+
+    mutable ProfiledMutex mutex_{"SimulatedLevelPort::mutex_"};
+    std::vector<float> levels_;
+    std::vector<float> values_;
+    std::vector<float> minimums_;
+    std::vector<uint64_t> writes_;
+    std::vector<float> levelSnapshot_;
+    std::vector<float> valueSnapshot_;
+    std::vector<double> processMicros_;
+    std::vector<double> intervalsMs_;
+    Clock::time_point lastCycle_;
+    uint64_t scripts_ = 0;
+};
@@ -0,0 +1,28 @@
+// EndpointVolume.h
+#pragma once
+
+#include "InlineFunction.h"
+#include "ListenerList.h"
+
+using VolumeChangeCallback = InlineFunction<void(float, bool)>;
+
+/**
+ * @brief Volume and mute interface of the mirrored Windows endpoint.
+ *
+ * Implemented by WindowsManager for the real device and by
+ * SimulatedEndpoint for benchmarks, so the mirror can be driven without
+ * touching the user's volume. Callbacks report changes made outside the
+ * mirror and may arrive on any thread.
+ */
+class EndpointVolume {
+public:
+    virtual ~EndpointVolume() = default;
+
+    virtual bool SetVolume(float volumePercent) = 0;
+    virtual bool SetMute(bool mute) = 0;
+    virtual float GetVolume() const = 0;
+    virtual bool GetMute() const = 0;
+
+    virtual CallbackID RegisterVolumeChangeCallback(VolumeChangeCallback callback) = 0;
+    virtual bool UnregisterVolumeChangeCallback(CallbackID callbackID) = 0;
+};
@@ -0,0 +1,147 @@
+// EventStream.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+#include "RAIIHandle.h"
+
+/**
+ * @brief Kinds of event on the stream.
+ */
+enum class StreamEventType : uint8_t {
+    Volume = 1,   ///< value: volume percent
+    Mute = 2,     ///< value: 1 muted, 0 unmuted
+    Device = 3,   ///< text: id of the new default playback device
+    Scene = 4,    ///< value: preset index, or -1; text: scene name
+    Dropped = 5   ///< value: events this subscriber lost since the previous frame
+};
+
+enum class StreamEventSide : uint8_t {
+    None = 0,
+    Windows = 1,
+    Voicemeeter = 2
+};
+
+/**
+ * @brief One event as queued; serialized into a frame when sent.
+ */
+struct StreamEvent {
+    StreamEventType type = StreamEventType::Volume;
+    StreamEventSide side = StreamEventSide::None;
+    uint8_t textLength = 0;
+    uint32_t sequence = 0;
+    uint64_t timestampUs = 0;  ///< Microseconds since the Unix epoch
+    float value = 0.0f;
+    char text[EVENT_TEXT_LENGTH];
+};
+
+/**
+ * @brief Pushes volume, mute, device and scene changes to local subscribers.
+ *
+ * Subscribers connect to a TCP port on 127.0.0.1 and only read. Each frame
+ * is a little-endian uint16 length followed by that many bytes:
+ *
+ *   uint8 type, uint8 side, uint32 sequence, uint64 timestamp (us since
+ *   the Unix epoch), float32 value, then the text bytes, if any.
+ *
+ * A new subscriber first receives the current volume and mute of both
+ * sides. Publishing never blocks on subscribers: it copies the event into a
+ * ring under a short lock and wakes the stream thread, which fans events out
+ * to a bounded queue per subscriber and sends with non-blocking writes. When
+ * a subscriber falls behind, a queued volume or mute is overwritten by the
+ * newer value of the same side, and other events are dropped and reported
+ * with a Dropped frame. Volume and mute are only published when they change.
+ */
+class EventStream {
+public:
+    struct Stats {
+        uint64_t published = 0;
+        uint64_t overflowed = 0;   ///< Dropped because the stream thread fell behind
+        uint64_t frames = 0;       ///< Frames sent to all subscribers together
+        uint64_t coalesced = 0;
+        uint64_t dropped = 0;      ///< Dropped from full subscriber queues
+        uint64_t disconnects = 0;
+        size_t subscribers = 0;
+    };
+
+    /**
+     * @brief The stream the application publishes to.
+     */
+    static EventStream& Instance();
+
+    EventStream();
+    ~EventStream();
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    /**
+     * @brief Listens on 127.0.0.1 and starts the stream thread.
+     * @param port TCP port; 0 picks a free one (see Port()).
+     */
+    bool Start(uint16_t port);
+    void Stop();
+
+    uint16_t Port() const { return port_; }
+    Stats GetStats() const;
+
+    // Safe from any thread, whether or not the stream is running. Never blocks on I/O or allocates.
+    void PublishVolume(StreamEventSide side, float volumePercent);
+    void PublishMute(StreamEventSide side, bool isMuted);
+    void PublishDevice(const char* deviceId);
+    void PublishScene(int preset, const char* name);
+
+    /**
+     * @brief Publishes at EVENT_BENCH_RATE_HZ to the given number of local
+     *        subscribers, one of which never reads, and reports publish cost,
+     *        delivery latency and backpressure.
+     */
+    static bool Benchmark(uint32_t subscribers);
+
+private:
+    struct Subscriber;
+
+    static constexpr size_t STATE_KEYS = 4;  ///< Volume and mute of each side
+
+    static int StateKey(StreamEventType type, StreamEventSide side);
+
+    void Publish(StreamEventType type, StreamEventSide side, float value, const char* text);
+    void ThreadProc();
+    void Accept();
+    void Enqueue(Subscriber& subscriber, const StreamEvent& event);
+    bool Flush(Subscriber& subscriber);
+    void Disconnect(size_t slot);
+
+    // Publisher side
+    ProfiledMutex ringMutex_{"EventStream::ringMutex_"};
+    StreamEvent ring_[EVENT_RING_SIZE];
+    size_t ringHead_ = 0;
+    size_t ringCount_ = 0;
+    uint32_t sequence_ = 0;
+    StreamEvent state_[STATE_KEYS];  ///< Last volume and mute of each side, sent to new subscribers
+    bool stateKnown_[STATE_KEYS] = {};
+    RAIIHandle wakeEvent_;
+
+    // Stream thread state
+    uintptr_t socket_;
+    uint16_t port_ = 0;
+    std::unique_ptr<Subscriber> subscribers_[EVENT_MAX_SUBSCRIBERS];
+    StreamEvent batch_[EVENT_RING_SIZE];
+    StreamEvent snapshot_[STATE_KEYS];
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> overflowed_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> disconnects_{0};
+    std::atomic<size_t> subscriberCount_{0};
+};
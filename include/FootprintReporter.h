@@ -0,0 +1,52 @@
+// FootprintReporter.h
+#pragma once
+
+#include <cstdint>
+
+#include "AllocationTracker.h"
+
+/**
+ * @brief Point-in-time view of the process memory footprint.
+ */
+struct Footprint {
+    uint64_t workingSetBytes = 0;
+    uint64_t privateBytes = 0;          ///< Commit charge; what the budget is checked against.
+    uint32_t threadCount = 0;
+    uint64_t stackReserveBytes = 0;     ///< threadCount times the image's default stack reserve.
+    uint64_t voicemeeterDllBytes = 0;   ///< Mapped image size of VoicemeeterRemote, 0 if not loaded.
+    uint64_t mappedImageBytes = 0;      ///< Mapped image size of every loaded module.
+    int64_t heapLiveBytes[static_cast<size_t>(AllocationSubsystem::Count)] = {};
+
+    /**
+     * @brief Live heap bytes summed over all subsystems (0 in untracked builds).
+     */
+    int64_t TrackedHeapBytes() const;
+};
+
+/**
+ * @brief Samples the process footprint and exports it as metrics.
+ *
+ * Process-level figures come from the OS and are available in every build.
+ * Per-subsystem heap figures come from AllocationTracker and are only
+ * non-zero in builds configured with VOICEMIRROR_TRACK_ALLOCATIONS.
+ */
+class FootprintReporter {
+public:
+    static Footprint Sample();
+
+    /**
+     * @brief Registers footprint gauges and a collector refreshing them.
+     *
+     * Safe to call more than once; later calls do nothing.
+     */
+    static void RegisterMetrics();
+
+    static void Log(const Footprint& footprint);
+
+    /**
+     * @brief Checks private bytes against a budget.
+     * @param budgetMB Budget in MiB; 0 disables the check.
+     * @return false and logs a warning if the budget is exceeded.
+     */
+    static bool CheckBudget(const Footprint& footprint, uint16_t budgetMB);
+};
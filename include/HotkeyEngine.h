@@ -0,0 +1,147 @@
+// HotkeyEngine.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Defconf.h"
+#include "InlineFunction.h"
+
+/**
+ * @brief What a hotkey does.
+ */
+struct HotkeyAction {
+    enum class Kind : uint8_t {
+        None,
+        VolumeStep,     ///< Add stepDb to a strip or bus gain.
+        MuteToggle,     ///< Flip a strip or bus mute.
+        ApplyPreset,    ///< Recall preset number `preset`.
+        ForceResync,    ///< Push the Windows volume to the mirrored channel again.
+        PlaySyncSound,  ///< Play the sync sound (the legacy single hotkey).
+        ToggleMidi      ///< Enable or disable MIDI mapping.
+    };
+
+    Kind kind = Kind::None;
+    ChannelType channelType = ChannelType::Input;
+    uint8_t channelIndex = 0;
+    uint8_t preset = 0;
+    float stepDb = 0.0f;
+};
+
+/**
+ * @brief One key combination and its action.
+ */
+struct HotkeyBinding {
+    uint16_t modifiers = 0;  ///< MOD_ALT | MOD_CONTROL | MOD_SHIFT | MOD_WIN
+    uint8_t vk = 0;          ///< Windows virtual key code
+    HotkeyAction action;
+};
+
+// Receives the modifiers and virtual key of every registered combination pressed.
+using KeyHandler = InlineFunction<void(uint16_t, uint8_t)>;
+
+/**
+ * @brief Delivers key combinations to the engine.
+ *
+ * The Windows implementation registers global hotkeys on its own input
+ * thread; SyntheticKeySource injects events directly, so dispatch can be
+ * exercised and timed without a desktop session.
+ */
+class KeySource {
+public:
+    virtual ~KeySource() = default;
+
+    /**
+     * @brief Starts delivering presses of the given bindings to @p handler.
+     * @return false if no binding could be registered.
+     */
+    virtual bool Start(const std::vector<HotkeyBinding>& bindings, KeyHandler handler) = 0;
+
+    virtual void Stop() = 0;
+};
+
+/**
+ * @brief Key source driven by the caller, for benchmarks and simulations.
+ */
+class SyntheticKeySource : public KeySource {
+public:
+    bool Start(const std::vector<HotkeyBinding>& bindings, KeyHandler handler) override;
+    void Stop() override;
+
+    /**
+     * @brief Delivers a key press on the calling thread.
+     */
+    void Press(uint16_t modifiers, uint8_t vk);
+
+private:
+    KeyHandler handler_;
+};
+
+/**
+ * @brief Maps key combinations to actions.
+ *
+ * Bindings are resolved once into a table indexed by modifiers and virtual
+ * key, so a press costs one array lookup before the action reaches the sink.
+ * The sink runs on the key source's thread and must only queue work.
+ */
+class HotkeyEngine {
+public:
+    using ActionSink = InlineFunction<void(const HotkeyAction&)>;
+
+    HotkeyEngine(KeySource& source, ActionSink sink);
+    ~HotkeyEngine();
+
+    HotkeyEngine(const HotkeyEngine&) = delete;
+    HotkeyEngine& operator=(const HotkeyEngine&) = delete;
+
+    /**
+     * @brief Adds a binding; a later binding for the same combination replaces the earlier one.
+     * @return false if the table is full or the combination is invalid.
+     */
+    bool Bind(const HotkeyBinding& binding);
+
+    /**
+     * @brief Parses "ctrl+alt+F5=step:input:0:+3" style bindings.
+     *
+     * Actions: step:<input|output>:<index>:<dB>, mute:<input|output>:<index>,
+     * preset:<n>, resync, sound, midi.
+     */
+    static bool ParseBinding(const std::string& text, HotkeyBinding& binding);
+
+    /**
+     * @brief Parses the action half of a binding ("mute:input:0").
+     */
+    static bool ParseAction(const std::string& text, HotkeyAction& action);
+
+    bool Start();
+    void Stop();
+
+    /**
+     * @brief Looks up a combination and hands its action to the sink.
+     */
+    void Dispatch(uint16_t modifiers, uint8_t vk);
+
+    size_t BindingCount() const { return bindings_.size(); }
+    uint64_t DispatchCount() const { return dispatched_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Times synthetic presses through the full dispatch path and logs the result.
+     * @param presses Number of presses to deliver.
+     * @return true if every press dispatched exactly its bound action.
+     */
+    static bool BenchmarkDispatch(uint32_t presses);
+
+private:
+    static constexpr size_t MODIFIER_COMBINATIONS = 16;
+    static constexpr size_t VIRTUAL_KEYS = 256;
+    static constexpr uint8_t NO_BINDING = 0xFF;
+
+    KeySource& source_;
+    ActionSink sink_;
+    std::vector<HotkeyBinding> bindings_;
+    uint8_t table_[MODIFIER_COMBINATIONS][VIRTUAL_KEYS];
+    std::atomic<uint64_t> dispatched_{0};
+    bool running_ = false;
+};
@@ -0,0 +1,126 @@
+// InlineFunction.h
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+constexpr size_t INLINE_FUNCTION_CAPACITY = 4 * sizeof(void*);
+
+template <typename Signature, size_t Capacity = INLINE_FUNCTION_CAPACITY>
+class InlineFunction;
+
+/**
+ * @brief Copyable callable wrapper that never allocates.
+ *
+ * Works like std::function, but the callable is always stored in an inline
+ * buffer of @p Capacity bytes. Callables that do not fit are rejected at
+ * compile time instead of falling back to the heap, so copying, invoking and
+ * destroying an InlineFunction is always allocation-free.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+    InlineFunction() noexcept = default;
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction>>>
+    InlineFunction(F&& fn) {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= Capacity, "Callable does not fit in InlineFunction; capture less state");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable is over-aligned for InlineFunction");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>, "Callable must be nothrow move constructible");
+        static_assert(std::is_copy_constructible_v<Fn>, "Callable must be copy constructible");
+
+        ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+        ops_ = &OpsFor<Fn>::table;
+    }
+
+    InlineFunction(const InlineFunction& other) {
+        if (other.ops_) {
+            other.ops_->copy(storage_, other.storage_);
+            ops_ = other.ops_;
+        }
+    }
+
+    InlineFunction(InlineFunction&& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.Reset();
+        }
+    }
+
+    InlineFunction& operator=(const InlineFunction& other) {
+        if (this != &other) {
+            Reset();
+            if (other.ops_) {
+                other.ops_->copy(storage_, other.storage_);
+                ops_ = other.ops_;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(InlineFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            if (other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.Reset();
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    ~InlineFunction() { Reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    R operator()(Args... args) const {
+        return ops_->invoke(const_cast<unsigned char*>(storage_), std::forward<Args>(args)...);
+    }
+
+private:
+    struct Ops {
+        R (*invoke)(void* target, Args&&... args);
+        void (*copy)(void* destination, const void* source);
+        void (*move)(void* destination, void* source);
+        void (*destroy)(void* target);
+    };
+
+    template <typename Fn>
+    struct OpsFor {
+        static R Invoke(void* target, Args&&... args) {
+            return (*static_cast<Fn*>(target))(std::forward<Args>(args)...);
+        }
+        static void Copy(void* destination, const void* source) {
+            ::new (destination) Fn(*static_cast<const Fn*>(source));
+        }
+        static void Move(void* destination, void* source) {
+            ::new (destination) Fn(std::move(*static_cast<Fn*>(source)));
+        }
+        static void Destroy(void* target) {
+            static_cast<Fn*>(target)->~Fn();
+        }
+
+        static constexpr Ops table{&Invoke, &Copy, &Move, &Destroy};
+    };
+
+    void Reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    const Ops* ops_ = nullptr;
+};
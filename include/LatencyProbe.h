@@ -0,0 +1,114 @@
+// LatencyProbe.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AudioInsert.h"
+#include "Defconf.h"
+
+/**
+ * @brief Where a LatencyProbe sends its marker and where it listens for it.
+ */
+struct LatencyPath {
+    uint32_t output = 0;  ///< Bus channel of the MAIN stream, 0 being A1 left
+    uint32_t input = 0;   ///< Strip input channel of the MAIN stream, 0 being strip 1 left
+};
+
+/**
+ * @brief Measures the round trip from a bus output back to a strip input.
+ *
+ * Each run replaces one bus channel with a maximum-length sequence followed
+ * by silence and, from the same sample on, captures one input channel into
+ * a buffer allocated up front. The audio thread only copies samples; once
+ * the capture is full, the measuring thread finds the marker in it by
+ * normalized cross-correlation, with the dot product at every lag taken
+ * four samples at a time in SSE. The lag of the correlation peak is the
+ * round trip in samples, including everything outside Voicemeeter: driver
+ * buffers, converters and the loopback cable.
+ *
+ * Runs are started with Trigger() and collected with Collect(); at most one
+ * is in flight.
+ */
+class LatencyProbe : public AudioProcessor {
+public:
+    struct Measurement {
+        bool detected = false;
+        uint32_t samples = 0;
+        double ms = 0.0;
+        float correlation = 0.0f;  ///< Normalized peak, 1 for an exact copy
+    };
+
+    LatencyProbe();
+
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    /**
+     * @brief Parses "<bus channel>:<input channel>", e.g. "0:0".
+     */
+    static bool ParsePath(const std::string& text, LatencyPath& path);
+
+    /**
+     * @brief Sets the channels. Call before the audio insert starts.
+     */
+    void SetPath(const LatencyPath& path) { path_ = path; }
+
+    void Prepare(uint32_t sampleRate, uint32_t frames) override;
+    void Process(const AudioBlock& block) override;
+
+    /**
+     * @brief Sends the marker with the next buffer. Safe from any thread.
+     * @return false before the stream started or while a run is in flight.
+     */
+    bool Trigger();
+
+    /**
+     * @brief Finds the marker in a finished capture and ends the run.
+     * @return false while the run is still capturing.
+     */
+    bool Collect(Measurement& measurement);
+
+    /**
+     * @brief Runs @p runs measurements against the live stream, LATENCY_RUN_GAP_MS apart.
+     * @return false if the stream stopped or the path does not exist.
+     */
+    bool Measure(uint32_t runs, std::vector<Measurement>& results);
+
+    /**
+     * @brief Logs the round trip and a jitter histogram of the detected runs.
+     * @return false if no run was detected.
+     */
+    static bool Report(const std::vector<Measurement>& results);
+
+    /**
+     * @brief Measures a synthetic loopback whose delay, gain and noise are
+     *        known, changing the delay by a few samples between runs, and
+     *        checks that every run comes out exact.
+     */
+    static bool Benchmark(uint32_t runs);
+
+private:
+    enum State : uint32_t {
+        IDLE,       ///< The measuring thread may trigger
+        ARMED,      ///< The audio thread starts with the next buffer
+        CAPTURING,  ///< Audio thread only
+        DONE        ///< The measuring thread may collect
+    };
+
+    LatencyPath path_;
+    float marker_[LATENCY_MARKER_LENGTH] = {};
+    double markerEnergy_ = 0.0;
+    std::vector<float> capture_;
+
+    std::atomic<uint32_t> state_{IDLE};
+    std::atomic<uint32_t> sampleRate_{0};
+    std::atomic<bool> pathMissing_{false};  ///< The stream has fewer channels than the path needs
+
+    // Audio thread only, handed over with state_
+    size_t captureFrames_ = 0;
+    size_t captureFill_ = 0;
+    size_t markerPosition_ = 0;
+};
@@ -0,0 +1,187 @@
+// ListenerList.h
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "Defconf.h"
+#include "InlineFunction.h"
+#include "ProfiledMutex.h"
+
+// Type definition for callback identifiers. Zero is never a valid ID.
+using CallbackID = unsigned int;
+
+/**
+ * @brief Copy-on-write list of event listeners with lock-free dispatch.
+ *
+ * Listeners live in immutable snapshots. Add and Remove build a new snapshot
+ * in a spare slot and publish it with an atomic pointer swap; Dispatch pins
+ * the current snapshot with a reader count and invokes it without taking any
+ * lock or allocating. A slow or re-entrant listener therefore never blocks
+ * registration, and listeners may add or remove listeners from inside a
+ * callback.
+ *
+ * Once Remove returns, the removed listener is no longer running on any
+ * thread, except when Remove is called from inside a dispatch on the calling
+ * thread (the listener may be the one currently executing).
+ *
+ * Capacity is fixed at MAX_CALLBACKS listeners. Each pinned snapshot holds
+ * a slot, so at most SNAPSHOT_COUNT - 2 threads may modify the list from
+ * inside callbacks at the same time; VoiceMirror dispatches each list from a
+ * single notification thread.
+ */
+template <typename... Args>
+class ListenerList {
+public:
+    using Callback = InlineFunction<void(Args...)>;
+
+    explicit ListenerList(const char* name) : writeMutex_(name) {
+        current_.store(&snapshots_[0], std::memory_order_release);
+    }
+
+    ListenerList(const ListenerList&) = delete;
+    ListenerList& operator=(const ListenerList&) = delete;
+
+    /**
+     * @brief Adds a listener.
+     * @return The new listener's ID, or 0 if the list is full.
+     */
+    CallbackID Add(Callback callback) {
+        std::lock_guard<ProfiledMutex> lock(writeMutex_);
+        const Snapshot* current = current_.load(std::memory_order_acquire);
+        if (current->count == MAX_CALLBACKS) {
+            return 0;
+        }
+
+        Snapshot* next = AcquireSpareSnapshot(current);
+        CopyEntries(*current, *next, 0);
+        next->entries[next->count].id = nextID_;
+        next->entries[next->count].callback = std::move(callback);
+        ++next->count;
+        current_.store(next, std::memory_order_seq_cst);
+        return nextID_++;
+    }
+
+    /**
+     * @brief Removes a listener and waits for in-flight dispatches to finish.
+     * @return true if the listener was registered.
+     */
+    bool Remove(CallbackID id) {
+        {
+            std::lock_guard<ProfiledMutex> lock(writeMutex_);
+            const Snapshot* current = current_.load(std::memory_order_acquire);
+            size_t position = current->count;
+            for (size_t i = 0; i < current->count; ++i) {
+                if (current->entries[i].id == id) {
+                    position = i;
+                    break;
+                }
+            }
+            if (position == current->count) {
+                return false;
+            }
+
+            Snapshot* next = AcquireSpareSnapshot(current);
+            CopyEntries(*current, *next, id);
+            current_.store(next, std::memory_order_seq_cst);
+        }
+
+        // Waiting inside a callback would wait on ourselves.
+        if (dispatchDepth_ == 0) {
+            WaitForRetiredReaders();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Invokes every listener of the current snapshot, in registration order.
+     */
+    void Dispatch(Args... args) const {
+        const Snapshot* snapshot = Pin();
+        ++dispatchDepth_;
+        for (size_t i = 0; i < snapshot->count; ++i) {
+            snapshot->entries[i].callback(args...);
+        }
+        --dispatchDepth_;
+        snapshot->readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    size_t Size() const { return current_.load(std::memory_order_acquire)->count; }
+
+private:
+    // One published snapshot plus spares for writers while readers drain.
+    static constexpr size_t SNAPSHOT_COUNT = 4;
+
+    struct Entry {
+        CallbackID id = 0;
+        Callback callback;
+    };
+
+    struct Snapshot {
+        std::array<Entry, MAX_CALLBACKS> entries;
+        size_t count = 0;
+        mutable std::atomic<uint32_t> readers{0};
+    };
+
+    const Snapshot* Pin() const {
+        const Snapshot* snapshot = current_.load(std::memory_order_seq_cst);
+        while (true) {
+            snapshot->readers.fetch_add(1, std::memory_order_seq_cst);
+            const Snapshot* check = current_.load(std::memory_order_seq_cst);
+            if (check == snapshot) {
+                return snapshot;
+            }
+            // A writer published in between; the old slot may be reused.
+            snapshot->readers.fetch_sub(1, std::memory_order_release);
+            snapshot = check;
+        }
+    }
+
+    // Caller holds writeMutex_.
+    Snapshot* AcquireSpareSnapshot(const Snapshot* current) {
+        while (true) {
+            for (Snapshot& candidate : snapshots_) {
+                if (&candidate != current && candidate.readers.load(std::memory_order_seq_cst) == 0) {
+                    return &candidate;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    static void CopyEntries(const Snapshot& source, Snapshot& destination, CallbackID skip) {
+        size_t count = 0;
+        for (size_t i = 0; i < source.count; ++i) {
+            if (source.entries[i].id != skip) {
+                destination.entries[count++] = source.entries[i];
+            }
+        }
+        for (size_t i = count; i < destination.entries.size(); ++i) {
+            destination.entries[i].id = 0;
+            destination.entries[i].callback = nullptr;
+        }
+        destination.count = count;
+    }
+
+    void WaitForRetiredReaders() const {
+        for (const Snapshot& snapshot : snapshots_) {
+            while (&snapshot != current_.load(std::memory_order_seq_cst) &&
+                   snapshot.readers.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    Snapshot snapshots_[SNAPSHOT_COUNT];
+    std::atomic<const Snapshot*> current_{nullptr};
+    ProfiledMutex writeMutex_;
+    CallbackID nextID_ = 1;
+
+    static thread_local int dispatchDepth_;
+};
+
+template <typename... Args>
+thread_local int ListenerList<Args...>::dispatchDepth_ = 0;
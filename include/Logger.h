@@ -9,14 +9,18 @@
 #include <string>
 #include <atomic>
 #include <string_view>
+#ifdef _WIN32
 #include "RAIIHandle.h"
+#endif
 #include "Defconf.h"
+#include "ProfiledMutex.h"
 
 /**
  * @brief Logger class to handle logging with different levels.
  *
  * The Logger class is implemented as a singleton to ensure consistent logging
- * across the application.
+ * across the application. Log() formats into a stack buffer and does not
+ * allocate, so it is safe to call from the steady-state sync path.
  */
 class Logger {
 public:
@@ -33,15 +37,19 @@ private:
     Logger();
     ~Logger();
 
-     char buffer_[512]; // Reduced buffer size
+    // Serializes writes so lines from different threads do not interleave
+    ProfiledMutex writeMutex_{"Logger::writeMutex_"};
 
     constexpr const char* LogLevelToString(LogLevel level) const;
-    WORD GetColorForLogLevel(LogLevel level) const;
 
     LogLevel logLevel;
     std::ofstream logFile;
     bool fileLoggingEnabled;
+#ifdef _WIN32
+    WORD GetColorForLogLevel(LogLevel level) const;
+
     RAIIHandle consoleHandle;
+#endif
 };
 
 #ifdef _DEBUG
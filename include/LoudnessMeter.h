@@ -0,0 +1,120 @@
+// LoudnessMeter.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "AudioInsert.h"
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+#include "TripleBuffer.h"
+
+/**
+ * @brief Loudness of every bus at the end of a 100 ms step.
+ */
+struct LoudnessReading {
+    uint32_t busCount = 0;
+    uint64_t steps = 0;  ///< Steps measured since the stream started or the last reset
+    float momentaryLufs[AUDIO_MAX_BUSES] = {};   ///< Last 400 ms
+    float shortTermLufs[AUDIO_MAX_BUSES] = {};   ///< Last 3 s
+    float integratedLufs[AUDIO_MAX_BUSES] = {};  ///< Gated, since the start or the last reset
+};
+
+/**
+ * @brief EBU R128 loudness of every bus, measured on the audio thread.
+ *
+ * Each bus channel is K-weighted with the two BS.1770 biquads, computed for
+ * the stream's sample rate. Channels are filtered four at a time in SSE
+ * lanes, so a Potato stream is 16 vector filters rather than 64 scalar
+ * ones. Squared samples are summed per 100 ms step and weighted per bus in
+ * 7.1 order (LFE left out, surrounds +1.5 dB).
+ *
+ * Momentary and short-term loudness come from a ring of the last 30 step
+ * energies. Integrated loudness keeps every 400 ms gating block, overlapping
+ * by 75 %, in a fixed histogram of 0.1 LU bins, so gating costs the same
+ * after an hour as after a second and nothing is allocated on the audio
+ * thread; block energies are summed per bin, so the only approximation is
+ * where the relative gate falls inside its bin.
+ *
+ * Readings are handed to other threads through a triple buffer after every
+ * step; Read() never waits on the audio thread.
+ */
+class LoudnessMeter : public AudioProcessor {
+public:
+    /**
+     * @brief The meter attached to the audio insert and exported as metrics.
+     */
+    static LoudnessMeter& Instance();
+
+    LoudnessMeter();
+
+    LoudnessMeter(const LoudnessMeter&) = delete;
+    LoudnessMeter& operator=(const LoudnessMeter&) = delete;
+
+    void Prepare(uint32_t sampleRate, uint32_t frames) override;
+    void Process(const AudioBlock& block) override;
+
+    /**
+     * @brief Copies the latest reading. Safe from any thread.
+     * @return false before the first step.
+     */
+    bool Read(LoudnessReading& reading);
+
+    /**
+     * @brief Restarts integrated loudness at the next step. Safe from any thread.
+     */
+    void Reset() { resetRequested_.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Exports Instance()'s momentary, short-term and integrated loudness per bus.
+     */
+    static void RegisterMetrics();
+
+private:
+    struct Biquad {
+        float b0 = 1.0f;
+        float b1 = 0.0f;
+        float b2 = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+    };
+
+    void Filter(const AudioBlock& block, uint32_t channels, uint32_t offset, uint32_t frames);
+    void FinishStep();
+    void ClearGating();
+    double StepMean(size_t bus, size_t steps) const;
+    float Integrated(size_t bus) const;
+
+    static float ToLufs(double energy);
+
+    // K-weighting for the current sample rate
+    Biquad shelf_;
+    Biquad highPass_;
+
+    // Filter state per channel: shelf z1, shelf z2, high-pass z1, high-pass z2
+    alignas(16) float state_[4][AUDIO_MAX_BUS_CHANNELS] = {};
+    // Filter output of the current four channels, one row each
+    alignas(16) float filtered_[4][LOUDNESS_FILTER_CHUNK_FRAMES] = {};
+
+    // Current step
+    double channelEnergy_[AUDIO_MAX_BUS_CHANNELS] = {};
+    uint32_t stepFrames_ = 0;  ///< 0 until prepared
+    uint32_t stepFill_ = 0;
+    uint32_t busCount_ = 0;
+
+    // Mean square of the last LOUDNESS_SHORT_TERM_STEPS steps per bus, newest at stepHead_ - 1
+    double stepEnergy_[AUDIO_MAX_BUSES][LOUDNESS_SHORT_TERM_STEPS] = {};
+    size_t stepHead_ = 0;
+    size_t stepCount_ = 0;
+    uint64_t steps_ = 0;
+
+    // Gating blocks above the absolute gate, per bus and 0.1 LU bin
+    uint32_t blockCounts_[AUDIO_MAX_BUSES][LOUDNESS_HISTOGRAM_BINS] = {};
+    double blockEnergy_[AUDIO_MAX_BUSES][LOUDNESS_HISTOGRAM_BINS] = {};
+    uint64_t gatedCount_[AUDIO_MAX_BUSES] = {};
+    double gatedEnergy_[AUDIO_MAX_BUSES] = {};
+
+    std::atomic<bool> resetRequested_{false};
+    TripleBuffer<LoudnessReading> readings_;
+    ProfiledMutex readMutex_{"LoudnessMeter::readMutex_"};  ///< Makes Read() the single consumer
+};
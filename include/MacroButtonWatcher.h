@@ -0,0 +1,129 @@
+// MacroButtonWatcher.h
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "HotkeyEngine.h"
+#include "InlineFunction.h"
+#include "ProfiledMutex.h"
+
+class VoicemeeterManager;
+
+using MacroButtonBits = std::bitset<MACRO_BUTTON_COUNT>;
+
+/**
+ * @brief One MacroButtons button and its action.
+ */
+struct MacroButtonBinding {
+    uint8_t button = 0;  ///< Logical button, 0 to MACRO_BUTTON_COUNT - 1
+    HotkeyAction action;
+};
+
+/**
+ * @brief Runs actions from MacroButtons buttons and keeps their lit state in sync.
+ *
+ * Every MACRO_POLL_INTERVAL_MS one executor command checks
+ * VBVMR_MacroButton_IsDirty, reads the bound buttons into a bitset only when
+ * it is set, and pushes all lit state corrections of the cycle together.
+ *
+ * Mute and midi bindings latch: the button state is the target state, so
+ * bind them to 2-position buttons. A mute changed elsewhere is lit back on
+ * its button. All other actions run when their button turns on; preset
+ * buttons light up one at a time, for the preset last recalled.
+ */
+class MacroButtonWatcher {
+public:
+    // Receives the action of a changed button and the button's new state.
+    using ActionSink = InlineFunction<void(const HotkeyAction&, bool)>;
+
+    MacroButtonWatcher(VoicemeeterManager& manager, ActionSink sink);
+    ~MacroButtonWatcher();
+
+    MacroButtonWatcher(const MacroButtonWatcher&) = delete;
+    MacroButtonWatcher& operator=(const MacroButtonWatcher&) = delete;
+
+    /**
+     * @brief Adds a binding; a later binding for the same button replaces the earlier one.
+     * @return false if the watcher is running, full, or the binding is invalid.
+     */
+    bool Bind(const MacroButtonBinding& binding);
+
+    /**
+     * @brief Parses "12=mute:input:0" style bindings; actions are the hotkey actions.
+     */
+    static bool ParseBinding(const std::string& text, MacroButtonBinding& binding);
+
+    size_t BindingCount() const { return bindings_.size(); }
+
+    bool Start();
+    void Stop();
+
+    /**
+     * @brief Buttons read when the dirty flag is set.
+     */
+    const MacroButtonBits& WatchedButtons() const { return watched_; }
+
+    /**
+     * @brief Parameter mirrored by each binding's lit state, in binding order; empty if none.
+     */
+    const std::vector<std::string>& TargetParameters() const { return parameters_; }
+
+    /**
+     * @brief Whether the next cycle must read the buttons even if they are not dirty.
+     */
+    bool NeedsButtonRead() const { return !buttonsKnown_; }
+
+    /**
+     * @brief Runs one cycle. Called by VoicemeeterManager on the executor thread.
+     *
+     * @param buttons Button states, or nullptr if they were not read this cycle.
+     * @param values Current value of each TargetParameters() entry; NaN if none or unreadable.
+     */
+    void Process(const MacroButtonBits* buttons, const float* values);
+
+    /**
+     * @brief Lit states to push, produced by the last Process().
+     */
+    const MacroButtonBits& WriteMask() const { return writeMask_; }
+    const MacroButtonBits& WriteValues() const { return writeValues_; }
+
+private:
+    struct Edge {
+        uint8_t binding;
+        bool on;
+    };
+
+    static constexpr uint8_t NO_BINDING = 0xFF;
+
+    void ThreadProc();
+    void UpdateLitStates(const float* values);
+
+    VoicemeeterManager& manager_;
+    ActionSink sink_;
+
+    std::vector<MacroButtonBinding> bindings_;
+    std::vector<std::string> parameters_;
+    std::vector<uint8_t> settleCycles_;
+    uint8_t slots_[MACRO_BUTTON_COUNT];
+    MacroButtonBits watched_;
+
+    // Cycle state. Only touched by Process().
+    MacroButtonBits state_;
+    bool buttonsKnown_ = false;
+    int selectedPreset_ = -1;
+    MacroButtonBits writeMask_;
+    MacroButtonBits writeValues_;
+
+    // Edges found by Process(), dispatched on the watcher thread
+    ProfiledMutex edgesMutex_{"MacroButtonWatcher::edgesMutex_"};
+    std::vector<Edge> edges_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,154 @@
+// Metrics.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "Defconf.h"
+#include "InlineFunction.h"
+
+/**
+ * @brief One exported value.
+ *
+ * Metrics sharing a name form one family and differ by a single label.
+ * Names, help texts and labels must be string literals or otherwise outlive
+ * the registry.
+ */
+class Metric {
+public:
+    enum class Type : uint8_t {
+        Counter,
+        Gauge
+    };
+
+    void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+
+    void Add(double delta) {
+        double previous = value_.load(std::memory_order_relaxed);
+        while (!value_.compare_exchange_weak(previous, previous + delta, std::memory_order_relaxed)) {
+        }
+    }
+
+    double Value() const { return value_.load(std::memory_order_relaxed); }
+
+    const char* Name() const { return name_; }
+    Type GetType() const { return type_; }
+
+private:
+    friend class MetricsRegistry;
+
+    const char* name_ = nullptr;
+    const char* help_ = nullptr;
+    const char* labelName_ = nullptr;
+    const char* labelValue_ = nullptr;
+    Type type_ = Type::Gauge;
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief Cumulative latency or size distribution over fixed bucket bounds.
+ *
+ * Observe() is lock-free and never allocates. Bounds are set at
+ * registration and must outlive the registry, like names.
+ */
+class Histogram {
+public:
+    void Observe(double value);
+
+    const char* Name() const { return name_; }
+
+private:
+    friend class MetricsRegistry;
+
+    const char* name_ = nullptr;
+    const char* help_ = nullptr;
+    const char* labelName_ = nullptr;
+    const char* labelValue_ = nullptr;
+    const double* bounds_ = nullptr;
+    size_t boundCount_ = 0;
+    std::atomic<uint64_t> buckets_[METRICS_MAX_BUCKETS + 1] = {};  ///< Per bucket, not cumulative; last is +Inf
+    std::atomic<double> sum_{0.0};
+};
+
+/**
+ * @brief Process-wide table of exported metrics.
+ *
+ * Metrics live in a fixed table, so updating a registered metric never
+ * locks or allocates. Collectors run before every snapshot to refresh
+ * values that are sampled rather than pushed (memory usage, for example).
+ * RenderText() produces the Prometheus text exposition format, either into
+ * a caller's buffer without allocating or as a string.
+ */
+class MetricsRegistry {
+public:
+    using Collector = InlineFunction<void()>;
+
+    static MetricsRegistry& Instance();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Returns the metric for @p name and label, creating it if needed.
+     * @return nullptr if the table is full.
+     */
+    Metric* Register(const char* name, const char* help, Metric::Type type,
+                     const char* labelName = nullptr, const char* labelValue = nullptr);
+
+    Metric* Gauge(const char* name, const char* help,
+                  const char* labelName = nullptr, const char* labelValue = nullptr) {
+        return Register(name, help, Metric::Type::Gauge, labelName, labelValue);
+    }
+
+    Metric* Counter(const char* name, const char* help,
+                    const char* labelName = nullptr, const char* labelValue = nullptr) {
+        return Register(name, help, Metric::Type::Counter, labelName, labelValue);
+    }
+
+    /**
+     * @brief Returns the histogram for @p name and label, creating it if needed.
+     * @param bounds Ascending upper bounds, at most METRICS_MAX_BUCKETS.
+     * @return nullptr if the table is full or the bounds are invalid.
+     */
+    Histogram* RegisterHistogram(const char* name, const char* help, const double* bounds, size_t boundCount,
+                                 const char* labelName = nullptr, const char* labelValue = nullptr);
+
+    /**
+     * @brief Adds a callable run by Collect().
+     * @return false if the collector table is full.
+     */
+    bool AddCollector(Collector collector);
+
+    /**
+     * @brief Runs every collector.
+     */
+    void Collect();
+
+    /**
+     * @brief Collects and renders all metrics in Prometheus text format.
+     */
+    std::string RenderText();
+
+    /**
+     * @brief Collects and renders all metrics into @p buffer without allocating.
+     * @param length Receives the number of bytes written.
+     * @return false if the text did not fit; @p length then covers what did.
+     */
+    bool RenderText(char* buffer, size_t capacity, size_t& length);
+
+private:
+    MetricsRegistry() = default;
+
+    std::mutex registerMutex_;
+    Metric metrics_[METRICS_MAX_COUNT];
+    std::atomic<size_t> count_{0};
+    Histogram histograms_[METRICS_MAX_HISTOGRAMS];
+    std::atomic<size_t> histogramCount_{0};
+
+    std::mutex collectMutex_;
+    Collector collectors_[METRICS_MAX_COLLECTORS];
+    size_t collectorCount_ = 0;
+};
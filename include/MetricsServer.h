@@ -0,0 +1,80 @@
+// MetricsServer.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "Metrics.h"
+
+/**
+ * @brief Minimal HTTP/1.1 endpoint serving MetricsRegistry to Prometheus.
+ *
+ * Binds 127.0.0.1 only. One thread accepts one connection at a time, reads
+ * the request head and answers GET /metrics with the text exposition format
+ * and GET /history with VolumeHistory CSV; every response closes the
+ * connection. The request, header and body
+ * buffers are sized once in Start(), so a scrape does not allocate.
+ */
+class MetricsServer {
+public:
+    struct Stats {
+        uint64_t scrapes = 0;
+        uint64_t rejected = 0;    ///< Malformed, unknown path or method, or timed out
+        uint64_t truncated = 0;   ///< Exposition text larger than METRICS_RENDER_BUFFER_BYTES
+        uint64_t allocatingScrapes = 0;  ///< Allocation-tracking builds only
+        uint64_t historyQueries = 0;
+    };
+
+    MetricsServer();
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Binds the TCP port on 127.0.0.1 and starts the server thread.
+     * @param port TCP port; 0 picks a free one (see Port()).
+     */
+    bool Start(uint16_t port);
+    void Stop();
+
+    uint16_t Port() const { return port_; }
+    Stats GetStats() const;
+
+    /**
+     * @brief Scrapes a local server the given number of times, checks every
+     *        response and reports scrape latency.
+     */
+    static bool Benchmark(uint32_t scrapes);
+
+private:
+    void ThreadProc();
+    void Serve(uintptr_t client);
+    void ServeHistory(uintptr_t client, const char* query, size_t queryLength);
+
+    // Reads the request head into request_; returns its length, or 0 if none arrived.
+    size_t ReadRequest(uintptr_t client);
+    void Respond(uintptr_t client, const char* status, const char* body, size_t bodyLength);
+
+    uintptr_t socket_;
+    uint16_t port_ = 0;
+
+    std::vector<char> request_;
+    std::vector<char> body_;
+    char header_[METRICS_HTTP_HEADER_BYTES];
+
+    Metric* scrapeCounter_;
+    Histogram* renderDuration_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> scrapes_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> truncated_{0};
+    std::atomic<uint64_t> allocatingScrapes_{0};
+    std::atomic<uint64_t> historyQueries_{0};
+};
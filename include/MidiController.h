@@ -0,0 +1,312 @@
+// MidiController.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+
+/**
+ * @brief One decoded MIDI message.
+ */
+struct MidiEvent {
+    enum class Kind : uint8_t {
+        ControlChange,  ///< 7-bit value; 14-bit pairs are joined by the mapping.
+        Nrpn,           ///< 14-bit value from data entry CC 6/38.
+        PitchBend,      ///< 14-bit value.
+        Note            ///< 127 on note on, 0 on note off.
+    };
+
+    Kind kind = Kind::ControlChange;
+    uint8_t channel = 0;   ///< 0-15
+    uint16_t number = 0;   ///< CC, NRPN parameter or note number; 0 for pitch bend.
+    uint16_t value = 0;
+};
+
+/**
+ * @brief Streaming MIDI byte decoder.
+ *
+ * Handles running status, skips SysEx and system messages, ignores realtime
+ * bytes wherever they appear, and assembles NRPN parameter selection and
+ * data entry per channel. Messages split across reads are completed on the
+ * next call.
+ */
+class MidiDecoder {
+public:
+    MidiDecoder();
+
+    /**
+     * @brief Decodes bytes and appends complete messages to @p events.
+     */
+    void Decode(const uint8_t* bytes, size_t length, std::vector<MidiEvent>& events);
+
+private:
+    void Emit(std::vector<MidiEvent>& events);
+
+    static constexpr uint16_t NO_NRPN = 0xFFFF;
+
+    uint8_t status_ = 0;  ///< Running status; 0 when data bytes have no status to belong to.
+    uint8_t data_[2] = {};
+    uint8_t count_ = 0;
+    bool inSysex_ = false;
+
+    uint16_t nrpnParameter_[16];
+    uint8_t nrpnDataMsb_[16] = {};
+};
+
+/**
+ * @brief Control on the MIDI device that drives a mapping.
+ */
+struct MidiSource {
+    enum class Kind : uint8_t {
+        ControlChange,    ///< cc:<ch>:<n>
+        ControlChange14,  ///< cc14:<ch>:<n>, MSB on CC n and LSB on CC n+32
+        Nrpn,             ///< nrpn:<ch>:<parameter>
+        PitchBend,        ///< bend:<ch>
+        Note              ///< note:<ch>:<n>
+    };
+
+    Kind kind = Kind::ControlChange;
+    uint8_t channel = 0;   ///< 0-15
+    uint16_t number = 0;
+};
+
+/**
+ * @brief Mixer parameter a mapping drives.
+ */
+struct MidiTarget {
+    enum class Field : uint8_t {
+        Gain,  ///< Fader across DEFAULT_MIN_DBM..DEFAULT_MAX_DBM, with soft takeover.
+        Mute   ///< Toggled on every press.
+    };
+
+    Field field = Field::Gain;
+    ChannelType channelType = ChannelType::Input;
+    uint8_t index = 0;
+};
+
+struct MidiMapping {
+    MidiSource source;
+    MidiTarget target;
+};
+
+class MidiController;
+
+/**
+ * @brief Where MIDI cycles run: Voicemeeter, or the byte-stream fake.
+ *
+ * RunCycle() reads the bytes received since the previous cycle and the
+ * current value of every TargetParameters() entry, calls
+ * MidiController::Process() once, then applies its script and sends its
+ * feedback, so a cycle costs one pass over the device however many
+ * messages arrived.
+ */
+class MidiPort {
+public:
+    virtual ~MidiPort() = default;
+
+    virtual bool RunCycle(MidiController& controller) = 0;
+
+    /**
+     * @brief Returns once no cycle started by RunCycle() can still touch the controller.
+     */
+    virtual void Close() {}
+};
+
+/**
+ * @brief Maps MIDI controls to strip and bus parameters.
+ *
+ * A cycle thread runs every MIDI_POLL_INTERVAL_MS. Within a cycle only the
+ * last value of each control is written, as one VBVMR_SetParameters script.
+ *
+ * Faders use soft takeover: after the parameter changes elsewhere, a fader
+ * is ignored until it reaches or crosses the mixer value, so it never makes
+ * the gain jump. Parameters changed elsewhere are also sent back to the
+ * controller, for motor faders and LEDs; values that came from the
+ * controller are not echoed.
+ */
+class MidiController {
+public:
+    /**
+     * @brief Cycle counters.
+     */
+    struct Stats {
+        uint64_t cycles = 0;
+        uint64_t bytes = 0;
+        uint64_t events = 0;
+        uint64_t writes = 0;
+        uint64_t feedbackBytes = 0;
+        uint64_t takeoverHolds = 0;  ///< Fader moves ignored until pickup.
+    };
+
+    MidiController();
+    ~MidiController();
+
+    MidiController(const MidiController&) = delete;
+    MidiController& operator=(const MidiController&) = delete;
+
+    /**
+     * @brief Adds a mapping; a later mapping of the same control replaces the earlier one.
+     * @return false if the controller is running, full, or the mapping is invalid.
+     */
+    bool AddMapping(const MidiMapping& mapping);
+
+    /**
+     * @brief Parses "cc:1:7=gain:input:0" style mappings.
+     *
+     * Sources: cc:<ch>:<n>, cc14:<ch>:<0-31>, nrpn:<ch>:<0-16383>, bend:<ch>,
+     * note:<ch>:<n>, with channels 1-16. Targets: gain|mute:<input|output>:<index>.
+     */
+    static bool ParseMapping(const std::string& text, MidiMapping& mapping);
+
+    size_t MappingCount() const { return mappings_.size(); }
+
+    /**
+     * @brief Parameter name read for each mapping, in mapping order ("Strip[0].Gain").
+     */
+    const std::vector<std::string>& TargetParameters() const { return parameters_; }
+
+    /**
+     * @brief Starts the cycle thread on @p port.
+     */
+    bool Start(MidiPort& port);
+
+    /**
+     * @brief Stops the cycle thread and waits until the port is done with the controller.
+     */
+    void Stop();
+
+    /**
+     * @brief Enables or disables mapping; while disabled, incoming messages are drained and ignored.
+     */
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Runs one cycle. Called by the port, on the thread that owns the device.
+     *
+     * @param input Bytes received since the previous cycle.
+     * @param values Current value of each TargetParameters() entry; NaN if unreadable.
+     */
+    void Process(const uint8_t* input, size_t length, const float* values);
+
+    /**
+     * @brief Parameter script produced by the last Process(); may be empty.
+     */
+    const std::string& Script() const { return script_; }
+
+    /**
+     * @brief Feedback bytes produced by the last Process(); may be empty.
+     */
+    const std::vector<uint8_t>& Feedback() const { return feedback_; }
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Measures decoding throughput and end-to-end latency against the
+     *        byte-stream fake and logs the results.
+     * @param messages Number of messages to decode.
+     * @return true if every message decoded to the control and value that was sent.
+     */
+    static bool Benchmark(uint32_t messages);
+
+private:
+    // Per-mapping cycle state. Only touched by Process().
+    struct MappingState {
+        float known = 0.0f;        ///< Mixer value in parameter units (dB or 0/1).
+        bool knownValid = false;
+        float pending = 0.0f;      ///< Control position this cycle, 0..1.
+        bool dirty = false;
+        bool pickedUp = false;
+        float lastControl = -1.0f; ///< Previous control position, -1 if none yet.
+        uint8_t msb = 0;           ///< Last CC14 MSB.
+        bool pressed = false;
+        bool feedbackDue = false;
+        uint8_t settleCycles = 0;  ///< Cycles left for a written value to read back.
+    };
+
+    static constexpr uint8_t NO_MAPPING = 0xFF;
+
+    void ThreadProc();
+    void ObserveValues(const float* values);
+    void ApplyEvent(const MidiEvent& event);
+    void ApplyControl(size_t slot, float position);
+    size_t WriteScript();
+    void WriteFeedback();
+
+    float ToPosition(size_t slot, float value) const;
+    float FromPosition(size_t slot, float position) const;
+
+    std::vector<MidiMapping> mappings_;
+    std::vector<std::string> parameters_;
+    std::vector<MappingState> states_;
+
+    // Lookup from a message to its mapping slot
+    uint8_t controlTable_[16][128];
+    uint8_t noteTable_[16][128];
+    uint8_t bendTable_[16];
+
+    MidiDecoder decoder_;
+    std::vector<MidiEvent> events_;
+    std::string script_;
+    std::vector<uint8_t> feedback_;
+    uint64_t cycleHolds_ = 0;
+
+    // Thread state
+    MidiPort* port_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> enabled_{true};
+
+    mutable ProfiledMutex statsMutex_{"MidiController::statsMutex_"};
+    Stats stats_;
+};
+
+/**
+ * @brief In-memory MIDI port with a simulated mixer, for benchmarks.
+ *
+ * Bytes injected from any thread are delivered on the next cycle; scripts
+ * are applied to the simulated parameter values, and the time from
+ * injection to application is recorded.
+ */
+class ByteStreamMidiPort : public MidiPort {
+public:
+    explicit ByteStreamMidiPort(const std::vector<std::string>& parameters);
+
+    void Inject(const uint8_t* bytes, size_t length);
+
+    /**
+     * @brief Changes a simulated parameter as if it was moved on the mixer.
+     */
+    void SetValue(size_t index, float value);
+    float GetValue(size_t index) const;
+
+    bool RunCycle(MidiController& controller) override;
+
+    uint64_t AppliedScripts() const;
+    double MeanLatencyMs() const;
+    double MaxLatencyMs() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void ApplyScript(const std::string& script);
+
+    std::vector<std::string> parameters_;
+
+    mutable ProfiledMutex mutex_{"ByteStreamMidiPort::mutex_"};
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> input_;
+    std::vector<float> values_;
+    std::vector<float> snapshot_;
+    Clock::time_point firstPending_;
+    uint64_t scripts_ = 0;
+    uint64_t latencySamples_ = 0;
+    double latencyTotalMs_ = 0.0;
+    double latencyMaxMs_ = 0.0;
+};
@@ -0,0 +1,142 @@
+// MirrorState.h
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "VolumeUtils.h"
+
+/**
+ * @brief Volume mirroring decision logic, free of any I/O.
+ *
+ * VolumeMirror feeds samples from either side into these transition
+ * functions under a short lock and performs the returned action after
+ * releasing it. Every accepted change bumps the state generation; samples
+ * and actions tagged with an older generation are stale and are discarded.
+ */
+namespace MirrorLogic {
+
+/**
+ * @brief Last known state of both sides of the mirror.
+ */
+struct State {
+    float lastVmVolume = 0.0f;
+    bool lastVmMute = false;
+    float lastWinVolume = 0.0f;
+    bool lastWinMute = false;
+
+    // Voicemeeter debounce: a change must be seen on two consecutive polls
+    float pendingVmVolume = 0.0f;
+    bool pendingVmMute = false;
+    bool vmChangePending = false;
+
+    uint64_t generation = 0;
+};
+
+/**
+ * @brief I/O to perform once the state lock has been released.
+ */
+struct Action {
+    enum class Kind : uint8_t {
+        None,
+        UpdateVoicemeeter,
+        UpdateWindows
+    };
+
+    Kind kind = Kind::None;
+    float volume = 0.0f;
+    bool mute = false;
+    bool playSyncSound = false;
+    uint64_t generation = 0;
+};
+
+inline float RoundVolume(float volume) {
+    return std::round(volume * 100.0f) / 100.0f;
+}
+
+inline Action MakeAction(State& state, Action::Kind kind, float volume, bool mute, bool playSyncSound) {
+    Action action;
+    action.kind = kind;
+    action.volume = volume;
+    action.mute = mute;
+    action.playSyncSound = playSyncSound;
+    action.generation = ++state.generation;
+    return action;
+}
+
+/**
+ * @brief Applies a Windows volume sample (notification or poll).
+ *
+ * Updates the Windows side and, if Voicemeeter differs, returns an action
+ * pushing the new value to Voicemeeter. The Voicemeeter side is recorded as
+ * already updated so the echo from the next poll is ignored.
+ */
+inline Action ApplyWindowsSample(State& state, float volume, bool mute) {
+    volume = RoundVolume(volume);
+
+    if (VolumeUtils::IsFloatEqual(volume, state.lastWinVolume) && mute == state.lastWinMute) {
+        return Action{};
+    }
+
+    state.lastWinVolume = volume;
+    state.lastWinMute = mute;
+
+    if (VolumeUtils::IsFloatEqual(volume, state.lastVmVolume) && mute == state.lastVmMute) {
+        return Action{};
+    }
+
+    state.lastVmVolume = volume;
+    state.lastVmMute = mute;
+    state.vmChangePending = false;
+    return MakeAction(state, Action::Kind::UpdateVoicemeeter, volume, mute, false);
+}
+
+/**
+ * @brief Applies a Voicemeeter poll result.
+ *
+ * A change has to be observed on two consecutive polls before it is mirrored
+ * to Windows. Both sides are recorded as updated so the Windows echo is
+ * ignored.
+ */
+inline Action ApplyVoicemeeterSample(State& state, float volume, bool mute) {
+    volume = RoundVolume(volume);
+
+    if (VolumeUtils::IsFloatEqual(volume, state.lastVmVolume) && mute == state.lastVmMute) {
+        state.vmChangePending = false;
+        return Action{};
+    }
+
+    if (!state.vmChangePending ||
+        !VolumeUtils::IsFloatEqual(volume, state.pendingVmVolume) || mute != state.pendingVmMute) {
+        state.pendingVmVolume = volume;
+        state.pendingVmMute = mute;
+        state.vmChangePending = true;
+        return Action{};
+    }
+
+    state.vmChangePending = false;
+    state.lastVmVolume = volume;
+    state.lastVmMute = mute;
+    state.lastWinVolume = volume;
+    state.lastWinMute = mute;
+    return MakeAction(state, Action::Kind::UpdateWindows, volume, mute, true);
+}
+
+/**
+ * @brief Pushes the Windows state to Voicemeeter even if nothing changed.
+ *
+ * Used to repair a Voicemeeter channel that was changed behind the mirror's
+ * back, e.g. while it was not being polled. Any pending Voicemeeter change
+ * is dropped in favour of Windows.
+ */
+inline Action ForceResync(State& state, float volume, bool mute) {
+    volume = RoundVolume(volume);
+    state.lastWinVolume = volume;
+    state.lastWinMute = mute;
+    state.lastVmVolume = volume;
+    state.lastVmMute = mute;
+    state.vmChangePending = false;
+    return MakeAction(state, Action::Kind::UpdateVoicemeeter, volume, mute, false);
+}
+
+}  // namespace MirrorLogic
@@ -0,0 +1,40 @@
+// MixerConnection.h
+#pragma once
+
+#include <string>
+
+#include "Defconf.h"
+#include "Scene.h"
+
+/**
+ * @brief Parameter read and write interface of a Voicemeeter instance.
+ *
+ * Implemented by VoicemeeterManager for the local DLL session and by
+ * VbanTextClient for a Voicemeeter on another machine, so the mirror and
+ * the OSC server work against either. Writes are queued and never wait.
+ */
+class MixerConnection {
+public:
+    virtual ~MixerConnection() = default;
+
+    /**
+     * @brief Reads the volume percentage and mute state of a strip or bus.
+     * @return false if the state is unavailable.
+     */
+    virtual bool GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) = 0;
+
+    /**
+     * @brief Queues a volume percentage and mute state for a strip or bus.
+     */
+    virtual void UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) = 0;
+
+    /**
+     * @brief Queues a VBVMR_SetParameters script. Scripts run in submission order.
+     */
+    virtual void ApplyParameterScript(const std::string& script) = 0;
+
+    /**
+     * @brief Reads gains, mutes, routing and labels of every strip and bus.
+     */
+    virtual bool CaptureScene(Scene& scene) = 0;
+};
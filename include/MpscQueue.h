@@ -0,0 +1,87 @@
+// MpscQueue.h
+#pragma once
+
+#include <atomic>
+
+/**
+ * @brief Intrusive link embedded in every node pushed through an MpscQueue.
+ */
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+/**
+ * @brief Intrusive lock-free multi-producer single-consumer queue.
+ *
+ * Based on Dmitry Vyukov's node-based MPSC algorithm. Push() is wait-free
+ * and may be called from any thread; Pop() must only be called from the
+ * single consumer thread. Pop() can transiently return nullptr while a
+ * producer is between its two stores, so consumers should be woken again
+ * after every push (see VoicemeeterExecutor).
+ *
+ * @tparam T Node type, must derive from MpscNode. The queue never owns nodes.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Appends a node to the queue. Safe to call from any thread.
+     */
+    void Push(T* node) {
+        PushNode(static_cast<MpscNode*>(node));
+    }
+
+    /**
+     * @brief Removes the oldest node, or returns nullptr if none is ready.
+     *
+     * Consumer thread only.
+     */
+    T* Pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_) {
+            if (!next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // A producer has swapped head_ but not linked its node yet.
+            return nullptr;
+        }
+
+        PushNode(&stub_);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+private:
+    void PushNode(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    MpscNode stub_;
+    std::atomic<MpscNode*> head_;  // Producers swap in here.
+    MpscNode* tail_;               // Consumer-owned.
+};
@@ -0,0 +1,307 @@
+// OscServer.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+#include "Scene.h"
+
+/**
+ * @brief One OSC message, pointing into the datagram it was read from.
+ */
+struct OscMessage {
+    const char* address = nullptr;     ///< NUL-terminated
+    size_t addressLength = 0;
+    const char* typeTags = "";         ///< Argument types, without the leading ','
+    const uint8_t* arguments = nullptr;
+    const uint8_t* end = nullptr;
+
+    /**
+     * @brief Reads the first argument as a float; accepts f, d, i, h, T and F.
+     */
+    bool FirstFloat(float& value) const;
+};
+
+/**
+ * @brief Zero-copy OSC 1.0 packet parser.
+ *
+ * Messages are visited in order, bundles are descended into, and nothing is
+ * copied: every OscMessage points into the caller's buffer. Bundle time tags
+ * are ignored; their messages run on arrival.
+ */
+class OscParser {
+public:
+    /**
+     * @brief Calls visit(const OscMessage&) for every message in a packet.
+     * @return false if the packet, or a bundle element in it, is malformed.
+     */
+    template <typename Visitor>
+    static bool Parse(const uint8_t* data, size_t length, Visitor&& visit, int depth = 0);
+
+    /**
+     * @brief Parses a single message.
+     */
+    static bool ParseMessage(const uint8_t* data, size_t length, OscMessage& message);
+
+    static bool IsBundle(const uint8_t* data, size_t length);
+
+    static constexpr size_t BUNDLE_HEADER_SIZE = 16;  ///< "#bundle\0" and the time tag
+};
+
+/**
+ * @brief OSC address space compiled into a trie of path segments.
+ *
+ * Literal addresses resolve with one comparison per segment; patterns with
+ * *, ?, [...] and {a,b} walk every branch their segments match.
+ */
+class OscRouter {
+public:
+    static constexpr uint16_t NO_TARGET = 0xFFFF;
+
+    OscRouter();
+
+    /**
+     * @brief Adds a literal address ("/strip/0/gain") for a target id.
+     */
+    void Add(const std::string& address, uint16_t target);
+
+    /**
+     * @brief Calls visit(uint16_t target) for every address the pattern matches.
+     * @return Number of matches.
+     */
+    template <typename Visitor>
+    size_t Match(const char* pattern, size_t length, Visitor&& visit) const;
+
+    /**
+     * @brief Matches one segment against an OSC pattern segment.
+     */
+    static bool MatchSegment(const char* pattern, const char* patternEnd, const char* text, const char* textEnd);
+
+private:
+    struct Node {
+        std::string segment;
+        uint16_t target = NO_TARGET;
+        uint16_t firstChild = NO_TARGET;
+        uint16_t nextSibling = NO_TARGET;
+    };
+
+    template <typename Visitor>
+    size_t MatchFrom(uint16_t node, const char* pattern, const char* end, Visitor& visit) const;
+
+    std::vector<Node> nodes_;
+};
+
+/**
+ * @brief Mixer the OSC server reads and writes.
+ */
+class OscBackend {
+public:
+    virtual ~OscBackend() = default;
+
+    /**
+     * @brief Applies a parameter script built from client writes. Must not block.
+     */
+    virtual void Apply(const std::string& script) = 0;
+
+    /**
+     * @brief Reads the gains and mutes sent back to clients.
+     */
+    virtual bool Read(Scene& scene) = 0;
+};
+
+/**
+ * @brief UDP OSC server for control surfaces such as TouchOSC.
+ *
+ * Addresses, for strips and buses 0-7:
+ *   /strip/<n>/gain    dB
+ *   /strip/<n>/volume  0..1, the mirror's volume mapping
+ *   /strip/<n>/mute    0 or 1
+ *   /bus/<n>/...       the same for buses
+ *   /subscribe         no-op, registers the sender
+ *
+ * One thread owns the socket. It drains every datagram waiting, keeps only
+ * the last value written to each parameter and applies them as one script.
+ * Every sender is subscribed to feedback: every OSC_FEEDBACK_INTERVAL_MS the
+ * changed values are sent to each client as one bundle, skipping controls
+ * the client itself is still moving.
+ */
+class OscServer {
+public:
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t messages = 0;
+        uint64_t malformed = 0;
+        uint64_t unmatched = 0;
+        uint64_t scripts = 0;
+        uint64_t feedbackPackets = 0;
+        uint64_t feedbackMessages = 0;
+        size_t clients = 0;
+    };
+
+    explicit OscServer(OscBackend& backend);
+    ~OscServer();
+
+    OscServer(const OscServer&) = delete;
+    OscServer& operator=(const OscServer&) = delete;
+
+    /**
+     * @brief Binds the UDP port and starts the server thread.
+     * @param port UDP port; 0 picks a free one (see Port()).
+     * @param loopbackOnly Bind 127.0.0.1 instead of every interface.
+     */
+    bool Start(uint16_t port, bool loopbackOnly = false);
+    void Stop();
+
+    uint16_t Port() const { return port_; }
+    Stats GetStats() const;
+
+    /**
+     * @brief Drives the server over localhost UDP against a simulated mixer,
+     *        reports throughput and feedback rate, and checks the final state.
+     * @param messages Number of messages to send.
+     */
+    static bool Benchmark(uint32_t messages);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Field : uint8_t { Gain, Volume, Mute };
+
+    struct Target {
+        Field field;
+        uint8_t channel;  ///< Strips first, then buses
+    };
+
+    struct Client {
+        bool active = false;
+        uint32_t address = 0;  ///< IPv4, network byte order
+        uint16_t port = 0;     ///< Network byte order
+        Clock::time_point lastSeen;
+        bool needsFullState = true;
+    };
+
+    static constexpr size_t CHANNELS = SCENE_MAX_STRIPS + SCENE_MAX_BUSES;
+    static constexpr size_t NO_CLIENT = OSC_MAX_CLIENTS;
+
+    void ThreadProc();
+    size_t Subscribe(uint32_t address, uint16_t port, Clock::time_point now);
+    void HandlePacket(const uint8_t* data, size_t length, size_t client, Clock::time_point now);
+    void HandleMessage(const OscMessage& message, size_t client, Clock::time_point now);
+    void ApplyPending();
+    void SendFeedback(Clock::time_point now);
+    void SendBundle(const Client& client, const std::vector<uint8_t>& bundle);
+
+    static float ValueOf(const Scene& scene, const Target& target);
+
+    OscBackend& backend_;
+    OscRouter router_;
+    std::vector<Target> targets_;
+    std::vector<std::string> addresses_;
+
+    // Server thread state
+    uintptr_t socket_;
+    uint16_t port_ = 0;
+    Client clients_[OSC_MAX_CLIENTS];
+    float pendingGain_[CHANNELS] = {};
+    uint8_t pendingMute_[CHANNELS] = {};
+    bool gainDirty_[CHANNELS] = {};
+    bool muteDirty_[CHANNELS] = {};
+    size_t holdClient_[CHANNELS][2];            ///< Level and mute writer
+    Clock::time_point holdUntil_[CHANNELS][2];
+    std::vector<float> values_;                 ///< Values read this feedback cycle
+    std::vector<float> sent_;                   ///< Last value sent per target, NaN if none
+    std::string script_;
+    std::vector<uint8_t> bundle_;
+    Scene scene_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    Stats cycleStats_;  ///< Counted by the server thread, published once per loop
+
+    mutable ProfiledMutex statsMutex_{"OscServer::statsMutex_"};
+    Stats stats_;
+};
+
+template <typename Visitor>
+bool OscParser::Parse(const uint8_t* data, size_t length, Visitor&& visit, int depth) {
+    if (!IsBundle(data, length)) {
+        OscMessage message;
+        if (!ParseMessage(data, length, message)) {
+            return false;
+        }
+        visit(static_cast<const OscMessage&>(message));
+        return true;
+    }
+    if (depth >= OSC_MAX_BUNDLE_DEPTH) {
+        return false;
+    }
+
+    size_t offset = BUNDLE_HEADER_SIZE;
+    while (offset < length) {
+        if (length - offset < 4) {
+            return false;
+        }
+        const uint8_t* sizeBytes = data + offset;
+        uint32_t size = (static_cast<uint32_t>(sizeBytes[0]) << 24) | (static_cast<uint32_t>(sizeBytes[1]) << 16) |
+                        (static_cast<uint32_t>(sizeBytes[2]) << 8) | sizeBytes[3];
+        offset += 4;
+        if (size == 0 || size % 4 != 0 || size > length - offset ||
+            !Parse(data + offset, size, visit, depth + 1)) {
+            return false;
+        }
+        offset += size;
+    }
+    return true;
+}
+
+template <typename Visitor>
+size_t OscRouter::Match(const char* pattern, size_t length, Visitor&& visit) const {
+    if (length == 0 || pattern[0] != '/') {
+        return 0;
+    }
+    return MatchFrom(0, pattern + 1, pattern + length, visit);
+}
+
+template <typename Visitor>
+size_t OscRouter::MatchFrom(uint16_t node, const char* pattern, const char* end, Visitor& visit) const {
+    const char* segmentEnd = static_cast<const char*>(std::memchr(pattern, '/', static_cast<size_t>(end - pattern)));
+    bool last = segmentEnd == nullptr;
+    if (last) {
+        segmentEnd = end;
+    }
+    bool literal = true;
+    for (const char* c = pattern; c < segmentEnd && literal; ++c) {
+        literal = *c != '*' && *c != '?' && *c != '[' && *c != '{';
+    }
+
+    size_t matches = 0;
+    for (uint16_t child = nodes_[node].firstChild; child != NO_TARGET; child = nodes_[child].nextSibling) {
+        const std::string& segment = nodes_[child].segment;
+        bool matched = literal
+            ? segment.size() == static_cast<size_t>(segmentEnd - pattern) && std::memcmp(segment.data(), pattern, segment.size()) == 0
+            : MatchSegment(pattern, segmentEnd, segment.data(), segment.data() + segment.size());
+        if (!matched) {
+            continue;
+        }
+        if (last) {
+            if (nodes_[child].target != NO_TARGET) {
+                visit(nodes_[child].target);
+                ++matches;
+            }
+        } else {
+            matches += MatchFrom(child, segmentEnd + 1, end, visit);
+        }
+        if (literal) {
+            break;  // Siblings are unique
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,65 @@
+// PhaseTimer.h
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+#include "Logger.h"
+
+/**
+ * @brief Wall-clock timing of the consecutive phases of one operation.
+ *
+ * Each Mark() closes the phase that started at the previous mark (or at
+ * construction). Report() logs all phases and the total on one debug line;
+ * unlike LOG_DEBUG it is not compiled out of release builds, so --debug
+ * shows timings there too.
+ */
+class PhaseTimer {
+public:
+    static constexpr size_t MAX_PHASES = 8;
+
+    explicit PhaseTimer(const char* operation)
+        : operation_(operation), start_(Clock::now()), last_(start_) {}
+
+    void Mark(const char* phase) {
+        Clock::time_point now = Clock::now();
+        if (count_ < MAX_PHASES) {
+            phases_[count_].name = phase;
+            phases_[count_].ms = std::chrono::duration<double, std::milli>(now - last_).count();
+            ++count_;
+        }
+        last_ = now;
+    }
+
+    double TotalMs() const {
+        return std::chrono::duration<double, std::milli>(last_ - start_).count();
+    }
+
+    void Report() const {
+        char line[LOG_MESSAGE_LENGTH];
+        int length = std::snprintf(line, sizeof(line), "[PhaseTimer::Report] %s:", operation_);
+        for (size_t i = 0; i < count_ && length > 0 && static_cast<size_t>(length) < sizeof(line); ++i) {
+            length += std::snprintf(line + length, sizeof(line) - length, " %s %.1f ms,",
+                                    phases_[i].name, phases_[i].ms);
+        }
+        if (length > 0 && static_cast<size_t>(length) < sizeof(line)) {
+            std::snprintf(line + length, sizeof(line) - length, " total %.1f ms.", TotalMs());
+        }
+        Logger::Instance().Log(LogLevel::DEBUG, line);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        const char* name = "";
+        double ms = 0.0;
+    };
+
+    const char* operation_;
+    Clock::time_point start_;
+    Clock::time_point last_;
+    Phase phases_[MAX_PHASES];
+    size_t count_ = 0;
+};
@@ -0,0 +1,171 @@
+// ProfiledMutex.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Contention statistics for one named lock.
+ *
+ * All instances constructed with the same name share one entry.
+ */
+struct LockStats {
+    const char* name = nullptr;
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> waitNs{0};
+    std::atomic<uint64_t> maxWaitNs{0};
+    std::atomic<uint64_t> holdNs{0};
+    std::atomic<uint64_t> maxHoldNs{0};
+};
+
+/**
+ * @brief Registry of named lock statistics.
+ *
+ * Entries live in a fixed table so registering and recording never
+ * allocate. Recording only happens in builds configured with
+ * VOICEMIRROR_PROFILE_LOCKS and while the profiler is enabled.
+ */
+class LockProfiler {
+public:
+    // About 30 locks are registered today; leave room before the table fills.
+    static constexpr size_t MAX_LOCKS = 64;
+
+    static LockProfiler& Instance();
+
+    LockProfiler(const LockProfiler&) = delete;
+    LockProfiler& operator=(const LockProfiler&) = delete;
+
+    /**
+     * @brief Returns the entry for @p name, creating it if needed.
+     * @return nullptr if the table is full. The first name that does not fit
+     *         is reported on stderr, since the logger's own lock registers
+     *         here, and Report() repeats the count.
+     */
+    LockStats* Register(const char* name);
+
+    /**
+     * @brief Number of registrations that did not fit in the table.
+     */
+    size_t Unprofiled() const { return unprofiled_.load(std::memory_order_relaxed); }
+
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Logs one line per lock, most contended first.
+     */
+    void Report() const;
+
+    /**
+     * @brief Clears all counters, keeping registered names.
+     */
+    void Reset();
+
+    static void RecordMax(std::atomic<uint64_t>& target, uint64_t value) {
+        uint64_t previous = target.load(std::memory_order_relaxed);
+        while (value > previous &&
+               !target.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    LockProfiler() = default;
+
+    std::mutex registerMutex_;
+    LockStats locks_[MAX_LOCKS];
+    std::atomic<size_t> count_{0};
+    std::atomic<size_t> unprofiled_{0};
+    std::atomic<bool> enabled_{true};
+};
+
+/**
+ * @brief Drop-in replacement for std::mutex that reports contention.
+ *
+ * Without VOICEMIRROR_PROFILE_LOCKS this is a plain std::mutex and the name
+ * is ignored. With it, every acquisition records wait time, hold time and
+ * whether the lock was contended under the given name.
+ */
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* name)
+#ifdef VOICEMIRROR_PROFILE_LOCKS
+        : stats_(LockProfiler::Instance().Register(name))
+#endif
+    {
+        (void)name;
+    }
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+#ifdef VOICEMIRROR_PROFILE_LOCKS
+    void lock() {
+        if (!stats_ || !LockProfiler::Instance().IsEnabled()) {
+            mutex_.lock();
+            acquiredAt_ = Clock::time_point();
+            return;
+        }
+
+        Clock::time_point waitStart = Clock::now();
+        if (!mutex_.try_lock()) {
+            stats_->contended.fetch_add(1, std::memory_order_relaxed);
+            mutex_.lock();
+        }
+        acquiredAt_ = Clock::now();
+        RecordAcquisition(ToNanoseconds(acquiredAt_ - waitStart));
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            if (stats_) {
+                stats_->contended.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+
+        acquiredAt_ = Clock::time_point();
+        if (stats_ && LockProfiler::Instance().IsEnabled()) {
+            acquiredAt_ = Clock::now();
+            RecordAcquisition(0);
+        }
+        return true;
+    }
+
+    void unlock() {
+        if (acquiredAt_ != Clock::time_point()) {
+            uint64_t held = ToNanoseconds(Clock::now() - acquiredAt_);
+            stats_->holdNs.fetch_add(held, std::memory_order_relaxed);
+            LockProfiler::RecordMax(stats_->maxHoldNs, held);
+        }
+        mutex_.unlock();
+    }
+#else
+    void lock() { mutex_.lock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+#endif
+
+private:
+    std::mutex mutex_;
+
+#ifdef VOICEMIRROR_PROFILE_LOCKS
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t ToNanoseconds(Clock::duration duration) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    void RecordAcquisition(uint64_t waited) {
+        stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        stats_->waitNs.fetch_add(waited, std::memory_order_relaxed);
+        LockProfiler::RecordMax(stats_->maxWaitNs, waited);
+    }
+
+    LockStats* stats_;
+    Clock::time_point acquiredAt_;  // Only touched by the owning thread.
+#endif
+};
@@ -0,0 +1,104 @@
+// Scene.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Defconf.h"
+
+/**
+ * @brief Captured state of one strip or bus.
+ */
+struct ChannelSnapshot {
+    float gainDb = 0.0f;
+    uint16_t routing = 0;  ///< Strips only: A1..A5 in bits 0-4, B1..B3 in bits 5-7.
+    uint8_t mute = 0;
+    uint8_t reserved = 0;
+    char label[SCENE_LABEL_LENGTH] = {};
+};
+
+/**
+ * @brief Mixer scene: gains, mutes, routing and labels of every strip and bus.
+ *
+ * Plain fixed-size data, written to disk as is.
+ */
+struct Scene {
+    uint8_t voicemeeterType = 0;  ///< VOICEMEETER_BASIC, _BANANA or _POTATO; 0 if not captured.
+    uint8_t stripCount = 0;
+    uint8_t busCount = 0;
+    uint8_t reserved = 0;
+    ChannelSnapshot strips[SCENE_MAX_STRIPS];
+    ChannelSnapshot buses[SCENE_MAX_BUSES];
+};
+
+/**
+ * @brief Strip, bus and routing counts of one Voicemeeter edition.
+ */
+struct SceneLayout {
+    uint8_t voicemeeterType = 0;  ///< x64 editions fold onto their 32-bit type.
+    uint8_t stripCount = 0;
+    uint8_t busCount = 0;
+    uint8_t physicalBuses = 0;    ///< A1..An routing buttons per strip.
+    uint8_t virtualBuses = 0;     ///< B1..Bn routing buttons per strip.
+};
+
+namespace SceneLogic {
+
+/**
+ * @brief Layout for a VBVMR_GetVoicemeeterType() value; voicemeeterType is 0 if unknown.
+ */
+SceneLayout GetLayout(long voicemeeterType);
+
+/**
+ * @brief Routing bit of the n-th routing button of a strip (A buttons first, then B).
+ */
+int RoutingBit(const SceneLayout& layout, int button);
+
+/**
+ * @brief Parameter name of a routing bit ("A1".."A5", "B1".."B3").
+ */
+const char* RoutingField(int bit);
+
+/**
+ * @brief Copies a label of @p length bytes into a snapshot.
+ *
+ * Quotes become apostrophes and semicolons commas, so the label cannot end
+ * its statement in a recall script. Labels too long for the snapshot are cut
+ * at a UTF-8 character boundary.
+ */
+void CopyLabel(char (&label)[SCENE_LABEL_LENGTH], const char* source, size_t length);
+
+/**
+ * @brief Appends the VBVMR_SetParameters statements that turn current into target.
+ *
+ * Only parameters that differ are written. Both scenes must share a layout.
+ *
+ * @return Number of parameters in the script.
+ */
+size_t BuildRecallScript(const Scene& current, const Scene& target, std::string& script);
+
+/**
+ * @brief Applies gain, mute, routing and label statements of a script to a scene.
+ *
+ * Stands in for Voicemeeter in simulations; other statements are ignored.
+ */
+void ApplyScript(Scene& scene, const std::string& script);
+
+/**
+ * @brief Potato scene for simulations. The flipped scene differs from the
+ *        unflipped one in every mute, routing and label; gains differ by the offset.
+ */
+Scene MakeSimulatedScene(float gainOffset, bool flip);
+
+/**
+ * @brief Writes a scene file with a header and checksum.
+ */
+bool Save(const std::string& path, const Scene& scene);
+
+/**
+ * @brief Reads and validates a scene file.
+ */
+bool Load(const std::string& path, Scene& scene);
+
+}  // namespace SceneLogic
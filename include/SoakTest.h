@@ -0,0 +1,61 @@
+// SoakTest.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "FootprintReporter.h"
+#include "ListenerList.h"
+#include "MirrorState.h"
+#include "VoicemeeterExecutor.h"
+
+/**
+ * @brief Long-running footprint check against a simulated backend.
+ *
+ * Drives the same machinery a live session uses (mirror decision logic,
+ * executor command traffic with merging, listener dispatch and churn,
+ * logging and metrics) against an in-memory stand-in for Voicemeeter and
+ * the Windows endpoint, sampling the process footprint as it goes. The run
+ * fails if the footprint keeps growing after warm-up or exceeds the budget.
+ */
+class SoakTest {
+public:
+    /**
+     * @param minutes Run duration.
+     * @param budgetMB Private-bytes budget in MiB; 0 disables it.
+     * @param running Cleared by the console handler to end the run early.
+     */
+    SoakTest(uint16_t minutes, uint16_t budgetMB, const std::atomic<bool>& running);
+
+    SoakTest(const SoakTest&) = delete;
+    SoakTest& operator=(const SoakTest&) = delete;
+
+    /**
+     * @return EXIT_SUCCESS if the footprint stayed bounded, EXIT_FAILURE otherwise.
+     */
+    int Run();
+
+private:
+    // In-memory stand-in for one Voicemeeter channel, touched on the executor thread only.
+    struct SimulatedChannel {
+        float volume = 0.0f;
+        bool mute = false;
+    };
+
+    void Tick();
+    bool Evaluate() const;
+
+    uint16_t minutes_;
+    uint16_t budgetMB_;
+    const std::atomic<bool>& running_;
+
+    VoicemeeterExecutor executor_;
+    ListenerList<float, bool> listeners_{"SoakTest::listeners_"};
+    MirrorLogic::State state_;
+    SimulatedChannel channel_;
+    std::vector<Footprint> samples_;
+    uint64_t ticks_ = 0;
+    uint64_t dispatched_ = 0;
+    bool withinBudget_ = true;
+};
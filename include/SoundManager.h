@@ -7,9 +7,10 @@
 #include <mutex>
 #include <string>
 #include <thread>
-#include <vector>
 
 #include "Logger.h"
+#include "ProfiledMutex.h"
+#include "RAIIHandle.h"
 
 class SoundManager {
    public:
@@ -34,14 +35,29 @@ class SoundManager {
    private:
     SoundManager() = default;  // Private constructor for singleton
 
-    // Helper method to play sound
+    // Helper method to play sound. Asynchronous playback keeps a pointer to
+    // soundFilePath, so it must be one of the stored paths.
     bool PlaySoundInternal(const std::wstring& soundFilePath, uint16_t delayMs, bool playSync);
 
+    // Plays a sound on the calling thread
+    void PlayNow(const std::wstring& soundFilePath, uint16_t delayMs, bool playSync);
+
+    // Plays queued asynchronous sounds so callers never spawn threads
+    void PlaybackThreadProc();
+
+    // Starts the playback thread on first use
+    bool EnsurePlaybackThread();
+
     // Mutex for thread-safe operations
-    std::mutex playMutex_;
+    ProfiledMutex playMutex_{"SoundManager::playMutex_"};
 
-    // To keep track of asynchronous sound threads
-    std::vector<std::thread> asyncThreads_;
+    // Asynchronous playback thread and its pending request. Requests made
+    // while one is pending are coalesced into a single playback.
+    std::thread playbackThread_;
+    RAIIHandle playbackEvent_;
+    std::atomic<const std::wstring*> pendingSound_{nullptr};
+    std::atomic<uint16_t> pendingDelayMs_{0};
+    std::atomic<bool> playbackReady_{false};
 
     // Atomic flag to manage shutdown
     std::atomic<bool> shuttingDown_{false};
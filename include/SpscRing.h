@@ -0,0 +1,96 @@
+// SpscRing.h
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Lock-free single-producer single-consumer ring of elements.
+ *
+ * Storage is allocated once in the constructor, rounded up to a power of
+ * two so positions wrap with a mask. Positions only ever grow; the
+ * producer writes elements at WritePosition() + n through At() and makes
+ * them visible with Commit(), the consumer takes contiguous runs with
+ * Contiguous() and hands them back with Release(). Neither side waits,
+ * allocates or makes system calls, so the producer may be a real-time
+ * thread.
+ *
+ * @tparam T Element type; must be trivially copyable.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t minimumCapacity) {
+        capacity_ = 1;
+        while (capacity_ < minimumCapacity) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        buffer_.reset(new T[capacity_]());
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t Capacity() const { return capacity_; }
+
+    /**
+     * @brief Element at an absolute position, wrapped into the ring.
+     */
+    T& At(size_t position) { return buffer_[position & mask_]; }
+
+    // Producer side
+
+    size_t WritePosition() const { return head_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Elements that can be written without overtaking the consumer.
+     */
+    size_t Free() const {
+        return capacity_ - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Publishes @p count elements written after WritePosition().
+     */
+    void Commit(size_t count) {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Consumer side
+
+    size_t ReadPosition() const { return tail_.load(std::memory_order_relaxed); }
+
+    size_t Available() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Longest run of readable elements that does not wrap.
+     * @param count Set to the length of the run, 0 if the ring is empty.
+     */
+    const T* Contiguous(size_t& count) const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t start = tail & mask_;
+        count = (std::min)(head_.load(std::memory_order_acquire) - tail, capacity_ - start);
+        return &buffer_[start];
+    }
+
+    /**
+     * @brief Gives @p count read elements back to the producer.
+     */
+    void Release(size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    std::unique_ptr<T[]> buffer_;
+
+    // Each side writes its own line only.
+    alignas(64) std::atomic<size_t> head_{0};  ///< Next position the producer writes
+    alignas(64) std::atomic<size_t> tail_{0};  ///< Next position the consumer reads
+};
@@ -0,0 +1,94 @@
+// StateCache.h
+#pragma once
+
+#include <windows.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "Defconf.h"
+#include "ProfiledMutex.h"
+#include "RAIIHandle.h"
+
+/**
+ * @brief Last known mirror state persisted in a small memory-mapped file.
+ *
+ * The file holds the last synchronized volume and mute together with the
+ * channel mapping and device assignments they belong to. Updates are plain
+ * stores into the mapped view and never block on disk; a background thread
+ * coalesces them into at most one FlushViewOfFile per flush interval.
+ *
+ * On startup the cached volume is applied to whichever side comes up first
+ * so the mixer does not jump while the other side is still starting, and
+ * VolumeMirror's initial sync reconciles the two once both are ready.
+ */
+class StateCache {
+public:
+    static StateCache& Instance();
+
+    StateCache(const StateCache&) = delete;
+    StateCache& operator=(const StateCache&) = delete;
+
+    /**
+     * @brief Maps the state file, creating it if needed, and validates its content.
+     * @return true if the file is mapped; cached state may still be unusable.
+     */
+    bool Open(const Config& config);
+
+    /**
+     * @brief Flushes pending updates and unmaps the file.
+     */
+    void Close();
+
+    /**
+     * @brief Cached volume, if the file was valid and written for the current channel mapping.
+     */
+    bool GetRestorableVolume(float& volumePercent, bool& isMuted) const;
+
+    /**
+     * @brief Records a volume both sides agree on. Never allocates or touches the disk.
+     */
+    void RecordVolume(float volumePercent, bool isMuted);
+
+private:
+    StateCache() = default;
+    ~StateCache();
+
+    // On-disk layout. Fixed size and plain data so it can be mapped directly.
+    struct CachedState {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t size;
+        uint64_t savedAtMs;  // Unix time of the last update
+        float volumePercent;
+        uint8_t isMuted;
+        uint8_t channelIndex;
+        uint8_t channelType;
+        uint8_t voicemeeterType;
+        char monitorDeviceUUID[DEVICE_ID_LENGTH];
+        char toggleParam[32];
+        uint32_t checksum;   // Over every preceding byte; detects torn writes
+    };
+
+    static uint32_t Checksum(const CachedState& state);
+    void FlushThreadProc();
+
+    RAIIHandle file_;
+    RAIIHandle mapping_;
+    CachedState* view_ = nullptr;
+
+    // Mapping and assignments from the current configuration.
+    CachedState current_ = {};
+
+    bool restorable_ = false;
+    float restoredVolume_ = 0.0f;
+    bool restoredMute_ = false;
+
+    ProfiledMutex writeMutex_{"StateCache::writeMutex_"};
+    RAIIHandle flushEvent_;
+    std::thread flushThread_;
+    std::atomic<bool> dirty_{false};
+    std::atomic<bool> stopping_{false};
+};
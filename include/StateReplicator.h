@@ -0,0 +1,197 @@
+// StateReplicator.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Defconf.h"
+#include "Metrics.h"
+#include "ProfiledMutex.h"
+
+/**
+ * @brief Replicated volume and mute, stamped by the write that produced it.
+ */
+struct ReplicaState {
+    uint64_t lamport = 0;  ///< 0 until the first write anywhere
+    uint32_t origin = 0;   ///< Instance that wrote it; breaks Lamport ties
+    float volumePercent = 0.0f;
+    bool isMuted = false;
+};
+
+/**
+ * @brief Last-writer-wins rules and wire format, free of any I/O.
+ */
+namespace ReplicaLogic {
+
+enum class PacketType : uint8_t {
+    Delta = 1,     ///< A local change, sent once
+    Snapshot = 2   ///< Full state, sent periodically and to peers found behind
+};
+
+// "VMR1", type, mute, 2 reserved, sender, origin, sequence, Lamport time, volume; little-endian
+constexpr size_t PACKET_SIZE = 4 + 1 + 1 + 2 + 4 + 4 + 4 + 8 + 4;
+
+struct Packet {
+    PacketType type = PacketType::Delta;
+    uint32_t sender = 0;    ///< Instance that sent the packet, not necessarily the writer
+    uint32_t sequence = 0;  ///< Per sender, for loss accounting
+    ReplicaState state;
+};
+
+/**
+ * @brief Whether a was written after b: higher Lamport time, then higher origin.
+ */
+inline bool Newer(const ReplicaState& a, const ReplicaState& b) {
+    return a.lamport != b.lamport ? a.lamport > b.lamport : a.origin > b.origin;
+}
+
+void Encode(const Packet& packet, uint8_t* out);
+bool Decode(const uint8_t* data, size_t length, Packet& packet);
+
+}  // namespace ReplicaLogic
+
+/**
+ * @brief Shares the mirrored volume and mute with VoiceMirror on other machines.
+ *
+ * Every change both sides of the local mirror agree on is stamped with a
+ * Lamport time and this instance's random origin ID and sent once as a
+ * delta, to the configured peers or to a multicast group. Received states
+ * are merged last-writer-wins on (Lamport time, origin), so all instances
+ * settle on the same value whatever order packets arrive in. Each instance
+ * also sends its full state every anti-entropy interval, and answers a
+ * packet carrying an older state with its own, which repairs lost deltas
+ * and brings restarted instances up to date.
+ *
+ * Loops are suppressed at both ends: packets are never forwarded, packets
+ * from this origin are ignored, and a local change that matches a remote
+ * state applied within REPLICA_ECHO_WINDOW_MS (the mirror reporting it
+ * back) is not sent, even if a newer remote state arrived in between.
+ */
+class StateReplicator {
+public:
+    struct Stats {
+        uint64_t deltasSent = 0;     ///< Packets, one per peer and change
+        uint64_t snapshotsSent = 0;  ///< Including replies to peers found behind
+        uint64_t received = 0;
+        uint64_t applied = 0;        ///< Received states that won
+        uint64_t stale = 0;          ///< Received states older than ours
+        uint64_t echoes = 0;         ///< Local changes not sent: unchanged, or echoes of remote states
+        uint64_t malformed = 0;
+        uint64_t lost = 0;           ///< Dropped by the benchmark's simulated loss
+    };
+
+    /**
+     * @brief The replicator the mirror records into.
+     */
+    static StateReplicator& Instance();
+
+    StateReplicator();
+    ~StateReplicator();
+
+    StateReplicator(const StateReplicator&) = delete;
+    StateReplicator& operator=(const StateReplicator&) = delete;
+
+    /**
+     * @brief Called on the replicator thread with a remote state that won. Set before Start().
+     */
+    std::function<void(float volumePercent, bool isMuted)> onRemoteVolume;
+
+    /**
+     * @brief Binds the UDP port and starts the replicator thread.
+     * @param port UDP port; 0 picks a free one (see Port()).
+     * @param peers host or host:port of each peer, port defaulting to ours.
+     * @param group Multicast group joined on port and sent to; empty for none.
+     */
+    bool Start(uint16_t port, const std::vector<std::string>& peers, const std::string& group,
+               uint32_t antiEntropyIntervalMs = REPLICA_ANTI_ENTROPY_INTERVAL_MS);
+    void Stop();
+
+    /**
+     * @brief Adds a unicast peer while running.
+     */
+    bool AddPeer(const std::string& peer);
+
+    /**
+     * @brief Records a volume both sides of the local mirror agree on.
+     *
+     * Safe from any thread and a no-op while stopped. Never allocates.
+     */
+    void RecordVolume(float volumePercent, bool isMuted);
+
+    /**
+     * @return false if no instance has written a state yet.
+     */
+    bool GetState(ReplicaState& state) const;
+
+    uint16_t Port() const { return port_; }
+    uint32_t Origin() const { return origin_; }
+    Stats GetStats() const;
+
+    /**
+     * @brief Runs several instances on loopback with simulated packet loss,
+     *        measures convergence time and packet rates, and checks that
+     *        echoes of remote states are never sent again.
+     */
+    static bool Benchmark(uint32_t instances);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // A remote state handed to onRemoteVolume; the mirror reports it back as a local change.
+    struct RemoteApply {
+        float volumePercent = 0.0f;
+        bool isMuted = false;
+        Clock::time_point at;
+    };
+
+    bool IsEcho(float volumePercent, bool isMuted, Clock::time_point now) const;
+    void ThreadProc();
+    void Receive();
+    void Merge(const ReplicaLogic::Packet& packet, const void* from);
+
+    // Sends a packet with the current state to every peer, or to one address.
+    void Broadcast(ReplicaLogic::PacketType type, const ReplicaState& state);
+    void SendTo(ReplicaLogic::PacketType type, const ReplicaState& state, const void* address);
+
+    uintptr_t socket_;
+    uint16_t port_ = 0;
+    uint32_t origin_ = 0;
+    std::chrono::milliseconds antiEntropyInterval_{REPLICA_ANTI_ENTROPY_INTERVAL_MS};
+    std::atomic<uint32_t> sequence_{0};
+
+    // Peers, or the multicast group as the only entry
+    mutable ProfiledMutex peerMutex_{"StateReplicator::peerMutex_"};
+    uint8_t peers_[REPLICA_MAX_PEERS][16];  ///< sockaddr_in
+    size_t peerCount_ = 0;
+
+    mutable ProfiledMutex stateMutex_{"StateReplicator::stateMutex_"};
+    ReplicaState state_;
+    uint64_t lamport_ = 0;  ///< Highest Lamport time seen
+    RemoteApply remoteApplies_[REPLICA_ECHO_HISTORY];
+    size_t remoteApplyNext_ = 0;
+
+    // Benchmark only: share of received packets dropped, and the generator deciding which
+    uint32_t lossPercent_ = 0;
+    uint32_t lossSeed_ = 1;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> deltasSent_{0};
+    std::atomic<uint64_t> snapshotsSent_{0};
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> applied_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> echoes_{0};
+    std::atomic<uint64_t> malformed_{0};
+    std::atomic<uint64_t> lost_{0};
+
+    Metric* deltaCounter_ = nullptr;
+    Metric* snapshotCounter_ = nullptr;
+    Metric* appliedCounter_ = nullptr;
+};
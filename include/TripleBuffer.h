@@ -0,0 +1,71 @@
+// TripleBuffer.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single-producer single-consumer latest-value exchange.
+ *
+ * The producer fills WriteBuffer() and calls Publish(); the consumer calls
+ * Read() and gets the most recently published value. Neither side ever
+ * waits or allocates: each owns one of three slots, and Publish()/Read()
+ * swap their slot with the shared middle one in a single atomic exchange.
+ * Values published between two reads are overwritten, never queued, which
+ * suits meters read at a lower rate than they are produced.
+ *
+ * @tparam T Value type, copied into the three slots.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief Slot the next Publish() hands over. Producer only.
+     *
+     * Holds whatever the consumer last released, not the previous value.
+     */
+    T& WriteBuffer() { return slots_[write_].value; }
+
+    /**
+     * @brief Makes WriteBuffer() the latest value. Producer only.
+     */
+    void Publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(write_ | FRESH), std::memory_order_acq_rel);
+        write_ = static_cast<uint8_t>(previous & INDEX);
+    }
+
+    /**
+     * @brief Latest published value. Consumer only.
+     *
+     * Valid until the next Read().
+     * @return nullptr if nothing was published yet.
+     */
+    const T* Read() {
+        if (middle_.load(std::memory_order_acquire) & FRESH) {
+            uint8_t previous = middle_.exchange(read_, std::memory_order_acq_rel);
+            read_ = static_cast<uint8_t>(previous & INDEX);
+            published_ = true;
+        }
+        return published_ ? &slots_[read_].value : nullptr;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;  ///< Set in middle_ until the consumer takes it
+
+    // One cache line each, so the two sides never share a line they write.
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    Slot slots_[3];
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t write_ = 0;  ///< Producer's slot
+    alignas(64) uint8_t read_ = 2;   ///< Consumer's slot
+    bool published_ = false;
+};
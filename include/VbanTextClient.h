@@ -0,0 +1,205 @@
+// VbanTextClient.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "Defconf.h"
+#include "MixerConnection.h"
+#include "ProfiledMutex.h"
+#include "Scene.h"
+
+/**
+ * @brief VBAN packet header, as sent on the wire (little-endian).
+ */
+struct VbanHeader {
+    char magic[4];           ///< "VBAN"
+    uint8_t formatSR;        ///< Sub-protocol in the top 3 bits, rate index below
+    uint8_t formatNbs;
+    uint8_t formatNbc;
+    uint8_t formatBit;
+    char streamName[VBAN_STREAM_NAME_LENGTH];
+    uint32_t frame;          ///< Per-stream packet counter
+};
+
+namespace VbanProtocol {
+
+constexpr uint8_t PROTOCOL_MASK = 0xE0;
+constexpr uint8_t PROTOCOL_TEXT = 0x40;
+constexpr uint8_t PROTOCOL_SERVICE = 0x60;
+constexpr uint8_t TEXT_UTF8 = 0x10;
+constexpr uint8_t SERVICE_RTPACKET_REGISTER = 32;
+constexpr uint8_t SERVICE_RTPACKET = 33;
+
+/**
+ * @brief Index of a VBAN-TEXT bit rate in the protocol's rate table.
+ * @return -1 if the rate is not one the protocol defines.
+ */
+int TextRateIndex(uint32_t bitsPerSecond);
+
+/**
+ * @brief Fills a header; the stream name is truncated to 16 bytes.
+ */
+void FillHeader(VbanHeader& header, uint8_t formatSR, uint8_t nbs, uint8_t nbc, uint8_t bit,
+                const char* streamName, uint32_t frame);
+
+/**
+ * @brief Checks the magic and size of a received datagram.
+ */
+bool ReadHeader(const uint8_t* data, size_t length, VbanHeader& header);
+
+}  // namespace VbanProtocol
+
+/**
+ * @brief Controls a Voicemeeter on another machine over VBAN.
+ *
+ * Writes go out as VBAN-TEXT: parameter scripts are queued, split at
+ * statement boundaries into packets of at most VBAN_MAX_PACKET_SIZE bytes,
+ * numbered with the stream's frame counter and paced with a token bucket to
+ * the bit rate the remote incoming stream is set to. Volume updates are
+ * merged per channel and sent ahead of queued scripts.
+ *
+ * State comes back through the VBAN service protocol: the client registers
+ * for RT packets and keeps the latest T_VBAN_VMRT_PACKET as a Scene. A
+ * volume written locally is reported until an RT packet shows it (or
+ * VBAN_WRITE_SETTLE_MS passes), so the mirror never sees its own write
+ * undone by a packet that was already on its way.
+ *
+ * One thread owns the socket; public methods may be called from any thread.
+ */
+class VbanTextClient : public MixerConnection {
+public:
+    struct Stats {
+        uint64_t packets = 0;            ///< VBAN-TEXT packets sent
+        uint64_t bytes = 0;              ///< Including headers
+        uint64_t statements = 0;
+        uint64_t droppedStatements = 0;  ///< Queue full, or longer than a packet
+        uint64_t rtPackets = 0;
+        uint64_t malformed = 0;          ///< Datagrams received that were not RT packets
+    };
+
+    VbanTextClient();
+    ~VbanTextClient() override;
+
+    VbanTextClient(const VbanTextClient&) = delete;
+    VbanTextClient& operator=(const VbanTextClient&) = delete;
+
+    /**
+     * @brief Opens the socket and starts the client thread.
+     * @param host IPv4 address or name of the machine running Voicemeeter.
+     * @param port VBAN UDP port of that machine.
+     * @param streamName Name of the remote incoming VBAN-TEXT stream.
+     * @param bitsPerSecond Rate of that stream; must be a VBAN-TEXT rate.
+     */
+    bool Start(const std::string& host, uint16_t port, const std::string& streamName, uint32_t bitsPerSecond);
+    void Stop();
+
+    /**
+     * @brief Waits for the first RT packet.
+     * @return false if none arrived within the timeout.
+     */
+    bool WaitForState(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Returns once everything queued before the call has been sent.
+     */
+    bool WaitForQueuedText(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Script text queued and not sent yet.
+     */
+    size_t QueuedBytes() const;
+
+    Stats GetStats() const;
+
+    // MixerConnection
+    bool GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) override;
+    void UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) override;
+    void ApplyParameterScript(const std::string& script) override;
+    bool CaptureScene(Scene& scene) override;
+
+    /**
+     * @brief Converts an RT packet payload into a scene.
+     * @return false if the payload is too short or from an unknown edition.
+     */
+    static bool DecodeRtPacket(const uint8_t* payload, size_t length, Scene& scene);
+
+    /**
+     * @brief Encodes a scene as an RT packet payload; used by the stand-in receiver.
+     * @return Payload size.
+     */
+    static size_t EncodeRtPacket(const Scene& scene, uint8_t* payload, size_t capacity);
+
+    /**
+     * @brief Drives the client against a local UDP stand-in receiver, checks
+     *        sequence numbers, pacing and the final state, and reports throughput.
+     * @param statements Number of parameter statements to send.
+     */
+    static bool Benchmark(uint32_t statements);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SIDES = 2;  ///< Indexed by ChannelType
+    static constexpr size_t CHANNELS = SCENE_MAX_STRIPS > SCENE_MAX_BUSES ? SCENE_MAX_STRIPS : SCENE_MAX_BUSES;
+
+    struct VolumeWrite {
+        bool queued = false;    ///< Not sent yet
+        bool settling = false;  ///< Sent or queued, not yet seen in an RT packet
+        float volumePercent = 0.0f;
+        bool isMuted = false;
+        Clock::time_point settleUntil;
+    };
+
+    void ThreadProc();
+    void Receive(Clock::time_point now);
+    void Register(Clock::time_point now);
+    void SendPending(Clock::time_point now);
+
+    // Copies merged volume writes and then queued statements that fit in capacity
+    // bytes of text into packet_, after the header. Returns the text length.
+    size_t FillPacket(size_t capacity, Clock::time_point now, uint64_t& statements);
+
+    // Applies unconfirmed writes on top of the remote state. Caller holds stateMutex_.
+    void OverlayWrites(Scene& scene, Clock::time_point now);
+
+    static size_t AppendVolumeStatements(char* out, size_t capacity, size_t channel, ChannelType type, const VolumeWrite& write);
+
+    // Socket and pacing, client thread only
+    uintptr_t socket_;
+    uint32_t remoteIp_ = 0;     ///< IPv4, network byte order
+    uint16_t remotePort_ = 0;   ///< Network byte order
+    std::string streamName_;
+    uint8_t rateIndex_ = 0;
+    double bytesPerSecond_ = 0.0;
+    double tokens_ = 0.0;
+    Clock::time_point lastRefill_;
+    Clock::time_point nextRegister_;
+    uint32_t frame_ = 0;
+    uint8_t packet_[VBAN_MAX_PACKET_SIZE];
+
+    // Outgoing text
+    mutable ProfiledMutex queueMutex_{"VbanTextClient::queueMutex_"};
+    std::string queue_;       ///< Complete statements, each ending in ';'
+    size_t queueHead_ = 0;    ///< Sent up to here; compacted when the queue drains
+
+    // Remote state and writes not yet confirmed by it
+    mutable ProfiledMutex stateMutex_{"VbanTextClient::stateMutex_"};
+    Scene remote_;
+    bool haveState_ = false;
+    Clock::time_point stateTime_;
+    VolumeWrite writes_[SIDES][CHANNELS];
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> statements_{0};
+    std::atomic<uint64_t> droppedStatements_{0};
+    std::atomic<uint64_t> rtPackets_{0};
+    std::atomic<uint64_t> malformed_{0};
+};
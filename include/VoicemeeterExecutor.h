@@ -0,0 +1,362 @@
+// VoicemeeterExecutor.h
+#pragma once
+
+#include <windows.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Defconf.h"
+#include "InlineFunction.h"
+#include "Logger.h"
+#include "MpscQueue.h"
+#include "RAIIHandle.h"
+
+/**
+ * @brief Dedicated thread that owns every VoicemeeterRemote DLL call.
+ *
+ * Any thread may submit a command; commands travel through a lock-free MPSC
+ * queue and run one at a time on the executor thread, so the DLL session is
+ * only ever touched from one place. Results come back through std::future.
+ *
+ * Adjacent queued commands that share a non-zero merge key are collapsed:
+ * only the newest one reaches the DLL and the older ones complete as
+ * superseded. Every command carries a deadline; commands still queued past
+ * their deadline are dropped, and a watchdog thread reports commands that
+ * stall inside the DLL past theirs.
+ *
+ * Execute() and Post() use a fixed pool of preallocated commands whenever
+ * the callable and its result are small enough, so steady-state traffic
+ * does not touch the heap. Submit() always allocates its promise.
+ */
+class VoicemeeterExecutor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Snapshot of executor counters.
+     */
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t executed = 0;
+        uint64_t merged = 0;
+        uint64_t expired = 0;
+        uint64_t stalls = 0;
+        uint64_t waitTimeouts = 0;
+        uint64_t poolMisses = 0;
+    };
+
+    VoicemeeterExecutor();
+    ~VoicemeeterExecutor();
+
+    VoicemeeterExecutor(const VoicemeeterExecutor&) = delete;
+    VoicemeeterExecutor& operator=(const VoicemeeterExecutor&) = delete;
+
+    /**
+     * @brief Starts the executor and watchdog threads.
+     * @return true if the threads are running.
+     */
+    bool Start();
+
+    /**
+     * @brief Stops both threads. Commands still queued complete as cancelled.
+     *
+     * Waits at most VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS for a command inside
+     * the DLL. If it has not returned by then, the executor thread is left
+     * behind: it finishes the queued commands whenever the DLL returns, so the
+     * executor and everything those commands capture must stay alive until the
+     * process exits, and the DLL must stay loaded.
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Whether Stop() gave up on a command stuck in the DLL.
+     */
+    bool IsAbandoned() const { return abandoned_.load(std::memory_order_acquire); }
+
+    bool IsExecutorThread() const {
+        return std::this_thread::get_id() == threadId_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Queues a command for the executor thread.
+     *
+     * @param name Static command name used in watchdog reports.
+     * @param work Callable run on the executor thread. Must capture by value.
+     * @param deadline Time budget measured from submission.
+     * @param mergeKey Non-zero key shared by commands that may be collapsed.
+     * @return Future receiving the callable's result, or a default value if
+     *         the command expired, was superseded or the executor stopped.
+     */
+    template <typename F>
+    auto Submit(const char* name, F&& work, std::chrono::milliseconds deadline, uint32_t mergeKey = 0)
+        -> std::future<std::invoke_result_t<std::decay_t<F>&>>;
+
+    /**
+     * @brief Runs a command and waits up to its deadline for the result.
+     *
+     * Runs inline when called from the executor thread itself.
+     *
+     * @return The command result, or @p fallback on timeout or cancellation.
+     */
+    template <typename F, typename R = std::invoke_result_t<std::decay_t<F>&>>
+    R Execute(const char* name, F&& work, std::chrono::milliseconds deadline, R fallback = R{});
+
+    /**
+     * @brief Queues a command whose result nobody waits for.
+     *
+     * Same merge and deadline rules as Submit(), without a future.
+     */
+    template <typename F>
+    void Post(const char* name, F&& work, std::chrono::milliseconds deadline, uint32_t mergeKey = 0);
+
+    Stats GetStats() const;
+
+    /**
+     * @brief Drives the executor against a simulated DLL that stalls on
+     *        demand: measures round trips, checks that writes queued behind a
+     *        stall merge and expire as they should and that the watchdog
+     *        reports the stall, then stops the executor with a command that
+     *        never returns in time and checks Stop() gives up on schedule.
+     */
+    static bool Benchmark(uint32_t commands);
+
+private:
+    struct CommandBase : MpscNode {
+        const char* name = "";
+        uint32_t mergeKey = 0;
+        Clock::time_point deadline;
+
+        virtual ~CommandBase() = default;
+        virtual void Run() = 0;
+        virtual void Cancel() = 0;
+        virtual void Supersede() = 0;
+
+        // Called by the executor once it is done with the command.
+        virtual void Release() { delete this; }
+    };
+
+    template <typename F, typename R>
+    struct Command final : CommandBase {
+        explicit Command(F&& fn) : work(std::move(fn)) {}
+
+        void Run() override {
+            try {
+                promise.set_value(work());
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        void Cancel() override { promise.set_value(R{}); }
+
+        void Supersede() override {
+            // A newer write for the same target replaces this one.
+            if constexpr (std::is_same_v<R, bool>) {
+                promise.set_value(true);
+            } else {
+                promise.set_value(R{});
+            }
+        }
+
+        F work;
+        std::promise<R> promise;
+    };
+
+    static constexpr size_t POOLED_RESULT_CAPACITY = 16;
+
+    /**
+     * @brief Preallocated command shared by the executor and at most one waiter.
+     *
+     * Each holder owns one reference; the slot returns to the pool when the
+     * last one is released, so a waiter that timed out can leave safely.
+     */
+    struct PooledCommand final : CommandBase {
+        enum class Status : uint8_t {
+            Pending,
+            Done,
+            Failed,
+            Cancelled
+        };
+
+        void Run() override {
+            try {
+                work(result);
+                Complete(Status::Done);
+            } catch (...) {
+                Complete(Status::Failed);
+            }
+        }
+
+        void Cancel() override { Complete(Status::Cancelled); }
+        void Supersede() override { Complete(Status::Cancelled); }
+        void Release() override { refs.fetch_sub(1, std::memory_order_acq_rel); }
+
+        void Complete(Status value) {
+            status.store(value, std::memory_order_release);
+            SetEvent(done.get());
+        }
+
+        InlineFunction<void(void*)> work;
+        alignas(std::max_align_t) unsigned char result[POOLED_RESULT_CAPACITY];
+        std::atomic<uint32_t> refs{0};
+        std::atomic<Status> status{Status::Pending};
+        RAIIHandle done;
+    };
+
+    // Whether Execute()/Post() can use a pooled command for this callable.
+    template <typename Fn, typename R>
+    static constexpr bool IsPoolable =
+        sizeof(Fn) <= INLINE_FUNCTION_CAPACITY && alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<Fn> && std::is_copy_constructible_v<Fn> &&
+        std::is_trivially_copyable_v<R> && sizeof(R) <= POOLED_RESULT_CAPACITY;
+
+    /**
+     * @brief Claims a free pooled command holding @p refs references.
+     * @return nullptr if every slot is in use.
+     */
+    PooledCommand* AcquirePooled(uint32_t refs);
+
+    void Enqueue(CommandBase* command);
+    void ThreadProc();
+    void WatchdogProc();
+    void ExecuteBatch(std::vector<CommandBase*>& batch);
+    void CancelPending();
+    void RecordWaitTimeout(const char* name);
+
+    static int64_t ToNanoseconds(Clock::time_point tp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    }
+
+    PooledCommand pool_[VOICEMEETER_EXECUTOR_POOL_SIZE];
+    MpscQueue<CommandBase> queue_;
+    RAIIHandle wakeEvent_;
+    RAIIHandle watchdogStopEvent_;
+    RAIIHandle threadExitedEvent_;
+    std::thread thread_;
+    std::thread watchdogThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> abandoned_{false};
+    std::atomic<std::thread::id> threadId_{};
+
+    // Command currently inside the DLL, read by the watchdog.
+    std::atomic<const char*> busyName_{nullptr};
+    std::atomic<int64_t> busySinceNs_{0};
+    std::atomic<int64_t> busyDeadlineNs_{0};
+    std::atomic<uint64_t> busySequence_{0};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> merged_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> waitTimeouts_{0};
+    std::atomic<uint64_t> poolMisses_{0};
+};
+
+template <typename F>
+auto VoicemeeterExecutor::Submit(const char* name, F&& work, std::chrono::milliseconds deadline, uint32_t mergeKey)
+    -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+    using Fn = std::decay_t<F>;
+    using R = std::invoke_result_t<Fn&>;
+    static_assert(!std::is_void_v<R>, "Voicemeeter commands must return a value");
+
+    auto* command = new Command<Fn, R>(Fn(std::forward<F>(work)));
+    command->name = name;
+    command->mergeKey = mergeKey;
+    command->deadline = Clock::now() + deadline;
+    std::future<R> result = command->promise.get_future();
+
+    if (!IsRunning()) {
+        LOG_WARNING(std::string("[VoicemeeterExecutor::Submit] Executor not running. Dropping command: ") + name);
+        command->Cancel();
+        delete command;
+        return result;
+    }
+
+    Enqueue(command);
+    return result;
+}
+
+template <typename F, typename R>
+R VoicemeeterExecutor::Execute(const char* name, F&& work, std::chrono::milliseconds deadline, R fallback) {
+    if (IsExecutorThread()) {
+        return work();
+    }
+
+    using Fn = std::decay_t<F>;
+    if constexpr (IsPoolable<Fn, R>) {
+        if (!IsRunning()) {
+            LOG_WARNING(std::string("[VoicemeeterExecutor::Execute] Executor not running. Dropping command: ") + name);
+            return fallback;
+        }
+
+        // One reference for the executor, one for this waiter.
+        if (PooledCommand* command = AcquirePooled(2)) {
+            command->work = [fn = Fn(std::forward<F>(work))](void* out) { ::new (out) R(fn()); };
+            command->name = name;
+            command->mergeKey = 0;
+            command->deadline = Clock::now() + deadline;
+            Enqueue(command);
+
+            R value = fallback;
+            if (WaitForSingleObject(command->done.get(), static_cast<DWORD>(deadline.count())) != WAIT_OBJECT_0) {
+                RecordWaitTimeout(name);
+            } else if (command->status.load(std::memory_order_acquire) == PooledCommand::Status::Done) {
+                std::memcpy(&value, command->result, sizeof(R));
+            } else if (command->status.load(std::memory_order_acquire) == PooledCommand::Status::Failed) {
+                LOG_ERROR(std::string("[VoicemeeterExecutor::Execute] Command ") + name + " threw.");
+            }
+            command->Release();
+            return value;
+        }
+    }
+
+    std::future<R> result = Submit(name, std::forward<F>(work), deadline);
+    if (result.wait_for(deadline) != std::future_status::ready) {
+        RecordWaitTimeout(name);
+        return fallback;
+    }
+
+    try {
+        return result.get();
+    } catch (const std::exception& ex) {
+        LOG_ERROR(std::string("[VoicemeeterExecutor::Execute] Command ") + name + " threw: " + ex.what());
+        return fallback;
+    }
+}
+
+template <typename F>
+void VoicemeeterExecutor::Post(const char* name, F&& work, std::chrono::milliseconds deadline, uint32_t mergeKey) {
+    using Fn = std::decay_t<F>;
+    using R = std::invoke_result_t<Fn&>;
+
+    if constexpr (IsPoolable<Fn, R>) {
+        if (!IsRunning()) {
+            LOG_WARNING(std::string("[VoicemeeterExecutor::Post] Executor not running. Dropping command: ") + name);
+            return;
+        }
+
+        if (PooledCommand* command = AcquirePooled(1)) {
+            command->work = [fn = Fn(std::forward<F>(work))](void*) { fn(); };
+            command->name = name;
+            command->mergeKey = mergeKey;
+            command->deadline = Clock::now() + deadline;
+            Enqueue(command);
+            return;
+        }
+    }
+
+    Submit(name, std::forward<F>(work), deadline, mergeKey);
+}
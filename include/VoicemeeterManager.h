@@ -1,19 +1,27 @@
 #pragma once
 
-#include <functional>
-#include <map>
 #include <mutex>
 #include <string>
 #include "RAIIHandle.h"
+#include "AudioInsert.h"
 #include "Defconf.h"
-
-
-// Type definition for callback identifiers
-using CallbackID = unsigned int;
+#include "DuckingEngine.h"
+#include "ListenerList.h"
+#include "MidiController.h"
+#include "MixerConnection.h"
+#include "OscServer.h"
+#include "ProfiledMutex.h"
+#include "Scene.h"
+#include "VoicemeeterExecutor.h"
+
+// Receives channel index, channel type, volume percentage and mute state.
+using VoicemeeterVolumeCallback = InlineFunction<void(int, ChannelType, float, bool)>;
 
 // Forward declaration of RAIIHMODULE (assuming it's defined in RAIIHandle.h)
 class RAIIHMODULE;
 
+class MacroButtonWatcher;
+
 /**
  * @brief Manages interactions with the Voicemeeter Remote API.
  *
@@ -21,8 +29,11 @@ class RAIIHMODULE;
  * Voicemeeter applications via the VoicemeeterRemote.dll. It handles
  * initialization, parameter management, device selection, and callback
  * registration for volume changes.
+ *
+ * All DLL calls are routed through a VoicemeeterExecutor so the DLL session
+ * is owned by a single thread; public methods may be called from any thread.
  */
-class VoicemeeterManager {
+class VoicemeeterManager : public MixerConnection {
 public:
     /**
      * @brief Constructs a new VoicemeeterManager object.
@@ -37,18 +48,27 @@ public:
      * Ensures that all resources are properly released and the connection
      * to Voicemeeter is gracefully terminated.
      */
-    ~VoicemeeterManager();
+    ~VoicemeeterManager() override;
+
+    /**
+     * @brief How much of the session Initialize() sets up.
+     */
+    enum class InitMode : uint8_t {
+        Full,       ///< Session plus A1 device repair, for mirroring.
+        QueryOnly   ///< Session only, for one-shot commands; skips the A1 device repair.
+    };
 
     /**
      * @brief Initializes the VoicemeeterManager with the specified Voicemeeter type.
      *
      * Attempts to load the VoicemeeterRemote DLL, log in to Voicemeeter, and
-     * set up the A1 device if necessary.
+     * in Full mode set up the A1 device if necessary.
      *
      * @param voicemeeterType The type of Voicemeeter application to initialize.
+     * @param mode Full for mirroring, QueryOnly for read-only commands.
      * @return true if initialization is successful, false otherwise.
      */
-    bool Initialize(int voicemeeterType);
+    bool Initialize(int voicemeeterType, InitMode mode = InitMode::Full);
 
     /**
      * @brief Shuts down the VoicemeeterManager, logging out and unloading the DLL.
@@ -103,17 +123,39 @@ public:
      * @param isMuted Reference to store the mute state.
      * @return true if retrieval is successful, false otherwise.
      */
-    bool GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted);
+    bool GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) override;
 
     /**
      * @brief Updates the volume and mute state of a specified channel.
      *
+     * The write is queued without waiting for the DLL. Consecutive updates
+     * for the same channel that are still queued are merged.
+     *
      * @param channelIndex The index of the channel.
      * @param channelType The type of the channel (Input or Bus).
      * @param volumePercent The desired volume percentage.
      * @param isMuted The desired mute state.
      */
-    void UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted);
+    void UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) override;
+
+    /**
+     * @brief Adds deltaDb to a channel's gain, clamped to the Voicemeeter range.
+     *
+     * Queued without waiting. Steps are relative, so they are never merged.
+     *
+     * @param channelIndex The index of the channel.
+     * @param channelType The type of the channel (Input or Bus).
+     * @param deltaDb Gain change in dB; negative steps down.
+     */
+    void StepGain(int channelIndex, ChannelType channelType, float deltaDb);
+
+    /**
+     * @brief Flips the mute state of a channel. Queued without waiting.
+     *
+     * @param channelIndex The index of the channel.
+     * @param channelType The type of the channel (Input or Bus).
+     */
+    void ToggleMute(int channelIndex, ChannelType channelType);
 
     /**
      * @brief Checks if Voicemeeter parameters have changed since the last check.
@@ -151,13 +193,99 @@ public:
      */
     bool SetMute(int channelIndex, ChannelType channelType, bool isMuted);
 
+    /**
+     * @brief Reads gains, mutes, routing and labels of every strip and bus.
+     *
+     * All reads run as one executor command, so the scene is captured in a
+     * single pass over the DLL without interleaving other traffic.
+     *
+     * @param scene Receives the captured scene.
+     * @return true if the running Voicemeeter edition is known and every read succeeded.
+     */
+    bool CaptureScene(Scene& scene) override;
+
+    /**
+     * @brief Applies a scene, writing only the parameters that differ.
+     *
+     * Captures the current state, diffs it against the scene and sends the
+     * changes as one VBVMR_SetParameters script.
+     *
+     * @param scene Scene to apply; must match the running edition's layout.
+     * @param changedParameters Receives the number of parameters written.
+     * @return true if the scene was applied or nothing needed to change.
+     */
+    bool RecallScene(const Scene& scene, size_t& changedParameters);
+
+    /**
+     * @brief Queues a VBVMR_SetParameters script without waiting for it.
+     *
+     * Scripts run in submission order and are never merged, so a sequence of
+     * incremental scripts (crossfade frames) is applied completely.
+     */
+    void ApplyParameterScript(const std::string& script) override;
+
+    /**
+     * @brief Runs one MIDI cycle as a single executor command.
+     *
+     * Drains VBVMR_GetMidiMessage, reads the controller's target parameters,
+     * lets it process both, then applies its script and sends its feedback
+     * with VBVMR_SendMidiMessage.
+     *
+     * @return false if MIDI is unavailable or the script failed.
+     */
+    bool RunMidiCycle(MidiController& controller);
+
+    /**
+     * @brief Runs one MacroButtons cycle as a single executor command.
+     *
+     * Reads the watched buttons when VBVMR_MacroButton_IsDirty reports a
+     * change, lets the watcher process them, then pushes its lit states.
+     *
+     * @return false if MacroButtons is unavailable or not running.
+     */
+    bool RunMacroButtonCycle(MacroButtonWatcher& watcher);
+
+    /**
+     * @brief Runs one ducking cycle as a single executor command.
+     *
+     * Reads the peak level of every trigger with VBVMR_GetLevel and the gain
+     * of every target, lets the engine process both, then applies its script.
+     *
+     * @return false if level metering is unavailable or the script failed.
+     */
+    bool RunDuckingCycle(DuckingEngine& engine);
+
+    /**
+     * @brief Registers @p insert as the MAIN audio callback and starts the audio stream.
+     *
+     * Stream changes reported by Voicemeeter restart the stream from the
+     * executor thread. The insert must outlive StopAudioInsert().
+     *
+     * @return false if the callback API is unavailable or another application holds the MAIN callback.
+     */
+    bool StartAudioInsert(AudioInsert& insert);
+
+    /**
+     * @brief Stops the audio stream and unregisters the callback; no processor runs after it returns.
+     */
+    void StopAudioInsert();
+
+    /**
+     * @brief Returns once every command queued before the call has finished.
+     */
+    void WaitForQueuedCommands();
+
     /**
      * @brief Registers a callback function to be invoked on volume changes.
      *
-     * @param callback A std::function taking volume percentage and mute state as parameters.
-     * @return A unique CallbackID for the registered callback.
+     * Invoked on the executor thread whenever a read observes a channel whose
+     * volume or mute state changed outside VoiceMirror. Callbacks must not
+     * block and must not wait on other VoicemeeterManager calls.
+     *
+     * @param callback Callable taking channel index, channel type, volume percentage and mute state.
+     * @return A unique CallbackID for the registered callback, or 0 if the limit is reached.
      */
-    CallbackID RegisterVolumeChangeCallback(std::function<void(float, bool)> callback);
+    CallbackID RegisterVolumeChangeCallback(VoicemeeterVolumeCallback callback);
 
     /**
      * @brief Unregisters a previously registered volume change callback.
@@ -168,6 +296,52 @@ public:
     bool UnregisterVolumeChangeCallback(CallbackID callbackID);
 
 private:
+    /**
+     * @brief Volume and mute state read back from the executor thread.
+     */
+    struct VolumeReading {
+        bool ok = false;
+        float volumePercent = 0.0f;
+        bool isMuted = false;
+    };
+
+    /**
+     * @brief Builds the executor merge key for writes to one channel parameter.
+     */
+    static uint32_t MakeMergeKey(uint8_t parameter, int channelIndex, ChannelType channelType);
+
+    // Executor-thread implementations of the public API.
+    bool InitializeInternal(int voicemeeterType, InitMode mode);
+    void ShutdownInternal();
+    bool GetVoicemeeterVolumeInternal(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted);
+    void UpdateVoicemeeterVolumeInternal(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted);
+    bool StepGainInternal(int channelIndex, ChannelType channelType, float deltaDb);
+    bool IsParametersDirtyInternal();
+    bool GetChannelVolumeInternal(int channelIndex, ChannelType channelType, float& volumePercent);
+    bool IsChannelMutedInternal(int channelIndex, ChannelType channelType);
+    void ListAllChannelsInternal();
+    void ListInputsInternal();
+    void ListOutputsInternal();
+    Scene CaptureSceneInternal();
+    bool CaptureChannelInternal(const char* prefix, int index, const SceneLayout& layout, ChannelSnapshot& channel);
+    bool RecallSceneInternal(const Scene& scene, size_t& changedParameters);
+    bool RunMidiCycleInternal(MidiController& controller);
+    bool RunMacroButtonCycleInternal(MacroButtonWatcher& watcher);
+    bool RunDuckingCycleInternal(DuckingEngine& engine);
+    bool StartAudioInsertInternal(AudioInsert& insert);
+    void StopAudioInsertInternal();
+
+    /**
+     * @brief Records a channel reading and notifies listeners if it changed.
+     */
+    void RecordObservedVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted);
+
+    /**
+     * @brief Drops the recorded reading after VoiceMirror writes the channel,
+     *        so the next read becomes the new baseline instead of an event.
+     */
+    void ForgetObservedVolume(int channelIndex, ChannelType channelType);
+
     /**
      * @brief Loads the VoicemeeterRemote DLL and initializes function pointers.
      *
@@ -212,6 +386,7 @@ private:
     typedef long(__stdcall* T_VBVMR_GetVoicemeeterType)(long* type);
     typedef long(__stdcall* T_VBVMR_GetVoicemeeterVersion)(char* buffer);
     typedef long(__stdcall* T_VBVMR_IsParametersDirty)();
+    typedef long(__stdcall* T_VBVMR_GetLevel)(long type, long channel, float* value);
     typedef long(__stdcall* T_VBVMR_GetParameterFloat)(char* param, float* value);
     typedef long(__stdcall* T_VBVMR_GetParameterStringA)(char* param, char* buffer);
     typedef long(__stdcall* T_VBVMR_GetParameterStringW)(wchar_t* param, wchar_t* buffer);
@@ -220,6 +395,16 @@ private:
     typedef long(__stdcall* T_VBVMR_SetParameters)(const char* params);
     typedef long(__stdcall* T_VBVMR_Output_GetDeviceNumber)();
     typedef long(__stdcall* T_VBVMR_Output_GetDeviceDescA)(int index, int* type, char* name, char* hwId);
+    typedef long(__stdcall* T_VBVMR_GetMidiMessage)(unsigned char* buffer, long maxBytes);
+    typedef long(__stdcall* T_VBVMR_SendMidiMessage)(unsigned char* buffer, long bytes);
+    typedef long(__stdcall* T_VBVMR_MacroButton_IsDirty)();
+    typedef long(__stdcall* T_VBVMR_MacroButton_GetStatus)(long button, float* value, long bitmode);
+    typedef long(__stdcall* T_VBVMR_MacroButton_SetStatus)(long button, float value, long bitmode);
+    typedef long(__stdcall* T_VBVMR_AudioCallback)(void* user, long command, void* data, long synchro);
+    typedef long(__stdcall* T_VBVMR_AudioCallbackRegister)(long mode, T_VBVMR_AudioCallback callback, void* user, char clientName[64]);
+    typedef long(__stdcall* T_VBVMR_AudioCallbackStart)();
+    typedef long(__stdcall* T_VBVMR_AudioCallbackStop)();
+    typedef long(__stdcall* T_VBVMR_AudioCallbackUnregister)();
 
     // Function pointers for VoicemeeterRemote DLL
     T_VBVMR_Login VBVMR_Login;
@@ -228,6 +413,7 @@ private:
     T_VBVMR_GetVoicemeeterType VBVMR_GetVoicemeeterType;
     T_VBVMR_GetVoicemeeterVersion VBVMR_GetVoicemeeterVersion;
     T_VBVMR_IsParametersDirty VBVMR_IsParametersDirty;
+    T_VBVMR_GetLevel VBVMR_GetLevel;
     T_VBVMR_GetParameterFloat VBVMR_GetParameterFloat;
     T_VBVMR_GetParameterStringA VBVMR_GetParameterStringA;
     T_VBVMR_GetParameterStringW VBVMR_GetParameterStringW;
@@ -236,6 +422,15 @@ private:
     T_VBVMR_SetParameters VBVMR_SetParameters;
     T_VBVMR_Output_GetDeviceNumber VBVMR_Output_GetDeviceNumber;
     T_VBVMR_Output_GetDeviceDescA VBVMR_Output_GetDeviceDescA;
+    T_VBVMR_GetMidiMessage VBVMR_GetMidiMessage;
+    T_VBVMR_SendMidiMessage VBVMR_SendMidiMessage;
+    T_VBVMR_MacroButton_IsDirty VBVMR_MacroButton_IsDirty;
+    T_VBVMR_MacroButton_GetStatus VBVMR_MacroButton_GetStatus;
+    T_VBVMR_MacroButton_SetStatus VBVMR_MacroButton_SetStatus;
+    T_VBVMR_AudioCallbackRegister VBVMR_AudioCallbackRegister;
+    T_VBVMR_AudioCallbackStart VBVMR_AudioCallbackStart;
+    T_VBVMR_AudioCallbackStop VBVMR_AudioCallbackStop;
+    T_VBVMR_AudioCallbackUnregister VBVMR_AudioCallbackUnregister;
 
     // RAII handle for the VoicemeeterRemote DLL
     RAIIHMODULE hVoicemeeterRemote;
@@ -245,18 +440,84 @@ private:
     bool loggedIn;
 
     // Mutexes for thread safety
-    std::mutex initMutex_;
-    std::mutex shutdownMutex_;
-    std::mutex channelMutex_;
-    std::mutex callbackMutex_;
+    ProfiledMutex initMutex_{"VoicemeeterManager::initMutex_"};
+    ProfiledMutex shutdownMutex_{"VoicemeeterManager::shutdownMutex_"};
 
     // Callback management
-    std::map<CallbackID, std::function<void(float, bool)>> volumeChangeCallbacks_;
-    CallbackID nextCallbackID_;
+    ListenerList<int, ChannelType, float, bool> volumeListeners_{"VoicemeeterManager::volumeListeners_"};
+
+    // Last value seen per channel. Only touched on the executor thread.
+    struct ObservedVolume {
+        bool valid = false;
+        float volumePercent = 0.0f;
+        bool isMuted = false;
+    };
+    static constexpr int MAX_OBSERVED_CHANNELS = 16;
+    ObservedVolume observedVolumes_[2][MAX_OBSERVED_CHANNELS];
 
     // Constants (define these appropriately or ensure they are defined elsewhere)
     static constexpr int DEFAULT_STARTUP_DELAY_MS = 5000; // Example value
     static constexpr int MAX_RETRIES = 10;               // Example value
     static constexpr int RETRY_DELAY_MS = 1000;          // Example value
+    static constexpr int READY_POLL_INTERVAL_MS = 10;
+
+    // MIDI bytes drained in the current cycle. Only touched on the executor thread.
+    std::vector<uint8_t> midiInput_;
+
+    // Insert registered as the MAIN audio callback. Only touched on the executor thread.
+    AudioInsert* audioInsert_ = nullptr;
+
+    // Single thread owning all DLL calls
+    VoicemeeterExecutor executor_;
 };
 
+/**
+ * @brief MIDI port on the device Voicemeeter uses for its own MIDI mapping.
+ */
+class VoicemeeterMidiPort : public MidiPort {
+public:
+    explicit VoicemeeterMidiPort(VoicemeeterManager& manager) : manager_(manager) {}
+
+    bool RunCycle(MidiController& controller) override { return manager_.RunMidiCycle(controller); }
+
+    // A cycle that outlived its deadline may still be queued on the executor.
+    void Close() override { manager_.WaitForQueuedCommands(); }
+
+private:
+    VoicemeeterManager& manager_;
+};
+
+/**
+ * @brief Level meters and gains of the local Voicemeeter, for ducking.
+ */
+class VoicemeeterDuckingPort : public DuckingPort {
+public:
+    explicit VoicemeeterDuckingPort(VoicemeeterManager& manager) : manager_(manager) {}
+
+    bool RunCycle(DuckingEngine& engine) override { return manager_.RunDuckingCycle(engine); }
+
+    // A cycle that outlived its deadline may still be queued on the executor.
+    void Close() override { manager_.WaitForQueuedCommands(); }
+
+    void Restore(const std::string& script) override {
+        manager_.ApplyParameterScript(script);
+        manager_.WaitForQueuedCommands();
+    }
+
+private:
+    VoicemeeterManager& manager_;
+};
+
+/**
+ * @brief Mixer behind the OSC server: the running Voicemeeter instance, local or remote.
+ */
+class VoicemeeterOscBackend : public OscBackend {
+public:
+    explicit VoicemeeterOscBackend(MixerConnection& mixer) : mixer_(mixer) {}
+
+    void Apply(const std::string& script) override { mixer_.ApplyParameterScript(script); }
+    bool Read(Scene& scene) override { return mixer_.CaptureScene(scene); }
+
+private:
+    MixerConnection& mixer_;
+};
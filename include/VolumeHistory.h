@@ -0,0 +1,144 @@
+// VolumeHistory.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Defconf.h"
+#include "EventStream.h"
+#include "ProfiledMutex.h"
+
+/**
+ * @brief Every volume and mute change of the mirrored channel, kept in memory
+ *        at three resolutions and saved to a small binary file on shutdown.
+ *
+ * There is one series per side and quantity: Windows volume, Windows mute,
+ * Voicemeeter volume and Voicemeeter mute. A sample is stored only when its
+ * quantized value differs from the previous one of the same series. Each
+ * series keeps three fixed-size rings, filled side by side:
+ *
+ *   raw  every change: time and value
+ *   1s   one bucket per second with changes: min, max, last value and count
+ *   1m   the same per minute
+ *
+ * The rings are columnar (one array per field) and allocated up front, so
+ * recording never allocates. Times are stored as deltas from the previous
+ * entry in the tier's unit, values as hundredths of a percent. When the raw
+ * ring is full the oldest change falls out while the coarse tiers still
+ * cover it, so queries fall back to the finest tier reaching back far
+ * enough. Times are wall-clock milliseconds since the Unix epoch; if the
+ * clock steps back, the change is stored at the time of the previous one.
+ *
+ * The file is written with varint deltas and a checksum, and read back at
+ * startup if it belongs to the same channel mapping.
+ */
+class VolumeHistory {
+public:
+    enum Series : uint8_t {
+        WindowsVolume,
+        WindowsMute,
+        VoicemeeterVolume,
+        VoicemeeterMute,
+        SeriesCount
+    };
+
+    enum Tier : uint8_t {
+        Raw,
+        Second,
+        Minute,
+        TierCount
+    };
+
+    /**
+     * @brief What a query returns; parsed from an HTTP query string.
+     */
+    struct Query {
+        int series = -1;            ///< One Series, or -1 for all
+        int tier = -1;              ///< One Tier, or -1 for the finest covering fromMs
+        uint64_t fromMs = 0;        ///< Inclusive
+        uint64_t toMs = UINT64_MAX; ///< Inclusive
+    };
+
+    /**
+     * @brief The history the application records into.
+     */
+    static VolumeHistory& Instance();
+
+    VolumeHistory();
+
+    VolumeHistory(const VolumeHistory&) = delete;
+    VolumeHistory& operator=(const VolumeHistory&) = delete;
+
+    /**
+     * @brief Loads the history file of the configured channel mapping, if any.
+     * @return false if a file exists but cannot be used; recording works either way.
+     */
+    bool Open(const Config& config);
+
+    /**
+     * @brief Saves the history file. Call once the mirror has stopped.
+     */
+    void Close();
+
+    /**
+     * @brief Records one side's volume and mute if either changed. Never allocates or touches the disk.
+     */
+    void Record(StreamEventSide side, float volumePercent, bool isMuted);
+
+    /**
+     * @brief Parses "series=windows_volume&tier=1s&from=<ms>&to=<ms>"; every key is optional.
+     */
+    static bool ParseQuery(const char* text, size_t length, Query& query);
+
+    /**
+     * @brief Writes matching entries as CSV lines of
+     *        series,tier,time_ms,min,max,last,changes (raw entries have
+     *        min = max = last and 1 change). Does not allocate.
+     * @return false if the text did not fit in @p capacity bytes.
+     */
+    bool Render(const Query& query, char* out, size_t capacity, size_t& length);
+
+    /**
+     * @brief Records synthetic slider drags and mute toggles, checks every
+     *        tier against a plain list of the same changes, round-trips the
+     *        file and reports recording cost and bytes per change.
+     */
+    static bool Benchmark(uint32_t changes);
+
+private:
+    // One ring of one tier; value columns other than last are empty for Raw.
+    struct Ring {
+        size_t head = 0;            ///< Oldest entry
+        size_t count = 0;
+        bool evicted = false;       ///< Entries have fallen out, so it starts at oldest
+        uint64_t oldest = 0;        ///< Time of the oldest entry, in the tier's unit
+        uint64_t newest = 0;
+        std::vector<uint32_t> delta;  ///< Since the previous entry; unused for the oldest
+        std::vector<uint16_t> last;
+        std::vector<uint16_t> minimum;
+        std::vector<uint16_t> maximum;
+        std::vector<uint16_t> changes;
+    };
+
+    struct SeriesData {
+        bool known = false;
+        uint16_t value = 0;         ///< Last recorded, quantized
+        Ring rings[TierCount];
+    };
+
+    void RecordValue(int series, uint16_t value, uint64_t nowMs);
+    void Append(Ring& ring, int tier, uint16_t value, uint64_t nowMs);
+
+    // Finest tier whose entries reach back to fromMs.
+    int CoveringTier(const SeriesData& data, uint64_t fromMs) const;
+
+    bool Save(const std::string& path);
+    bool Load(const std::string& path);
+
+    ProfiledMutex mutex_{"VolumeHistory::mutex_"};
+    SeriesData series_[SeriesCount];
+    uint8_t channelIndex_ = 0;
+    uint8_t channelType_ = 0;
+    std::string path_;
+};
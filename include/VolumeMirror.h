@@ -2,13 +2,19 @@
 #pragma once
 
 #include <atomic>
-#include <functional>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <string>
 #include <thread>
 
 #include "Defconf.h"
-#include "VoicemeeterManager.h"
-#include "WindowsManager.h"
+#include "EndpointVolume.h"
+#include "ListenerList.h"
+#include "Metrics.h"
+#include "MirrorState.h"
+#include "MixerConnection.h"
+#include "ProfiledMutex.h"
 
 class VolumeMirror {
    public:
@@ -16,7 +22,7 @@ class VolumeMirror {
                       Callback,
                       Hybrid };
 
-    static VolumeMirror& Instance(int channelIdx, ChannelType type, VoicemeeterManager& manager, WindowsManager& windowsManager, Mode mode) {
+    static VolumeMirror& Instance(int channelIdx, ChannelType type, MixerConnection& manager, EndpointVolume& windowsManager, Mode mode) {
         static VolumeMirror instance(channelIdx, type, manager, windowsManager, mode);
         return instance;
     }
@@ -28,16 +34,55 @@ class VolumeMirror {
     void Start();
     void Stop();
 
+    /**
+     * @brief Pushes the current Windows volume and mute state to Voicemeeter.
+     */
+    void ForceResync();
+
+    /**
+     * @brief Mirrors between a simulated endpoint and mixer with every sync
+     *        thread busy at once: slider drags on the notification thread,
+     *        fader moves picked up by a 1 ms poll and hotkey resyncs. Reports
+     *        lock contention and checks both sides end up equal.
+     */
+    static bool Benchmark(uint32_t events);
+
+    /**
+     * @brief Mirrors slider changes and fader moves between a simulated
+     *        endpoint and mixer one at a time and fails if any sync event
+     *        allocates after warm-up. Needs a release build with
+     *        VOICEMIRROR_TRACK_ALLOCATIONS.
+     */
+    static bool AllocationBenchmark(uint32_t events);
+
    private:
-    VolumeMirror(int channelIdx, ChannelType type, VoicemeeterManager& manager, WindowsManager& windowsManager, Mode mode);
+    VolumeMirror(int channelIdx, ChannelType type, MixerConnection& manager, EndpointVolume& windowsManager, Mode mode);
     void OnWindowsVolumeChange(float newVolume, bool isMuted);
     void MonitorVolumes();
 
+    // Applies a sample under controlMutex; returns the I/O to run afterwards.
+    MirrorLogic::Action ApplyWindowsSample(float volume, bool isMuted, uint64_t sampleGeneration);
+    MirrorLogic::Action ApplyVoicemeeterSample(float volume, bool isMuted, uint64_t sampleGeneration);
+
+    // Claims an action for writing unless a newer one superseded it, and
+    // writes it if no other thread is writing.
+    void PerformAction(const MirrorLogic::Action& action);
+
+    // Writes an action to its side; called by the writing thread without any lock held.
+    void WriteAction(const MirrorLogic::Action& action);
+
+    void LogLockHoldStats();
+
+    // Reports sync events that allocated after warm-up (allocation tracking builds only).
+    void CheckSyncEventAllocations(uint64_t allocationsBefore, const char* source);
+
+    void RegisterMetrics();
+
     int channelIndex;
     ChannelType channelType;
 
-    VoicemeeterManager& vmManager;
-    WindowsManager& windowsManager;
+    MixerConnection& vmManager;
+    EndpointVolume& windowsManager;
 
     Mode mode;
 
@@ -46,20 +91,123 @@ class VolumeMirror {
 
     std::thread monitorThread;
 
-    std::mutex controlMutex;
-
-    std::function<void(float, bool)> windowsVolumeCallback;
-    unsigned int windowsVolumeCallbackID;
-
-    float lastVmVolume;
-    bool lastVmMute;
-    float lastWinVolume;
-    bool lastWinMute;
+    // Serializes Start/Stop; never held while mirroring.
+    ProfiledMutex lifecycleMutex{"VolumeMirror::lifecycleMutex"};
+
+    // Guards mirrorState only. No DLL or COM call is made while it is held.
+    ProfiledMutex controlMutex{"VolumeMirror::controlMutex"};
+    MirrorLogic::State mirrorState;
+
+    // Mirror of mirrorState.generation readable without the lock.
+    std::atomic<uint64_t> generation{0};
+
+    // Guards the claimed action and the writing flag. An action is claimed
+    // only if it is still the newest; one thread at a time writes, always the
+    // newest claimed action, so writes reach either side in generation order
+    // without the lock being held across a DLL or COM call. Never taken with
+    // controlMutex.
+    ProfiledMutex writeMutex{"VolumeMirror::writeMutex"};
+    MirrorLogic::Action claimedAction;  ///< Kind::None once taken by the writer
+    bool writing = false;
+
+    CallbackID windowsVolumeCallbackID = 0;
+
+    // Hold times of a lock, or durations of the endpoint writes, which were
+    // made under writeMutex before writes were claimed
+    struct HoldStats {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> maxNs{0};
+
+        void Record(std::chrono::steady_clock::duration held);
+        std::string Describe(const char* what) const;
+    };
+    HoldStats controlHolds;
+    HoldStats writeHolds;
+    HoldStats endpointWrites;
+    std::atomic<uint64_t> staleSamples{0};
+    std::atomic<uint64_t> staleActions{0};
+
+    // Sync event allocation check
+    std::atomic<uint64_t> syncEvents{0};
+    std::atomic<uint64_t> allocatingSyncEvents{0};
+
+    // Exported metrics, indexed by Side; null if the registry was full
+    enum Side { WindowsSide, VoicemeeterSide, SideCount };
+    Metric* volumeGauges[SideCount] = {};
+    Metric* muteGauges[SideCount] = {};
+    Metric* syncCounters[SideCount] = {};       ///< Syncs written to that side
+    Histogram* syncDurations[SideCount] = {};
+    Metric* staleSampleCounter = nullptr;
+    Metric* staleActionCounter = nullptr;
+};
 
-    bool updatingVoicemeeter;
-    bool updatingWindows;
+/**
+ * @brief Simulated Windows endpoint, for benchmarks.
+ *
+ * Like Windows, every change, including the mirror's own writes, is reported
+ * to the callbacks on a separate notification thread. Changes made while a
+ * report is pending are coalesced into one report of the latest value.
+ */
+class SimulatedEndpoint : public EndpointVolume {
+public:
+    SimulatedEndpoint();
+    ~SimulatedEndpoint() override;
+
+    SimulatedEndpoint(const SimulatedEndpoint&) = delete;
+    SimulatedEndpoint& operator=(const SimulatedEndpoint&) = delete;
+
+    /**
+     * @brief Changes the volume as if the user dragged the slider.
+     */
+    void UserChange(float volumePercent, bool isMuted);
+
+    /**
+     * @brief Waits until every change made so far has been reported.
+     */
+    bool WaitReported(std::chrono::milliseconds timeout);
+
+    bool SetVolume(float volumePercent) override;
+    bool SetMute(bool mute) override;
+    float GetVolume() const override;
+    bool GetMute() const override;
+
+    CallbackID RegisterVolumeChangeCallback(VolumeChangeCallback callback) override;
+    bool UnregisterVolumeChangeCallback(CallbackID callbackID) override;
+
+private:
+    void NotifierProc();
+
+    mutable ProfiledMutex mutex_{"SimulatedEndpoint::mutex_"};
+    std::condition_variable_any changed_;
+    std::condition_variable_any reported_;
+    float volume_ = 0.0f;
+    bool mute_ = false;
+    uint64_t changes_ = 0;
+    uint64_t reportedChanges_ = 0;
+    bool stopping_ = false;
+
+    ListenerList<float, bool> listeners_{"SimulatedEndpoint::listeners_"};
+    std::thread notifier_;
+};
 
-    float pendingVmVolume;
-    bool pendingVmMute;
-    bool vmChangePending;
+/**
+ * @brief Simulated Voicemeeter channel, for benchmarks. Writes apply at once.
+ */
+class SimulatedMixer : public MixerConnection {
+public:
+    /**
+     * @brief Changes the channel as if its fader was moved in Voicemeeter.
+     */
+    void UserChange(float volumePercent, bool isMuted);
+
+    bool GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) override;
+    void UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) override;
+    void ApplyParameterScript(const std::string&) override {}
+    bool CaptureScene(Scene&) override { return false; }
+
+private:
+    mutable ProfiledMutex mutex_{"SimulatedMixer::mutex_"};
+    float volume_ = 0.0f;
+    bool mute_ = false;
 };
@@ -2,7 +2,9 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <algorithm>  
 #include <cmath>
 #include <string>
@@ -46,6 +48,7 @@ inline bool IsFloatEqual(float a, float b, int decimalPlaces = 2) {
     auto factor = std::pow(10.0f, decimalPlaces);
     return std::round(a * factor) == std::round(b * factor);}
 
+#ifdef _WIN32
 inline std::wstring ConvertToWString(const char* str) {
     if (!str) return L"";
     int size_needed = MultiByteToWideChar(CP_UTF8, 0, str, -1, nullptr, 0);
@@ -66,4 +69,15 @@ inline std::wstring ConvertToWString(const wchar_t* wstr) {
     return std::wstring(wstr);
 }
 
+// Converts to UTF-8 in a caller-provided buffer without allocating. Truncated on overflow.
+template <size_t N>
+inline const char* ConvertToUtf8(const wchar_t* wstr, char (&buffer)[N]) {
+    buffer[0] = '\0';
+    if (wstr && WideCharToMultiByte(CP_UTF8, 0, wstr, -1, buffer, static_cast<int>(N), nullptr, nullptr) == 0) {
+        buffer[N - 1] = '\0';
+    }
+    return buffer;
+}
+#endif
+
 }  // namespace VolumeUtils
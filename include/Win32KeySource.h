@@ -0,0 +1,36 @@
+// Win32KeySource.h
+#pragma once
+
+#include <windows.h>
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "HotkeyEngine.h"
+
+/**
+ * @brief Global hotkeys registered on a dedicated input thread.
+ *
+ * The thread owns a message-only window and runs its message pump, so
+ * WM_HOTKEY is delivered no matter which thread started the source.
+ * Volume steps auto-repeat while held; every other action fires once per press.
+ */
+class Win32KeySource : public KeySource {
+public:
+    Win32KeySource() = default;
+    ~Win32KeySource() override;
+
+    Win32KeySource(const Win32KeySource&) = delete;
+    Win32KeySource& operator=(const Win32KeySource&) = delete;
+
+    bool Start(const std::vector<HotkeyBinding>& bindings, KeyHandler handler) override;
+    void Stop() override;
+
+private:
+    void ThreadProc(std::vector<HotkeyBinding> bindings, std::promise<bool>& ready);
+
+    KeyHandler handler_;
+    std::thread thread_;
+    DWORD threadId_ = 0;
+};
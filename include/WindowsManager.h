@@ -11,34 +11,40 @@
 #include <atomic>
 #include <cmath>
 #include <functional>
-#include <map>
 #include <mutex>
 #include <string>
 
 #include "Defconf.h"
+#include "EndpointVolume.h"
+#include "ListenerList.h"
 #include "Logger.h"
+#include "ProfiledMutex.h"
 #include "VolumeUtils.h"
 
-using CallbackID = unsigned int;
-
-class WindowsManager : public IAudioEndpointVolumeCallback, public IMMNotificationClient {
+class WindowsManager : public IAudioEndpointVolumeCallback, public IMMNotificationClient, public EndpointVolume {
 public:
     // Constructor and Destructor
     WindowsManager(const Config& config);
     ~WindowsManager();
 
     // Volume Control Methods
-    bool SetVolume(float volumePercent);
-    bool SetMute(bool mute);
-    float GetVolume() const;
-    bool GetMute() const;
+    bool SetVolume(float volumePercent) override;
+    bool SetMute(bool mute) override;
+    float GetVolume() const override;
+    bool GetMute() const override;
 
     // Callback Registration
-    CallbackID RegisterVolumeChangeCallback(std::function<void(float, bool)> callback);
-    bool UnregisterVolumeChangeCallback(CallbackID callbackID);
+    CallbackID RegisterVolumeChangeCallback(VolumeChangeCallback callback) override;
+    bool UnregisterVolumeChangeCallback(CallbackID callbackID) override;
 
     // Device Enumeration
-    void ListMonitorableDevices();  // Newly added method
+    /**
+     * @brief Lists active audio endpoints.
+     *
+     * Needs neither an instance nor the default endpoint: initializes COM on
+     * the calling thread for the duration of the call.
+     */
+    static void ListMonitorableDevices();
 
     // IUnknown Methods
     STDMETHODIMP QueryInterface(REFIID riid, void** ppvInterface) override;
@@ -81,25 +87,14 @@ private:
     bool previousMute_ = false;
 
     // Mutex for Sound Operations
-    mutable std::mutex soundMutex_;
-
-    // Hotkey Handling Members
-    bool InitializeHotkey();
-    void CleanupHotkey();
-    void WindowProcCallback();
-    static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
-    HWND hwndHotkeyWindow_;
-    uint16_t hotkeyModifiers_;
-    uint8_t hotkeyVK_;
+    mutable ProfiledMutex soundMutex_{"WindowsManager::soundMutex_"};
 
     // COM Initialization State
     bool comInitialized_;
-    std::mutex comInitializedMutex_;
+    ProfiledMutex comInitializedMutex_{"WindowsManager::comInitializedMutex_"};
 
     // Callback Management
-    std::mutex callbackMutex_;
-    std::map<CallbackID, std::function<void(float, bool)>> volumeChangeCallbacks_;
-    CallbackID nextCallbackID_ = 1;
+    ListenerList<float, bool> volumeListeners_{"WindowsManager::volumeListeners_"};
 
     // Constants for Device Enumeration Formatting
     static constexpr size_t INDEX_WIDTH = 7;
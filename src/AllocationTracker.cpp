@@ -0,0 +1,249 @@
+// AllocationTracker.cpp
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "Logger.h"
+
+namespace {
+constexpr size_t SUBSYSTEM_COUNT = static_cast<size_t>(AllocationSubsystem::Count);
+
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+// Plain arrays of atomics: zero-initialized before any allocation can happen.
+std::atomic<uint64_t> subsystemAllocations[SUBSYSTEM_COUNT];
+std::atomic<uint64_t> subsystemBytes[SUBSYSTEM_COUNT];
+std::atomic<int64_t> subsystemLiveBytes[SUBSYSTEM_COUNT];
+thread_local uint64_t threadAllocations = 0;
+thread_local AllocationSubsystem threadSubsystem = AllocationSubsystem::Other;
+
+// Prepended to every block; keeps the user pointer 16-byte aligned like malloc.
+struct alignas(16) BlockHeader {
+    size_t size;
+    AllocationSubsystem subsystem;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must preserve malloc alignment");
+
+// Fills in the header at the start of a block and counts it; returns the user pointer.
+void* TrackBlock(BlockHeader* header, size_t bytes) {
+    header->size = bytes;
+    header->subsystem = threadSubsystem;
+
+    ++threadAllocations;
+    size_t index = static_cast<size_t>(threadSubsystem);
+    subsystemAllocations[index].fetch_add(1, std::memory_order_relaxed);
+    subsystemBytes[index].fetch_add(bytes, std::memory_order_relaxed);
+    subsystemLiveBytes[index].fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    return header + 1;
+}
+
+BlockHeader* UntrackBlock(void* memory) {
+    BlockHeader* header = static_cast<BlockHeader*>(memory) - 1;
+    size_t index = static_cast<size_t>(header->subsystem);
+    subsystemLiveBytes[index].fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+    return header;
+}
+#endif
+}  // namespace
+
+uint64_t AllocationTracker::ThreadAllocations() {
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    return threadAllocations;
+#else
+    return 0;
+#endif
+}
+
+AllocationTracker::Counters AllocationTracker::SubsystemCounters(AllocationSubsystem subsystem) {
+    Counters counters;
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    size_t index = static_cast<size_t>(subsystem);
+    counters.allocations = subsystemAllocations[index].load(std::memory_order_relaxed);
+    counters.bytes = subsystemBytes[index].load(std::memory_order_relaxed);
+    counters.liveBytes = subsystemLiveBytes[index].load(std::memory_order_relaxed);
+#else
+    (void)subsystem;
+#endif
+    return counters;
+}
+
+const char* AllocationTracker::SubsystemName(AllocationSubsystem subsystem) {
+    switch (subsystem) {
+        case AllocationSubsystem::Other: return "Other";
+        case AllocationSubsystem::Logger: return "Logger";
+        case AllocationSubsystem::Mirror: return "Mirror";
+        case AllocationSubsystem::Voicemeeter: return "Voicemeeter";
+        case AllocationSubsystem::Windows: return "Windows";
+        case AllocationSubsystem::Sound: return "Sound";
+        case AllocationSubsystem::Config: return "Config";
+        case AllocationSubsystem::Devices: return "Devices";
+        case AllocationSubsystem::Cache: return "Cache";
+        default: return "Unknown";
+    }
+}
+
+int64_t AllocationTracker::TotalLiveBytes() {
+    int64_t total = 0;
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        total += subsystemLiveBytes[i].load(std::memory_order_relaxed);
+    }
+#endif
+    return total;
+}
+
+void AllocationTracker::Report() {
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+    LOG_INFO("[AllocationTracker::Report] Heap allocations by subsystem:");
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        Counters counters = SubsystemCounters(static_cast<AllocationSubsystem>(i));
+        LOG_INFO(std::string("[AllocationTracker::Report] ") + SubsystemName(static_cast<AllocationSubsystem>(i)) +
+                 ": " + std::to_string(counters.allocations) + " allocations, " +
+                 std::to_string(counters.bytes) + " bytes, " +
+                 std::to_string(counters.liveBytes) + " bytes live.");
+    }
+#endif
+}
+
+#ifdef VOICEMIRROR_TRACK_ALLOCATIONS
+void* AllocationTracker::Allocate(size_t bytes) noexcept {
+    BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + bytes));
+    if (!header) {
+        return nullptr;
+    }
+    return TrackBlock(header, bytes);
+}
+
+void AllocationTracker::Free(void* memory) noexcept {
+    if (!memory) {
+        return;
+    }
+    std::free(UntrackBlock(memory));
+}
+
+void* AllocationTracker::AllocateAligned(size_t bytes, size_t alignment) noexcept {
+    // The malloc pointer is kept in the word before the header, which sits
+    // right before the aligned user pointer: [padding][base][header][user].
+    if (alignment < alignof(BlockHeader)) {
+        alignment = alignof(BlockHeader);
+    }
+    size_t overhead = sizeof(void*) + sizeof(BlockHeader) + alignment - 1;
+    if (bytes > SIZE_MAX - overhead) {
+        return nullptr;
+    }
+    void* base = std::malloc(overhead + bytes);
+    if (!base) {
+        return nullptr;
+    }
+    uintptr_t first = reinterpret_cast<uintptr_t>(base) + sizeof(void*) + sizeof(BlockHeader);
+    uintptr_t user = (first + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(user) - 1;
+    reinterpret_cast<void**>(header)[-1] = base;
+    return TrackBlock(header, bytes);
+}
+
+void AllocationTracker::FreeAligned(void* memory) noexcept {
+    if (!memory) {
+        return;
+    }
+    BlockHeader* header = UntrackBlock(memory);
+    std::free(reinterpret_cast<void**>(header)[-1]);
+}
+
+AllocationSubsystem& AllocationTracker::CurrentSubsystem() {
+    return threadSubsystem;
+}
+
+// -----------------------------
+// Global allocation hooks
+// -----------------------------
+
+void* operator new(size_t size) {
+    if (void* memory = AllocationTracker::Allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return AllocationTracker::Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return AllocationTracker::Allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    AllocationTracker::Free(memory);
+}
+
+// Over-aligned types (alignas above 16) come through these.
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* memory = AllocationTracker::AllocateAligned(size, static_cast<size_t>(alignment))) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocationTracker::AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocationTracker::AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    AllocationTracker::FreeAligned(memory);
+}
+#endif
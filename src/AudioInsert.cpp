@@ -0,0 +1,394 @@
+// AudioInsert.cpp
+#include "AudioInsert.h"
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+#include "Scene.h"
+#include "VoicemeeterRemote.h"
+
+namespace {
+// MXCSR flush-to-zero and denormals-are-zero
+constexpr unsigned int MXCSR_FTZ_DAZ = 0x8040;
+
+// MAIN stream channels per strip
+constexpr uint32_t PHYSICAL_STRIP_CHANNELS = 2;
+constexpr uint32_t VIRTUAL_STRIP_CHANNELS = 8;
+
+// Benchmark: shortened so the bypass can be seen ending within a second
+constexpr uint32_t BENCH_BYPASS_HOLD_MS = 300;
+constexpr uint32_t BENCH_OVERLOAD_SECONDS = 1;
+constexpr double BENCH_OVERLOAD_FRACTION = 0.4;  // Of the period: over budget, within the deadline
+constexpr double BENCH_MISS_FRACTION = 1.2;      // Of the period: a deadline miss
+
+// Keeps the audio thread busy for a given time, like a processor gone slow.
+class SpinProcessor : public AudioProcessor {
+public:
+    void Prepare(uint32_t /*sampleRate*/, uint32_t /*frames*/) override {}
+
+    void Process(const AudioBlock& /*block*/) override {
+        ++calls;
+        auto until = std::chrono::steady_clock::now() + spin;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+
+    std::chrono::steady_clock::duration spin{0};
+    uint64_t calls = 0;
+};
+
+class CountingProcessor : public AudioProcessor {
+public:
+    void Prepare(uint32_t /*sampleRate*/, uint32_t /*frames*/) override {}
+    void Process(const AudioBlock& /*block*/) override { ++calls; }
+
+    uint64_t calls = 0;
+};
+
+// Single writer: the audio thread
+void RaiseMax(std::atomic<double>& max, double value) {
+    if (value > max.load(std::memory_order_relaxed)) {
+        max.store(value, std::memory_order_relaxed);
+    }
+}
+}  // namespace
+
+AudioInsert::AudioInsert() {
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    processingHistogram_ = registry.RegisterHistogram(
+        "voicemirror_audio_callback_duration_ratio",
+        "Time spent in the MAIN audio callback, as a fraction of the buffer period.", AUDIO_PERIOD_BUCKETS,
+        std::size(AUDIO_PERIOD_BUCKETS));
+    jitterHistogram_ = registry.RegisterHistogram(
+        "voicemirror_audio_callback_jitter_ratio",
+        "Deviation of the time between MAIN audio callbacks from the buffer period, as a fraction of it.",
+        AUDIO_PERIOD_BUCKETS, std::size(AUDIO_PERIOD_BUCKETS));
+    overBudgetCounter_ = registry.Counter("voicemirror_audio_callback_over_budget_total",
+                                          "Audio callbacks over VoiceMirror's share of the buffer period.");
+    deadlineMissCounter_ = registry.Counter("voicemirror_audio_callback_deadline_misses_total",
+                                            "Audio callbacks longer than the buffer period.");
+    bypassCounter_ = registry.Counter("voicemirror_audio_optional_bypasses_total",
+                                      "Times optional audio processing was bypassed for running over budget.");
+    bypassedGauge_ = registry.Gauge("voicemirror_audio_optional_bypassed",
+                                    "1 while optional audio processing is bypassed.");
+}
+
+bool AudioInsert::AddProcessor(AudioProcessor& processor, bool optional) {
+    if (processorCount_ >= AUDIO_MAX_PROCESSORS) {
+        LOG_ERROR("[AudioInsert::AddProcessor] At most " + std::to_string(AUDIO_MAX_PROCESSORS) +
+                  " audio processors can be attached.");
+        return false;
+    }
+    optional_[processorCount_] = optional;
+    processors_[processorCount_++] = &processor;
+    if (optional) {
+        ++optionalCount_;
+    }
+    return true;
+}
+
+long __stdcall AudioInsert::Callback(void* user, long command, void* data, long /*synchro*/) {
+    AudioInsert* insert = static_cast<AudioInsert*>(user);
+    switch (command) {
+    case VBVMR_CBCOMMAND_STARTING: {
+        const VBVMR_T_AUDIOINFO* info = static_cast<const VBVMR_T_AUDIOINFO*>(data);
+        insert->Start(static_cast<uint32_t>(info->samplerate), static_cast<uint32_t>(info->nbSamplePerFrame));
+        break;
+    }
+    case VBVMR_CBCOMMAND_ENDING:
+        insert->prepared_ = false;
+        insert->sampleRate_.store(0, std::memory_order_relaxed);
+        insert->frames_.store(0, std::memory_order_relaxed);
+        break;
+    case VBVMR_CBCOMMAND_CHANGE:
+        if (insert->onStreamChange) {
+            insert->onStreamChange();
+        }
+        break;
+    case VBVMR_CBCOMMAND_BUFFER_MAIN:
+        insert->ProcessMain(*static_cast<const VBVMR_T_AUDIOBUFFER*>(data));
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+void AudioInsert::Start(uint32_t sampleRate, uint32_t frames) {
+    // Not a buffer yet: Voicemeeter lets STARTING take its time, so logging is fine here.
+    prepared_ = sampleRate > 0 && frames > 0 && frames <= AUDIO_MAX_FRAMES;
+    if (!prepared_) {
+        LOG_WARNING("[AudioInsert::Start] Unsupported stream (" + std::to_string(sampleRate) + " Hz, " +
+                    std::to_string(frames) + " frames). Audio processors are bypassed.");
+    } else {
+        for (size_t i = 0; i < processorCount_; ++i) {
+            processors_[i]->Prepare(sampleRate, frames);
+        }
+    }
+    // Gaps across a restart are not jitter, and a new stream gets a fresh budget.
+    lastStart_ = Clock::time_point();
+    overBudgetRun_ = 0;
+    bypassing_ = false;
+    bypassed_.store(false, std::memory_order_relaxed);
+    if (bypassedGauge_) {
+        bypassedGauge_->Set(0.0);
+    }
+
+    sampleRate_.store(sampleRate, std::memory_order_relaxed);
+    frames_.store(frames, std::memory_order_relaxed);
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioInsert::ProcessMain(const VBVMR_T_AUDIOBUFFER& buffer) {
+    Clock::time_point start = Clock::now();
+    uint32_t frames = static_cast<uint32_t>(buffer.audiobuffer_nbs);
+    uint32_t outputs = static_cast<uint32_t>((std::min)(buffer.audiobuffer_nbo, buffer.audiobuffer_nbi));
+    uint32_t inputs = static_cast<uint32_t>(buffer.audiobuffer_nbi) - outputs;
+
+    // The read side holds every strip and then every bus; the write side the buses only.
+    float* const* busIn = buffer.audiobuffer_r + inputs;
+    for (uint32_t k = 0; k < outputs; ++k) {
+        if (buffer.audiobuffer_w[k] != busIn[k]) {
+            std::memcpy(buffer.audiobuffer_w[k], busIn[k], frames * sizeof(float));
+        }
+    }
+    buffers_.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t sampleRate = static_cast<uint32_t>(buffer.audiobuffer_sr);
+    if (prepared_ && processorCount_ > 0 && frames <= AUDIO_MAX_FRAMES) {
+        AudioBlock block;
+        block.sampleRate = sampleRate;
+        block.frames = frames;
+        block.inputCount = inputs;
+        block.outputCount = (std::min)(outputs, static_cast<uint32_t>(AUDIO_MAX_BUS_CHANNELS));
+        block.inputs = buffer.audiobuffer_r;
+        block.outputs = buffer.audiobuffer_w;
+
+        unsigned int csr = _mm_getcsr();
+        _mm_setcsr(csr | MXCSR_FTZ_DAZ);
+        for (size_t i = 0; i < processorCount_; ++i) {
+            if (!(bypassing_ && optional_[i])) {
+                processors_[i]->Process(block);
+            }
+        }
+        _mm_setcsr(csr);
+    }
+
+    if (sampleRate > 0 && frames > 0) {
+        Monitor(start, Clock::now(), sampleRate, frames);
+    }
+}
+
+void AudioInsert::Monitor(Clock::time_point start, Clock::time_point end, uint32_t sampleRate, uint32_t frames) {
+    double period = static_cast<double>(frames) / sampleRate;
+    double processing = std::chrono::duration<double>(end - start).count() / period;
+    if (processingHistogram_) {
+        processingHistogram_->Observe(processing);
+    }
+    RaiseMax(maxProcessing_, processing);
+
+    if (lastStart_ != Clock::time_point()) {
+        double jitter = std::fabs(std::chrono::duration<double>(start - lastStart_).count() - period) / period;
+        if (jitterHistogram_) {
+            jitterHistogram_->Observe(jitter);
+        }
+        RaiseMax(maxJitter_, jitter);
+    }
+    lastStart_ = start;
+
+    bool missed = processing > 1.0;
+    if (missed) {
+        deadlineMisses_.fetch_add(1, std::memory_order_relaxed);
+        if (deadlineMissCounter_) {
+            deadlineMissCounter_->Add(1.0);
+        }
+    }
+    if (processing > AUDIO_BUDGET_FRACTION) {
+        ++overBudgetRun_;
+        overBudget_.fetch_add(1, std::memory_order_relaxed);
+        if (overBudgetCounter_) {
+            overBudgetCounter_->Add(1.0);
+        }
+    } else {
+        overBudgetRun_ = 0;
+    }
+
+    // The hold ends on wall time, so a bypass cannot outlive a stalled stream by buffers.
+    if (bypassing_ && end >= bypassUntil_) {
+        bypassing_ = false;
+        bypassed_.store(false, std::memory_order_relaxed);
+        if (bypassedGauge_) {
+            bypassedGauge_->Set(0.0);
+        }
+    }
+    if (!bypassing_ && optionalCount_ > 0 && (missed || overBudgetRun_ >= AUDIO_BYPASS_AFTER_BUFFERS)) {
+        bypassing_ = true;
+        bypassUntil_ = end + bypassHold_;
+        overBudgetRun_ = 0;
+        bypasses_.fetch_add(1, std::memory_order_relaxed);
+        bypassed_.store(true, std::memory_order_relaxed);
+        if (bypassCounter_) {
+            bypassCounter_->Add(1.0);
+        }
+        if (bypassedGauge_) {
+            bypassedGauge_->Set(1.0);
+        }
+    }
+}
+
+AudioInsert::Stats AudioInsert::GetStats() const {
+    Stats stats;
+    stats.buffers = buffers_.load(std::memory_order_relaxed);
+    stats.restarts = restarts_.load(std::memory_order_relaxed);
+    stats.sampleRate = sampleRate_.load(std::memory_order_relaxed);
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.overBudget = overBudget_.load(std::memory_order_relaxed);
+    stats.deadlineMisses = deadlineMisses_.load(std::memory_order_relaxed);
+    stats.bypasses = bypasses_.load(std::memory_order_relaxed);
+    stats.bypassed = bypassed_.load(std::memory_order_relaxed);
+    stats.maxProcessing = maxProcessing_.load(std::memory_order_relaxed);
+    stats.maxJitter = maxJitter_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool AudioInsert::Benchmark(uint32_t seconds) {
+    if (seconds < 1 || seconds > AUDIO_BENCH_MAX_SECONDS) {
+        LOG_ERROR("[AudioInsert::Benchmark] Duration must be 1-" + std::to_string(AUDIO_BENCH_MAX_SECONDS) + " seconds.");
+        return false;
+    }
+
+    SpinProcessor optional;
+    CountingProcessor required;
+    AudioInsert insert;
+    insert.bypassHold_ = std::chrono::milliseconds(BENCH_BYPASS_HOLD_MS);
+    insert.AddProcessor(optional, true);
+    insert.AddProcessor(required);
+    SyntheticAudioDriver driver(insert, VOICEMEETER_POTATO);
+    uint32_t sampleRate = driver.SampleRate();
+    uint32_t frames = driver.Frames();
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(frames) / sampleRate));
+
+    uint64_t buffers = 0;
+    std::vector<double> micros;
+    Clock::time_point next = Clock::now();
+    auto runRealTime = [&](double duration) {
+        uint64_t count = static_cast<uint64_t>(duration * sampleRate / frames);
+        for (uint64_t b = 0; b < count; ++b) {
+            micros.push_back(driver.RunBuffer());
+            ++buffers;
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    };
+
+    // Steady: only the pacing of the loop moves the jitter.
+    driver.Start();
+    runRealTime(seconds);
+    Stats steady = insert.GetStats();
+
+    // Overload: the optional processor takes 40 % of the period on every buffer it gets.
+    optional.spin = std::chrono::duration_cast<Clock::duration>(period * BENCH_OVERLOAD_FRACTION);
+    uint64_t spinCallsBefore = optional.calls;
+    uint64_t buffersBefore = buffers;
+    runRealTime(BENCH_OVERLOAD_SECONDS);
+    uint64_t overloadBuffers = buffers - buffersBefore;
+    uint64_t overloadCalls = optional.calls - spinCallsBefore;
+    Stats overloaded = insert.GetStats();
+
+    // Recovery: fast again; the bypass ends and does not come back.
+    optional.spin = Clock::duration(0);
+    runRealTime(BENCH_BYPASS_HOLD_MS / 1000.0 + 0.5);
+    Stats recovered = insert.GetStats();
+
+    // One buffer past the deadline bypasses at once.
+    optional.spin = std::chrono::duration_cast<Clock::duration>(period * BENCH_MISS_FRACTION);
+    micros.push_back(driver.RunBuffer());
+    ++buffers;
+    optional.spin = Clock::duration(0);
+    Stats missed = insert.GetStats();
+    driver.Stop();
+
+    std::sort(micros.begin(), micros.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    double periodMicros = 1e6 * frames / sampleRate;
+    LOG_INFO("[AudioInsert::Benchmark] " + std::to_string(buffers) + " buffers of " + std::to_string(frames) +
+             " frames at " + std::to_string(sampleRate) + " Hz, period " + std::to_string(periodMicros) +
+             " us. Callback p50: " + std::to_string(at(micros, 0.5)) + " us, p99: " + std::to_string(at(micros, 0.99)) +
+             " us. Steady: max callback " + std::to_string(steady.maxProcessing * 100.0) + " % of the period, max jitter " +
+             std::to_string(steady.maxJitter * 100.0) + " %.");
+    LOG_INFO("[AudioInsert::Benchmark] Overload: slow processor ran " + std::to_string(overloadCalls) + " of " +
+             std::to_string(overloadBuffers) + " buffers, " + std::to_string(overloaded.bypasses) +
+             " bypasses. Deadline miss: " + std::to_string(missed.deadlineMisses) + " counted, bypassed " +
+             (missed.bypassed ? "at once." : "late."));
+
+    bool correct = steady.overBudget == 0 && steady.bypasses == 0 && steady.deadlineMisses == 0 &&
+                   overloaded.bypasses > 0 && overloadCalls < overloadBuffers &&
+                   overloaded.overBudget == overloadCalls && overloaded.deadlineMisses == 0 &&
+                   recovered.bypasses == overloaded.bypasses && !recovered.bypassed &&
+                   missed.deadlineMisses == 1 && missed.bypassed && missed.bypasses == recovered.bypasses + 1 &&
+                   required.calls == buffers;
+    if (!correct) {
+        LOG_ERROR("[AudioInsert::Benchmark] Over budget: " + std::to_string(steady.overBudget) + " steady, " +
+                  std::to_string(overloaded.overBudget) + " after overload. Bypasses: " +
+                  std::to_string(steady.bypasses) + ", " + std::to_string(overloaded.bypasses) + ", " +
+                  std::to_string(recovered.bypasses) + ", " + std::to_string(missed.bypasses) + ". Required processor ran " +
+                  std::to_string(required.calls) + " of " + std::to_string(buffers) + " buffers.");
+    }
+    return correct;
+}
+
+SyntheticAudioDriver::SyntheticAudioDriver(AudioInsert& insert, long voicemeeterType, uint32_t sampleRate,
+                                           uint32_t frames)
+    : insert_(insert), sampleRate_(sampleRate), frames_(frames), buffer_(std::make_unique<VBVMR_T_AUDIOBUFFER>()) {
+    SceneLayout layout = SceneLogic::GetLayout(voicemeeterType);
+    uint32_t virtualStrips = layout.virtualBuses;
+    uint32_t physicalStrips = layout.stripCount - virtualStrips;
+    inputs_ = physicalStrips * PHYSICAL_STRIP_CHANNELS + virtualStrips * VIRTUAL_STRIP_CHANNELS;
+    buses_ = layout.busCount * static_cast<uint32_t>(AUDIO_CHANNELS_PER_BUS);
+
+    read_.assign(static_cast<size_t>(inputs_ + buses_) * frames_, 0.0f);
+    write_.assign(static_cast<size_t>(buses_) * frames_, 0.0f);
+
+    std::memset(buffer_.get(), 0, sizeof(VBVMR_T_AUDIOBUFFER));
+    buffer_->audiobuffer_sr = static_cast<long>(sampleRate_);
+    buffer_->audiobuffer_nbs = static_cast<long>(frames_);
+    buffer_->audiobuffer_nbi = static_cast<long>(inputs_ + buses_);
+    buffer_->audiobuffer_nbo = static_cast<long>(buses_);
+    for (uint32_t i = 0; i < inputs_ + buses_; ++i) {
+        buffer_->audiobuffer_r[i] = &read_[static_cast<size_t>(i) * frames_];
+    }
+    for (uint32_t i = 0; i < buses_; ++i) {
+        buffer_->audiobuffer_w[i] = &write_[static_cast<size_t>(i) * frames_];
+    }
+}
+
+SyntheticAudioDriver::~SyntheticAudioDriver() = default;
+
+void SyntheticAudioDriver::Start() {
+    VBVMR_T_AUDIOINFO info;
+    info.samplerate = static_cast<long>(sampleRate_);
+    info.nbSamplePerFrame = static_cast<long>(frames_);
+    AudioInsert::Callback(&insert_, VBVMR_CBCOMMAND_STARTING, &info, 0);
+}
+
+double SyntheticAudioDriver::RunBuffer() {
+    auto start = std::chrono::steady_clock::now();
+    AudioInsert::Callback(&insert_, VBVMR_CBCOMMAND_BUFFER_MAIN, buffer_.get(), 0);
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SyntheticAudioDriver::Stop() {
+    AudioInsert::Callback(&insert_, VBVMR_CBCOMMAND_ENDING, nullptr, 0);
+}
@@ -0,0 +1,277 @@
+// AudioKernels.cpp
+#include "AudioKernels.h"
+
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float INT16_SCALE = 32768.0f;
+constexpr float INT16_MIN_FLOAT = -32768.0f;
+constexpr float INT16_MAX_FLOAT = 32767.0f;
+
+// Scalar reference
+
+float ScalarPeakAbs(const float* in, size_t count) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        peak = (std::max)(peak, std::fabs(in[i]));
+    }
+    return peak;
+}
+
+double ScalarSumSquares(const float* in, size_t count) {
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += static_cast<double>(in[i]) * in[i];
+    }
+    return sum;
+}
+
+double ScalarDotProduct(const float* a, const float* b, size_t count) {
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+void ScalarGainRamp(const float* in, float* out, size_t count, float start, float step) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i] * (start + step * static_cast<float>(i));
+    }
+}
+
+void ScalarMixAdd(const float* in, float* out, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] += in[i] * gain;
+    }
+}
+
+void ScalarFloatToInt16(const float* in, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float scaled = (std::min)((std::max)(in[i] * INT16_SCALE, INT16_MIN_FLOAT), INT16_MAX_FLOAT);
+        out[i] = static_cast<int16_t>(std::lrint(scaled));
+    }
+}
+
+void ScalarInt16ToFloat(const int16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * (1.0f / INT16_SCALE);
+    }
+}
+
+constexpr KernelTable SCALAR_KERNELS = {ScalarPeakAbs, ScalarSumSquares,   ScalarDotProduct,  ScalarGainRamp,
+                                        ScalarMixAdd,  ScalarFloatToInt16, ScalarInt16ToFloat};
+
+// SSE2: part of x64, so always available
+
+float Sse2PeakAbs(const float* in, size_t count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak0 = _mm_setzero_ps();
+    __m128 peak1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak0 = _mm_max_ps(peak0, _mm_and_ps(_mm_loadu_ps(in + i), absMask));
+        peak1 = _mm_max_ps(peak1, _mm_and_ps(_mm_loadu_ps(in + i + 4), absMask));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_max_ps(peak0, peak1));
+    float peak = (std::max)((std::max)(lanes[0], lanes[1]), (std::max)(lanes[2], lanes[3]));
+    return (std::max)(peak, ScalarPeakAbs(in + i, count - i));
+}
+
+double Sse2SumSquares(const float* in, size_t count) {
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(in + i);
+        __m128d low = _mm_cvtps_pd(x);
+        __m128d high = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(low, low));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(high, high));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(sum0, sum1));
+    return lanes[0] + lanes[1] + ScalarSumSquares(in + i, count - i);
+}
+
+double Sse2DotProduct(const float* a, const float* b, size_t count) {
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(a + i);
+        __m128 y = _mm_loadu_ps(b + i);
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_cvtps_pd(x), _mm_cvtps_pd(y)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(y, y))));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(sum0, sum1));
+    return lanes[0] + lanes[1] + ScalarDotProduct(a + i, b + i, count - i);
+}
+
+void Sse2GainRamp(const float* in, float* out, size_t count, float start, float step) {
+    const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 starts = _mm_set1_ps(start);
+    const __m128 steps = _mm_set1_ps(step);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), offsets);
+        __m128 gain = _mm_add_ps(starts, _mm_mul_ps(steps, index));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), gain));
+    }
+    for (; i < count; ++i) {
+        out[i] = in[i] * (start + step * static_cast<float>(i));
+    }
+}
+
+void Sse2MixAdd(const float* in, float* out, size_t count, float gain) {
+    const __m128 gains = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), gains)));
+    }
+    ScalarMixAdd(in + i, out + i, count - i, gain);
+}
+
+void Sse2FloatToInt16(const float* in, int16_t* out, size_t count) {
+    const __m128 scale = _mm_set1_ps(INT16_SCALE);
+    const __m128 low = _mm_set1_ps(INT16_MIN_FLOAT);
+    const __m128 high = _mm_set1_ps(INT16_MAX_FLOAT);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), low), high);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), low), high);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    ScalarFloatToInt16(in + i, out + i, count - i);
+}
+
+void Sse2Int16ToFloat(const int16_t* in, float* out, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / INT16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by unpacking into the high half and shifting back down.
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    ScalarInt16ToFloat(in + i, out + i, count - i);
+}
+
+constexpr KernelTable SSE2_KERNELS = {Sse2PeakAbs, Sse2SumSquares,   Sse2DotProduct,  Sse2GainRamp,
+                                      Sse2MixAdd,  Sse2FloatToInt16, Sse2Int16ToFloat};
+
+// CPU detection
+
+void Cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4]) {
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        registers[i] = static_cast<uint32_t>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Register state the OS saves on context switches (XCR0)
+uint64_t EnabledRegisterState() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t low = 0;
+    uint32_t high = 0;
+    __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+SimdLevel Detect() {
+    // /arch:AVX2 and /arch:AVX512 let the compiler emit FMA instructions
+    constexpr uint32_t FMA = 1u << 12;         // CPUID.1:ECX
+    constexpr uint32_t OSXSAVE = 1u << 27;     // CPUID.1:ECX
+    constexpr uint32_t AVX = 1u << 28;         // CPUID.1:ECX
+    constexpr uint32_t AVX2 = 1u << 5;         // CPUID.7.0:EBX
+    // /arch:AVX512 lets the compiler use DQ, BW and VL as well as F
+    constexpr uint32_t AVX512 = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);  // CPUID.7.0:EBX
+    constexpr uint64_t YMM_STATE = 0x6;        // XMM and upper YMM
+    constexpr uint64_t ZMM_STATE = 0xE6;       // Plus opmask and both ZMM halves
+
+    uint32_t registers[4] = {};
+    Cpuid(0, 0, registers);
+    uint32_t maxLeaf = registers[0];
+    Cpuid(1, 0, registers);
+    uint32_t features1 = registers[2];
+    if (maxLeaf < 7 || (features1 & (OSXSAVE | AVX | FMA)) != (OSXSAVE | AVX | FMA)) {
+        return SimdLevel::Sse2;
+    }
+    uint64_t state = EnabledRegisterState();
+    Cpuid(7, 0, registers);
+    uint32_t features7 = registers[1];
+    if ((features7 & (AVX512 | AVX2)) == (AVX512 | AVX2) && (state & ZMM_STATE) == ZMM_STATE) {
+        return SimdLevel::Avx512;
+    }
+    if ((features7 & AVX2) && (state & YMM_STATE) == YMM_STATE) {
+        return SimdLevel::Avx2;
+    }
+    return SimdLevel::Sse2;
+}
+}  // namespace
+
+namespace AudioKernels {
+
+const KernelTable& Get() {
+    static const KernelTable* kernels = Table(Level());
+    return *kernels;
+}
+
+SimdLevel Level() {
+    static const SimdLevel level = Detect();
+    return level;
+}
+
+const char* LevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Sse2:
+        return "SSE2";
+    case SimdLevel::Avx2:
+        return "AVX2";
+    case SimdLevel::Avx512:
+        return "AVX-512";
+    }
+    return "unknown";
+}
+
+const KernelTable* Table(SimdLevel level) {
+    if (level > Level()) {
+        return nullptr;
+    }
+    switch (level) {
+    case SimdLevel::Scalar:
+        return &SCALAR_KERNELS;
+    case SimdLevel::Sse2:
+        return &SSE2_KERNELS;
+    case SimdLevel::Avx2:
+        return &Avx2Kernels();
+    case SimdLevel::Avx512:
+        return &Avx512Kernels();
+    }
+    return nullptr;
+}
+
+}  // namespace AudioKernels
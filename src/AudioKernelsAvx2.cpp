@@ -0,0 +1,140 @@
+// AudioKernelsAvx2.cpp
+// The only file built with AVX2; see AudioKernels.h before adding includes or inline helpers.
+#include <immintrin.h>
+
+#include "AudioKernels.h"
+
+#ifdef _MSC_VER
+// /fp:fast would fuse multiply-adds here but not in the other levels.
+#pragma fp_contract(off)
+#endif
+
+namespace {
+constexpr float INT16_SCALE = 32768.0f;
+constexpr float INT16_MIN_FLOAT = -32768.0f;
+constexpr float INT16_MAX_FLOAT = 32767.0f;
+
+float PeakAbs(const float* in, size_t count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 peak0 = _mm256_setzero_ps();
+    __m256 peak1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        peak0 = _mm256_max_ps(peak0, _mm256_and_ps(_mm256_loadu_ps(in + i), absMask));
+        peak1 = _mm256_max_ps(peak1, _mm256_and_ps(_mm256_loadu_ps(in + i + 8), absMask));
+    }
+    __m256 peak8 = _mm256_max_ps(peak0, peak1);
+    __m128 peak4 = _mm_max_ps(_mm256_castps256_ps128(peak8), _mm256_extractf128_ps(peak8, 1));
+    for (; i < count; ++i) {
+        peak4 = _mm_max_ss(peak4, _mm_and_ps(_mm_set_ss(in[i]), _mm256_castps256_ps128(absMask)));
+    }
+    peak4 = _mm_max_ps(peak4, _mm_movehl_ps(peak4, peak4));
+    peak4 = _mm_max_ss(peak4, _mm_shuffle_ps(peak4, peak4, 1));
+    return _mm_cvtss_f32(peak4);
+}
+
+double SumSquares(const float* in, size_t count) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d low = _mm256_cvtps_pd(_mm_loadu_ps(in + i));
+        __m256d high = _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4));
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(low, low));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(high, high));
+    }
+    __m256d sum4 = _mm256_add_pd(sum0, sum1);
+    __m128d sum2 = _mm_add_pd(_mm256_castpd256_pd128(sum4), _mm256_extractf128_pd(sum4, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(sum2, _mm_unpackhi_pd(sum2, sum2)));
+    for (; i < count; ++i) {
+        sum += static_cast<double>(in[i]) * in[i];
+    }
+    return sum;
+}
+
+double DotProduct(const float* a, const float* b, size_t count) {
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d low = _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(a + i)), _mm256_cvtps_pd(_mm_loadu_ps(b + i)));
+        __m256d high = _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(a + i + 4)), _mm256_cvtps_pd(_mm_loadu_ps(b + i + 4)));
+        sum0 = _mm256_add_pd(sum0, low);
+        sum1 = _mm256_add_pd(sum1, high);
+    }
+    __m256d sum4 = _mm256_add_pd(sum0, sum1);
+    __m128d sum2 = _mm_add_pd(_mm256_castpd256_pd128(sum4), _mm256_extractf128_pd(sum4, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(sum2, _mm_unpackhi_pd(sum2, sum2)));
+    for (; i < count; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+void GainRamp(const float* in, float* out, size_t count, float start, float step) {
+    const __m256 offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 starts = _mm256_set1_ps(start);
+    const __m256 steps = _mm256_set1_ps(step);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), offsets);
+        __m256 gain = _mm256_add_ps(starts, _mm256_mul_ps(steps, index));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), gain));
+    }
+    for (; i < count; ++i) {
+        out[i] = in[i] * (start + step * static_cast<float>(i));
+    }
+}
+
+void MixAdd(const float* in, float* out, size_t count, float gain) {
+    const __m256 gains = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), gains)));
+    }
+    for (; i < count; ++i) {
+        out[i] += in[i] * gain;
+    }
+}
+
+void FloatToInt16(const float* in, int16_t* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(INT16_SCALE);
+    const __m256 low = _mm256_set1_ps(INT16_MIN_FLOAT);
+    const __m256 high = _mm256_set1_ps(INT16_MAX_FLOAT);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), low), high);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), low), high);
+        // Packing works within 128-bit lanes; put the quarters back in order.
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    for (; i < count; ++i) {
+        __m128 scaled = _mm_mul_ss(_mm_set_ss(in[i]), _mm256_castps256_ps128(scale));
+        scaled = _mm_min_ss(_mm_max_ss(scaled, _mm256_castps256_ps128(low)), _mm256_castps256_ps128(high));
+        out[i] = static_cast<int16_t>(_mm_cvtss_si32(scaled));
+    }
+}
+
+void Int16ToFloat(const int16_t* in, float* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / INT16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * (1.0f / INT16_SCALE);
+    }
+}
+
+const KernelTable AVX2_KERNELS = {PeakAbs, SumSquares, DotProduct, GainRamp, MixAdd, FloatToInt16, Int16ToFloat};
+}  // namespace
+
+namespace AudioKernels {
+
+const KernelTable& Avx2Kernels() {
+    return AVX2_KERNELS;
+}
+
+}  // namespace AudioKernels
@@ -0,0 +1,139 @@
+// AudioKernelsAvx512.cpp
+// The only file built with AVX-512; see AudioKernels.h before adding includes or inline helpers.
+#include <immintrin.h>
+
+#include "AudioKernels.h"
+
+#ifdef _MSC_VER
+// /fp:fast would fuse multiply-adds here but not in the other levels.
+#pragma fp_contract(off)
+#endif
+
+// Masked loads cover the tails without a scalar loop, except for 16-bit
+// loads, which would need AVX512BW.
+namespace {
+constexpr float INT16_SCALE = 32768.0f;
+constexpr float INT16_MIN_FLOAT = -32768.0f;
+constexpr float INT16_MAX_FLOAT = 32767.0f;
+
+__mmask16 TailMask(size_t remaining) {
+    return static_cast<__mmask16>((1u << remaining) - 1u);
+}
+
+float PeakAbs(const float* in, size_t count) {
+    __m512 peak0 = _mm512_setzero_ps();
+    __m512 peak1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        peak0 = _mm512_max_ps(peak0, _mm512_abs_ps(_mm512_loadu_ps(in + i)));
+        peak1 = _mm512_max_ps(peak1, _mm512_abs_ps(_mm512_loadu_ps(in + i + 16)));
+    }
+    for (; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : TailMask(count - i);
+        peak0 = _mm512_max_ps(peak0, _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, in + i)));
+    }
+    return _mm512_reduce_max_ps(_mm512_max_ps(peak0, peak1));
+}
+
+double SumSquares(const float* in, size_t count) {
+    __m512d sum0 = _mm512_setzero_pd();
+    __m512d sum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d low = _mm512_cvtps_pd(_mm256_loadu_ps(in + i));
+        __m512d high = _mm512_cvtps_pd(_mm256_loadu_ps(in + i + 8));
+        sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(low, low));
+        sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(high, high));
+    }
+    if (i < count) {
+        __m512 tail = _mm512_maskz_loadu_ps(TailMask(count - i), in + i);
+        __m512d low = _mm512_cvtps_pd(_mm512_castps512_ps256(tail));
+        __m512d high = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(tail), 1)));
+        sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(low, low));
+        sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(high, high));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+}
+
+double DotProduct(const float* a, const float* b, size_t count) {
+    __m512d sum0 = _mm512_setzero_pd();
+    __m512d sum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d low = _mm512_mul_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i)), _mm512_cvtps_pd(_mm256_loadu_ps(b + i)));
+        __m512d high = _mm512_mul_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8)),
+                                     _mm512_cvtps_pd(_mm256_loadu_ps(b + i + 8)));
+        sum0 = _mm512_add_pd(sum0, low);
+        sum1 = _mm512_add_pd(sum1, high);
+    }
+    if (i < count) {
+        __mmask16 mask = TailMask(count - i);
+        __m512 tailA = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 tailB = _mm512_maskz_loadu_ps(mask, b + i);
+        __m512d lowA = _mm512_cvtps_pd(_mm512_castps512_ps256(tailA));
+        __m512d lowB = _mm512_cvtps_pd(_mm512_castps512_ps256(tailB));
+        __m512d highA = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(tailA), 1)));
+        __m512d highB = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(tailB), 1)));
+        sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(lowA, lowB));
+        sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(highA, highB));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+}
+
+void GainRamp(const float* in, float* out, size_t count, float start, float step) {
+    const __m512 offsets = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                          8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    const __m512 starts = _mm512_set1_ps(start);
+    const __m512 steps = _mm512_set1_ps(step);
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : TailMask(count - i);
+        __m512 index = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(i)), offsets);
+        __m512 gain = _mm512_add_ps(starts, _mm512_mul_ps(steps, index));
+        _mm512_mask_storeu_ps(out + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, in + i), gain));
+    }
+}
+
+void MixAdd(const float* in, float* out, size_t count, float gain) {
+    const __m512 gains = _mm512_set1_ps(gain);
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : TailMask(count - i);
+        __m512 sum = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, out + i),
+                                   _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, in + i), gains));
+        _mm512_mask_storeu_ps(out + i, mask, sum);
+    }
+}
+
+void FloatToInt16(const float* in, int16_t* out, size_t count) {
+    const __m512 scale = _mm512_set1_ps(INT16_SCALE);
+    const __m512 low = _mm512_set1_ps(INT16_MIN_FLOAT);
+    const __m512 high = _mm512_set1_ps(INT16_MAX_FLOAT);
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : TailMask(count - i);
+        __m512 scaled = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, in + i), scale);
+        __m512i rounded = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(scaled, low), high));
+        _mm512_mask_cvtsepi32_storeu_epi16(out + i, mask, rounded);
+    }
+}
+
+void Int16ToFloat(const int16_t* in, float* out, size_t count) {
+    const __m512 scale = _mm512_set1_ps(1.0f / INT16_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i samples = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(samples), scale));
+    }
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * (1.0f / INT16_SCALE);
+    }
+}
+
+const KernelTable AVX512_KERNELS = {PeakAbs, SumSquares, DotProduct, GainRamp, MixAdd, FloatToInt16, Int16ToFloat};
+}  // namespace
+
+namespace AudioKernels {
+
+const KernelTable& Avx512Kernels() {
+    return AVX512_KERNELS;
+}
+
+}  // namespace AudioKernels
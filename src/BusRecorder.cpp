@@ -0,0 +1,631 @@
+// BusRecorder.cpp
+#include "BusRecorder.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include "Logger.h"
+#include "RAIIHandle.h"
+
+namespace {
+// Header padded to one sector: RIFF, ds64 placeholder, fmt, filler, data chunk header
+constexpr size_t HEADER_BYTES = RECORD_SECTOR_BYTES;
+constexpr size_t DS64_OFFSET = 12;
+constexpr uint32_t DS64_PAYLOAD = 28;
+constexpr size_t FMT_OFFSET = DS64_OFFSET + 8 + DS64_PAYLOAD;
+constexpr uint32_t FMT_PAYLOAD = 40;
+constexpr size_t FILLER_OFFSET = FMT_OFFSET + 8 + FMT_PAYLOAD;
+constexpr size_t DATA_OFFSET = HEADER_BYTES - 8;
+constexpr uint32_t FILLER_PAYLOAD = static_cast<uint32_t>(DATA_OFFSET - FILLER_OFFSET - 8);
+constexpr uint64_t MAX_RIFF_SIZE = 0xFFFFFFFFull;
+
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE_TAG = 0xFFFE;
+constexpr uint16_t SAMPLE_BITS = 32;
+// KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+constexpr uint8_t IEEE_FLOAT_GUID[16] = {0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                         0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+// Benchmark: bus 0 of a Potato stream, all 8 channels
+constexpr uint32_t BENCH_STALL_RINGS = 2;  // Ring lengths offered while the writer stalls
+constexpr uint32_t BENCH_RECOVERY_SECONDS = 1;
+constexpr uint32_t SAMPLE_MASK = 0xFFFFFF;  // Largest integer range a float holds exactly
+
+void Put16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void Put32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void Put64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t Get32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+/**
+ * Fills the header sector. A file still being written claims the largest
+ * sizes, so a recording cut short by a crash stays readable up to its end.
+ */
+void BuildHeader(uint8_t* header, uint32_t sampleRate, uint16_t channels, bool final, uint64_t dataBytes) {
+    std::memset(header, 0, HEADER_BYTES);
+    uint16_t blockAlign = static_cast<uint16_t>(channels * (SAMPLE_BITS / 8));
+    uint64_t riffSize = HEADER_BYTES - 8 + dataBytes;
+    bool rf64 = final && riffSize > MAX_RIFF_SIZE;
+
+    std::memcpy(header, rf64 ? "RF64" : "RIFF", 4);
+    Put32(header + 4, final && !rf64 ? static_cast<uint32_t>(riffSize) : 0xFFFFFFFFu);
+    std::memcpy(header + 8, "WAVE", 4);
+
+    // Reserved for ds64 (EBU Tech 3306) and only turned into one past 4 GiB.
+    std::memcpy(header + DS64_OFFSET, rf64 ? "ds64" : "JUNK", 4);
+    Put32(header + DS64_OFFSET + 4, DS64_PAYLOAD);
+    if (rf64) {
+        Put64(header + DS64_OFFSET + 8, riffSize);
+        Put64(header + DS64_OFFSET + 16, dataBytes);
+        Put64(header + DS64_OFFSET + 24, dataBytes / blockAlign);
+    }
+
+    // Speaker positions are left unassigned: a tap may take any channels of a bus.
+    uint8_t* fmt = header + FMT_OFFSET;
+    std::memcpy(fmt, "fmt ", 4);
+    Put32(fmt + 4, FMT_PAYLOAD);
+    Put16(fmt + 8, WAVE_FORMAT_EXTENSIBLE_TAG);
+    Put16(fmt + 10, channels);
+    Put32(fmt + 12, sampleRate);
+    Put32(fmt + 16, sampleRate * blockAlign);
+    Put16(fmt + 20, blockAlign);
+    Put16(fmt + 22, SAMPLE_BITS);
+    Put16(fmt + 24, 22);
+    Put16(fmt + 26, SAMPLE_BITS);
+    Put32(fmt + 28, 0);
+    std::memcpy(fmt + 32, IEEE_FLOAT_GUID, sizeof(IEEE_FLOAT_GUID));
+
+    std::memcpy(header + FILLER_OFFSET, "JUNK", 4);
+    Put32(header + FILLER_OFFSET + 4, FILLER_PAYLOAD);
+
+    std::memcpy(header + DATA_OFFSET, "data", 4);
+    Put32(header + DATA_OFFSET + 4, final && !rf64 ? static_cast<uint32_t>(dataBytes) : 0xFFFFFFFFu);
+}
+
+uint8_t* AlignToSector(std::vector<uint8_t>& storage, size_t bytes) {
+    storage.assign(bytes + RECORD_SECTOR_BYTES, 0);
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+    uintptr_t aligned = (address + RECORD_SECTOR_BYTES - 1) & ~static_cast<uintptr_t>(RECORD_SECTOR_BYTES - 1);
+    return storage.data() + (aligned - address);
+}
+
+std::string FileName(uint8_t bus) {
+    SYSTEMTIME now;
+    GetLocalTime(&now);
+    char name[64];
+    std::snprintf(name, sizeof(name), "voicemirror-bus%u-%04u%02u%02u-%02u%02u%02u-%03u.wav", static_cast<unsigned>(bus),
+                  static_cast<unsigned>(now.wYear), static_cast<unsigned>(now.wMonth), static_cast<unsigned>(now.wDay),
+                  static_cast<unsigned>(now.wHour), static_cast<unsigned>(now.wMinute),
+                  static_cast<unsigned>(now.wSecond), static_cast<unsigned>(now.wMilliseconds));
+    return name;
+}
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (;;) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+bool ParseNumber(const std::string& text, long minimum, long maximum, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= minimum && value <= maximum;
+}
+
+float BenchSample(uint64_t frame, size_t channel) {
+    return static_cast<float>((frame * RECORD_MAX_CHANNELS + channel) & SAMPLE_MASK);
+}
+
+// Reads a benchmark recording back and checks every frame; gaps must be whole dropped buffers.
+bool VerifyRecording(const std::string& path, uint32_t sampleRate, uint32_t frames, const BusRecorder::Stats& stats,
+                     uint64_t& gapFrames, uint64_t& mismatches) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("[BusRecorder::Benchmark] Cannot read back " + path + ".");
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    uint8_t header[HEADER_BYTES];
+    if (fileSize < HEADER_BYTES || !file.read(reinterpret_cast<char*>(header), HEADER_BYTES)) {
+        LOG_ERROR("[BusRecorder::Benchmark] " + path + " is shorter than its header.");
+        return false;
+    }
+    uint64_t dataBytes = fileSize - HEADER_BYTES;
+    size_t frameBytes = RECORD_MAX_CHANNELS * sizeof(float);
+    bool headerOk = std::memcmp(header, "RIFF", 4) == 0 && Get32(header + 4) == fileSize - 8 &&
+                    std::memcmp(header + 8, "WAVE", 4) == 0 && std::memcmp(header + FMT_OFFSET, "fmt ", 4) == 0 &&
+                    Get32(header + FMT_OFFSET + 12) == sampleRate && (header[FMT_OFFSET + 10] == RECORD_MAX_CHANNELS) &&
+                    std::memcmp(header + DATA_OFFSET, "data", 4) == 0 && Get32(header + DATA_OFFSET + 4) == dataBytes &&
+                    dataBytes == stats.frames * frameBytes;
+    if (!headerOk) {
+        LOG_ERROR("[BusRecorder::Benchmark] Header of " + path + " does not match its " + std::to_string(dataBytes) +
+                  " data bytes and " + std::to_string(stats.frames) + " recorded frames.");
+        return false;
+    }
+
+    // Channel 0 carries the frame index, so a dropped buffer shows as a jump.
+    const uint64_t indexRange = (static_cast<uint64_t>(SAMPLE_MASK) + 1) / RECORD_MAX_CHANNELS;
+    std::vector<float> chunk(RECORD_MAX_CHANNELS * 4096);
+    uint64_t expected = 0;
+    uint64_t remaining = dataBytes / frameBytes;
+    gapFrames = 0;
+    mismatches = 0;
+    while (remaining > 0) {
+        size_t count = static_cast<size_t>((std::min)(remaining, static_cast<uint64_t>(4096)));
+        if (!file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(count * frameBytes))) {
+            LOG_ERROR("[BusRecorder::Benchmark] Short read from " + path + ".");
+            return false;
+        }
+        for (size_t f = 0; f < count; ++f) {
+            const float* frame = &chunk[f * RECORD_MAX_CHANNELS];
+            uint64_t index = static_cast<uint64_t>(frame[0]) / RECORD_MAX_CHANNELS;
+            uint64_t gap = (index + indexRange - expected % indexRange) % indexRange;
+            if (gap != 0) {
+                if (gap % frames != 0) {
+                    ++mismatches;
+                }
+                gapFrames += gap;
+                expected += gap;
+            }
+            for (size_t c = 0; c < RECORD_MAX_CHANNELS; ++c) {
+                if (frame[c] != BenchSample(expected, c)) {
+                    ++mismatches;
+                }
+            }
+            ++expected;
+        }
+        remaining -= count;
+    }
+    return true;
+}
+}  // namespace
+
+/**
+ * @brief One WAV file written with unbuffered, sector-aligned writes.
+ */
+class WavFileWriter {
+public:
+    bool Open(const std::string& path, uint32_t sampleRate, uint16_t channels) {
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        header_ = AlignToSector(headerStorage_, HEADER_BYTES);
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            LOG_ERROR("[BusRecorder::OpenFile] Failed to create " + path + ". Error: " + std::to_string(GetLastError()));
+            return false;
+        }
+        file_ = RAIIHandle(file);
+
+        BuildHeader(header_, sampleRate_, channels_, false, 0);
+        return Write(header_, HEADER_BYTES);
+    }
+
+    /**
+     * @brief Appends @p bytes from a sector-aligned buffer; @p bytes is a whole number of sectors.
+     */
+    bool Write(const uint8_t* data, size_t bytes) {
+        DWORD written = 0;
+        if (!WriteFile(file_.get(), data, static_cast<DWORD>(bytes), &written, nullptr) || written != bytes) {
+            LOG_ERROR("[BusRecorder::WriteBlock] WriteFile failed. Error: " + std::to_string(GetLastError()));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes the final header and cuts the sector padding off the end.
+     */
+    bool Finish(uint64_t dataBytes) {
+        BuildHeader(header_, sampleRate_, channels_, true, dataBytes);
+        LARGE_INTEGER position;
+        position.QuadPart = 0;
+        bool ok = SetFilePointerEx(file_.get(), position, nullptr, FILE_BEGIN) && Write(header_, HEADER_BYTES);
+        position.QuadPart = static_cast<LONGLONG>(HEADER_BYTES + dataBytes);
+        ok = SetFilePointerEx(file_.get(), position, nullptr, FILE_BEGIN) && SetEndOfFile(file_.get()) && ok;
+        file_ = RAIIHandle();
+        return ok;
+    }
+
+private:
+    RAIIHandle file_;
+    std::vector<uint8_t> headerStorage_;
+    uint8_t* header_ = nullptr;
+    uint32_t sampleRate_ = 0;
+    uint16_t channels_ = 0;
+};
+
+BusRecorder::BusRecorder() = default;
+
+BusRecorder::~BusRecorder() {
+    Stop();
+}
+
+bool BusRecorder::ParseTarget(const std::string& text, RecordTarget& target) {
+    std::vector<std::string> parts = Split(text, ':');
+    long bus = 0;
+    if (parts.size() > 2 || !ParseNumber(parts[0], 0, static_cast<long>(AUDIO_MAX_BUSES) - 1, bus)) {
+        return false;
+    }
+
+    RecordTarget parsed;
+    parsed.bus = static_cast<uint8_t>(bus);
+    if (parts.size() == 2) {
+        std::vector<std::string> range = Split(parts[1], '-');
+        long first = 0;
+        long last = 0;
+        long maxChannel = static_cast<long>(AUDIO_CHANNELS_PER_BUS) - 1;
+        if (range.size() > 2 || !ParseNumber(range[0], 0, maxChannel, first)) {
+            return false;
+        }
+        last = first;
+        if (range.size() == 2 && !ParseNumber(range[1], first, maxChannel, last)) {
+            return false;
+        }
+        parsed.firstChannel = static_cast<uint8_t>(first);
+        parsed.channelCount = static_cast<uint8_t>(last - first + 1);
+    }
+    target = parsed;
+    return true;
+}
+
+bool BusRecorder::Start(const RecordTarget& target, const std::string& directory) {
+    if (running_) {
+        return true;
+    }
+    if (target.bus >= AUDIO_MAX_BUSES || target.channelCount == 0 ||
+        target.firstChannel + target.channelCount > AUDIO_CHANNELS_PER_BUS) {
+        LOG_ERROR("[BusRecorder::Start] Invalid recording target.");
+        return false;
+    }
+
+    target_ = target;
+    directory_ = directory;
+    channels_ = target.channelCount;
+    ring_ = std::make_unique<SpscRing<float>>(RECORD_RING_FRAMES * channels_);
+    block_ = AlignToSector(blockStorage_, RECORD_WRITE_BLOCK_BYTES);
+    blockFill_ = 0;
+
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    frameCounter_ = registry.Counter("voicemirror_record_frames_total", "Frames captured by the bus recording tap.");
+    overrunCounter_ = registry.Counter("voicemirror_record_overruns_total",
+                                       "Buffers the bus recording tap dropped because its ring was full.");
+    bytesCounter_ = registry.Counter("voicemirror_record_bytes_written_total", "Sample bytes written to recordings.");
+
+    running_ = true;
+    thread_ = std::thread(&BusRecorder::WriterProc, this);
+    LOG_INFO("[BusRecorder::Start] Recording channels " + std::to_string(target.firstChannel) + "-" +
+             std::to_string(target.firstChannel + target.channelCount - 1) + " of bus " + std::to_string(target.bus) +
+             " into " + (directory.empty() ? std::string("the working directory") : directory) + ".");
+    return true;
+}
+
+void BusRecorder::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    Stats stats = GetStats();
+    LOG_INFO("[BusRecorder::Stop] Recorded " + std::to_string(stats.frames) + " frames into " +
+             std::to_string(stats.files) + " files, " + std::to_string(stats.overruns) + " overruns (" +
+             std::to_string(stats.droppedFrames) + " frames dropped), " + std::to_string(stats.writeErrors) +
+             " write errors.");
+}
+
+void BusRecorder::Prepare(uint32_t sampleRate, uint32_t /*frames*/) {
+    if (!ring_) {
+        return;
+    }
+    // The writer starts a new file from this ring position on.
+    streamStart_.store(ring_->WritePosition(), std::memory_order_relaxed);
+    streamRate_.store(sampleRate, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void BusRecorder::Process(const AudioBlock& block) {
+    if (!ring_ || streamRate_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    size_t first = target_.bus * AUDIO_CHANNELS_PER_BUS + target_.firstChannel;
+    if (first + channels_ > block.outputCount) {
+        return;
+    }
+
+    size_t samples = static_cast<size_t>(block.frames) * channels_;
+    if (ring_->Free() < samples) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames_.fetch_add(block.frames, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t position = ring_->WritePosition();
+    for (size_t c = 0; c < channels_; ++c) {
+        const float* in = block.outputs[first + c];
+        for (uint32_t i = 0; i < block.frames; ++i) {
+            ring_->At(position + i * channels_ + c) = in[i];
+        }
+    }
+    ring_->Commit(samples);
+    frames_.fetch_add(block.frames, std::memory_order_relaxed);
+
+    size_t used = (ring_->Capacity() - ring_->Free()) / channels_;
+    if (used > ringPeak_.load(std::memory_order_relaxed)) {
+        ringPeak_.store(used, std::memory_order_relaxed);
+    }
+}
+
+void BusRecorder::WriterProc() {
+    uint32_t generation = 0;
+    for (;;) {
+        // Checked before draining, so everything committed before Stop() is written.
+        bool stopping = !running_.load(std::memory_order_acquire);
+
+        if (stallWriter_.load(std::memory_order_relaxed) && !stopping) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(RECORD_WRITE_INTERVAL_MS));
+            continue;
+        }
+
+        uint32_t current = generation_.load(std::memory_order_acquire);
+        if (current != generation) {
+            size_t start = streamStart_.load(std::memory_order_relaxed);
+            uint32_t sampleRate = streamRate_.load(std::memory_order_relaxed);
+            Drain(start);
+            CloseFile();
+            OpenFile(sampleRate);
+            generation = current;
+        }
+
+        size_t drained = Drain(SIZE_MAX);
+        PublishMetrics();
+        if (stopping) {
+            break;
+        }
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(RECORD_WRITE_INTERVAL_MS));
+        }
+    }
+    CloseFile();
+    PublishMetrics();
+}
+
+size_t BusRecorder::Drain(size_t limit) {
+    size_t drained = 0;
+    for (;;) {
+        size_t count = 0;
+        const float* data = ring_->Contiguous(count);
+        count = (std::min)(count, limit - ring_->ReadPosition());
+        count = (std::min)(count, (RECORD_WRITE_BLOCK_BYTES - blockFill_) / sizeof(float));
+        if (count == 0) {
+            return drained;
+        }
+        // Without a file (it failed to open) samples are consumed and lost.
+        if (file_) {
+            std::memcpy(block_ + blockFill_, data, count * sizeof(float));
+            blockFill_ += count * sizeof(float);
+        }
+        ring_->Release(count);
+        drained += count;
+        if (blockFill_ == RECORD_WRITE_BLOCK_BYTES) {
+            WriteBlock();
+        }
+    }
+}
+
+bool BusRecorder::WriteBlock() {
+    // Whole sectors only; the tail of the last block is padded and cut off in CloseFile().
+    size_t bytes = (blockFill_ + RECORD_SECTOR_BYTES - 1) & ~(RECORD_SECTOR_BYTES - 1);
+    std::memset(block_ + blockFill_, 0, bytes - blockFill_);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = file_->Write(block_, bytes);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (ms > maxWriteMs_.load(std::memory_order_relaxed)) {
+        maxWriteMs_.store(ms, std::memory_order_relaxed);
+    }
+
+    if (ok) {
+        fileBytes_ += blockFill_;
+        bytesWritten_.fetch_add(blockFill_, std::memory_order_relaxed);
+    } else {
+        writeErrors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    blockFill_ = 0;
+    return ok;
+}
+
+void BusRecorder::OpenFile(uint32_t sampleRate) {
+    if (sampleRate == 0) {
+        return;
+    }
+    std::string path = FileName(target_.bus);
+    if (!directory_.empty()) {
+        char last = directory_.back();
+        path = directory_ + (last == '\\' || last == '/' ? "" : "\\") + path;
+    }
+
+    auto file = std::make_unique<WavFileWriter>();
+    if (!file->Open(path, sampleRate, static_cast<uint16_t>(channels_))) {
+        writeErrors_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    file_ = std::move(file);
+    fileBytes_ = 0;
+    fileCount_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<ProfiledMutex> lock(filesMutex_);
+        files_.push_back(path);
+    }
+    LOG_INFO("[BusRecorder::OpenFile] Recording " + std::to_string(channels_) + " channels at " +
+             std::to_string(sampleRate) + " Hz into " + path + ".");
+}
+
+void BusRecorder::CloseFile() {
+    if (!file_) {
+        return;
+    }
+    if (blockFill_ > 0) {
+        WriteBlock();
+    }
+    if (!file_->Finish(fileBytes_)) {
+        writeErrors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    file_.reset();
+    LOG_DEBUG("[BusRecorder::CloseFile] Closed recording with " + std::to_string(fileBytes_) + " data bytes" +
+              (HEADER_BYTES - 8 + fileBytes_ > MAX_RIFF_SIZE ? " as RF64." : "."));
+}
+
+void BusRecorder::PublishMetrics() {
+    if (frameCounter_) {
+        frameCounter_->Set(static_cast<double>(frames_.load(std::memory_order_relaxed)));
+    }
+    if (overrunCounter_) {
+        overrunCounter_->Set(static_cast<double>(overruns_.load(std::memory_order_relaxed)));
+    }
+    if (bytesCounter_) {
+        bytesCounter_->Set(static_cast<double>(bytesWritten_.load(std::memory_order_relaxed)));
+    }
+}
+
+std::vector<std::string> BusRecorder::Files() const {
+    std::lock_guard<ProfiledMutex> lock(filesMutex_);
+    return files_;
+}
+
+BusRecorder::Stats BusRecorder::GetStats() const {
+    Stats stats;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    stats.files = fileCount_.load(std::memory_order_relaxed);
+    stats.writeErrors = writeErrors_.load(std::memory_order_relaxed);
+    stats.ringPeakFrames = ringPeak_.load(std::memory_order_relaxed);
+    stats.maxWriteMs = maxWriteMs_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool BusRecorder::Benchmark(uint32_t seconds) {
+    if (seconds < 1 || seconds > RECORD_BENCH_MAX_SECONDS) {
+        LOG_ERROR("[BusRecorder::Benchmark] Duration must be 1-" + std::to_string(RECORD_BENCH_MAX_SECONDS) + " seconds.");
+        return false;
+    }
+
+    BusRecorder recorder;
+    if (!recorder.Start(RecordTarget{}, "")) {
+        return false;
+    }
+    AudioInsert insert;
+    insert.AddProcessor(recorder);
+    SyntheticAudioDriver driver(insert, VOICEMEETER_POTATO);
+    uint32_t sampleRate = driver.SampleRate();
+    uint32_t frames = driver.Frames();
+
+    uint64_t frameIndex = 0;
+    std::vector<double> micros;
+    auto runBuffer = [&]() {
+        for (uint32_t i = 0; i < frames; ++i) {
+            for (size_t c = 0; c < RECORD_MAX_CHANNELS; ++c) {
+                driver.Bus(c)[i] = BenchSample(frameIndex + i, c);
+            }
+        }
+        frameIndex += frames;
+        micros.push_back(driver.RunBuffer());
+    };
+    auto runRealTime = [&](uint32_t duration) {
+        using BenchClock = std::chrono::steady_clock;
+        auto period = std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(
+            static_cast<double>(frames) / sampleRate));
+        BenchClock::time_point next = BenchClock::now();
+        uint64_t buffers = static_cast<uint64_t>(duration) * sampleRate / frames;
+        for (uint64_t b = 0; b < buffers; ++b) {
+            runBuffer();
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    };
+
+    driver.Start();
+    runRealTime(seconds);
+    Stats realTime = recorder.GetStats();
+
+    // The writer stalls while buffers keep coming faster than real time.
+    recorder.stallWriter_ = true;
+    uint64_t stallBuffers = BENCH_STALL_RINGS * RECORD_RING_FRAMES / frames;
+    for (uint64_t b = 0; b < stallBuffers; ++b) {
+        runBuffer();
+    }
+    recorder.stallWriter_ = false;
+    runRealTime(BENCH_RECOVERY_SECONDS);
+    driver.Stop();
+    recorder.Stop();
+    Stats stats = recorder.GetStats();
+
+    std::vector<std::string> files = recorder.Files();
+    uint64_t gapFrames = 0;
+    uint64_t mismatches = 0;
+    bool readBack = files.size() == 1 && VerifyRecording(files[0], sampleRate, frames, stats, gapFrames, mismatches);
+
+    std::sort(micros.begin(), micros.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[BusRecorder::Benchmark] " + std::to_string(RECORD_MAX_CHANNELS) + " channels at " +
+             std::to_string(sampleRate) + " Hz, " + std::to_string(micros.size()) + " buffers of " +
+             std::to_string(frames) + " frames. Callback p50: " + std::to_string(at(micros, 0.5)) + " us, p99: " +
+             std::to_string(at(micros, 0.99)) + " us, max: " + std::to_string(at(micros, 1.0)) + " us.");
+    LOG_INFO("[BusRecorder::Benchmark] Real time: ring peak " + std::to_string(realTime.ringPeakFrames) + " of " +
+             std::to_string(RECORD_RING_FRAMES) + " frames, " + std::to_string(realTime.overruns) +
+             " overruns. Writer stalled: " + std::to_string(stats.overruns) + " overruns, " +
+             std::to_string(stats.droppedFrames) + " frames dropped. " + std::to_string(stats.bytesWritten) +
+             " bytes written, slowest block " + std::to_string(stats.maxWriteMs) + " ms.");
+
+    bool correct = readBack && realTime.overruns == 0 && stats.overruns > 0 &&
+                   stats.droppedFrames == stats.overruns * frames && gapFrames == stats.droppedFrames &&
+                   mismatches == 0 && stats.writeErrors == 0 &&
+                   stats.frames + stats.droppedFrames == frameIndex;
+    if (!correct) {
+        LOG_ERROR("[BusRecorder::Benchmark] " + std::to_string(files.size()) + " files, " +
+                  std::to_string(realTime.overruns) + " overruns in real time, " + std::to_string(gapFrames) +
+                  " frames missing from the file for " + std::to_string(stats.droppedFrames) + " dropped, " +
+                  std::to_string(mismatches) + " mismatched samples.");
+        return false;
+    }
+    LOG_INFO("[BusRecorder::Benchmark] " + files[0] + " matches every frame that was not dropped.");
+    DeleteFileA(files[0].c_str());
+    return true;
+}
@@ -10,9 +10,16 @@
 #include <stdexcept>
 #include <vector>
 
+#include "AllocationTracker.h"
+#include "BusRecorder.h"
 #include "Defconf.h"
+#include "DuckingEngine.h"
+#include "HotkeyEngine.h"
+#include "LatencyProbe.h"
 #include "Logger.h"
-#include "RAIIHandle.h"
+#include "MacroButtonWatcher.h"
+#include "MidiController.h"
+#include "VbanTextClient.h"
 #include "cxxopts.hpp"
 
 ConfigParser::ConfigParser(int argc, char** argv)
@@ -88,6 +95,7 @@ bool ConfigParser::SetupLogging(const Config& config) {
 }
 
 void ConfigParser::HandleConfiguration(Config& config) {
+    AllocationScope allocationScope(AllocationSubsystem::Config);
     cxxopts::Options options = CreateOptions();
     cxxopts::ParseResult result;
     try {
@@ -151,6 +159,135 @@ void ConfigParser::ValidateConfig(const Config& config) {
         LOG_ERROR("[ConfigParser::ValidateConfig] Invalid hotkey modifiers.");
         throw std::runtime_error("Hotkey modifiers must include at least one of MOD_CONTROL, MOD_ALT, MOD_SHIFT, or MOD_WIN.");
     }
+
+    for (const std::string& text : config.hotkeyBindings.value) {
+        HotkeyBinding binding;
+        if (!HotkeyEngine::ParseBinding(text, binding)) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid hotkey binding: " + text);
+            throw std::runtime_error("Hotkey bindings look like ctrl+alt+F5=step:input:0:+3 (actions: step, mute, preset, resync, sound, midi).");
+        }
+        if (binding.action.kind == HotkeyAction::Kind::ApplyPreset && binding.action.preset >= config.presetPaths.value.size()) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Hotkey binding refers to a missing preset: " + text);
+            throw std::runtime_error("Hotkey binding refers to preset " + std::to_string(binding.action.preset) + ", but only " +
+                                     std::to_string(config.presetPaths.value.size()) + " presets are configured.");
+        }
+    }
+    if (config.hotkeyBindings.value.size() + 1 > HOTKEY_MAX_BINDINGS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many hotkey bindings.");
+        throw std::runtime_error("At most " + std::to_string(HOTKEY_MAX_BINDINGS - 1) + " hotkey bindings are supported.");
+    }
+    if (config.presetPaths.value.size() > HOTKEY_MAX_PRESETS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many presets.");
+        throw std::runtime_error("At most " + std::to_string(HOTKEY_MAX_PRESETS) + " presets are supported.");
+    }
+
+    for (const std::string& text : config.midiMappings.value) {
+        MidiMapping mapping;
+        if (!MidiController::ParseMapping(text, mapping)) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid MIDI mapping: " + text);
+            throw std::runtime_error("MIDI mappings look like cc:1:7=gain:input:0 (sources: cc, cc14, nrpn, bend, note; targets: gain, mute).");
+        }
+    }
+    if (config.midiMappings.value.size() > MIDI_MAX_MAPPINGS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many MIDI mappings.");
+        throw std::runtime_error("At most " + std::to_string(MIDI_MAX_MAPPINGS) + " MIDI mappings are supported.");
+    }
+
+    for (const std::string& text : config.macroButtonBindings.value) {
+        MacroButtonBinding binding;
+        if (!MacroButtonWatcher::ParseBinding(text, binding)) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid MacroButtons binding: " + text);
+            throw std::runtime_error("MacroButtons bindings look like 12=mute:input:0, with buttons 0-" +
+                                     std::to_string(MACRO_BUTTON_COUNT - 1) + " and the hotkey actions.");
+        }
+        if (binding.action.kind == HotkeyAction::Kind::ApplyPreset && binding.action.preset >= config.presetPaths.value.size()) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] MacroButtons binding refers to a missing preset: " + text);
+            throw std::runtime_error("MacroButtons binding refers to preset " + std::to_string(binding.action.preset) + ", but only " +
+                                     std::to_string(config.presetPaths.value.size()) + " presets are configured.");
+        }
+    }
+    if (config.macroButtonBindings.value.size() > MACRO_MAX_BINDINGS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many MacroButtons bindings.");
+        throw std::runtime_error("At most " + std::to_string(MACRO_MAX_BINDINGS) + " MacroButtons bindings are supported.");
+    }
+    if (!config.vbanHost.value.empty()) {
+        if (VbanProtocol::TextRateIndex(config.vbanTextBps.value) < 0) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid VBAN-TEXT rate: " + std::to_string(config.vbanTextBps.value));
+            throw std::runtime_error("VBAN-TEXT rate must be one of the protocol's serial rates, e.g. 9600, 57600 or 115200.");
+        }
+        if (config.vbanStream.value.empty() || config.vbanStream.value.size() > VBAN_STREAM_NAME_LENGTH) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid VBAN stream name: " + config.vbanStream.value);
+            throw std::runtime_error("VBAN stream names are 1 to " + std::to_string(VBAN_STREAM_NAME_LENGTH) + " characters.");
+        }
+    }
+    if (config.replicaPeers.value.size() > REPLICA_MAX_PEERS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many replication peers.");
+        throw std::runtime_error("At most " + std::to_string(REPLICA_MAX_PEERS) + " replication peers are supported.");
+    }
+    uint32_t replicaInstances = config.replicaBenchInstances.value;
+    if (replicaInstances != 0 && (replicaInstances < 2 || replicaInstances > REPLICA_BENCH_MAX_INSTANCES)) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Replication benchmark instance count out of range.");
+        throw std::runtime_error("Replication benchmark needs 2 to " + std::to_string(REPLICA_BENCH_MAX_INSTANCES) + " instances.");
+    }
+    for (const std::string& text : config.duckRules.value) {
+        DuckRule rule;
+        if (!DuckingEngine::ParseRule(text, rule)) {
+            LOG_ERROR("[ConfigParser::ValidateConfig] Invalid ducking rule: " + text);
+            throw std::runtime_error("Ducking rules look like input:0=input:5:-12[:threshold dB[:attack:hold:release ms]].");
+        }
+    }
+    if (config.duckRules.value.size() > DUCK_MAX_RULES) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Too many ducking rules.");
+        throw std::runtime_error("At most " + std::to_string(DUCK_MAX_RULES) + " ducking rules are supported.");
+    }
+    if (config.duckBenchRules.value > DUCK_MAX_RULES) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Ducking benchmark rule count out of range.");
+        throw std::runtime_error("Ducking benchmark runs 1 to " + std::to_string(DUCK_MAX_RULES) + " rules.");
+    }
+    if (config.audioBenchSeconds.value > AUDIO_BENCH_MAX_SECONDS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Audio insert benchmark duration out of range.");
+        throw std::runtime_error("Audio insert benchmark runs 1 to " + std::to_string(AUDIO_BENCH_MAX_SECONDS) + " seconds.");
+    }
+    RecordTarget recordTarget;
+    if (!config.recordTarget.value.empty() && !BusRecorder::ParseTarget(config.recordTarget.value, recordTarget)) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Invalid recording target: " + config.recordTarget.value);
+        throw std::runtime_error("Recording targets look like 0 (all channels of bus 0) or 0:0-1.");
+    }
+    if (config.recordBenchSeconds.value > RECORD_BENCH_MAX_SECONDS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Recording benchmark duration out of range.");
+        throw std::runtime_error("Recording benchmark runs 1 to " + std::to_string(RECORD_BENCH_MAX_SECONDS) + " seconds.");
+    }
+    LatencyPath latencyPath;
+    if (!config.latencyPath.value.empty() && !LatencyProbe::ParsePath(config.latencyPath.value, latencyPath)) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Invalid latency path: " + config.latencyPath.value);
+        throw std::runtime_error("Latency paths look like 0:0 (bus channel 0 back to input channel 0).");
+    }
+    if (config.latencyRuns.value < 1 || config.latencyRuns.value > LATENCY_MAX_RUNS ||
+        config.latencyBenchRuns.value > LATENCY_MAX_RUNS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Latency run count out of range.");
+        throw std::runtime_error("Latency measurement runs 1 to " + std::to_string(LATENCY_MAX_RUNS) + " times.");
+    }
+    if (config.executorBenchCommands.value > EXECUTOR_BENCH_MAX_COMMANDS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Executor benchmark commands out of range.");
+        throw std::runtime_error("Executor benchmark sends 1 to " + std::to_string(EXECUTOR_BENCH_MAX_COMMANDS) + " commands.");
+    }
+    if (config.lockBenchEvents.value > LOCK_BENCH_MAX_EVENTS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Lock benchmark events out of range.");
+        throw std::runtime_error("Lock benchmark drives 1 to " + std::to_string(LOCK_BENCH_MAX_EVENTS) + " events.");
+    }
+    if (config.allocBenchEvents.value > ALLOC_BENCH_MAX_EVENTS) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Allocation benchmark events out of range.");
+        throw std::runtime_error("Allocation benchmark drives 1 to " + std::to_string(ALLOC_BENCH_MAX_EVENTS) + " events.");
+    }
+    if (config.historyBenchChanges.value > HISTORY_BENCH_MAX_CHANGES) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] History benchmark changes out of range.");
+        throw std::runtime_error("History benchmark records 1 to " + std::to_string(HISTORY_BENCH_MAX_CHANGES) + " changes.");
+    }
+    uint32_t eventSubscribers = config.eventBenchSubscribers.value;
+    if (eventSubscribers != 0 && (eventSubscribers < 2 || eventSubscribers > EVENT_MAX_SUBSCRIBERS)) {
+        LOG_ERROR("[ConfigParser::ValidateConfig] Event benchmark subscriber count out of range.");
+        throw std::runtime_error("Event benchmark needs 2 to " + std::to_string(EVENT_MAX_SUBSCRIBERS) + " subscribers.");
+    }
 }
 
 void ConfigParser::ParseConfigFile(const std::string& configPath, Config& config) {
@@ -219,6 +356,66 @@ void ConfigParser::ParseConfigFile(const std::string& configPath, Config& config
                 } else if (key == "hotkey_key") {
                     config.hotkeyVK.value = static_cast<uint8_t>(std::stoi(value));
                     config.hotkeyVK.source = ConfigSource::ConfigFile;
+                } else if (key == "hotkey") {
+                    config.hotkeyBindings.value.push_back(value);
+                    config.hotkeyBindings.source = ConfigSource::ConfigFile;
+                } else if (key == "preset") {
+                    config.presetPaths.value.push_back(value);
+                    config.presetPaths.source = ConfigSource::ConfigFile;
+                } else if (key == "midi_map") {
+                    config.midiMappings.value.push_back(value);
+                    config.midiMappings.source = ConfigSource::ConfigFile;
+                } else if (key == "macro_button") {
+                    config.macroButtonBindings.value.push_back(value);
+                    config.macroButtonBindings.source = ConfigSource::ConfigFile;
+                } else if (key == "osc_port") {
+                    config.oscPort.value = static_cast<uint16_t>(std::stoi(value));
+                    config.oscPort.source = ConfigSource::ConfigFile;
+                } else if (key == "metrics_port") {
+                    config.metricsPort.value = static_cast<uint16_t>(std::stoi(value));
+                    config.metricsPort.source = ConfigSource::ConfigFile;
+                } else if (key == "event_port") {
+                    config.eventPort.value = static_cast<uint16_t>(std::stoi(value));
+                    config.eventPort.source = ConfigSource::ConfigFile;
+                } else if (key == "vban_host") {
+                    config.vbanHost.value = value;
+                    config.vbanHost.source = ConfigSource::ConfigFile;
+                } else if (key == "vban_port") {
+                    config.vbanPort.value = static_cast<uint16_t>(std::stoi(value));
+                    config.vbanPort.source = ConfigSource::ConfigFile;
+                } else if (key == "vban_stream") {
+                    config.vbanStream.value = value;
+                    config.vbanStream.source = ConfigSource::ConfigFile;
+                } else if (key == "vban_rate") {
+                    config.vbanTextBps.value = static_cast<uint32_t>(std::stoul(value));
+                    config.vbanTextBps.source = ConfigSource::ConfigFile;
+                } else if (key == "replica_port") {
+                    config.replicaPort.value = static_cast<uint16_t>(std::stoi(value));
+                    config.replicaPort.source = ConfigSource::ConfigFile;
+                } else if (key == "replica_peer") {
+                    config.replicaPeers.value.push_back(value);
+                    config.replicaPeers.source = ConfigSource::ConfigFile;
+                } else if (key == "duck") {
+                    config.duckRules.value.push_back(value);
+                    config.duckRules.source = ConfigSource::ConfigFile;
+                } else if (key == "loudness") {
+                    config.loudness.value = (value == "true");
+                    config.loudness.source = ConfigSource::ConfigFile;
+                } else if (key == "record") {
+                    config.recordTarget.value = value;
+                    config.recordTarget.source = ConfigSource::ConfigFile;
+                } else if (key == "record_dir") {
+                    config.recordDir.value = value;
+                    config.recordDir.source = ConfigSource::ConfigFile;
+                } else if (key == "footprint_budget") {
+                    config.footprintBudgetMB.value = static_cast<uint16_t>(std::stoi(value));
+                    config.footprintBudgetMB.source = ConfigSource::ConfigFile;
+                } else if (key == "state_file") {
+                    config.stateFilePath.value = value;
+                    config.stateFilePath.source = ConfigSource::ConfigFile;
+                } else if (key == "history_file") {
+                    config.historyFilePath.value = value;
+                    config.historyFilePath.source = ConfigSource::ConfigFile;
                 } else if (key == "log") {
                     config.loggingEnabled.value = true;
                     config.logFilePath.value = value.c_str();
@@ -265,10 +462,94 @@ cxxopts::Options ConfigParser::CreateOptions() {
             cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_HOTKEY_MODIFIERS)))
         ("hk,hotkey-key", "Hotkey virtual key code (e.g., R=82, F5=116)",
             cxxopts::value<uint8_t>()->default_value(std::to_string(DEFAULT_HOTKEY_VK)))
+        ("hotkey", "Bind a hotkey to an action, e.g. ctrl+alt+up=step:input:0:+3. Actions: step:<input|output>:<index>:<dB>, mute:<input|output>:<index>, preset:<n>, resync, sound, midi. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("preset", "Scene file recalled by preset:<n> hotkeys, numbered from 0 in the order given. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("hotkey-bench", "Dispatch the given number of synthetic hotkey presses, report latency and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_HOTKEY_BENCH_PRESSES)))
+        ("midi-map", "Map a MIDI control to a parameter, e.g. cc:1:7=gain:input:0. Sources: cc:<ch>:<n>, cc14:<ch>:<n>, nrpn:<ch>:<n>, bend:<ch>, note:<ch>:<n>. Targets: gain|mute:<input|output>:<index>. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("midi-bench", "Decode the given number of synthetic MIDI messages, measure end-to-end latency and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_MIDI_BENCH_MESSAGES)))
+        ("macro-button", "Bind a MacroButtons button to a hotkey action, e.g. 12=mute:input:0. Mute and midi follow the button state; other actions run when it turns on. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("osc-port", "Listen for OSC control surfaces on this UDP port (0 disables)",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_OSC_PORT)))
+        ("osc-bench", "Send the given number of OSC messages over localhost to a simulated mixer, report throughput and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_OSC_BENCH_MESSAGES)))
+        ("metrics-port", "Serve Prometheus metrics on http://127.0.0.1:<port>/metrics (0 disables)",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_METRICS_PORT)))
+        ("metrics-bench", "Scrape a local metrics endpoint the given number of times, check the responses, report latency and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_METRICS_BENCH_SCRAPES)))
+        ("event-port", "Stream volume, mute, device and scene changes to subscribers on 127.0.0.1:<port> (0 disables)",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_EVENT_PORT)))
+        ("event-bench", "Publish events at 1 kHz to the given number of local subscribers, report fan-out cost and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_EVENT_BENCH_SUBSCRIBERS)))
+        ("vban-host", "Control the Voicemeeter on this host over VBAN-TEXT instead of the local one",
+            cxxopts::value<std::string>())
+        ("vban-port", "VBAN UDP port of the remote Voicemeeter",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_VBAN_PORT)))
+        ("vban-stream", "Name of the incoming VBAN-TEXT stream on the remote Voicemeeter",
+            cxxopts::value<std::string>()->default_value(DEFAULT_VBAN_STREAM))
+        ("vban-rate", "Bit rate of that stream; VBAN-TEXT packets are paced to it",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_VBAN_TEXT_BPS)))
+        ("vban-bench", "Send the given number of statements to a local VBAN-TEXT stand-in receiver, check pacing and read-back, report throughput and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_VBAN_BENCH_STATEMENTS)))
+        ("replica-port", "Share the mirrored volume and mute with other instances on this UDP port (0 disables)",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_REPLICA_PORT)))
+        ("replica-peer", "Replicate to this host or host:port instead of the multicast group. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("replica-bench", "Run the given number of replicating instances on loopback with packet loss, report convergence time and packet rates and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_REPLICA_BENCH_INSTANCES)))
+        ("duck", "Lower a strip or bus while another has signal, e.g. input:0=input:5:-12. Optional threshold dB, then attack, hold and release ms: input:0=input:5:-12:-40:50:300:600. Repeatable",
+            cxxopts::value<std::vector<std::string>>())
+        ("duck-bench", "Run the given number of ducking rules (1-16) against a simulated level source, report evaluation cost and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_DUCK_BENCH_RULES)))
+        ("audio-bench", "Drive the audio insert in real time for the given seconds, overload it, check the deadline monitor bypasses optional processing and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_AUDIO_BENCH_SECONDS)))
+        ("loudness", "Measure EBU R128 loudness of every bus in the Voicemeeter audio callback and export it as metrics",
+            cxxopts::value<bool>()->default_value("false"))
+        ("record", "Record channels of a bus from the Voicemeeter audio callback into WAV files: <bus> or <bus>:<first>-<last>, e.g. 0:0-1",
+            cxxopts::value<std::string>())
+        ("record-dir", "Directory the recordings are written to",
+            cxxopts::value<std::string>()->default_value(DEFAULT_RECORD_DIR))
+        ("record-bench", "Record 8 channels from a synthetic 48 kHz callback for the given seconds, force overruns, verify the file and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_RECORD_BENCH_SECONDS)))
+        ("latency", "Measure the round trip from a bus channel back to an input channel through a loopback, e.g. 0:0, report it and exit",
+            cxxopts::value<std::string>())
+        ("latency-runs", "Number of measurements for --latency",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_LATENCY_RUNS)))
+        ("latency-bench", "Measure a synthetic loopback delay the given number of times, check every run is exact and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_LATENCY_BENCH_RUNS)))
+        ("history-bench", "Record the given number of synthetic volume and mute changes, check every history tier and the file, and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_HISTORY_BENCH_CHANGES)))
         ("log", "Enable logging with specified log file path",
             cxxopts::value<std::string>()->default_value(DEFAULT_LOG_FILE))
         ("startup-sound", "Enable startup sound",
             cxxopts::value<bool>()->default_value("false"))
+        ("executor-bench", "Send the given number of commands through the Voicemeeter executor against a simulated DLL that stalls, check merging, expiry and a bounded stop, and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_EXECUTOR_BENCH_COMMANDS)))
+        ("lock-bench", "Mirror the given number of slider changes between a simulated endpoint and mixer while fader moves and resyncs run alongside, report lock contention and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_LOCK_BENCH_EVENTS)))
+        ("alloc-bench", "Mirror the given number of slider changes and fader moves between a simulated endpoint and mixer, fail on any heap allocation after warm-up and exit",
+            cxxopts::value<uint32_t>()->default_value(std::to_string(DEFAULT_ALLOC_BENCH_EVENTS)))
+        ("footprint-budget", "Warn when private memory exceeds this many MiB (0 disables)",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_FOOTPRINT_BUDGET_MB)))
+        ("soak", "Run the soak test against a simulated backend for the given minutes and exit",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_SOAK_MINUTES)))
+        ("state-file", "Path of the last-known-state cache used to restore volume at startup (empty disables)",
+            cxxopts::value<std::string>()->default_value(DEFAULT_STATE_FILE))
+        ("history-file", "Path the volume and mute history is saved to on shutdown and loaded from at startup (empty keeps it in memory only)",
+            cxxopts::value<std::string>()->default_value(DEFAULT_HISTORY_FILE))
+        ("scene-save", "Capture gains, mutes, routing and labels of every strip and bus to a scene file and exit",
+            cxxopts::value<std::string>())
+        ("scene-recall", "Apply a scene file, changing only parameters that differ, and exit",
+            cxxopts::value<std::string>())
+        ("fade", "Crossfade --scene-recall over the given milliseconds instead of switching instantly",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_CROSSFADE_MS)))
+        ("crossfade-sim", "Run a pre-empted crossfade of the given milliseconds against a simulated mixer, report frame jitter and exit",
+            cxxopts::value<uint16_t>()->default_value(std::to_string(DEFAULT_CROSSFADE_SIM_MS)))
         ("help", "Print help")
         ("version", "Print version");
 
@@ -299,6 +580,7 @@ void ConfigParser::ApplyCommandLineOptions(const cxxopts::ParseResult& result, C
     setBool("shutdown", config.shutdown);
     setBool("hidden", config.hideConsole);
     setBool("startup-sound", config.startupSound);
+    setBool("loudness", config.loudness);
     setBool("help", config.help);
     setBool("version", config.version);
     setBool("loggingEnabled", config.loggingEnabled);
@@ -368,6 +650,211 @@ void ConfigParser::ApplyCommandLineOptions(const cxxopts::ParseResult& result, C
         config.startupDelay.source = ConfigSource::CommandLine;
         LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Startup delay set to: " + std::to_string(config.startupDelay.value) + "ms");
     }
+    if (result.count("hotkey")) {
+        config.hotkeyBindings.value = result["hotkey"].as<std::vector<std::string>>();
+        config.hotkeyBindings.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Hotkey bindings set: " + std::to_string(config.hotkeyBindings.value.size()));
+    }
+    if (result.count("preset")) {
+        config.presetPaths.value = result["preset"].as<std::vector<std::string>>();
+        config.presetPaths.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Presets set: " + std::to_string(config.presetPaths.value.size()));
+    }
+    if (result.count("hotkey-bench")) {
+        config.hotkeyBenchPresses.value = result["hotkey-bench"].as<uint32_t>();
+        config.hotkeyBenchPresses.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Hotkey benchmark presses set to: " + std::to_string(config.hotkeyBenchPresses.value));
+    }
+    if (result.count("midi-map")) {
+        config.midiMappings.value = result["midi-map"].as<std::vector<std::string>>();
+        config.midiMappings.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] MIDI mappings set: " + std::to_string(config.midiMappings.value.size()));
+    }
+    if (result.count("midi-bench")) {
+        config.midiBenchMessages.value = result["midi-bench"].as<uint32_t>();
+        config.midiBenchMessages.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] MIDI benchmark messages set to: " + std::to_string(config.midiBenchMessages.value));
+    }
+    if (result.count("macro-button")) {
+        config.macroButtonBindings.value = result["macro-button"].as<std::vector<std::string>>();
+        config.macroButtonBindings.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] MacroButtons bindings set: " + std::to_string(config.macroButtonBindings.value.size()));
+    }
+    if (result.count("osc-port")) {
+        config.oscPort.value = result["osc-port"].as<uint16_t>();
+        config.oscPort.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] OSC port set to: " + std::to_string(config.oscPort.value));
+    }
+    if (result.count("osc-bench")) {
+        config.oscBenchMessages.value = result["osc-bench"].as<uint32_t>();
+        config.oscBenchMessages.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] OSC benchmark messages set to: " + std::to_string(config.oscBenchMessages.value));
+    }
+    if (result.count("metrics-port")) {
+        config.metricsPort.value = result["metrics-port"].as<uint16_t>();
+        config.metricsPort.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Metrics port set to: " + std::to_string(config.metricsPort.value));
+    }
+    if (result.count("metrics-bench")) {
+        config.metricsBenchScrapes.value = result["metrics-bench"].as<uint32_t>();
+        config.metricsBenchScrapes.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Metrics benchmark scrapes set to: " + std::to_string(config.metricsBenchScrapes.value));
+    }
+    if (result.count("event-port")) {
+        config.eventPort.value = result["event-port"].as<uint16_t>();
+        config.eventPort.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Event stream port set to: " + std::to_string(config.eventPort.value));
+    }
+    if (result.count("event-bench")) {
+        config.eventBenchSubscribers.value = result["event-bench"].as<uint32_t>();
+        config.eventBenchSubscribers.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Event benchmark subscribers set to: " + std::to_string(config.eventBenchSubscribers.value));
+    }
+    if (result.count("vban-host")) {
+        config.vbanHost.value = result["vban-host"].as<std::string>();
+        config.vbanHost.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] VBAN host set to: " + config.vbanHost.value);
+    }
+    if (result.count("vban-port")) {
+        config.vbanPort.value = result["vban-port"].as<uint16_t>();
+        config.vbanPort.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] VBAN port set to: " + std::to_string(config.vbanPort.value));
+    }
+    if (result.count("vban-stream")) {
+        config.vbanStream.value = result["vban-stream"].as<std::string>();
+        config.vbanStream.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] VBAN stream set to: " + config.vbanStream.value);
+    }
+    if (result.count("vban-rate")) {
+        config.vbanTextBps.value = result["vban-rate"].as<uint32_t>();
+        config.vbanTextBps.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] VBAN-TEXT rate set to: " + std::to_string(config.vbanTextBps.value) + " bps");
+    }
+    if (result.count("vban-bench")) {
+        config.vbanBenchStatements.value = result["vban-bench"].as<uint32_t>();
+        config.vbanBenchStatements.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] VBAN benchmark statements set to: " + std::to_string(config.vbanBenchStatements.value));
+    }
+    if (result.count("replica-port")) {
+        config.replicaPort.value = result["replica-port"].as<uint16_t>();
+        config.replicaPort.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Replication port set to: " + std::to_string(config.replicaPort.value));
+    }
+    if (result.count("replica-peer")) {
+        config.replicaPeers.value = result["replica-peer"].as<std::vector<std::string>>();
+        config.replicaPeers.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Replication peers set: " + std::to_string(config.replicaPeers.value.size()));
+    }
+    if (result.count("replica-bench")) {
+        config.replicaBenchInstances.value = result["replica-bench"].as<uint32_t>();
+        config.replicaBenchInstances.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Replication benchmark instances set to: " + std::to_string(config.replicaBenchInstances.value));
+    }
+    if (result.count("duck")) {
+        config.duckRules.value = result["duck"].as<std::vector<std::string>>();
+        config.duckRules.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Ducking rules set: " + std::to_string(config.duckRules.value.size()));
+    }
+    if (result.count("duck-bench")) {
+        config.duckBenchRules.value = result["duck-bench"].as<uint32_t>();
+        config.duckBenchRules.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Ducking benchmark rules set to: " + std::to_string(config.duckBenchRules.value));
+    }
+    if (result.count("audio-bench")) {
+        config.audioBenchSeconds.value = result["audio-bench"].as<uint32_t>();
+        config.audioBenchSeconds.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Audio insert benchmark seconds set to: " + std::to_string(config.audioBenchSeconds.value));
+    }
+    if (result.count("record")) {
+        config.recordTarget.value = result["record"].as<std::string>();
+        config.recordTarget.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Recording target set to: " + config.recordTarget.value);
+    }
+    if (result.count("record-dir")) {
+        config.recordDir.value = result["record-dir"].as<std::string>();
+        config.recordDir.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Recording directory set to: " + config.recordDir.value);
+    }
+    if (result.count("record-bench")) {
+        config.recordBenchSeconds.value = result["record-bench"].as<uint32_t>();
+        config.recordBenchSeconds.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Recording benchmark seconds set to: " + std::to_string(config.recordBenchSeconds.value));
+    }
+    if (result.count("latency")) {
+        config.latencyPath.value = result["latency"].as<std::string>();
+        config.latencyPath.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Latency path set to: " + config.latencyPath.value);
+    }
+    if (result.count("latency-runs")) {
+        config.latencyRuns.value = result["latency-runs"].as<uint32_t>();
+        config.latencyRuns.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Latency runs set to: " + std::to_string(config.latencyRuns.value));
+    }
+    if (result.count("latency-bench")) {
+        config.latencyBenchRuns.value = result["latency-bench"].as<uint32_t>();
+        config.latencyBenchRuns.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Latency benchmark runs set to: " + std::to_string(config.latencyBenchRuns.value));
+    }
+    if (result.count("history-bench")) {
+        config.historyBenchChanges.value = result["history-bench"].as<uint32_t>();
+        config.historyBenchChanges.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] History benchmark changes set to: " + std::to_string(config.historyBenchChanges.value));
+    }
+    if (result.count("executor-bench")) {
+        config.executorBenchCommands.value = result["executor-bench"].as<uint32_t>();
+        config.executorBenchCommands.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Executor benchmark commands set to: " + std::to_string(config.executorBenchCommands.value));
+    }
+    if (result.count("lock-bench")) {
+        config.lockBenchEvents.value = result["lock-bench"].as<uint32_t>();
+        config.lockBenchEvents.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Lock benchmark events set to: " + std::to_string(config.lockBenchEvents.value));
+    }
+    if (result.count("alloc-bench")) {
+        config.allocBenchEvents.value = result["alloc-bench"].as<uint32_t>();
+        config.allocBenchEvents.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Allocation benchmark events set to: " + std::to_string(config.allocBenchEvents.value));
+    }
+    if (result.count("footprint-budget")) {
+        config.footprintBudgetMB.value = result["footprint-budget"].as<uint16_t>();
+        config.footprintBudgetMB.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Footprint budget set to: " + std::to_string(config.footprintBudgetMB.value) + " MiB");
+    }
+    if (result.count("soak")) {
+        config.soakMinutes.value = result["soak"].as<uint16_t>();
+        config.soakMinutes.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Soak duration set to: " + std::to_string(config.soakMinutes.value) + " minutes");
+    }
+    if (result.count("state-file")) {
+        config.stateFilePath.value = result["state-file"].as<std::string>();
+        config.stateFilePath.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] State file path set to: " + config.stateFilePath.value);
+    }
+    if (result.count("history-file")) {
+        config.historyFilePath.value = result["history-file"].as<std::string>();
+        config.historyFilePath.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] History file path set to: " + config.historyFilePath.value);
+    }
+    if (result.count("scene-save")) {
+        config.sceneSavePath.value = result["scene-save"].as<std::string>();
+        config.sceneSavePath.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Scene save path set to: " + config.sceneSavePath.value);
+    }
+    if (result.count("scene-recall")) {
+        config.sceneRecallPath.value = result["scene-recall"].as<std::string>();
+        config.sceneRecallPath.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Scene recall path set to: " + config.sceneRecallPath.value);
+    }
+    if (result.count("fade")) {
+        config.crossfadeMs.value = result["fade"].as<uint16_t>();
+        config.crossfadeMs.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Crossfade time set to: " + std::to_string(config.crossfadeMs.value) + "ms");
+    }
+    if (result.count("crossfade-sim")) {
+        config.crossfadeSimMs.value = result["crossfade-sim"].as<uint16_t>();
+        config.crossfadeSimMs.source = ConfigSource::CommandLine;
+        LOG_DEBUG("[ConfigParser::ApplyCommandLineOptions] Crossfade simulation time set to: " + std::to_string(config.crossfadeSimMs.value) + "ms");
+    }
     if (result.count("monitor")) {
         config.monitorDeviceUUID.value = result["monitor"].as<std::string>();
         config.monitorDeviceUUID.source = ConfigSource::CommandLine;
@@ -420,6 +907,55 @@ void ConfigParser::LogConfiguration(const Config& config) {
     logOption("listChannels", config.listChannels.value ? "true" : "false", config.listChannels.source);
     logOption("hotkeyModifiers", std::to_string(config.hotkeyModifiers.value), config.hotkeyModifiers.source);
     logOption("hotkeyVK", std::to_string(config.hotkeyVK.value), config.hotkeyVK.source);
+    auto joinList = [](const std::vector<std::string>& values) {
+        std::string joined;
+        for (const std::string& value : values) {
+            joined += (joined.empty() ? "" : ", ") + value;
+        }
+        return joined;
+    };
+    logOption("hotkeyBindings", joinList(config.hotkeyBindings.value), config.hotkeyBindings.source);
+    logOption("presetPaths", joinList(config.presetPaths.value), config.presetPaths.source);
+    logOption("hotkeyBenchPresses", std::to_string(config.hotkeyBenchPresses.value), config.hotkeyBenchPresses.source);
+    logOption("midiMappings", joinList(config.midiMappings.value), config.midiMappings.source);
+    logOption("midiBenchMessages", std::to_string(config.midiBenchMessages.value), config.midiBenchMessages.source);
+    logOption("macroButtonBindings", joinList(config.macroButtonBindings.value), config.macroButtonBindings.source);
+    logOption("oscPort", std::to_string(config.oscPort.value), config.oscPort.source);
+    logOption("oscBenchMessages", std::to_string(config.oscBenchMessages.value), config.oscBenchMessages.source);
+    logOption("metricsPort", std::to_string(config.metricsPort.value), config.metricsPort.source);
+    logOption("metricsBenchScrapes", std::to_string(config.metricsBenchScrapes.value), config.metricsBenchScrapes.source);
+    logOption("eventPort", std::to_string(config.eventPort.value), config.eventPort.source);
+    logOption("eventBenchSubscribers", std::to_string(config.eventBenchSubscribers.value), config.eventBenchSubscribers.source);
+    logOption("vbanHost", config.vbanHost.value, config.vbanHost.source);
+    logOption("vbanPort", std::to_string(config.vbanPort.value), config.vbanPort.source);
+    logOption("vbanStream", config.vbanStream.value, config.vbanStream.source);
+    logOption("vbanTextBps", std::to_string(config.vbanTextBps.value), config.vbanTextBps.source);
+    logOption("vbanBenchStatements", std::to_string(config.vbanBenchStatements.value), config.vbanBenchStatements.source);
+    logOption("replicaPort", std::to_string(config.replicaPort.value), config.replicaPort.source);
+    logOption("replicaPeers", joinList(config.replicaPeers.value), config.replicaPeers.source);
+    logOption("replicaBenchInstances", std::to_string(config.replicaBenchInstances.value), config.replicaBenchInstances.source);
+    logOption("duckRules", joinList(config.duckRules.value), config.duckRules.source);
+    logOption("duckBenchRules", std::to_string(config.duckBenchRules.value), config.duckBenchRules.source);
+    logOption("audioBenchSeconds", std::to_string(config.audioBenchSeconds.value), config.audioBenchSeconds.source);
+    logOption("loudness", config.loudness.value ? "true" : "false", config.loudness.source);
+    logOption("recordTarget", config.recordTarget.value, config.recordTarget.source);
+    logOption("recordDir", config.recordDir.value, config.recordDir.source);
+    logOption("recordBenchSeconds", std::to_string(config.recordBenchSeconds.value), config.recordBenchSeconds.source);
+    logOption("latencyPath", config.latencyPath.value, config.latencyPath.source);
+    logOption("latencyRuns", std::to_string(config.latencyRuns.value), config.latencyRuns.source);
+    logOption("latencyBenchRuns", std::to_string(config.latencyBenchRuns.value), config.latencyBenchRuns.source);
+    logOption("historyBenchChanges", std::to_string(config.historyBenchChanges.value), config.historyBenchChanges.source);
+    logOption("executorBenchCommands", std::to_string(config.executorBenchCommands.value), config.executorBenchCommands.source);
+    logOption("lockBenchEvents", std::to_string(config.lockBenchEvents.value), config.lockBenchEvents.source);
+    logOption("allocBenchEvents", std::to_string(config.allocBenchEvents.value), config.allocBenchEvents.source);
+    logOption("footprintBudgetMB", std::to_string(config.footprintBudgetMB.value), config.footprintBudgetMB.source);
+    logOption("soakMinutes", std::to_string(config.soakMinutes.value), config.soakMinutes.source);
+    logOption("stateFilePath", config.stateFilePath.value, config.stateFilePath.source);
+    logOption("historyFilePath", config.historyFilePath.value, config.historyFilePath.source);
+    logOption("sceneSavePath", config.sceneSavePath.value, config.sceneSavePath.source);
+    logOption("sceneRecallPath", config.sceneRecallPath.value, config.sceneRecallPath.source);
+    logOption("crossfadeMs", std::to_string(config.crossfadeMs.value), config.crossfadeMs.source);
+    logOption("crossfadeSimMs", std::to_string(config.crossfadeSimMs.value), config.crossfadeSimMs.source);
 
     oss << "====\n\n";
 
@@ -448,20 +984,6 @@ bool ConfigParser::HandleSpecialCommands(const Config& config) {
         return true;
     }
 
-    if (config.shutdown.value) {
-        LOG_DEBUG("[ConfigParser::HandleSpecialCommands] Processing shutdown command");
-        RAIIHandle hQuitEvent(OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, EVENT_NAME));
-        if (hQuitEvent.get()) {
-            if (SetEvent(hQuitEvent.get())) {
-                LOG_INFO("[ConfigParser::HandleSpecialCommands] Signaled running instances to quit.");
-            } else {
-                LOG_ERROR("[ConfigParser::HandleSpecialCommands] Failed to signal quit event to running instances.");
-            }
-        } else {
-            LOG_INFO("[ConfigParser::HandleSpecialCommands] No running instances found.");
-        }
-        return true;
-    }
-
+    // --shutdown and the --list-* commands are dispatched by main.
     return false;
 }
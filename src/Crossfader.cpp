@@ -0,0 +1,233 @@
+// Crossfader.cpp
+#include "Crossfader.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logger.h"
+
+namespace {
+constexpr std::chrono::milliseconds FRAME_INTERVAL(CROSSFADE_FRAME_INTERVAL_MS);
+
+double ToMs(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Interpolates gains and keeps the last written gain where the change is
+// below the diff threshold, so slow fades accumulate until they are written.
+void InterpolateGains(const ChannelSnapshot* from, const ChannelSnapshot* to, const ChannelSnapshot* live,
+                      ChannelSnapshot* frame, int count, float t) {
+    for (int i = 0; i < count; ++i) {
+        float gain = from[i].gainDb + (to[i].gainDb - from[i].gainDb) * t;
+        frame[i].gainDb = std::fabs(gain - live[i].gainDb) > SCENE_GAIN_EPSILON_DB ? gain : live[i].gainDb;
+    }
+}
+}  // namespace
+
+Crossfader::Crossfader(ScriptSink sink) : sink_(std::move(sink)) {}
+
+Crossfader::~Crossfader() {
+    Stop();
+}
+
+bool Crossfader::Start() {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    // Plain sleeps follow the 15.6 ms system tick; a high-resolution
+    // waitable timer keeps frames on their grid without raising it globally.
+    timer_ = RAIIHandle(CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+    if (!timer_.get()) {
+        LOG_DEBUG("[Crossfader::Start] High-resolution timer unavailable. Falling back to sleeps.");
+    }
+
+    running_ = true;
+    thread_ = std::thread(&Crossfader::ThreadProc, this);
+    return true;
+}
+
+void Crossfader::Stop() {
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        active_ = false;
+    }
+    wake_.notify_all();
+    idle_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    timer_ = RAIIHandle();
+}
+
+void Crossfader::FadeTo(const Scene& current, const Scene& target, uint32_t durationMs) {
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        if (active_) {
+            ++stats_.preempted;
+            from_ = live_;
+            LOG_DEBUG("[Crossfader::FadeTo] Pre-empting the running crossfade.");
+        } else {
+            from_ = current;
+            live_ = current;
+            nextFrame_ = Clock::now();
+        }
+
+        // A pre-empting fade keeps the running frame grid, so the frame
+        // thread's pending wait stays valid.
+        target_ = target;
+        switched_ = false;
+        fadeStart_ = Clock::now();
+        fadeDuration_ = std::chrono::milliseconds(durationMs);
+        active_ = true;
+        ++stats_.fades;
+    }
+    wake_.notify_all();
+}
+
+bool Crossfader::WaitIdle(std::chrono::milliseconds timeout) {
+    std::unique_lock<ProfiledMutex> lock(mutex_);
+    return idle_.wait_for(lock, timeout, [this]() { return !active_; });
+}
+
+Crossfader::Stats Crossfader::GetStats() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.meanJitterMs = stats_.frames > 0 ? jitterTotalMs_ / static_cast<double>(stats_.frames) : 0.0;
+    return stats;
+}
+
+void Crossfader::WaitUntil(Clock::time_point due) {
+    Clock::duration remaining = due - Clock::now();
+    if (remaining <= Clock::duration::zero()) {
+        return;
+    }
+
+    if (timer_.get()) {
+        // Negative due time is relative, in 100 ns units.
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+        if (SetWaitableTimer(timer_.get(), &dueTime, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer_.get(), INFINITE);
+            return;
+        }
+    }
+    std::this_thread::sleep_until(due);
+}
+
+void Crossfader::ThreadProc() {
+    std::string script;
+    script.reserve(SCENE_RECALL_SCRIPT_RESERVE);
+
+    while (true) {
+        Clock::time_point due;
+        {
+            std::unique_lock<ProfiledMutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return !running_ || active_; });
+            if (!running_) {
+                break;
+            }
+            due = nextFrame_;
+        }
+
+        WaitUntil(due);
+
+        script.clear();
+        {
+            std::lock_guard<ProfiledMutex> lock(mutex_);
+            if (!active_ || nextFrame_ != due) {
+                // Stopped, or idle and restarted while waiting; pick up the new schedule.
+                continue;
+            }
+
+            Clock::time_point now = Clock::now();
+            double jitterMs = (std::max)(ToMs(now - due), 0.0);
+            ++stats_.frames;
+            jitterTotalMs_ += jitterMs;
+            stats_.maxJitterMs = (std::max)(stats_.maxJitterMs, jitterMs);
+
+            // Stay on the frame grid; frames the thread slept through are dropped.
+            nextFrame_ += FRAME_INTERVAL;
+            while (nextFrame_ <= now) {
+                nextFrame_ += FRAME_INTERVAL;
+                ++stats_.missedFrames;
+            }
+
+            if (RenderFrame(now, script)) {
+                active_ = false;
+                idle_.notify_all();
+            }
+        }
+
+        if (!script.empty()) {
+            sink_(script);
+        }
+    }
+}
+
+bool Crossfader::RenderFrame(Clock::time_point now, std::string& script) {
+    float t = 1.0f;
+    if (fadeDuration_ > Clock::duration::zero()) {
+        t = static_cast<float>(ToMs(now - fadeStart_) / ToMs(fadeDuration_));
+        t = (std::min)((std::max)(t, 0.0f), 1.0f);
+    }
+
+    if (t >= 0.5f) {
+        switched_ = true;
+    }
+
+    // Discrete parameters come from whichever end the fade is closer to.
+    Scene frame = switched_ ? target_ : from_;
+    InterpolateGains(from_.strips, target_.strips, live_.strips, frame.strips, frame.stripCount, t);
+    InterpolateGains(from_.buses, target_.buses, live_.buses, frame.buses, frame.busCount, t);
+
+    SceneLogic::BuildRecallScript(live_, frame, script);
+    live_ = frame;
+    return t >= 1.0f;
+}
+
+bool Crossfader::RunSimulation(uint16_t durationMs) {
+    Scene meeting = SceneLogic::MakeSimulatedScene(0.0f, false);
+    Scene streaming = SceneLogic::MakeSimulatedScene(-12.0f, true);
+    Scene mixer = meeting;
+    uint64_t scripts = 0;
+
+    Crossfader crossfader([&](const std::string& script) {
+        SceneLogic::ApplyScript(mixer, script);
+        ++scripts;
+    });
+    if (!crossfader.Start()) {
+        return false;
+    }
+
+    LOG_INFO("[Crossfader::RunSimulation] Crossfading a Potato layout over " + std::to_string(durationMs) +
+             " ms, pre-empted at 60%.");
+    const std::chrono::milliseconds duration(durationMs);
+    crossfader.FadeTo(mixer, streaming, durationMs);
+    std::this_thread::sleep_for(duration * 6 / 10);
+    crossfader.FadeTo(mixer, meeting, durationMs);
+    bool finished = crossfader.WaitIdle(duration * 2 + std::chrono::seconds(1));
+    crossfader.Stop();
+
+    Stats stats = crossfader.GetStats();
+    LOG_INFO("[Crossfader::RunSimulation] Frames: " + std::to_string(stats.frames) +
+             ", scripts: " + std::to_string(scripts) +
+             ", missed frames: " + std::to_string(stats.missedFrames) +
+             ", pre-empted: " + std::to_string(stats.preempted) +
+             ". Frame jitter mean " + std::to_string(stats.meanJitterMs) +
+             " ms, max " + std::to_string(stats.maxJitterMs) + " ms.");
+
+    std::string remaining;
+    size_t differences = SceneLogic::BuildRecallScript(mixer, meeting, remaining);
+    if (!finished || differences != 0) {
+        LOG_ERROR("[Crossfader::RunSimulation] Simulated mixer did not end on the target. Differences: " +
+                  std::to_string(differences) + " " + remaining);
+        return false;
+    }
+    return true;
+}
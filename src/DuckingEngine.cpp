@@ -0,0 +1,633 @@
+// DuckingEngine.cpp
+#include "DuckingEngine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "Logger.h"
+#include "Scene.h"
+
+namespace {
+// Large enough for "Strip[N].Gain" and a value
+constexpr size_t PARAMETER_NAME_LENGTH = 32;
+
+// Accepted threshold range; meters read slightly above 0 dBFS when clipping
+constexpr float MIN_THRESHOLD_DB = -120.0f;
+constexpr float MAX_THRESHOLD_DB = 12.0f;
+constexpr long MAX_ENVELOPE_MS = 10000;
+
+// Benchmark: two microphones talking in overlapping bursts
+constexpr uint16_t BENCH_ATTACK_MS = 50;
+constexpr uint16_t BENCH_HOLD_MS = 200;
+constexpr uint16_t BENCH_RELEASE_MS = 400;
+constexpr float BENCH_TALK_LEVEL = 0.1f;      // -20 dBFS
+constexpr float BENCH_SILENT_LEVEL = 0.001f;  // -60 dBFS
+constexpr int BENCH_MOVE_AT_MS = 2300;
+constexpr float BENCH_MOVED_GAIN_DB = -7.0f;
+constexpr int BENCH_RUN_MS = 3800;
+constexpr float BENCH_DEPTH_TOLERANCE_DB = 0.06f;
+constexpr float BENCH_RESTORE_TOLERANCE_DB = 0.005f;
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+std::string Lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool ParseNumber(const std::string& text, long minimum, long maximum, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= minimum && value <= maximum;
+}
+
+bool ParseDecibels(const std::string& text, float minimum, float maximum, float& value) {
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && value >= minimum && value <= maximum;
+}
+
+bool ParseChannel(const std::string& type, const std::string& index, DuckChannel& channel) {
+    std::string kind = Lower(type);
+    long number = 0;
+    if ((kind != "input" && kind != "output") ||
+        !ParseNumber(index, 0, static_cast<long>(SCENE_MAX_STRIPS) - 1, number)) {
+        return false;
+    }
+    channel.type = kind == "input" ? ChannelType::Input : ChannelType::Output;
+    channel.index = static_cast<uint8_t>(number);
+    return true;
+}
+
+// Talk bursts of the benchmark's two microphones, in ms from the start.
+bool Talking(uint8_t microphone, int elapsedMs) {
+    if (microphone == 0) {
+        return (elapsedMs >= 200 && elapsedMs < 1000) || (elapsedMs >= 2000 && elapsedMs < 2600);
+    }
+    return (elapsedMs >= 500 && elapsedMs < 1500) || (elapsedMs >= 2200 && elapsedMs < 2800);
+}
+}  // namespace
+
+DuckingEngine::DuckingEngine() {
+    script_.reserve(DUCK_MAX_RULES * PARAMETER_NAME_LENGTH);
+}
+
+DuckingEngine::~DuckingEngine() {
+    Stop();
+}
+
+uint8_t DuckingEngine::AddChannel(std::vector<DuckChannel>& channels, const DuckChannel& channel) {
+    auto found = std::find(channels.begin(), channels.end(), channel);
+    if (found != channels.end()) {
+        return static_cast<uint8_t>(found - channels.begin());
+    }
+    channels.push_back(channel);
+    return static_cast<uint8_t>(channels.size() - 1);
+}
+
+bool DuckingEngine::AddRule(const DuckRule& rule) {
+    if (running_) {
+        LOG_ERROR("[DuckingEngine::AddRule] Rules cannot change while the engine is running.");
+        return false;
+    }
+    if (rule.trigger.index >= SCENE_MAX_STRIPS || rule.target.index >= SCENE_MAX_STRIPS ||
+        rule.trigger == rule.target || !(rule.depthDb < 0.0f)) {
+        LOG_ERROR("[DuckingEngine::AddRule] Invalid rule.");
+        return false;
+    }
+    if (rules_.size() >= DUCK_MAX_RULES) {
+        LOG_ERROR("[DuckingEngine::AddRule] Rule limit of " + std::to_string(DUCK_MAX_RULES) + " reached.");
+        return false;
+    }
+
+    RuleState state;
+    state.trigger = AddChannel(triggers_, rule.trigger);
+    size_t targets = targets_.size();
+    state.target = AddChannel(targets_, rule.target);
+    if (targets_.size() != targets) {
+        parameters_.push_back(std::string(rule.target.type == ChannelType::Input ? "Strip[" : "Bus[") +
+                              std::to_string(rule.target.index) + "].Gain");
+        targetStates_.emplace_back();
+        targetOffsets_.push_back(0.0f);
+    }
+
+    rules_.push_back(rule);
+    rules_.back().depthDb = std::round(rule.depthDb / DUCK_WRITE_STEP_DB) * DUCK_WRITE_STEP_DB;
+    ruleStates_.push_back(state);
+    return true;
+}
+
+bool DuckingEngine::ParseRule(const std::string& text, DuckRule& rule) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+
+    std::vector<std::string> trigger = Split(text.substr(0, equals), ':');
+    std::vector<std::string> target = Split(text.substr(equals + 1), ':');
+    if (trigger.size() != 2 || (target.size() != 3 && target.size() != 4 && target.size() != 7)) {
+        return false;
+    }
+
+    DuckRule parsed;
+    if (!ParseChannel(trigger[0], trigger[1], parsed.trigger) ||
+        !ParseChannel(target[0], target[1], parsed.target) ||
+        !ParseDecibels(target[2], static_cast<float>(DEFAULT_MIN_DBM), -DUCK_WRITE_STEP_DB, parsed.depthDb) ||
+        parsed.trigger == parsed.target) {
+        return false;
+    }
+    if (target.size() >= 4 && !ParseDecibels(target[3], MIN_THRESHOLD_DB, MAX_THRESHOLD_DB, parsed.thresholdDb)) {
+        return false;
+    }
+    if (target.size() == 7) {
+        long attack = 0;
+        long hold = 0;
+        long release = 0;
+        if (!ParseNumber(target[4], 0, MAX_ENVELOPE_MS, attack) ||
+            !ParseNumber(target[5], 0, MAX_ENVELOPE_MS, hold) ||
+            !ParseNumber(target[6], 0, MAX_ENVELOPE_MS, release)) {
+            return false;
+        }
+        parsed.attackMs = static_cast<uint16_t>(attack);
+        parsed.holdMs = static_cast<uint16_t>(hold);
+        parsed.releaseMs = static_cast<uint16_t>(release);
+    }
+    rule = parsed;
+    return true;
+}
+
+bool DuckingEngine::LevelChannels(long voicemeeterType, const DuckChannel& channel, int& first, int& count) {
+    SceneLayout layout = SceneLogic::GetLayout(voicemeeterType);
+    if (layout.voicemeeterType == 0) {
+        return false;
+    }
+
+    if (channel.type == ChannelType::Output) {
+        if (channel.index >= layout.busCount) {
+            return false;
+        }
+        first = channel.index * DUCK_VIRTUAL_CHANNELS;
+        count = DUCK_VIRTUAL_CHANNELS;
+        return true;
+    }
+
+    if (channel.index >= layout.stripCount) {
+        return false;
+    }
+    // Physical strips come first; each edition has as many virtual strips as virtual buses.
+    int physical = layout.stripCount - layout.virtualBuses;
+    if (channel.index < physical) {
+        first = channel.index * DUCK_PHYSICAL_STRIP_CHANNELS;
+        count = DUCK_PHYSICAL_STRIP_CHANNELS;
+    } else {
+        first = physical * DUCK_PHYSICAL_STRIP_CHANNELS + (channel.index - physical) * DUCK_VIRTUAL_CHANNELS;
+        count = DUCK_VIRTUAL_CHANNELS;
+    }
+    return true;
+}
+
+bool DuckingEngine::Start(DuckingPort& port) {
+    if (running_) {
+        return true;
+    }
+    if (rules_.empty()) {
+        LOG_DEBUG("[DuckingEngine::Start] No rules configured.");
+        return false;
+    }
+
+    port_ = &port;
+    processed_ = false;
+    running_ = true;
+    thread_ = std::thread(&DuckingEngine::ThreadProc, this);
+    LOG_INFO("[DuckingEngine::Start] " + std::to_string(rules_.size()) + " ducking rules active on " +
+             std::to_string(targets_.size()) + " targets.");
+    return true;
+}
+
+void DuckingEngine::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    port_->Close();
+
+    // With every offset at zero, targets still ducked get their user gain back.
+    script_.clear();
+    std::fill(targetOffsets_.begin(), targetOffsets_.end(), 0.0f);
+    size_t restores = WriteScript();
+    if (restores > 0) {
+        LOG_INFO("[DuckingEngine::Stop] Restoring the gain of " + std::to_string(restores) + " ducked targets.");
+        port_->Restore(script_);
+    }
+    port_ = nullptr;
+}
+
+void DuckingEngine::ThreadProc() {
+    const std::chrono::milliseconds interval(DUCK_INTERVAL_MS);
+
+    Clock::time_point nextCycle = Clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        port_->RunCycle(*this);
+
+        nextCycle += interval;
+        Clock::time_point now = Clock::now();
+        if (nextCycle < now) {
+            nextCycle = now + interval;  // Fell behind; do not burst to catch up.
+        }
+        std::this_thread::sleep_until(nextCycle);
+    }
+}
+
+void DuckingEngine::Process(const float* levels, const float* values) {
+    script_.clear();
+    cycleActivations_ = 0;
+    cycleOverrides_ = 0;
+
+    // Envelopes advance by the time that really passed, so a late cycle does not stretch them.
+    Clock::time_point now = Clock::now();
+    float elapsedMs = processed_ ? std::chrono::duration<float, std::milli>(now - lastProcess_).count()
+                                 : static_cast<float>(DUCK_INTERVAL_MS);
+    lastProcess_ = now;
+    processed_ = true;
+
+    ObserveValues(values);
+    AdvanceEnvelopes(levels, elapsedMs);
+    size_t writes = WriteScript();
+
+    std::lock_guard<ProfiledMutex> lock(statsMutex_);
+    ++stats_.cycles;
+    stats_.writes += writes;
+    stats_.activations += cycleActivations_;
+    stats_.overrides += cycleOverrides_;
+}
+
+void DuckingEngine::ObserveValues(const float* values) {
+    for (size_t slot = 0; slot < targetStates_.size(); ++slot) {
+        TargetState& state = targetStates_[slot];
+        float value = values[slot];
+        if (std::isnan(value)) {
+            continue;
+        }
+
+        if (!state.known) {
+            state.known = true;
+            state.userDb = value;
+            state.writtenDb = value;
+            state.appliedDb = 0.0f;
+            continue;
+        }
+
+        bool same = std::fabs(value - state.writtenDb) <= SCENE_GAIN_EPSILON_DB;
+        if (state.settleCycles > 0) {
+            // Our own write may not have reached the mixer yet.
+            state.settleCycles = same ? 0 : static_cast<uint8_t>(state.settleCycles - 1);
+            continue;
+        }
+        if (same) {
+            continue;
+        }
+
+        // Moved elsewhere: the gain it shows now is the one the user wants.
+        if (state.appliedDb != 0.0f || targetOffsets_[slot] != 0.0f) {
+            state.suspended = true;
+            ++cycleOverrides_;
+        }
+        state.userDb = value;
+        state.writtenDb = value;
+        state.appliedDb = 0.0f;
+    }
+}
+
+void DuckingEngine::AdvanceEnvelopes(const float* levels, float elapsedMs) {
+    std::fill(targetOffsets_.begin(), targetOffsets_.end(), 0.0f);
+
+    for (size_t slot = 0; slot < rules_.size(); ++slot) {
+        const DuckRule& rule = rules_[slot];
+        RuleState& state = ruleStates_[slot];
+
+        // NaN and silence both read as -inf.
+        float level = levels[state.trigger];
+        float levelDb = level > 0.0f ? 20.0f * std::log10(level) : -std::numeric_limits<float>::infinity();
+        bool active = levelDb >= rule.thresholdDb;
+        if (active && !state.active) {
+            ++cycleActivations_;
+        }
+        state.active = active;
+
+        if (active) {
+            state.holdLeftMs = rule.holdMs;
+            state.offsetDb = rule.attackMs == 0
+                ? rule.depthDb
+                : (std::max)(rule.depthDb, state.offsetDb + rule.depthDb * elapsedMs / rule.attackMs);
+        } else if (state.holdLeftMs > 0.0f) {
+            state.holdLeftMs -= elapsedMs;
+        } else {
+            state.offsetDb = rule.releaseMs == 0
+                ? 0.0f
+                : (std::min)(0.0f, state.offsetDb - rule.depthDb * elapsedMs / rule.releaseMs);
+        }
+
+        // The deepest rule on a target wins.
+        float& offset = targetOffsets_[state.target];
+        offset = (std::min)(offset, state.offsetDb);
+    }
+}
+
+size_t DuckingEngine::WriteScript() {
+    size_t writes = 0;
+    char statement[PARAMETER_NAME_LENGTH * 2];
+    for (size_t slot = 0; slot < targetStates_.size(); ++slot) {
+        TargetState& state = targetStates_[slot];
+        if (!state.known) {
+            continue;
+        }
+
+        float offset = targetOffsets_[slot];
+        if (state.suspended) {
+            // Left alone until every rule on it has released; the next duck starts from the user's gain.
+            state.suspended = offset < 0.0f;
+            continue;
+        }
+
+        float step = std::round(offset / DUCK_WRITE_STEP_DB) * DUCK_WRITE_STEP_DB;
+        if (std::fabs(step - state.appliedDb) < DUCK_WRITE_STEP_DB / 2.0f) {
+            continue;
+        }
+
+        // Fully released, the user's gain goes back as it was read.
+        float value = step == 0.0f
+            ? state.userDb
+            : (std::min)((std::max)(state.userDb + step, static_cast<float>(DEFAULT_MIN_DBM)), static_cast<float>(DEFAULT_MAX_DBM));
+        // Written with two decimals, so compare against what will read back.
+        value = std::round(value * 100.0f) / 100.0f;
+
+        std::snprintf(statement, sizeof(statement), "%s=%.2f;", parameters_[slot].c_str(), value);
+        script_ += statement;
+        ++writes;
+
+        state.writtenDb = value;
+        state.appliedDb = step;
+        state.settleCycles = DUCK_SETTLE_CYCLES;
+    }
+    return writes;
+}
+
+DuckingEngine::Stats DuckingEngine::GetStats() const {
+    std::lock_guard<ProfiledMutex> lock(statsMutex_);
+    return stats_;
+}
+
+bool DuckingEngine::Benchmark(uint32_t rules) {
+    if (rules < 1 || rules > DUCK_MAX_RULES) {
+        LOG_ERROR("[DuckingEngine::Benchmark] Rule count must be 1-" + std::to_string(DUCK_MAX_RULES) + ".");
+        return false;
+    }
+
+    // Microphones on strips 0 and 1 duck music strips and buses; rules past
+    // the last target duck targets already taken with the other microphone.
+    const DuckChannel TARGETS[] = {
+        {ChannelType::Input, 2}, {ChannelType::Input, 3}, {ChannelType::Input, 4},
+        {ChannelType::Input, 5}, {ChannelType::Input, 6}, {ChannelType::Input, 7},
+        {ChannelType::Output, 0}, {ChannelType::Output, 1}, {ChannelType::Output, 2}, {ChannelType::Output, 3},
+        {ChannelType::Output, 4}, {ChannelType::Output, 5}, {ChannelType::Output, 6}, {ChannelType::Output, 7},
+    };
+    const size_t targetCount = sizeof(TARGETS) / sizeof(TARGETS[0]);
+
+    DuckingEngine engine;
+    for (uint32_t i = 0; i < rules; ++i) {
+        DuckRule rule;
+        rule.trigger = {ChannelType::Input, static_cast<uint8_t>(i < targetCount ? i % 2 : (i + 1) % 2)};
+        rule.target = TARGETS[i % targetCount];
+        rule.attackMs = BENCH_ATTACK_MS;
+        rule.holdMs = BENCH_HOLD_MS;
+        rule.releaseMs = BENCH_RELEASE_MS;
+        engine.AddRule(rule);
+    }
+
+    const std::vector<DuckChannel>& triggers = engine.Triggers();
+    size_t targets = engine.Targets().size();
+    SimulatedLevelPort port(triggers, engine.TargetParameters());
+
+    // Every target gets its own user gain, so a restore to the wrong one shows.
+    std::vector<float> initialGains(targets);
+    for (size_t t = 0; t < targets; ++t) {
+        initialGains[t] = -3.0f - 0.5f * static_cast<float>(t);
+        port.SetValue(t, initialGains[t]);
+    }
+    std::vector<float> userGains = initialGains;
+    for (size_t trigger = 0; trigger < triggers.size(); ++trigger) {
+        port.SetLevel(trigger, BENCH_SILENT_LEVEL);
+    }
+
+    // The target of the second rule is moved while both microphones duck it.
+    size_t moved = engine.ruleStates_[rules > 1 ? 1 : 0].target;
+    uint64_t writesBeforeMove = 0;
+    bool movedDone = false;
+
+    using BenchClock = std::chrono::steady_clock;
+    engine.Start(port);
+    BenchClock::time_point start = BenchClock::now();
+    std::vector<bool> talking(triggers.size(), false);
+    int elapsedMs = 0;
+    while ((elapsedMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(BenchClock::now() - start).count())) < BENCH_RUN_MS) {
+        for (size_t trigger = 0; trigger < triggers.size(); ++trigger) {
+            bool now = Talking(triggers[trigger].index, elapsedMs);
+            if (now != talking[trigger]) {
+                talking[trigger] = now;
+                port.SetLevel(trigger, now ? BENCH_TALK_LEVEL : BENCH_SILENT_LEVEL);
+            }
+        }
+        if (!movedDone && elapsedMs >= BENCH_MOVE_AT_MS) {
+            writesBeforeMove = port.Writes(moved);
+            port.SetValue(moved, BENCH_MOVED_GAIN_DB);
+            userGains[moved] = BENCH_MOVED_GAIN_DB;
+            movedDone = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint32_t shallow = 0;
+    uint32_t notRestored = 0;
+    for (size_t t = 0; t < targets; ++t) {
+        if (std::fabs(port.MinimumValue(t) - (initialGains[t] + DEFAULT_DUCK_DEPTH_DB)) > BENCH_DEPTH_TOLERANCE_DB) {
+            ++shallow;
+        }
+        if (std::fabs(port.GetValue(t) - userGains[t]) > BENCH_RESTORE_TOLERANCE_DB) {
+            ++notRestored;
+        }
+    }
+    uint64_t writesAfterMove = port.Writes(moved) - writesBeforeMove;
+
+    // Stopped mid-duck, every target must still get its user gain back.
+    for (size_t trigger = 0; trigger < triggers.size(); ++trigger) {
+        port.SetLevel(trigger, BENCH_TALK_LEVEL);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_ATTACK_MS * 3));
+    uint32_t notDuckedAtStop = 0;
+    for (size_t t = 0; t < targets; ++t) {
+        if (port.GetValue(t) > userGains[t] - DUCK_WRITE_STEP_DB) {
+            ++notDuckedAtStop;
+        }
+    }
+    engine.Stop();
+    uint32_t notRestoredAtStop = 0;
+    for (size_t t = 0; t < targets; ++t) {
+        if (std::fabs(port.GetValue(t) - userGains[t]) > BENCH_RESTORE_TOLERANCE_DB) {
+            ++notRestoredAtStop;
+        }
+    }
+    Stats stats = engine.GetStats();
+
+    std::vector<double> process = port.ProcessMicros();
+    std::vector<double> intervals = port.CycleIntervalsMs();
+    std::sort(process.begin(), process.end());
+    std::sort(intervals.begin(), intervals.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[DuckingEngine::Benchmark] " + std::to_string(rules) + " rules on " + std::to_string(triggers.size()) +
+             " triggers and " + std::to_string(targets) + " targets, " + std::to_string(stats.cycles) + " cycles at " +
+             std::to_string(1000 / DUCK_INTERVAL_MS) + " Hz. Evaluation p50: " + std::to_string(at(process, 0.5)) +
+             " us, p99: " + std::to_string(at(process, 0.99)) + " us, max: " + std::to_string(at(process, 1.0)) +
+             " us. Cycle interval p50: " + std::to_string(at(intervals, 0.5)) + " ms, p99: " +
+             std::to_string(at(intervals, 0.99)) + " ms.");
+    LOG_INFO("[DuckingEngine::Benchmark] " + std::to_string(stats.writes) + " gain writes in " +
+             std::to_string(port.Scripts()) + " scripts, " + std::to_string(stats.activations) + " activations, " +
+             std::to_string(stats.overrides) + " user moves kept.");
+
+    bool correct = shallow == 0 && notRestored == 0 && writesAfterMove == 0 && stats.overrides == 1 &&
+                   notDuckedAtStop == 0 && notRestoredAtStop == 0;
+    if (!correct) {
+        LOG_ERROR("[DuckingEngine::Benchmark] " + std::to_string(shallow) + " targets missed the ducking depth, " +
+                  std::to_string(notRestored) + " were not restored to the user gain, " +
+                  std::to_string(writesAfterMove) + " writes reached the target moved while ducked, " +
+                  std::to_string(notDuckedAtStop) + " were not ducked and " + std::to_string(notRestoredAtStop) +
+                  " not restored when stopped mid-duck.");
+    }
+    return correct;
+}
+
+// -----------------------------
+// SimulatedLevelPort
+// -----------------------------
+
+SimulatedLevelPort::SimulatedLevelPort(const std::vector<DuckChannel>& triggers, const std::vector<std::string>& parameters)
+    : parameters_(parameters),
+      levels_(triggers.size(), 0.0f),
+      values_(parameters.size(), 0.0f),
+      minimums_(parameters.size(), std::numeric_limits<float>::infinity()),
+      writes_(parameters.size(), 0),
+      levelSnapshot_(triggers.size(), 0.0f),
+      valueSnapshot_(parameters.size(), 0.0f) {
+    processMicros_.reserve(1024);
+    intervalsMs_.reserve(1024);
+}
+
+void SimulatedLevelPort::SetLevel(size_t trigger, float level) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    levels_[trigger] = level;
+}
+
+void SimulatedLevelPort::SetValue(size_t target, float value) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    values_[target] = value;
+}
+
+float SimulatedLevelPort::GetValue(size_t target) const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return values_[target];
+}
+
+float SimulatedLevelPort::MinimumValue(size_t target) const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return minimums_[target];
+}
+
+uint64_t SimulatedLevelPort::Writes(size_t target) const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return writes_[target];
+}
+
+bool SimulatedLevelPort::RunCycle(DuckingEngine& engine) {
+    Clock::time_point cycleStart = Clock::now();
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        levelSnapshot_ = levels_;
+        valueSnapshot_ = values_;
+        if (lastCycle_ != Clock::time_point()) {
+            intervalsMs_.push_back(std::chrono::duration<double, std::milli>(cycleStart - lastCycle_).count());
+        }
+        lastCycle_ = cycleStart;
+    }
+
+    Clock::time_point before = Clock::now();
+    engine.Process(levelSnapshot_.data(), valueSnapshot_.data());
+    double micros = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    processMicros_.push_back(micros);
+    if (!engine.Script().empty()) {
+        ApplyScript(engine.Script());
+        ++scripts_;
+    }
+    return true;
+}
+
+void SimulatedLevelPort::Restore(const std::string& script) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    ApplyScript(script);
+}
+
+void SimulatedLevelPort::ApplyScript(const std::string& script) {
+    size_t start = 0;
+    while (start < script.size()) {
+        size_t end = script.find(';', start);
+        if (end == std::string::npos) {
+            end = script.size();
+        }
+        size_t equals = script.find('=', start);
+        if (equals < end) {
+            std::string name = script.substr(start, equals - start);
+            for (size_t i = 0; i < parameters_.size(); ++i) {
+                if (parameters_[i] == name) {
+                    values_[i] = std::strtof(script.c_str() + equals + 1, nullptr);
+                    minimums_[i] = (std::min)(minimums_[i], values_[i]);
+                    ++writes_[i];
+                }
+            }
+        }
+        start = end + 1;
+    }
+}
+
+std::vector<double> SimulatedLevelPort::ProcessMicros() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return processMicros_;
+}
+
+std::vector<double> SimulatedLevelPort::CycleIntervalsMs() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return intervalsMs_;
+}
+
+uint64_t SimulatedLevelPort::Scripts() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return scripts_;
+}
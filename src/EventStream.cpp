@@ -0,0 +1,545 @@
+// EventStream.cpp
+// Winsock 2 has to come before windows.h, which pulls in the old winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "EventStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+namespace {
+// Everything in a frame before the text: length, type, side, sequence, timestamp and value
+constexpr size_t FRAME_HEADER_SIZE = 2 + 1 + 1 + 4 + 8 + 4;
+constexpr size_t MAX_FRAME_SIZE = FRAME_HEADER_SIZE + EVENT_TEXT_LENGTH;
+
+// Bytes the benchmark's stalled subscriber lets the kernel buffer, so backpressure starts early
+constexpr int BENCH_STALLED_RECEIVE_BUFFER = 4096;
+
+void WriteLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t ReadLittleEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+size_t WriteFrame(uint8_t* out, const StreamEvent& event) {
+    uint32_t valueBits;
+    std::memcpy(&valueBits, &event.value, sizeof(valueBits));
+
+    WriteLittleEndian(out, FRAME_HEADER_SIZE - 2 + event.textLength, 2);
+    out[2] = static_cast<uint8_t>(event.type);
+    out[3] = static_cast<uint8_t>(event.side);
+    WriteLittleEndian(out + 4, event.sequence, 4);
+    WriteLittleEndian(out + 8, event.timestampUs, 8);
+    WriteLittleEndian(out + 16, valueBits, 4);
+    std::memcpy(out + FRAME_HEADER_SIZE, event.text, event.textLength);
+    return FRAME_HEADER_SIZE + event.textLength;
+}
+
+uint64_t NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+}  // namespace
+
+struct EventStream::Subscriber {
+    SOCKET socket = INVALID_SOCKET;
+    bool fresh = true;  ///< Gets the state snapshot before any event
+
+    StreamEvent queue[EVENT_QUEUE_DEPTH];
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint64_t statePosition[STATE_KEYS] = {};  ///< Queue position + 1 of the last volume or mute queued
+    uint32_t dropped = 0;                     ///< Events lost since the last Dropped frame
+
+    uint8_t out[EVENT_SEND_BUFFER_BYTES];
+    size_t outLength = 0;
+    size_t outOffset = 0;
+};
+
+EventStream& EventStream::Instance() {
+    static EventStream instance;
+    return instance;
+}
+
+EventStream::EventStream()
+    : wakeEvent_(CreateEventW(nullptr, FALSE, FALSE, nullptr)), socket_(static_cast<uintptr_t>(INVALID_SOCKET)) {
+    if (!wakeEvent_.get()) {
+        throw std::runtime_error("Failed to create EventStream wake event");
+    }
+}
+
+EventStream::~EventStream() {
+    Stop();
+}
+
+int EventStream::StateKey(StreamEventType type, StreamEventSide side) {
+    if ((type != StreamEventType::Volume && type != StreamEventType::Mute) || side == StreamEventSide::None) {
+        return -1;
+    }
+    return (type == StreamEventType::Mute ? 2 : 0) + (side == StreamEventSide::Voicemeeter ? 1 : 0);
+}
+
+bool EventStream::Start(uint16_t port) {
+    if (running_) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("[EventStream::Start] WSAStartup failed.");
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        LOG_ERROR("[EventStream::Start] Failed to create socket. Error: " + std::to_string(WSAGetLastError()));
+        WSACleanup();
+        return false;
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    unsigned long nonBlocking = 1;
+    if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || listen(sock, SOMAXCONN) != 0 ||
+        ioctlsocket(sock, FIONBIO, &nonBlocking) != 0) {
+        LOG_ERROR("[EventStream::Start] Failed to listen on TCP port " + std::to_string(port) + ". Error: " + std::to_string(WSAGetLastError()));
+        closesocket(sock);
+        WSACleanup();
+        return false;
+    }
+
+    int localLength = sizeof(local);
+    getsockname(sock, reinterpret_cast<sockaddr*>(&local), &localLength);
+    port_ = ntohs(local.sin_port);
+    socket_ = static_cast<uintptr_t>(sock);
+
+    {
+        std::lock_guard<ProfiledMutex> lock(ringMutex_);
+        ringHead_ = 0;
+        ringCount_ = 0;
+    }
+    running_ = true;
+    thread_ = std::thread(&EventStream::ThreadProc, this);
+    LOG_INFO("[EventStream::Start] Streaming events on 127.0.0.1:" + std::to_string(port_) + ".");
+    return true;
+}
+
+void EventStream::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    SetEvent(wakeEvent_.get());
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    for (size_t slot = 0; slot < EVENT_MAX_SUBSCRIBERS; ++slot) {
+        if (subscribers_[slot]) {
+            Disconnect(slot);
+        }
+    }
+    closesocket(static_cast<SOCKET>(socket_));
+    socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    WSACleanup();
+}
+
+EventStream::Stats EventStream::GetStats() const {
+    Stats stats;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.overflowed = overflowed_.load(std::memory_order_relaxed);
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.disconnects = disconnects_.load(std::memory_order_relaxed);
+    stats.subscribers = subscriberCount_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void EventStream::PublishVolume(StreamEventSide side, float volumePercent) {
+    Publish(StreamEventType::Volume, side, volumePercent, nullptr);
+}
+
+void EventStream::PublishMute(StreamEventSide side, bool isMuted) {
+    Publish(StreamEventType::Mute, side, isMuted ? 1.0f : 0.0f, nullptr);
+}
+
+void EventStream::PublishDevice(const char* deviceId) {
+    Publish(StreamEventType::Device, StreamEventSide::Windows, 0.0f, deviceId);
+}
+
+void EventStream::PublishScene(int preset, const char* name) {
+    Publish(StreamEventType::Scene, StreamEventSide::Voicemeeter, static_cast<float>(preset), name);
+}
+
+void EventStream::Publish(StreamEventType type, StreamEventSide side, float value, const char* text) {
+    StreamEvent event;
+    event.type = type;
+    event.side = side;
+    event.value = value;
+    event.timestampUs = NowUs();
+    if (text) {
+        event.textLength = static_cast<uint8_t>(std::min(std::strlen(text), EVENT_TEXT_LENGTH));
+        std::memcpy(event.text, text, event.textLength);
+    }
+
+    int key = StateKey(type, side);
+    bool wake = false;
+    {
+        std::lock_guard<ProfiledMutex> lock(ringMutex_);
+        if (key >= 0) {
+            if (stateKnown_[key] && state_[key].value == value) {
+                return;  // Polled samples repeat; only changes are events
+            }
+            stateKnown_[key] = true;
+        }
+        event.sequence = ++sequence_;
+        if (key >= 0) {
+            state_[key] = event;
+        }
+        if (!running_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (ringCount_ == EVENT_RING_SIZE) {
+            overflowed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring_[(ringHead_ + ringCount_) % EVENT_RING_SIZE] = event;
+        wake = ++ringCount_ == 1;
+    }
+
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if (wake) {
+        SetEvent(wakeEvent_.get());
+    }
+}
+
+void EventStream::ThreadProc() {
+    while (running_.load(std::memory_order_acquire)) {
+        WaitForSingleObject(wakeEvent_.get(), EVENT_POLL_INTERVAL_MS);
+        Accept();
+
+        // Take the batch and the state it leads to together: subscribers that
+        // connected this round get the state instead of the batch.
+        size_t count = 0;
+        bool known[STATE_KEYS];
+        {
+            std::lock_guard<ProfiledMutex> lock(ringMutex_);
+            for (; count < ringCount_; ++count) {
+                batch_[count] = ring_[(ringHead_ + count) % EVENT_RING_SIZE];
+            }
+            ringHead_ = (ringHead_ + count) % EVENT_RING_SIZE;
+            ringCount_ = 0;
+            for (size_t key = 0; key < STATE_KEYS; ++key) {
+                known[key] = stateKnown_[key];
+                snapshot_[key] = state_[key];
+            }
+        }
+
+        for (size_t slot = 0; slot < EVENT_MAX_SUBSCRIBERS; ++slot) {
+            Subscriber* subscriber = subscribers_[slot].get();
+            if (!subscriber) {
+                continue;
+            }
+            if (subscriber->fresh) {
+                subscriber->fresh = false;
+                for (size_t key = 0; key < STATE_KEYS; ++key) {
+                    if (known[key]) {
+                        Enqueue(*subscriber, snapshot_[key]);
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Enqueue(*subscriber, batch_[i]);
+                }
+            }
+            if (!Flush(*subscriber)) {
+                Disconnect(slot);
+            }
+        }
+    }
+}
+
+void EventStream::Accept() {
+    SOCKET listener = static_cast<SOCKET>(socket_);
+    while (true) {
+        SOCKET client = accept(listener, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            return;
+        }
+
+        size_t slot = 0;
+        while (slot < EVENT_MAX_SUBSCRIBERS && subscribers_[slot]) {
+            ++slot;
+        }
+        unsigned long nonBlocking = 1;
+        if (slot == EVENT_MAX_SUBSCRIBERS || ioctlsocket(client, FIONBIO, &nonBlocking) != 0) {
+            LOG_WARNING("[EventStream::Accept] Subscriber refused; " + std::to_string(EVENT_MAX_SUBSCRIBERS) + " are connected.");
+            closesocket(client);
+            continue;
+        }
+        // Frames are small and latency matters more than packet count.
+        int noDelay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        subscribers_[slot].reset(new Subscriber);
+        subscribers_[slot]->socket = client;
+        subscriberCount_.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG("[EventStream::Accept] Subscriber connected in slot " + std::to_string(slot) + ".");
+    }
+}
+
+void EventStream::Enqueue(Subscriber& subscriber, const StreamEvent& event) {
+    int key = StateKey(event.type, event.side);
+    if (key >= 0 && subscriber.statePosition[key] > subscriber.popped) {
+        // Still waiting to be sent: only the newest value matters.
+        subscriber.queue[(subscriber.statePosition[key] - 1) % EVENT_QUEUE_DEPTH] = event;
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (subscriber.pushed - subscriber.popped == EVENT_QUEUE_DEPTH) {
+        ++subscriber.dropped;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    subscriber.queue[subscriber.pushed % EVENT_QUEUE_DEPTH] = event;
+    ++subscriber.pushed;
+    if (key >= 0) {
+        subscriber.statePosition[key] = subscriber.pushed;
+    }
+}
+
+bool EventStream::Flush(Subscriber& subscriber) {
+    while (true) {
+        if (subscriber.outOffset < subscriber.outLength) {
+            int sent = send(subscriber.socket, reinterpret_cast<const char*>(subscriber.out + subscriber.outOffset),
+                            static_cast<int>(subscriber.outLength - subscriber.outOffset), 0);
+            if (sent < 0) {
+                return WSAGetLastError() == WSAEWOULDBLOCK;  // Anything else: the subscriber is gone
+            }
+            subscriber.outOffset += static_cast<size_t>(sent);
+            if (subscriber.outOffset < subscriber.outLength) {
+                return true;  // Socket buffer full; events keep coalescing in the queue meanwhile
+            }
+        }
+
+        // Refill from the queue only once the previous frames are out.
+        subscriber.outOffset = 0;
+        subscriber.outLength = 0;
+        if (subscriber.dropped > 0) {
+            StreamEvent notice;
+            notice.type = StreamEventType::Dropped;
+            notice.value = static_cast<float>(subscriber.dropped);
+            notice.timestampUs = NowUs();
+            subscriber.outLength += WriteFrame(subscriber.out, notice);
+            subscriber.dropped = 0;
+        }
+        size_t frames = 0;
+        while (subscriber.popped < subscriber.pushed && EVENT_SEND_BUFFER_BYTES - subscriber.outLength >= MAX_FRAME_SIZE) {
+            const StreamEvent& event = subscriber.queue[subscriber.popped % EVENT_QUEUE_DEPTH];
+            subscriber.outLength += WriteFrame(subscriber.out + subscriber.outLength, event);
+            ++subscriber.popped;
+            ++frames;
+        }
+        frames_.fetch_add(frames, std::memory_order_relaxed);
+        if (subscriber.outLength == 0) {
+            return true;
+        }
+    }
+}
+
+void EventStream::Disconnect(size_t slot) {
+    closesocket(subscribers_[slot]->socket);
+    subscribers_[slot].reset();
+    subscriberCount_.fetch_sub(1, std::memory_order_relaxed);
+    disconnects_.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("[EventStream::Disconnect] Subscriber in slot " + std::to_string(slot) + " disconnected.");
+}
+
+bool EventStream::Benchmark(uint32_t subscribers) {
+    using BenchClock = std::chrono::steady_clock;
+
+    if (subscribers < 2 || subscribers > EVENT_MAX_SUBSCRIBERS) {
+        LOG_ERROR("[EventStream::Benchmark] Subscriber count must be 2-" + std::to_string(EVENT_MAX_SUBSCRIBERS) + ".");
+        return false;
+    }
+
+    EventStream stream;
+    if (!stream.Start(0)) {
+        return false;
+    }
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(stream.Port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // The last subscriber connects with a tiny receive buffer and never reads.
+    std::vector<SOCKET> sockets(subscribers, INVALID_SOCKET);
+    bool connected = true;
+    for (uint32_t i = 0; i < subscribers && connected; ++i) {
+        sockets[i] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (i + 1 == subscribers) {
+            int receiveBuffer = BENCH_STALLED_RECEIVE_BUFFER;
+            setsockopt(sockets[i], SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+        }
+        connected = sockets[i] != INVALID_SOCKET &&
+                    connect(sockets[i], reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    BenchClock::time_point deadline = BenchClock::now() + std::chrono::seconds(2);
+    while (connected && stream.GetStats().subscribers < subscribers && BenchClock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    connected = connected && stream.GetStats().subscribers == subscribers;
+
+    // Readers: every subscriber but the stalled one, parsed on one thread.
+    const size_t readers = subscribers - 1;
+    const uint32_t events = static_cast<uint32_t>(EVENT_BENCH_RATE_HZ) * EVENT_BENCH_SECONDS;
+    std::vector<std::vector<uint8_t>> buffers(readers, std::vector<uint8_t>(64 * 1024));
+    std::vector<size_t> buffered(readers, 0);
+    std::vector<uint64_t> frames(readers, 0);
+    std::vector<uint64_t> scenes(readers, 0);
+    std::vector<float> lastVolume(readers * 2, -1.0f);
+    std::vector<uint32_t> latenciesUs;
+    latenciesUs.reserve(static_cast<size_t>(events) * readers);
+    std::atomic<bool> reading{connected};
+
+    std::thread reader([&]() {
+        while (reading.load()) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            for (size_t i = 0; i < readers; ++i) {
+                FD_SET(sockets[i], &readable);
+            }
+            timeval timeout{0, 10000};
+            if (select(0x7FFFFFFF, &readable, nullptr, nullptr, &timeout) <= 0) {
+                continue;
+            }
+            uint64_t now = NowUs();
+            for (size_t i = 0; i < readers; ++i) {
+                if (!FD_ISSET(sockets[i], &readable)) {
+                    continue;
+                }
+                std::vector<uint8_t>& buffer = buffers[i];
+                int received = recv(sockets[i], reinterpret_cast<char*>(buffer.data() + buffered[i]),
+                                    static_cast<int>(buffer.size() - buffered[i]), 0);
+                if (received <= 0) {
+                    continue;
+                }
+                buffered[i] += static_cast<size_t>(received);
+
+                size_t offset = 0;
+                while (buffered[i] - offset >= 2) {
+                    size_t length = static_cast<size_t>(ReadLittleEndian(buffer.data() + offset, 2));
+                    if (buffered[i] - offset < 2 + length) {
+                        break;
+                    }
+                    const uint8_t* frame = buffer.data() + offset;
+                    uint64_t timestamp = ReadLittleEndian(frame + 8, 8);
+                    uint32_t valueBits = static_cast<uint32_t>(ReadLittleEndian(frame + 16, 4));
+                    float value;
+                    std::memcpy(&value, &valueBits, sizeof(value));
+                    if (frame[2] == static_cast<uint8_t>(StreamEventType::Volume)) {
+                        lastVolume[i * 2 + (frame[3] == static_cast<uint8_t>(StreamEventSide::Voicemeeter) ? 1 : 0)] = value;
+                    } else if (frame[2] == static_cast<uint8_t>(StreamEventType::Scene)) {
+                        ++scenes[i];
+                    }
+                    if (now >= timestamp) {
+                        latenciesUs.push_back(static_cast<uint32_t>(std::min<uint64_t>(now - timestamp, UINT32_MAX)));
+                    }
+                    ++frames[i];
+                    offset += 2 + length;
+                }
+                std::memmove(buffer.data(), buffer.data() + offset, buffered[i] - offset);
+                buffered[i] -= offset;
+            }
+        }
+    });
+
+    // Publish at a fixed rate: volume changes alternating between sides, and a scene every 100 events.
+    std::vector<double> publishUs;
+    publishUs.reserve(events);
+    float lastSent[2] = {-1.0f, -1.0f};
+    uint32_t scenesSent = 0;
+    const std::chrono::microseconds period(1000000 / EVENT_BENCH_RATE_HZ);
+    BenchClock::time_point next = BenchClock::now();
+    for (uint32_t i = 0; i < events && connected; ++i) {
+        next += period;
+        std::this_thread::sleep_until(next);
+
+        BenchClock::time_point start = BenchClock::now();
+        int side = static_cast<int>(i % 2);
+        lastSent[side] = static_cast<float>((i / 2) % 101);
+        stream.PublishVolume(side ? StreamEventSide::Voicemeeter : StreamEventSide::Windows, lastSent[side]);
+        if (i % 100 == 99) {
+            stream.PublishScene(static_cast<int>(scenesSent++ % 4), "bench");
+        }
+        publishUs.push_back(std::chrono::duration<double, std::micro>(BenchClock::now() - start).count());
+    }
+
+    // Let the readers drain what is in flight.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    reading = false;
+    reader.join();
+    Stats stats = stream.GetStats();
+    stream.Stop();
+    for (SOCKET sock : sockets) {
+        if (sock != INVALID_SOCKET) {
+            closesocket(sock);
+        }
+    }
+    WSACleanup();
+
+    if (!connected) {
+        LOG_ERROR("[EventStream::Benchmark] Not every subscriber could connect.");
+        return false;
+    }
+
+    bool complete = stats.overflowed == 0;
+    uint64_t minFrames = UINT64_MAX;
+    uint64_t totalFrames = 0;
+    for (size_t i = 0; i < readers; ++i) {
+        complete = complete && scenes[i] == scenesSent && lastVolume[i * 2] == lastSent[0] && lastVolume[i * 2 + 1] == lastSent[1];
+        minFrames = std::min(minFrames, frames[i]);
+        totalFrames += frames[i];
+    }
+
+    std::sort(publishUs.begin(), publishUs.end());
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[EventStream::Benchmark] " + std::to_string(stats.published) + " events published at " +
+             std::to_string(EVENT_BENCH_RATE_HZ) + " Hz to " + std::to_string(subscribers) + " subscribers. Publish cost p50: " +
+             std::to_string(at(publishUs, 0.5)) + " us, p99: " + std::to_string(at(publishUs, 0.99)) + " us, max: " +
+             std::to_string(at(publishUs, 1.0)) + " us.");
+    LOG_INFO("[EventStream::Benchmark] " + std::to_string(readers) + " reading subscribers received " +
+             std::to_string(totalFrames) + " frames (at least " + std::to_string(minFrames) + " each). Delivery latency p50: " +
+             std::to_string(at(latenciesUs, 0.5)) + " us, p99: " + std::to_string(at(latenciesUs, 0.99)) + " us, max: " +
+             std::to_string(at(latenciesUs, 1.0)) + " us.");
+    LOG_INFO("[EventStream::Benchmark] Backpressure: " + std::to_string(stats.coalesced) + " events coalesced, " +
+             std::to_string(stats.dropped) + " dropped, " + std::to_string(stats.overflowed) + " lost to ring overflow.");
+    if (!complete) {
+        LOG_ERROR("[EventStream::Benchmark] A reading subscriber missed a scene or the final volumes.");
+    }
+    return complete;
+}
@@ -0,0 +1,196 @@
+// FootprintReporter.cpp
+#include "FootprintReporter.h"
+
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+
+#include <atomic>
+#include <string>
+
+#include "Logger.h"
+#include "Metrics.h"
+#include "RAIIHandle.h"
+
+namespace {
+constexpr size_t SUBSYSTEM_COUNT = static_cast<size_t>(AllocationSubsystem::Count);
+constexpr size_t MAX_MODULES = 512;
+
+struct FootprintMetrics {
+    Metric* workingSet = nullptr;
+    Metric* privateBytes = nullptr;
+    Metric* threads = nullptr;
+    Metric* stackReserve = nullptr;
+    Metric* voicemeeterDll = nullptr;
+    Metric* mappedImages = nullptr;
+    Metric* heapLive[SUBSYSTEM_COUNT] = {};
+    Metric* heapAllocations[SUBSYSTEM_COUNT] = {};
+};
+
+FootprintMetrics footprintMetrics;
+std::atomic<bool> metricsRegistered{false};
+
+uint64_t DefaultStackReserve() {
+    auto* base = reinterpret_cast<const BYTE*>(GetModuleHandleA(nullptr));
+    if (!base) {
+        return 0;
+    }
+    auto* dos = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
+    auto* nt = reinterpret_cast<const IMAGE_NT_HEADERS*>(base + dos->e_lfanew);
+    return static_cast<uint64_t>(nt->OptionalHeader.SizeOfStackReserve);
+}
+
+uint32_t CountThreads() {
+    HANDLE rawSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (rawSnapshot == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    RAIIHandle snapshot(rawSnapshot);
+
+    DWORD processId = GetCurrentProcessId();
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    uint32_t count = 0;
+    if (Thread32First(snapshot.get(), &entry)) {
+        do {
+            if (entry.th32OwnerProcessID == processId) {
+                ++count;
+            }
+        } while (Thread32Next(snapshot.get(), &entry));
+    }
+    return count;
+}
+
+uint64_t ModuleImageSize(HANDLE process, HMODULE module) {
+    MODULEINFO info;
+    if (!module || !GetModuleInformation(process, module, &info, sizeof(info))) {
+        return 0;
+    }
+    return info.SizeOfImage;
+}
+}  // namespace
+
+int64_t Footprint::TrackedHeapBytes() const {
+    int64_t total = 0;
+    for (int64_t bytes : heapLiveBytes) {
+        total += bytes;
+    }
+    return total;
+}
+
+Footprint FootprintReporter::Sample() {
+    Footprint footprint;
+    HANDLE process = GetCurrentProcess();
+
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        footprint.workingSetBytes = counters.WorkingSetSize;
+        footprint.privateBytes = counters.PrivateUsage;
+    }
+
+    footprint.threadCount = CountThreads();
+    footprint.stackReserveBytes = footprint.threadCount * DefaultStackReserve();
+
+    footprint.voicemeeterDllBytes = ModuleImageSize(process, GetModuleHandleA("VoicemeeterRemote64.dll")) +
+                                    ModuleImageSize(process, GetModuleHandleA("VoicemeeterRemote.dll"));
+
+    HMODULE modules[MAX_MODULES];
+    DWORD needed = 0;
+    if (EnumProcessModules(process, modules, sizeof(modules), &needed)) {
+        size_t moduleCount = needed / sizeof(HMODULE);
+        if (moduleCount > MAX_MODULES) {
+            moduleCount = MAX_MODULES;
+        }
+        for (size_t i = 0; i < moduleCount; ++i) {
+            footprint.mappedImageBytes += ModuleImageSize(process, modules[i]);
+        }
+    }
+
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        footprint.heapLiveBytes[i] = AllocationTracker::SubsystemCounters(static_cast<AllocationSubsystem>(i)).liveBytes;
+    }
+    return footprint;
+}
+
+void FootprintReporter::RegisterMetrics() {
+    if (metricsRegistered.exchange(true)) {
+        return;
+    }
+
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    FootprintMetrics& m = footprintMetrics;
+    m.workingSet = registry.Gauge("voicemirror_working_set_bytes", "Process working set.");
+    m.privateBytes = registry.Gauge("voicemirror_private_bytes", "Process private (committed) bytes.");
+    m.threads = registry.Gauge("voicemirror_threads", "Threads in the process.");
+    m.stackReserve = registry.Gauge("voicemirror_thread_stack_reserved_bytes",
+                                    "Address space reserved for thread stacks.");
+    m.voicemeeterDll = registry.Gauge("voicemirror_module_image_bytes", "Mapped size of loaded module images.",
+                                      "module", "VoicemeeterRemote");
+    m.mappedImages = registry.Gauge("voicemirror_module_image_bytes", "Mapped size of loaded module images.",
+                                    "module", "all");
+
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        const char* name = AllocationTracker::SubsystemName(static_cast<AllocationSubsystem>(i));
+        m.heapLive[i] = registry.Gauge("voicemirror_heap_live_bytes",
+                                       "Live heap bytes by subsystem (allocation-tracking builds only).",
+                                       "subsystem", name);
+        m.heapAllocations[i] = registry.Counter("voicemirror_heap_allocations_total",
+                                                "Heap allocations by subsystem (allocation-tracking builds only).",
+                                                "subsystem", name);
+    }
+
+    registry.AddCollector([]() {
+        Footprint footprint = FootprintReporter::Sample();
+        FootprintMetrics& m = footprintMetrics;
+        auto set = [](Metric* metric, double value) {
+            if (metric) {
+                metric->Set(value);
+            }
+        };
+
+        set(m.workingSet, static_cast<double>(footprint.workingSetBytes));
+        set(m.privateBytes, static_cast<double>(footprint.privateBytes));
+        set(m.threads, footprint.threadCount);
+        set(m.stackReserve, static_cast<double>(footprint.stackReserveBytes));
+        set(m.voicemeeterDll, static_cast<double>(footprint.voicemeeterDllBytes));
+        set(m.mappedImages, static_cast<double>(footprint.mappedImageBytes));
+        for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+            set(m.heapLive[i], static_cast<double>(footprint.heapLiveBytes[i]));
+            set(m.heapAllocations[i], static_cast<double>(
+                AllocationTracker::SubsystemCounters(static_cast<AllocationSubsystem>(i)).allocations));
+        }
+    });
+}
+
+void FootprintReporter::Log(const Footprint& footprint) {
+    LOG_INFO("[FootprintReporter::Log] Working set: " + std::to_string(footprint.workingSetBytes / 1024) +
+             " KiB, private: " + std::to_string(footprint.privateBytes / 1024) +
+             " KiB, threads: " + std::to_string(footprint.threadCount) +
+             " (" + std::to_string(footprint.stackReserveBytes / 1024) + " KiB stack reserved)" +
+             ", VoicemeeterRemote: " + std::to_string(footprint.voicemeeterDllBytes / 1024) +
+             " KiB, all images: " + std::to_string(footprint.mappedImageBytes / 1024) + " KiB.");
+
+    if (!AllocationTracker::IsEnabled()) {
+        return;
+    }
+    for (size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        LOG_INFO(std::string("[FootprintReporter::Log] Heap ") +
+                 AllocationTracker::SubsystemName(static_cast<AllocationSubsystem>(i)) + ": " +
+                 std::to_string(footprint.heapLiveBytes[i]) + " bytes live.");
+    }
+}
+
+bool FootprintReporter::CheckBudget(const Footprint& footprint, uint16_t budgetMB) {
+    if (budgetMB == 0) {
+        return true;
+    }
+
+    uint64_t budgetBytes = static_cast<uint64_t>(budgetMB) * 1024 * 1024;
+    if (footprint.privateBytes <= budgetBytes) {
+        return true;
+    }
+
+    LOG_WARNING("[FootprintReporter::CheckBudget] Private bytes " + std::to_string(footprint.privateBytes / 1024) +
+                " KiB exceed the " + std::to_string(budgetMB) + " MiB budget.");
+    return false;
+}
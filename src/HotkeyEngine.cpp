@@ -0,0 +1,309 @@
+// HotkeyEngine.cpp
+#include "HotkeyEngine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+
+namespace {
+// Windows virtual key codes, spelled out so parsing does not depend on winuser.h
+constexpr uint8_t KEY_F1 = 0x70;
+constexpr int KEY_F_COUNT = 24;
+
+struct NamedKey {
+    const char* name;
+    uint8_t vk;
+};
+
+constexpr NamedKey NAMED_KEYS[] = {
+    {"space", 0x20}, {"pageup", 0x21}, {"pagedown", 0x22}, {"end", 0x23}, {"home", 0x24},
+    {"left", 0x25}, {"up", 0x26}, {"right", 0x27}, {"down", 0x28},
+    {"insert", 0x2D}, {"delete", 0x2E}, {"pause", 0x13},
+    {"volumemute", 0xAD}, {"volumedown", 0xAE}, {"volumeup", 0xAF},
+};
+
+std::string Lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+bool ParseKey(const std::string& name, uint8_t& vk) {
+    std::string key = Lower(name);
+    if (key.size() == 1 && std::isalnum(static_cast<unsigned char>(key[0]))) {
+        vk = static_cast<uint8_t>(std::toupper(static_cast<unsigned char>(key[0])));
+        return true;
+    }
+    if (key.size() >= 2 && key[0] == 'f' && std::isdigit(static_cast<unsigned char>(key[1]))) {
+        int number = std::atoi(key.c_str() + 1);
+        if (number >= 1 && number <= KEY_F_COUNT) {
+            vk = static_cast<uint8_t>(KEY_F1 + number - 1);
+            return true;
+        }
+        return false;
+    }
+    for (const NamedKey& named : NAMED_KEYS) {
+        if (key == named.name) {
+            vk = named.vk;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseModifier(const std::string& name, uint16_t& modifiers) {
+    std::string modifier = Lower(name);
+    if (modifier == "ctrl" || modifier == "control") {
+        modifiers |= MOD_CONTROL;
+    } else if (modifier == "alt") {
+        modifiers |= MOD_ALT;
+    } else if (modifier == "shift") {
+        modifiers |= MOD_SHIFT;
+    } else if (modifier == "win") {
+        modifiers |= MOD_WIN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseChannel(const std::string& type, const std::string& index, HotkeyAction& action) {
+    std::string channelType = Lower(type);
+    if (channelType != "input" && channelType != "output") {
+        return false;
+    }
+    char* end = nullptr;
+    long channelIndex = std::strtol(index.c_str(), &end, 10);
+    if (index.empty() || *end != '\0' || channelIndex < 0 || channelIndex >= static_cast<long>(SCENE_MAX_STRIPS)) {
+        return false;
+    }
+    action.channelType = channelType == "input" ? ChannelType::Input : ChannelType::Output;
+    action.channelIndex = static_cast<uint8_t>(channelIndex);
+    return true;
+}
+
+}  // namespace
+
+bool SyntheticKeySource::Start(const std::vector<HotkeyBinding>&, KeyHandler handler) {
+    handler_ = std::move(handler);
+    return true;
+}
+
+void SyntheticKeySource::Stop() {
+    handler_ = nullptr;
+}
+
+void SyntheticKeySource::Press(uint16_t modifiers, uint8_t vk) {
+    if (handler_) {
+        handler_(modifiers, vk);
+    }
+}
+
+HotkeyEngine::HotkeyEngine(KeySource& source, ActionSink sink) : source_(source), sink_(std::move(sink)) {
+    std::memset(table_, NO_BINDING, sizeof(table_));
+}
+
+HotkeyEngine::~HotkeyEngine() {
+    Stop();
+}
+
+bool HotkeyEngine::Bind(const HotkeyBinding& binding) {
+    if (running_) {
+        LOG_ERROR("[HotkeyEngine::Bind] Bindings cannot change while the engine is running.");
+        return false;
+    }
+    if (binding.vk == 0 || binding.modifiers >= MODIFIER_COMBINATIONS || binding.action.kind == HotkeyAction::Kind::None) {
+        LOG_ERROR("[HotkeyEngine::Bind] Invalid binding.");
+        return false;
+    }
+
+    uint8_t& slot = table_[binding.modifiers][binding.vk];
+    if (slot != NO_BINDING) {
+        LOG_WARNING("[HotkeyEngine::Bind] Combination bound twice; the later binding wins.");
+        bindings_[slot] = binding;
+        return true;
+    }
+    if (bindings_.size() >= HOTKEY_MAX_BINDINGS) {
+        LOG_ERROR("[HotkeyEngine::Bind] Binding limit of " + std::to_string(HOTKEY_MAX_BINDINGS) + " reached.");
+        return false;
+    }
+
+    slot = static_cast<uint8_t>(bindings_.size());
+    bindings_.push_back(binding);
+    return true;
+}
+
+bool HotkeyEngine::ParseBinding(const std::string& text, HotkeyBinding& binding) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+
+    std::vector<std::string> keys = Split(text.substr(0, equals), '+');
+    HotkeyBinding parsed;
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        if (!ParseModifier(keys[i], parsed.modifiers)) {
+            return false;
+        }
+    }
+    if (parsed.modifiers == 0 || !ParseKey(keys.back(), parsed.vk) ||
+        !ParseAction(text.substr(equals + 1), parsed.action)) {
+        return false;
+    }
+
+    binding = parsed;
+    return true;
+}
+
+bool HotkeyEngine::ParseAction(const std::string& text, HotkeyAction& action) {
+    std::vector<std::string> parts = Split(text, ':');
+    std::string kind = Lower(parts[0]);
+
+    if (kind == "step" && parts.size() == 4 && ParseChannel(parts[1], parts[2], action)) {
+        char* end = nullptr;
+        action.stepDb = std::strtof(parts[3].c_str(), &end);
+        action.kind = HotkeyAction::Kind::VolumeStep;
+        return !parts[3].empty() && *end == '\0' && action.stepDb != 0.0f;
+    }
+    if (kind == "mute" && parts.size() == 3 && ParseChannel(parts[1], parts[2], action)) {
+        action.kind = HotkeyAction::Kind::MuteToggle;
+        return true;
+    }
+    if (kind == "preset" && parts.size() == 2) {
+        char* end = nullptr;
+        long preset = std::strtol(parts[1].c_str(), &end, 10);
+        if (parts[1].empty() || *end != '\0' || preset < 0 || preset >= static_cast<long>(HOTKEY_MAX_PRESETS)) {
+            return false;
+        }
+        action.kind = HotkeyAction::Kind::ApplyPreset;
+        action.preset = static_cast<uint8_t>(preset);
+        return true;
+    }
+    if (kind == "resync" && parts.size() == 1) {
+        action.kind = HotkeyAction::Kind::ForceResync;
+        return true;
+    }
+    if (kind == "sound" && parts.size() == 1) {
+        action.kind = HotkeyAction::Kind::PlaySyncSound;
+        return true;
+    }
+    if (kind == "midi" && parts.size() == 1) {
+        action.kind = HotkeyAction::Kind::ToggleMidi;
+        return true;
+    }
+    return false;
+}
+bool HotkeyEngine::Start() {
+    if (running_) {
+        return true;
+    }
+    if (bindings_.empty()) {
+        LOG_DEBUG("[HotkeyEngine::Start] No bindings configured.");
+        return false;
+    }
+
+    running_ = source_.Start(bindings_, [this](uint16_t modifiers, uint8_t vk) { Dispatch(modifiers, vk); });
+    if (running_) {
+        LOG_INFO("[HotkeyEngine::Start] " + std::to_string(bindings_.size()) + " hotkeys active.");
+    }
+    return running_;
+}
+
+void HotkeyEngine::Stop() {
+    if (running_) {
+        source_.Stop();
+        running_ = false;
+    }
+}
+
+void HotkeyEngine::Dispatch(uint16_t modifiers, uint8_t vk) {
+    uint8_t slot = table_[modifiers & (MODIFIER_COMBINATIONS - 1)][vk];
+    if (slot == NO_BINDING) {
+        return;
+    }
+    dispatched_.fetch_add(1, std::memory_order_relaxed);
+    sink_(bindings_[slot].action);
+}
+
+bool HotkeyEngine::BenchmarkDispatch(uint32_t presses) {
+    using Clock = std::chrono::steady_clock;
+
+    SyntheticKeySource source;
+    uint64_t delivered = 0;
+    HotkeyAction last;
+    HotkeyEngine engine(source, [&delivered, &last](const HotkeyAction& action) {
+        ++delivered;
+        last = action;
+    });
+
+    // A full table, so the lookup is measured at its worst case. Every
+    // binding gets its own step and channel, so a wrong lookup shows.
+    for (size_t i = 0; i < HOTKEY_MAX_BINDINGS; ++i) {
+        HotkeyBinding binding;
+        binding.modifiers = MOD_CONTROL | MOD_ALT;
+        binding.vk = static_cast<uint8_t>(KEY_F1 + i % KEY_F_COUNT);
+        binding.modifiers |= i >= KEY_F_COUNT ? MOD_SHIFT : 0;
+        binding.action.kind = HotkeyAction::Kind::VolumeStep;
+        binding.action.channelIndex = static_cast<uint8_t>(i % KEY_F_COUNT);
+        binding.action.stepDb = static_cast<float>(i + 1);
+        engine.Bind(binding);
+    }
+    engine.Start();
+
+    std::vector<uint32_t> samples;
+    samples.reserve(presses);
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < presses; ++i) {
+        const HotkeyBinding& binding = engine.bindings_[i % engine.bindings_.size()];
+        uint64_t before = delivered;
+        Clock::time_point start = Clock::now();
+        source.Press(binding.modifiers, binding.vk);
+        samples.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+        if (delivered != before + 1 || last.kind != binding.action.kind ||
+            last.channelIndex != binding.action.channelIndex || last.stepDb != binding.action.stepDb) {
+            ++mismatches;
+        }
+    }
+
+    // A combination nobody bound must not reach the sink.
+    uint64_t beforeUnbound = delivered;
+    source.Press(MOD_WIN, KEY_F1);
+    bool unboundIgnored = delivered == beforeUnbound;
+    engine.Stop();
+
+    bool correct = mismatches == 0 && unboundIgnored;
+    if (!correct) {
+        LOG_ERROR("[HotkeyEngine::BenchmarkDispatch] " + std::to_string(mismatches) +
+                  " presses did not dispatch their bound action" +
+                  (unboundIgnored ? "." : "; an unbound combination was dispatched."));
+    }
+    if (samples.empty()) {
+        return correct;
+    }
+    std::sort(samples.begin(), samples.end());
+    uint64_t total = 0;
+    for (uint32_t sample : samples) {
+        total += sample;
+    }
+    LOG_INFO("[HotkeyEngine::BenchmarkDispatch] " + std::to_string(delivered) + " presses dispatched. Mean " +
+             std::to_string(total / samples.size()) + " ns, p50 " + std::to_string(samples[samples.size() / 2]) +
+             " ns, p99 " + std::to_string(samples[samples.size() * 99 / 100]) + " ns, max " +
+             std::to_string(samples.back()) + " ns.");
+    return correct;
+}
@@ -0,0 +1,355 @@
+// LatencyProbe.cpp
+#include "LatencyProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "AudioKernels.h"
+#include "Logger.h"
+
+namespace {
+// Measure(): how long a run may take before the stream is considered stopped
+constexpr uint32_t RUN_TIMEOUT_MS = LATENCY_MAX_MS + 2000;
+constexpr uint32_t POLL_MS = 5;
+
+// Report(): longest histogram bar
+constexpr size_t HISTOGRAM_BAR_WIDTH = 40;
+
+// Benchmark: bus channel 0 comes back on input channel 0 through a delay line
+constexpr uint32_t BENCH_BASE_DELAY_BUFFERS = 3;
+constexpr uint32_t BENCH_DELAY_OFFSET = 37;      // Not a whole number of buffers
+constexpr uint32_t BENCH_JITTER_SAMPLES = 3;     // Delay moves this far either way between runs
+constexpr float BENCH_LOOPBACK_GAIN = 0.5f;      // -6 dB through the converters
+constexpr float BENCH_NOISE_LEVEL = 0.01f;       // -40 dBFS on the input
+constexpr float BENCH_PROGRAM_LEVEL = 0.1f;      // What the buses carry besides the marker
+constexpr size_t BENCH_HISTORY_FRAMES = 8192;    // Power of two above the longest delay plus a buffer
+
+/**
+ * Maximum-length sequence of 255 chips from the 8-bit LFSR x^8 + x^6 + x^5 + x^4 + 1;
+ * its circular autocorrelation is 255 at lag 0 and -1 everywhere else.
+ */
+void GenerateMarker(float* marker) {
+    uint32_t state = 1;
+    for (size_t i = 0; i < 255; ++i) {
+        marker[i] = (state & 1) ? LATENCY_MARKER_LEVEL : -LATENCY_MARKER_LEVEL;
+        uint32_t feedback = (state ^ (state >> 2) ^ (state >> 3) ^ (state >> 4)) & 1;
+        state = (state >> 1) | (feedback << 7);
+    }
+    for (size_t i = 255; i < LATENCY_MARKER_LENGTH; ++i) {
+        marker[i] = 0.0f;
+    }
+}
+}  // namespace
+
+LatencyProbe::LatencyProbe() : capture_(LATENCY_CAPTURE_FRAMES, 0.0f) {
+    GenerateMarker(marker_);
+    markerEnergy_ = AudioKernels::SumSquares(marker_, LATENCY_MARKER_LENGTH);
+}
+
+bool LatencyProbe::ParsePath(const std::string& text, LatencyPath& path) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    std::string output = text.substr(0, colon);
+    std::string input = text.substr(colon + 1);
+    char* end = nullptr;
+    long outputChannel = std::strtol(output.c_str(), &end, 10);
+    if (output.empty() || *end != '\0' || outputChannel < 0 || outputChannel >= static_cast<long>(AUDIO_MAX_BUS_CHANNELS)) {
+        return false;
+    }
+    long inputChannel = std::strtol(input.c_str(), &end, 10);
+    if (input.empty() || *end != '\0' || inputChannel < 0 || inputChannel > 255) {
+        return false;
+    }
+    path.output = static_cast<uint32_t>(outputChannel);
+    path.input = static_cast<uint32_t>(inputChannel);
+    return true;
+}
+
+void LatencyProbe::Prepare(uint32_t sampleRate, uint32_t /*frames*/) {
+    captureFrames_ = (std::min)(static_cast<size_t>(sampleRate) * LATENCY_MAX_MS / 1000 + LATENCY_MARKER_LENGTH,
+                                LATENCY_CAPTURE_FRAMES);
+    // A run cut off by a stream restart starts over on the new stream.
+    uint32_t capturing = CAPTURING;
+    state_.compare_exchange_strong(capturing, ARMED, std::memory_order_relaxed);
+    sampleRate_.store(sampleRate, std::memory_order_relaxed);
+}
+
+void LatencyProbe::Process(const AudioBlock& block) {
+    uint32_t state = state_.load(std::memory_order_acquire);
+    if (state == ARMED) {
+        if (path_.output >= block.outputCount || path_.input >= block.inputCount) {
+            pathMissing_.store(true, std::memory_order_relaxed);
+            captureFill_ = 0;
+            state_.store(DONE, std::memory_order_release);
+            return;
+        }
+        markerPosition_ = 0;
+        captureFill_ = 0;
+        state = CAPTURING;
+        state_.store(CAPTURING, std::memory_order_relaxed);
+    }
+    if (state != CAPTURING) {
+        return;
+    }
+
+    // The output carries the marker, then silence until the capture is full.
+    float* out = block.outputs[path_.output];
+    for (uint32_t i = 0; i < block.frames; ++i) {
+        out[i] = markerPosition_ < LATENCY_MARKER_LENGTH ? marker_[markerPosition_++] : 0.0f;
+    }
+
+    size_t count = (std::min)(static_cast<size_t>(block.frames), captureFrames_ - captureFill_);
+    std::memcpy(&capture_[captureFill_], block.inputs[path_.input], count * sizeof(float));
+    captureFill_ += count;
+    if (captureFill_ == captureFrames_) {
+        state_.store(DONE, std::memory_order_release);
+    }
+}
+
+bool LatencyProbe::Trigger() {
+    if (sampleRate_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    uint32_t idle = IDLE;
+    return state_.compare_exchange_strong(idle, ARMED, std::memory_order_acq_rel);
+}
+
+bool LatencyProbe::Collect(Measurement& measurement) {
+    if (state_.load(std::memory_order_acquire) != DONE) {
+        return false;
+    }
+
+    measurement = Measurement();
+    if (captureFill_ >= LATENCY_MARKER_LENGTH) {
+        const float* samples = capture_.data();
+        size_t lags = captureFill_ - LATENCY_MARKER_LENGTH + 1;
+
+        // Energy of the window under the marker, slid along with it
+        double windowEnergy = AudioKernels::SumSquares(samples, LATENCY_MARKER_LENGTH);
+        double floor = 1e-6 * markerEnergy_;
+        for (size_t lag = 0; lag < lags; ++lag) {
+            if (lag > 0) {
+                double entering = samples[lag + LATENCY_MARKER_LENGTH - 1];
+                double leaving = samples[lag - 1];
+                windowEnergy = (std::max)(0.0, windowEnergy + entering * entering - leaving * leaving);
+            }
+            if (windowEnergy < floor) {
+                continue;
+            }
+            double dot = AudioKernels::DotProduct(samples + lag, marker_, LATENCY_MARKER_LENGTH);
+            if (dot <= 0.0) {
+                continue;
+            }
+            float correlation = static_cast<float>(dot / std::sqrt(markerEnergy_ * windowEnergy));
+            if (correlation > measurement.correlation) {
+                measurement.correlation = correlation;
+                measurement.samples = static_cast<uint32_t>(lag);
+            }
+        }
+        measurement.detected = measurement.correlation >= LATENCY_DETECT_THRESHOLD;
+        uint32_t sampleRate = sampleRate_.load(std::memory_order_relaxed);
+        measurement.ms = sampleRate > 0 ? 1000.0 * measurement.samples / sampleRate : 0.0;
+    }
+
+    state_.store(IDLE, std::memory_order_release);
+    return true;
+}
+
+bool LatencyProbe::Measure(uint32_t runs, std::vector<Measurement>& results) {
+    using Clock = std::chrono::steady_clock;
+    results.reserve(results.size() + runs);
+    for (uint32_t run = 0; run < runs; ++run) {
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(RUN_TIMEOUT_MS);
+        auto waitFor = [deadline](const auto& done) {
+            while (!done()) {
+                if (Clock::now() > deadline) {
+                    LOG_ERROR("[LatencyProbe::Measure] No audio buffers for " + std::to_string(RUN_TIMEOUT_MS) +
+                              " ms. Is the Voicemeeter audio engine running?");
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+            }
+            return true;
+        };
+        Measurement measurement;
+        if (!waitFor([this]() { return Trigger(); }) || !waitFor([&]() { return Collect(measurement); })) {
+            return false;
+        }
+        if (pathMissing_.load(std::memory_order_relaxed)) {
+            LOG_ERROR("[LatencyProbe::Measure] Bus channel " + std::to_string(path_.output) + " or input channel " +
+                      std::to_string(path_.input) + " does not exist in this Voicemeeter edition.");
+            return false;
+        }
+        LOG_DEBUG("[LatencyProbe::Measure] Run " + std::to_string(run + 1) + ": " +
+                  (measurement.detected ? std::to_string(measurement.samples) + " samples, " +
+                                              std::to_string(measurement.ms) + " ms"
+                                        : std::string("not detected")) +
+                  ", correlation " + std::to_string(measurement.correlation) + ".");
+        results.push_back(measurement);
+        std::this_thread::sleep_for(std::chrono::milliseconds(LATENCY_RUN_GAP_MS));
+    }
+    return true;
+}
+
+bool LatencyProbe::Report(const std::vector<Measurement>& results) {
+    std::vector<Measurement> detected;
+    for (const Measurement& measurement : results) {
+        if (measurement.detected) {
+            detected.push_back(measurement);
+        }
+    }
+    if (detected.empty()) {
+        LOG_ERROR("[LatencyProbe::Report] The marker was not detected in any of " + std::to_string(results.size()) +
+                  " runs. Check that the output is looped back to the input and the level reaches it.");
+        return false;
+    }
+
+    std::sort(detected.begin(), detected.end(),
+              [](const Measurement& a, const Measurement& b) { return a.samples < b.samples; });
+    const Measurement& low = detected.front();
+    const Measurement& median = detected[detected.size() / 2];
+    const Measurement& high = detected.back();
+    float weakest = 1.0f;
+    for (const Measurement& measurement : detected) {
+        weakest = (std::min)(weakest, measurement.correlation);
+    }
+    LOG_INFO("[LatencyProbe::Report] Round trip over " + std::to_string(detected.size()) + " of " +
+             std::to_string(results.size()) + " runs: median " + std::to_string(median.samples) + " samples (" +
+             std::to_string(median.ms) + " ms), min " + std::to_string(low.samples) + " (" + std::to_string(low.ms) +
+             " ms), max " + std::to_string(high.samples) + " (" + std::to_string(high.ms) + " ms), jitter " +
+             std::to_string(high.samples - low.samples) + " samples. Weakest correlation " + std::to_string(weakest) +
+             ".");
+
+    // One bin per sample of deviation from the median; the outer bins collect everything beyond.
+    constexpr size_t BINS = 2 * LATENCY_JITTER_RANGE + 1;
+    size_t counts[BINS] = {};
+    for (const Measurement& measurement : detected) {
+        int64_t deviation = static_cast<int64_t>(measurement.samples) - static_cast<int64_t>(median.samples);
+        deviation = (std::max)(static_cast<int64_t>(-LATENCY_JITTER_RANGE),
+                               (std::min)(deviation, static_cast<int64_t>(LATENCY_JITTER_RANGE)));
+        ++counts[deviation + LATENCY_JITTER_RANGE];
+    }
+    size_t tallest = *std::max_element(counts, counts + BINS);
+    for (size_t bin = 0; bin < BINS; ++bin) {
+        if (counts[bin] == 0) {
+            continue;
+        }
+        int32_t deviation = static_cast<int32_t>(bin) - LATENCY_JITTER_RANGE;
+        std::string label = (deviation == -LATENCY_JITTER_RANGE ? "<=" : deviation == LATENCY_JITTER_RANGE ? ">=" : "  ") +
+                            std::string(deviation > 0 ? "+" : "") + std::to_string(deviation);
+        label.insert(0, label.size() < 5 ? 5 - label.size() : 0, ' ');
+        size_t bar = (std::max)(static_cast<size_t>(1), counts[bin] * HISTOGRAM_BAR_WIDTH / tallest);
+        LOG_INFO("[LatencyProbe::Report] " + label + " samples: " + std::string(bar, '#') + " " +
+                 std::to_string(counts[bin]));
+    }
+    return true;
+}
+
+bool LatencyProbe::Benchmark(uint32_t runs) {
+    if (runs < 1 || runs > LATENCY_MAX_RUNS) {
+        LOG_ERROR("[LatencyProbe::Benchmark] Run count must be 1-" + std::to_string(LATENCY_MAX_RUNS) + ".");
+        return false;
+    }
+
+    auto probe = std::make_unique<LatencyProbe>();
+    probe->SetPath(LatencyPath{});
+    AudioInsert insert;
+    insert.AddProcessor(*probe);
+    SyntheticAudioDriver driver(insert, VOICEMEETER_POTATO);
+    uint32_t sampleRate = driver.SampleRate();
+    uint32_t frames = driver.Frames();
+
+    // The loopback reads what bus channel 0 played `delay` samples ago; a delay
+    // of at least one buffer keeps it causal.
+    std::vector<float> history(BENCH_HISTORY_FRAMES, 0.0f);
+    const uint64_t historyMask = BENCH_HISTORY_FRAMES - 1;
+    uint64_t position = 0;
+    uint32_t noise = 1;
+    auto nextNoise = [&noise]() {
+        noise = noise * 1664525u + 1013904223u;
+        return static_cast<float>(noise >> 8) / 8388608.0f - 1.0f;
+    };
+    std::vector<double> callbackMicros;
+    auto runBuffer = [&](uint32_t delay) {
+        float* in = driver.Input(0);
+        for (uint32_t i = 0; i < frames; ++i) {
+            uint64_t now = position + i;
+            float looped = now >= delay ? history[(now - delay) & historyMask] : 0.0f;
+            in[i] = BENCH_LOOPBACK_GAIN * looped + BENCH_NOISE_LEVEL * nextNoise();
+            for (uint32_t c = 0; c < driver.BusChannels(); ++c) {
+                driver.Bus(c)[i] = BENCH_PROGRAM_LEVEL * nextNoise();
+            }
+        }
+        callbackMicros.push_back(driver.RunBuffer());
+        const float* out = driver.Output(0);
+        for (uint32_t i = 0; i < frames; ++i) {
+            history[(position + i) & historyMask] = out[i];
+        }
+        position += frames;
+    };
+
+    uint32_t baseDelay = BENCH_BASE_DELAY_BUFFERS * frames + BENCH_DELAY_OFFSET;
+    uint32_t gapBuffers = static_cast<uint32_t>(static_cast<uint64_t>(LATENCY_RUN_GAP_MS) * sampleRate / 1000 / frames) + 1;
+    uint32_t runBuffers = static_cast<uint32_t>(LATENCY_CAPTURE_FRAMES / frames) + 2;
+    std::vector<Measurement> results;
+    std::vector<double> collectMillis;
+    uint32_t wrong = 0;
+
+    driver.Start();
+    for (uint32_t run = 0; run < runs; ++run) {
+        uint32_t delay = baseDelay - BENCH_JITTER_SAMPLES + (run * 3) % (2 * BENCH_JITTER_SAMPLES + 1);
+        Measurement measurement;
+        bool collected = false;
+        bool triggered = probe->Trigger();
+        for (uint32_t b = 0; triggered && !collected && b < runBuffers; ++b) {
+            runBuffer(delay);
+            auto start = std::chrono::steady_clock::now();
+            collected = probe->Collect(measurement);
+            if (collected) {
+                collectMillis.push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        if (!collected || !measurement.detected || measurement.samples != delay) {
+            LOG_ERROR("[LatencyProbe::Benchmark] Run " + std::to_string(run + 1) + ": loopback delay " +
+                      std::to_string(delay) + " samples, measured " +
+                      (collected && measurement.detected ? std::to_string(measurement.samples) : std::string("nothing")) +
+                      ".");
+            ++wrong;
+        }
+        results.push_back(measurement);
+        for (uint32_t b = 0; b < gapBuffers; ++b) {
+            runBuffer(delay);
+        }
+    }
+    driver.Stop();
+
+    bool reported = Report(results);
+    std::sort(callbackMicros.begin(), callbackMicros.end());
+    std::sort(collectMillis.begin(), collectMillis.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[LatencyProbe::Benchmark] Loopback " + std::to_string(baseDelay) + " +/- " +
+             std::to_string(BENCH_JITTER_SAMPLES) + " samples at " + std::to_string(sampleRate) + " Hz, gain " +
+             std::to_string(BENCH_LOOPBACK_GAIN) + ", noise " + std::to_string(BENCH_NOISE_LEVEL) + ". Callback p50: " +
+             std::to_string(at(callbackMicros, 0.5)) + " us, max: " + std::to_string(at(callbackMicros, 1.0)) +
+             " us. Correlation over " +
+             std::to_string(static_cast<uint64_t>(sampleRate) * LATENCY_MAX_MS / 1000 + LATENCY_MARKER_LENGTH) +
+             " frames p50: " +
+             std::to_string(at(collectMillis, 0.5)) + " ms, max: " + std::to_string(at(collectMillis, 1.0)) + " ms.");
+
+    bool correct = reported && wrong == 0;
+    if (!correct) {
+        LOG_ERROR("[LatencyProbe::Benchmark] " + std::to_string(wrong) + " of " + std::to_string(runs) +
+                  " runs did not measure the loopback delay exactly.");
+    }
+    return correct;
+}
@@ -1,8 +1,12 @@
 #include "Logger.h"
-#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 // Include Defconf.h for color definitions
+#include "AllocationTracker.h"
 #include "Defconf.h"
 
 Logger& Logger::Instance() {
@@ -10,6 +14,7 @@ Logger& Logger::Instance() {
     return instance;
 }
 
+#ifdef _WIN32
 Logger::Logger()
     : logLevel(LogLevel::INFO),
       fileLoggingEnabled(false),
@@ -18,6 +23,10 @@ Logger::Logger()
         std::cerr << "Logger: Failed to obtain console handle." << std::endl;
     }
 }
+#else
+// Other platforms only build the test target; it logs to stdout without colors.
+Logger::Logger() : logLevel(LogLevel::INFO), fileLoggingEnabled(false) {}
+#endif
 
 Logger::~Logger() {
     Shutdown();
@@ -50,6 +59,8 @@ void Logger::Log(LogLevel level, std::string_view message) {
         return;
     }
 
+    AllocationScope allocationScope(AllocationSubsystem::Logger);
+
     // Get current time
     auto now = std::chrono::system_clock::now();
     auto now_time_t = std::chrono::system_clock::to_time_t(now);
@@ -66,18 +77,25 @@ void Logger::Log(LogLevel level, std::string_view message) {
     char time_buffer[64];
     std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", &local_tm);
 
-    // Prepare the log message
-    std::ostringstream logStream;
-    logStream << "[" << time_buffer << "." << std::setfill('0') << std::setw(3)
-              << milliseconds.count() << "] " << LogLevelToString(level) << ": " << message << std::endl;
+    // Prepare the line prefix; the message itself is written as-is
+    char prefix[96];
+    int prefixLength = std::snprintf(prefix, sizeof(prefix), "[%s.%03d] %s: ", time_buffer,
+                                     static_cast<int>(milliseconds.count()), LogLevelToString(level));
+    if (prefixLength < 0) {
+        return;
+    }
+    prefixLength = (std::min)(prefixLength, static_cast<int>(sizeof(prefix)) - 1);
 
-    std::string finalLog = logStream.str();
+    std::lock_guard<ProfiledMutex> lock(writeMutex_);
 
     // Output the log message with colorization
     if (fileLoggingEnabled && logFile.is_open()) {
-        logFile << finalLog;
+        logFile.write(prefix, prefixLength);
+        logFile.write(message.data(), static_cast<std::streamsize>(message.size()));
+        logFile.put('\n');
         logFile.flush(); // Ensure the message is written immediately
     } else {
+#ifdef _WIN32
         // Set console text color based on log level
         WORD originalAttributes;
         CONSOLE_SCREEN_BUFFER_INFO csbi;
@@ -89,12 +107,18 @@ void Logger::Log(LogLevel level, std::string_view message) {
 
         // Set color
         SetConsoleTextAttribute(consoleHandle.get(), GetColorForLogLevel(level));
+#endif
 
         // Write to console
-        std::cout << finalLog;
+        std::cout.write(prefix, prefixLength);
+        std::cout.write(message.data(), static_cast<std::streamsize>(message.size()));
+        std::cout.put('\n');
+        std::cout.flush();
 
+#ifdef _WIN32
         // Reset to original color
         SetConsoleTextAttribute(consoleHandle.get(), originalAttributes);
+#endif
     }
 }
 
@@ -108,6 +132,7 @@ constexpr const char* Logger::LogLevelToString(LogLevel level) const {
     }
 }
 
+#ifdef _WIN32
 WORD Logger::GetColorForLogLevel(LogLevel level) const {
     switch (level) {
         case LogLevel::DEBUG:
@@ -122,3 +147,4 @@ WORD Logger::GetColorForLogLevel(LogLevel level) const {
             return FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE; // Default to white
     }
 }
+#endif
@@ -0,0 +1,311 @@
+// LoudnessMeter.cpp
+#include "LoudnessMeter.h"
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "AudioKernels.h"
+#include "Metrics.h"
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+
+// BS.1770-4 K-weighting: high shelf, then high-pass; the analog prototypes
+// are re-derived for the stream's sample rate
+constexpr double SHELF_HZ = 1681.974450955533;
+constexpr double SHELF_GAIN_DB = 3.999843853973347;
+constexpr double SHELF_Q = 0.7071752369554196;
+constexpr double SHELF_BAND_EXPONENT = 0.4996667741545416;
+constexpr double HIGH_PASS_HZ = 38.13547087602444;
+constexpr double HIGH_PASS_Q = 0.5003270373238773;
+
+// Offset that puts a 0 dBFS 1 kHz sine on one channel at -3.01 LUFS
+constexpr double LUFS_OFFSET = -0.691;
+
+// Channel weights in 7.1 order: L, R, C, LFE, side and back surrounds
+constexpr float CHANNEL_WEIGHTS[AUDIO_CHANNELS_PER_BUS] = {1.0f, 1.0f, 1.0f, 0.0f, 1.41f, 1.41f, 1.41f, 1.41f};
+
+constexpr const char* BUS_LABELS[AUDIO_MAX_BUSES] = {"0", "1", "2", "3", "4", "5", "6", "7"};
+
+struct LoudnessMetrics {
+    Metric* momentary[AUDIO_MAX_BUSES] = {};
+    Metric* shortTerm[AUDIO_MAX_BUSES] = {};
+    Metric* integrated[AUDIO_MAX_BUSES] = {};
+};
+LoudnessMetrics loudnessMetrics;
+std::atomic<bool> metricsRegistered{false};
+
+inline __m128 RunBiquad(__m128 x, __m128& z1, __m128& z2, const __m128* c) {
+    // Transposed direct form II; c holds b0, b1, b2, a1, a2
+    __m128 y = _mm_add_ps(_mm_mul_ps(c[0], x), z1);
+    z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(c[1], x), _mm_mul_ps(c[3], y)), z2);
+    z2 = _mm_sub_ps(_mm_mul_ps(c[2], x), _mm_mul_ps(c[4], y));
+    return y;
+}
+}  // namespace
+
+LoudnessMeter& LoudnessMeter::Instance() {
+    static LoudnessMeter instance;
+    return instance;
+}
+
+LoudnessMeter::LoudnessMeter() = default;
+
+void LoudnessMeter::Prepare(uint32_t sampleRate, uint32_t /*frames*/) {
+    double rate = static_cast<double>(sampleRate);
+
+    double k = std::tan(PI * SHELF_HZ / rate);
+    double vh = std::pow(10.0, SHELF_GAIN_DB / 20.0);
+    double vb = std::pow(vh, SHELF_BAND_EXPONENT);
+    double a0 = 1.0 + k / SHELF_Q + k * k;
+    shelf_.b0 = static_cast<float>((vh + vb * k / SHELF_Q + k * k) / a0);
+    shelf_.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+    shelf_.b2 = static_cast<float>((vh - vb * k / SHELF_Q + k * k) / a0);
+    shelf_.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    shelf_.a2 = static_cast<float>((1.0 - k / SHELF_Q + k * k) / a0);
+
+    k = std::tan(PI * HIGH_PASS_HZ / rate);
+    a0 = 1.0 + k / HIGH_PASS_Q + k * k;
+    highPass_.b0 = 1.0f;
+    highPass_.b1 = -2.0f;
+    highPass_.b2 = 1.0f;
+    highPass_.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    highPass_.a2 = static_cast<float>((1.0 - k / HIGH_PASS_Q + k * k) / a0);
+
+    std::memset(state_, 0, sizeof(state_));
+    std::memset(channelEnergy_, 0, sizeof(channelEnergy_));
+    std::memset(stepEnergy_, 0, sizeof(stepEnergy_));
+    stepFrames_ = (std::max)(1u, static_cast<uint32_t>(std::lround(rate / LOUDNESS_STEPS_PER_SECOND)));
+    stepFill_ = 0;
+    stepHead_ = 0;
+    stepCount_ = 0;
+    steps_ = 0;
+    ClearGating();
+}
+
+void LoudnessMeter::Process(const AudioBlock& block) {
+    if (stepFrames_ == 0) {
+        return;
+    }
+    // Whole buses only; every edition has 8 channels per bus.
+    busCount_ = (std::min)(block.outputCount / static_cast<uint32_t>(AUDIO_CHANNELS_PER_BUS),
+                           static_cast<uint32_t>(AUDIO_MAX_BUSES));
+    uint32_t channels = busCount_ * static_cast<uint32_t>(AUDIO_CHANNELS_PER_BUS);
+
+    // Buffers rarely line up with steps; split them at step boundaries.
+    uint32_t offset = 0;
+    while (offset < block.frames) {
+        uint32_t frames = (std::min)(block.frames - offset, stepFrames_ - stepFill_);
+        Filter(block, channels, offset, frames);
+        offset += frames;
+        stepFill_ += frames;
+        if (stepFill_ == stepFrames_) {
+            FinishStep();
+        }
+    }
+}
+
+void LoudnessMeter::Filter(const AudioBlock& block, uint32_t channels, uint32_t offset, uint32_t frames) {
+    const __m128 shelf[5] = {_mm_set1_ps(shelf_.b0), _mm_set1_ps(shelf_.b1), _mm_set1_ps(shelf_.b2),
+                             _mm_set1_ps(shelf_.a1), _mm_set1_ps(shelf_.a2)};
+    const __m128 highPass[5] = {_mm_set1_ps(highPass_.b0), _mm_set1_ps(highPass_.b1), _mm_set1_ps(highPass_.b2),
+                                _mm_set1_ps(highPass_.a1), _mm_set1_ps(highPass_.a2)};
+
+    // Four channels per vector; samples are loaded four at a time per
+    // channel and transposed, so each vector holds one instant of the group.
+    // The filter is recursive across instants and stays here; its output is
+    // transposed back into filtered_ and summed by the shared kernels.
+    for (uint32_t first = 0; first < channels; first += 4) {
+        __m128 s1 = _mm_load_ps(&state_[0][first]);
+        __m128 s2 = _mm_load_ps(&state_[1][first]);
+        __m128 h1 = _mm_load_ps(&state_[2][first]);
+        __m128 h2 = _mm_load_ps(&state_[3][first]);
+
+        for (uint32_t chunk = 0; chunk < frames; chunk += LOUDNESS_FILTER_CHUNK_FRAMES) {
+            uint32_t count = (std::min)(frames - chunk, LOUDNESS_FILTER_CHUNK_FRAMES);
+            const float* in0 = block.outputs[first] + offset + chunk;
+            const float* in1 = block.outputs[first + 1] + offset + chunk;
+            const float* in2 = block.outputs[first + 2] + offset + chunk;
+            const float* in3 = block.outputs[first + 3] + offset + chunk;
+
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x0 = _mm_loadu_ps(in0 + i);
+                __m128 x1 = _mm_loadu_ps(in1 + i);
+                __m128 x2 = _mm_loadu_ps(in2 + i);
+                __m128 x3 = _mm_loadu_ps(in3 + i);
+                _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+
+                __m128 y0 = RunBiquad(RunBiquad(x0, s1, s2, shelf), h1, h2, highPass);
+                __m128 y1 = RunBiquad(RunBiquad(x1, s1, s2, shelf), h1, h2, highPass);
+                __m128 y2 = RunBiquad(RunBiquad(x2, s1, s2, shelf), h1, h2, highPass);
+                __m128 y3 = RunBiquad(RunBiquad(x3, s1, s2, shelf), h1, h2, highPass);
+                _MM_TRANSPOSE4_PS(y0, y1, y2, y3);
+                _mm_store_ps(&filtered_[0][i], y0);
+                _mm_store_ps(&filtered_[1][i], y1);
+                _mm_store_ps(&filtered_[2][i], y2);
+                _mm_store_ps(&filtered_[3][i], y3);
+            }
+            for (; i < count; ++i) {
+                __m128 x = _mm_setr_ps(in0[i], in1[i], in2[i], in3[i]);
+                alignas(16) float y[4];
+                _mm_store_ps(y, RunBiquad(RunBiquad(x, s1, s2, shelf), h1, h2, highPass));
+                for (uint32_t lane = 0; lane < 4; ++lane) {
+                    filtered_[lane][i] = y[lane];
+                }
+            }
+
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                channelEnergy_[first + lane] += AudioKernels::SumSquares(filtered_[lane], count);
+            }
+        }
+
+        _mm_store_ps(&state_[0][first], s1);
+        _mm_store_ps(&state_[1][first], s2);
+        _mm_store_ps(&state_[2][first], h1);
+        _mm_store_ps(&state_[3][first], h2);
+    }
+}
+
+void LoudnessMeter::FinishStep() {
+    if (resetRequested_.exchange(false, std::memory_order_relaxed)) {
+        // A one-off 72 KB clear; cheap next to a step of filtering.
+        ClearGating();
+        steps_ = 0;
+    }
+
+    for (size_t bus = 0; bus < busCount_; ++bus) {
+        double energy = 0.0;
+        for (size_t c = 0; c < AUDIO_CHANNELS_PER_BUS; ++c) {
+            energy += CHANNEL_WEIGHTS[c] * channelEnergy_[bus * AUDIO_CHANNELS_PER_BUS + c];
+        }
+        stepEnergy_[bus][stepHead_] = energy / stepFrames_;
+    }
+    std::memset(channelEnergy_, 0, sizeof(channelEnergy_));
+    stepFill_ = 0;
+    stepHead_ = (stepHead_ + 1) % LOUDNESS_SHORT_TERM_STEPS;
+    stepCount_ = (std::min)(stepCount_ + 1, LOUDNESS_SHORT_TERM_STEPS);
+    ++steps_;
+
+    LoudnessReading& reading = readings_.WriteBuffer();
+    reading.busCount = busCount_;
+    reading.steps = steps_;
+    for (size_t bus = 0; bus < busCount_; ++bus) {
+        double momentary = StepMean(bus, (std::min)(stepCount_, LOUDNESS_MOMENTARY_STEPS));
+        float momentaryLufs = ToLufs(momentary);
+
+        // Every step closes a 400 ms gating block, overlapping the last by 75 %.
+        if (stepCount_ >= LOUDNESS_MOMENTARY_STEPS && momentaryLufs > LOUDNESS_ABSOLUTE_GATE_LUFS) {
+            size_t bin = (std::min)(static_cast<size_t>((momentaryLufs - LOUDNESS_ABSOLUTE_GATE_LUFS) /
+                                                        LOUDNESS_HISTOGRAM_STEP_LU),
+                                    LOUDNESS_HISTOGRAM_BINS - 1);
+            ++blockCounts_[bus][bin];
+            blockEnergy_[bus][bin] += momentary;
+            ++gatedCount_[bus];
+            gatedEnergy_[bus] += momentary;
+        }
+
+        reading.momentaryLufs[bus] = momentaryLufs;
+        reading.shortTermLufs[bus] = ToLufs(StepMean(bus, stepCount_));
+        reading.integratedLufs[bus] = Integrated(bus);
+    }
+    readings_.Publish();
+}
+
+void LoudnessMeter::ClearGating() {
+    std::memset(blockCounts_, 0, sizeof(blockCounts_));
+    std::memset(blockEnergy_, 0, sizeof(blockEnergy_));
+    std::memset(gatedCount_, 0, sizeof(gatedCount_));
+    std::memset(gatedEnergy_, 0, sizeof(gatedEnergy_));
+}
+
+double LoudnessMeter::StepMean(size_t bus, size_t steps) const {
+    if (steps == 0) {
+        return 0.0;
+    }
+    double energy = 0.0;
+    size_t index = stepHead_;
+    for (size_t i = 0; i < steps; ++i) {
+        index = (index + LOUDNESS_SHORT_TERM_STEPS - 1) % LOUDNESS_SHORT_TERM_STEPS;
+        energy += stepEnergy_[bus][index];
+    }
+    return energy / static_cast<double>(steps);
+}
+
+float LoudnessMeter::Integrated(size_t bus) const {
+    if (gatedCount_[bus] == 0) {
+        return LOUDNESS_FLOOR_LUFS;
+    }
+    // Relative gate 10 LU under the loudness of every block above the absolute gate
+    float gate = ToLufs(gatedEnergy_[bus] / static_cast<double>(gatedCount_[bus])) + LOUDNESS_RELATIVE_GATE_LU;
+    size_t first = 0;
+    if (gate > LOUDNESS_ABSOLUTE_GATE_LUFS) {
+        first = (std::min)(static_cast<size_t>((gate - LOUDNESS_ABSOLUTE_GATE_LUFS) / LOUDNESS_HISTOGRAM_STEP_LU),
+                           LOUDNESS_HISTOGRAM_BINS - 1);
+    }
+
+    uint64_t count = 0;
+    double energy = 0.0;
+    for (size_t bin = first; bin < LOUDNESS_HISTOGRAM_BINS; ++bin) {
+        count += blockCounts_[bus][bin];
+        energy += blockEnergy_[bus][bin];
+    }
+    return count == 0 ? LOUDNESS_FLOOR_LUFS : ToLufs(energy / static_cast<double>(count));
+}
+
+float LoudnessMeter::ToLufs(double energy) {
+    if (energy <= 0.0) {
+        return LOUDNESS_FLOOR_LUFS;
+    }
+    return (std::max)(LOUDNESS_FLOOR_LUFS, static_cast<float>(LUFS_OFFSET + 10.0 * std::log10(energy)));
+}
+
+bool LoudnessMeter::Read(LoudnessReading& reading) {
+    std::lock_guard<ProfiledMutex> lock(readMutex_);
+    const LoudnessReading* latest = readings_.Read();
+    if (!latest) {
+        return false;
+    }
+    reading = *latest;
+    return true;
+}
+
+void LoudnessMeter::RegisterMetrics() {
+    if (metricsRegistered.exchange(true)) {
+        return;
+    }
+
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    LoudnessMetrics& m = loudnessMetrics;
+    for (size_t bus = 0; bus < AUDIO_MAX_BUSES; ++bus) {
+        m.momentary[bus] = registry.Gauge("voicemirror_loudness_momentary_lufs",
+                                          "EBU R128 momentary loudness (400 ms) per bus.", "bus", BUS_LABELS[bus]);
+        m.shortTerm[bus] = registry.Gauge("voicemirror_loudness_short_term_lufs",
+                                          "EBU R128 short-term loudness (3 s) per bus.", "bus", BUS_LABELS[bus]);
+        m.integrated[bus] = registry.Gauge("voicemirror_loudness_integrated_lufs",
+                                           "EBU R128 integrated loudness per bus.", "bus", BUS_LABELS[bus]);
+    }
+
+    registry.AddCollector([]() {
+        LoudnessReading reading;
+        if (!LoudnessMeter::Instance().Read(reading)) {
+            return;
+        }
+        LoudnessMetrics& m = loudnessMetrics;
+        for (size_t bus = 0; bus < reading.busCount; ++bus) {
+            if (m.momentary[bus]) {
+                m.momentary[bus]->Set(reading.momentaryLufs[bus]);
+            }
+            if (m.shortTerm[bus]) {
+                m.shortTerm[bus]->Set(reading.shortTermLufs[bus]);
+            }
+            if (m.integrated[bus]) {
+                m.integrated[bus]->Set(reading.integratedLufs[bus]);
+            }
+        }
+    });
+}
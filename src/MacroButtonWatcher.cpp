@@ -0,0 +1,212 @@
+// MacroButtonWatcher.cpp
+#include "MacroButtonWatcher.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+#include "VoicemeeterManager.h"
+
+namespace {
+// Actions whose target follows the button state instead of running on press.
+bool IsLatching(HotkeyAction::Kind kind) {
+    return kind == HotkeyAction::Kind::MuteToggle || kind == HotkeyAction::Kind::ToggleMidi;
+}
+}  // namespace
+
+MacroButtonWatcher::MacroButtonWatcher(VoicemeeterManager& manager, ActionSink sink)
+    : manager_(manager), sink_(std::move(sink)) {
+    std::memset(slots_, NO_BINDING, sizeof(slots_));
+}
+
+MacroButtonWatcher::~MacroButtonWatcher() {
+    Stop();
+}
+
+bool MacroButtonWatcher::Bind(const MacroButtonBinding& binding) {
+    if (running_) {
+        LOG_ERROR("[MacroButtonWatcher::Bind] Bindings cannot change while the watcher is running.");
+        return false;
+    }
+    if (binding.button >= MACRO_BUTTON_COUNT || binding.action.kind == HotkeyAction::Kind::None) {
+        LOG_ERROR("[MacroButtonWatcher::Bind] Invalid binding.");
+        return false;
+    }
+
+    std::string parameter;
+    if (binding.action.kind == HotkeyAction::Kind::MuteToggle) {
+        parameter = std::string(binding.action.channelType == ChannelType::Input ? "Strip[" : "Bus[") +
+                    std::to_string(binding.action.channelIndex) + "].Mute";
+    }
+
+    uint8_t& slot = slots_[binding.button];
+    if (slot != NO_BINDING) {
+        LOG_WARNING("[MacroButtonWatcher::Bind] Button " + std::to_string(binding.button) + " bound twice; the later binding wins.");
+        bindings_[slot] = binding;
+        parameters_[slot] = parameter;
+        return true;
+    }
+    if (bindings_.size() >= MACRO_MAX_BINDINGS) {
+        LOG_ERROR("[MacroButtonWatcher::Bind] Binding limit of " + std::to_string(MACRO_MAX_BINDINGS) + " reached.");
+        return false;
+    }
+
+    slot = static_cast<uint8_t>(bindings_.size());
+    bindings_.push_back(binding);
+    parameters_.push_back(parameter);
+    settleCycles_.push_back(0);
+    watched_.set(binding.button);
+    return true;
+}
+
+bool MacroButtonWatcher::ParseBinding(const std::string& text, MacroButtonBinding& binding) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        return false;
+    }
+
+    std::string button = text.substr(0, equals);
+    char* end = nullptr;
+    long index = std::strtol(button.c_str(), &end, 10);
+    if (*end != '\0' || index < 0 || index >= static_cast<long>(MACRO_BUTTON_COUNT)) {
+        return false;
+    }
+
+    MacroButtonBinding parsed;
+    parsed.button = static_cast<uint8_t>(index);
+    if (!HotkeyEngine::ParseAction(text.substr(equals + 1), parsed.action)) {
+        return false;
+    }
+
+    binding = parsed;
+    return true;
+}
+
+bool MacroButtonWatcher::Start() {
+    if (running_) {
+        return true;
+    }
+    if (bindings_.empty()) {
+        LOG_DEBUG("[MacroButtonWatcher::Start] No bindings configured.");
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MacroButtonWatcher::ThreadProc, this);
+    LOG_INFO("[MacroButtonWatcher::Start] " + std::to_string(bindings_.size()) + " MacroButtons bound.");
+    return true;
+}
+
+void MacroButtonWatcher::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    // A cycle that outlived its deadline may still be queued on the executor.
+    manager_.WaitForQueuedCommands();
+}
+
+void MacroButtonWatcher::ThreadProc() {
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::milliseconds interval(MACRO_POLL_INTERVAL_MS);
+
+    std::vector<Edge> edges;
+    edges.reserve(MACRO_MAX_BINDINGS);
+
+    Clock::time_point nextCycle = Clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        manager_.RunMacroButtonCycle(*this);
+
+        // Actions may wait on the executor, so they run here rather than inside the cycle.
+        edges.clear();
+        {
+            std::lock_guard<ProfiledMutex> lock(edgesMutex_);
+            edges.swap(edges_);
+        }
+        for (const Edge& edge : edges) {
+            sink_(bindings_[edge.binding].action, edge.on);
+        }
+
+        nextCycle += interval;
+        Clock::time_point now = Clock::now();
+        if (nextCycle < now) {
+            nextCycle = now + interval;  // Fell behind; do not burst to catch up.
+        }
+        std::this_thread::sleep_until(nextCycle);
+    }
+}
+
+void MacroButtonWatcher::Process(const MacroButtonBits* buttons, const float* values) {
+    writeMask_.reset();
+
+    if (buttons) {
+        MacroButtonBits changed = buttonsKnown_ ? (*buttons ^ state_) & watched_ : MacroButtonBits();
+        if (changed.any()) {
+            std::lock_guard<ProfiledMutex> lock(edgesMutex_);
+            for (size_t button = 0; button < MACRO_BUTTON_COUNT; ++button) {
+                if (!changed.test(button)) {
+                    continue;
+                }
+                uint8_t slot = slots_[button];
+                const HotkeyAction& action = bindings_[slot].action;
+                bool on = buttons->test(button);
+                if (IsLatching(action.kind)) {
+                    settleCycles_[slot] = MACRO_SETTLE_CYCLES;
+                } else if (!on) {
+                    continue;
+                } else if (action.kind == HotkeyAction::Kind::ApplyPreset) {
+                    selectedPreset_ = action.preset;
+                }
+                edges_.push_back({slot, on});
+            }
+        }
+        // The first read is the baseline; buttons already on do not fire.
+        state_ = *buttons;
+        buttonsKnown_ = true;
+    }
+
+    if (buttonsKnown_) {
+        UpdateLitStates(values);
+    }
+}
+
+void MacroButtonWatcher::UpdateLitStates(const float* values) {
+    for (size_t slot = 0; slot < bindings_.size(); ++slot) {
+        const MacroButtonBinding& binding = bindings_[slot];
+        bool lit = false;
+
+        if (binding.action.kind == HotkeyAction::Kind::MuteToggle) {
+            if (std::isnan(values[slot])) {
+                continue;
+            }
+            lit = values[slot] != 0.0f;
+            if (settleCycles_[slot] > 0) {
+                // Give a pressed button's mute time to follow before correcting it.
+                if (lit == state_.test(binding.button)) {
+                    settleCycles_[slot] = 0;
+                } else {
+                    --settleCycles_[slot];
+                }
+                continue;
+            }
+        } else if (binding.action.kind == HotkeyAction::Kind::ApplyPreset) {
+            if (selectedPreset_ < 0) {
+                continue;
+            }
+            lit = binding.action.preset == selectedPreset_;
+        } else {
+            continue;
+        }
+
+        if (state_.test(binding.button) != lit) {
+            writeMask_.set(binding.button);
+            writeValues_.set(binding.button, lit);
+            // Reading the pushed state back must not count as a press.
+            state_.set(binding.button, lit);
+        }
+    }
+}
@@ -0,0 +1,286 @@
+// Metrics.cpp
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "Logger.h"
+
+namespace {
+bool SameLabel(const char* a, const char* b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return std::strcmp(a, b) == 0;
+}
+
+// Appends to a fixed buffer; once something does not fit, everything after it is dropped.
+class TextWriter {
+public:
+    TextWriter(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    void Append(const char* text, size_t size) {
+        if (overflow_ || size > capacity_ - length_) {
+            overflow_ = true;
+            return;
+        }
+        std::memcpy(buffer_ + length_, text, size);
+        length_ += size;
+    }
+
+    void Append(const char* text) { Append(text, std::strlen(text)); }
+    void Append(char c) { Append(&c, 1); }
+
+    void AppendValue(double value) {
+        char text[32];
+        int size;
+        if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e15) {
+            size = std::snprintf(text, sizeof(text), "%.0f", value);
+        } else {
+            size = std::snprintf(text, sizeof(text), "%.9g", value);
+        }
+        Append(text, static_cast<size_t>(size));
+    }
+
+    // name{label="value",extra="extraValue"}, leaving out whatever is null
+    void AppendSeries(const char* name, const char* suffix, const char* labelName, const char* labelValue,
+                      const char* extraName = nullptr, const char* extraValue = nullptr) {
+        Append(name);
+        if (suffix) {
+            Append(suffix);
+        }
+        if (!labelName && !extraName) {
+            return;
+        }
+        Append('{');
+        if (labelName) {
+            AppendLabel(labelName, labelValue);
+        }
+        if (extraName) {
+            if (labelName) {
+                Append(',');
+            }
+            AppendLabel(extraName, extraValue);
+        }
+        Append('}');
+    }
+
+    void AppendHeader(const char* name, const char* help, const char* type) {
+        Append("# HELP ");
+        Append(name);
+        Append(' ');
+        Append(help);
+        Append("\n# TYPE ");
+        Append(name);
+        Append(' ');
+        Append(type);
+        Append('\n');
+    }
+
+    size_t Length() const { return length_; }
+    bool Overflowed() const { return overflow_; }
+
+private:
+    void AppendLabel(const char* name, const char* value) {
+        Append(name);
+        Append("=\"");
+        Append(value);
+        Append('"');
+    }
+
+    char* buffer_;
+    size_t capacity_;
+    size_t length_ = 0;
+    bool overflow_ = false;
+};
+}  // namespace
+
+void Histogram::Observe(double value) {
+    // Few buckets: a linear scan beats a binary search.
+    size_t bucket = 0;
+    while (bucket < boundCount_ && value > bounds_[bucket]) {
+        ++bucket;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    double previous = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(previous, previous + value, std::memory_order_relaxed)) {
+    }
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+Metric* MetricsRegistry::Register(const char* name, const char* help, Metric::Type type,
+                                  const char* labelName, const char* labelValue) {
+    std::lock_guard<std::mutex> lock(registerMutex_);
+
+    size_t count = count_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        Metric& metric = metrics_[i];
+        if (std::strcmp(metric.name_, name) == 0 &&
+            SameLabel(metric.labelName_, labelName) && SameLabel(metric.labelValue_, labelValue)) {
+            return &metric;
+        }
+    }
+
+    if (count == METRICS_MAX_COUNT) {
+        LOG_WARNING(std::string("[MetricsRegistry::Register] Metric table full, dropping ") + name);
+        return nullptr;
+    }
+
+    Metric& metric = metrics_[count];
+    metric.name_ = name;
+    metric.help_ = help;
+    metric.type_ = type;
+    metric.labelName_ = labelName;
+    metric.labelValue_ = labelValue;
+    count_.store(count + 1, std::memory_order_release);
+    return &metric;
+}
+
+Histogram* MetricsRegistry::RegisterHistogram(const char* name, const char* help, const double* bounds, size_t boundCount,
+                                              const char* labelName, const char* labelValue) {
+    if (boundCount == 0 || boundCount > METRICS_MAX_BUCKETS || !std::is_sorted(bounds, bounds + boundCount)) {
+        LOG_WARNING(std::string("[MetricsRegistry::RegisterHistogram] Invalid bucket bounds for ") + name);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(registerMutex_);
+
+    size_t count = histogramCount_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        Histogram& histogram = histograms_[i];
+        if (std::strcmp(histogram.name_, name) == 0 &&
+            SameLabel(histogram.labelName_, labelName) && SameLabel(histogram.labelValue_, labelValue)) {
+            return &histogram;
+        }
+    }
+
+    if (count == METRICS_MAX_HISTOGRAMS) {
+        LOG_WARNING(std::string("[MetricsRegistry::RegisterHistogram] Histogram table full, dropping ") + name);
+        return nullptr;
+    }
+
+    Histogram& histogram = histograms_[count];
+    histogram.name_ = name;
+    histogram.help_ = help;
+    histogram.labelName_ = labelName;
+    histogram.labelValue_ = labelValue;
+    histogram.bounds_ = bounds;
+    histogram.boundCount_ = boundCount;
+    histogramCount_.store(count + 1, std::memory_order_release);
+    return &histogram;
+}
+
+bool MetricsRegistry::AddCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(collectMutex_);
+    if (collectorCount_ == METRICS_MAX_COLLECTORS) {
+        LOG_WARNING("[MetricsRegistry::AddCollector] Collector table full.");
+        return false;
+    }
+    collectors_[collectorCount_++] = std::move(collector);
+    return true;
+}
+
+void MetricsRegistry::Collect() {
+    std::lock_guard<std::mutex> lock(collectMutex_);
+    for (size_t i = 0; i < collectorCount_; ++i) {
+        collectors_[i]();
+    }
+}
+
+std::string MetricsRegistry::RenderText() {
+    std::string out(METRICS_RENDER_BUFFER_BYTES, '\0');
+    size_t length = 0;
+    if (!RenderText(&out[0], out.size(), length)) {
+        LOG_WARNING("[MetricsRegistry::RenderText] Metrics exceed " + std::to_string(METRICS_RENDER_BUFFER_BYTES) +
+                    " bytes; output truncated.");
+    }
+    out.resize(length);
+    return out;
+}
+
+bool MetricsRegistry::RenderText(char* buffer, size_t capacity, size_t& length) {
+    Collect();
+
+    TextWriter out(buffer, capacity);
+    size_t count = count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        const Metric& first = metrics_[i];
+
+        // Each family is rendered once, at its first registered member.
+        bool rendered = false;
+        for (size_t j = 0; j < i && !rendered; ++j) {
+            rendered = std::strcmp(metrics_[j].name_, first.name_) == 0;
+        }
+        if (rendered) {
+            continue;
+        }
+
+        out.AppendHeader(first.name_, first.help_, first.type_ == Metric::Type::Counter ? "counter" : "gauge");
+        for (size_t j = i; j < count; ++j) {
+            const Metric& metric = metrics_[j];
+            if (std::strcmp(metric.name_, first.name_) != 0) {
+                continue;
+            }
+            out.AppendSeries(metric.name_, nullptr, metric.labelName_, metric.labelValue_);
+            out.Append(' ');
+            out.AppendValue(metric.Value());
+            out.Append('\n');
+        }
+    }
+
+    size_t histogramCount = histogramCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < histogramCount; ++i) {
+        const Histogram& first = histograms_[i];
+
+        bool rendered = false;
+        for (size_t j = 0; j < i && !rendered; ++j) {
+            rendered = std::strcmp(histograms_[j].name_, first.name_) == 0;
+        }
+        if (rendered) {
+            continue;
+        }
+
+        out.AppendHeader(first.name_, first.help_, "histogram");
+        for (size_t j = i; j < histogramCount; ++j) {
+            const Histogram& histogram = histograms_[j];
+            if (std::strcmp(histogram.name_, first.name_) != 0) {
+                continue;
+            }
+
+            // The count is the sum of the buckets read, so the series stay consistent
+            // with each other while observations race the scrape.
+            uint64_t cumulative = 0;
+            char bound[32];
+            for (size_t b = 0; b <= histogram.boundCount_; ++b) {
+                cumulative += histogram.buckets_[b].load(std::memory_order_relaxed);
+                if (b < histogram.boundCount_) {
+                    std::snprintf(bound, sizeof(bound), "%.9g", histogram.bounds_[b]);
+                } else {
+                    std::memcpy(bound, "+Inf", 5);
+                }
+                out.AppendSeries(histogram.name_, "_bucket", histogram.labelName_, histogram.labelValue_, "le", bound);
+                out.Append(' ');
+                out.AppendValue(static_cast<double>(cumulative));
+                out.Append('\n');
+            }
+            out.AppendSeries(histogram.name_, "_sum", histogram.labelName_, histogram.labelValue_);
+            out.Append(' ');
+            out.AppendValue(histogram.sum_.load(std::memory_order_relaxed));
+            out.Append('\n');
+            out.AppendSeries(histogram.name_, "_count", histogram.labelName_, histogram.labelValue_);
+            out.Append(' ');
+            out.AppendValue(static_cast<double>(cumulative));
+            out.Append('\n');
+        }
+    }
+
+    length = out.Length();
+    return !out.Overflowed();
+}
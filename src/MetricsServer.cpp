@@ -0,0 +1,389 @@
+// MetricsServer.cpp
+// Winsock 2 has to come before windows.h, which pulls in the old winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "MetricsServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#include "AllocationTracker.h"
+#include "FootprintReporter.h"
+#include "Logger.h"
+#include "VolumeHistory.h"
+
+namespace {
+constexpr char CONTENT_TYPE[] = "text/plain; version=0.0.4; charset=utf-8";
+constexpr char METRICS_PATH[] = "/metrics";
+constexpr char HISTORY_PATH[] = "/history";
+
+// Scrapes allowed to allocate before the allocation check counts them (first use of collector statics)
+constexpr uint64_t ALLOCATION_WARMUP_SCRAPES = 2;
+
+bool StartsWith(const char* text, size_t length, const char* prefix) {
+    size_t prefixLength = std::strlen(prefix);
+    return length >= prefixLength && std::memcmp(text, prefix, prefixLength) == 0;
+}
+
+bool SendAll(SOCKET socket, const char* data, size_t length) {
+    while (length > 0) {
+        int sent = send(socket, data, static_cast<int>(length), 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void SetTimeouts(SOCKET socket) {
+    DWORD timeout = METRICS_HTTP_TIMEOUT_MS;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+// Checks the status line and that Content-Length matches the body received.
+bool CheckResponse(const char* response, size_t length, const char* status, const char*& body) {
+    std::string statusLine = std::string("HTTP/1.1 ") + status + "\r\n";
+    const char* headerEnd = std::strstr(response, "\r\n\r\n");
+    const char* contentLength = std::strstr(response, "Content-Length: ");
+    if (!StartsWith(response, length, statusLine.c_str()) || !headerEnd || !contentLength || contentLength > headerEnd) {
+        return false;
+    }
+    body = headerEnd + 4;
+    unsigned long expected = std::strtoul(contentLength + 16, nullptr, 10);
+    return expected == static_cast<unsigned long>(response + length - body);
+}
+}  // namespace
+
+MetricsServer::MetricsServer() : socket_(static_cast<uintptr_t>(INVALID_SOCKET)) {
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    scrapeCounter_ = registry.Counter("voicemirror_metrics_scrapes_total", "Scrapes served by the metrics endpoint.");
+    renderDuration_ = registry.RegisterHistogram("voicemirror_metrics_render_duration_seconds",
+                                                 "Time taken to collect and render a scrape.",
+                                                 METRICS_LATENCY_BUCKETS_S, std::size(METRICS_LATENCY_BUCKETS_S));
+}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(uint16_t port) {
+    if (running_) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("[MetricsServer::Start] WSAStartup failed.");
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        LOG_ERROR("[MetricsServer::Start] Failed to create socket. Error: " + std::to_string(WSAGetLastError()));
+        WSACleanup();
+        return false;
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || listen(sock, SOMAXCONN) != 0) {
+        LOG_ERROR("[MetricsServer::Start] Failed to listen on TCP port " + std::to_string(port) + ". Error: " + std::to_string(WSAGetLastError()));
+        closesocket(sock);
+        WSACleanup();
+        return false;
+    }
+
+    int localLength = sizeof(local);
+    getsockname(sock, reinterpret_cast<sockaddr*>(&local), &localLength);
+    port_ = ntohs(local.sin_port);
+    socket_ = static_cast<uintptr_t>(sock);
+
+    // The response header is written right in front of the body, so a scrape is one send.
+    request_.resize(METRICS_HTTP_REQUEST_BYTES);
+    body_.resize(METRICS_HTTP_HEADER_BYTES + METRICS_RENDER_BUFFER_BYTES);
+
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::ThreadProc, this);
+    LOG_INFO("[MetricsServer::Start] Serving metrics on http://127.0.0.1:" + std::to_string(port_) + METRICS_PATH);
+    return true;
+}
+
+void MetricsServer::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closesocket(static_cast<SOCKET>(socket_));
+    socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    WSACleanup();
+}
+
+MetricsServer::Stats MetricsServer::GetStats() const {
+    Stats stats;
+    stats.scrapes = scrapes_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.truncated = truncated_.load(std::memory_order_relaxed);
+    stats.allocatingScrapes = allocatingScrapes_.load(std::memory_order_relaxed);
+    stats.historyQueries = historyQueries_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MetricsServer::ThreadProc() {
+    SOCKET sock = static_cast<SOCKET>(socket_);
+
+    while (running_.load(std::memory_order_acquire)) {
+        // Wake up regularly to notice Stop().
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        timeval timeout{0, static_cast<long>(METRICS_ACCEPT_POLL_MS * 1000)};
+        if (select(static_cast<int>(sock) + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+            continue;
+        }
+
+        SOCKET client = accept(sock, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            continue;
+        }
+        SetTimeouts(client);
+        Serve(static_cast<uintptr_t>(client));
+        shutdown(client, SD_SEND);
+        closesocket(client);
+    }
+}
+
+size_t MetricsServer::ReadRequest(uintptr_t client) {
+    size_t length = 0;
+    while (length < request_.size()) {
+        int received = recv(static_cast<SOCKET>(client), request_.data() + length, static_cast<int>(request_.size() - length), 0);
+        if (received <= 0) {
+            return 0;  // Closed, reset or timed out before the head was complete
+        }
+
+        // The blank line may straddle two reads.
+        size_t searchFrom = length >= 3 ? length - 3 : 0;
+        length += static_cast<size_t>(received);
+        for (size_t i = searchFrom; i + 4 <= length; ++i) {
+            if (std::memcmp(request_.data() + i, "\r\n\r\n", 4) == 0) {
+                return length;
+            }
+        }
+    }
+    return 0;  // Head larger than the request buffer
+}
+
+void MetricsServer::Serve(uintptr_t client) {
+    char* body = body_.data() + METRICS_HTTP_HEADER_BYTES;
+    auto respondWith = [this, client, body](const char* status, const char* text) {
+        size_t length = std::strlen(text);
+        std::memcpy(body, text, length);
+        Respond(client, status, body, length);
+    };
+
+    size_t length = ReadRequest(client);
+    if (length == 0) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const char* request = request_.data();
+    if (!StartsWith(request, length, "GET ")) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        respondWith("405 Method Not Allowed", "Only GET is supported.\n");
+        return;
+    }
+
+    const char* path = request + 4;
+    const char* pathEnd = path;
+    while (pathEnd < request + length && *pathEnd != ' ' && *pathEnd != '?' && *pathEnd != '\r') {
+        ++pathEnd;
+    }
+    size_t pathLength = static_cast<size_t>(pathEnd - path);
+    if (pathLength == std::strlen(HISTORY_PATH) && std::memcmp(path, HISTORY_PATH, pathLength) == 0) {
+        const char* queryEnd = pathEnd;
+        while (queryEnd < request + length && *queryEnd != ' ' && *queryEnd != '\r') {
+            ++queryEnd;
+        }
+        const char* query = pathEnd < queryEnd ? pathEnd + 1 : pathEnd;
+        ServeHistory(client, query, static_cast<size_t>(queryEnd - query));
+        return;
+    }
+    if (pathLength != std::strlen(METRICS_PATH) || std::memcmp(path, METRICS_PATH, pathLength) != 0) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        respondWith("404 Not Found", "Metrics are served at /metrics, volume history at /history.\n");
+        return;
+    }
+
+    uint64_t allocationsBefore = AllocationTracker::ThreadAllocations();
+    auto renderStart = std::chrono::steady_clock::now();
+    if (scrapeCounter_) {
+        scrapeCounter_->Add(1.0);
+    }
+    size_t bodyLength = 0;
+    bool rendered = MetricsRegistry::Instance().RenderText(body, METRICS_RENDER_BUFFER_BYTES, bodyLength);
+    if (renderDuration_) {
+        renderDuration_->Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count());
+    }
+
+    if (!rendered) {
+        // Logs once per overflow rather than growing the buffer mid-scrape.
+        if (truncated_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            LOG_WARNING("[MetricsServer::Serve] Metrics exceed " + std::to_string(METRICS_RENDER_BUFFER_BYTES) + " bytes.");
+        }
+        respondWith("500 Internal Server Error", "Metrics exceed the render buffer.\n");
+        return;
+    }
+
+    Respond(client, "200 OK", body, bodyLength);
+    uint64_t scrapes = scrapes_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (scrapes > ALLOCATION_WARMUP_SCRAPES && AllocationTracker::ThreadAllocations() != allocationsBefore) {
+        allocatingScrapes_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MetricsServer::ServeHistory(uintptr_t client, const char* query, size_t queryLength) {
+    char* body = body_.data() + METRICS_HTTP_HEADER_BYTES;
+    auto respondWith = [this, client, body](const char* status, const char* text) {
+        size_t length = std::strlen(text);
+        std::memcpy(body, text, length);
+        Respond(client, status, body, length);
+    };
+
+    VolumeHistory::Query parsed;
+    if (!VolumeHistory::ParseQuery(query, queryLength, parsed)) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        respondWith("400 Bad Request",
+                    "Query with series=windows_volume|windows_mute|voicemeeter_volume|voicemeeter_mute, "
+                    "tier=raw|1s|1m, from=<ms> and to=<ms>, all optional.\n");
+        return;
+    }
+    size_t bodyLength = 0;
+    if (!VolumeHistory::Instance().Render(parsed, body, METRICS_RENDER_BUFFER_BYTES, bodyLength)) {
+        respondWith("500 Internal Server Error", "History exceeds the render buffer; narrow from/to or pick a coarser tier.\n");
+        return;
+    }
+    Respond(client, "200 OK", body, bodyLength);
+    historyQueries_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricsServer::Respond(uintptr_t client, const char* status, const char* body, size_t bodyLength) {
+    int headerLength = std::snprintf(header_, sizeof(header_),
+                                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                                     status, CONTENT_TYPE, bodyLength);
+    if (headerLength <= 0 || static_cast<size_t>(headerLength) >= sizeof(header_)) {
+        return;
+    }
+
+    // body always points METRICS_HTTP_HEADER_BYTES into body_, so the header fits in front of it.
+    char* response = const_cast<char*>(body) - headerLength;
+    std::memcpy(response, header_, static_cast<size_t>(headerLength));
+    SendAll(static_cast<SOCKET>(client), response, static_cast<size_t>(headerLength) + bodyLength);
+}
+
+bool MetricsServer::Benchmark(uint32_t scrapes) {
+    using BenchClock = std::chrono::steady_clock;
+
+    // Scrape what a running instance exports: the footprint collector and the endpoint's own metrics.
+    FootprintReporter::RegisterMetrics();
+    MetricsServer server;
+    if (!server.Start(0)) {
+        return false;
+    }
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(server.Port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::vector<char> response(METRICS_HTTP_HEADER_BYTES + METRICS_RENDER_BUFFER_BYTES + 1);
+    auto scrape = [&address, &response](const char* request, size_t& length) {
+        length = 0;
+        SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET) {
+            return false;
+        }
+        SetTimeouts(sock);
+        bool ok = connect(sock, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+                  SendAll(sock, request, std::strlen(request));
+        while (ok && length < response.size() - 1) {
+            int received = recv(sock, response.data() + length, static_cast<int>(response.size() - 1 - length), 0);
+            if (received <= 0) {
+                ok = received == 0;
+                break;
+            }
+            length += static_cast<size_t>(received);
+        }
+        closesocket(sock);
+        response[length] = '\0';
+        return ok;
+    };
+
+    bool valid = true;
+    size_t length = 0;
+    const char* body = nullptr;
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(scrapes);
+    size_t bodyBytes = 0;
+    for (uint32_t i = 0; i < scrapes && valid; ++i) {
+        BenchClock::time_point start = BenchClock::now();
+        bool ok = scrape("GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: text/plain\r\n\r\n", length);
+        latenciesUs.push_back(std::chrono::duration<double, std::micro>(BenchClock::now() - start).count());
+
+        valid = ok && CheckResponse(response.data(), length, "200 OK", body) &&
+                std::strstr(body, "# TYPE voicemirror_metrics_render_duration_seconds histogram\n") &&
+                std::strstr(body, "voicemirror_metrics_render_duration_seconds_bucket{le=\"+Inf\"} ");
+        bodyBytes = length;
+        if (!valid) {
+            LOG_ERROR("[MetricsServer::Benchmark] Scrape " + std::to_string(i) + " returned an invalid response:\n" +
+                      std::string(response.data(), length));
+        }
+    }
+
+    bool rejects = scrape("GET /nothing HTTP/1.1\r\n\r\n", length) &&
+                   CheckResponse(response.data(), length, "404 Not Found", body) &&
+                   scrape("POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n", length) &&
+                   CheckResponse(response.data(), length, "405 Method Not Allowed", body) &&
+                   scrape("GET /history?tier=10s HTTP/1.1\r\n\r\n", length) &&
+                   CheckResponse(response.data(), length, "400 Bad Request", body);
+    if (!rejects) {
+        LOG_ERROR("[MetricsServer::Benchmark] Unknown paths, methods or history queries were not rejected.");
+    }
+    bool history = scrape("GET /history?series=windows_volume&from=0 HTTP/1.1\r\n\r\n", length) &&
+                   CheckResponse(response.data(), length, "200 OK", body) &&
+                   StartsWith(body, std::strlen(body), "series,tier,time_ms,");
+    if (!history) {
+        LOG_ERROR("[MetricsServer::Benchmark] The history query did not return CSV.");
+    }
+
+    server.Stop();
+    WSACleanup();
+    Stats stats = server.GetStats();
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    auto percentile = [&latenciesUs](double p) {
+        return latenciesUs.empty() ? 0.0 : latenciesUs[static_cast<size_t>(p * (latenciesUs.size() - 1))];
+    };
+    LOG_INFO("[MetricsServer::Benchmark] " + std::to_string(stats.scrapes) + " of " + std::to_string(scrapes) +
+             " scrapes of " + std::to_string(bodyBytes) + " bytes. Latency p50: " + std::to_string(percentile(0.5)) +
+             " us, p99: " + std::to_string(percentile(0.99)) + " us, max: " + std::to_string(percentile(1.0)) + " us.");
+    if (AllocationTracker::IsEnabled()) {
+        LOG_INFO("[MetricsServer::Benchmark] Scrapes that allocated after warm-up: " + std::to_string(stats.allocatingScrapes) + ".");
+    }
+
+    return valid && rejects && history && stats.historyQueries == 1 && stats.scrapes == scrapes && stats.truncated == 0 && stats.allocatingScrapes == 0;
+}
@@ -0,0 +1,837 @@
+// MidiController.cpp
+#include "MidiController.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+
+namespace {
+constexpr float GAIN_RANGE_DB = static_cast<float>(DEFAULT_MAX_DBM - DEFAULT_MIN_DBM);
+constexpr float MAX_7BIT = 127.0f;
+constexpr float MAX_14BIT = 16383.0f;
+
+// Controller numbers with a fixed meaning in NRPN/RPN sequences
+constexpr uint8_t CC_DATA_ENTRY_MSB = 6;
+constexpr uint8_t CC_DATA_ENTRY_LSB = 38;
+constexpr uint8_t CC_NRPN_LSB = 98;
+constexpr uint8_t CC_NRPN_MSB = 99;
+constexpr uint8_t CC_RPN_LSB = 100;
+constexpr uint8_t CC_RPN_MSB = 101;
+constexpr uint16_t CC14_LSB_OFFSET = 32;
+
+// Large enough for "Strip[N].Gain" and a value
+constexpr size_t PARAMETER_NAME_LENGTH = 32;
+
+// Longest feedback message: an NRPN write of four controller messages
+constexpr size_t MAX_FEEDBACK_MESSAGE = 12;
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+std::string Lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool ParseNumber(const std::string& text, long minimum, long maximum, long& value) {
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= minimum && value <= maximum;
+}
+
+bool ParseSource(const std::vector<std::string>& parts, MidiSource& source) {
+    std::string kind = Lower(parts[0]);
+    long channel = 0;
+    long number = 0;
+    if (parts.size() < 2 || !ParseNumber(parts[1], 1, 16, channel)) {
+        return false;
+    }
+    source.channel = static_cast<uint8_t>(channel - 1);
+
+    if (kind == "bend") {
+        source.kind = MidiSource::Kind::PitchBend;
+        return parts.size() == 2;
+    }
+    if (parts.size() != 3) {
+        return false;
+    }
+    if (kind == "cc" && ParseNumber(parts[2], 0, 127, number)) {
+        source.kind = MidiSource::Kind::ControlChange;
+    } else if (kind == "cc14" && ParseNumber(parts[2], 0, 31, number)) {
+        source.kind = MidiSource::Kind::ControlChange14;
+    } else if (kind == "nrpn" && ParseNumber(parts[2], 0, 16383, number)) {
+        source.kind = MidiSource::Kind::Nrpn;
+    } else if (kind == "note" && ParseNumber(parts[2], 0, 127, number)) {
+        source.kind = MidiSource::Kind::Note;
+    } else {
+        return false;
+    }
+    source.number = static_cast<uint16_t>(number);
+    return true;
+}
+
+bool ParseTarget(const std::vector<std::string>& parts, MidiTarget& target) {
+    if (parts.size() != 3) {
+        return false;
+    }
+    std::string field = Lower(parts[0]);
+    std::string type = Lower(parts[1]);
+    long index = 0;
+    if ((field != "gain" && field != "mute") || (type != "input" && type != "output") ||
+        !ParseNumber(parts[2], 0, static_cast<long>(SCENE_MAX_STRIPS) - 1, index)) {
+        return false;
+    }
+    target.field = field == "gain" ? MidiTarget::Field::Gain : MidiTarget::Field::Mute;
+    target.channelType = type == "input" ? ChannelType::Input : ChannelType::Output;
+    target.index = static_cast<uint8_t>(index);
+    return true;
+}
+
+bool SameSource(const MidiSource& a, const MidiSource& b) {
+    return a.kind == b.kind && a.channel == b.channel && a.number == b.number;
+}
+
+void PushControl(std::vector<uint8_t>& out, uint8_t channel, uint8_t number, uint8_t value) {
+    out.push_back(static_cast<uint8_t>(0xB0 | channel));
+    out.push_back(number);
+    out.push_back(value);
+}
+
+// Appends a message, leaving out the status byte where running status allows.
+MidiEvent MakeEvent(MidiEvent::Kind kind, uint8_t channel, uint16_t number, uint16_t value) {
+    MidiEvent event;
+    event.kind = kind;
+    event.channel = channel;
+    event.number = number;
+    event.value = value;
+    return event;
+}
+
+void PushMessage(std::vector<uint8_t>& out, uint8_t& runningStatus, uint8_t status, uint8_t data1, int data2 = -1) {
+    if (status != runningStatus) {
+        out.push_back(status);
+        runningStatus = status;
+    }
+    out.push_back(data1);
+    if (data2 >= 0) {
+        out.push_back(static_cast<uint8_t>(data2));
+    }
+}
+}  // namespace
+
+// -----------------------------
+// MidiDecoder
+// -----------------------------
+
+MidiDecoder::MidiDecoder() {
+    std::fill(std::begin(nrpnParameter_), std::end(nrpnParameter_), NO_NRPN);
+}
+
+void MidiDecoder::Decode(const uint8_t* bytes, size_t length, std::vector<MidiEvent>& events) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = bytes[i];
+
+        if (byte >= 0xF8) {
+            continue;  // Realtime bytes may appear anywhere, even inside messages.
+        }
+        if (byte >= 0xF0) {
+            // SysEx and system common messages cancel running status; their data is skipped.
+            inSysex_ = byte == 0xF0;
+            status_ = 0;
+            count_ = 0;
+            continue;
+        }
+        if (byte >= 0x80) {
+            inSysex_ = false;
+            status_ = byte;
+            count_ = 0;
+            continue;
+        }
+        if (inSysex_ || status_ == 0) {
+            continue;
+        }
+
+        data_[count_++] = byte;
+        uint8_t type = status_ & 0xF0;
+        uint8_t needed = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+        if (count_ == needed) {
+            Emit(events);
+            count_ = 0;
+        }
+    }
+}
+
+void MidiDecoder::Emit(std::vector<MidiEvent>& events) {
+    uint8_t type = status_ & 0xF0;
+    uint8_t channel = status_ & 0x0F;
+
+    MidiEvent event;
+    event.channel = channel;
+
+    switch (type) {
+        case 0x80:
+        case 0x90:
+            event.kind = MidiEvent::Kind::Note;
+            event.number = data_[0];
+            event.value = (type == 0x90 && data_[1] > 0) ? 127 : 0;
+            break;
+        case 0xE0:
+            event.kind = MidiEvent::Kind::PitchBend;
+            event.value = static_cast<uint16_t>((data_[1] << 7) | data_[0]);
+            break;
+        case 0xB0: {
+            uint8_t number = data_[0];
+            uint8_t value = data_[1];
+            uint16_t& parameter = nrpnParameter_[channel];
+            switch (number) {
+                case CC_NRPN_MSB:
+                    parameter = static_cast<uint16_t>((value << 7) | (parameter == NO_NRPN ? 0 : parameter & 0x7F));
+                    return;
+                case CC_NRPN_LSB:
+                    parameter = static_cast<uint16_t>((parameter == NO_NRPN ? 0 : parameter & 0x3F80) | value);
+                    return;
+                case CC_RPN_MSB:
+                case CC_RPN_LSB:
+                    // Data entry now belongs to an RPN, which nothing maps.
+                    parameter = NO_NRPN;
+                    return;
+                case CC_DATA_ENTRY_MSB:
+                case CC_DATA_ENTRY_LSB:
+                    if (parameter != NO_NRPN) {
+                        // Per the spec a new MSB clears the LSB.
+                        if (number == CC_DATA_ENTRY_MSB) {
+                            nrpnDataMsb_[channel] = value;
+                        }
+                        event.kind = MidiEvent::Kind::Nrpn;
+                        event.number = parameter;
+                        event.value = static_cast<uint16_t>((nrpnDataMsb_[channel] << 7) |
+                                                            (number == CC_DATA_ENTRY_LSB ? value : 0));
+                        break;
+                    }
+                    [[fallthrough]];
+                default:
+                    event.kind = MidiEvent::Kind::ControlChange;
+                    event.number = number;
+                    event.value = value;
+                    break;
+            }
+            break;
+        }
+        default:
+            return;  // Aftertouch and program changes are not mapped.
+    }
+    events.push_back(event);
+}
+
+// -----------------------------
+// MidiController
+// -----------------------------
+
+MidiController::MidiController() {
+    std::memset(controlTable_, NO_MAPPING, sizeof(controlTable_));
+    std::memset(noteTable_, NO_MAPPING, sizeof(noteTable_));
+    std::memset(bendTable_, NO_MAPPING, sizeof(bendTable_));
+    events_.reserve(MIDI_INPUT_BUFFER_SIZE);
+    script_.reserve(SCENE_RECALL_SCRIPT_RESERVE);
+    feedback_.reserve(MIDI_FEEDBACK_BUFFER_SIZE);
+}
+
+MidiController::~MidiController() {
+    Stop();
+}
+
+bool MidiController::AddMapping(const MidiMapping& mapping) {
+    if (running_) {
+        LOG_ERROR("[MidiController::AddMapping] Mappings cannot change while the controller is running.");
+        return false;
+    }
+
+    const MidiSource& source = mapping.source;
+    if (source.channel >= 16) {
+        return false;
+    }
+
+    size_t slot = mappings_.size();
+    for (size_t i = 0; i < mappings_.size(); ++i) {
+        if (SameSource(mappings_[i].source, source)) {
+            LOG_WARNING("[MidiController::AddMapping] Control mapped twice; the later mapping wins.");
+            slot = i;
+            break;
+        }
+    }
+    if (slot == mappings_.size() && mappings_.size() >= MIDI_MAX_MAPPINGS) {
+        LOG_ERROR("[MidiController::AddMapping] Mapping limit of " + std::to_string(MIDI_MAX_MAPPINGS) + " reached.");
+        return false;
+    }
+
+    char parameter[PARAMETER_NAME_LENGTH];
+    std::snprintf(parameter, sizeof(parameter), "%s[%d].%s",
+                  mapping.target.channelType == ChannelType::Input ? "Strip" : "Bus", mapping.target.index,
+                  mapping.target.field == MidiTarget::Field::Gain ? "Gain" : "Mute");
+
+    if (slot == mappings_.size()) {
+        mappings_.push_back(mapping);
+        parameters_.push_back(parameter);
+        states_.emplace_back();
+    } else {
+        mappings_[slot] = mapping;
+        parameters_[slot] = parameter;
+        states_[slot] = MappingState();
+    }
+
+    uint8_t index = static_cast<uint8_t>(slot);
+    switch (source.kind) {
+        case MidiSource::Kind::ControlChange:
+            controlTable_[source.channel][source.number] = index;
+            break;
+        case MidiSource::Kind::ControlChange14:
+            controlTable_[source.channel][source.number] = index;
+            controlTable_[source.channel][source.number + CC14_LSB_OFFSET] = index;
+            break;
+        case MidiSource::Kind::Note:
+            noteTable_[source.channel][source.number] = index;
+            break;
+        case MidiSource::Kind::PitchBend:
+            bendTable_[source.channel] = index;
+            break;
+        case MidiSource::Kind::Nrpn:
+            break;  // Few enough to scan.
+    }
+    return true;
+}
+
+bool MidiController::ParseMapping(const std::string& text, MidiMapping& mapping) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+
+    MidiMapping parsed;
+    if (!ParseSource(Split(text.substr(0, equals), ':'), parsed.source) ||
+        !ParseTarget(Split(text.substr(equals + 1), ':'), parsed.target)) {
+        return false;
+    }
+    mapping = parsed;
+    return true;
+}
+
+bool MidiController::Start(MidiPort& port) {
+    if (running_) {
+        return true;
+    }
+    if (mappings_.empty()) {
+        LOG_DEBUG("[MidiController::Start] No mappings configured.");
+        return false;
+    }
+
+    port_ = &port;
+    running_ = true;
+    thread_ = std::thread(&MidiController::ThreadProc, this);
+    LOG_INFO("[MidiController::Start] " + std::to_string(mappings_.size()) + " MIDI mappings active.");
+    return true;
+}
+
+void MidiController::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    port_->Close();
+    port_ = nullptr;
+}
+
+void MidiController::ThreadProc() {
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::milliseconds interval(MIDI_POLL_INTERVAL_MS);
+
+    Clock::time_point nextCycle = Clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        port_->RunCycle(*this);
+
+        nextCycle += interval;
+        Clock::time_point now = Clock::now();
+        if (nextCycle < now) {
+            nextCycle = now + interval;  // Fell behind; do not burst to catch up.
+        }
+        std::this_thread::sleep_until(nextCycle);
+    }
+}
+
+void MidiController::Process(const uint8_t* input, size_t length, const float* values) {
+    events_.clear();
+    script_.clear();
+    feedback_.clear();
+
+    ObserveValues(values);
+
+    decoder_.Decode(input, length, events_);
+    cycleHolds_ = 0;
+    if (enabled_.load(std::memory_order_relaxed)) {
+        for (const MidiEvent& event : events_) {
+            ApplyEvent(event);
+        }
+    }
+
+    size_t writes = WriteScript();
+    WriteFeedback();
+
+    std::lock_guard<ProfiledMutex> lock(statsMutex_);
+    ++stats_.cycles;
+    stats_.bytes += length;
+    stats_.events += events_.size();
+    stats_.writes += writes;
+    stats_.feedbackBytes += feedback_.size();
+    stats_.takeoverHolds += cycleHolds_;
+}
+
+void MidiController::ObserveValues(const float* values) {
+    for (size_t slot = 0; slot < states_.size(); ++slot) {
+        MappingState& state = states_[slot];
+        float value = values[slot];
+        if (std::isnan(value)) {
+            continue;
+        }
+
+        if (!state.knownValid) {
+            state.known = value;
+            state.knownValid = true;
+            state.feedbackDue = true;
+            continue;
+        }
+
+        bool gain = mappings_[slot].target.field == MidiTarget::Field::Gain;
+        bool same = gain ? std::fabs(value - state.known) <= SCENE_GAIN_EPSILON_DB
+                         : (value != 0.0f) == (state.known != 0.0f);
+        if (state.settleCycles > 0) {
+            // Our own write may not have reached the mixer yet.
+            state.settleCycles = same ? 0 : static_cast<uint8_t>(state.settleCycles - 1);
+            continue;
+        }
+        if (!same) {
+            // The fader position from before the change says nothing about crossing the new value.
+            state.known = value;
+            state.pickedUp = false;
+            state.lastControl = -1.0f;
+            state.feedbackDue = true;
+        }
+    }
+}
+
+void MidiController::ApplyEvent(const MidiEvent& event) {
+    uint8_t slot = NO_MAPPING;
+    switch (event.kind) {
+        case MidiEvent::Kind::ControlChange:
+            slot = controlTable_[event.channel][event.number & 0x7F];
+            break;
+        case MidiEvent::Kind::Note:
+            slot = noteTable_[event.channel][event.number & 0x7F];
+            break;
+        case MidiEvent::Kind::PitchBend:
+            slot = bendTable_[event.channel];
+            break;
+        case MidiEvent::Kind::Nrpn:
+            for (size_t i = 0; i < mappings_.size(); ++i) {
+                const MidiSource& source = mappings_[i].source;
+                if (source.kind == MidiSource::Kind::Nrpn && source.channel == event.channel && source.number == event.number) {
+                    slot = static_cast<uint8_t>(i);
+                    break;
+                }
+            }
+            break;
+    }
+    if (slot == NO_MAPPING) {
+        return;
+    }
+
+    const MidiSource& source = mappings_[slot].source;
+    float position = 0.0f;
+    switch (source.kind) {
+        case MidiSource::Kind::ControlChange:
+            position = event.value / MAX_7BIT;
+            break;
+        case MidiSource::Kind::ControlChange14: {
+            MappingState& state = states_[slot];
+            uint16_t raw = 0;
+            if (event.number == source.number) {
+                // Per the spec a new MSB clears the LSB.
+                state.msb = static_cast<uint8_t>(event.value);
+                raw = static_cast<uint16_t>(event.value << 7);
+            } else {
+                raw = static_cast<uint16_t>((state.msb << 7) | event.value);
+            }
+            position = raw / MAX_14BIT;
+            break;
+        }
+        case MidiSource::Kind::Nrpn:
+        case MidiSource::Kind::PitchBend:
+            if (event.kind == MidiEvent::Kind::ControlChange) {
+                return;
+            }
+            position = event.value / MAX_14BIT;
+            break;
+        case MidiSource::Kind::Note:
+            position = event.value > 0 ? 1.0f : 0.0f;
+            break;
+    }
+    ApplyControl(slot, position);
+}
+
+void MidiController::ApplyControl(size_t slot, float position) {
+    MappingState& state = states_[slot];
+
+    if (mappings_[slot].target.field == MidiTarget::Field::Mute) {
+        bool pressed = position >= 0.5f;
+        if (pressed && !state.pressed) {
+            float current = state.dirty ? state.pending : (state.knownValid ? ToPosition(slot, state.known) : 0.0f);
+            state.pending = current >= 0.5f ? 0.0f : 1.0f;
+            state.dirty = true;
+        }
+        state.pressed = pressed;
+        return;
+    }
+
+    if (!state.pickedUp) {
+        if (!state.knownValid) {
+            state.pickedUp = true;
+        } else {
+            float mixer = ToPosition(slot, state.known);
+            bool near = std::fabs(position - mixer) <= MIDI_TAKEOVER_WINDOW;
+            bool crossed = state.lastControl >= 0.0f && (state.lastControl - mixer) * (position - mixer) <= 0.0f;
+            state.pickedUp = near || crossed;
+        }
+    }
+    state.lastControl = position;
+
+    if (!state.pickedUp) {
+        ++cycleHolds_;
+        return;
+    }
+    state.pending = position;
+    state.dirty = true;
+}
+
+size_t MidiController::WriteScript() {
+    size_t writes = 0;
+    char statement[PARAMETER_NAME_LENGTH * 2];
+    for (size_t slot = 0; slot < states_.size(); ++slot) {
+        MappingState& state = states_[slot];
+        if (!state.dirty) {
+            continue;
+        }
+        state.dirty = false;
+
+        // Written with two decimals, so compare against what will read back.
+        float value = std::round(FromPosition(slot, state.pending) * 100.0f) / 100.0f;
+        if (state.knownValid && std::fabs(value - state.known) <= SCENE_GAIN_EPSILON_DB / 2.0f) {
+            continue;
+        }
+
+        if (mappings_[slot].target.field == MidiTarget::Field::Gain) {
+            std::snprintf(statement, sizeof(statement), "%s=%.2f;", parameters_[slot].c_str(), value);
+        } else {
+            std::snprintf(statement, sizeof(statement), "%s=%d;", parameters_[slot].c_str(), value != 0.0f ? 1 : 0);
+        }
+        script_ += statement;
+        ++writes;
+
+        state.known = value;
+        state.knownValid = true;
+        state.settleCycles = MIDI_SETTLE_CYCLES;
+    }
+    return writes;
+}
+
+void MidiController::WriteFeedback() {
+    for (size_t slot = 0; slot < states_.size(); ++slot) {
+        MappingState& state = states_[slot];
+        if (!state.feedbackDue || !state.knownValid) {
+            continue;
+        }
+        if (feedback_.size() + MAX_FEEDBACK_MESSAGE > MIDI_FEEDBACK_BUFFER_SIZE) {
+            return;  // The rest goes out next cycle.
+        }
+        state.feedbackDue = false;
+
+        const MidiSource& source = mappings_[slot].source;
+        float position = ToPosition(slot, state.known);
+        uint8_t value7 = static_cast<uint8_t>(std::lround(position * MAX_7BIT));
+        uint16_t value14 = static_cast<uint16_t>(std::lround(position * MAX_14BIT));
+        uint8_t channel = source.channel;
+
+        switch (source.kind) {
+            case MidiSource::Kind::ControlChange:
+                PushControl(feedback_, channel, static_cast<uint8_t>(source.number), value7);
+                break;
+            case MidiSource::Kind::ControlChange14:
+                PushControl(feedback_, channel, static_cast<uint8_t>(source.number), static_cast<uint8_t>(value14 >> 7));
+                PushControl(feedback_, channel, static_cast<uint8_t>(source.number + CC14_LSB_OFFSET), static_cast<uint8_t>(value14 & 0x7F));
+                break;
+            case MidiSource::Kind::Nrpn:
+                PushControl(feedback_, channel, CC_NRPN_MSB, static_cast<uint8_t>(source.number >> 7));
+                PushControl(feedback_, channel, CC_NRPN_LSB, static_cast<uint8_t>(source.number & 0x7F));
+                PushControl(feedback_, channel, CC_DATA_ENTRY_MSB, static_cast<uint8_t>(value14 >> 7));
+                PushControl(feedback_, channel, CC_DATA_ENTRY_LSB, static_cast<uint8_t>(value14 & 0x7F));
+                break;
+            case MidiSource::Kind::PitchBend:
+                feedback_.push_back(static_cast<uint8_t>(0xE0 | channel));
+                feedback_.push_back(static_cast<uint8_t>(value14 & 0x7F));
+                feedback_.push_back(static_cast<uint8_t>(value14 >> 7));
+                break;
+            case MidiSource::Kind::Note:
+                // LED on or off
+                feedback_.push_back(static_cast<uint8_t>(0x90 | channel));
+                feedback_.push_back(static_cast<uint8_t>(source.number));
+                feedback_.push_back(position >= 0.5f ? 127 : 0);
+                break;
+        }
+    }
+}
+
+float MidiController::ToPosition(size_t slot, float value) const {
+    if (mappings_[slot].target.field == MidiTarget::Field::Mute) {
+        return value != 0.0f ? 1.0f : 0.0f;
+    }
+    return (std::min)((std::max)((value - DEFAULT_MIN_DBM) / GAIN_RANGE_DB, 0.0f), 1.0f);
+}
+
+float MidiController::FromPosition(size_t slot, float position) const {
+    if (mappings_[slot].target.field == MidiTarget::Field::Mute) {
+        return position >= 0.5f ? 1.0f : 0.0f;
+    }
+    return DEFAULT_MIN_DBM + position * GAIN_RANGE_DB;
+}
+
+MidiController::Stats MidiController::GetStats() const {
+    std::lock_guard<ProfiledMutex> lock(statsMutex_);
+    return stats_;
+}
+
+bool MidiController::Benchmark(uint32_t messages) {
+    using Clock = std::chrono::steady_clock;
+    const char* MAPPINGS[] = {
+        "cc:1:7=gain:input:0",
+        "cc14:1:1=gain:input:1",
+        "nrpn:1:512=gain:input:2",
+        "bend:2=gain:output:0",
+        "note:1:60=mute:input:3",
+    };
+
+    // A mixed stream using running status wherever a real device would,
+    // with the message each one must decode to.
+    std::vector<uint8_t> stream;
+    stream.reserve(static_cast<size_t>(messages) * 3 + 8);
+    std::vector<MidiEvent> sent;
+    sent.reserve(messages);
+    uint8_t runningStatus = 0;
+    PushMessage(stream, runningStatus, 0xB0, CC_NRPN_MSB, 512 >> 7);
+    PushMessage(stream, runningStatus, 0xB0, CC_NRPN_LSB, 512 & 0x7F);
+    for (uint32_t i = 0; i < messages; ++i) {
+        uint8_t sweep = static_cast<uint8_t>(i & 0x7F);
+        uint8_t reverse = static_cast<uint8_t>(127 - sweep);
+        switch (i % 8) {
+            case 0:
+            case 1:
+            case 2:
+                PushMessage(stream, runningStatus, 0xB0, 7, sweep);
+                sent.push_back(MakeEvent(MidiEvent::Kind::ControlChange, 0, 7, sweep));
+                break;
+            case 3:
+                PushMessage(stream, runningStatus, 0xB0, 1, sweep);
+                sent.push_back(MakeEvent(MidiEvent::Kind::ControlChange, 0, 1, sweep));
+                break;
+            case 4:
+                PushMessage(stream, runningStatus, 0xB0, 1 + CC14_LSB_OFFSET, reverse);
+                sent.push_back(MakeEvent(MidiEvent::Kind::ControlChange, 0, 1 + CC14_LSB_OFFSET, reverse));
+                break;
+            case 5:
+                PushMessage(stream, runningStatus, 0xB0, CC_DATA_ENTRY_MSB, sweep);
+                sent.push_back(MakeEvent(MidiEvent::Kind::Nrpn, 0, 512, static_cast<uint16_t>(sweep << 7)));
+                break;
+            case 6:
+                PushMessage(stream, runningStatus, 0xE1, sweep, reverse);
+                sent.push_back(MakeEvent(MidiEvent::Kind::PitchBend, 1, 0, static_cast<uint16_t>((reverse << 7) | sweep)));
+                break;
+            case 7: {
+                bool on = (i / 8) % 2 == 0;
+                PushMessage(stream, runningStatus, 0x90, 60, on ? 100 : 0);
+                sent.push_back(MakeEvent(MidiEvent::Kind::Note, 0, 60, on ? 127 : 0));
+                break;
+            }
+        }
+    }
+
+    // Decoded in odd-sized reads, so messages are split across calls as they are on a real port.
+    MidiDecoder checker;
+    std::vector<MidiEvent> received;
+    received.reserve(sent.size());
+    for (size_t offset = 0; offset < stream.size(); offset += 7) {
+        checker.Decode(stream.data() + offset, (std::min)(size_t(7), stream.size() - offset), received);
+    }
+    uint32_t mismatches = received.size() == sent.size() ? 0 : 1;
+    for (size_t i = 0; mismatches == 0 && i < sent.size(); ++i) {
+        const MidiEvent& a = sent[i];
+        const MidiEvent& b = received[i];
+        if (a.kind != b.kind || a.channel != b.channel || a.number != b.number || a.value != b.value) {
+            LOG_ERROR("[MidiController::Benchmark] Message " + std::to_string(i) + " decoded to control " +
+                      std::to_string(b.number) + " value " + std::to_string(b.value) + " on channel " +
+                      std::to_string(b.channel + 1) + "; sent control " + std::to_string(a.number) + " value " +
+                      std::to_string(a.value) + " on channel " + std::to_string(a.channel + 1) + ".");
+            ++mismatches;
+        }
+    }
+    if (received.size() != sent.size()) {
+        LOG_ERROR("[MidiController::Benchmark] " + std::to_string(sent.size()) + " messages sent, " +
+                  std::to_string(received.size()) + " decoded.");
+    }
+
+    MidiController decoder;
+    for (const char* text : MAPPINGS) {
+        MidiMapping mapping;
+        ParseMapping(text, mapping);
+        decoder.AddMapping(mapping);
+    }
+    std::vector<float> values(decoder.MappingCount(), 0.0f);
+
+    Clock::time_point start = Clock::now();
+    for (size_t offset = 0; offset < stream.size(); offset += MIDI_INPUT_BUFFER_SIZE) {
+        size_t chunk = (std::min)(MIDI_INPUT_BUFFER_SIZE, stream.size() - offset);
+        decoder.Process(stream.data() + offset, chunk, values.data());
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    Stats decoded = decoder.GetStats();
+    LOG_INFO("[MidiController::Benchmark] Decoded " + std::to_string(decoded.events) + " messages (" +
+             std::to_string(stream.size()) + " bytes) in " + std::to_string(decoded.cycles) + " cycles: " +
+             std::to_string(seconds > 0.0 ? seconds * 1e9 / (std::max)(decoded.events, uint64_t(1)) : 0.0) + " ns/message, " +
+             std::to_string(seconds > 0.0 ? stream.size() / seconds / 1e6 : 0.0) + " MB/s.");
+
+    // End to end: a fader sweep injected every millisecond through the cycle thread.
+    MidiController controller;
+    for (const char* text : MAPPINGS) {
+        MidiMapping mapping;
+        ParseMapping(text, mapping);
+        controller.AddMapping(mapping);
+    }
+    ByteStreamMidiPort port(controller.TargetParameters());
+    controller.Start(port);
+
+    const int moves = 500;
+    for (int i = 0; i < moves; ++i) {
+        uint8_t move[3] = {0xB0, 7, static_cast<uint8_t>((i * 3) & 0x7F)};
+        port.Inject(move, sizeof(move));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(MIDI_POLL_INTERVAL_MS * 2));
+    controller.Stop();
+
+    Stats cycled = controller.GetStats();
+    LOG_INFO("[MidiController::Benchmark] " + std::to_string(moves) + " fader moves in " + std::to_string(cycled.cycles) +
+             " cycles produced " + std::to_string(port.AppliedScripts()) + " scripts. Latency mean " +
+             std::to_string(port.MeanLatencyMs()) + " ms, max " + std::to_string(port.MaxLatencyMs()) + " ms.");
+    return mismatches == 0;
+}
+
+// -----------------------------
+// ByteStreamMidiPort
+// -----------------------------
+
+ByteStreamMidiPort::ByteStreamMidiPort(const std::vector<std::string>& parameters)
+    : parameters_(parameters), values_(parameters.size(), 0.0f), snapshot_(parameters.size(), 0.0f) {
+    pending_.reserve(MIDI_INPUT_BUFFER_SIZE);
+    input_.reserve(MIDI_INPUT_BUFFER_SIZE);
+}
+
+void ByteStreamMidiPort::Inject(const uint8_t* bytes, size_t length) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    if (pending_.empty()) {
+        firstPending_ = Clock::now();
+    }
+    pending_.insert(pending_.end(), bytes, bytes + length);
+}
+
+void ByteStreamMidiPort::SetValue(size_t index, float value) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    values_[index] = value;
+}
+
+float ByteStreamMidiPort::GetValue(size_t index) const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return values_[index];
+}
+
+bool ByteStreamMidiPort::RunCycle(MidiController& controller) {
+    Clock::time_point injected;
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        input_.swap(pending_);
+        pending_.clear();
+        injected = firstPending_;
+        snapshot_ = values_;
+    }
+
+    controller.Process(input_.data(), input_.size(), snapshot_.data());
+
+    if (!controller.Script().empty()) {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        ApplyScript(controller.Script());
+        ++scripts_;
+        if (!input_.empty()) {
+            double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - injected).count();
+            ++latencySamples_;
+            latencyTotalMs_ += latencyMs;
+            latencyMaxMs_ = (std::max)(latencyMaxMs_, latencyMs);
+        }
+    }
+    return true;
+}
+
+void ByteStreamMidiPort::ApplyScript(const std::string& script) {
+    size_t start = 0;
+    while (start < script.size()) {
+        size_t end = script.find(';', start);
+        if (end == std::string::npos) {
+            end = script.size();
+        }
+        size_t equals = script.find('=', start);
+        if (equals < end) {
+            std::string name = script.substr(start, equals - start);
+            for (size_t i = 0; i < parameters_.size(); ++i) {
+                if (parameters_[i] == name) {
+                    values_[i] = std::strtof(script.c_str() + equals + 1, nullptr);
+                }
+            }
+        }
+        start = end + 1;
+    }
+}
+
+uint64_t ByteStreamMidiPort::AppliedScripts() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return scripts_;
+}
+
+double ByteStreamMidiPort::MeanLatencyMs() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return latencySamples_ > 0 ? latencyTotalMs_ / static_cast<double>(latencySamples_) : 0.0;
+}
+
+double ByteStreamMidiPort::MaxLatencyMs() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return latencyMaxMs_;
+}
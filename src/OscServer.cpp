@@ -0,0 +1,793 @@
+// OscServer.cpp
+// Winsock 2 has to come before windows.h, which pulls in the old winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "OscServer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "Logger.h"
+#include "VolumeUtils.h"
+
+namespace {
+const std::chrono::milliseconds FEEDBACK_INTERVAL(OSC_FEEDBACK_INTERVAL_MS);
+const std::chrono::milliseconds ECHO_HOLD(OSC_ECHO_HOLD_MS);
+const std::chrono::seconds CLIENT_TIMEOUT(OSC_CLIENT_TIMEOUT_S);
+
+constexpr char BUNDLE_TAG[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', '\0'};
+// Time tag 1 means "immediately"
+constexpr uint8_t IMMEDIATELY[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+// Router target of the /subscribe address
+constexpr uint16_t SUBSCRIBE = 0xFFFE;
+
+// Hold slots: level (gain and volume) and mute
+constexpr size_t LEVEL = 0;
+constexpr size_t MUTE = 1;
+
+// Room for the longest feedback message: "/strip/7/volume", its type tags and a float
+constexpr size_t MAX_MESSAGE_SIZE = 32;
+// Large enough for "Strip[N].Gain=-60.00;"
+constexpr size_t STATEMENT_LENGTH = 32;
+
+// Datagrams the benchmark keeps in flight, so it measures the server rather than the socket buffer
+constexpr uint64_t BENCH_WINDOW = 256;
+
+uint32_t ReadUint32(const uint8_t* bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+uint64_t ReadUint64(const uint8_t* bytes) {
+    return (static_cast<uint64_t>(ReadUint32(bytes)) << 32) | ReadUint32(bytes + 4);
+}
+
+void AppendUint32(std::vector<uint8_t>& out, uint32_t value) {
+    const uint8_t bytes[4] = {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                              static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+// Size of an OSC string with its terminator and padding, or 0 if it is not terminated in time.
+size_t StringSize(const uint8_t* data, size_t available) {
+    const void* terminator = std::memchr(data, '\0', available);
+    if (!terminator) {
+        return 0;
+    }
+    size_t size = (static_cast<size_t>(static_cast<const uint8_t*>(terminator) - data) + 4) & ~static_cast<size_t>(3);
+    return size <= available ? size : 0;
+}
+
+void AppendString(std::vector<uint8_t>& out, const char* text) {
+    size_t length = std::strlen(text);
+    out.insert(out.end(), text, text + length);
+    out.insert(out.end(), 4 - length % 4, '\0');
+}
+
+// Appends a message with one float argument, or none if value is NaN.
+void AppendMessage(std::vector<uint8_t>& out, const char* address, float value) {
+    AppendString(out, address);
+    if (std::isnan(value)) {
+        AppendString(out, ",");
+        return;
+    }
+    AppendString(out, ",f");
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    AppendUint32(out, bits);
+}
+
+void BeginBundle(std::vector<uint8_t>& out) {
+    out.clear();
+    out.insert(out.end(), BUNDLE_TAG, BUNDLE_TAG + sizeof(BUNDLE_TAG));
+    out.insert(out.end(), IMMEDIATELY, IMMEDIATELY + sizeof(IMMEDIATELY));
+}
+
+// Appends a bundle element: its size, then the message.
+void AppendElement(std::vector<uint8_t>& out, const char* address, float value) {
+    size_t sizeOffset = out.size();
+    AppendUint32(out, 0);
+    AppendMessage(out, address, value);
+    uint32_t size = static_cast<uint32_t>(out.size() - sizeOffset - 4);
+    for (int i = 0; i < 4; ++i) {
+        out[sizeOffset + i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+    }
+}
+
+void AppendStatement(std::string& script, size_t channel, const char* field, const char* format, float value) {
+    char statement[STATEMENT_LENGTH];
+    bool strip = channel < SCENE_MAX_STRIPS;
+    int index = static_cast<int>(strip ? channel : channel - SCENE_MAX_STRIPS);
+    int length = std::snprintf(statement, sizeof(statement), "%s[%d].%s=", strip ? "Strip" : "Bus", index, field);
+    length += std::snprintf(statement + length, sizeof(statement) - length, format, value);
+    script.append(statement, static_cast<size_t>(length));
+    script.push_back(';');
+}
+
+// Mixer stand-in for the benchmark.
+class SimulatedOscBackend : public OscBackend {
+public:
+    SimulatedOscBackend() {
+        SceneLayout layout = SceneLogic::GetLayout(VOICEMEETER_POTATO);
+        scene_.voicemeeterType = layout.voicemeeterType;
+        scene_.stripCount = layout.stripCount;
+        scene_.busCount = layout.busCount;
+    }
+
+    void Apply(const std::string& script) override {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        SceneLogic::ApplyScript(scene_, script);
+    }
+
+    bool Read(Scene& scene) override {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        scene = scene_;
+        return true;
+    }
+
+private:
+    ProfiledMutex mutex_{"SimulatedOscBackend::mutex_"};
+    Scene scene_;
+};
+
+// Reads every datagram arriving within the timeout and counts the messages in them.
+void ReceiveFeedback(SOCKET socket, std::chrono::milliseconds timeout, uint64_t& packets, uint64_t& messages) {
+    uint8_t buffer[OSC_MAX_PACKET_SIZE];
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return;
+        }
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(socket, &readable);
+        timeval wait{static_cast<long>(remaining.count() / 1000000), static_cast<long>(remaining.count() % 1000000)};
+        if (select(static_cast<int>(socket) + 1, &readable, nullptr, nullptr, &wait) <= 0) {
+            return;
+        }
+        int received = recvfrom(socket, reinterpret_cast<char*>(buffer), static_cast<int>(sizeof(buffer)), 0, nullptr, nullptr);
+        if (received > 0) {
+            ++packets;
+            OscParser::Parse(buffer, static_cast<size_t>(received), [&messages](const OscMessage&) { ++messages; });
+        }
+    }
+}
+}  // namespace
+
+bool OscMessage::FirstFloat(float& value) const {
+    size_t available = static_cast<size_t>(end - arguments);
+    switch (typeTags[0]) {
+        case 'f': {
+            if (available < 4) {
+                return false;
+            }
+            uint32_t bits = ReadUint32(arguments);
+            std::memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+        case 'i':
+            if (available < 4) {
+                return false;
+            }
+            value = static_cast<float>(static_cast<int32_t>(ReadUint32(arguments)));
+            return true;
+        case 'd': {
+            if (available < 8) {
+                return false;
+            }
+            uint64_t bits = ReadUint64(arguments);
+            double number = 0.0;
+            std::memcpy(&number, &bits, sizeof(number));
+            value = static_cast<float>(number);
+            return true;
+        }
+        case 'h':
+            if (available < 8) {
+                return false;
+            }
+            value = static_cast<float>(static_cast<int64_t>(ReadUint64(arguments)));
+            return true;
+        case 'T':
+            value = 1.0f;
+            return true;
+        case 'F':
+            value = 0.0f;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool OscParser::IsBundle(const uint8_t* data, size_t length) {
+    return length >= BUNDLE_HEADER_SIZE && std::memcmp(data, BUNDLE_TAG, sizeof(BUNDLE_TAG)) == 0;
+}
+
+bool OscParser::ParseMessage(const uint8_t* data, size_t length, OscMessage& message) {
+    if (length < 4 || length % 4 != 0 || data[0] != '/') {
+        return false;
+    }
+
+    size_t addressSize = StringSize(data, length);
+    if (addressSize == 0) {
+        return false;
+    }
+    message.address = reinterpret_cast<const char*>(data);
+    message.addressLength = std::strlen(message.address);
+    message.end = data + length;
+
+    // Type tags were optional before OSC 1.0; such messages carry no arguments we read.
+    if (addressSize == length) {
+        message.typeTags = "";
+        message.arguments = message.end;
+        return true;
+    }
+    if (data[addressSize] != ',') {
+        return false;
+    }
+    size_t tagsSize = StringSize(data + addressSize, length - addressSize);
+    if (tagsSize == 0) {
+        return false;
+    }
+    message.typeTags = reinterpret_cast<const char*>(data + addressSize + 1);
+    message.arguments = data + addressSize + tagsSize;
+    return true;
+}
+
+OscRouter::OscRouter() {
+    nodes_.emplace_back();
+}
+
+void OscRouter::Add(const std::string& address, uint16_t target) {
+    uint16_t node = 0;
+    size_t start = 1;
+    while (start <= address.size()) {
+        size_t end = address.find('/', start);
+        if (end == std::string::npos) {
+            end = address.size();
+        }
+        std::string segment = address.substr(start, end - start);
+
+        uint16_t* link = &nodes_[node].firstChild;
+        while (*link != NO_TARGET && nodes_[*link].segment != segment) {
+            link = &nodes_[*link].nextSibling;
+        }
+        if (*link == NO_TARGET) {
+            // Link first: emplace_back may move the node that link points into.
+            *link = static_cast<uint16_t>(nodes_.size());
+            nodes_.emplace_back();
+            nodes_.back().segment = segment;
+            node = static_cast<uint16_t>(nodes_.size() - 1);
+        } else {
+            node = *link;
+        }
+        start = end + 1;
+    }
+    nodes_[node].target = target;
+}
+
+bool OscRouter::MatchSegment(const char* pattern, const char* patternEnd, const char* text, const char* textEnd) {
+    while (pattern < patternEnd) {
+        switch (*pattern) {
+            case '*': {
+                while (pattern < patternEnd && *pattern == '*') {
+                    ++pattern;
+                }
+                if (pattern == patternEnd) {
+                    return true;
+                }
+                for (const char* rest = text; rest <= textEnd; ++rest) {
+                    if (MatchSegment(pattern, patternEnd, rest, textEnd)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            case '?':
+                if (text == textEnd) {
+                    return false;
+                }
+                ++pattern;
+                ++text;
+                break;
+            case '[': {
+                const char* close = std::find(pattern + 1, patternEnd, ']');
+                if (text == textEnd || close == patternEnd) {
+                    return false;
+                }
+                const char* member = pattern + 1;
+                bool negate = member < close && *member == '!';
+                if (negate) {
+                    ++member;
+                }
+                bool found = false;
+                while (member < close) {
+                    if (member + 2 < close && member[1] == '-') {
+                        found = found || (*text >= member[0] && *text <= member[2]);
+                        member += 3;
+                    } else {
+                        found = found || *text == *member;
+                        ++member;
+                    }
+                }
+                if (found == negate) {
+                    return false;
+                }
+                pattern = close + 1;
+                ++text;
+                break;
+            }
+            case '{': {
+                const char* close = std::find(pattern + 1, patternEnd, '}');
+                if (close == patternEnd) {
+                    return false;
+                }
+                for (const char* option = pattern + 1; option <= close;) {
+                    const char* comma = std::find(option, close, ',');
+                    size_t length = static_cast<size_t>(comma - option);
+                    if (length <= static_cast<size_t>(textEnd - text) && std::memcmp(option, text, length) == 0 &&
+                        MatchSegment(close + 1, patternEnd, text + length, textEnd)) {
+                        return true;
+                    }
+                    option = comma + 1;
+                }
+                return false;
+            }
+            default:
+                if (text == textEnd || *pattern != *text) {
+                    return false;
+                }
+                ++pattern;
+                ++text;
+                break;
+        }
+    }
+    return text == textEnd;
+}
+
+OscServer::OscServer(OscBackend& backend) : backend_(backend), socket_(static_cast<uintptr_t>(INVALID_SOCKET)) {
+    static const char* const fields[] = {"gain", "volume", "mute"};
+    for (size_t channel = 0; channel < CHANNELS; ++channel) {
+        bool strip = channel < SCENE_MAX_STRIPS;
+        std::string prefix = std::string(strip ? "/strip/" : "/bus/") +
+                             std::to_string(strip ? channel : channel - SCENE_MAX_STRIPS) + "/";
+        for (int field = 0; field < 3; ++field) {
+            uint16_t id = static_cast<uint16_t>(targets_.size());
+            targets_.push_back({static_cast<Field>(field), static_cast<uint8_t>(channel)});
+            addresses_.push_back(prefix + fields[field]);
+            router_.Add(addresses_.back(), id);
+        }
+    }
+    router_.Add("/subscribe", SUBSCRIBE);
+
+    values_.assign(targets_.size(), NAN);
+    sent_.assign(targets_.size(), NAN);
+    for (size_t channel = 0; channel < CHANNELS; ++channel) {
+        holdClient_[channel][LEVEL] = NO_CLIENT;
+        holdClient_[channel][MUTE] = NO_CLIENT;
+    }
+    script_.reserve(CHANNELS * 2 * STATEMENT_LENGTH);
+    bundle_.reserve(OSC_FEEDBACK_PACKET_SIZE);
+}
+
+OscServer::~OscServer() {
+    Stop();
+}
+
+bool OscServer::Start(uint16_t port, bool loopbackOnly) {
+    if (running_) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("[OscServer::Start] WSAStartup failed.");
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        LOG_ERROR("[OscServer::Start] Failed to create socket. Error: " + std::to_string(WSAGetLastError()));
+        WSACleanup();
+        return false;
+    }
+
+    // Room for bursts from fast controllers while a feedback cycle runs.
+    int receiveBuffer = OSC_RECEIVE_BUFFER_BYTES;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    unsigned long nonBlocking = 1;
+    if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+        ioctlsocket(sock, FIONBIO, &nonBlocking) != 0) {
+        LOG_ERROR("[OscServer::Start] Failed to bind UDP port " + std::to_string(port) + ". Error: " + std::to_string(WSAGetLastError()));
+        closesocket(sock);
+        WSACleanup();
+        return false;
+    }
+
+    int localLength = sizeof(local);
+    getsockname(sock, reinterpret_cast<sockaddr*>(&local), &localLength);
+    port_ = ntohs(local.sin_port);
+    socket_ = static_cast<uintptr_t>(sock);
+
+    running_ = true;
+    thread_ = std::thread(&OscServer::ThreadProc, this);
+    LOG_INFO("[OscServer::Start] Listening for OSC on UDP port " + std::to_string(port_) + ".");
+    return true;
+}
+
+void OscServer::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closesocket(static_cast<SOCKET>(socket_));
+    socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    WSACleanup();
+}
+
+OscServer::Stats OscServer::GetStats() const {
+    std::lock_guard<ProfiledMutex> lock(statsMutex_);
+    return stats_;
+}
+
+void OscServer::ThreadProc() {
+    SOCKET sock = static_cast<SOCKET>(socket_);
+    std::vector<uint8_t> buffer(OSC_MAX_PACKET_SIZE);
+
+    Clock::time_point nextFeedback = Clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        // Sleep until a datagram arrives or feedback is due.
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(nextFeedback - Clock::now());
+        wait = (std::max)(wait, std::chrono::microseconds(0));
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        timeval timeout{static_cast<long>(wait.count() / 1000000), static_cast<long>(wait.count() % 1000000)};
+        select(static_cast<int>(sock) + 1, &readable, nullptr, nullptr, &timeout);
+
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < OSC_MAX_PACKETS_PER_DRAIN; ++i) {
+            sockaddr_in from{};
+            int fromLength = sizeof(from);
+            int received = recvfrom(sock, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0,
+                                    reinterpret_cast<sockaddr*>(&from), &fromLength);
+            if (received < 0) {
+                int error = WSAGetLastError();
+                if (error == WSAEMSGSIZE) {
+                    ++cycleStats_.malformed;
+                    continue;
+                }
+                // A client that went away makes the next read fail with WSAECONNRESET; skip it.
+                if (error == WSAECONNRESET) {
+                    continue;
+                }
+                break;
+            }
+            size_t client = Subscribe(from.sin_addr.s_addr, from.sin_port, now);
+            HandlePacket(buffer.data(), static_cast<size_t>(received), client, now);
+        }
+
+        ApplyPending();
+        if (now >= nextFeedback) {
+            SendFeedback(now);
+            nextFeedback = now + FEEDBACK_INTERVAL;
+        }
+
+        std::lock_guard<ProfiledMutex> lock(statsMutex_);
+        stats_.packets += cycleStats_.packets;
+        stats_.messages += cycleStats_.messages;
+        stats_.malformed += cycleStats_.malformed;
+        stats_.unmatched += cycleStats_.unmatched;
+        stats_.scripts += cycleStats_.scripts;
+        stats_.feedbackPackets += cycleStats_.feedbackPackets;
+        stats_.feedbackMessages += cycleStats_.feedbackMessages;
+        stats_.clients = static_cast<size_t>(std::count_if(clients_, clients_ + OSC_MAX_CLIENTS, [](const Client& c) { return c.active; }));
+        cycleStats_ = Stats();
+    }
+}
+
+size_t OscServer::Subscribe(uint32_t address, uint16_t port, Clock::time_point now) {
+    size_t free = NO_CLIENT;
+    for (size_t i = 0; i < OSC_MAX_CLIENTS; ++i) {
+        Client& client = clients_[i];
+        if (client.active && client.address == address && client.port == port) {
+            client.lastSeen = now;
+            return i;
+        }
+        if (free == NO_CLIENT && (!client.active || now - client.lastSeen > CLIENT_TIMEOUT)) {
+            free = i;
+        }
+    }
+    if (free == NO_CLIENT) {
+        return NO_CLIENT;  // Writes still apply; the sender just gets no feedback.
+    }
+
+    Client& client = clients_[free];
+    client.active = true;
+    client.address = address;
+    client.port = port;
+    client.lastSeen = now;
+    client.needsFullState = true;
+
+    in_addr ip{};
+    ip.s_addr = address;
+    char text[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &ip, text, sizeof(text));
+    LOG_INFO(std::string("[OscServer::Subscribe] Client subscribed: ") + text + ":" + std::to_string(ntohs(port)));
+    return free;
+}
+
+void OscServer::HandlePacket(const uint8_t* data, size_t length, size_t client, Clock::time_point now) {
+    ++cycleStats_.packets;
+    bool valid = OscParser::Parse(data, length, [this, client, now](const OscMessage& message) {
+        HandleMessage(message, client, now);
+    });
+    if (!valid) {
+        ++cycleStats_.malformed;
+    }
+}
+
+void OscServer::HandleMessage(const OscMessage& message, size_t client, Clock::time_point now) {
+    ++cycleStats_.messages;
+    float value = 0.0f;
+    bool hasValue = message.FirstFloat(value) && !std::isnan(value);
+
+    size_t matched = router_.Match(message.address, message.addressLength, [&](uint16_t id) {
+        if (id == SUBSCRIBE) {
+            if (client != NO_CLIENT) {
+                clients_[client].needsFullState = true;
+            }
+            return;
+        }
+        if (!hasValue) {
+            return;
+        }
+
+        const Target& target = targets_[id];
+        size_t slot = LEVEL;
+        switch (target.field) {
+            case Field::Gain:
+                pendingGain_[target.channel] = std::clamp(value, static_cast<float>(DEFAULT_MIN_DBM), static_cast<float>(DEFAULT_MAX_DBM));
+                gainDirty_[target.channel] = true;
+                break;
+            case Field::Volume:
+                pendingGain_[target.channel] = VolumeUtils::PercentToDbm(VolumeUtils::ScalarToPercent(value));
+                gainDirty_[target.channel] = true;
+                break;
+            case Field::Mute:
+                pendingMute_[target.channel] = value >= 0.5f ? 1 : 0;
+                muteDirty_[target.channel] = true;
+                slot = MUTE;
+                break;
+        }
+        holdClient_[target.channel][slot] = client;
+        holdUntil_[target.channel][slot] = now + ECHO_HOLD;
+    });
+    if (matched == 0) {
+        ++cycleStats_.unmatched;
+    }
+}
+
+void OscServer::ApplyPending() {
+    script_.clear();
+    for (size_t channel = 0; channel < CHANNELS; ++channel) {
+        if (gainDirty_[channel]) {
+            AppendStatement(script_, channel, "Gain", "%.2f", pendingGain_[channel]);
+            gainDirty_[channel] = false;
+        }
+        if (muteDirty_[channel]) {
+            AppendStatement(script_, channel, "Mute", "%.0f", pendingMute_[channel]);
+            muteDirty_[channel] = false;
+        }
+    }
+    if (!script_.empty()) {
+        backend_.Apply(script_);
+        ++cycleStats_.scripts;
+    }
+}
+
+float OscServer::ValueOf(const Scene& scene, const Target& target) {
+    bool strip = target.channel < SCENE_MAX_STRIPS;
+    size_t index = strip ? target.channel : target.channel - SCENE_MAX_STRIPS;
+    if (index >= static_cast<size_t>(strip ? scene.stripCount : scene.busCount)) {
+        return NAN;
+    }
+    const ChannelSnapshot& channel = strip ? scene.strips[index] : scene.buses[index];
+    switch (target.field) {
+        case Field::Gain:
+            return channel.gainDb;
+        case Field::Volume:
+            return VolumeUtils::PercentToScalar(VolumeUtils::dBmToPercent(channel.gainDb));
+        case Field::Mute:
+            return channel.mute ? 1.0f : 0.0f;
+    }
+    return NAN;
+}
+
+void OscServer::SendFeedback(Clock::time_point now) {
+    bool anyClient = false;
+    for (Client& client : clients_) {
+        if (client.active && now - client.lastSeen > CLIENT_TIMEOUT) {
+            client.active = false;
+            LOG_DEBUG("[OscServer::SendFeedback] Dropping a client that went quiet.");
+        }
+        anyClient = anyClient || client.active;
+    }
+    if (!anyClient || !backend_.Read(scene_)) {
+        return;
+    }
+
+    for (size_t id = 0; id < targets_.size(); ++id) {
+        values_[id] = ValueOf(scene_, targets_[id]);
+    }
+
+    for (size_t c = 0; c < OSC_MAX_CLIENTS; ++c) {
+        Client& client = clients_[c];
+        if (!client.active) {
+            continue;
+        }
+
+        BeginBundle(bundle_);
+        for (size_t id = 0; id < targets_.size(); ++id) {
+            float value = values_[id];
+            if (std::isnan(value)) {
+                continue;
+            }
+            bool changed = std::isnan(sent_[id]) || std::fabs(value - sent_[id]) > 0.0001f;
+            if (!changed && !client.needsFullState) {
+                continue;
+            }
+            const Target& target = targets_[id];
+            size_t slot = target.field == Field::Mute ? MUTE : LEVEL;
+            if (holdClient_[target.channel][slot] == c && now < holdUntil_[target.channel][slot]) {
+                continue;  // The client is moving this control itself.
+            }
+
+            if (bundle_.size() + MAX_MESSAGE_SIZE + 4 > OSC_FEEDBACK_PACKET_SIZE) {
+                SendBundle(client, bundle_);
+                BeginBundle(bundle_);
+            }
+            AppendElement(bundle_, addresses_[id].c_str(), value);
+            ++cycleStats_.feedbackMessages;
+        }
+        if (bundle_.size() > OscParser::BUNDLE_HEADER_SIZE) {
+            SendBundle(client, bundle_);
+        }
+        client.needsFullState = false;
+    }
+
+    for (size_t id = 0; id < targets_.size(); ++id) {
+        if (!std::isnan(values_[id])) {
+            sent_[id] = values_[id];
+        }
+    }
+}
+
+void OscServer::SendBundle(const Client& client, const std::vector<uint8_t>& bundle) {
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = client.address;
+    to.sin_port = client.port;
+    sendto(static_cast<SOCKET>(socket_), reinterpret_cast<const char*>(bundle.data()), static_cast<int>(bundle.size()), 0,
+           reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+    ++cycleStats_.feedbackPackets;
+}
+
+bool OscServer::Benchmark(uint32_t messages) {
+    using BenchClock = std::chrono::steady_clock;
+
+    SimulatedOscBackend backend;
+    OscServer server(backend);
+    if (!server.Start(0, true)) {
+        return false;
+    }
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    SOCKET subscriber = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    SOCKET sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in serverAddress{};
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(server.Port());
+    serverAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto send = [&serverAddress](SOCKET socket, const std::vector<uint8_t>& packet) {
+        sendto(socket, reinterpret_cast<const char*>(packet.data()), static_cast<int>(packet.size()), 0,
+               reinterpret_cast<const sockaddr*>(&serverAddress), sizeof(serverAddress));
+    };
+
+    // Subscribe, and expect the full state back.
+    std::vector<uint8_t> packet;
+    AppendMessage(packet, "/subscribe", NAN);
+    send(subscriber, packet);
+    uint64_t feedbackPackets = 0;
+    uint64_t feedbackMessages = 0;
+    ReceiveFeedback(subscriber, FEEDBACK_INTERVAL * 4, feedbackPackets, feedbackMessages);
+    uint64_t initialMessages = feedbackMessages;
+
+    // Gains one message at a time, and every fourth datagram a bundle that also
+    // mutes two buses through an address pattern.
+    float lastGain[SCENE_MAX_STRIPS];
+    std::fill(lastGain, lastGain + SCENE_MAX_STRIPS, NAN);
+    float lastMute = NAN;
+    char address[MAX_MESSAGE_SIZE];
+    uint32_t sent = 0;
+    uint64_t datagrams = 1;  // The subscribe
+    BenchClock::time_point start = BenchClock::now();
+    while (sent < messages) {
+        packet.clear();
+        bool bundle = datagrams % 4 == 3 && messages - sent >= 4;
+        if (bundle) {
+            BeginBundle(packet);
+        }
+        for (int k = 0; k < (bundle ? 3 : 1); ++k, ++sent) {
+            size_t strip = sent % SCENE_MAX_STRIPS;
+            float gain = -static_cast<float>(sent % 60);
+            std::snprintf(address, sizeof(address), "/strip/%zu/gain", strip);
+            if (bundle) {
+                AppendElement(packet, address, gain);
+            } else {
+                AppendMessage(packet, address, gain);
+            }
+            lastGain[strip] = gain;
+        }
+        if (bundle) {
+            lastMute = static_cast<float>((datagrams / 4) % 2);
+            AppendElement(packet, "/bus/{0,1}/mute", lastMute);
+            ++sent;
+        }
+        send(sender, packet);
+        ++datagrams;
+
+        if (datagrams % 64 == 0) {
+            BenchClock::time_point stalled = BenchClock::now() + std::chrono::seconds(1);
+            while (datagrams - server.GetStats().packets > BENCH_WINDOW && BenchClock::now() < stalled) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    // Wait for the server to catch up; whatever is missing after that was dropped.
+    BenchClock::time_point stalled = BenchClock::now() + std::chrono::seconds(1);
+    while (server.GetStats().packets < datagrams && BenchClock::now() < stalled) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+
+    ReceiveFeedback(subscriber, FEEDBACK_INTERVAL * 4, feedbackPackets, feedbackMessages);
+    Stats stats = server.GetStats();
+    server.Stop();
+    closesocket(subscriber);
+    closesocket(sender);
+    WSACleanup();
+
+    Scene mixer;
+    backend.Read(mixer);
+    bool correct = stats.packets == datagrams;
+    for (size_t strip = 0; strip < SCENE_MAX_STRIPS; ++strip) {
+        correct = correct && (std::isnan(lastGain[strip]) || mixer.strips[strip].gainDb == lastGain[strip]);
+    }
+    correct = correct && (std::isnan(lastMute) || (mixer.buses[0].mute == lastMute && mixer.buses[1].mute == lastMute));
+
+    LOG_INFO("[OscServer::Benchmark] " + std::to_string(stats.messages) + " of " + std::to_string(sent) + " messages in " +
+             std::to_string(stats.packets) + " of " + std::to_string(datagrams) + " datagrams handled in " +
+             std::to_string(elapsedMs) + " ms (" + std::to_string(elapsedMs > 0.0 ? stats.messages * 1000.0 / elapsedMs : 0.0) +
+             " messages/s). Scripts applied: " + std::to_string(stats.scripts) + ", malformed: " + std::to_string(stats.malformed) +
+             ", unmatched: " + std::to_string(stats.unmatched) + ".");
+    LOG_INFO("[OscServer::Benchmark] Subscriber received " + std::to_string(initialMessages) + " messages of initial state and " +
+             std::to_string(feedbackMessages - initialMessages) + " more in " + std::to_string(feedbackPackets) +
+             " feedback datagrams, at most one bundle per " + std::to_string(OSC_FEEDBACK_INTERVAL_MS) + " ms.");
+    if (!correct) {
+        LOG_ERROR("[OscServer::Benchmark] Simulated mixer does not hold the last values sent.");
+    }
+    return correct;
+}
@@ -0,0 +1,87 @@
+// ProfiledMutex.cpp
+#include "ProfiledMutex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Logger.h"
+
+LockProfiler& LockProfiler::Instance() {
+    static LockProfiler instance;
+    return instance;
+}
+
+LockStats* LockProfiler::Register(const char* name) {
+    std::lock_guard<std::mutex> lock(registerMutex_);
+
+    size_t count = count_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (std::strcmp(locks_[i].name, name) == 0) {
+            return &locks_[i];
+        }
+    }
+
+    if (count == MAX_LOCKS) {
+        // Not through the logger: this can run while the logger is being built.
+        if (unprofiled_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "LockProfiler: Table of " << MAX_LOCKS << " locks is full, " << name
+                      << " and later locks are not profiled. Raise LockProfiler::MAX_LOCKS." << std::endl;
+        }
+        return nullptr;
+    }
+
+    locks_[count].name = name;
+    count_.store(count + 1, std::memory_order_release);
+    return &locks_[count];
+}
+
+void LockProfiler::Report() const {
+#ifdef VOICEMIRROR_PROFILE_LOCKS
+    size_t count = count_.load(std::memory_order_acquire);
+    const LockStats* order[MAX_LOCKS];
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = &locks_[i];
+    }
+    std::sort(order, order + count, [](const LockStats* a, const LockStats* b) {
+        return a->contended.load(std::memory_order_relaxed) > b->contended.load(std::memory_order_relaxed);
+    });
+
+    LOG_INFO("[LockProfiler::Report] Lock contention (most contended first):");
+    size_t unprofiled = unprofiled_.load(std::memory_order_relaxed);
+    if (unprofiled > 0) {
+        LOG_WARNING("[LockProfiler::Report] " + std::to_string(unprofiled) +
+                    " lock registrations did not fit in the table and are missing below. Raise LockProfiler::MAX_LOCKS.");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const LockStats& stats = *order[i];
+        uint64_t acquisitions = stats.acquisitions.load(std::memory_order_relaxed);
+        if (acquisitions == 0) {
+            continue;
+        }
+
+        double averageWaitUs = stats.waitNs.load(std::memory_order_relaxed) / 1000.0 / acquisitions;
+        double averageHoldUs = stats.holdNs.load(std::memory_order_relaxed) / 1000.0 / acquisitions;
+        LOG_INFO(std::string("[LockProfiler::Report] ") + stats.name +
+                 ": acquisitions: " + std::to_string(acquisitions) +
+                 ", contended: " + std::to_string(stats.contended.load(std::memory_order_relaxed)) +
+                 ", wait avg/max: " + std::to_string(averageWaitUs) + "/" +
+                 std::to_string(stats.maxWaitNs.load(std::memory_order_relaxed) / 1000.0) + " us" +
+                 ", hold avg/max: " + std::to_string(averageHoldUs) + "/" +
+                 std::to_string(stats.maxHoldNs.load(std::memory_order_relaxed) / 1000.0) + " us");
+    }
+#endif
+}
+
+void LockProfiler::Reset() {
+    size_t count = count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        locks_[i].acquisitions.store(0, std::memory_order_relaxed);
+        locks_[i].contended.store(0, std::memory_order_relaxed);
+        locks_[i].waitNs.store(0, std::memory_order_relaxed);
+        locks_[i].maxWaitNs.store(0, std::memory_order_relaxed);
+        locks_[i].holdNs.store(0, std::memory_order_relaxed);
+        locks_[i].maxHoldNs.store(0, std::memory_order_relaxed);
+    }
+}
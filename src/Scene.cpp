@@ -0,0 +1,252 @@
+// Scene.cpp
+#include "Scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "Logger.h"
+
+namespace {
+constexpr uint32_t SCENE_FILE_MAGIC = 0x43534D56;  // "VMSC"
+constexpr uint16_t SCENE_FILE_VERSION = 1;
+
+struct SceneFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+};
+
+// Room for the longest statement: a label with its quotes
+constexpr size_t STATEMENT_LENGTH = SCENE_LABEL_LENGTH + 32;
+
+uint32_t Checksum(const Scene& scene) {
+    // FNV-1a
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&scene);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(Scene); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void AppendStatement(std::string& script, const char* format, const char* prefix, int index, const char* field, float value) {
+    char statement[STATEMENT_LENGTH];
+    std::snprintf(statement, sizeof(statement), format, prefix, index, field, value);
+    script += statement;
+}
+
+size_t AppendChannelDiff(const ChannelSnapshot& current, const ChannelSnapshot& target,
+                         const char* prefix, int index, const SceneLayout& layout, std::string& script) {
+    size_t changed = 0;
+
+    if (std::fabs(current.gainDb - target.gainDb) > SCENE_GAIN_EPSILON_DB) {
+        AppendStatement(script, "%s[%d].%s=%.2f;", prefix, index, "Gain", target.gainDb);
+        ++changed;
+    }
+    if (current.mute != target.mute) {
+        AppendStatement(script, "%s[%d].%s=%.0f;", prefix, index, "Mute", target.mute ? 1.0f : 0.0f);
+        ++changed;
+    }
+
+    for (int button = 0; button < layout.physicalBuses + layout.virtualBuses; ++button) {
+        int bit = SceneLogic::RoutingBit(layout, button);
+        bool was = (current.routing >> bit) & 1;
+        bool wanted = (target.routing >> bit) & 1;
+        if (was != wanted) {
+            AppendStatement(script, "%s[%d].%s=%.0f;", prefix, index, SceneLogic::RoutingField(bit), wanted ? 1.0f : 0.0f);
+            ++changed;
+        }
+    }
+
+    if (std::strncmp(current.label, target.label, SCENE_LABEL_LENGTH) != 0) {
+        // Scene files may come from anywhere; never write a label that could end the statement.
+        char label[SCENE_LABEL_LENGTH];
+        SceneLogic::CopyLabel(label, target.label, strnlen(target.label, SCENE_LABEL_LENGTH));
+        char statement[STATEMENT_LENGTH];
+        std::snprintf(statement, sizeof(statement), "%s[%d].Label=\"%s\";", prefix, index, label);
+        script += statement;
+        ++changed;
+    }
+    return changed;
+}
+}  // namespace
+
+namespace SceneLogic {
+
+SceneLayout GetLayout(long voicemeeterType) {
+    SceneLayout layout;
+    switch (voicemeeterType) {
+        case VOICEMEETER_BASIC:
+        case VOICEMEETER_BASIC_X64:
+            layout = {VOICEMEETER_BASIC, 3, 2, 1, 1};
+            break;
+        case VOICEMEETER_BANANA:
+        case VOICEMEETER_BANANA_X64:
+            layout = {VOICEMEETER_BANANA, 5, 5, 3, 2};
+            break;
+        case VOICEMEETER_POTATO:
+        case VOICEMEETER_POTATO_X64:
+            layout = {VOICEMEETER_POTATO, 8, 8, 5, 3};
+            break;
+        default:
+            break;
+    }
+    return layout;
+}
+
+int RoutingBit(const SceneLayout& layout, int button) {
+    return button < layout.physicalBuses ? button : SCENE_VIRTUAL_ROUTING_SHIFT + button - layout.physicalBuses;
+}
+
+const char* RoutingField(int bit) {
+    static const char* const fields[] = {"A1", "A2", "A3", "A4", "A5", "B1", "B2", "B3"};
+    return bit >= 0 && bit < static_cast<int>(sizeof(fields) / sizeof(fields[0])) ? fields[bit] : "";
+}
+
+void CopyLabel(char (&label)[SCENE_LABEL_LENGTH], const char* source, size_t length) {
+    size_t end = (std::min)(length, SCENE_LABEL_LENGTH - 1);
+    // Back up over continuation bytes (10xxxxxx) to the start of a character that does not fit.
+    if (end < length) {
+        while (end > 0 && (static_cast<uint8_t>(source[end]) & 0xC0) == 0x80) {
+            --end;
+        }
+    }
+    for (size_t i = 0; i < end; ++i) {
+        label[i] = source[i] == '"' ? '\'' : source[i] == ';' ? ',' : source[i];
+    }
+    std::memset(label + end, 0, SCENE_LABEL_LENGTH - end);
+}
+
+size_t BuildRecallScript(const Scene& current, const Scene& target, std::string& script) {
+    SceneLayout layout = GetLayout(target.voicemeeterType);
+    size_t changed = 0;
+
+    // Routing buttons only exist on strips; buses get an empty layout for them.
+    for (int i = 0; i < target.stripCount && i < current.stripCount; ++i) {
+        changed += AppendChannelDiff(current.strips[i], target.strips[i], "Strip", i, layout, script);
+    }
+    SceneLayout busLayout;
+    for (int i = 0; i < target.busCount && i < current.busCount; ++i) {
+        changed += AppendChannelDiff(current.buses[i], target.buses[i], "Bus", i, busLayout, script);
+    }
+    return changed;
+}
+
+void ApplyScript(Scene& scene, const std::string& script) {
+    size_t start = 0;
+    while (start < script.size()) {
+        // Statements end at the first semicolon outside quotes.
+        size_t end = start;
+        bool quoted = false;
+        while (end < script.size() && (quoted || script[end] != ';')) {
+            quoted = script[end] == '"' ? !quoted : quoted;
+            ++end;
+        }
+        std::string statement = script.substr(start, end - start);
+        start = end + 1;
+
+        char prefix[8] = {};
+        char field[8] = {};
+        char value[SCENE_LABEL_LENGTH + 4] = {};
+        int index = 0;
+        if (std::sscanf(statement.c_str(), "%7[A-Za-z][%d].%7[A-Za-z0-9]=%35[^\n]", prefix, &index, field, value) != 4) {
+            continue;
+        }
+
+        bool isStrip = std::strcmp(prefix, "Strip") == 0;
+        if (index < 0 || index >= (isStrip ? scene.stripCount : scene.busCount)) {
+            continue;
+        }
+        ChannelSnapshot& channel = isStrip ? scene.strips[index] : scene.buses[index];
+
+        if (std::strcmp(field, "Gain") == 0) {
+            channel.gainDb = std::strtof(value, nullptr);
+        } else if (std::strcmp(field, "Mute") == 0) {
+            channel.mute = std::strtof(value, nullptr) != 0.0f ? 1 : 0;
+        } else if (std::strcmp(field, "Label") == 0) {
+            size_t length = std::strlen(value);
+            CopyLabel(channel.label, value + 1, length >= 2 ? length - 2 : 0);
+        } else {
+            for (int bit = 0; bit < 8; ++bit) {
+                if (std::strcmp(field, RoutingField(bit)) == 0) {
+                    channel.routing = static_cast<uint16_t>(std::strtof(value, nullptr) != 0.0f
+                                                                ? channel.routing | (1u << bit)
+                                                                : channel.routing & ~(1u << bit));
+                }
+            }
+        }
+    }
+}
+
+Scene MakeSimulatedScene(float gainOffset, bool flip) {
+    SceneLayout layout = GetLayout(VOICEMEETER_POTATO);
+    Scene scene;
+    scene.voicemeeterType = layout.voicemeeterType;
+    scene.stripCount = layout.stripCount;
+    scene.busCount = layout.busCount;
+    for (int i = 0; i < layout.stripCount; ++i) {
+        scene.strips[i].gainDb = -static_cast<float>(i) * 3.0f + gainOffset;
+        scene.strips[i].mute = (i % 2 == 0) == flip ? 1 : 0;
+        scene.strips[i].routing = static_cast<uint16_t>(flip ? 0x21 << (i % 3) : 0x01);
+        std::snprintf(scene.strips[i].label, SCENE_LABEL_LENGTH, "%s %d", flip ? "Stream" : "Meeting", i);
+    }
+    for (int i = 0; i < layout.busCount; ++i) {
+        scene.buses[i].gainDb = gainOffset / 2.0f - static_cast<float>(i);
+        scene.buses[i].mute = flip && i == layout.busCount - 1 ? 1 : 0;
+    }
+    return scene;
+}
+
+bool Save(const std::string& path, const Scene& scene) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("[SceneLogic::Save] Failed to open scene file " + path + " for writing.");
+        return false;
+    }
+
+    SceneFileHeader header = {SCENE_FILE_MAGIC, SCENE_FILE_VERSION, static_cast<uint16_t>(sizeof(Scene))};
+    uint32_t checksum = Checksum(scene);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&scene), sizeof(scene));
+    file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    if (!file) {
+        LOG_ERROR("[SceneLogic::Save] Failed to write scene file " + path + ".");
+        return false;
+    }
+    return true;
+}
+
+bool Load(const std::string& path, Scene& scene) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("[SceneLogic::Load] Failed to open scene file " + path + ".");
+        return false;
+    }
+
+    SceneFileHeader header = {};
+    Scene loaded;
+    uint32_t checksum = 0;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    file.read(reinterpret_cast<char*>(&loaded), sizeof(loaded));
+    file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+    if (!file || header.magic != SCENE_FILE_MAGIC || header.version != SCENE_FILE_VERSION ||
+        header.size != sizeof(Scene) || checksum != Checksum(loaded)) {
+        LOG_ERROR("[SceneLogic::Load] " + path + " is not a valid scene file.");
+        return false;
+    }
+
+    SceneLayout layout = GetLayout(loaded.voicemeeterType);
+    if (layout.voicemeeterType == 0 || loaded.stripCount != layout.stripCount || loaded.busCount != layout.busCount) {
+        LOG_ERROR("[SceneLogic::Load] " + path + " has an unknown mixer layout.");
+        return false;
+    }
+
+    scene = loaded;
+    return true;
+}
+
+}  // namespace SceneLogic
@@ -0,0 +1,180 @@
+// SoakTest.cpp
+#include "SoakTest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "AllocationTracker.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+namespace {
+constexpr std::chrono::milliseconds COMMAND_DEADLINE(VOICEMEETER_COMMAND_DEADLINE_MS);
+constexpr uint32_t SIMULATED_VOLUME_MERGE_KEY = 1;
+
+// Traffic shape, in ticks
+constexpr uint64_t WINDOWS_SWEEP_TICKS = 200;
+constexpr uint64_t FADER_MOVE_TICKS = 50;
+constexpr uint64_t LISTENER_CHURN_TICKS = 1000;
+constexpr uint64_t PROGRESS_LOG_TICKS = 2000;
+}  // namespace
+
+SoakTest::SoakTest(uint16_t minutes, uint16_t budgetMB, const std::atomic<bool>& running)
+    : minutes_(minutes), budgetMB_(budgetMB), running_(running) {}
+
+int SoakTest::Run() {
+    using Clock = std::chrono::steady_clock;
+
+    if (!executor_.Start()) {
+        LOG_ERROR("[SoakTest::Run] Failed to start the executor.");
+        return EXIT_FAILURE;
+    }
+
+    CallbackID listenerID = listeners_.Add([this](float, bool) { ++dispatched_; });
+
+    FootprintReporter::RegisterMetrics();
+    Metric* tickCounter = MetricsRegistry::Instance().Counter(
+        "voicemirror_soak_ticks_total", "Simulated backend ticks driven by soak mode.");
+
+    const std::chrono::milliseconds sampleInterval(SOAK_SAMPLE_INTERVAL_MS);
+    const std::chrono::minutes duration(minutes_);
+    samples_.reserve(static_cast<size_t>(duration / sampleInterval) + 2);
+
+    LOG_INFO("[SoakTest::Run] Soak test started for " + std::to_string(minutes_) + " minutes.");
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + duration;
+    Clock::time_point nextSample = start;
+    while (running_.load() && Clock::now() < end) {
+        Tick();
+        if (tickCounter) {
+            tickCounter->Add(1);
+        }
+
+        if (Clock::now() >= nextSample) {
+            samples_.push_back(FootprintReporter::Sample());
+            withinBudget_ = FootprintReporter::CheckBudget(samples_.back(), budgetMB_) && withinBudget_;
+            nextSample += sampleInterval;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(SOAK_TICK_INTERVAL_MS));
+    }
+
+    listeners_.Remove(listenerID);
+    executor_.Stop();
+    samples_.push_back(FootprintReporter::Sample());
+
+    VoicemeeterExecutor::Stats stats = executor_.GetStats();
+    LOG_INFO("[SoakTest::Run] Ticks: " + std::to_string(ticks_) +
+             ", dispatched: " + std::to_string(dispatched_) +
+             ", commands executed: " + std::to_string(stats.executed) +
+             ", merged: " + std::to_string(stats.merged) +
+             ", pool misses: " + std::to_string(stats.poolMisses) + ".");
+    FootprintReporter::Log(samples_.back());
+    LOG_DEBUG("[SoakTest::Run] Metrics:\n" + MetricsRegistry::Instance().RenderText());
+
+    if (!running_.load()) {
+        LOG_WARNING("[SoakTest::Run] Soak test interrupted; evaluating the samples taken so far.");
+    }
+
+    bool passed = Evaluate() && withinBudget_;
+    if (passed) {
+        LOG_INFO("[SoakTest::Run] Soak test passed.");
+    } else {
+        LOG_ERROR("[SoakTest::Run] Soak test failed.");
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void SoakTest::Tick() {
+    ++ticks_;
+
+    // Windows side: a slow sweep up and down, as if the user dragged the slider.
+    uint64_t phase = ticks_ % WINDOWS_SWEEP_TICKS;
+    float windowsVolume = static_cast<float>(phase <= WINDOWS_SWEEP_TICKS / 2 ? phase : WINDOWS_SWEEP_TICKS - phase);
+    MirrorLogic::Action action = MirrorLogic::ApplyWindowsSample(state_, windowsVolume, false);
+    if (action.kind == MirrorLogic::Action::Kind::UpdateVoicemeeter) {
+        float volume = action.volume;
+        bool mute = action.mute;
+        executor_.Post("SoakSetVolume", [this, volume, mute]() {
+            channel_.volume = volume;
+            channel_.mute = mute;
+            return true;
+        }, COMMAND_DEADLINE, SIMULATED_VOLUME_MERGE_KEY);
+    }
+
+    // Voicemeeter side: the fader moves and is picked up by two polls.
+    if (ticks_ % FADER_MOVE_TICKS == 0) {
+        float fader = static_cast<float>((ticks_ / FADER_MOVE_TICKS) % 100);
+        bool faderMute = (ticks_ / FADER_MOVE_TICKS) % 7 == 0;
+        executor_.Post("SoakMoveFader", [this, fader, faderMute]() {
+            channel_.volume = fader;
+            channel_.mute = faderMute;
+            return true;
+        }, COMMAND_DEADLINE);
+
+        for (int poll = 0; poll < 2; ++poll) {
+            SimulatedChannel observed = executor_.Execute("SoakPoll", [this]() { return channel_; },
+                                                          COMMAND_DEADLINE, SimulatedChannel{});
+            action = MirrorLogic::ApplyVoicemeeterSample(state_, observed.volume, observed.mute);
+            if (action.kind == MirrorLogic::Action::Kind::UpdateWindows) {
+                listeners_.Dispatch(action.volume, action.mute);
+            }
+        }
+    }
+
+    if (ticks_ % LISTENER_CHURN_TICKS == 0) {
+        CallbackID id = listeners_.Add([](float, bool) {});
+        listeners_.Remove(id);
+    }
+
+    if (ticks_ % PROGRESS_LOG_TICKS == 0) {
+        LOG_DEBUG("[SoakTest::Tick] Tick " + std::to_string(ticks_) +
+                  ", generation " + std::to_string(state_.generation) + ".");
+    }
+}
+
+bool SoakTest::Evaluate() const {
+    size_t count = samples_.size();
+    size_t warmup = std::max<size_t>(1, count / 10);
+    if (count < warmup + 4) {
+        LOG_WARNING("[SoakTest::Evaluate] Run too short to judge growth (" + std::to_string(count) + " samples).");
+        return true;
+    }
+
+    // Compare the peak of the first quarter after warm-up with the floor of
+    // the last quarter: only growth that never gives memory back counts.
+    size_t quarter = (count - warmup) / 4;
+    auto growth = [&](auto field) {
+        int64_t baseline = field(samples_[warmup]);
+        for (size_t i = warmup; i < warmup + quarter; ++i) {
+            baseline = std::max(baseline, field(samples_[i]));
+        }
+        int64_t floor = field(samples_[count - 1]);
+        for (size_t i = count - quarter; i < count; ++i) {
+            floor = std::min(floor, field(samples_[i]));
+        }
+        return floor - baseline;
+    };
+
+    bool passed = true;
+    auto check = [&](const char* what, int64_t grown, int64_t limit) {
+        LOG_INFO(std::string("[SoakTest::Evaluate] ") + what + " growth: " + std::to_string(grown) + ".");
+        if (grown > limit) {
+            LOG_ERROR(std::string("[SoakTest::Evaluate] ") + what + " grew past the limit of " +
+                      std::to_string(limit) + ".");
+            passed = false;
+        }
+    };
+
+    const int64_t limit = static_cast<int64_t>(SOAK_GROWTH_LIMIT_BYTES);
+    check("Private bytes", growth([](const Footprint& f) { return static_cast<int64_t>(f.privateBytes); }), limit);
+    check("Threads", growth([](const Footprint& f) { return static_cast<int64_t>(f.threadCount); }), 0);
+    if (AllocationTracker::IsEnabled()) {
+        check("Tracked heap bytes", growth([](const Footprint& f) { return f.TrackedHeapBytes(); }), limit);
+    }
+    return passed;
+}
@@ -1,7 +1,7 @@
 // SoundManager.cpp
 #include "SoundManager.h"
 #include <Windows.h>
-#include <future> // For std::async
+#include "AllocationTracker.h"
 #include "VolumeUtils.h"
 #include <atomic> // For thread-safe flags
 
@@ -13,14 +13,40 @@ SoundManager& SoundManager::Instance() {
 
 // Initialize SoundManager with sound paths
 void SoundManager::Initialize(const std::wstring& startupSoundPath, const std::wstring& syncSoundPath) {
+    AllocationScope allocationScope(AllocationSubsystem::Sound);
+    std::lock_guard<ProfiledMutex> lock(playMutex_);
     startupSoundPath_ = startupSoundPath;
     syncSoundPath_ = syncSoundPath;
     LOG_INFO("[SoundManager::Initialize] SoundManager initialized with provided sound paths.");
 }
 
+// The playback thread is only started by the first asynchronous sound
+bool SoundManager::EnsurePlaybackThread() {
+    if (playbackReady_.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(playMutex_);
+    if (!playbackThread_.joinable()) {
+        playbackEvent_ = RAIIHandle(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+        if (!playbackEvent_.get()) {
+            LOG_ERROR("[SoundManager::EnsurePlaybackThread] Failed to create playback event. Error: " + std::to_string(GetLastError()));
+            return false;
+        }
+        playbackThread_ = std::thread(&SoundManager::PlaybackThreadProc, this);
+        playbackReady_.store(true, std::memory_order_release);
+        LOG_DEBUG("[SoundManager::EnsurePlaybackThread] Playback thread started.");
+    }
+    return true;
+}
+
 // Destructor
 SoundManager::~SoundManager() {
     shuttingDown_ = true;
+    if (playbackThread_.joinable()) {
+        SetEvent(playbackEvent_.get());
+        playbackThread_.join();
+    }
     LOG_INFO("[SoundManager::~SoundManager] SoundManager shut down gracefully.");
 }
 
@@ -46,49 +72,71 @@ bool SoundManager::PlaySyncSound(uint16_t delayMs) {
 // Play Sound Internally
 bool SoundManager::PlaySoundInternal(const std::wstring& soundFilePath, uint16_t delayMs, bool playSync) {
     if (shuttingDown_) {
-        LOG_WARNING(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Shutdown in progress. Aborting sound playback."));
+        LOG_WARNING("[SoundManager::PlaySoundInternal] Shutdown in progress. Aborting sound playback.");
         return false;
     }
 
-    auto playSound = [this, soundFilePath, delayMs, playSync]() {
-        if (delayMs > 0) {
-            LOG_DEBUG(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Delaying sound playback by " + std::to_wstring(delayMs) + L" ms."));
-            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
-        }
+    if (playSync) {
+        PlayNow(soundFilePath, delayMs, true); // Synchronous playback
+        return true;
+    }
 
-        if (soundFilePath.empty()) {
-            LOG_ERROR(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Sound file path is empty."));
-            return;
-        }
+    // Asynchronous playback
+    if (!EnsurePlaybackThread()) {
+        LOG_WARNING("[SoundManager::PlaySoundInternal] Playback thread not running. Skipping asynchronous sound.");
+        return false;
+    }
 
-        DWORD fileAttrib = GetFileAttributesW(soundFilePath.c_str());
-        if (fileAttrib == INVALID_FILE_ATTRIBUTES || (fileAttrib & FILE_ATTRIBUTE_DIRECTORY)) {
-            LOG_ERROR(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Sound file does not exist or is a directory: " + soundFilePath));
-            return;
-        }
+    pendingDelayMs_.store(delayMs, std::memory_order_relaxed);
+    pendingSound_.store(&soundFilePath, std::memory_order_release);
+    SetEvent(playbackEvent_.get());
+    LOG_DEBUG("[SoundManager::PlaySoundInternal] Asynchronous sound playback queued.");
+    return true;
+}
 
-        LOG_INFO(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Playing sound: " + soundFilePath + (playSync ? L" synchronously." : L" asynchronously.")));
-        BOOL result = PlaySoundW(soundFilePath.c_str(), NULL, SND_FILENAME | (playSync ? SND_SYNC : SND_ASYNC));
-        if (!result) {
-            LOG_ERROR(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Failed to play sound. Error code: " + std::to_wstring(GetLastError())));
-        } else {
-            LOG_INFO(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Sound played successfully."));
+void SoundManager::PlaybackThreadProc() {
+    AllocationScope allocationScope(AllocationSubsystem::Sound);
+    while (true) {
+        WaitForSingleObject(playbackEvent_.get(), INFINITE);
+        if (shuttingDown_) {
+            break;
         }
 
-        // Only purge if the sound was played synchronously
-        if (playSync) {
-            PlaySoundW(NULL, NULL, SND_PURGE);
-            LOG_DEBUG("[SoundManager::PlaySoundInternal] Purged sound playback.");
+        const std::wstring* soundFilePath = pendingSound_.exchange(nullptr, std::memory_order_acq_rel);
+        if (soundFilePath) {
+            PlayNow(*soundFilePath, pendingDelayMs_.load(std::memory_order_relaxed), false);
         }
-    };
+    }
+}
 
-    if (playSync) {
-        playSound(); // Synchronous playback
+void SoundManager::PlayNow(const std::wstring& soundFilePath, uint16_t delayMs, bool playSync) {
+    if (delayMs > 0) {
+        LOG_DEBUG("[SoundManager::PlaySoundInternal] Delaying sound playback by " + std::to_string(delayMs) + " ms.");
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+
+    if (soundFilePath.empty()) {
+        LOG_ERROR("[SoundManager::PlaySoundInternal] Sound file path is empty.");
+        return;
+    }
+
+    DWORD fileAttrib = GetFileAttributesW(soundFilePath.c_str());
+    if (fileAttrib == INVALID_FILE_ATTRIBUTES || (fileAttrib & FILE_ATTRIBUTE_DIRECTORY)) {
+        LOG_ERROR(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Sound file does not exist or is a directory: " + soundFilePath));
+        return;
+    }
+
+    LOG_DEBUG(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Playing sound: " + soundFilePath + (playSync ? L" synchronously." : L" asynchronously.")));
+    BOOL result = PlaySoundW(soundFilePath.c_str(), NULL, SND_FILENAME | (playSync ? SND_SYNC : SND_ASYNC));
+    if (!result) {
+        LOG_ERROR("[SoundManager::PlaySoundInternal] Failed to play sound. Error code: " + std::to_string(GetLastError()));
     } else {
-        // Asynchronous playback
-        std::future<void> asyncResult = std::async(std::launch::async, playSound);
-        LOG_INFO(VolumeUtils::ConvertWStringToString(L"[SoundManager::PlaySoundInternal] Asynchronous sound playback started."));
+        LOG_INFO("[SoundManager::PlaySoundInternal] Sound played successfully.");
     }
 
-    return true;
+    // Only purge if the sound was played synchronously
+    if (playSync) {
+        PlaySoundW(NULL, NULL, SND_PURGE);
+        LOG_DEBUG("[SoundManager::PlaySoundInternal] Purged sound playback.");
+    }
 }
@@ -0,0 +1,191 @@
+// StateCache.cpp
+#include "StateCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#include "AllocationTracker.h"
+#include "Logger.h"
+#include "MirrorState.h"
+
+namespace {
+constexpr uint32_t STATE_CACHE_MAGIC = 0x53524D56;  // "VMRS"
+constexpr uint16_t STATE_CACHE_VERSION = 1;
+
+void CopyString(char* destination, size_t capacity, const std::string& source) {
+    size_t length = (std::min)(source.size(), capacity - 1);
+    std::memcpy(destination, source.data(), length);
+    std::memset(destination + length, 0, capacity - length);
+}
+
+uint64_t NowUnixMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+}  // namespace
+
+StateCache& StateCache::Instance() {
+    static StateCache instance;
+    return instance;
+}
+
+StateCache::~StateCache() {
+    Close();
+}
+
+uint32_t StateCache::Checksum(const CachedState& state) {
+    // FNV-1a
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(CachedState, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool StateCache::Open(const Config& config) {
+    AllocationScope allocationScope(AllocationSubsystem::Cache);
+    std::lock_guard<ProfiledMutex> lock(writeMutex_);
+    if (view_) {
+        return true;
+    }
+
+    current_ = {};
+    current_.magic = STATE_CACHE_MAGIC;
+    current_.version = STATE_CACHE_VERSION;
+    current_.size = sizeof(CachedState);
+    current_.channelIndex = config.index.value;
+    current_.channelType = static_cast<uint8_t>(std::strcmp(config.type.value, "input") == 0 ? ChannelType::Input : ChannelType::Output);
+    current_.voicemeeterType = config.voicemeeterType.value;
+    CopyString(current_.monitorDeviceUUID, sizeof(current_.monitorDeviceUUID), config.monitorDeviceUUID.value);
+    CopyString(current_.toggleParam, sizeof(current_.toggleParam), config.toggleParam.value);
+
+    const std::string& path = config.stateFilePath.value;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_WARNING("[StateCache::Open] Failed to open state file " + path + ". Error: " + std::to_string(GetLastError()));
+        return false;
+    }
+    file_ = RAIIHandle(file);
+
+    mapping_ = RAIIHandle(CreateFileMappingA(file_.get(), nullptr, PAGE_READWRITE, 0, sizeof(CachedState), nullptr));
+    if (!mapping_.get()) {
+        LOG_WARNING("[StateCache::Open] Failed to map state file. Error: " + std::to_string(GetLastError()));
+        file_ = RAIIHandle();
+        return false;
+    }
+
+    view_ = static_cast<CachedState*>(MapViewOfFile(mapping_.get(), FILE_MAP_ALL_ACCESS, 0, 0, sizeof(CachedState)));
+    if (!view_) {
+        LOG_WARNING("[StateCache::Open] Failed to map view of state file. Error: " + std::to_string(GetLastError()));
+        mapping_ = RAIIHandle();
+        file_ = RAIIHandle();
+        return false;
+    }
+
+    // A new file is zero-filled and fails the magic check.
+    const CachedState& cached = *view_;
+    bool valid = cached.magic == STATE_CACHE_MAGIC && cached.version == STATE_CACHE_VERSION &&
+                 cached.size == sizeof(CachedState) && cached.checksum == Checksum(cached);
+    if (!valid) {
+        LOG_INFO("[StateCache::Open] No usable cached state in " + path + ".");
+    } else if (cached.channelIndex != current_.channelIndex || cached.channelType != current_.channelType) {
+        LOG_INFO("[StateCache::Open] Cached state belongs to another channel mapping. Ignoring it.");
+    } else {
+        restorable_ = true;
+        restoredVolume_ = cached.volumePercent;
+        restoredMute_ = cached.isMuted != 0;
+        current_.volumePercent = cached.volumePercent;
+        current_.isMuted = cached.isMuted;
+        LOG_INFO("[StateCache::Open] Cached state: " + std::to_string(restoredVolume_) + "%, " +
+                 (restoredMute_ ? "muted" : "unmuted") + ".");
+    }
+
+    flushEvent_ = RAIIHandle(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+    if (flushEvent_.get()) {
+        stopping_ = false;
+        flushThread_ = std::thread(&StateCache::FlushThreadProc, this);
+    } else {
+        LOG_WARNING("[StateCache::Open] Failed to create flush event. State is written back on exit only.");
+    }
+    return true;
+}
+
+void StateCache::Close() {
+    if (flushThread_.joinable()) {
+        stopping_ = true;
+        SetEvent(flushEvent_.get());
+        flushThread_.join();
+    }
+
+    std::lock_guard<ProfiledMutex> lock(writeMutex_);
+    if (!view_) {
+        return;
+    }
+
+    FlushViewOfFile(view_, sizeof(CachedState));
+    UnmapViewOfFile(view_);
+    view_ = nullptr;
+    mapping_ = RAIIHandle();
+    file_ = RAIIHandle();
+    LOG_DEBUG("[StateCache::Close] State file closed.");
+}
+
+bool StateCache::GetRestorableVolume(float& volumePercent, bool& isMuted) const {
+    if (!restorable_) {
+        return false;
+    }
+    volumePercent = restoredVolume_;
+    isMuted = restoredMute_;
+    return true;
+}
+
+void StateCache::RecordVolume(float volumePercent, bool isMuted) {
+    volumePercent = MirrorLogic::RoundVolume(volumePercent);
+    {
+        std::lock_guard<ProfiledMutex> lock(writeMutex_);
+        if (!view_) {
+            return;
+        }
+        if (current_.volumePercent == volumePercent && current_.isMuted == static_cast<uint8_t>(isMuted) &&
+            view_->checksum == current_.checksum) {
+            return;
+        }
+
+        current_.volumePercent = volumePercent;
+        current_.isMuted = isMuted ? 1 : 0;
+        current_.savedAtMs = NowUnixMs();
+        current_.checksum = Checksum(current_);
+        std::memcpy(view_, &current_, sizeof(CachedState));
+    }
+
+    if (!dirty_.exchange(true, std::memory_order_acq_rel) && flushEvent_.get()) {
+        SetEvent(flushEvent_.get());
+    }
+}
+
+void StateCache::FlushThreadProc() {
+    AllocationScope allocationScope(AllocationSubsystem::Cache);
+    while (true) {
+        WaitForSingleObject(flushEvent_.get(), INFINITE);
+        if (stopping_) {
+            break;
+        }
+
+        // Let a burst of updates (a slider drag) settle into one flush.
+        if (WaitForSingleObject(flushEvent_.get(), STATE_CACHE_FLUSH_INTERVAL_MS) == WAIT_OBJECT_0 && stopping_) {
+            break;
+        }
+
+        // No lock: the view stays mapped until Close() has joined this thread,
+        // and holding writeMutex_ across disk I/O would stall RecordVolume().
+        dirty_.store(false, std::memory_order_release);
+        if (!FlushViewOfFile(view_, sizeof(CachedState))) {
+            LOG_WARNING("[StateCache::FlushThreadProc] FlushViewOfFile failed. Error: " + std::to_string(GetLastError()));
+        }
+    }
+}
@@ -0,0 +1,566 @@
+// StateReplicator.cpp
+// Winsock 2 has to come before windows.h, which pulls in the old winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "StateReplicator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "Logger.h"
+
+static_assert(sizeof(sockaddr_in) <= 16, "peer slots hold a sockaddr_in");
+
+namespace {
+constexpr uint8_t PACKET_MAGIC[4] = {'V', 'M', 'R', '1'};
+
+// How long the benchmark waits for one write to reach every instance
+constexpr uint32_t BENCH_CONVERGE_TIMEOUT_MS = 3000;
+// Every n-th benchmark write races a second write from another instance
+constexpr uint32_t BENCH_CONFLICT_EVERY = 10;
+// Idle time over which the benchmark measures the anti-entropy packet rate
+constexpr uint32_t BENCH_IDLE_MS = 1000;
+
+void WriteLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t ReadLittleEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void Count(Metric* metric) {
+    if (metric) {
+        metric->Add(1.0);
+    }
+}
+
+bool Resolve(const std::string& host, uint16_t port, sockaddr_in& address) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &resolved) != 0 || !resolved) {
+        return false;
+    }
+    address = *reinterpret_cast<const sockaddr_in*>(resolved->ai_addr);
+    address.sin_port = htons(port);
+    freeaddrinfo(resolved);
+    return true;
+}
+
+bool SameState(const ReplicaState& a, const ReplicaState& b) {
+    return a.lamport == b.lamport && a.origin == b.origin;
+}
+}  // namespace
+
+namespace ReplicaLogic {
+
+void Encode(const Packet& packet, uint8_t* out) {
+    uint32_t volumeBits;
+    std::memcpy(&volumeBits, &packet.state.volumePercent, sizeof(volumeBits));
+
+    std::memcpy(out, PACKET_MAGIC, sizeof(PACKET_MAGIC));
+    out[4] = static_cast<uint8_t>(packet.type);
+    out[5] = packet.state.isMuted ? 1 : 0;
+    WriteLittleEndian(out + 6, 0, 2);
+    WriteLittleEndian(out + 8, packet.sender, 4);
+    WriteLittleEndian(out + 12, packet.state.origin, 4);
+    WriteLittleEndian(out + 16, packet.sequence, 4);
+    WriteLittleEndian(out + 20, packet.state.lamport, 8);
+    WriteLittleEndian(out + 28, volumeBits, 4);
+}
+
+bool Decode(const uint8_t* data, size_t length, Packet& packet) {
+    if (length != PACKET_SIZE || std::memcmp(data, PACKET_MAGIC, sizeof(PACKET_MAGIC)) != 0 ||
+        (data[4] != static_cast<uint8_t>(PacketType::Delta) && data[4] != static_cast<uint8_t>(PacketType::Snapshot))) {
+        return false;
+    }
+    packet.type = static_cast<PacketType>(data[4]);
+    packet.state.isMuted = data[5] != 0;
+    packet.sender = static_cast<uint32_t>(ReadLittleEndian(data + 8, 4));
+    packet.state.origin = static_cast<uint32_t>(ReadLittleEndian(data + 12, 4));
+    packet.sequence = static_cast<uint32_t>(ReadLittleEndian(data + 16, 4));
+    packet.state.lamport = ReadLittleEndian(data + 20, 8);
+    uint32_t volumeBits = static_cast<uint32_t>(ReadLittleEndian(data + 28, 4));
+    std::memcpy(&packet.state.volumePercent, &volumeBits, sizeof(volumeBits));
+    return std::isfinite(packet.state.volumePercent);
+}
+
+}  // namespace ReplicaLogic
+
+StateReplicator& StateReplicator::Instance() {
+    static StateReplicator instance;
+    return instance;
+}
+
+StateReplicator::StateReplicator() : socket_(static_cast<uintptr_t>(INVALID_SOCKET)) {
+    std::random_device random;
+    do {
+        origin_ = random() ^ static_cast<uint32_t>(GetCurrentProcessId());
+    } while (origin_ == 0);
+
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    const char* help = "State replication packets by kind.";
+    deltaCounter_ = registry.Counter("voicemirror_replication_packets_total", help, "kind", "delta_sent");
+    snapshotCounter_ = registry.Counter("voicemirror_replication_packets_total", help, "kind", "snapshot_sent");
+    appliedCounter_ = registry.Counter("voicemirror_replication_packets_total", help, "kind", "applied");
+}
+
+StateReplicator::~StateReplicator() {
+    Stop();
+}
+
+bool StateReplicator::Start(uint16_t port, const std::vector<std::string>& peers, const std::string& group,
+                            uint32_t antiEntropyIntervalMs) {
+    if (running_) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("[StateReplicator::Start] WSAStartup failed.");
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        LOG_ERROR("[StateReplicator::Start] Failed to create socket. Error: " + std::to_string(WSAGetLastError()));
+        WSACleanup();
+        return false;
+    }
+
+    // Instances on one host share the group port.
+    BOOL reuse = group.empty() ? FALSE : TRUE;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    unsigned long nonBlocking = 1;
+    if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || ioctlsocket(sock, FIONBIO, &nonBlocking) != 0) {
+        LOG_ERROR("[StateReplicator::Start] Failed to bind UDP port " + std::to_string(port) + ". Error: " + std::to_string(WSAGetLastError()));
+        closesocket(sock);
+        WSACleanup();
+        return false;
+    }
+    int localLength = sizeof(local);
+    getsockname(sock, reinterpret_cast<sockaddr*>(&local), &localLength);
+    port_ = ntohs(local.sin_port);
+    socket_ = static_cast<uintptr_t>(sock);
+
+    {
+        std::lock_guard<ProfiledMutex> lock(peerMutex_);
+        peerCount_ = 0;
+    }
+    if (!group.empty()) {
+        sockaddr_in groupAddress{};
+        ip_mreq membership{};
+        int ttl = REPLICA_MULTICAST_TTL;
+        DWORD loop = 1;
+        if (!Resolve(group, port_, groupAddress) || !IN_MULTICAST(ntohl(groupAddress.sin_addr.s_addr))) {
+            LOG_ERROR("[StateReplicator::Start] Not a multicast group: " + group);
+            closesocket(sock);
+            socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+            WSACleanup();
+            return false;
+        }
+        membership.imr_multiaddr = groupAddress.sin_addr;
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char*>(&membership), sizeof(membership)) != 0) {
+            LOG_WARNING("[StateReplicator::Start] Failed to join " + group + ". Error: " + std::to_string(WSAGetLastError()));
+        }
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&ttl), sizeof(ttl));
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&loop), sizeof(loop));
+
+        std::lock_guard<ProfiledMutex> lock(peerMutex_);
+        std::memcpy(peers_[peerCount_++], &groupAddress, sizeof(groupAddress));
+    }
+    for (const std::string& peer : peers) {
+        AddPeer(peer);
+    }
+
+    antiEntropyInterval_ = std::chrono::milliseconds(antiEntropyIntervalMs);
+    running_ = true;
+    thread_ = std::thread(&StateReplicator::ThreadProc, this);
+
+    char origin[9];
+    std::snprintf(origin, sizeof(origin), "%08x", origin_);
+    LOG_INFO("[StateReplicator::Start] Replicating volume on UDP port " + std::to_string(port_) + " as " + origin + " to " +
+             (group.empty() ? std::to_string(peers.size()) + " peers." : group + "."));
+    return true;
+}
+
+void StateReplicator::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closesocket(static_cast<SOCKET>(socket_));
+    socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    WSACleanup();
+
+    Stats stats = GetStats();
+    LOG_DEBUG("[StateReplicator::Stop] Sent " + std::to_string(stats.deltasSent) + " deltas and " +
+              std::to_string(stats.snapshotsSent) + " snapshots; received " + std::to_string(stats.received) + ", applied " +
+              std::to_string(stats.applied) + ", suppressed " + std::to_string(stats.echoes) + " echoes.");
+}
+
+bool StateReplicator::AddPeer(const std::string& peer) {
+    std::string host = peer;
+    uint16_t port = port_;
+    size_t colon = peer.rfind(':');
+    if (colon != std::string::npos) {
+        host = peer.substr(0, colon);
+        port = static_cast<uint16_t>(std::strtoul(peer.c_str() + colon + 1, nullptr, 10));
+    }
+
+    sockaddr_in address{};
+    if (host.empty() || port == 0 || !Resolve(host, port, address)) {
+        LOG_ERROR("[StateReplicator::AddPeer] Cannot resolve peer " + peer + ".");
+        return false;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(peerMutex_);
+    if (peerCount_ == REPLICA_MAX_PEERS) {
+        LOG_ERROR("[StateReplicator::AddPeer] At most " + std::to_string(REPLICA_MAX_PEERS) + " peers are supported.");
+        return false;
+    }
+    std::memcpy(peers_[peerCount_++], &address, sizeof(address));
+    return true;
+}
+
+void StateReplicator::RecordVolume(float volumePercent, bool isMuted) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    ReplicaState state;
+    {
+        std::lock_guard<ProfiledMutex> lock(stateMutex_);
+        bool unchanged = state_.lamport != 0 && state_.isMuted == isMuted &&
+                         std::fabs(state_.volumePercent - volumePercent) <= REPLICA_ECHO_TOLERANCE_PERCENT;
+        if (unchanged || IsEcho(volumePercent, isMuted, now)) {
+            echoes_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        state_.lamport = ++lamport_;
+        state_.origin = origin_;
+        state_.volumePercent = volumePercent;
+        state_.isMuted = isMuted;
+        state = state_;
+    }
+    Broadcast(ReplicaLogic::PacketType::Delta, state);
+}
+
+bool StateReplicator::IsEcho(float volumePercent, bool isMuted, Clock::time_point now) const {
+    const std::chrono::milliseconds window(REPLICA_ECHO_WINDOW_MS);
+    for (const RemoteApply& apply : remoteApplies_) {
+        if (now - apply.at <= window && apply.isMuted == isMuted &&
+            std::fabs(apply.volumePercent - volumePercent) <= REPLICA_ECHO_TOLERANCE_PERCENT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StateReplicator::GetState(ReplicaState& state) const {
+    std::lock_guard<ProfiledMutex> lock(stateMutex_);
+    state = state_;
+    return state_.lamport != 0;
+}
+
+StateReplicator::Stats StateReplicator::GetStats() const {
+    Stats stats;
+    stats.deltasSent = deltasSent_.load(std::memory_order_relaxed);
+    stats.snapshotsSent = snapshotsSent_.load(std::memory_order_relaxed);
+    stats.received = received_.load(std::memory_order_relaxed);
+    stats.applied = applied_.load(std::memory_order_relaxed);
+    stats.stale = stale_.load(std::memory_order_relaxed);
+    stats.echoes = echoes_.load(std::memory_order_relaxed);
+    stats.malformed = malformed_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StateReplicator::ThreadProc() {
+    SOCKET sock = static_cast<SOCKET>(socket_);
+    // The first snapshot announces this instance; peers that are ahead answer with theirs.
+    Clock::time_point nextSnapshot = Clock::now();
+
+    while (running_.load(std::memory_order_acquire)) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        timeval timeout{0, static_cast<long>(REPLICA_POLL_INTERVAL_MS) * 1000};
+        select(static_cast<int>(sock) + 1, &readable, nullptr, nullptr, &timeout);
+        Receive();
+
+        Clock::time_point now = Clock::now();
+        if (now >= nextSnapshot) {
+            nextSnapshot = now + antiEntropyInterval_;
+            ReplicaState state;
+            GetState(state);
+            Broadcast(ReplicaLogic::PacketType::Snapshot, state);
+        }
+    }
+}
+
+void StateReplicator::Receive() {
+    uint8_t buffer[ReplicaLogic::PACKET_SIZE + 1];
+    while (true) {
+        sockaddr_in from{};
+        int fromLength = sizeof(from);
+        int received = recvfrom(static_cast<SOCKET>(socket_), reinterpret_cast<char*>(buffer), static_cast<int>(sizeof(buffer)), 0,
+                                reinterpret_cast<sockaddr*>(&from), &fromLength);
+        if (received < 0) {
+            // WSAECONNRESET reports an earlier send to a peer that is not running; keep reading.
+            if (WSAGetLastError() == WSAECONNRESET) {
+                continue;
+            }
+            return;
+        }
+
+        ReplicaLogic::Packet packet;
+        if (!ReplicaLogic::Decode(buffer, static_cast<size_t>(received), packet)) {
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (packet.sender == origin_) {
+            continue;  // Our own multicast, looped back
+        }
+        if (lossPercent_ > 0) {
+            lossSeed_ ^= lossSeed_ << 13;
+            lossSeed_ ^= lossSeed_ >> 17;
+            lossSeed_ ^= lossSeed_ << 5;
+            if (lossSeed_ % 100 < lossPercent_) {
+                lost_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        }
+        received_.fetch_add(1, std::memory_order_relaxed);
+        Merge(packet, &from);
+    }
+}
+
+void StateReplicator::Merge(const ReplicaLogic::Packet& packet, const void* from) {
+    bool applied = false;
+    bool behind = false;
+    ReplicaState state;
+    {
+        std::lock_guard<ProfiledMutex> lock(stateMutex_);
+        lamport_ = (std::max)(lamport_, packet.state.lamport);
+        if (packet.state.lamport != 0 && ReplicaLogic::Newer(packet.state, state_)) {
+            state_ = packet.state;
+            RemoteApply& apply = remoteApplies_[remoteApplyNext_];
+            remoteApplyNext_ = (remoteApplyNext_ + 1) % REPLICA_ECHO_HISTORY;
+            apply.volumePercent = packet.state.volumePercent;
+            apply.isMuted = packet.state.isMuted;
+            apply.at = Clock::now();
+            applied = true;
+        } else if (state_.lamport != 0 && ReplicaLogic::Newer(state_, packet.state)) {
+            behind = true;
+        }
+        state = state_;
+    }
+
+    if (applied) {
+        applied_.fetch_add(1, std::memory_order_relaxed);
+        Count(appliedCounter_);
+        if (onRemoteVolume) {
+            onRemoteVolume(state.volumePercent, state.isMuted);
+        }
+    } else if (behind) {
+        // The sender missed a write; answer directly instead of waiting for the next round.
+        stale_.fetch_add(1, std::memory_order_relaxed);
+        SendTo(ReplicaLogic::PacketType::Snapshot, state, from);
+    }
+}
+
+void StateReplicator::Broadcast(ReplicaLogic::PacketType type, const ReplicaState& state) {
+    uint8_t peers[REPLICA_MAX_PEERS][16];
+    size_t count;
+    {
+        std::lock_guard<ProfiledMutex> lock(peerMutex_);
+        count = peerCount_;
+        std::memcpy(peers, peers_, count * sizeof(peers_[0]));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        SendTo(type, state, peers[i]);
+    }
+}
+
+void StateReplicator::SendTo(ReplicaLogic::PacketType type, const ReplicaState& state, const void* address) {
+    ReplicaLogic::Packet packet;
+    packet.type = type;
+    packet.sender = origin_;
+    packet.sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+    packet.state = state;
+    uint8_t buffer[ReplicaLogic::PACKET_SIZE];
+    ReplicaLogic::Encode(packet, buffer);
+    sendto(static_cast<SOCKET>(socket_), reinterpret_cast<const char*>(buffer), static_cast<int>(sizeof(buffer)), 0,
+           static_cast<const sockaddr*>(address), sizeof(sockaddr_in));
+
+    if (type == ReplicaLogic::PacketType::Delta) {
+        deltasSent_.fetch_add(1, std::memory_order_relaxed);
+        Count(deltaCounter_);
+    } else {
+        snapshotsSent_.fetch_add(1, std::memory_order_relaxed);
+        Count(snapshotCounter_);
+    }
+}
+
+bool StateReplicator::Benchmark(uint32_t instances) {
+    using BenchClock = std::chrono::steady_clock;
+
+    if (instances < 2 || instances > REPLICA_BENCH_MAX_INSTANCES) {
+        LOG_ERROR("[StateReplicator::Benchmark] Instance count must be 2-" + std::to_string(REPLICA_BENCH_MAX_INSTANCES) + ".");
+        return false;
+    }
+
+    // Full mesh of unicast instances on loopback, each losing a share of what it receives.
+    std::vector<std::unique_ptr<StateReplicator>> replicas;
+    bool started = true;
+    for (uint32_t i = 0; i < instances; ++i) {
+        auto replica = std::make_unique<StateReplicator>();
+        replica->lossPercent_ = REPLICA_BENCH_LOSS_PERCENT;
+        replica->lossSeed_ = 0x9E3779B9u * (i + 1);
+        // Stands in for the mirror: a remote state reaches Windows and is reported back as a local change.
+        StateReplicator* self = replica.get();
+        replica->onRemoteVolume = [self](float volumePercent, bool isMuted) { self->RecordVolume(volumePercent, isMuted); };
+        started = started && replica->Start(0, {}, "", REPLICA_BENCH_ANTI_ENTROPY_MS);
+        replicas.push_back(std::move(replica));
+    }
+    for (size_t i = 0; i < replicas.size() && started; ++i) {
+        for (size_t j = 0; j < replicas.size(); ++j) {
+            if (i != j) {
+                started = started && replicas[i]->AddPeer("127.0.0.1:" + std::to_string(replicas[j]->Port()));
+            }
+        }
+    }
+
+    auto converged = [&replicas](ReplicaState& agreed) {
+        if (!replicas[0]->GetState(agreed)) {
+            return false;
+        }
+        for (const auto& replica : replicas) {
+            ReplicaState state;
+            if (!replica->GetState(state) || !SameState(state, agreed)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto total = [&replicas]() {
+        Stats sum;
+        for (const auto& replica : replicas) {
+            Stats stats = replica->GetStats();
+            sum.deltasSent += stats.deltasSent;
+            sum.snapshotsSent += stats.snapshotsSent;
+            sum.received += stats.received;
+            sum.applied += stats.applied;
+            sum.stale += stats.stale;
+            sum.echoes += stats.echoes;
+            sum.malformed += stats.malformed;
+            sum.lost += stats.lost;
+        }
+        return sum;
+    };
+
+    // Writes from random instances, every few of them racing a second writer.
+    // Values never repeat, so no write can be mistaken for an echo.
+    std::mt19937 random(12345);
+    std::vector<double> convergeMs;
+    convergeMs.reserve(REPLICA_BENCH_WRITES);
+    uint32_t localWrites = 0;
+    uint32_t timeouts = 0;
+    uint32_t wrongValues = 0;
+    BenchClock::time_point writeStart = BenchClock::now();
+    for (uint32_t w = 0; w < REPLICA_BENCH_WRITES && started; ++w) {
+        size_t writer = random() % instances;
+        float volume = static_cast<float>(w) * 0.25f;
+        bool muted = w % 7 == 0;
+        float raced = -1.0f;
+
+        BenchClock::time_point start = BenchClock::now();
+        replicas[writer]->RecordVolume(volume, muted);
+        ++localWrites;
+        if (w % BENCH_CONFLICT_EVERY == BENCH_CONFLICT_EVERY - 1) {
+            size_t other = (writer + 1 + random() % (instances - 1)) % instances;
+            raced = volume + 0.125f;
+            replicas[other]->RecordVolume(raced, muted);
+            ++localWrites;
+        }
+
+        ReplicaState agreed;
+        BenchClock::time_point deadline = start + std::chrono::milliseconds(BENCH_CONVERGE_TIMEOUT_MS);
+        bool done = false;
+        while (!(done = converged(agreed)) && BenchClock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (!done) {
+            ++timeouts;
+            continue;
+        }
+        convergeMs.push_back(std::chrono::duration<double, std::milli>(BenchClock::now() - start).count());
+        if ((agreed.volumePercent != volume && agreed.volumePercent != raced) || agreed.isMuted != muted) {
+            ++wrongValues;
+        }
+    }
+    double writeSeconds = std::chrono::duration<double>(BenchClock::now() - writeStart).count();
+    Stats afterWrites = total();
+
+    // Idle: only anti-entropy snapshots should flow, and no echo may turn into a delta.
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_IDLE_MS));
+    Stats afterIdle = total();
+    for (auto& replica : replicas) {
+        replica->Stop();
+    }
+    if (!started) {
+        LOG_ERROR("[StateReplicator::Benchmark] Not every instance could start.");
+        return false;
+    }
+
+    uint64_t expectedDeltas = static_cast<uint64_t>(localWrites) * (instances - 1);
+    uint64_t idleDeltas = afterIdle.deltasSent - afterWrites.deltasSent;
+    double idleRate = static_cast<double>(afterIdle.snapshotsSent - afterWrites.snapshotsSent) * 1000.0 / BENCH_IDLE_MS / instances;
+    double writeRate = static_cast<double>(afterWrites.deltasSent + afterWrites.snapshotsSent) / writeSeconds / instances;
+
+    std::sort(convergeMs.begin(), convergeMs.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[StateReplicator::Benchmark] " + std::to_string(localWrites) + " writes across " + std::to_string(instances) +
+             " instances with " + std::to_string(REPLICA_BENCH_LOSS_PERCENT) + "% loss. Convergence p50: " +
+             std::to_string(at(convergeMs, 0.5)) + " ms, p99: " + std::to_string(at(convergeMs, 0.99)) + " ms, max: " +
+             std::to_string(at(convergeMs, 1.0)) + " ms; " + std::to_string(timeouts) + " timed out.");
+    LOG_INFO("[StateReplicator::Benchmark] Packets per instance: " + std::to_string(writeRate) + "/s while writing, " +
+             std::to_string(idleRate) + "/s idle (anti-entropy every " + std::to_string(REPLICA_BENCH_ANTI_ENTROPY_MS) +
+             " ms). Deltas " + std::to_string(afterIdle.deltasSent) + " of " + std::to_string(expectedDeltas) + " expected, " +
+             std::to_string(afterIdle.snapshotsSent) + " snapshots, " + std::to_string(afterIdle.lost) + " lost, " +
+             std::to_string(afterIdle.stale) + " stale answered, " + std::to_string(afterIdle.echoes) + " echoes suppressed.");
+
+    bool correct = timeouts == 0 && wrongValues == 0 && idleDeltas == 0 && afterIdle.deltasSent == expectedDeltas &&
+                   afterIdle.malformed == 0;
+    if (!correct) {
+        LOG_ERROR("[StateReplicator::Benchmark] " + std::to_string(wrongValues) + " writes converged to a value nobody wrote, " +
+                  std::to_string(idleDeltas) + " deltas sent while idle.");
+    }
+    return correct;
+}
@@ -0,0 +1,859 @@
+// VbanTextClient.cpp
+// Winsock 2 has to come before windows.h, which pulls in the old winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "VbanTextClient.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "Logger.h"
+#include "VoicemeeterRemote.h"
+#include "VolumeUtils.h"
+
+static_assert(sizeof(VbanHeader) == VBAN_HEADER_SIZE, "VBAN header must match the wire format");
+static_assert(sizeof(T_VBAN_VMRT_PACKET) == expected_size_T_VBAN_VMRT_PACKET, "RT packet must match the wire format");
+
+namespace {
+constexpr size_t MAX_TEXT_SIZE = VBAN_MAX_PACKET_SIZE - VBAN_HEADER_SIZE;
+constexpr const char* REGISTER_STREAM = "Register RTP";
+constexpr const char* RT_STREAM = "Voicemeeter-RTP";
+
+const std::chrono::milliseconds STATE_TIMEOUT(VBAN_STATE_TIMEOUT_MS);
+const std::chrono::milliseconds WRITE_SETTLE(VBAN_WRITE_SETTLE_MS);
+const std::chrono::milliseconds RT_RENEW_INTERVAL(VBAN_RT_RENEW_INTERVAL_MS);
+const std::chrono::milliseconds POLL_INTERVAL(VBAN_POLL_INTERVAL_MS);
+
+// VBAN-TEXT rates, by the index carried in formatSR
+constexpr uint32_t TEXT_RATES[] = {0,      110,    150,    300,    600,     1200,    2400,    4800,
+                                   9600,   14400,  19200,  31250,  38400,   57600,   115200,  128000,
+                                   230400, 250000, 256000, 460800, 921600,  1000000, 1500000, 2000000,
+                                   3000000};
+
+// Strip routing buttons in the RT packet, in scene routing bit order (A1..A5, then B1..B3)
+constexpr unsigned long ROUTING_STATE_BITS[] = {VMRTSTATE_MODE_BUSA1, VMRTSTATE_MODE_BUSA2, VMRTSTATE_MODE_BUSA3,
+                                                VMRTSTATE_MODE_BUSA4, VMRTSTATE_MODE_BUSA5, VMRTSTATE_MODE_BUSB1,
+                                                VMRTSTATE_MODE_BUSB2, VMRTSTATE_MODE_BUSB3};
+
+// Large enough for "Strip[N].Gain=-60.00;Strip[N].Mute=1;"
+constexpr size_t VOLUME_STATEMENTS_LENGTH = 48;
+
+// Statements per script the benchmark sends, and how often it writes a bus volume instead
+constexpr uint32_t BENCH_SCRIPT_STATEMENTS = 4;
+constexpr uint32_t BENCH_VOLUME_EVERY = 8;
+// Average statement size assumed when budgeting the benchmark's send time
+constexpr uint32_t BENCH_STATEMENT_BYTES = 24;
+
+short ToDb100(float gainDb) {
+    return static_cast<short>(std::lround(std::clamp(gainDb, -327.0f, 327.0f) * 100.0f));
+}
+
+const char* TrimStatement(const char* begin, const char*& end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(end[-1]))) {
+        --end;
+    }
+    return begin;
+}
+
+// Stand-in for the remote Voicemeeter: applies VBAN-TEXT scripts to a simulated
+// Potato mixer, checks frame numbers and pacing, and answers RT registration.
+class StandInReceiver {
+public:
+    struct Result {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t statements = 0;
+        uint64_t sequenceGaps = 0;
+        uint64_t rateViolations = 0;
+        uint64_t rtPackets = 0;
+        uint64_t foreign = 0;  ///< Wrong protocol, stream name or rate
+    };
+
+    explicit StandInReceiver(uint32_t bitsPerSecond)
+        : bytesPerSecond_(bitsPerSecond / 8.0), rateIndex_(VbanProtocol::TextRateIndex(bitsPerSecond)) {
+        SceneLayout layout = SceneLogic::GetLayout(VOICEMEETER_POTATO);
+        scene_.voicemeeterType = layout.voicemeeterType;
+        scene_.stripCount = layout.stripCount;
+        scene_.busCount = layout.busCount;
+    }
+
+    ~StandInReceiver() { Stop(); }
+
+    bool Start() {
+        socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = 0;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        unsigned long nonBlocking = 1;
+        if (socket_ == INVALID_SOCKET || bind(socket_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+            ioctlsocket(socket_, FIONBIO, &nonBlocking) != 0) {
+            LOG_ERROR("[VbanTextClient::Benchmark] Failed to open the stand-in receiver.");
+            return false;
+        }
+        int localLength = sizeof(local);
+        getsockname(socket_, reinterpret_cast<sockaddr*>(&local), &localLength);
+        port_ = ntohs(local.sin_port);
+
+        running_ = true;
+        thread_ = std::thread(&StandInReceiver::ThreadProc, this);
+        return true;
+    }
+
+    void Stop() {
+        if (running_.exchange(false) && thread_.joinable()) {
+            thread_.join();
+        }
+        if (socket_ != INVALID_SOCKET) {
+            closesocket(socket_);
+            socket_ = INVALID_SOCKET;
+        }
+    }
+
+    uint16_t Port() const { return port_; }
+
+    Scene GetScene() {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        return scene_;
+    }
+
+    Result GetResult() {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        return result_;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void ThreadProc() {
+        std::vector<uint8_t> buffer(VBAN_MAX_PACKET_SIZE);
+        std::vector<uint8_t> rt(VBAN_MAX_PACKET_SIZE);
+        std::string script;
+        const std::chrono::milliseconds rtInterval(VBAN_BENCH_RT_INTERVAL_MS);
+        Clock::time_point nextRt = Clock::now();
+
+        while (running_.load(std::memory_order_acquire)) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(socket_, &readable);
+            timeval timeout{0, static_cast<long>(VBAN_POLL_INTERVAL_MS) * 1000};
+            select(static_cast<int>(socket_) + 1, &readable, nullptr, nullptr, &timeout);
+
+            while (true) {
+                sockaddr_in from{};
+                int fromLength = sizeof(from);
+                int received = recvfrom(socket_, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0,
+                                        reinterpret_cast<sockaddr*>(&from), &fromLength);
+                if (received < 0) {
+                    break;
+                }
+                Handle(buffer.data(), static_cast<size_t>(received), from, Clock::now(), script);
+            }
+
+            Clock::time_point now = Clock::now();
+            if (now >= nextRt) {
+                nextRt = now + rtInterval;
+                SendRtPacket(rt);
+            }
+        }
+    }
+
+    void Handle(const uint8_t* data, size_t length, const sockaddr_in& from, Clock::time_point now, std::string& script) {
+        VbanHeader header;
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        if (!VbanProtocol::ReadHeader(data, length, header)) {
+            ++result_.foreign;
+            return;
+        }
+
+        uint8_t protocol = header.formatSR & VbanProtocol::PROTOCOL_MASK;
+        if (protocol == VbanProtocol::PROTOCOL_SERVICE && header.formatNbc == VbanProtocol::SERVICE_RTPACKET_REGISTER) {
+            subscriber_ = from;
+            registered_ = true;
+            return;
+        }
+        if (protocol != VbanProtocol::PROTOCOL_TEXT || (header.formatSR & ~VbanProtocol::PROTOCOL_MASK) != rateIndex_ ||
+            std::strncmp(header.streamName, DEFAULT_VBAN_STREAM, VBAN_STREAM_NAME_LENGTH) != 0) {
+            ++result_.foreign;
+            return;
+        }
+
+        if (result_.packets == 0) {
+            firstPacket_ = now;
+        } else if (header.frame != expectedFrame_) {
+            ++result_.sequenceGaps;
+        }
+        expectedFrame_ = header.frame + 1;
+        ++result_.packets;
+
+        // One packet of burst is allowed by the sender's bucket, one more covers scheduling slack.
+        double allowed = 2.0 * VBAN_MAX_PACKET_SIZE + std::chrono::duration<double>(now - firstPacket_).count() * bytesPerSecond_;
+        result_.bytes += length;
+        if (static_cast<double>(result_.bytes) > allowed) {
+            ++result_.rateViolations;
+        }
+
+        script.assign(reinterpret_cast<const char*>(data) + VBAN_HEADER_SIZE, length - VBAN_HEADER_SIZE);
+        result_.statements += static_cast<uint64_t>(std::count(script.begin(), script.end(), ';'));
+        SceneLogic::ApplyScript(scene_, script);
+    }
+
+    void SendRtPacket(std::vector<uint8_t>& packet) {
+        sockaddr_in to{};
+        {
+            std::lock_guard<ProfiledMutex> lock(mutex_);
+            if (!registered_) {
+                return;
+            }
+            to = subscriber_;
+            VbanHeader header;
+            VbanProtocol::FillHeader(header, VbanProtocol::PROTOCOL_SERVICE, 0, VbanProtocol::SERVICE_RTPACKET, 0,
+                                     RT_STREAM, rtFrame_++);
+            std::memcpy(packet.data(), &header, sizeof(header));
+            size_t payload = VbanTextClient::EncodeRtPacket(scene_, packet.data() + VBAN_HEADER_SIZE, MAX_TEXT_SIZE);
+            packet.resize(VBAN_HEADER_SIZE + payload);
+            ++result_.rtPackets;
+        }
+        sendto(socket_, reinterpret_cast<const char*>(packet.data()), static_cast<int>(packet.size()), 0,
+               reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        packet.resize(VBAN_MAX_PACKET_SIZE);
+    }
+
+    double bytesPerSecond_;
+    int rateIndex_;
+    SOCKET socket_ = INVALID_SOCKET;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    ProfiledMutex mutex_{"StandInReceiver::mutex_"};
+    Scene scene_;
+    Result result_;
+    uint32_t expectedFrame_ = 0;
+    uint32_t rtFrame_ = 0;
+    Clock::time_point firstPacket_;
+    sockaddr_in subscriber_{};
+    bool registered_ = false;
+};
+}  // namespace
+
+namespace VbanProtocol {
+
+int TextRateIndex(uint32_t bitsPerSecond) {
+    for (size_t i = 1; i < std::size(TEXT_RATES); ++i) {
+        if (TEXT_RATES[i] == bitsPerSecond) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void FillHeader(VbanHeader& header, uint8_t formatSR, uint8_t nbs, uint8_t nbc, uint8_t bit,
+                const char* streamName, uint32_t frame) {
+    std::memcpy(header.magic, "VBAN", 4);
+    header.formatSR = formatSR;
+    header.formatNbs = nbs;
+    header.formatNbc = nbc;
+    header.formatBit = bit;
+    std::memset(header.streamName, 0, sizeof(header.streamName));
+    std::strncpy(header.streamName, streamName, sizeof(header.streamName));
+    header.frame = frame;
+}
+
+bool ReadHeader(const uint8_t* data, size_t length, VbanHeader& header) {
+    if (length < VBAN_HEADER_SIZE || std::memcmp(data, "VBAN", 4) != 0) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    return true;
+}
+
+}  // namespace VbanProtocol
+
+VbanTextClient::VbanTextClient() : socket_(static_cast<uintptr_t>(INVALID_SOCKET)) {
+    queue_.reserve(VBAN_TEXT_QUEUE_BYTES);
+}
+
+VbanTextClient::~VbanTextClient() {
+    Stop();
+}
+
+bool VbanTextClient::Start(const std::string& host, uint16_t port, const std::string& streamName, uint32_t bitsPerSecond) {
+    if (running_) {
+        return true;
+    }
+
+    int rateIndex = VbanProtocol::TextRateIndex(bitsPerSecond);
+    if (rateIndex < 0) {
+        LOG_ERROR("[VbanTextClient::Start] " + std::to_string(bitsPerSecond) + " bps is not a VBAN-TEXT rate.");
+        return false;
+    }
+    if (streamName.empty() || streamName.size() > VBAN_STREAM_NAME_LENGTH) {
+        LOG_ERROR("[VbanTextClient::Start] VBAN stream names are 1 to 16 characters.");
+        return false;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("[VbanTextClient::Start] WSAStartup failed.");
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &resolved) != 0 || !resolved) {
+        LOG_ERROR("[VbanTextClient::Start] Failed to resolve " + host + ".");
+        WSACleanup();
+        return false;
+    }
+    remoteIp_ = reinterpret_cast<const sockaddr_in*>(resolved->ai_addr)->sin_addr.s_addr;
+    remotePort_ = htons(port);
+    freeaddrinfo(resolved);
+
+    // RT packets come back to the port registration was sent from, so one socket does both.
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    unsigned long nonBlocking = 1;
+    if (sock == INVALID_SOCKET || bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+        ioctlsocket(sock, FIONBIO, &nonBlocking) != 0) {
+        LOG_ERROR("[VbanTextClient::Start] Failed to open UDP socket. Error: " + std::to_string(WSAGetLastError()));
+        if (sock != INVALID_SOCKET) {
+            closesocket(sock);
+        }
+        WSACleanup();
+        return false;
+    }
+    socket_ = static_cast<uintptr_t>(sock);
+
+    streamName_ = streamName;
+    rateIndex_ = static_cast<uint8_t>(rateIndex);
+    bytesPerSecond_ = bitsPerSecond / 8.0;
+    tokens_ = static_cast<double>(VBAN_MAX_PACKET_SIZE);
+    lastRefill_ = Clock::now();
+    nextRegister_ = lastRefill_;
+    frame_ = 0;
+
+    running_ = true;
+    thread_ = std::thread(&VbanTextClient::ThreadProc, this);
+    LOG_INFO("[VbanTextClient::Start] Controlling Voicemeeter at " + host + ":" + std::to_string(port) + " through VBAN-TEXT stream " +
+             streamName + " at " + std::to_string(bitsPerSecond) + " bps.");
+    return true;
+}
+
+void VbanTextClient::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closesocket(static_cast<SOCKET>(socket_));
+    socket_ = static_cast<uintptr_t>(INVALID_SOCKET);
+    WSACleanup();
+
+    Stats stats = GetStats();
+    LOG_DEBUG("[VbanTextClient::Stop] Sent " + std::to_string(stats.statements) + " statements in " + std::to_string(stats.packets) +
+              " packets, dropped " + std::to_string(stats.droppedStatements) + "; received " + std::to_string(stats.rtPackets) +
+              " RT packets.");
+}
+
+bool VbanTextClient::WaitForState(std::chrono::milliseconds timeout) {
+    Clock::time_point deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline) {
+        {
+            std::lock_guard<ProfiledMutex> lock(stateMutex_);
+            if (haveState_) {
+                return true;
+            }
+        }
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    LOG_WARNING("[VbanTextClient::WaitForState] No RT packet from the remote Voicemeeter yet.");
+    return false;
+}
+
+bool VbanTextClient::WaitForQueuedText(std::chrono::milliseconds timeout) {
+    Clock::time_point deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline) {
+        bool writesQueued = false;
+        {
+            std::lock_guard<ProfiledMutex> lock(stateMutex_);
+            for (const auto& side : writes_) {
+                for (const VolumeWrite& write : side) {
+                    writesQueued = writesQueued || write.queued;
+                }
+            }
+        }
+        if (!writesQueued && QueuedBytes() == 0) {
+            return true;
+        }
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    return false;
+}
+
+size_t VbanTextClient::QueuedBytes() const {
+    std::lock_guard<ProfiledMutex> lock(queueMutex_);
+    return queue_.size() - queueHead_;
+}
+
+VbanTextClient::Stats VbanTextClient::GetStats() const {
+    Stats stats;
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.statements = statements_.load(std::memory_order_relaxed);
+    stats.droppedStatements = droppedStatements_.load(std::memory_order_relaxed);
+    stats.rtPackets = rtPackets_.load(std::memory_order_relaxed);
+    stats.malformed = malformed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool VbanTextClient::GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<ProfiledMutex> lock(stateMutex_);
+    if (!haveState_ || now - stateTime_ > STATE_TIMEOUT) {
+        return false;
+    }
+
+    bool strip = channelType == ChannelType::Input;
+    if (channelIndex < 0 || channelIndex >= (strip ? remote_.stripCount : remote_.busCount)) {
+        return false;
+    }
+
+    const VolumeWrite& write = writes_[static_cast<size_t>(channelType)][channelIndex];
+    if (write.queued || (write.settling && now < write.settleUntil)) {
+        volumePercent = write.volumePercent;
+        isMuted = write.isMuted;
+        return true;
+    }
+
+    const ChannelSnapshot& channel = strip ? remote_.strips[channelIndex] : remote_.buses[channelIndex];
+    volumePercent = VolumeUtils::dBmToPercent(channel.gainDb);
+    isMuted = channel.mute != 0;
+    return true;
+}
+
+void VbanTextClient::UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) {
+    if (channelIndex < 0 || static_cast<size_t>(channelIndex) >= CHANNELS) {
+        LOG_ERROR("[VbanTextClient::UpdateVoicemeeterVolume] Channel index out of range: " + std::to_string(channelIndex));
+        return;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(stateMutex_);
+    VolumeWrite& write = writes_[static_cast<size_t>(channelType)][channelIndex];
+    write.queued = true;
+    write.settling = true;
+    write.volumePercent = std::round(volumePercent * 100.0f) / 100.0f;
+    write.isMuted = isMuted;
+}
+
+void VbanTextClient::ApplyParameterScript(const std::string& script) {
+    std::lock_guard<ProfiledMutex> lock(queueMutex_);
+    const char* cursor = script.data();
+    const char* end = script.data() + script.size();
+    while (cursor < end) {
+        const char* statementEnd = std::find_if(cursor, end, [](char c) { return c == ';' || c == '\n'; });
+        const char* next = statementEnd < end ? statementEnd + 1 : end;
+        const char* statement = TrimStatement(cursor, statementEnd);
+        cursor = next;
+
+        size_t length = static_cast<size_t>(statementEnd - statement);
+        if (length == 0) {
+            continue;
+        }
+        if (length + 1 > MAX_TEXT_SIZE || queue_.size() - queueHead_ + length + 1 > VBAN_TEXT_QUEUE_BYTES) {
+            droppedStatements_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // Reuse the sent prefix before the string has to grow.
+        if (queueHead_ > 0 && queue_.size() + length + 1 > queue_.capacity()) {
+            queue_.erase(0, queueHead_);
+            queueHead_ = 0;
+        }
+        queue_.append(statement, length);
+        queue_.push_back(';');
+    }
+}
+
+bool VbanTextClient::CaptureScene(Scene& scene) {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<ProfiledMutex> lock(stateMutex_);
+    if (!haveState_ || now - stateTime_ > STATE_TIMEOUT) {
+        return false;
+    }
+    scene = remote_;
+    OverlayWrites(scene, now);
+    return true;
+}
+
+void VbanTextClient::OverlayWrites(Scene& scene, Clock::time_point now) {
+    for (size_t side = 0; side < SIDES; ++side) {
+        bool strip = side == static_cast<size_t>(ChannelType::Input);
+        size_t count = strip ? scene.stripCount : scene.busCount;
+        for (size_t channel = 0; channel < count; ++channel) {
+            const VolumeWrite& write = writes_[side][channel];
+            if (write.queued || (write.settling && now < write.settleUntil)) {
+                ChannelSnapshot& snapshot = strip ? scene.strips[channel] : scene.buses[channel];
+                snapshot.gainDb = VolumeUtils::PercentToDbm(write.volumePercent);
+                snapshot.mute = write.isMuted ? 1 : 0;
+            }
+        }
+    }
+}
+
+bool VbanTextClient::DecodeRtPacket(const uint8_t* payload, size_t length, Scene& scene) {
+    if (length < sizeof(T_VBAN_VMRT_PACKET)) {
+        return false;
+    }
+    T_VBAN_VMRT_PACKET packet;
+    std::memcpy(&packet, payload, sizeof(packet));
+
+    SceneLayout layout = SceneLogic::GetLayout(packet.voicemeeterType);
+    if (layout.voicemeeterType == 0) {
+        return false;
+    }
+
+    scene = Scene();
+    scene.voicemeeterType = layout.voicemeeterType;
+    scene.stripCount = layout.stripCount;
+    scene.busCount = layout.busCount;
+    for (size_t i = 0; i < layout.stripCount; ++i) {
+        ChannelSnapshot& strip = scene.strips[i];
+        strip.gainDb = packet.stripGaindB100Layer1[i] / 100.0f;
+        strip.mute = (packet.stripState[i] & VMRTSTATE_MODE_MUTE) ? 1 : 0;
+        for (int bit = 0; bit < static_cast<int>(std::size(ROUTING_STATE_BITS)); ++bit) {
+            if (packet.stripState[i] & ROUTING_STATE_BITS[bit]) {
+                strip.routing = static_cast<uint16_t>(strip.routing | (1u << bit));
+            }
+        }
+        SceneLogic::CopyLabel(strip.label, packet.stripLabelUTF8c60[i],
+                              strnlen(packet.stripLabelUTF8c60[i], sizeof(packet.stripLabelUTF8c60[i])));
+    }
+    for (size_t i = 0; i < layout.busCount; ++i) {
+        ChannelSnapshot& bus = scene.buses[i];
+        bus.gainDb = packet.busGaindB100[i] / 100.0f;
+        bus.mute = (packet.busState[i] & VMRTSTATE_MODE_MUTE) ? 1 : 0;
+        SceneLogic::CopyLabel(bus.label, packet.busLabelUTF8c60[i],
+                              strnlen(packet.busLabelUTF8c60[i], sizeof(packet.busLabelUTF8c60[i])));
+    }
+    return true;
+}
+
+size_t VbanTextClient::EncodeRtPacket(const Scene& scene, uint8_t* payload, size_t capacity) {
+    if (capacity < sizeof(T_VBAN_VMRT_PACKET)) {
+        return 0;
+    }
+    T_VBAN_VMRT_PACKET packet;
+    std::memset(&packet, 0, sizeof(packet));
+    packet.voicemeeterType = scene.voicemeeterType;
+    packet.buffersize = 512;
+    packet.samplerate = 48000;
+    for (size_t i = 0; i < scene.stripCount; ++i) {
+        const ChannelSnapshot& strip = scene.strips[i];
+        packet.stripGaindB100Layer1[i] = ToDb100(strip.gainDb);
+        packet.stripState[i] = strip.mute ? VMRTSTATE_MODE_MUTE : 0;
+        for (int bit = 0; bit < static_cast<int>(std::size(ROUTING_STATE_BITS)); ++bit) {
+            if ((strip.routing >> bit) & 1) {
+                packet.stripState[i] |= ROUTING_STATE_BITS[bit];
+            }
+        }
+        std::memcpy(packet.stripLabelUTF8c60[i], strip.label, SCENE_LABEL_LENGTH);
+    }
+    for (size_t i = 0; i < scene.busCount; ++i) {
+        const ChannelSnapshot& bus = scene.buses[i];
+        packet.busGaindB100[i] = ToDb100(bus.gainDb);
+        packet.busState[i] = bus.mute ? VMRTSTATE_MODE_MUTE : 0;
+        std::memcpy(packet.busLabelUTF8c60[i], bus.label, SCENE_LABEL_LENGTH);
+    }
+    std::memcpy(payload, &packet, sizeof(packet));
+    return sizeof(packet);
+}
+
+void VbanTextClient::ThreadProc() {
+    SOCKET sock = static_cast<SOCKET>(socket_);
+    while (running_.load(std::memory_order_acquire)) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        timeval timeout{0, static_cast<long>(VBAN_POLL_INTERVAL_MS) * 1000};
+        select(static_cast<int>(sock) + 1, &readable, nullptr, nullptr, &timeout);
+
+        Clock::time_point now = Clock::now();
+        Receive(now);
+        if (now >= nextRegister_) {
+            Register(now);
+        }
+        SendPending(now);
+    }
+}
+
+void VbanTextClient::Receive(Clock::time_point now) {
+    uint8_t buffer[VBAN_MAX_PACKET_SIZE];
+    while (true) {
+        sockaddr_in from{};
+        int fromLength = sizeof(from);
+        int received = recvfrom(static_cast<SOCKET>(socket_), reinterpret_cast<char*>(buffer), static_cast<int>(sizeof(buffer)), 0,
+                                reinterpret_cast<sockaddr*>(&from), &fromLength);
+        if (received < 0) {
+            // WSAECONNRESET reports an earlier send to a closed port; keep reading.
+            if (WSAGetLastError() == WSAECONNRESET) {
+                continue;
+            }
+            return;
+        }
+
+        VbanHeader header;
+        Scene scene;
+        if (from.sin_addr.s_addr != remoteIp_ ||
+            !VbanProtocol::ReadHeader(buffer, static_cast<size_t>(received), header) ||
+            (header.formatSR & VbanProtocol::PROTOCOL_MASK) != VbanProtocol::PROTOCOL_SERVICE ||
+            header.formatNbc != VbanProtocol::SERVICE_RTPACKET || header.formatNbs != 0 ||
+            !DecodeRtPacket(buffer + VBAN_HEADER_SIZE, static_cast<size_t>(received) - VBAN_HEADER_SIZE, scene)) {
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        rtPackets_.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<ProfiledMutex> lock(stateMutex_);
+        if (!haveState_) {
+            LOG_INFO("[VbanTextClient::Receive] Receiving state from the remote Voicemeeter.");
+        }
+        remote_ = scene;
+        haveState_ = true;
+        stateTime_ = now;
+
+        // A sent write is confirmed once the remote shows it.
+        for (size_t side = 0; side < SIDES; ++side) {
+            bool strip = side == static_cast<size_t>(ChannelType::Input);
+            size_t count = strip ? scene.stripCount : scene.busCount;
+            for (size_t channel = 0; channel < count; ++channel) {
+                VolumeWrite& write = writes_[side][channel];
+                const ChannelSnapshot& snapshot = strip ? scene.strips[channel] : scene.buses[channel];
+                if (write.settling && !write.queued &&
+                    VolumeUtils::IsFloatEqual(VolumeUtils::dBmToPercent(snapshot.gainDb), write.volumePercent, 1) &&
+                    (snapshot.mute != 0) == write.isMuted) {
+                    write.settling = false;
+                }
+            }
+        }
+    }
+}
+
+void VbanTextClient::Register(Clock::time_point now) {
+    VbanHeader header;
+    VbanProtocol::FillHeader(header, VbanProtocol::PROTOCOL_SERVICE, 0, VbanProtocol::SERVICE_RTPACKET_REGISTER,
+                             VBAN_RT_REGISTER_TIMEOUT_S, REGISTER_STREAM, 0);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = remoteIp_;
+    to.sin_port = remotePort_;
+    sendto(static_cast<SOCKET>(socket_), reinterpret_cast<const char*>(&header), static_cast<int>(sizeof(header)), 0,
+           reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+    nextRegister_ = now + RT_RENEW_INTERVAL;
+}
+
+void VbanTextClient::SendPending(Clock::time_point now) {
+    tokens_ = (std::min)(static_cast<double>(VBAN_MAX_PACKET_SIZE),
+                         tokens_ + std::chrono::duration<double>(now - lastRefill_).count() * bytesPerSecond_);
+    lastRefill_ = now;
+
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = remoteIp_;
+    to.sin_port = remotePort_;
+
+    while (tokens_ > static_cast<double>(VBAN_HEADER_SIZE)) {
+        size_t capacity = (std::min)(MAX_TEXT_SIZE, static_cast<size_t>(tokens_) - VBAN_HEADER_SIZE);
+        uint64_t statements = 0;
+        size_t textLength = FillPacket(capacity, now, statements);
+        if (textLength == 0) {
+            return;  // Nothing queued, or the next statement has to wait for tokens.
+        }
+
+        VbanHeader header;
+        VbanProtocol::FillHeader(header, static_cast<uint8_t>(VbanProtocol::PROTOCOL_TEXT | rateIndex_), 0, 0,
+                                 VbanProtocol::TEXT_UTF8, streamName_.c_str(), frame_++);
+        std::memcpy(packet_, &header, sizeof(header));
+        size_t size = VBAN_HEADER_SIZE + textLength;
+        sendto(static_cast<SOCKET>(socket_), reinterpret_cast<const char*>(packet_), static_cast<int>(size), 0,
+               reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+
+        tokens_ -= static_cast<double>(size);
+        packets_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(size, std::memory_order_relaxed);
+        statements_.fetch_add(statements, std::memory_order_relaxed);
+    }
+}
+
+size_t VbanTextClient::FillPacket(size_t capacity, Clock::time_point now, uint64_t& statements) {
+    char* text = reinterpret_cast<char*>(packet_ + VBAN_HEADER_SIZE);
+    size_t length = 0;
+
+    {
+        std::lock_guard<ProfiledMutex> lock(stateMutex_);
+        for (size_t side = 0; side < SIDES; ++side) {
+            for (size_t channel = 0; channel < CHANNELS; ++channel) {
+                VolumeWrite& write = writes_[side][channel];
+                if (!write.queued) {
+                    continue;
+                }
+                size_t written = AppendVolumeStatements(text + length, capacity - length, channel,
+                                                        static_cast<ChannelType>(side), write);
+                if (written == 0) {
+                    return length;  // Sent with the next packet
+                }
+                length += written;
+                statements += 2;
+                write.queued = false;
+                write.settleUntil = now + WRITE_SETTLE;
+            }
+        }
+    }
+
+    std::lock_guard<ProfiledMutex> lock(queueMutex_);
+    while (queueHead_ < queue_.size()) {
+        size_t end = queue_.find(';', queueHead_);
+        size_t statementLength = end + 1 - queueHead_;
+        if (statementLength > capacity - length) {
+            break;
+        }
+        std::memcpy(text + length, queue_.data() + queueHead_, statementLength);
+        length += statementLength;
+        queueHead_ = end + 1;
+        ++statements;
+    }
+    if (queueHead_ == queue_.size()) {
+        queue_.clear();
+        queueHead_ = 0;
+    }
+    return length;
+}
+
+size_t VbanTextClient::AppendVolumeStatements(char* out, size_t capacity, size_t channel, ChannelType type, const VolumeWrite& write) {
+    char statements[VOLUME_STATEMENTS_LENGTH];
+    const char* prefix = type == ChannelType::Input ? "Strip" : "Bus";
+    int length = std::snprintf(statements, sizeof(statements), "%s[%zu].Gain=%.2f;%s[%zu].Mute=%d;", prefix, channel,
+                               VolumeUtils::PercentToDbm(write.volumePercent), prefix, channel, write.isMuted ? 1 : 0);
+    if (length <= 0 || static_cast<size_t>(length) > capacity) {
+        return 0;
+    }
+    std::memcpy(out, statements, static_cast<size_t>(length));
+    return static_cast<size_t>(length);
+}
+
+bool VbanTextClient::Benchmark(uint32_t statements) {
+    using BenchClock = std::chrono::steady_clock;
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    StandInReceiver receiver(DEFAULT_VBAN_TEXT_BPS);
+    if (!receiver.Start()) {
+        WSACleanup();
+        return false;
+    }
+
+    VbanTextClient client;
+    if (!client.Start("127.0.0.1", receiver.Port(), DEFAULT_VBAN_STREAM, DEFAULT_VBAN_TEXT_BPS) ||
+        !client.WaitForState(std::chrono::seconds(1))) {
+        receiver.Stop();
+        WSACleanup();
+        return false;
+    }
+
+    // Scripts move strip gains; every few scripts a bus volume goes through the merged write path.
+    float lastStripGain[SCENE_MAX_STRIPS];
+    std::fill(lastStripGain, lastStripGain + SCENE_MAX_STRIPS, NAN);
+    float lastBusVolume[SCENE_MAX_BUSES];
+    std::fill(lastBusVolume, lastBusVolume + SCENE_MAX_BUSES, NAN);
+    bool lastBusMute[SCENE_MAX_BUSES] = {};
+
+    std::string script;
+    char statement[32];
+    uint32_t sent = 0;
+    uint32_t round = 0;
+    BenchClock::time_point start = BenchClock::now();
+    while (sent < statements) {
+        if (round % BENCH_VOLUME_EVERY == BENCH_VOLUME_EVERY - 1) {
+            size_t bus = (round / BENCH_VOLUME_EVERY) % SCENE_MAX_BUSES;
+            lastBusVolume[bus] = static_cast<float>(round % 100);
+            lastBusMute[bus] = (round / BENCH_VOLUME_EVERY) % 2 == 1;
+            client.UpdateVoicemeeterVolume(static_cast<int>(bus), ChannelType::Output, lastBusVolume[bus], lastBusMute[bus]);
+            sent += 2;
+        } else {
+            script.clear();
+            for (uint32_t k = 0; k < BENCH_SCRIPT_STATEMENTS && sent < statements; ++k, ++sent) {
+                size_t strip = sent % SCENE_MAX_STRIPS;
+                lastStripGain[strip] = -static_cast<float>(sent % 60);
+                std::snprintf(statement, sizeof(statement), "Strip[%zu].Gain=%.1f;", strip, lastStripGain[strip]);
+                script += statement;
+            }
+            client.ApplyParameterScript(script);
+        }
+        ++round;
+
+        // Keep the queue from overflowing; the pacing is what is being measured.
+        while (client.QueuedBytes() > VBAN_TEXT_QUEUE_BYTES / 2) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+
+    auto sendBudget = std::chrono::milliseconds(2000 + static_cast<uint64_t>(statements) * BENCH_STATEMENT_BYTES * 8 * 1000 / DEFAULT_VBAN_TEXT_BPS);
+    bool drained = client.WaitForQueuedText(sendBudget);
+    double elapsedMs = std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+
+    // Let RT packets carry the final state back to the client.
+    std::this_thread::sleep_for(std::chrono::milliseconds(VBAN_BENCH_RT_INTERVAL_MS * 5) + WRITE_SETTLE);
+    Scene remote = receiver.GetScene();
+    Scene mirrored;
+    bool readBack = client.CaptureScene(mirrored);
+    Stats stats = client.GetStats();
+    client.Stop();
+    StandInReceiver::Result result = receiver.GetResult();
+    receiver.Stop();
+    WSACleanup();
+
+    bool correct = drained && readBack && result.sequenceGaps == 0 && result.rateViolations == 0 && result.foreign == 0 &&
+                   stats.droppedStatements == 0 && result.statements == stats.statements;
+    for (size_t strip = 0; strip < SCENE_MAX_STRIPS; ++strip) {
+        if (!std::isnan(lastStripGain[strip])) {
+            correct = correct && remote.strips[strip].gainDb == lastStripGain[strip] &&
+                      std::fabs(mirrored.strips[strip].gainDb - lastStripGain[strip]) < 0.01f;
+        }
+    }
+    for (size_t bus = 0; bus < SCENE_MAX_BUSES; ++bus) {
+        if (!std::isnan(lastBusVolume[bus])) {
+            float gain = VolumeUtils::PercentToDbm(lastBusVolume[bus]);
+            correct = correct && std::fabs(remote.buses[bus].gainDb - gain) < 0.01f &&
+                      (remote.buses[bus].mute != 0) == lastBusMute[bus] &&
+                      std::fabs(mirrored.buses[bus].gainDb - gain) < 0.01f && (mirrored.buses[bus].mute != 0) == lastBusMute[bus];
+        }
+    }
+
+    double seconds = elapsedMs / 1000.0;
+    LOG_INFO("[VbanTextClient::Benchmark] " + std::to_string(stats.statements) + " statements (" + std::to_string(sent) +
+             " submitted, volume writes merged) in " + std::to_string(stats.packets) + " packets over " + std::to_string(elapsedMs) +
+             " ms: " + std::to_string(seconds > 0.0 ? stats.statements / seconds : 0.0) + " statements/s, " +
+             std::to_string(seconds > 0.0 ? stats.bytes * 8 / seconds : 0.0) + " bps of " + std::to_string(DEFAULT_VBAN_TEXT_BPS) +
+             " allowed, " + std::to_string(stats.packets > 0 ? stats.bytes / stats.packets : 0) + " bytes per packet.");
+    LOG_INFO("[VbanTextClient::Benchmark] Receiver: " + std::to_string(result.packets) + " packets, " +
+             std::to_string(result.sequenceGaps) + " sequence gaps, " + std::to_string(result.rateViolations) +
+             " over the rate, " + std::to_string(result.foreign) + " foreign; " + std::to_string(result.rtPackets) +
+             " RT packets sent, " + std::to_string(stats.rtPackets) + " decoded by the client.");
+    if (!correct) {
+        LOG_ERROR("[VbanTextClient::Benchmark] Receiver or read-back state does not match the last values sent.");
+    }
+    return correct;
+}
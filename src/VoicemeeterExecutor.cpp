@@ -0,0 +1,424 @@
+// VoicemeeterExecutor.cpp
+#include "VoicemeeterExecutor.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include "AllocationTracker.h"
+#include "Metrics.h"
+
+namespace {
+// Exported counters, shared by every executor in the process.
+struct ExecutorMetrics {
+    Metric* submitted;
+    Metric* executed;
+    Metric* merged;
+    Metric* expired;
+    Metric* stalls;
+    Metric* waitTimeouts;
+    Metric* poolMisses;
+    Histogram* duration;
+};
+
+ExecutorMetrics& Metrics() {
+    static ExecutorMetrics metrics = [] {
+        MetricsRegistry& registry = MetricsRegistry::Instance();
+        const char* commands = "voicemirror_dll_commands_total";
+        const char* commandsHelp = "VoicemeeterRemote commands by outcome.";
+        ExecutorMetrics m;
+        m.submitted = registry.Counter(commands, commandsHelp, "outcome", "submitted");
+        m.executed = registry.Counter(commands, commandsHelp, "outcome", "executed");
+        m.merged = registry.Counter(commands, commandsHelp, "outcome", "merged");
+        m.expired = registry.Counter(commands, commandsHelp, "outcome", "expired");
+        m.stalls = registry.Counter(commands, commandsHelp, "outcome", "stalled");
+        m.waitTimeouts = registry.Counter(commands, commandsHelp, "outcome", "wait_timeout");
+        m.poolMisses = registry.Counter("voicemirror_dll_command_pool_misses_total",
+                                        "Commands that did not fit the preallocated pool.");
+        m.duration = registry.RegisterHistogram("voicemirror_dll_command_duration_seconds",
+                                                "Time commands spent inside VoicemeeterRemote.",
+                                                METRICS_LATENCY_BUCKETS_S, std::size(METRICS_LATENCY_BUCKETS_S));
+        return m;
+    }();
+    return metrics;
+}
+
+void Count(Metric* metric) {
+    if (metric) {
+        metric->Add(1.0);
+    }
+}
+
+// Benchmark: a stall long enough for the watchdog to report it
+constexpr std::chrono::milliseconds BENCH_DEADLINE(VOICEMEETER_COMMAND_DEADLINE_MS);
+constexpr std::chrono::milliseconds BENCH_STALL(VOICEMEETER_COMMAND_DEADLINE_MS + 4 * VOICEMEETER_WATCHDOG_INTERVAL_MS);
+// Writes queued behind the stall must outlive it
+constexpr std::chrono::milliseconds BENCH_QUEUED_DEADLINE(10000);
+// A read whose caller gives up while the stall holds the executor
+constexpr std::chrono::milliseconds BENCH_SHORT_DEADLINE(50);
+// Upper bound of the command Stop() must give up on; the benchmark releases it earlier
+constexpr std::chrono::milliseconds BENCH_HANG(4 * VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS);
+constexpr std::chrono::milliseconds BENCH_STOP_SLACK(500);
+constexpr uint32_t BENCH_MERGE_KEY = 1;
+
+// Stand-in for VoicemeeterRemote, touched on the executor thread only
+// except for the stall counter and the release event.
+struct SimulatedDll {
+    float volume = 0.0f;
+    std::atomic<uint32_t> stalls{0};
+    RAIIHandle release{CreateEventW(nullptr, TRUE, FALSE, nullptr)};
+
+    // Holds the executor thread like a hung DLL call, until released or @p limit.
+    bool Stall(std::chrono::milliseconds limit) {
+        stalls.fetch_add(1, std::memory_order_release);
+        return WaitForSingleObject(release.get(), static_cast<DWORD>(limit.count())) == WAIT_OBJECT_0;
+    }
+
+    bool WaitForStall(uint32_t count) const {
+        for (int i = 0; i < 1000 && stalls.load(std::memory_order_acquire) < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return stalls.load(std::memory_order_acquire) >= count;
+    }
+};
+}  // namespace
+
+VoicemeeterExecutor::VoicemeeterExecutor()
+    : wakeEvent_(CreateEventW(nullptr, FALSE, FALSE, nullptr)),
+      watchdogStopEvent_(CreateEventW(nullptr, TRUE, FALSE, nullptr)),
+      threadExitedEvent_(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {
+    if (!wakeEvent_.get() || !watchdogStopEvent_.get() || !threadExitedEvent_.get()) {
+        throw std::runtime_error("Failed to create VoicemeeterExecutor events");
+    }
+
+    for (PooledCommand& command : pool_) {
+        command.done = RAIIHandle(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+        if (!command.done.get()) {
+            throw std::runtime_error("Failed to create VoicemeeterExecutor command events");
+        }
+    }
+    // Register the exported metrics up front rather than on the first command.
+    Metrics();
+}
+
+VoicemeeterExecutor::~VoicemeeterExecutor() {
+    Stop();
+    // A thread left behind by Stop() is still the queue's consumer.
+    if (!IsAbandoned()) {
+        CancelPending();
+    }
+}
+
+bool VoicemeeterExecutor::Start() {
+    if (IsAbandoned()) {
+        LOG_ERROR("[VoicemeeterExecutor::Start] A previous executor thread is still stuck in VoicemeeterRemote. Not restarting.");
+        return false;
+    }
+
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        LOG_DEBUG("[VoicemeeterExecutor::Start] Executor already running.");
+        return true;
+    }
+
+    ResetEvent(watchdogStopEvent_.get());
+    ResetEvent(threadExitedEvent_.get());
+    thread_ = std::thread(&VoicemeeterExecutor::ThreadProc, this);
+    watchdogThread_ = std::thread(&VoicemeeterExecutor::WatchdogProc, this);
+    LOG_DEBUG("[VoicemeeterExecutor::Start] Executor and watchdog threads started.");
+    return true;
+}
+
+void VoicemeeterExecutor::Stop() {
+    if (IsExecutorThread()) {
+        LOG_ERROR("[VoicemeeterExecutor::Stop] Stop called from the executor thread. Ignoring.");
+        return;
+    }
+
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    SetEvent(wakeEvent_.get());
+    if (thread_.joinable()) {
+        // A DLL call that never returns must not hang shutdown with it.
+        if (WaitForSingleObject(threadExitedEvent_.get(), VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS) == WAIT_OBJECT_0) {
+            thread_.join();
+        } else {
+            const char* name = busyName_.load(std::memory_order_relaxed);
+            LOG_WARNING(std::string("[VoicemeeterExecutor::Stop] Command ") + (name ? name : "unknown") +
+                        " still inside VoicemeeterRemote after " + std::to_string(VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS) +
+                        " ms. Leaving the executor thread behind.");
+            abandoned_.store(true, std::memory_order_release);
+            thread_.detach();
+        }
+    }
+
+    SetEvent(watchdogStopEvent_.get());
+    if (watchdogThread_.joinable()) {
+        watchdogThread_.join();
+    }
+
+    // The consumer is gone, so this thread may drain the queue.
+    if (!IsAbandoned()) {
+        CancelPending();
+    }
+
+    Stats stats = GetStats();
+    LOG_DEBUG("[VoicemeeterExecutor::Stop] Executor stopped. Submitted: " + std::to_string(stats.submitted) +
+              ", executed: " + std::to_string(stats.executed) +
+              ", merged: " + std::to_string(stats.merged) +
+              ", expired: " + std::to_string(stats.expired) +
+              ", stalls: " + std::to_string(stats.stalls) +
+              ", wait timeouts: " + std::to_string(stats.waitTimeouts) +
+              ", pool misses: " + std::to_string(stats.poolMisses));
+
+    if (stats.stalls > 0 || stats.expired > 0 || stats.waitTimeouts > 0) {
+        LOG_WARNING("[VoicemeeterExecutor::Stop] VoicemeeterRemote was slow during this session. Stalls: " +
+                    std::to_string(stats.stalls) + ", expired commands: " + std::to_string(stats.expired) +
+                    ", wait timeouts: " + std::to_string(stats.waitTimeouts) +
+                    ", pool misses: " + std::to_string(stats.poolMisses));
+    }
+}
+
+VoicemeeterExecutor::Stats VoicemeeterExecutor::GetStats() const {
+    Stats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.merged = merged_.load(std::memory_order_relaxed);
+    stats.expired = expired_.load(std::memory_order_relaxed);
+    stats.stalls = stalls_.load(std::memory_order_relaxed);
+    stats.waitTimeouts = waitTimeouts_.load(std::memory_order_relaxed);
+    stats.poolMisses = poolMisses_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+VoicemeeterExecutor::PooledCommand* VoicemeeterExecutor::AcquirePooled(uint32_t refs) {
+    for (PooledCommand& command : pool_) {
+        uint32_t expected = 0;
+        if (command.refs.compare_exchange_strong(expected, refs, std::memory_order_acq_rel)) {
+            // A waiter that timed out may have left the event signalled.
+            ResetEvent(command.done.get());
+            command.status.store(PooledCommand::Status::Pending, std::memory_order_relaxed);
+            return &command;
+        }
+    }
+
+    poolMisses_.fetch_add(1, std::memory_order_relaxed);
+    Count(Metrics().poolMisses);
+    return nullptr;
+}
+
+void VoicemeeterExecutor::Enqueue(CommandBase* command) {
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    Count(Metrics().submitted);
+    queue_.Push(command);
+    SetEvent(wakeEvent_.get());
+}
+
+void VoicemeeterExecutor::RecordWaitTimeout(const char* name) {
+    waitTimeouts_.fetch_add(1, std::memory_order_relaxed);
+    Count(Metrics().waitTimeouts);
+    LOG_WARNING(std::string("[VoicemeeterExecutor::Execute] Timed out waiting for command: ") + name);
+}
+
+void VoicemeeterExecutor::ThreadProc() {
+    threadId_.store(std::this_thread::get_id(), std::memory_order_release);
+    AllocationScope allocationScope(AllocationSubsystem::Voicemeeter);
+    LOG_DEBUG("[VoicemeeterExecutor::ThreadProc] Executor thread started.");
+
+    std::vector<CommandBase*> batch;
+    batch.reserve(VOICEMEETER_EXECUTOR_BATCH_SIZE);
+
+    while (true) {
+        while (batch.size() < VOICEMEETER_EXECUTOR_BATCH_SIZE) {
+            CommandBase* command = queue_.Pop();
+            if (!command) {
+                break;
+            }
+            batch.push_back(command);
+        }
+
+        if (!batch.empty()) {
+            ExecuteBatch(batch);
+            batch.clear();
+            continue;
+        }
+
+        if (!running_.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        WaitForSingleObject(wakeEvent_.get(), INFINITE);
+    }
+
+    threadId_.store(std::thread::id(), std::memory_order_release);
+    LOG_DEBUG("[VoicemeeterExecutor::ThreadProc] Executor thread exiting.");
+    SetEvent(threadExitedEvent_.get());
+}
+
+void VoicemeeterExecutor::ExecuteBatch(std::vector<CommandBase*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+        CommandBase* command = batch[i];
+
+        if (command->mergeKey != 0 && i + 1 < batch.size() && batch[i + 1]->mergeKey == command->mergeKey) {
+            command->Supersede();
+            command->Release();
+            merged_.fetch_add(1, std::memory_order_relaxed);
+            Count(Metrics().merged);
+            continue;
+        }
+
+        Clock::time_point start = Clock::now();
+        if (start > command->deadline) {
+            LOG_WARNING(std::string("[VoicemeeterExecutor::ExecuteBatch] Command expired before execution: ") + command->name);
+            command->Cancel();
+            command->Release();
+            expired_.fetch_add(1, std::memory_order_relaxed);
+            Count(Metrics().expired);
+            continue;
+        }
+
+        busyName_.store(command->name, std::memory_order_relaxed);
+        busyDeadlineNs_.store(ToNanoseconds(command->deadline), std::memory_order_relaxed);
+        busySinceNs_.store(ToNanoseconds(start), std::memory_order_relaxed);
+        busySequence_.fetch_add(1, std::memory_order_release);
+
+        command->Run();
+
+        busySinceNs_.store(0, std::memory_order_release);
+        executed_.fetch_add(1, std::memory_order_relaxed);
+
+        Clock::time_point end = Clock::now();
+        ExecutorMetrics& metrics = Metrics();
+        Count(metrics.executed);
+        if (metrics.duration) {
+            metrics.duration->Observe(std::chrono::duration<double>(end - start).count());
+        }
+        if (end > command->deadline) {
+            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            LOG_WARNING(std::string("[VoicemeeterExecutor::ExecuteBatch] Command ") + command->name +
+                        " completed past its deadline after " + std::to_string(elapsedMs) + " ms.");
+        }
+
+        command->Release();
+    }
+}
+
+void VoicemeeterExecutor::WatchdogProc() {
+    uint64_t reportedSequence = 0;
+
+    while (WaitForSingleObject(watchdogStopEvent_.get(), VOICEMEETER_WATCHDOG_INTERVAL_MS) == WAIT_TIMEOUT) {
+        uint64_t sequence = busySequence_.load(std::memory_order_acquire);
+        int64_t since = busySinceNs_.load(std::memory_order_acquire);
+        if (since == 0 || sequence == reportedSequence) {
+            continue;
+        }
+
+        int64_t now = ToNanoseconds(Clock::now());
+        if (now <= busyDeadlineNs_.load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        reportedSequence = sequence;
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        Count(Metrics().stalls);
+        const char* name = busyName_.load(std::memory_order_relaxed);
+        LOG_WARNING(std::string("[VoicemeeterExecutor::WatchdogProc] Command ") + (name ? name : "unknown") +
+                    " stalled in VoicemeeterRemote for " + std::to_string((now - since) / 1000000) + " ms.");
+    }
+}
+
+void VoicemeeterExecutor::CancelPending() {
+    while (CommandBase* command = queue_.Pop()) {
+        command->Cancel();
+        command->Release();
+    }
+}
+
+bool VoicemeeterExecutor::Benchmark(uint32_t commands) {
+    if (commands < 1 || commands > EXECUTOR_BENCH_MAX_COMMANDS) {
+        LOG_ERROR("[VoicemeeterExecutor::Benchmark] Command count must be 1-" + std::to_string(EXECUTOR_BENCH_MAX_COMMANDS) + ".");
+        return false;
+    }
+
+    SimulatedDll dll;
+    VoicemeeterExecutor executor;
+    if (!dll.release.get() || !executor.Start()) {
+        LOG_ERROR("[VoicemeeterExecutor::Benchmark] Failed to start the executor.");
+        return false;
+    }
+
+    // Round trips through an idle executor.
+    std::vector<double> roundTrips;
+    roundTrips.reserve(commands);
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < commands; ++i) {
+        Clock::time_point start = Clock::now();
+        bool answered = executor.Execute("BenchRead", [&dll]() { return dll.volume >= 0.0f; }, BENCH_DEADLINE, false);
+        roundTrips.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        lost += answered ? 0 : 1;
+    }
+
+    // Writes queued behind a stall collapse into the newest one, a read whose
+    // caller gave up expires, and the watchdog reports the stall.
+    Stats before = executor.GetStats();
+    executor.Post("BenchStall", [&dll]() { return dll.Stall(BENCH_STALL); }, BENCH_DEADLINE);
+    bool stalled = dll.WaitForStall(1);
+    for (uint32_t i = 1; i <= commands; ++i) {
+        float volume = static_cast<float>(i);
+        executor.Post("BenchSetVolume", [&dll, volume]() {
+            dll.volume = volume;
+            return true;
+        }, BENCH_QUEUED_DEADLINE, BENCH_MERGE_KEY);
+    }
+    bool shortRead = executor.Execute("BenchShortRead", [&dll]() { return dll.volume >= 0.0f; }, BENCH_SHORT_DEADLINE, false);
+    float finalVolume = executor.Execute("BenchBarrier", [&dll]() { return dll.volume; }, BENCH_QUEUED_DEADLINE, -1.0f);
+    Stats after = executor.GetStats();
+
+    // Stop with a command that does not return in time; the write queued
+    // behind it must still run once it does.
+    const float drainVolume = -1.0f;
+    executor.Post("BenchHang", [&dll]() { return dll.Stall(BENCH_HANG); }, BENCH_DEADLINE);
+    bool hung = dll.WaitForStall(2);
+    executor.Post("BenchSetVolume", [&dll, drainVolume]() {
+        dll.volume = drainVolume;
+        return true;
+    }, BENCH_QUEUED_DEADLINE);
+    Clock::time_point stopStart = Clock::now();
+    executor.Stop();
+    auto stopMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - stopStart).count();
+    bool abandoned = executor.IsAbandoned();
+    SetEvent(dll.release.get());
+    bool exited = WaitForSingleObject(executor.threadExitedEvent_.get(), static_cast<DWORD>(BENCH_HANG.count())) == WAIT_OBJECT_0;
+    bool drained = exited && dll.volume == drainVolume;
+
+    std::sort(roundTrips.begin(), roundTrips.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    uint64_t merged = after.merged - before.merged;
+    uint64_t expired = after.expired - before.expired;
+    uint64_t stalls = after.stalls - before.stalls;
+    uint64_t waitTimeouts = after.waitTimeouts - before.waitTimeouts;
+    LOG_INFO("[VoicemeeterExecutor::Benchmark] " + std::to_string(commands) + " round trips. p50: " +
+             std::to_string(at(roundTrips, 0.5)) + " us, p99: " + std::to_string(at(roundTrips, 0.99)) +
+             " us, max: " + std::to_string(at(roundTrips, 1.0)) + " us.");
+    LOG_INFO("[VoicemeeterExecutor::Benchmark] Behind a " + std::to_string(BENCH_STALL.count()) + " ms stall: " +
+             std::to_string(merged) + " of " + std::to_string(commands) + " writes merged, " +
+             std::to_string(expired) + " expired, " + std::to_string(stalls) + " stalls reported, " +
+             std::to_string(waitTimeouts) + " wait timeouts.");
+    LOG_INFO("[VoicemeeterExecutor::Benchmark] Stop returned after " + std::to_string(stopMs) + " ms with a hung command" +
+             (abandoned ? ", thread left behind" : "") + (drained ? " and drained once released." : "."));
+
+    bool correct = lost == 0 && stalled && hung && !shortRead && finalVolume == static_cast<float>(commands) &&
+                   (commands == 1 || merged > 0) && expired >= 1 && stalls >= 1 && waitTimeouts >= 1 &&
+                   abandoned && stopMs <= (std::chrono::milliseconds(VOICEMEETER_EXECUTOR_STOP_TIMEOUT_MS) + BENCH_STOP_SLACK).count() &&
+                   drained;
+    if (!correct) {
+        LOG_ERROR("[VoicemeeterExecutor::Benchmark] " + std::to_string(lost) + " round trips lost, final volume " +
+                  std::to_string(finalVolume) + " instead of " + std::to_string(commands) + ", " +
+                  (abandoned ? "" : "Stop waited for the hung command, ") + (drained ? "" : "queued write not drained, ") +
+                  "stall " + (stalled && hung ? "seen." : "never started."));
+    }
+    return correct;
+}
@@ -1,15 +1,59 @@
 // VoicemeeterManager.cpp
 #include "VoicemeeterManager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
 #include <thread>
-#include <cmath>
 
 #include "Logger.h"
+#include "MacroButtonWatcher.h"
+#include "Metrics.h"
+#include "PhaseTimer.h"
 #include "RAIIHandle.h"
+#include "Scene.h"
 #include "VolumeUtils.h"
 
+namespace {
+const std::chrono::milliseconds COMMAND_DEADLINE(VOICEMEETER_COMMAND_DEADLINE_MS);
+const std::chrono::milliseconds INIT_DEADLINE(VOICEMEETER_INIT_DEADLINE_MS);
+const std::chrono::milliseconds SCENE_DEADLINE(SCENE_COMMAND_DEADLINE_MS);
+
+// Parameter identifiers used to build executor merge keys
+constexpr uint8_t MERGE_PARAM_VOLUME = 1;
+constexpr uint8_t MERGE_PARAM_MUTE = 2;
+
+// Large enough for "Strip[NN].Gain" and friends
+constexpr size_t CHANNEL_PARAM_LENGTH = 32;
+
+// VBVMR_MacroButton_GetStatus/SetStatus bitmodes: the button state, and its displayed state only
+constexpr long MACROBUTTON_MODE_DEFAULT = 0x00000000;
+constexpr long MACROBUTTON_MODE_STATEONLY = 0x00000002;
+
+// VBVMR_AudioCallbackRegister mode receiving every strip input and bus output
+constexpr long AUDIOCALLBACK_MAIN = 0x00000004;
+
+// Formats a per-channel parameter name into a stack buffer, without allocating.
+void FormatChannelParam(char (&buffer)[CHANNEL_PARAM_LENGTH], int channelIndex, ChannelType channelType, const char* field) {
+    std::snprintf(buffer, CHANNEL_PARAM_LENGTH, "%s[%d].%s",
+                  channelType == ChannelType::Input ? "Strip" : "Bus", channelIndex, field);
+}
+
+// Every Voicemeeter session after the first one in this process counts as a reconnect.
+void RecordSession() {
+    static std::atomic<uint64_t> sessions{0};
+    static Metric* reconnects = MetricsRegistry::Instance().Counter(
+        "voicemirror_reconnects_total", "Sessions re-established after the first.", "component", "voicemeeter");
+    if (sessions.fetch_add(1, std::memory_order_relaxed) > 0 && reconnects) {
+        reconnects->Add(1.0);
+    }
+}
+}  // namespace
+
 VoicemeeterManager::VoicemeeterManager()
     : VBVMR_Login(nullptr),
       VBVMR_Logout(nullptr),
@@ -17,13 +61,22 @@ VoicemeeterManager::VoicemeeterManager()
       VBVMR_GetVoicemeeterType(nullptr),
       VBVMR_GetVoicemeeterVersion(nullptr),
       VBVMR_IsParametersDirty(nullptr),
+      VBVMR_GetLevel(nullptr),
       VBVMR_GetParameterFloat(nullptr),
       VBVMR_GetParameterStringA(nullptr),
       VBVMR_GetParameterStringW(nullptr),
       VBVMR_SetParameterFloat(nullptr),
+      VBVMR_GetMidiMessage(nullptr),
+      VBVMR_SendMidiMessage(nullptr),
+      VBVMR_MacroButton_IsDirty(nullptr),
+      VBVMR_MacroButton_GetStatus(nullptr),
+      VBVMR_MacroButton_SetStatus(nullptr),
+      VBVMR_AudioCallbackRegister(nullptr),
+      VBVMR_AudioCallbackStart(nullptr),
+      VBVMR_AudioCallbackStop(nullptr),
+      VBVMR_AudioCallbackUnregister(nullptr),
       initialized(false),
-      loggedIn(false),
-      nextCallbackID_(1) {
+      loggedIn(false) {
     LOG_DEBUG("[VoicemeeterManager::VoicemeeterManager] Constructor called.");
 }
 
@@ -31,19 +84,39 @@ VoicemeeterManager::~VoicemeeterManager() {
     LOG_DEBUG("[VoicemeeterManager::~VoicemeeterManager] Destructor called.");
     Shutdown();
 }
-bool VoicemeeterManager::Initialize(int voicemeeterType) {
-    std::lock_guard<std::mutex> lock(initMutex_);
+
+uint32_t VoicemeeterManager::MakeMergeKey(uint8_t parameter, int channelIndex, ChannelType channelType) {
+    return (static_cast<uint32_t>(parameter) << 16) |
+           (static_cast<uint32_t>(channelType) << 8) |
+           static_cast<uint32_t>(channelIndex & 0xFF);
+}
+
+bool VoicemeeterManager::Initialize(int voicemeeterType, InitMode mode) {
+    std::lock_guard<ProfiledMutex> lock(initMutex_);
+    if (!executor_.Start()) {
+        LOG_ERROR("[VoicemeeterManager::Initialize] Failed to start Voicemeeter executor.");
+        return false;
+    }
+
+    return executor_.Execute("Initialize", [this, voicemeeterType, mode]() {
+        return InitializeInternal(voicemeeterType, mode);
+    }, INIT_DEADLINE);
+}
+
+bool VoicemeeterManager::InitializeInternal(int voicemeeterType, InitMode mode) {
     if (initialized) {
         LOG_WARNING("[VoicemeeterManager::Initialize] Already initialized.");
         return true;
     }
 
     LOG_DEBUG("[VoicemeeterManager::Initialize] Initialization started.");
+    PhaseTimer timer("VoicemeeterManager::Initialize");
 
     if (!LoadVoicemeeterRemote()) {
         LOG_ERROR("[VoicemeeterManager::Initialize] Failed to load VoicemeeterRemote DLL.");
         return false;
     }
+    timer.Mark("load");
 
     if (!loggedIn) {
         long loginResult = VBVMR_Login();
@@ -74,21 +147,36 @@ bool VoicemeeterManager::Initialize(int voicemeeterType) {
         }
     }
 
+    timer.Mark("login");
+
+    // Poll finely within the same overall budget; a running Voicemeeter is
+    // usually ready on the first call.
     bool parametersReady = false;
-    for (int attempt = 0; attempt < MAX_RETRIES && !parametersReady; ++attempt) {
-        long dirty = VBVMR_IsParametersDirty();
-        if (dirty == 1) {
+    const auto readyDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MAX_RETRIES * RETRY_DELAY_MS);
+    while (!parametersReady) {
+        if (VBVMR_IsParametersDirty() == 1) {
             parametersReady = true;
+        } else if (std::chrono::steady_clock::now() >= readyDeadline) {
+            break;
         } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS));
+            std::this_thread::sleep_for(std::chrono::milliseconds(READY_POLL_INTERVAL_MS));
         }
     }
 
     if (!parametersReady) {
         LOG_ERROR("[VoicemeeterManager::Initialize] Parameters not ready after retries.");
-        Shutdown();
+        ShutdownInternal();
         return false;
     }
+    timer.Mark("ready");
+    RecordSession();
+
+    if (mode == InitMode::QueryOnly) {
+        initialized = true;
+        timer.Report();
+        LOG_DEBUG("[VoicemeeterManager::Initialize] Query-only initialization completed.");
+        return true;
+    }
 
     char deviceName[512] = {0};
     float deviceSR = 0.0f;
@@ -107,12 +195,12 @@ bool VoicemeeterManager::Initialize(int voicemeeterType) {
         std::string wdmDevice = GetFirstWdmDeviceName();
         if (wdmDevice.empty()) {
             LOG_ERROR("[VoicemeeterManager::Initialize] No WDM devices found to set as A1.");
-            Shutdown();
+            ShutdownInternal();
             return false;
         }
         if (!SetA1Device(wdmDevice)) {
             LOG_ERROR("[VoicemeeterManager::Initialize] Failed to set A1 Device to WDM device.");
-            Shutdown();
+            ShutdownInternal();
             return false;
         }
 
@@ -120,6 +208,8 @@ bool VoicemeeterManager::Initialize(int voicemeeterType) {
     }
 
     initialized = true;
+    timer.Mark("A1 check");
+    timer.Report();
     LOG_DEBUG("[VoicemeeterManager::Initialize] Initialization completed successfully.");
     return true;
 }
@@ -162,6 +252,19 @@ bool VoicemeeterManager::LoadVoicemeeterRemote() {
     VBVMR_SetParameters = reinterpret_cast<T_VBVMR_SetParameters>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_SetParameters"));
     VBVMR_Output_GetDeviceNumber = reinterpret_cast<T_VBVMR_Output_GetDeviceNumber>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_Output_GetDeviceNumber"));
     VBVMR_Output_GetDeviceDescA = reinterpret_cast<T_VBVMR_Output_GetDeviceDescA>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_Output_GetDeviceDescA"));
+    // Optional: only MIDI mapping and MacroButtons bindings need these.
+    VBVMR_GetMidiMessage = reinterpret_cast<T_VBVMR_GetMidiMessage>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_GetMidiMessage"));
+    VBVMR_SendMidiMessage = reinterpret_cast<T_VBVMR_SendMidiMessage>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_SendMidiMessage"));
+    VBVMR_MacroButton_IsDirty = reinterpret_cast<T_VBVMR_MacroButton_IsDirty>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_MacroButton_IsDirty"));
+    VBVMR_MacroButton_GetStatus = reinterpret_cast<T_VBVMR_MacroButton_GetStatus>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_MacroButton_GetStatus"));
+    VBVMR_MacroButton_SetStatus = reinterpret_cast<T_VBVMR_MacroButton_SetStatus>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_MacroButton_SetStatus"));
+    // Optional: only ducking reads level meters.
+    VBVMR_GetLevel = reinterpret_cast<T_VBVMR_GetLevel>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_GetLevel"));
+    // Optional: only audio processors need the audio callback.
+    VBVMR_AudioCallbackRegister = reinterpret_cast<T_VBVMR_AudioCallbackRegister>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_AudioCallbackRegister"));
+    VBVMR_AudioCallbackStart = reinterpret_cast<T_VBVMR_AudioCallbackStart>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_AudioCallbackStart"));
+    VBVMR_AudioCallbackStop = reinterpret_cast<T_VBVMR_AudioCallbackStop>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_AudioCallbackStop"));
+    VBVMR_AudioCallbackUnregister = reinterpret_cast<T_VBVMR_AudioCallbackUnregister>(GetProcAddress(hVoicemeeterRemote.get(), "VBVMR_AudioCallbackUnregister"));
 
     if (!VBVMR_Login || !VBVMR_Logout || !VBVMR_RunVoicemeeter ||
         !VBVMR_GetVoicemeeterType || !VBVMR_GetVoicemeeterVersion ||
@@ -196,6 +299,16 @@ void VoicemeeterManager::UnloadVoicemeeterRemote() {
     VBVMR_SetParameters = nullptr;
     VBVMR_Output_GetDeviceNumber = nullptr;
     VBVMR_Output_GetDeviceDescA = nullptr;
+    VBVMR_GetMidiMessage = nullptr;
+    VBVMR_SendMidiMessage = nullptr;
+    VBVMR_MacroButton_IsDirty = nullptr;
+    VBVMR_MacroButton_GetStatus = nullptr;
+    VBVMR_MacroButton_SetStatus = nullptr;
+    VBVMR_GetLevel = nullptr;
+    VBVMR_AudioCallbackRegister = nullptr;
+    VBVMR_AudioCallbackStart = nullptr;
+    VBVMR_AudioCallbackStop = nullptr;
+    VBVMR_AudioCallbackUnregister = nullptr;
     initialized = false;
     LOG_DEBUG("[VoicemeeterManager::UnloadVoicemeeterRemote] Unloaded VoicemeeterRemote DLL.");
 }
@@ -238,9 +351,29 @@ bool VoicemeeterManager::SetA1Device(const std::string& deviceName) {
 }
 
 void VoicemeeterManager::Shutdown() {
-    std::lock_guard<std::mutex> lock(shutdownMutex_);
+    std::lock_guard<ProfiledMutex> lock(shutdownMutex_);
     LOG_DEBUG("[VoicemeeterManager::Shutdown] Shutdown initiated.");
 
+    if (executor_.IsRunning()) {
+        executor_.Execute("Shutdown", [this]() {
+            ShutdownInternal();
+            return true;
+        }, COMMAND_DEADLINE);
+        executor_.Stop();
+    } else if (executor_.IsAbandoned()) {
+        // The executor thread may still be inside the DLL; unloading it now would pull it out from under that call.
+        LOG_WARNING("[VoicemeeterManager::Shutdown] Executor thread is stuck in VoicemeeterRemote. Leaving the DLL loaded.");
+    } else {
+        ShutdownInternal();
+    }
+
+    LOG_DEBUG("[VoicemeeterManager::Shutdown] Shutdown completed.");
+}
+
+void VoicemeeterManager::ShutdownInternal() {
+    if (audioInsert_) {
+        StopAudioInsertInternal();
+    }
     if (loggedIn) {
         if (VBVMR_Logout) {
             long logoutResult = VBVMR_Logout();
@@ -250,37 +383,68 @@ void VoicemeeterManager::Shutdown() {
         loggedIn = false;
     }
 
-    LOG_DEBUG("[VoicemeeterManager::Shutdown] Shutdown completed.");
+    for (auto& channels : observedVolumes_) {
+        for (ObservedVolume& observed : channels) {
+            observed = ObservedVolume{};
+        }
+    }
 }
 
 void VoicemeeterManager::ShutdownCommand() {
     LOG_DEBUG("[VoicemeeterManager::ShutdownCommand] Sending shutdown command.");
-    if (VBVMR_SetParameterFloat) {
+    executor_.Execute("ShutdownCommand", [this]() {
+        if (!VBVMR_SetParameterFloat) {
+            LOG_ERROR("[VoicemeeterManager::ShutdownCommand] VBVMR_SetParameterFloat is not available.");
+            return false;
+        }
         if (VBVMR_SetParameterFloat(const_cast<char*>("Command.Shutdown"), 1.0f) != 0) {
             LOG_ERROR("[VoicemeeterManager::ShutdownCommand] Failed to send shutdown command.");
-        } else {
-            LOG_DEBUG("[VoicemeeterManager::ShutdownCommand] Shutdown command sent successfully.");
+            return false;
         }
-    } else {
-        LOG_ERROR("[VoicemeeterManager::ShutdownCommand] VBVMR_SetParameterFloat is not available.");
-    }
+        LOG_DEBUG("[VoicemeeterManager::ShutdownCommand] Shutdown command sent successfully.");
+        return true;
+    }, COMMAND_DEADLINE);
 }
 
 void VoicemeeterManager::RestartAudioEngine(int beforeRestartDelay, int afterRestartDelay) {
     LOG_DEBUG("[VoicemeeterManager::RestartAudioEngine] Restarting audio engine.");
-    std::lock_guard<std::mutex> lock(channelMutex_);
+    // Delays run on the caller so the executor stays free for other commands.
     std::this_thread::sleep_for(std::chrono::seconds(beforeRestartDelay));
-    if (VBVMR_SetParameterFloat) {
+    executor_.Execute("RestartAudioEngine", [this]() {
+        if (!VBVMR_SetParameterFloat) {
+            LOG_ERROR("[VoicemeeterManager::RestartAudioEngine] VBVMR_SetParameterFloat is not available.");
+            return false;
+        }
         VBVMR_SetParameterFloat(const_cast<char*>("Command.Restart"), 1.0f);
         LOG_DEBUG("[VoicemeeterManager::RestartAudioEngine] Restart command sent.");
-    } else {
-        LOG_ERROR("[VoicemeeterManager::RestartAudioEngine] VBVMR_SetParameterFloat is not available.");
-    }
+        return true;
+    }, COMMAND_DEADLINE);
     std::this_thread::sleep_for(std::chrono::seconds(afterRestartDelay));
     LOG_DEBUG("[VoicemeeterManager::RestartAudioEngine] Audio engine restarted.");
 }
 
 void VoicemeeterManager::ListAllChannels() {
+    executor_.Execute("ListAllChannels", [this]() {
+        ListAllChannelsInternal();
+        return true;
+    }, COMMAND_DEADLINE);
+}
+
+void VoicemeeterManager::ListInputs() {
+    executor_.Execute("ListInputs", [this]() {
+        ListInputsInternal();
+        return true;
+    }, COMMAND_DEADLINE);
+}
+
+void VoicemeeterManager::ListOutputs() {
+    executor_.Execute("ListOutputs", [this]() {
+        ListOutputsInternal();
+        return true;
+    }, COMMAND_DEADLINE);
+}
+
+void VoicemeeterManager::ListAllChannelsInternal() {
     LOG_DEBUG("[VoicemeeterManager::ListAllChannels] Listing all channels.");
 
     long voicemeeterType = 0;
@@ -381,7 +545,7 @@ void VoicemeeterManager::ListAllChannels() {
     LOG_INFO("[VoicemeeterManager::ListAllChannels] +---------+----------------------+--------------+");
 }
 
-void VoicemeeterManager::ListInputs() {
+void VoicemeeterManager::ListInputsInternal() {
     LOG_DEBUG("[VoicemeeterManager::ListInputs] Listing Voicemeeter inputs.");
 
     try {
@@ -410,7 +574,7 @@ void VoicemeeterManager::ListInputs() {
     }
 }
 
-void VoicemeeterManager::ListOutputs() {
+void VoicemeeterManager::ListOutputsInternal() {
     LOG_DEBUG("[VoicemeeterManager::ListOutputs] Listing Voicemeeter outputs.");
 
     try {
@@ -440,57 +604,95 @@ void VoicemeeterManager::ListOutputs() {
 }
 
 bool VoicemeeterManager::GetVoicemeeterVolume(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) {
-    LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Getting volume and mute state for channel index: " + std::to_string(channelIndex));
+    VolumeReading reading = executor_.Execute("GetVoicemeeterVolume", [this, channelIndex, channelType]() {
+        VolumeReading result;
+        result.ok = GetVoicemeeterVolumeInternal(channelIndex, channelType, result.volumePercent, result.isMuted);
+        return result;
+    }, COMMAND_DEADLINE);
+
+    if (!reading.ok) {
+        return false;
+    }
+    volumePercent = reading.volumePercent;
+    isMuted = reading.isMuted;
+    return true;
+}
 
-    std::lock_guard<std::mutex> lock(channelMutex_);
+bool VoicemeeterManager::GetVoicemeeterVolumeInternal(int channelIndex, ChannelType channelType, float& volumePercent, bool& isMuted) {
+    LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Getting volume and mute state for channel index: " + std::to_string(channelIndex));
 
     float gainValue = 0.0f;
     float muteValue = 0.0f;
-    std::string gainParam;
-    std::string muteParam;
+    char gainParam[CHANNEL_PARAM_LENGTH];
+    char muteParam[CHANNEL_PARAM_LENGTH];
     long dirtyParam = VBVMR_IsParametersDirty();
 
     LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] VBVMR_IsParametersDirty: " + std::to_string(dirtyParam));
 
 
-    if (channelType == ChannelType::Input) {
-        gainParam = "Strip[" + std::to_string(channelIndex) + "].Gain";
-        muteParam = "Strip[" + std::to_string(channelIndex) + "].Mute";
-    } else {
-        gainParam = "Bus[" + std::to_string(channelIndex) + "].Gain";
-        muteParam = "Bus[" + std::to_string(channelIndex) + "].Mute";
-    }
+    FormatChannelParam(gainParam, channelIndex, channelType, "Gain");
+    FormatChannelParam(muteParam, channelIndex, channelType, "Mute");
 
     if (VBVMR_GetParameterFloat &&
-        VBVMR_GetParameterFloat(const_cast<char*>(gainParam.c_str()), &gainValue) == 0) {
+        VBVMR_GetParameterFloat(gainParam, &gainValue) == 0) {
 
         volumePercent = VolumeUtils::dBmToPercent(gainValue);
         volumePercent = std::round(volumePercent * 100.0f) / 100.0f;
         LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Gain parameter retrieved: " + std::to_string(gainValue) + " dBm (" + std::to_string(volumePercent) + "%)");
     } else {
-        LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Failed to get Gain parameter for " + gainParam);
+        LOG_DEBUG(std::string("[VoicemeeterManager::GetVoicemeeterVolume] Failed to get Gain parameter for ") + gainParam);
         return false;
     }
 
     if (VBVMR_GetParameterFloat &&
-        VBVMR_GetParameterFloat(const_cast<char*>(muteParam.c_str()), &muteValue) == 0) {
+        VBVMR_GetParameterFloat(muteParam, &muteValue) == 0) {
         isMuted = (muteValue != 0.0f);
         LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Mute parameter retrieved: " + std::to_string(muteValue) + " (" + (isMuted ? "Muted" : "Unmuted") + ")");
     } else {
-        LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Failed to get Mute parameter for " + muteParam);
+        LOG_DEBUG(std::string("[VoicemeeterManager::GetVoicemeeterVolume] Failed to get Mute parameter for ") + muteParam);
         return false;
     }
 
     LOG_DEBUG("[VoicemeeterManager::GetVoicemeeterVolume] Volume: " + std::to_string(volumePercent) + "% (" + std::to_string(gainValue) + " dBm) " + (isMuted ? "(Muted)" : "(Unmuted)"));
+    RecordObservedVolume(channelIndex, channelType, volumePercent, isMuted);
     return true;
 }
 
+void VoicemeeterManager::RecordObservedVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) {
+    if (channelIndex < 0 || channelIndex >= MAX_OBSERVED_CHANNELS) {
+        return;
+    }
+
+    ObservedVolume& observed = observedVolumes_[static_cast<size_t>(channelType)][channelIndex];
+    bool changed = observed.valid &&
+                   (!VolumeUtils::IsFloatEqual(observed.volumePercent, volumePercent) || observed.isMuted != isMuted);
+
+    observed.valid = true;
+    observed.volumePercent = volumePercent;
+    observed.isMuted = isMuted;
+
+    if (changed) {
+        volumeListeners_.Dispatch(channelIndex, channelType, volumePercent, isMuted);
+    }
+}
+
+void VoicemeeterManager::ForgetObservedVolume(int channelIndex, ChannelType channelType) {
+    if (channelIndex >= 0 && channelIndex < MAX_OBSERVED_CHANNELS) {
+        observedVolumes_[static_cast<size_t>(channelType)][channelIndex].valid = false;
+    }
+}
+
 void VoicemeeterManager::UpdateVoicemeeterVolume(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) {
+    executor_.Post("UpdateVoicemeeterVolume", [this, channelIndex, channelType, volumePercent, isMuted]() {
+        UpdateVoicemeeterVolumeInternal(channelIndex, channelType, volumePercent, isMuted);
+        return true;
+    }, COMMAND_DEADLINE, MakeMergeKey(MERGE_PARAM_VOLUME, channelIndex, channelType));
+}
+
+void VoicemeeterManager::UpdateVoicemeeterVolumeInternal(int channelIndex, ChannelType channelType, float volumePercent, bool isMuted) {
     LOG_DEBUG("[VoicemeeterManager::UpdateVoicemeeterVolume] Updating volume and mute state for channel index: " + std::to_string(channelIndex) +
               " to " + std::to_string(volumePercent) + "% and " + (isMuted ? "Muted" : "Unmuted") + ".");
 
-    std::lock_guard<std::mutex> lock(channelMutex_);
-
     if (!VBVMR_SetParameterFloat) {
         LOG_ERROR("[VoicemeeterManager::UpdateVoicemeeterVolume] VBVMR_SetParameterFloat is not available.");
         return;
@@ -499,34 +701,76 @@ void VoicemeeterManager::UpdateVoicemeeterVolume(int channelIndex, ChannelType c
     float dBmValue = VolumeUtils::PercentToDbm(volumePercent);
     LOG_DEBUG("[VoicemeeterManager::UpdateVoicemeeterVolume] Converted " + std::to_string(volumePercent) + "% to " + std::to_string(dBmValue) + " dBm.");
 
-    std::string gainParam;
-    std::string muteParam;
+    char gainParam[CHANNEL_PARAM_LENGTH];
+    char muteParam[CHANNEL_PARAM_LENGTH];
 
-    if (channelType == ChannelType::Input) {
-        gainParam = "Strip[" + std::to_string(channelIndex) + "].Gain";
-        muteParam = "Strip[" + std::to_string(channelIndex) + "].Mute";
-    } else {
-        gainParam = "Bus[" + std::to_string(channelIndex) + "].Gain";
-        muteParam = "Bus[" + std::to_string(channelIndex) + "].Mute";
-    }
+    FormatChannelParam(gainParam, channelIndex, channelType, "Gain");
+    FormatChannelParam(muteParam, channelIndex, channelType, "Mute");
 
-    if (VBVMR_SetParameterFloat(const_cast<char*>(gainParam.c_str()), dBmValue) != 0) {
-        LOG_ERROR("[VoicemeeterManager::UpdateVoicemeeterVolume] Failed to set Gain parameter for " + gainParam);
+    if (VBVMR_SetParameterFloat(gainParam, dBmValue) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::UpdateVoicemeeterVolume] Failed to set Gain parameter for ") + gainParam);
     } else {
         LOG_DEBUG("[VoicemeeterManager::UpdateVoicemeeterVolume] Gain parameter set to " + std::to_string(dBmValue) + " dBm (" + std::to_string(volumePercent) + "%).");
     }
 
-    if (VBVMR_SetParameterFloat(const_cast<char*>(muteParam.c_str()), isMuted ? 1.0f : 0.0f) != 0) {
-        LOG_ERROR("[VoicemeeterManager::UpdateVoicemeeterVolume] Failed to set Mute parameter for " + muteParam);
+    if (VBVMR_SetParameterFloat(muteParam, isMuted ? 1.0f : 0.0f) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::UpdateVoicemeeterVolume] Failed to set Mute parameter for ") + muteParam);
     } else {
         LOG_DEBUG("[VoicemeeterManager::UpdateVoicemeeterVolume] Mute parameter set to " + std::string(isMuted ? "Muted" : "Unmuted") + ".");
     }
 
+    ForgetObservedVolume(channelIndex, channelType);
+
     LOG_DEBUG("[VoicemeeterManager::UpdateVoicemeeterVolume] Voicemeeter volume updated: " + std::to_string(volumePercent) + "% (" +
               std::to_string(dBmValue) + " dBm) " + (isMuted ? "(Muted)" : "(Unmuted)"));
 }
 
+void VoicemeeterManager::StepGain(int channelIndex, ChannelType channelType, float deltaDb) {
+    executor_.Post("StepGain", [this, channelIndex, channelType, deltaDb]() {
+        return StepGainInternal(channelIndex, channelType, deltaDb);
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::StepGainInternal(int channelIndex, ChannelType channelType, float deltaDb) {
+    if (!VBVMR_GetParameterFloat || !VBVMR_SetParameterFloat) {
+        LOG_ERROR("[VoicemeeterManager::StepGain] Parameter functions are not available.");
+        return false;
+    }
+
+    char gainParam[CHANNEL_PARAM_LENGTH];
+    FormatChannelParam(gainParam, channelIndex, channelType, "Gain");
+
+    float gainDb = 0.0f;
+    if (VBVMR_GetParameterFloat(gainParam, &gainDb) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::StepGain] Failed to get Gain parameter for ") + gainParam);
+        return false;
+    }
+
+    float steppedDb = (std::min)((std::max)(gainDb + deltaDb, static_cast<float>(DEFAULT_MIN_DBM)), static_cast<float>(DEFAULT_MAX_DBM));
+    if (VBVMR_SetParameterFloat(gainParam, steppedDb) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::StepGain] Failed to set Gain parameter for ") + gainParam);
+        return false;
+    }
+
+    // The observed reading is kept, so the next read reports the step to
+    // listeners and the mirror carries it over to Windows.
+    LOG_DEBUG(std::string("[VoicemeeterManager::StepGain] ") + gainParam + " stepped to " + std::to_string(steppedDb) + " dBm.");
+    return true;
+}
+
+void VoicemeeterManager::ToggleMute(int channelIndex, ChannelType channelType) {
+    executor_.Post("ToggleMute", [this, channelIndex, channelType]() {
+        return SetMuteInternal(channelIndex, channelType, !IsChannelMutedInternal(channelIndex, channelType));
+    }, COMMAND_DEADLINE);
+}
+
 bool VoicemeeterManager::IsParametersDirty() {
+    return executor_.Execute("IsParametersDirty", [this]() {
+        return IsParametersDirtyInternal();
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::IsParametersDirtyInternal() {
     LOG_DEBUG("[VoicemeeterManager::IsParametersDirty] Checking if parameters are dirty.");
 
     if (!loggedIn) {
@@ -562,54 +806,63 @@ bool VoicemeeterManager::IsParametersDirty() {
 }
 
 bool VoicemeeterManager::GetChannelVolume(int channelIndex, ChannelType channelType, float& volumePercent) {
+    VolumeReading reading = executor_.Execute("GetChannelVolume", [this, channelIndex, channelType]() {
+        VolumeReading result;
+        result.ok = GetChannelVolumeInternal(channelIndex, channelType, result.volumePercent);
+        return result;
+    }, COMMAND_DEADLINE);
+
+    if (!reading.ok) {
+        return false;
+    }
+    volumePercent = reading.volumePercent;
+    return true;
+}
+
+bool VoicemeeterManager::GetChannelVolumeInternal(int channelIndex, ChannelType channelType, float& volumePercent) {
     LOG_DEBUG("[VoicemeeterManager::GetChannelVolume] Getting volume for channel index: " + std::to_string(channelIndex));
 
-    std::lock_guard<std::mutex> lock(channelMutex_);
-    VoicemeeterManager::IsParametersDirty();
+    IsParametersDirtyInternal();
 
     float gainValue = 0.0f;
-    std::string gainParam;
+    char gainParam[CHANNEL_PARAM_LENGTH];
 
-    if (channelType == ChannelType::Input) {
-        gainParam = "Strip[" + std::to_string(channelIndex) + "].Gain";
-    } else {
-        gainParam = "Bus[" + std::to_string(channelIndex) + "].Gain";
-    }
+    FormatChannelParam(gainParam, channelIndex, channelType, "Gain");
 
     if (VBVMR_GetParameterFloat &&
-        VBVMR_GetParameterFloat(const_cast<char*>(gainParam.c_str()), &gainValue) == 0) {
+        VBVMR_GetParameterFloat(gainParam, &gainValue) == 0) {
         volumePercent = VolumeUtils::dBmToPercent(gainValue);
         LOG_DEBUG("[VoicemeeterManager::GetChannelVolume] Channel " + std::to_string(channelIndex) +
                   " Volume: " + std::to_string(volumePercent) + "% (" + std::to_string(gainValue) + " dBm)");
         return true;
     } else {
-        LOG_DEBUG("[VoicemeeterManager::GetChannelVolume] Failed to get Gain parameter for " + gainParam);
+        LOG_DEBUG(std::string("[VoicemeeterManager::GetChannelVolume] Failed to get Gain parameter for ") + gainParam);
         return false;
     }
 }
 
 bool VoicemeeterManager::IsChannelMuted(int channelIndex, ChannelType channelType) {
-    LOG_DEBUG("[VoicemeeterManager::IsChannelMuted] Checking mute state for channel index: " + std::to_string(channelIndex));
+    return executor_.Execute("IsChannelMuted", [this, channelIndex, channelType]() {
+        return IsChannelMutedInternal(channelIndex, channelType);
+    }, COMMAND_DEADLINE);
+}
 
-    std::lock_guard<std::mutex> lock(channelMutex_);
+bool VoicemeeterManager::IsChannelMutedInternal(int channelIndex, ChannelType channelType) {
+    LOG_DEBUG("[VoicemeeterManager::IsChannelMuted] Checking mute state for channel index: " + std::to_string(channelIndex));
 
     float muteValue = 0.0f;
-    std::string muteParam;
+    char muteParam[CHANNEL_PARAM_LENGTH];
 
-    if (channelType == ChannelType::Input) {
-        muteParam = "Strip[" + std::to_string(channelIndex) + "].Mute";
-    } else {
-        muteParam = "Bus[" + std::to_string(channelIndex) + "].Mute";
-    }
+    FormatChannelParam(muteParam, channelIndex, channelType, "Mute");
 
     if (VBVMR_GetParameterFloat &&
-        VBVMR_GetParameterFloat(const_cast<char*>(muteParam.c_str()), &muteValue) == 0) {
+        VBVMR_GetParameterFloat(muteParam, &muteValue) == 0) {
         bool isMuted = (muteValue != 0.0f);
         LOG_DEBUG("[VoicemeeterManager::IsChannelMuted] Channel " + std::to_string(channelIndex) +
                   " Mute State: " + (isMuted ? "Muted" : "Unmuted"));
         return isMuted;
     } else {
-        LOG_DEBUG("[VoicemeeterManager::IsChannelMuted] Failed to get Mute parameter for " + muteParam);
+        LOG_DEBUG(std::string("[VoicemeeterManager::IsChannelMuted] Failed to get Mute parameter for ") + muteParam);
         return false;
     }
 }
@@ -617,8 +870,15 @@ bool VoicemeeterManager::IsChannelMuted(int channelIndex, ChannelType channelTyp
 bool VoicemeeterManager::SetMute(int channelIndex, ChannelType channelType, bool isMuted) {
     LOG_DEBUG("[VoicemeeterManager::SetMute] Setting mute state for channel index: " + std::to_string(channelIndex) +
               " to " + (isMuted ? "Muted" : "Unmuted") + ".");
-    std::lock_guard<std::mutex> lock(channelMutex_);
-    return SetMuteInternal(channelIndex, channelType, isMuted);
+    std::future<bool> result = executor_.Submit("SetMute", [this, channelIndex, channelType, isMuted]() {
+        return SetMuteInternal(channelIndex, channelType, isMuted);
+    }, COMMAND_DEADLINE, MakeMergeKey(MERGE_PARAM_MUTE, channelIndex, channelType));
+
+    if (result.wait_for(COMMAND_DEADLINE) != std::future_status::ready) {
+        LOG_WARNING("[VoicemeeterManager::SetMute] Timed out waiting for Voicemeeter.");
+        return false;
+    }
+    return result.get();
 }
 
 bool VoicemeeterManager::SetMuteInternal(int channelIndex, ChannelType channelType, bool isMuted) {
@@ -627,38 +887,457 @@ bool VoicemeeterManager::SetMuteInternal(int channelIndex, ChannelType channelTy
         return false;
     }
 
-    std::string muteParam;
+    char muteParam[CHANNEL_PARAM_LENGTH];
 
-    if (channelType == ChannelType::Input) {
-        muteParam = "Strip[" + std::to_string(channelIndex) + "].Mute";
-    } else {
-        muteParam = "Bus[" + std::to_string(channelIndex) + "].Mute";
-    }
+    FormatChannelParam(muteParam, channelIndex, channelType, "Mute");
 
     float muteValue = isMuted ? 1.0f : 0.0f;
-    LOG_DEBUG("[VoicemeeterManager::SetMuteInternal] Setting " + muteParam + " to " + std::to_string(muteValue));
+    LOG_DEBUG(std::string("[VoicemeeterManager::SetMuteInternal] Setting ") + muteParam + " to " + std::to_string(muteValue));
 
-    long result = VBVMR_SetParameterFloat(const_cast<char*>(muteParam.c_str()), muteValue);
+    long result = VBVMR_SetParameterFloat(muteParam, muteValue);
 
     if (result != 0) {
-        LOG_ERROR("[VoicemeeterManager::SetMuteInternal] Failed to set Mute parameter for " + muteParam +
+        LOG_ERROR(std::string("[VoicemeeterManager::SetMuteInternal] Failed to set Mute parameter for ") + muteParam +
                   ". Error code: " + std::to_string(result));
         return false;
     }
 
+    ForgetObservedVolume(channelIndex, channelType);
+
     LOG_DEBUG("[VoicemeeterManager::SetMuteInternal] Channel " + std::to_string(channelIndex) +
               " mute state set to " + (isMuted ? "Muted" : "Unmuted") + ".");
     return true;
 }
 
-CallbackID VoicemeeterManager::RegisterVolumeChangeCallback(std::function<void(float, bool)> callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    CallbackID id = nextCallbackID_++;
-    volumeChangeCallbacks_[id] = callback;
+bool VoicemeeterManager::CaptureScene(Scene& scene) {
+    Scene captured = executor_.Execute("CaptureScene", [this]() {
+        return CaptureSceneInternal();
+    }, SCENE_DEADLINE);
+
+    if (captured.voicemeeterType == 0) {
+        return false;
+    }
+    scene = captured;
+    return true;
+}
+
+Scene VoicemeeterManager::CaptureSceneInternal() {
+    Scene scene;
+    long voicemeeterType = 0;
+    if (!VBVMR_GetVoicemeeterType || VBVMR_GetVoicemeeterType(&voicemeeterType) != 0) {
+        LOG_ERROR("[VoicemeeterManager::CaptureScene] Failed to get Voicemeeter type.");
+        return scene;
+    }
+
+    SceneLayout layout = SceneLogic::GetLayout(voicemeeterType);
+    if (layout.voicemeeterType == 0) {
+        LOG_ERROR("[VoicemeeterManager::CaptureScene] Unknown Voicemeeter type: " + std::to_string(voicemeeterType));
+        return scene;
+    }
+
+    // Refresh the DLL's parameter cache before reading it.
+    IsParametersDirtyInternal();
+
+    SceneLayout busLayout;
+    for (int i = 0; i < layout.stripCount; ++i) {
+        if (!CaptureChannelInternal("Strip", i, layout, scene.strips[i])) {
+            return Scene{};
+        }
+    }
+    for (int i = 0; i < layout.busCount; ++i) {
+        if (!CaptureChannelInternal("Bus", i, busLayout, scene.buses[i])) {
+            return Scene{};
+        }
+    }
+
+    scene.voicemeeterType = layout.voicemeeterType;
+    scene.stripCount = layout.stripCount;
+    scene.busCount = layout.busCount;
+    return scene;
+}
+
+bool VoicemeeterManager::CaptureChannelInternal(const char* prefix, int index, const SceneLayout& layout, ChannelSnapshot& channel) {
+    char param[CHANNEL_PARAM_LENGTH];
+    float value = 0.0f;
+
+    std::snprintf(param, sizeof(param), "%s[%d].Gain", prefix, index);
+    if (VBVMR_GetParameterFloat(param, &value) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::CaptureScene] Failed to read ") + param);
+        return false;
+    }
+    channel.gainDb = value;
+
+    std::snprintf(param, sizeof(param), "%s[%d].Mute", prefix, index);
+    if (VBVMR_GetParameterFloat(param, &value) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::CaptureScene] Failed to read ") + param);
+        return false;
+    }
+    channel.mute = value != 0.0f ? 1 : 0;
+
+    channel.routing = 0;
+    for (int button = 0; button < layout.physicalBuses + layout.virtualBuses; ++button) {
+        int bit = SceneLogic::RoutingBit(layout, button);
+        std::snprintf(param, sizeof(param), "%s[%d].%s", prefix, index, SceneLogic::RoutingField(bit));
+        if (VBVMR_GetParameterFloat(param, &value) != 0) {
+            LOG_ERROR(std::string("[VoicemeeterManager::CaptureScene] Failed to read ") + param);
+            return false;
+        }
+        if (value != 0.0f) {
+            channel.routing |= static_cast<uint16_t>(1u << bit);
+        }
+    }
+
+    // The DLL requires a 512 byte buffer for string parameters.
+    char label[512] = {0};
+    std::snprintf(param, sizeof(param), "%s[%d].Label", prefix, index);
+    if (VBVMR_GetParameterStringA(param, label) != 0) {
+        LOG_ERROR(std::string("[VoicemeeterManager::CaptureScene] Failed to read ") + param);
+        return false;
+    }
+    SceneLogic::CopyLabel(channel.label, label, std::strlen(label));
+    return true;
+}
+
+bool VoicemeeterManager::RecallScene(const Scene& scene, size_t& changedParameters) {
+    struct RecallResult {
+        bool ok = false;
+        uint32_t changed = 0;
+    };
+
+    RecallResult result = executor_.Execute("RecallScene", [this, scene]() {
+        RecallResult recall;
+        size_t changed = 0;
+        recall.ok = RecallSceneInternal(scene, changed);
+        recall.changed = static_cast<uint32_t>(changed);
+        return recall;
+    }, SCENE_DEADLINE);
+
+    changedParameters = result.changed;
+    return result.ok;
+}
+
+bool VoicemeeterManager::RecallSceneInternal(const Scene& scene, size_t& changedParameters) {
+    PhaseTimer timer("VoicemeeterManager::RecallScene");
+    changedParameters = 0;
+
+    Scene current = CaptureSceneInternal();
+    timer.Mark("capture");
+    if (current.voicemeeterType == 0) {
+        return false;
+    }
+    if (current.voicemeeterType != scene.voicemeeterType) {
+        LOG_ERROR("[VoicemeeterManager::RecallScene] Scene was captured on Voicemeeter type " +
+                  std::to_string(scene.voicemeeterType) + ", running type is " +
+                  std::to_string(current.voicemeeterType) + ".");
+        return false;
+    }
+
+    std::string script;
+    script.reserve(SCENE_RECALL_SCRIPT_RESERVE);
+    changedParameters = SceneLogic::BuildRecallScript(current, scene, script);
+    timer.Mark("diff");
+
+    if (changedParameters == 0) {
+        LOG_INFO("[VoicemeeterManager::RecallScene] Mixer already matches the scene.");
+        timer.Report();
+        return true;
+    }
+
+    LOG_DEBUG("[VoicemeeterManager::RecallScene] Script: " + script);
+    long result = VBVMR_SetParameters(script.c_str());
+    timer.Mark("apply");
+    timer.Report();
+
+    if (result != 0) {
+        LOG_ERROR("[VoicemeeterManager::RecallScene] VBVMR_SetParameters failed. Result: " + std::to_string(result));
+        return false;
+    }
+
+    LOG_INFO("[VoicemeeterManager::RecallScene] Applied " + std::to_string(changedParameters) + " changed parameters.");
+    return true;
+}
+
+void VoicemeeterManager::ApplyParameterScript(const std::string& script) {
+    executor_.Post("ApplyParameterScript", [this, script]() {
+        if (!VBVMR_SetParameters) {
+            LOG_ERROR("[VoicemeeterManager::ApplyParameterScript] VBVMR_SetParameters is not available.");
+            return false;
+        }
+        long result = VBVMR_SetParameters(script.c_str());
+        if (result != 0) {
+            LOG_ERROR("[VoicemeeterManager::ApplyParameterScript] VBVMR_SetParameters failed. Result: " + std::to_string(result));
+            return false;
+        }
+        return true;
+    }, SCENE_DEADLINE);
+}
+
+bool VoicemeeterManager::RunMidiCycle(MidiController& controller) {
+    MidiController* target = &controller;
+    return executor_.Execute("MidiCycle", [this, target]() {
+        return RunMidiCycleInternal(*target);
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::RunMidiCycleInternal(MidiController& controller) {
+    if (!loggedIn || !VBVMR_GetMidiMessage || !VBVMR_SendMidiMessage) {
+        return false;
+    }
+
+    // Drain everything received since the last cycle.
+    midiInput_.clear();
+    unsigned char buffer[MIDI_INPUT_BUFFER_SIZE];
+    for (int read = 0; read < MIDI_MAX_READS_PER_CYCLE; ++read) {
+        long received = VBVMR_GetMidiMessage(buffer, static_cast<long>(sizeof(buffer)));
+        if (received <= 0) {
+            break;
+        }
+        midiInput_.insert(midiInput_.end(), buffer, buffer + received);
+    }
+
+    // Refreshes the parameter values read below; the result is not needed.
+    VBVMR_IsParametersDirty();
+    const std::vector<std::string>& parameters = controller.TargetParameters();
+    float values[MIDI_MAX_MAPPINGS];
+    for (size_t i = 0; i < parameters.size() && i < MIDI_MAX_MAPPINGS; ++i) {
+        if (VBVMR_GetParameterFloat(const_cast<char*>(parameters[i].c_str()), &values[i]) != 0) {
+            values[i] = NAN;
+        }
+    }
+
+    controller.Process(midiInput_.data(), midiInput_.size(), values);
+
+    bool ok = true;
+    const std::string& script = controller.Script();
+    if (!script.empty()) {
+        long result = VBVMR_SetParameters(script.c_str());
+        if (result != 0) {
+            LOG_ERROR("[VoicemeeterManager::RunMidiCycle] VBVMR_SetParameters failed. Result: " + std::to_string(result));
+            ok = false;
+        }
+    }
+
+    const std::vector<uint8_t>& feedback = controller.Feedback();
+    if (!feedback.empty()) {
+        long result = VBVMR_SendMidiMessage(const_cast<unsigned char*>(feedback.data()), static_cast<long>(feedback.size()));
+        if (result < 0) {
+            LOG_DEBUG("[VoicemeeterManager::RunMidiCycle] VBVMR_SendMidiMessage failed. Result: " + std::to_string(result));
+        }
+    }
+    return ok;
+}
+
+bool VoicemeeterManager::RunMacroButtonCycle(MacroButtonWatcher& watcher) {
+    MacroButtonWatcher* target = &watcher;
+    return executor_.Execute("MacroButtonCycle", [this, target]() {
+        return RunMacroButtonCycleInternal(*target);
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::RunMacroButtonCycleInternal(MacroButtonWatcher& watcher) {
+    if (!loggedIn || !VBVMR_MacroButton_IsDirty || !VBVMR_MacroButton_GetStatus || !VBVMR_MacroButton_SetStatus) {
+        return false;
+    }
+
+    long dirty = VBVMR_MacroButton_IsDirty();
+    if (dirty < 0) {
+        // -2 while MacroButtons is not running; nothing to watch until it starts.
+        return false;
+    }
+
+    // Only the bound buttons are read, and only when something changed.
+    MacroButtonBits buttons;
+    bool readButtons = dirty > 0 || watcher.NeedsButtonRead();
+    if (readButtons) {
+        const MacroButtonBits& watched = watcher.WatchedButtons();
+        for (size_t button = 0; button < MACRO_BUTTON_COUNT; ++button) {
+            float value = 0.0f;
+            if (watched.test(button) &&
+                VBVMR_MacroButton_GetStatus(static_cast<long>(button), &value, MACROBUTTON_MODE_DEFAULT) == 0) {
+                buttons.set(button, value != 0.0f);
+            }
+        }
+    }
+
+    VBVMR_IsParametersDirty();
+    const std::vector<std::string>& parameters = watcher.TargetParameters();
+    float values[MACRO_MAX_BINDINGS];
+    for (size_t i = 0; i < parameters.size() && i < MACRO_MAX_BINDINGS; ++i) {
+        if (parameters[i].empty() ||
+            VBVMR_GetParameterFloat(const_cast<char*>(parameters[i].c_str()), &values[i]) != 0) {
+            values[i] = NAN;
+        }
+    }
+
+    watcher.Process(readButtons ? &buttons : nullptr, values);
+
+    // Lit states only; pushing with the default mode would press the button.
+    const MacroButtonBits& writeMask = watcher.WriteMask();
+    const MacroButtonBits& writeValues = watcher.WriteValues();
+    for (size_t button = 0; writeMask.any() && button < MACRO_BUTTON_COUNT; ++button) {
+        if (writeMask.test(button)) {
+            VBVMR_MacroButton_SetStatus(static_cast<long>(button), writeValues.test(button) ? 1.0f : 0.0f,
+                                        MACROBUTTON_MODE_STATEONLY);
+        }
+    }
+    return true;
+}
+
+bool VoicemeeterManager::RunDuckingCycle(DuckingEngine& engine) {
+    DuckingEngine* target = &engine;
+    return executor_.Execute("DuckingCycle", [this, target]() {
+        return RunDuckingCycleInternal(*target);
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::RunDuckingCycleInternal(DuckingEngine& engine) {
+    if (!loggedIn || !VBVMR_GetLevel || !VBVMR_GetVoicemeeterType) {
+        return false;
+    }
+    long voicemeeterType = 0;
+    if (VBVMR_GetVoicemeeterType(&voicemeeterType) != 0) {
+        return false;
+    }
+
+    // Peak across the trigger's channels; meters read linear, 1.0 at 0 dBFS.
+    const std::vector<DuckChannel>& triggers = engine.Triggers();
+    float levels[DUCK_MAX_RULES];
+    for (size_t i = 0; i < triggers.size() && i < DUCK_MAX_RULES; ++i) {
+        int first = 0;
+        int count = 0;
+        levels[i] = NAN;
+        if (!DuckingEngine::LevelChannels(voicemeeterType, triggers[i], first, count)) {
+            continue;
+        }
+        long type = triggers[i].type == ChannelType::Input ? DUCK_STRIP_LEVEL_TYPE : DUCK_BUS_LEVEL_TYPE;
+        float peak = 0.0f;
+        for (int channel = first; channel < first + count; ++channel) {
+            float level = 0.0f;
+            if (VBVMR_GetLevel(type, channel, &level) == 0) {
+                peak = (std::max)(peak, std::fabs(level));
+            }
+        }
+        levels[i] = peak;
+    }
+
+    VBVMR_IsParametersDirty();
+    const std::vector<std::string>& parameters = engine.TargetParameters();
+    float values[DUCK_MAX_RULES];
+    for (size_t i = 0; i < parameters.size() && i < DUCK_MAX_RULES; ++i) {
+        if (VBVMR_GetParameterFloat(const_cast<char*>(parameters[i].c_str()), &values[i]) != 0) {
+            values[i] = NAN;
+        }
+    }
+
+    engine.Process(levels, values);
+
+    const std::string& script = engine.Script();
+    if (!script.empty()) {
+        long result = VBVMR_SetParameters(script.c_str());
+        if (result != 0) {
+            LOG_ERROR("[VoicemeeterManager::RunDuckingCycle] VBVMR_SetParameters failed. Result: " + std::to_string(result));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VoicemeeterManager::StartAudioInsert(AudioInsert& insert) {
+    AudioInsert* target = &insert;
+    return executor_.Execute("StartAudioInsert", [this, target]() {
+        return StartAudioInsertInternal(*target);
+    }, COMMAND_DEADLINE);
+}
+
+bool VoicemeeterManager::StartAudioInsertInternal(AudioInsert& insert) {
+    if (!loggedIn || !VBVMR_AudioCallbackRegister || !VBVMR_AudioCallbackStart || !VBVMR_AudioCallbackStop ||
+        !VBVMR_AudioCallbackUnregister) {
+        LOG_ERROR("[VoicemeeterManager::StartAudioInsert] The audio callback API is not available.");
+        return false;
+    }
+    if (audioInsert_) {
+        LOG_ERROR("[VoicemeeterManager::StartAudioInsert] An audio insert is already registered.");
+        return false;
+    }
+
+    // The stream has to be restarted after a change; the callback only asks for it.
+    insert.onStreamChange = [this]() {
+        executor_.Post("RestartAudioInsert", [this]() {
+            if (!audioInsert_) {
+                return false;
+            }
+            LOG_INFO("[VoicemeeterManager::RestartAudioInsert] Audio stream changed. Restarting the audio callback.");
+            VBVMR_AudioCallbackStop();
+            return VBVMR_AudioCallbackStart() == 0;
+        }, COMMAND_DEADLINE);
+    };
+
+    char clientName[64] = {};
+    std::snprintf(clientName, sizeof(clientName), "%s", AUDIO_CLIENT_NAME);
+    long result = VBVMR_AudioCallbackRegister(AUDIOCALLBACK_MAIN, &AudioInsert::Callback, &insert, clientName);
+    if (result == 1) {
+        clientName[sizeof(clientName) - 1] = '\0';
+        LOG_ERROR("[VoicemeeterManager::StartAudioInsert] The MAIN audio callback is already registered by " +
+                  std::string(clientName) + ".");
+        return false;
+    }
+    if (result != 0) {
+        LOG_ERROR("[VoicemeeterManager::StartAudioInsert] VBVMR_AudioCallbackRegister failed. Result: " + std::to_string(result));
+        return false;
+    }
+
+    result = VBVMR_AudioCallbackStart();
+    if (result != 0) {
+        LOG_ERROR("[VoicemeeterManager::StartAudioInsert] VBVMR_AudioCallbackStart failed. Result: " + std::to_string(result));
+        VBVMR_AudioCallbackUnregister();
+        return false;
+    }
+    audioInsert_ = &insert;
+    LOG_INFO("[VoicemeeterManager::StartAudioInsert] Audio insert started with " +
+             std::to_string(insert.ProcessorCount()) + " processors.");
+    return true;
+}
+
+void VoicemeeterManager::StopAudioInsert() {
+    executor_.Execute("StopAudioInsert", [this]() {
+        StopAudioInsertInternal();
+        return true;
+    }, COMMAND_DEADLINE);
+}
+
+void VoicemeeterManager::StopAudioInsertInternal() {
+    if (!audioInsert_) {
+        return;
+    }
+    // Unregistering returns once the audio thread has left the callback.
+    if (VBVMR_AudioCallbackStop) {
+        VBVMR_AudioCallbackStop();
+    }
+    if (VBVMR_AudioCallbackUnregister) {
+        long result = VBVMR_AudioCallbackUnregister();
+        LOG_DEBUG("[VoicemeeterManager::StopAudioInsert] VBVMR_AudioCallbackUnregister result: " + std::to_string(result));
+    }
+    AudioInsert::Stats stats = audioInsert_->GetStats();
+    LOG_INFO("[VoicemeeterManager::StopAudioInsert] Audio insert stopped after " + std::to_string(stats.buffers) +
+             " buffers and " + std::to_string(stats.restarts) + " stream starts. Over budget: " +
+             std::to_string(stats.overBudget) + ", deadline misses: " + std::to_string(stats.deadlineMisses) +
+             ", optional processing bypassed " + std::to_string(stats.bypasses) + " times.");
+    audioInsert_ = nullptr;
+}
+
+void VoicemeeterManager::WaitForQueuedCommands() {
+    // Commands run in order, so once this one completes every earlier one has.
+    executor_.Submit("Barrier", []() { return true; }, COMMAND_DEADLINE).wait();
+}
+
+CallbackID VoicemeeterManager::RegisterVolumeChangeCallback(VoicemeeterVolumeCallback callback) {
+    CallbackID id = volumeListeners_.Add(std::move(callback));
+    if (id == 0) {
+        LOG_ERROR("[VoicemeeterManager::RegisterVolumeChangeCallback] Callback limit of " + std::to_string(MAX_CALLBACKS) + " reached.");
+    }
     return id;
 }
 
 bool VoicemeeterManager::UnregisterVolumeChangeCallback(CallbackID callbackID) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    return volumeChangeCallbacks_.erase(callbackID) > 0;
+    return volumeListeners_.Remove(callbackID);
 }
@@ -0,0 +1,658 @@
+// VolumeHistory.cpp
+#include "VolumeHistory.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+#include "AllocationTracker.h"
+#include "Logger.h"
+
+namespace {
+constexpr uint32_t HISTORY_FILE_MAGIC = 0x53484D56;  // "VMHS"
+constexpr uint16_t HISTORY_FILE_VERSION = 1;
+constexpr size_t HISTORY_FILE_HEADER_SIZE = 4 + 2 + 1 + 1;
+
+// Indexed by VolumeHistory::Tier
+constexpr uint64_t TIER_PERIOD_MS[] = {1, 1000, 60000};
+constexpr size_t TIER_CAPACITY[] = {HISTORY_RAW_CAPACITY, HISTORY_SECOND_CAPACITY, HISTORY_MINUTE_CAPACITY};
+constexpr const char* TIER_NAMES[] = {"raw", "1s", "1m"};
+constexpr const char* SERIES_NAMES[] = {"windows_volume", "windows_mute", "voicemeeter_volume", "voicemeeter_mute"};
+
+constexpr char CSV_HEADER[] = "series,tier,time_ms,min,max,last,changes\n";
+
+// Benchmark
+constexpr uint64_t BENCH_START_MS = 1760000000000ull;
+constexpr uint32_t BENCH_CHECKED_QUERY_ENTRIES = 10;
+constexpr size_t BENCH_RENDER_BYTES = 1024 * 1024;  // One whole series and tier
+constexpr const char* BENCH_FILE = "VoiceMirror.history.bench";
+
+uint64_t NowUnixMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+uint16_t QuantizeVolume(float volumePercent) {
+    float clamped = (std::min)((std::max)(volumePercent, 0.0f), 100.0f);
+    return static_cast<uint16_t>(std::lround(clamped * HISTORY_VOLUME_SCALE));
+}
+
+bool IsVolume(int series) {
+    return series == VolumeHistory::WindowsVolume || series == VolumeHistory::VoicemeeterVolume;
+}
+
+uint32_t Checksum(const uint8_t* bytes, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Reads varints from a file image; any overrun leaves ok false.
+struct Reader {
+    const uint8_t* position;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position == end) {
+                ok = false;
+                return 0;
+            }
+            uint8_t byte = *position++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    uint16_t Value(uint64_t value) {
+        ok = ok && value <= UINT16_MAX;
+        return static_cast<uint16_t>(value);
+    }
+};
+
+bool ParseNumber(const char* text, size_t length, uint64_t& value) {
+    value = 0;
+    if (length == 0 || length > 19) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(text[i] - '0');
+    }
+    return true;
+}
+
+bool Equals(const char* text, size_t length, const char* word) {
+    return std::strlen(word) == length && std::memcmp(text, word, length) == 0;
+}
+
+int FindName(const char* text, size_t length, const char* const* names, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (Equals(text, length, names[i])) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+uint32_t NextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// A decoded entry, for the benchmark's comparisons
+struct BenchEntry {
+    uint64_t time;
+    uint16_t minimum;
+    uint16_t maximum;
+    uint16_t last;
+    uint16_t changes;
+
+    bool operator==(const BenchEntry& other) const {
+        return time == other.time && minimum == other.minimum && maximum == other.maximum && last == other.last &&
+               changes == other.changes;
+    }
+};
+}  // namespace
+
+VolumeHistory& VolumeHistory::Instance() {
+    static VolumeHistory instance;
+    return instance;
+}
+
+VolumeHistory::VolumeHistory() {
+    for (SeriesData& data : series_) {
+        for (int tier = 0; tier < TierCount; ++tier) {
+            Ring& ring = data.rings[tier];
+            ring.delta.resize(TIER_CAPACITY[tier]);
+            ring.last.resize(TIER_CAPACITY[tier]);
+            if (tier != Raw) {
+                ring.minimum.resize(TIER_CAPACITY[tier]);
+                ring.maximum.resize(TIER_CAPACITY[tier]);
+                ring.changes.resize(TIER_CAPACITY[tier]);
+            }
+        }
+    }
+}
+
+bool VolumeHistory::Open(const Config& config) {
+    AllocationScope allocationScope(AllocationSubsystem::Cache);
+    channelIndex_ = config.index.value;
+    channelType_ = static_cast<uint8_t>(std::strcmp(config.type.value, "input") == 0 ? ChannelType::Input : ChannelType::Output);
+    path_ = config.historyFilePath.value;
+    if (path_.empty()) {
+        LOG_DEBUG("[VolumeHistory::Open] No history file; history is kept in memory only.");
+        return true;
+    }
+    if (GetFileAttributesA(path_.c_str()) == INVALID_FILE_ATTRIBUTES) {
+        LOG_INFO("[VolumeHistory::Open] No history in " + path_ + " yet.");
+        return true;
+    }
+    return Load(path_);
+}
+
+void VolumeHistory::Close() {
+    if (!path_.empty()) {
+        Save(path_);
+    }
+}
+
+void VolumeHistory::Record(StreamEventSide side, float volumePercent, bool isMuted) {
+    int volumeSeries = side == StreamEventSide::Windows ? WindowsVolume : VoicemeeterVolume;
+    uint64_t nowMs = NowUnixMs();
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    RecordValue(volumeSeries, QuantizeVolume(volumePercent), nowMs);
+    RecordValue(volumeSeries + 1, isMuted ? 1 : 0, nowMs);
+}
+
+void VolumeHistory::RecordValue(int series, uint16_t value, uint64_t nowMs) {
+    SeriesData& data = series_[series];
+    if (data.known && data.value == value) {
+        return;
+    }
+    data.known = true;
+    data.value = value;
+    for (int tier = 0; tier < TierCount; ++tier) {
+        Append(data.rings[tier], tier, value, nowMs);
+    }
+}
+
+void VolumeHistory::Append(Ring& ring, int tier, uint16_t value, uint64_t nowMs) {
+    const size_t capacity = ring.delta.size();
+    uint64_t time = nowMs / TIER_PERIOD_MS[tier];
+    if (ring.count > 0 && time < ring.newest) {
+        time = ring.newest;  // The clock stepped back
+    }
+
+    if (tier != Raw && ring.count > 0 && time == ring.newest) {
+        size_t index = (ring.head + ring.count - 1) % capacity;
+        ring.minimum[index] = (std::min)(ring.minimum[index], value);
+        ring.maximum[index] = (std::max)(ring.maximum[index], value);
+        ring.last[index] = value;
+        if (ring.changes[index] < UINT16_MAX) {
+            ++ring.changes[index];
+        }
+        return;
+    }
+
+    uint64_t delta = ring.count > 0 ? time - ring.newest : 0;
+    if (delta > UINT32_MAX) {
+        // A raw gap of over 49 days; the coarse tiers still cover what is dropped.
+        ring.head = 0;
+        ring.count = 0;
+        ring.evicted = true;
+        delta = 0;
+    }
+    if (ring.count == capacity) {
+        ring.head = (ring.head + 1) % capacity;
+        --ring.count;
+        ring.evicted = true;
+        ring.oldest += ring.delta[ring.head];
+    }
+    if (ring.count == 0) {
+        ring.oldest = time;
+    }
+
+    size_t index = (ring.head + ring.count) % capacity;
+    ring.delta[index] = static_cast<uint32_t>(delta);
+    ring.last[index] = value;
+    if (tier != Raw) {
+        ring.minimum[index] = value;
+        ring.maximum[index] = value;
+        ring.changes[index] = 1;
+    }
+    ++ring.count;
+    ring.newest = time;
+}
+
+int VolumeHistory::CoveringTier(const SeriesData& data, uint64_t fromMs) const {
+    for (int tier = 0; tier < TierCount; ++tier) {
+        const Ring& ring = data.rings[tier];
+        if (!ring.evicted || ring.oldest * TIER_PERIOD_MS[tier] <= fromMs) {
+            return tier;
+        }
+    }
+    return Minute;
+}
+
+bool VolumeHistory::ParseQuery(const char* text, size_t length, Query& query) {
+    query = Query();
+    const char* end = text + length;
+    while (text < end) {
+        const char* pairEnd = std::find(text, end, '&');
+        const char* equals = std::find(text, pairEnd, '=');
+        if (equals == pairEnd) {
+            return false;
+        }
+        const char* value = equals + 1;
+        size_t keyLength = static_cast<size_t>(equals - text);
+        size_t valueLength = static_cast<size_t>(pairEnd - value);
+
+        if (Equals(text, keyLength, "series")) {
+            query.series = FindName(value, valueLength, SERIES_NAMES, std::size(SERIES_NAMES));
+            if (query.series < 0) {
+                return false;
+            }
+        } else if (Equals(text, keyLength, "tier")) {
+            query.tier = FindName(value, valueLength, TIER_NAMES, std::size(TIER_NAMES));
+            if (query.tier < 0) {
+                return false;
+            }
+        } else if (Equals(text, keyLength, "from")) {
+            if (!ParseNumber(value, valueLength, query.fromMs)) {
+                return false;
+            }
+        } else if (Equals(text, keyLength, "to")) {
+            if (!ParseNumber(value, valueLength, query.toMs)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        text = pairEnd == end ? end : pairEnd + 1;
+    }
+    return query.fromMs <= query.toMs;
+}
+
+bool VolumeHistory::Render(const Query& query, char* out, size_t capacity, size_t& length) {
+    length = 0;
+    auto put = [&](int written) {
+        if (written < 0 || static_cast<size_t>(written) >= capacity - length) {
+            return false;
+        }
+        length += static_cast<size_t>(written);
+        return true;
+    };
+    if (capacity == 0 || !put(std::snprintf(out, capacity, "%s", CSV_HEADER))) {
+        return false;
+    }
+
+    for (int series = 0; series < SeriesCount; ++series) {
+        if (query.series >= 0 && query.series != series) {
+            continue;
+        }
+        // Locked per series, so recording waits for one series' text at most.
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        const SeriesData& data = series_[series];
+        int tier = query.tier >= 0 ? query.tier : CoveringTier(data, query.fromMs);
+        const Ring& ring = data.rings[tier];
+        const uint64_t period = TIER_PERIOD_MS[tier];
+        const size_t ringCapacity = ring.delta.size();
+
+        uint64_t time = ring.oldest;
+        for (size_t k = 0; k < ring.count; ++k) {
+            size_t index = (ring.head + k) % ringCapacity;
+            if (k > 0) {
+                time += ring.delta[index];
+            }
+            uint64_t startMs = time * period;
+            if (startMs + period - 1 < query.fromMs) {
+                continue;
+            }
+            if (startMs > query.toMs) {
+                break;
+            }
+
+            uint16_t values[3] = {ring.last[index], ring.last[index], ring.last[index]};
+            unsigned changes = 1;
+            if (tier != Raw) {
+                values[0] = ring.minimum[index];
+                values[1] = ring.maximum[index];
+                changes = ring.changes[index];
+            }
+            int written = IsVolume(series)
+                              ? std::snprintf(out + length, capacity - length, "%s,%s,%llu,%u.%02u,%u.%02u,%u.%02u,%u\n",
+                                              SERIES_NAMES[series], TIER_NAMES[tier], static_cast<unsigned long long>(startMs),
+                                              values[0] / 100u, values[0] % 100u, values[1] / 100u, values[1] % 100u,
+                                              values[2] / 100u, values[2] % 100u, changes)
+                              : std::snprintf(out + length, capacity - length, "%s,%s,%llu,%u,%u,%u,%u\n",
+                                              SERIES_NAMES[series], TIER_NAMES[tier], static_cast<unsigned long long>(startMs),
+                                              static_cast<unsigned>(values[0]), static_cast<unsigned>(values[1]),
+                                              static_cast<unsigned>(values[2]), changes);
+            if (!put(written)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool VolumeHistory::Save(const std::string& path) {
+    std::vector<uint8_t> bytes(HISTORY_FILE_HEADER_SIZE);
+    std::memcpy(bytes.data(), &HISTORY_FILE_MAGIC, 4);
+    std::memcpy(bytes.data() + 4, &HISTORY_FILE_VERSION, 2);
+    bytes[6] = channelIndex_;
+    bytes[7] = channelType_;
+
+    size_t entries = 0;
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        for (const SeriesData& data : series_) {
+            bytes.push_back(data.known ? 1 : 0);
+            PutVarint(bytes, data.value);
+            for (int tier = 0; tier < TierCount; ++tier) {
+                const Ring& ring = data.rings[tier];
+                PutVarint(bytes, ring.count);
+                bytes.push_back(ring.evicted ? 1 : 0);
+                PutVarint(bytes, ring.oldest);
+                uint16_t previous = 0;
+                for (size_t k = 0; k < ring.count; ++k) {
+                    size_t index = (ring.head + k) % ring.delta.size();
+                    if (k > 0) {
+                        PutVarint(bytes, ring.delta[index]);
+                    }
+                    uint16_t last = ring.last[index];
+                    PutVarint(bytes, ZigZag(static_cast<int64_t>(last) - previous));
+                    previous = last;
+                    if (tier != Raw) {
+                        PutVarint(bytes, last - ring.minimum[index]);
+                        PutVarint(bytes, ring.maximum[index] - last);
+                        PutVarint(bytes, ring.changes[index]);
+                    }
+                }
+                entries += ring.count;
+            }
+        }
+    }
+    uint32_t checksum = Checksum(bytes.data(), bytes.size());
+    bytes.insert(bytes.end(), reinterpret_cast<const uint8_t*>(&checksum), reinterpret_cast<const uint8_t*>(&checksum) + 4);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        LOG_ERROR("[VolumeHistory::Save] Failed to write history file " + path + ".");
+        return false;
+    }
+    LOG_INFO("[VolumeHistory::Save] Saved " + std::to_string(entries) + " history entries to " + path + " (" +
+             std::to_string(bytes.size()) + " bytes).");
+    return true;
+}
+
+bool VolumeHistory::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_WARNING("[VolumeHistory::Load] Failed to open history file " + path + ".");
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint32_t checksum = 0;
+    if (bytes.size() >= HISTORY_FILE_HEADER_SIZE + 4) {
+        std::memcpy(&magic, bytes.data(), 4);
+        std::memcpy(&version, bytes.data() + 4, 2);
+        std::memcpy(&checksum, bytes.data() + bytes.size() - 4, 4);
+    }
+    if (magic != HISTORY_FILE_MAGIC || version != HISTORY_FILE_VERSION ||
+        checksum != Checksum(bytes.data(), bytes.size() - 4)) {
+        LOG_WARNING("[VolumeHistory::Load] " + path + " is not a usable history file. Starting a new history.");
+        return false;
+    }
+    if (bytes[6] != channelIndex_ || bytes[7] != channelType_) {
+        LOG_INFO("[VolumeHistory::Load] History in " + path + " belongs to another channel mapping. Starting a new history.");
+        return true;
+    }
+
+    // Decoded into a copy, so a bad file leaves the current history alone.
+    auto loaded = std::make_unique<VolumeHistory>();
+    Reader reader{bytes.data() + HISTORY_FILE_HEADER_SIZE, bytes.data() + bytes.size() - 4};
+    size_t entries = 0;
+    for (SeriesData& data : loaded->series_) {
+        data.known = reader.Varint() != 0;
+        data.value = reader.Value(reader.Varint());
+        for (int tier = 0; tier < TierCount && reader.ok; ++tier) {
+            Ring& ring = data.rings[tier];
+            uint64_t count = reader.Varint();
+            if (count > ring.delta.size()) {
+                reader.ok = false;
+                break;
+            }
+            ring.count = static_cast<size_t>(count);
+            ring.evicted = reader.Varint() != 0;
+            ring.oldest = reader.Varint();
+            ring.newest = ring.oldest;
+            uint16_t previous = 0;
+            for (size_t k = 0; k < ring.count && reader.ok; ++k) {
+                uint64_t delta = k > 0 ? reader.Varint() : 0;
+                ring.delta[k] = static_cast<uint32_t>(delta);
+                ring.newest += delta;
+                reader.ok = reader.ok && delta <= UINT32_MAX;
+                int64_t last = previous + UnZigZag(reader.Varint());
+                reader.ok = reader.ok && last >= 0;
+                ring.last[k] = reader.Value(static_cast<uint64_t>(last));
+                previous = ring.last[k];
+                if (tier != Raw) {
+                    uint64_t belowLast = reader.Varint();
+                    uint64_t aboveLast = reader.Varint();
+                    reader.ok = reader.ok && belowLast <= ring.last[k];
+                    ring.minimum[k] = static_cast<uint16_t>(ring.last[k] - belowLast);
+                    ring.maximum[k] = reader.Value(ring.last[k] + aboveLast);
+                    ring.changes[k] = reader.Value(reader.Varint());
+                }
+            }
+            entries += ring.count;
+        }
+    }
+    if (!reader.ok || reader.position != reader.end) {
+        LOG_WARNING("[VolumeHistory::Load] " + path + " is damaged. Starting a new history.");
+        return false;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    for (int series = 0; series < SeriesCount; ++series) {
+        std::swap(series_[series], loaded->series_[series]);
+    }
+    LOG_INFO("[VolumeHistory::Load] Loaded " + std::to_string(entries) + " history entries from " + path + ".");
+    return true;
+}
+
+bool VolumeHistory::Benchmark(uint32_t changes) {
+    using BenchClock = std::chrono::steady_clock;
+    if (changes < 1 || changes > HISTORY_BENCH_MAX_CHANGES) {
+        LOG_ERROR("[VolumeHistory::Benchmark] Changes must be 1-" + std::to_string(HISTORY_BENCH_MAX_CHANGES) + ".");
+        return false;
+    }
+
+    // Slider drags of small steps tens of milliseconds apart, pauses of seconds
+    // and idle stretches of minutes, with the occasional mute toggle.
+    auto history = std::make_unique<VolumeHistory>();
+    std::vector<std::pair<uint64_t, uint16_t>> reference[SeriesCount];
+    uint16_t values[SeriesCount] = {5000, 0, 5000, 0};
+    std::vector<double> nanos;
+    nanos.reserve(changes);
+    uint32_t state = 12345;
+    uint64_t nowMs = BENCH_START_MS;
+    for (uint32_t i = 0; i < changes; ++i) {
+        uint32_t random = NextRandom(state);
+        uint32_t pause = random % 100;
+        nowMs += pause < 70 ? 10 + random % 90 : pause < 95 ? 1000 + random % 4000 : 60000 + random % 1740000;
+
+        int series = static_cast<int>(NextRandom(state) % 16);
+        series = series < 7 ? WindowsVolume : series < 14 ? VoicemeeterVolume : series == 14 ? WindowsMute : VoicemeeterMute;
+        if (IsVolume(series)) {
+            int step = static_cast<int>(NextRandom(state) % 301) - 150;
+            int next = std::clamp(static_cast<int>(values[series]) + (step == 0 ? 1 : step), 0, 10000);
+            values[series] = static_cast<uint16_t>(next == values[series] ? 10000 - next : next);
+        } else {
+            values[series] ^= 1;
+        }
+        reference[series].emplace_back(nowMs, values[series]);
+
+        BenchClock::time_point start = BenchClock::now();
+        {
+            std::lock_guard<ProfiledMutex> lock(history->mutex_);
+            history->RecordValue(series, values[series], nowMs);
+        }
+        nanos.push_back(std::chrono::duration<double, std::nano>(BenchClock::now() - start).count());
+    }
+
+    // Every tier must hold exactly the newest entries of the same changes aggregated by hand.
+    auto decode = [](const Ring& ring, int tier) {
+        std::vector<BenchEntry> entries;
+        uint64_t time = ring.oldest;
+        for (size_t k = 0; k < ring.count; ++k) {
+            size_t index = (ring.head + k) % ring.delta.size();
+            time += k > 0 ? ring.delta[index] : 0;
+            uint16_t last = ring.last[index];
+            entries.push_back(tier == Raw ? BenchEntry{time, last, last, last, 1}
+                                          : BenchEntry{time, ring.minimum[index], ring.maximum[index], last, ring.changes[index]});
+        }
+        return entries;
+    };
+    uint32_t mismatches = 0;
+    size_t stored = 0;
+    for (int series = 0; series < SeriesCount; ++series) {
+        for (int tier = 0; tier < TierCount; ++tier) {
+            std::vector<BenchEntry> expected;
+            for (const auto& change : reference[series]) {
+                uint64_t time = change.first / TIER_PERIOD_MS[tier];
+                if (tier != Raw && !expected.empty() && expected.back().time == time) {
+                    BenchEntry& bucket = expected.back();
+                    bucket.minimum = (std::min)(bucket.minimum, change.second);
+                    bucket.maximum = (std::max)(bucket.maximum, change.second);
+                    bucket.last = change.second;
+                    ++bucket.changes;
+                } else {
+                    expected.push_back({time, change.second, change.second, change.second, 1});
+                }
+            }
+            size_t kept = (std::min)(expected.size(), TIER_CAPACITY[tier]);
+            expected.erase(expected.begin(), expected.end() - static_cast<ptrdiff_t>(kept));
+            std::vector<BenchEntry> actual = decode(history->series_[series].rings[tier], tier);
+            stored += actual.size();
+            if (actual != expected) {
+                ++mismatches;
+                LOG_ERROR(std::string("[VolumeHistory::Benchmark] ") + SERIES_NAMES[series] + " " + TIER_NAMES[tier] +
+                          " holds " + std::to_string(actual.size()) + " entries that differ from the " +
+                          std::to_string(expected.size()) + " expected.");
+            }
+        }
+    }
+
+    // A query for the last few changes of one series comes from the raw tier.
+    std::vector<char> text(BENCH_RENDER_BYTES);
+    size_t length = 0;
+    const auto& drags = reference[WindowsVolume];
+    size_t checked = (std::min)(drags.size(), static_cast<size_t>(BENCH_CHECKED_QUERY_ENTRIES));
+    bool queried = true;
+    if (checked > 0) {
+        std::string queryText = "series=windows_volume&from=" + std::to_string(drags[drags.size() - checked].first) +
+                                "&to=" + std::to_string(drags.back().first);
+        Query query;
+        queried = ParseQuery(queryText.data(), queryText.size(), query) &&
+                  history->Render(query, text.data(), text.size(), length) &&
+                  static_cast<size_t>(std::count(text.data(), text.data() + length, '\n')) == checked + 1 &&
+                  std::string(text.data(), length).find(",raw,") != std::string::npos;
+    }
+    Query rejected;
+    bool rejects = !ParseQuery("series=nothing", 14, rejected) && !ParseQuery("from=12x", 8, rejected) &&
+                   !ParseQuery("from=2&to=1", 11, rejected) && !ParseQuery("tier", 4, rejected);
+    if (!queried || !rejects) {
+        LOG_ERROR("[VolumeHistory::Benchmark] Queries did not return the newest raw changes or accepted bad input.");
+    }
+
+    // The file must read back into the same history, and a damaged one must not.
+    bool roundTrip = history->Save(BENCH_FILE);
+    auto loaded = std::make_unique<VolumeHistory>();
+    roundTrip = roundTrip && loaded->Load(BENCH_FILE);
+    std::vector<char> loadedText(BENCH_RENDER_BYTES);
+    for (int series = 0; series < SeriesCount && roundTrip; ++series) {
+        for (int tier = 0; tier < TierCount && roundTrip; ++tier) {
+            Query query;
+            query.series = series;
+            query.tier = tier;
+            size_t loadedLength = 0;
+            roundTrip = history->Render(query, text.data(), text.size(), length) &&
+                        loaded->Render(query, loadedText.data(), loadedText.size(), loadedLength) &&
+                        length == loadedLength && std::memcmp(text.data(), loadedText.data(), length) == 0;
+        }
+    }
+    std::ifstream saved(BENCH_FILE, std::ios::binary | std::ios::ate);
+    uint64_t fileBytes = saved ? static_cast<uint64_t>(saved.tellg()) : 0;
+    saved.close();
+    {
+        std::fstream damaged(BENCH_FILE, std::ios::binary | std::ios::in | std::ios::out);
+        damaged.seekg(static_cast<std::streamoff>(fileBytes / 2));
+        int byte = damaged.get();
+        damaged.seekp(static_cast<std::streamoff>(fileBytes / 2));
+        damaged.put(static_cast<char>(byte ^ 0xFF));
+    }
+    bool rejectsDamage = !loaded->Load(BENCH_FILE);
+    DeleteFileA(BENCH_FILE);
+    if (!roundTrip || !rejectsDamage) {
+        LOG_ERROR("[VolumeHistory::Benchmark] The history file did not round-trip or a damaged file was accepted.");
+    }
+
+    std::sort(nanos.begin(), nanos.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[VolumeHistory::Benchmark] " + std::to_string(changes) + " changes over " +
+             std::to_string((nowMs - BENCH_START_MS) / 60000) + " minutes. Record p50: " + std::to_string(at(nanos, 0.5)) +
+             " ns, p99: " + std::to_string(at(nanos, 0.99)) + " ns, max: " + std::to_string(at(nanos, 1.0)) + " ns.");
+    LOG_INFO("[VolumeHistory::Benchmark] " + std::to_string(stored) + " entries kept across tiers, saved in " +
+             std::to_string(fileBytes) + " bytes (" +
+             std::to_string(stored > 0 ? static_cast<double>(fileBytes) / stored : 0.0) + " bytes per entry).");
+
+    bool correct = mismatches == 0 && queried && rejects && roundTrip && rejectsDamage;
+    if (correct) {
+        LOG_INFO("[VolumeHistory::Benchmark] Every tier matches the changes recorded, and the file round-trips.");
+    }
+    return correct;
+}
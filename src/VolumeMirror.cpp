@@ -1,55 +1,100 @@
 // VolumeMirror.cpp
 #include "VolumeMirror.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iterator>
 #include <thread>
+#include <vector>
 
+#include "AllocationTracker.h"
+#include "EventStream.h"
 #include "Logger.h"  // For logging
 #include "SoundManager.h"
+#include "StateCache.h"
+#include "StateReplicator.h"
+#include "VolumeHistory.h"
 #include "VolumeUtils.h"
 
 using namespace VolumeUtils;
 
-VolumeMirror::VolumeMirror(int channelIdx, ChannelType type, VoicemeeterManager& manager, WindowsManager& windowsManager, Mode mode)
+namespace {
+// Sample generation for values that can never be stale (notifications carry their value).
+constexpr uint64_t ANY_GENERATION = UINT64_MAX;
+
+void Count(Metric* metric) {
+    if (metric) {
+        metric->Add(1.0);
+    }
+}
+
+void Set(Metric* metric, double value) {
+    if (metric) {
+        metric->Set(value);
+    }
+}
+
+void Observe(Histogram* histogram, std::chrono::steady_clock::duration elapsed) {
+    if (histogram) {
+        histogram->Observe(std::chrono::duration<double>(elapsed).count());
+    }
+}
+
+// Benchmark: poll fast so fader moves are confirmed within a few ms
+constexpr int BENCH_POLL_MS = 1;
+constexpr std::chrono::milliseconds BENCH_RESYNC_INTERVAL(1);
+constexpr std::chrono::milliseconds BENCH_FADER_INTERVAL(5);
+constexpr std::chrono::milliseconds BENCH_REPORT_TIMEOUT(1000);
+constexpr std::chrono::milliseconds BENCH_SETTLE_TIMEOUT(2000);
+constexpr uint32_t BENCH_FADER_EVERY = 8;
+
+// Slider position of the n-th synthetic change: sweeps up and down, muting now and then.
+float BenchVolume(uint32_t n) {
+    uint32_t step = n % 200;
+    return static_cast<float>(step < 100 ? step : 200 - step);
+}
+
+bool BenchMute(uint32_t n) {
+    return n % 37 == 0;
+}
+}  // namespace
+
+VolumeMirror::VolumeMirror(int channelIdx, ChannelType type, MixerConnection& manager, EndpointVolume& windowsManager, Mode mode)
     : channelIndex(channelIdx),
       channelType(type),
       vmManager(manager),
       windowsManager(windowsManager),
       mode(mode),
       running(false),
-      pollingInterval(DEFAULT_POLLING_INTERVAL_MS),
-      updatingVoicemeeter(false),
-      updatingWindows(false),
-      lastWinVolume(0.0f),
-      lastWinMute(false),
-      lastVmVolume(0.0f),
-      lastVmMute(false),
-      pendingVmVolume(0.0f),
-      pendingVmMute(false),
-      vmChangePending(false) {
+      pollingInterval(DEFAULT_POLLING_INTERVAL_MS) {
     LOG_DEBUG("[VolumeMirror::Constructor] Initializing VolumeMirror.");
+    RegisterMetrics();
 
     // Initial synchronization: Set Voicemeeter volume to match Windows
-    lastWinVolume = windowsManager.GetVolume();
-    lastWinMute = windowsManager.GetMute();
-
-    // Round the initial Windows volume
-    lastWinVolume = std::round(lastWinVolume * 100.0f) / 100.0f;
+    float initialVolume = MirrorLogic::RoundVolume(windowsManager.GetVolume());
+    bool initialMute = windowsManager.GetMute();
 
-    LOG_DEBUG("[VolumeMirror::Constructor] Fetched Initial Windows Volume: " + std::to_string(lastWinVolume) + "%, Mute: " + (lastWinMute ? "Muted" : "Unmuted"));
+    LOG_DEBUG("[VolumeMirror::Constructor] Fetched Initial Windows Volume: " + std::to_string(initialVolume) + "%, Mute: " + (initialMute ? "Muted" : "Unmuted"));
 
-    vmManager.UpdateVoicemeeterVolume(channelIndex, channelType, lastWinVolume, lastWinMute);
+    vmManager.UpdateVoicemeeterVolume(channelIndex, channelType, initialVolume, initialMute);
     LOG_INFO("[VolumeMirror::Constructor] Voicemeeter volume and mute state synchronized with Windows.");
-
-    lastVmVolume = lastWinVolume;
-    lastVmMute = lastWinMute;
+    StateCache::Instance().RecordVolume(initialVolume, initialMute);
+
+    mirrorState.lastWinVolume = initialVolume;
+    mirrorState.lastWinMute = initialMute;
+    mirrorState.lastVmVolume = initialVolume;
+    mirrorState.lastVmMute = initialMute;
+    for (int side = 0; side < SideCount; ++side) {
+        Set(volumeGauges[side], initialVolume);
+        Set(muteGauges[side], initialMute ? 1.0 : 0.0);
+    }
 
     if (mode == Mode::Callback || mode == Mode::Hybrid) {
         LOG_DEBUG("[VolumeMirror::Constructor] Registering Windows Volume Change Callback.");
-        windowsVolumeCallback = [this](float newVolume, bool isMuted) {
+        windowsVolumeCallbackID = windowsManager.RegisterVolumeChangeCallback([this](float newVolume, bool isMuted) {
             this->OnWindowsVolumeChange(newVolume, isMuted);
-        };
-        windowsVolumeCallbackID = windowsManager.RegisterVolumeChangeCallback(windowsVolumeCallback);
+        });
         LOG_DEBUG("[VolumeMirror::Constructor] Windows Volume Change Callback registered with ID: " + std::to_string(windowsVolumeCallbackID));
     }
 }
@@ -58,7 +103,7 @@ VolumeMirror::~VolumeMirror() {
     LOG_DEBUG("[VolumeMirror::~Destructor] Stopping VolumeMirror.");
     Stop();
 
-    if (mode == Mode::Callback || mode == Mode::Hybrid) {
+    if (windowsVolumeCallbackID != 0) {
         LOG_DEBUG("[VolumeMirror::~Destructor] Unregistering Windows Volume Change Callback with ID: " + std::to_string(windowsVolumeCallbackID));
         windowsManager.UnregisterVolumeChangeCallback(windowsVolumeCallbackID);
         LOG_DEBUG("[VolumeMirror::~Destructor] Windows Volume Change Callback unregistered.");
@@ -68,7 +113,7 @@ VolumeMirror::~VolumeMirror() {
 }
 
 void VolumeMirror::Start() {
-    std::lock_guard<std::mutex> lock(controlMutex);
+    std::lock_guard<ProfiledMutex> lock(lifecycleMutex);
     if (running.load()) {
         LOG_DEBUG("[VolumeMirror::Start] Start called, but VolumeMirror is already running.");
         return;
@@ -87,7 +132,7 @@ void VolumeMirror::Start() {
 }
 
 void VolumeMirror::Stop() {
-    std::lock_guard<std::mutex> lock(controlMutex);
+    std::lock_guard<ProfiledMutex> lock(lifecycleMutex);
     if (!running.load()) {
         LOG_DEBUG("[VolumeMirror::Stop] Stop called, but VolumeMirror is not running.");
         return;
@@ -102,159 +147,557 @@ void VolumeMirror::Stop() {
         LOG_DEBUG("[VolumeMirror::Stop] MonitorVolumes thread joined.");
     }
 
+    LogLockHoldStats();
+    if (AllocationTracker::IsEnabled()) {
+        LOG_INFO("[VolumeMirror::Stop] Sync events: " + std::to_string(syncEvents.load()) +
+                 ", allocating after warm-up: " + std::to_string(allocatingSyncEvents.load()) + ".");
+    }
     LOG_INFO("[VolumeMirror::Stop] VolumeMirror has been stopped.");
 }
 
-void VolumeMirror::OnWindowsVolumeChange(float newVolume, bool isMuted) {
-    LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Triggered. New Volume: " + std::to_string(newVolume) + "%, Mute: " + (isMuted ? "Muted" : "Unmuted"));
+void VolumeMirror::RegisterMetrics() {
+    MetricsRegistry& registry = MetricsRegistry::Instance();
+    const char* sideNames[SideCount] = {"windows", "voicemeeter"};
+    for (int side = 0; side < SideCount; ++side) {
+        volumeGauges[side] = registry.Gauge("voicemirror_volume_percent", "Last volume read from each side.",
+                                            "side", sideNames[side]);
+        muteGauges[side] = registry.Gauge("voicemirror_muted", "Last mute state read from each side.",
+                                          "side", sideNames[side]);
+        syncCounters[side] = registry.Counter("voicemirror_syncs_total", "Volume and mute syncs written to each side.",
+                                              "target", sideNames[side]);
+        syncDurations[side] = registry.RegisterHistogram("voicemirror_sync_duration_seconds",
+                                                         "Time taken to write a sync to each side.",
+                                                         METRICS_LATENCY_BUCKETS_S, std::size(METRICS_LATENCY_BUCKETS_S),
+                                                         "target", sideNames[side]);
+    }
+    staleSampleCounter = registry.Counter("voicemirror_stale_samples_total",
+                                          "Samples dropped because a newer decision was made while they were read.");
+    staleActionCounter = registry.Counter("voicemirror_stale_actions_total",
+                                          "Sync writes skipped because a newer decision superseded them.");
+}
+
+void VolumeMirror::HoldStats::Record(std::chrono::steady_clock::duration held) {
+    uint64_t heldNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(held).count());
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNs.fetch_add(heldNs, std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock(controlMutex);
+    uint64_t previousMax = maxNs.load(std::memory_order_relaxed);
+    while (heldNs > previousMax && !maxNs.compare_exchange_weak(previousMax, heldNs, std::memory_order_relaxed)) {
+    }
+}
 
-    if (updatingWindows) {
-        LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Currently updating Windows volume. Skipping to prevent recursive updates.");
+std::string VolumeMirror::HoldStats::Describe(const char* what) const {
+    uint64_t n = count.load(std::memory_order_relaxed);
+    uint64_t averageNs = n == 0 ? 0 : totalNs.load(std::memory_order_relaxed) / n;
+    return std::string(what) + " " + std::to_string(n) + " times, average " + std::to_string(averageNs / 1000.0) +
+           " us, max " + std::to_string(maxNs.load(std::memory_order_relaxed) / 1000.0) + " us";
+}
+
+void VolumeMirror::LogLockHoldStats() {
+    if (controlHolds.count.load(std::memory_order_relaxed) == 0) {
         return;
     }
 
-    // Round the new volume to two decimal places
-    newVolume = std::round(newVolume * 100.0f) / 100.0f;
+    // Endpoint writes were made under writeMutex before writes were claimed, so
+    // their durations are what writeMutex hold times used to be.
+    LOG_INFO("[VolumeMirror::LogLockHoldStats] " + controlHolds.Describe("controlMutex held") + "; " +
+             writeHolds.Describe("writeMutex held") + "; " +
+             endpointWrites.Describe("endpoint writes (formerly under writeMutex)") + ". Stale samples: " +
+             std::to_string(staleSamples.load(std::memory_order_relaxed)) + ", stale actions: " +
+             std::to_string(staleActions.load(std::memory_order_relaxed)) + ".");
+}
 
-    if (!IsFloatEqual(newVolume, lastWinVolume) || isMuted != lastWinMute) {
-        LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Detected change in Windows Volume or Mute state.");
-        LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Previous Windows Volume: " + std::to_string(lastWinVolume) + "%, Previous Mute: " + (lastWinMute ? "Muted" : "Unmuted"));
+void VolumeMirror::CheckSyncEventAllocations(uint64_t allocationsBefore, const char* source) {
+    // Debug logging builds strings on purpose, so only release builds are checked.
+#if defined(VOICEMIRROR_TRACK_ALLOCATIONS) && !defined(_DEBUG)
+    uint64_t allocated = AllocationTracker::ThreadAllocations() - allocationsBefore;
+    if (syncEvents.fetch_add(1, std::memory_order_relaxed) < ALLOCATION_WARMUP_EVENTS || allocated == 0) {
+        return;
+    }
 
-        lastWinVolume = newVolume;
-        lastWinMute = isMuted;
+    allocatingSyncEvents.fetch_add(1, std::memory_order_relaxed);
+    LOG_ERROR(std::string("[VolumeMirror::CheckSyncEventAllocations] ") + source + " made " +
+              std::to_string(allocated) + " heap allocations after warm-up.");
+#else
+    (void)allocationsBefore;
+    (void)source;
+#endif
+}
 
-        if (!IsFloatEqual(newVolume, lastVmVolume) || isMuted != lastVmMute) {
-            LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Updating Voicemeeter Volume and Mute state to match Windows.");
-            updatingVoicemeeter = true;
-            vmManager.UpdateVoicemeeterVolume(channelIndex, channelType, newVolume, isMuted);
-            updatingVoicemeeter = false;
+MirrorLogic::Action VolumeMirror::ApplyWindowsSample(float volume, bool isMuted, uint64_t sampleGeneration) {
+    Set(volumeGauges[WindowsSide], volume);
+    Set(muteGauges[WindowsSide], isMuted ? 1.0 : 0.0);
+    EventStream::Instance().PublishVolume(StreamEventSide::Windows, volume);
+    EventStream::Instance().PublishMute(StreamEventSide::Windows, isMuted);
+    VolumeHistory::Instance().Record(StreamEventSide::Windows, volume, isMuted);
+
+    auto lockStart = std::chrono::steady_clock::now();
+    MirrorLogic::Action action;
+    {
+        std::lock_guard<ProfiledMutex> lock(controlMutex);
+        if (sampleGeneration != ANY_GENERATION && mirrorState.generation != sampleGeneration) {
+            // The sample was read before a newer decision; it may predate our own write.
+            staleSamples.fetch_add(1, std::memory_order_relaxed);
+            Count(staleSampleCounter);
+        } else {
+            action = MirrorLogic::ApplyWindowsSample(mirrorState, volume, isMuted);
+            generation.store(mirrorState.generation, std::memory_order_release);
+        }
+    }
+    controlHolds.Record(std::chrono::steady_clock::now() - lockStart);
+    return action;
+}
 
-            LOG_INFO("[VolumeMirror::OnWindowsVolumeChange] Voicemeeter volume and mute state synchronized with Windows.");
+MirrorLogic::Action VolumeMirror::ApplyVoicemeeterSample(float volume, bool isMuted, uint64_t sampleGeneration) {
+    Set(volumeGauges[VoicemeeterSide], volume);
+    Set(muteGauges[VoicemeeterSide], isMuted ? 1.0 : 0.0);
+    EventStream::Instance().PublishVolume(StreamEventSide::Voicemeeter, volume);
+    EventStream::Instance().PublishMute(StreamEventSide::Voicemeeter, isMuted);
+    VolumeHistory::Instance().Record(StreamEventSide::Voicemeeter, volume, isMuted);
+
+    auto lockStart = std::chrono::steady_clock::now();
+    MirrorLogic::Action action;
+    {
+        std::lock_guard<ProfiledMutex> lock(controlMutex);
+        if (mirrorState.generation != sampleGeneration) {
+            staleSamples.fetch_add(1, std::memory_order_relaxed);
+            Count(staleSampleCounter);
+        } else {
+            action = MirrorLogic::ApplyVoicemeeterSample(mirrorState, volume, isMuted);
+            generation.store(mirrorState.generation, std::memory_order_release);
+        }
+    }
+    controlHolds.Record(std::chrono::steady_clock::now() - lockStart);
+    return action;
+}
+
+void VolumeMirror::PerformAction(const MirrorLogic::Action& action) {
+    if (action.kind == MirrorLogic::Action::Kind::None) {
+        return;
+    }
 
-            lastVmVolume = newVolume;
-            lastVmMute = isMuted;
+    {
+        // Checking and claiming in one step keeps an action that lost the CPU
+        // after its check from being written after a newer one.
+        auto lockStart = std::chrono::steady_clock::now();
+        std::lock_guard<ProfiledMutex> lock(writeMutex);
+        bool stale = action.generation != generation.load(std::memory_order_acquire) ||
+                     action.generation <= claimedAction.generation;
+        if (stale || claimedAction.kind != MirrorLogic::Action::Kind::None) {
+            // Either this action or the unwritten claimed one is dropped.
+            LOG_DEBUG("[VolumeMirror::PerformAction] Action superseded by a newer decision. Skipping.");
+            staleActions.fetch_add(1, std::memory_order_relaxed);
+            Count(staleActionCounter);
+        }
+        if (!stale) {
+            claimedAction = action;
+        }
+        bool write = !stale && !writing;
+        writing = writing || write;
+        writeHolds.Record(std::chrono::steady_clock::now() - lockStart);
+        if (!write) {
+            // The writing thread picks up the claimed action when it is done.
+            return;
+        }
+    }
+
+    while (true) {
+        MirrorLogic::Action next;
+        {
+            auto lockStart = std::chrono::steady_clock::now();
+            std::lock_guard<ProfiledMutex> lock(writeMutex);
+            next = claimedAction;
+            claimedAction.kind = MirrorLogic::Action::Kind::None;  // The generation stays as the newest claimed
+            writing = next.kind != MirrorLogic::Action::Kind::None;
+            writeHolds.Record(std::chrono::steady_clock::now() - lockStart);
+        }
+        if (next.kind == MirrorLogic::Action::Kind::None) {
+            return;
         }
+
+        auto writeStart = std::chrono::steady_clock::now();
+        WriteAction(next);
+        endpointWrites.Record(std::chrono::steady_clock::now() - writeStart);
+
+        if (next.playSyncSound) {
+            // Play sound on Voicemeeter -> Windows change
+            LOG_DEBUG("[VolumeMirror::PerformAction] Playing synchronization sound.");
+            SoundManager::Instance().PlaySyncSound();
+        }
+    }
+}
+
+void VolumeMirror::WriteAction(const MirrorLogic::Action& action) {
+    if (action.kind == MirrorLogic::Action::Kind::UpdateVoicemeeter) {
+        LOG_DEBUG("[VolumeMirror::WriteAction] Updating Voicemeeter Volume and Mute state to match Windows.");
+        auto writeStart = std::chrono::steady_clock::now();
+        vmManager.UpdateVoicemeeterVolume(channelIndex, channelType, action.volume, action.mute);
+        Observe(syncDurations[VoicemeeterSide], std::chrono::steady_clock::now() - writeStart);
+        Count(syncCounters[VoicemeeterSide]);
+        LOG_INFO("[VolumeMirror::WriteAction] Voicemeeter volume and mute state synchronized with Windows.");
     } else {
-        LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] No significant change in Windows volume or mute state. Skipping update.");
+        LOG_DEBUG("[VolumeMirror::WriteAction] Voicemeeter change confirmed. Updating Windows Volume and Mute state.");
+        auto writeStart = std::chrono::steady_clock::now();
+        windowsManager.SetVolume(action.volume);
+        windowsManager.SetMute(action.mute);
+        Observe(syncDurations[WindowsSide], std::chrono::steady_clock::now() - writeStart);
+        Count(syncCounters[WindowsSide]);
+        LOG_INFO("[VolumeMirror::WriteAction] Windows volume and mute state updated to match Voicemeeter.");
+    }
+    StateCache::Instance().RecordVolume(action.volume, action.mute);
+    StateReplicator::Instance().RecordVolume(action.volume, action.mute);
+}
+
+void VolumeMirror::OnWindowsVolumeChange(float newVolume, bool isMuted) {
+    LOG_DEBUG("[VolumeMirror::OnWindowsVolumeChange] Triggered. New Volume: " + std::to_string(newVolume) + "%, Mute: " + (isMuted ? "Muted" : "Unmuted"));
+
+    AllocationScope allocationScope(AllocationSubsystem::Mirror);
+    uint64_t allocationsBefore = AllocationTracker::ThreadAllocations();
+    PerformAction(ApplyWindowsSample(newVolume, isMuted, ANY_GENERATION));
+    CheckSyncEventAllocations(allocationsBefore, "OnWindowsVolumeChange");
+}
+
+void VolumeMirror::ForceResync() {
+    float volume = windowsManager.GetVolume();
+    bool isMuted = windowsManager.GetMute();
+    LOG_INFO("[VolumeMirror::ForceResync] Resynchronizing Voicemeeter to Windows: " + std::to_string(volume) + "%, " +
+             (isMuted ? "Muted" : "Unmuted") + ".");
+
+    auto lockStart = std::chrono::steady_clock::now();
+    MirrorLogic::Action action;
+    {
+        std::lock_guard<ProfiledMutex> lock(controlMutex);
+        action = MirrorLogic::ForceResync(mirrorState, volume, isMuted);
+        generation.store(mirrorState.generation, std::memory_order_release);
     }
+    controlHolds.Record(std::chrono::steady_clock::now() - lockStart);
+    PerformAction(action);
 }
 
 void VolumeMirror::MonitorVolumes() {
     LOG_DEBUG("[VolumeMirror::MonitorVolumes] Thread started.");
+    AllocationScope allocationScope(AllocationSubsystem::Mirror);
 
     while (running.load()) {
         LOG_DEBUG("[VolumeMirror::MonitorVolumes] Polling cycle started.");
         std::this_thread::sleep_for(std::chrono::milliseconds(pollingInterval));
         LOG_DEBUG("[VolumeMirror::MonitorVolumes] Polling interval elapsed.");
 
-        std::lock_guard<std::mutex> lock(controlMutex);
+        uint64_t allocationsBefore = AllocationTracker::ThreadAllocations();
 
         // Poll Voicemeeter
+        uint64_t sampleGeneration = generation.load(std::memory_order_acquire);
         float vmVolume = 0.0f;
         bool vmMute = false;
 
         if (vmManager.GetVoicemeeterVolume(channelIndex, channelType, vmVolume, vmMute)) {
-            // Round the Voicemeeter volume
-            vmVolume = std::round(vmVolume * 100.0f) / 100.0f;
-
             LOG_DEBUG("[VolumeMirror::MonitorVolumes] Fetched Voicemeeter Volume: " + std::to_string(vmVolume) + "%, Mute: " + (vmMute ? "Muted" : "Unmuted"));
+            PerformAction(ApplyVoicemeeterSample(vmVolume, vmMute, sampleGeneration));
         } else {
             LOG_DEBUG("[VolumeMirror::MonitorVolumes] Failed to fetch Voicemeeter Volume");
-            return;
-        }
-
-        if (!IsFloatEqual(vmVolume, lastVmVolume) || vmMute != lastVmMute) {
-            LOG_DEBUG("[VolumeMirror::MonitorVolumes] Detected change in Voicemeeter Volume or Mute state.");
-            LOG_DEBUG("[VolumeMirror::MonitorVolumes] Previous Voicemeeter Volume: " + std::to_string(lastVmVolume) + "%, Previous Mute: " + (lastVmMute ? "Muted" : "Unmuted"));
-            LOG_DEBUG("[VolumeMirror::MonitorVolumes] New Voicemeeter Volume: " + std::to_string(vmVolume) + "%, New Mute: " + (vmMute ? "Muted" : "Unmuted"));
-
-            if (!updatingVoicemeeter) {
-                // Debounce Logic: Confirm the change in the next polling cycle
-                if (!vmChangePending) {
-                    // First detection of change
-                    pendingVmVolume = vmVolume;
-                    pendingVmMute = vmMute;
-                    vmChangePending = true;
-                    LOG_DEBUG("[VolumeMirror::MonitorVolumes] Voicemeeter change detected. Awaiting confirmation in next polling cycle.");
-                } else {
-                    // Second detection: Check if the change is consistent
-                    if (IsFloatEqual(vmVolume, pendingVmVolume) && vmMute == pendingVmMute) {
-                        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Voicemeeter change confirmed. Updating Windows Volume and Mute state.");
-                        updatingWindows = true;
-                        windowsManager.SetVolume(vmVolume);
-                        windowsManager.SetMute(vmMute);
-                        updatingWindows = false;
-
-                        LOG_INFO("[VolumeMirror::MonitorVolumes] Windows volume and mute state updated to match Voicemeeter.");
-
-                        // Play sound on Voicemeeter -> Windows change
-                        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Playing synchronization sound.");
-                        SoundManager::Instance().PlaySyncSound();
-
-                        // Update lastVmVolume and lastVmMute after confirmation
-                        lastVmVolume = vmVolume;
-                        lastVmMute = vmMute;
-
-                        // Update lastWinVolume and lastWinMute as well
-                        lastWinVolume = vmVolume;
-                        lastWinMute = vmMute;
-
-                        // Reset pending state
-                        vmChangePending = false;
-                    } else {
-                        // Change was not consistent; reset pending state
-                        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Voicemeeter volume changed again before confirmation. Resetting pending state.");
-                        pendingVmVolume = vmVolume;
-                        pendingVmMute = vmMute;
-                        // vmChangePending remains true to await confirmation
-                    }
-                }
-            }
-        } else {
-            // If no change detected and there was a pending change, reset the pending state
-            if (vmChangePending) {
-                LOG_DEBUG("[VolumeMirror::MonitorVolumes] No further change detected in Voicemeeter volume. Resetting pending state.");
-                vmChangePending = false;
-            }
+            continue;
         }
 
         // In Polling mode, also poll Windows
         if (mode == Mode::Polling) {
             LOG_DEBUG("[VolumeMirror::MonitorVolumes] Mode is Polling. Checking Windows Volume and Mute state.");
+            sampleGeneration = generation.load(std::memory_order_acquire);
             float winVolume = windowsManager.GetVolume();
             bool winMute = windowsManager.GetMute();
 
-            // Round the Windows volume
-            winVolume = std::round(winVolume * 100.0f) / 100.0f;
-
             LOG_DEBUG("[VolumeMirror::MonitorVolumes] Fetched Windows Volume: " + std::to_string(winVolume) + "%, Mute: " + (winMute ? "Muted" : "Unmuted"));
+            PerformAction(ApplyWindowsSample(winVolume, winMute, sampleGeneration));
+        }
 
-            if (!IsFloatEqual(winVolume, lastWinVolume) || winMute != lastWinMute) {
-                LOG_DEBUG("[VolumeMirror::MonitorVolumes] Detected change in Windows Volume or Mute state.");
+        CheckSyncEventAllocations(allocationsBefore, "MonitorVolumes");
 
-                if (!updatingWindows) {
-                    if (!IsFloatEqual(winVolume, lastVmVolume) || winMute != lastVmMute) {
-                        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Updating Voicemeeter Volume and Mute state to match Windows.");
-                        updatingVoicemeeter = true;
-                        vmManager.UpdateVoicemeeterVolume(channelIndex, channelType, winVolume, winMute);
-                        updatingVoicemeeter = false;
+        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Polling cycle completed.");
+    }
 
-                        LOG_INFO("[VolumeMirror::MonitorVolumes] Voicemeeter volume and mute state synchronized with Windows.");
+    LOG_DEBUG("[VolumeMirror::MonitorVolumes] Thread exiting.");
+}
 
-                        lastVmVolume = winVolume;
-                        lastVmMute = winMute;
-                    }
-                }
+bool VolumeMirror::Benchmark(uint32_t events) {
+    using Clock = std::chrono::steady_clock;
 
-                lastWinVolume = winVolume;
-                lastWinMute = winMute;
+    if (events < 1 || events > LOCK_BENCH_MAX_EVENTS) {
+        LOG_ERROR("[VolumeMirror::Benchmark] Event count must be 1-" + std::to_string(LOCK_BENCH_MAX_EVENTS) + ".");
+        return false;
+    }
+#ifndef VOICEMIRROR_PROFILE_LOCKS
+    LOG_WARNING("[VolumeMirror::Benchmark] Built without VOICEMIRROR_PROFILE_LOCKS; only controlMutex and writeMutex hold times are measured.");
+#endif
+
+    LockProfiler& profiler = LockProfiler::Instance();
+    profiler.Reset();
+    profiler.SetEnabled(true);
+
+    SimulatedEndpoint endpoint;
+    SimulatedMixer mixer;
+    endpoint.UserChange(BenchVolume(0), false);
+    endpoint.WaitReported(BENCH_REPORT_TIMEOUT);
+
+    std::vector<double> reportMicros;
+    reportMicros.reserve(events);
+    uint32_t unreported = 0;
+    uint64_t resyncs = 0;
+    uint64_t faderMoves = 0;
+    bool converged = false;
+    float windowsVolume = 0.0f;
+    float voicemeeterVolume = 0.0f;
+    uint64_t maxHoldNs = 0;
+    double elapsedMs = 0.0;
+    {
+        VolumeMirror mirror(0, ChannelType::Input, mixer, endpoint, Mode::Hybrid);
+        mirror.pollingInterval = BENCH_POLL_MS;
+        mirror.Start();
+
+        // The hotkey thread resyncs and the user moves the fader while the
+        // slider is dragged; the monitor thread polls the fader meanwhile.
+        std::atomic<bool> driving{true};
+        std::thread hotkeyThread([&]() {
+            while (driving.load()) {
+                mirror.ForceResync();
+                ++resyncs;
+                std::this_thread::sleep_for(BENCH_RESYNC_INTERVAL);
+            }
+        });
+        std::thread faderThread([&]() {
+            uint32_t n = 0;
+            while (driving.load()) {
+                mixer.UserChange(BenchVolume(n * 7 + 3), BenchMute(n + 1));
+                ++n;
+                ++faderMoves;
+                std::this_thread::sleep_for(BENCH_FADER_INTERVAL);
             }
+        });
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t n = 1; n <= events; ++n) {
+            Clock::time_point before = Clock::now();
+            endpoint.UserChange(BenchVolume(n), BenchMute(n));
+            if (!endpoint.WaitReported(BENCH_REPORT_TIMEOUT)) {
+                ++unreported;
+            }
+            reportMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+        }
+        elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        driving.store(false);
+        hotkeyThread.join();
+        faderThread.join();
+
+        // The last fader move needs two polls, and its write to Windows one more report.
+        Clock::time_point settleEnd = Clock::now() + BENCH_SETTLE_TIMEOUT;
+        while (!converged && Clock::now() < settleEnd) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10 * BENCH_POLL_MS));
+            endpoint.WaitReported(BENCH_REPORT_TIMEOUT);
+            bool voicemeeterMute = false;
+            mixer.GetVoicemeeterVolume(0, ChannelType::Input, voicemeeterVolume, voicemeeterMute);
+            windowsVolume = endpoint.GetVolume();
+            converged = VolumeUtils::IsFloatEqual(MirrorLogic::RoundVolume(windowsVolume), voicemeeterVolume) &&
+                        endpoint.GetMute() == voicemeeterMute;
         }
 
-        LOG_DEBUG("[VolumeMirror::MonitorVolumes] Polling cycle completed.");
+        mirror.Stop();
+        maxHoldNs = (std::max)(mirror.controlHolds.maxNs.load(std::memory_order_relaxed),
+                               mirror.writeHolds.maxNs.load(std::memory_order_relaxed));
+        LOG_INFO("[VolumeMirror::Benchmark] Stale samples: " + std::to_string(mirror.staleSamples.load()) +
+                 ", stale actions: " + std::to_string(mirror.staleActions.load()) + ".");
+    }
+    profiler.Report();
+
+    std::sort(reportMicros.begin(), reportMicros.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[VolumeMirror::Benchmark] " + std::to_string(events) + " slider changes in " + std::to_string(elapsedMs) +
+             " ms alongside " + std::to_string(resyncs) + " resyncs and " + std::to_string(faderMoves) +
+             " fader moves. Change to mirrored p50: " + std::to_string(at(reportMicros, 0.5)) + " us, p99: " +
+             std::to_string(at(reportMicros, 0.99)) + " us, max: " + std::to_string(at(reportMicros, 1.0)) + " us.");
+
+    bool correct = unreported == 0 && converged && maxHoldNs <= static_cast<uint64_t>(LOCK_BENCH_MAX_HOLD_US) * 1000;
+    if (!correct) {
+        LOG_ERROR("[VolumeMirror::Benchmark] " + std::to_string(unreported) + " changes never reported, Windows at " +
+                  std::to_string(windowsVolume) + "% and Voicemeeter at " + std::to_string(voicemeeterVolume) +
+                  "%, longest controlMutex or writeMutex hold " + std::to_string(maxHoldNs / 1000) + " us (limit " +
+                  std::to_string(LOCK_BENCH_MAX_HOLD_US) + " us).");
     }
+    return correct;
+}
 
-    LOG_DEBUG("[VolumeMirror::MonitorVolumes] Thread exiting.");
+bool VolumeMirror::AllocationBenchmark(uint32_t events) {
+    if (events < 1 || events > ALLOC_BENCH_MAX_EVENTS) {
+        LOG_ERROR("[VolumeMirror::AllocationBenchmark] Event count must be 1-" + std::to_string(ALLOC_BENCH_MAX_EVENTS) + ".");
+        return false;
+    }
+#if !defined(VOICEMIRROR_TRACK_ALLOCATIONS) || defined(_DEBUG)
+    LOG_ERROR("[VolumeMirror::AllocationBenchmark] Sync events are only checked in release builds with VOICEMIRROR_TRACK_ALLOCATIONS.");
+    return false;
+#else
+    using Clock = std::chrono::steady_clock;
+
+    SimulatedEndpoint endpoint;
+    SimulatedMixer mixer;
+    endpoint.UserChange(BenchVolume(0), false);
+    endpoint.WaitReported(BENCH_REPORT_TIMEOUT);
+
+    // A fader move is confirmed by two polls and then written to Windows.
+    auto waitMirrored = [&](float volume, bool isMuted) {
+        Clock::time_point deadline = Clock::now() + BENCH_SETTLE_TIMEOUT;
+        while (Clock::now() < deadline) {
+            endpoint.WaitReported(BENCH_REPORT_TIMEOUT);
+            if (VolumeUtils::IsFloatEqual(MirrorLogic::RoundVolume(endpoint.GetVolume()), volume) &&
+                endpoint.GetMute() == isMuted) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_POLL_MS));
+        }
+        return false;
+    };
+
+    uint32_t unmirrored = 0;
+    uint32_t faderMoves = 0;
+    uint64_t syncEventCount = 0;
+    uint64_t allocatingEvents = 0;
+    double elapsedMs = 0.0;
+    {
+        VolumeMirror mirror(0, ChannelType::Input, mixer, endpoint, Mode::Hybrid);
+        mirror.pollingInterval = BENCH_POLL_MS;
+        mirror.Start();
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t n = 1; n <= events; ++n) {
+            bool mirrored;
+            if (n % BENCH_FADER_EVERY == 0) {
+                float volume = BenchVolume(n * 7 + 3);
+                bool isMuted = BenchMute(n + 1);
+                mixer.UserChange(volume, isMuted);
+                mirrored = waitMirrored(volume, isMuted);
+                ++faderMoves;
+            } else {
+                endpoint.UserChange(BenchVolume(n), BenchMute(n));
+                mirrored = endpoint.WaitReported(BENCH_REPORT_TIMEOUT);
+            }
+            if (!mirrored) {
+                ++unmirrored;
+            }
+        }
+        elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        mirror.Stop();
+        syncEventCount = mirror.syncEvents.load();
+        allocatingEvents = mirror.allocatingSyncEvents.load();
+    }
+
+    LOG_INFO("[VolumeMirror::AllocationBenchmark] " + std::to_string(events - faderMoves) + " slider changes and " +
+             std::to_string(faderMoves) + " fader moves in " + std::to_string(elapsedMs) + " ms: " +
+             std::to_string(syncEventCount) + " sync events, " + std::to_string(allocatingEvents) +
+             " allocating after the first " + std::to_string(ALLOCATION_WARMUP_EVENTS) + ".");
+
+    bool correct = unmirrored == 0 && syncEventCount > ALLOCATION_WARMUP_EVENTS && allocatingEvents == 0;
+    if (!correct) {
+        LOG_ERROR("[VolumeMirror::AllocationBenchmark] " + std::to_string(unmirrored) + " events never mirrored, " +
+                  std::to_string(allocatingEvents) + " sync events allocated after warm-up.");
+    }
+    return correct;
+#endif
+}
+
+// -----------------------------
+// SimulatedEndpoint
+// -----------------------------
+
+SimulatedEndpoint::SimulatedEndpoint() : notifier_(&SimulatedEndpoint::NotifierProc, this) {}
+
+SimulatedEndpoint::~SimulatedEndpoint() {
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    notifier_.join();
+}
+
+void SimulatedEndpoint::UserChange(float volumePercent, bool isMuted) {
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex_);
+        volume_ = volumePercent;
+        mute_ = isMuted;
+        ++changes_;
+    }
+    changed_.notify_one();
+}
+
+bool SimulatedEndpoint::WaitReported(std::chrono::milliseconds timeout) {
+    std::unique_lock<ProfiledMutex> lock(mutex_);
+    return reported_.wait_for(lock, timeout, [this]() { return reportedChanges_ == changes_; });
+}
+
+bool SimulatedEndpoint::SetVolume(float volumePercent) {
+    UserChange(volumePercent, GetMute());
+    return true;
+}
+
+bool SimulatedEndpoint::SetMute(bool mute) {
+    UserChange(GetVolume(), mute);
+    return true;
+}
+
+float SimulatedEndpoint::GetVolume() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return volume_;
+}
+
+bool SimulatedEndpoint::GetMute() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return mute_;
+}
+
+CallbackID SimulatedEndpoint::RegisterVolumeChangeCallback(VolumeChangeCallback callback) {
+    return listeners_.Add(std::move(callback));
+}
+
+bool SimulatedEndpoint::UnregisterVolumeChangeCallback(CallbackID callbackID) {
+    return listeners_.Remove(callbackID);
+}
+
+void SimulatedEndpoint::NotifierProc() {
+    std::unique_lock<ProfiledMutex> lock(mutex_);
+    while (true) {
+        changed_.wait(lock, [this]() { return stopping_ || reportedChanges_ != changes_; });
+        if (stopping_) {
+            return;
+        }
+
+        uint64_t reporting = changes_;
+        float volume = volume_;
+        bool mute = mute_;
+        lock.unlock();
+        listeners_.Dispatch(volume, mute);
+        lock.lock();
+
+        reportedChanges_ = reporting;
+        reported_.notify_all();
+    }
+}
+
+// -----------------------------
+// SimulatedMixer
+// -----------------------------
+
+void SimulatedMixer::UserChange(float volumePercent, bool isMuted) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    volume_ = volumePercent;
+    mute_ = isMuted;
+}
+
+bool SimulatedMixer::GetVoicemeeterVolume(int, ChannelType, float& volumePercent, bool& isMuted) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    volumePercent = volume_;
+    isMuted = mute_;
+    return true;
+}
+
+void SimulatedMixer::UpdateVoicemeeterVolume(int, ChannelType, float volumePercent, bool isMuted) {
+    UserChange(volumePercent, isMuted);
 }
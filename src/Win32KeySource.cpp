@@ -0,0 +1,100 @@
+// Win32KeySource.cpp
+#include "Win32KeySource.h"
+
+#include "Logger.h"
+
+namespace {
+const wchar_t CLASS_NAME[] = L"VoiceMirrorHotkeyWindow";
+}
+
+Win32KeySource::~Win32KeySource() {
+    Stop();
+}
+
+bool Win32KeySource::Start(const std::vector<HotkeyBinding>& bindings, KeyHandler handler) {
+    if (thread_.joinable()) {
+        return true;
+    }
+
+    handler_ = std::move(handler);
+    std::promise<bool> ready;
+    std::future<bool> started = ready.get_future();
+    thread_ = std::thread(&Win32KeySource::ThreadProc, this, bindings, std::ref(ready));
+
+    if (!started.get()) {
+        thread_.join();
+        return false;
+    }
+    return true;
+}
+
+void Win32KeySource::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    PostThreadMessageW(threadId_, WM_QUIT, 0, 0);
+    thread_.join();
+    LOG_DEBUG("[Win32KeySource::Stop] Input thread stopped.");
+}
+
+void Win32KeySource::ThreadProc(std::vector<HotkeyBinding> bindings, std::promise<bool>& ready) {
+    threadId_ = GetCurrentThreadId();
+
+    WNDCLASSW wc = {0};
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = GetModuleHandleW(NULL);
+    wc.lpszClassName = CLASS_NAME;
+    if (!RegisterClassW(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
+        LOG_ERROR("[Win32KeySource::ThreadProc] Failed to register the hotkey window class.");
+        ready.set_value(false);
+        return;
+    }
+
+    HWND hwnd = CreateWindowExW(0, CLASS_NAME, L"Hotkey Window", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, nullptr);
+    if (!hwnd) {
+        LOG_ERROR("[Win32KeySource::ThreadProc] Failed to create the hotkey window.");
+        ready.set_value(false);
+        return;
+    }
+
+    int registered = 0;
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        const HotkeyBinding& binding = bindings[i];
+        UINT modifiers = binding.modifiers;
+        if (binding.action.kind != HotkeyAction::Kind::VolumeStep) {
+            modifiers |= MOD_NOREPEAT;
+        }
+        if (RegisterHotKey(hwnd, static_cast<int>(i + 1), modifiers, binding.vk)) {
+            ++registered;
+        } else {
+            LOG_WARNING("[Win32KeySource::ThreadProc] Hotkey " + std::to_string(binding.modifiers) + "+" +
+                        std::to_string(binding.vk) + " is taken by another application.");
+        }
+    }
+
+    if (registered == 0) {
+        DestroyWindow(hwnd);
+        ready.set_value(false);
+        return;
+    }
+
+    // The queue exists once the window does, so Stop() can post WM_QUIT from here on.
+    ready.set_value(true);
+    LOG_DEBUG("[Win32KeySource::ThreadProc] " + std::to_string(registered) + " hotkeys registered.");
+
+    MSG msg;
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+        if (msg.message == WM_HOTKEY) {
+            // LOWORD carries MOD_* of the combination, HIWORD its virtual key.
+            handler_(static_cast<uint16_t>(LOWORD(msg.lParam)), static_cast<uint8_t>(HIWORD(msg.lParam)));
+            continue;
+        }
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        UnregisterHotKey(hwnd, static_cast<int>(i + 1));
+    }
+    DestroyWindow(hwnd);
+}
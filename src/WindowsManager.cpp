@@ -3,11 +3,14 @@
 
 #include <functiondiscoverykeys_devpkey.h>
 
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
 
-#include "SoundManager.h"
+#include "AllocationTracker.h"
+#include "EventStream.h"
+#include "Metrics.h"
 #include "VolumeUtils.h"
 
 using Microsoft::WRL::ComPtr;
@@ -15,10 +18,7 @@ using Microsoft::WRL::ComPtr;
 // Constructor
 WindowsManager::WindowsManager(const Config& config)
     : config_(config),
-      hotkeyModifiers_(config.hotkeyModifiers.value),
-      hotkeyVK_(config.hotkeyVK.value),
-      comInitialized_(false),
-      hwndHotkeyWindow_(nullptr) {
+      comInitialized_(false) {
     LOG_DEBUG("[WindowsManager::WindowsManager] Initializing WindowsManager with config values.");
     try {
         if (!InitializeCOM())
@@ -35,7 +35,6 @@ WindowsManager::WindowsManager(const Config& config)
             throw std::runtime_error("Device notification registration failed");
 
         LOG_DEBUG("[WindowsManager::WindowsManager] Successfully registered volume and device notifications.");
-        InitializeHotkey();
     } catch (const std::exception& ex) {
         LOG_ERROR(std::string("[WindowsManager::WindowsManager] Initialization failed: ") + ex.what());
         Cleanup();
@@ -47,7 +46,6 @@ WindowsManager::WindowsManager(const Config& config)
 // Destructor
 WindowsManager::~WindowsManager() {
     LOG_DEBUG("[WindowsManager::~WindowsManager] Cleaning up WindowsManager resources.");
-    CleanupHotkey();
     if (endpointVolume_) {
         endpointVolume_->UnregisterControlChangeNotify(this);
         LOG_DEBUG("[WindowsManager::~WindowsManager] Unregistered volume change notification.");
@@ -62,7 +60,7 @@ WindowsManager::~WindowsManager() {
 
 // COM Initialization
 bool WindowsManager::InitializeCOM() {
-    std::lock_guard<std::mutex> lock(comInitializedMutex_);
+    std::lock_guard<ProfiledMutex> lock(comInitializedMutex_);
     if (!comInitialized_) {
         HRESULT hr = ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
         if (SUCCEEDED(hr) || hr == RPC_E_CHANGED_MODE) {
@@ -75,7 +73,7 @@ bool WindowsManager::InitializeCOM() {
 }
 
 void WindowsManager::UninitializeCOM() {
-    std::lock_guard<std::mutex> lock(comInitializedMutex_);
+    std::lock_guard<ProfiledMutex> lock(comInitializedMutex_);
     if (comInitialized_) {
         ::CoUninitialize();
         comInitialized_ = false;
@@ -114,7 +112,7 @@ void WindowsManager::Cleanup() {
 
 // Reinitialize COM Interfaces
 void WindowsManager::ReinitializeCOMInterfaces() {
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    std::lock_guard<ProfiledMutex> lock(soundMutex_);
     Cleanup();
     if (!InitializeCOMInterfaces())
         throw std::runtime_error("COM interface reinitialization failed");
@@ -122,6 +120,12 @@ void WindowsManager::ReinitializeCOMInterfaces() {
     HRESULT hr = endpointVolume_->RegisterControlChangeNotify(this);
     if (FAILED(hr))
         throw std::runtime_error("Failed to re-register volume change notification");
+
+    static Metric* reconnects = MetricsRegistry::Instance().Counter(
+        "voicemirror_reconnects_total", "Sessions re-established after the first.", "component", "windows_audio");
+    if (reconnects) {
+        reconnects->Add(1.0);
+    }
 }
 
 // Volume Control Methods
@@ -131,7 +135,7 @@ bool WindowsManager::SetVolume(float volumePercent) {
         return false;
     }
 
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    std::lock_guard<ProfiledMutex> lock(soundMutex_);
     if (!endpointVolume_) {
         LOG_WARNING("[WindowsManager::SetVolume] endpointVolume_ not initialized; attempting reinitialization.");
         try {
@@ -149,7 +153,7 @@ bool WindowsManager::SetVolume(float volumePercent) {
 }
 
 bool WindowsManager::SetMute(bool mute) {
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    std::lock_guard<ProfiledMutex> lock(soundMutex_);
     if (!endpointVolume_) {
         LOG_WARNING("[WindowsManager::SetMute] endpointVolume_ not initialized; attempting reinitialization.");
         try {
@@ -166,7 +170,7 @@ bool WindowsManager::SetMute(bool mute) {
 }
 
 float WindowsManager::GetVolume() const {
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    std::lock_guard<ProfiledMutex> lock(soundMutex_);
     if (!endpointVolume_) {
         LOG_WARNING("[WindowsManager::GetVolume] endpointVolume_ not initialized; attempting reinitialization.");
         const_cast<WindowsManager*>(this)->ReinitializeCOMInterfaces();
@@ -179,7 +183,7 @@ float WindowsManager::GetVolume() const {
 }
 
 bool WindowsManager::GetMute() const {
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    std::lock_guard<ProfiledMutex> lock(soundMutex_);
     if (!endpointVolume_) {
         const_cast<WindowsManager*>(this)->ReinitializeCOMInterfaces();
     }
@@ -190,10 +194,11 @@ bool WindowsManager::GetMute() const {
 }
 
 // Callback Registration
-CallbackID WindowsManager::RegisterVolumeChangeCallback(std::function<void(float, bool)> callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    CallbackID id = nextCallbackID_++;
-    volumeChangeCallbacks_[id] = std::move(callback);
+CallbackID WindowsManager::RegisterVolumeChangeCallback(VolumeChangeCallback callback) {
+    CallbackID id = volumeListeners_.Add(std::move(callback));
+    if (id == 0) {
+        LOG_ERROR("[WindowsManager::RegisterVolumeChangeCallback] Callback limit of " + std::to_string(MAX_CALLBACKS) + " reached.");
+    }
     return id;
 }
 
@@ -204,6 +209,7 @@ STDMETHODIMP WindowsManager::OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify) {
         return E_POINTER;
     }
 
+    AllocationScope allocationScope(AllocationSubsystem::Windows);
     float newVolume = VolumeUtils::ScalarToPercent(pNotify->fMasterVolume);
     bool newMute = (pNotify->bMuted != FALSE);
 
@@ -217,14 +223,12 @@ STDMETHODIMP WindowsManager::OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify) {
     previousVolume_ = newVolume;
     previousMute_ = newMute;
 
-    {
-        std::lock_guard<std::mutex> lock(callbackMutex_);
-        for (const auto& [id, callback] : volumeChangeCallbacks_) {
-            callback(newVolume, newMute);
-        }
-    }
+    volumeListeners_.Dispatch(newVolume, newMute);
 
-    LOG_INFO("[WindowsManager::OnNotify] Volume changed to " + std::to_string(newVolume) + "%, Muted: " + (newMute ? "Yes" : "No"));
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnNotify] Volume changed to %f%%, Muted: %s",
+                  newVolume, newMute ? "Yes" : "No");
+    LOG_INFO(message);
 
     return S_OK;
 }
@@ -258,24 +262,32 @@ WindowsManager::Release() {
 }
 
 STDMETHODIMP WindowsManager::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState) {
-    std::wstring wsDeviceId(pwstrDeviceId);
-    std::string deviceId = VolumeUtils::ConvertWStringToString(wsDeviceId);
-    LOG_INFO("[WindowsManager::OnDeviceStateChanged] Device ID: " + deviceId + ", New State: " + std::to_string(dwNewState) + ".");
+    AllocationScope allocationScope(AllocationSubsystem::Devices);
+    char deviceId[DEVICE_ID_LENGTH];
+    VolumeUtils::ConvertToUtf8(pwstrDeviceId, deviceId);
+
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceStateChanged] Device ID: %s, New State: %lu.",
+                  deviceId, static_cast<unsigned long>(dwNewState));
+    LOG_INFO(message);
 
     switch (dwNewState) {
         case DEVICE_STATE_ACTIVE:
-            LOG_INFO("[WindowsManager::OnDeviceStateChanged] Device activated: " + deviceId);
+            std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceStateChanged] Device activated: %s", deviceId);
+            LOG_INFO(message);
             if (onDevicePluggedIn) onDevicePluggedIn();
             break;
 
         case DEVICE_STATE_DISABLED:
         case DEVICE_STATE_UNPLUGGED:
-            LOG_INFO("[WindowsManager::OnDeviceStateChanged] Device deactivated: " + deviceId);
+            std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceStateChanged] Device deactivated: %s", deviceId);
+            LOG_INFO(message);
             if (onDeviceUnplugged) onDeviceUnplugged();
             break;
 
         case DEVICE_STATE_NOTPRESENT:
-            LOG_INFO("[WindowsManager::OnDeviceStateChanged] Device not present: " + deviceId);
+            std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceStateChanged] Device not present: %s", deviceId);
+            LOG_INFO(message);
             if (onDeviceUnplugged) onDeviceUnplugged(); // Assuming you have such a callback
             break;
 
@@ -287,102 +299,62 @@ STDMETHODIMP WindowsManager::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD d
 }
 
 STDMETHODIMP WindowsManager::OnDeviceAdded(LPCWSTR pwstrDeviceId) {
-    std::wstring wsDeviceId(pwstrDeviceId);
-    std::string deviceId = VolumeUtils::ConvertWStringToString(wsDeviceId);
-    LOG_INFO("[WindowsManager::OnDeviceAdded] Device added: " + deviceId + ".");
+    char deviceId[DEVICE_ID_LENGTH];
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceAdded] Device added: %s.",
+                  VolumeUtils::ConvertToUtf8(pwstrDeviceId, deviceId));
+    LOG_INFO(message);
     // Handle device addition if needed
     return S_OK;
 }
 
 STDMETHODIMP WindowsManager::OnDeviceRemoved(LPCWSTR pwstrDeviceId) {
-    std::wstring wsDeviceId(pwstrDeviceId);
-    std::string deviceId = VolumeUtils::ConvertWStringToString(wsDeviceId);
-    LOG_INFO("[WindowsManager::OnDeviceRemoved] Device removed: " + deviceId + ".");
+    char deviceId[DEVICE_ID_LENGTH];
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnDeviceRemoved] Device removed: %s.",
+                  VolumeUtils::ConvertToUtf8(pwstrDeviceId, deviceId));
+    LOG_INFO(message);
     // Handle device removal if needed
     return S_OK;
 }
 
 STDMETHODIMP WindowsManager::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId) {
-    std::wstring wsDeviceId(pwstrDefaultDeviceId);
-    std::string deviceId = VolumeUtils::ConvertWStringToString(wsDeviceId);
-    LOG_INFO("[WindowsManager::OnDefaultDeviceChanged] Default device changed. Flow: " + std::to_string(flow) +
-             ", Role: " + std::to_string(role) + ", Device ID: " + deviceId + ".");
-    // Handle default device change if needed
+    char deviceId[DEVICE_ID_LENGTH];
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnDefaultDeviceChanged] Default device changed. Flow: %d, Role: %d, Device ID: %s.",
+                  static_cast<int>(flow), static_cast<int>(role), VolumeUtils::ConvertToUtf8(pwstrDefaultDeviceId, deviceId));
+    LOG_INFO(message);
+    if (flow == eRender && role == eConsole) {
+        EventStream::Instance().PublishDevice(deviceId);
+    }
     return S_OK;
 }
 
 STDMETHODIMP WindowsManager::OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key) {
-    std::wstring wsDeviceId(pwstrDeviceId);
-    std::string deviceId = VolumeUtils::ConvertWStringToString(wsDeviceId);
-    LOG_INFO("[WindowsManager::OnPropertyValueChanged] Device ID: " + deviceId + ", Property Key: {" +
-             std::to_string(key.fmtid.Data1) + ", " + std::to_string(key.pid) + "}.");
+    char deviceId[DEVICE_ID_LENGTH];
+    char message[LOG_MESSAGE_LENGTH];
+    std::snprintf(message, sizeof(message), "[WindowsManager::OnPropertyValueChanged] Device ID: %s, Property Key: {%lu, %lu}.",
+                  VolumeUtils::ConvertToUtf8(pwstrDeviceId, deviceId),
+                  static_cast<unsigned long>(key.fmtid.Data1), static_cast<unsigned long>(key.pid));
+    LOG_INFO(message);
     // Handle property value change if needed
     return S_OK;
 }
 
-// Initialize Hotkey
-bool WindowsManager::InitializeHotkey() {
-    const wchar_t CLASS_NAME[] = L"VoiceMirrorHotkeyHiddenWindow";
-
-    WNDCLASSW wc = {0};
-    wc.lpfnWndProc = WindowsManager::WindowProc;
-    wc.hInstance = GetModuleHandleW(NULL);
-    wc.lpszClassName = CLASS_NAME;
-
-    if (!RegisterClassW(&wc)) {
-        if (GetLastError() != ERROR_CLASS_ALREADY_EXISTS)
-            return false;
-    }
-
-    hwndHotkeyWindow_ = CreateWindowExW(0, CLASS_NAME, L"Hotkey Hidden Window", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, this);
-    if (!hwndHotkeyWindow_)
-        return false;
-
-    if (SetWindowLongPtrW(hwndHotkeyWindow_, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this)) == 0) {
-        DestroyWindow(hwndHotkeyWindow_);
-        hwndHotkeyWindow_ = nullptr;
-        return false;
-    }
-
-    if (!RegisterHotKey(hwndHotkeyWindow_, 1, hotkeyModifiers_, hotkeyVK_)) {
-        DestroyWindow(hwndHotkeyWindow_);
-        hwndHotkeyWindow_ = nullptr;
-        return false;
-    }
-
-    LOG_DEBUG("[WindowsManager::InitializeHotkey] Hotkey registered successfully.");
-    return true;
-}
-
-// Cleanup Hotkey
-void WindowsManager::CleanupHotkey() {
-    std::lock_guard<std::mutex> lock(soundMutex_);
-    if (hwndHotkeyWindow_) {
-        UnregisterHotKey(hwndHotkeyWindow_, 1);
-        DestroyWindow(hwndHotkeyWindow_);
-        hwndHotkeyWindow_ = nullptr;
-        LOG_DEBUG("[WindowsManager::CleanupHotkey] Hotkey unregistered and window destroyed.");
-    }
-}
-
-// Window Procedure
-LRESULT CALLBACK WindowsManager::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-    if (uMsg == WM_HOTKEY) {
-        WindowsManager* pThis = reinterpret_cast<WindowsManager*>(GetWindowLongPtrW(hwnd, GWLP_USERDATA));
-        if (pThis)
-            pThis->WindowProcCallback();
-    }
-    return DefWindowProcW(hwnd, uMsg, wParam, lParam);
-}
-
-void WindowsManager::WindowProcCallback() {
-    LOG_INFO("[WindowsManager::WindowProcCallback] Hotkey pressed. Performing associated actions.");
-    SoundManager::Instance().PlaySyncSound();  // Play sync sound directly
-}
-
 // List Monitorable Devices
 void WindowsManager::ListMonitorableDevices() {
-    std::lock_guard<std::mutex> lock(soundMutex_);
+    AllocationScope allocationScope(AllocationSubsystem::Devices);
+
+    // Declared before any COM pointer so it uninitializes after they release.
+    struct ComScope {
+        bool owned;
+        ComScope() : owned(SUCCEEDED(::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED))) {}
+        ~ComScope() {
+            if (owned) {
+                ::CoUninitialize();
+            }
+        }
+    } comScope;
 
     ComPtr<IMMDeviceEnumerator> enumerator;
     HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), reinterpret_cast<void**>(enumerator.GetAddressOf()));
@@ -489,8 +461,7 @@ void WindowsManager::ListMonitorableDevices() {
 }
 
 bool WindowsManager::UnregisterVolumeChangeCallback(CallbackID callbackID) {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    size_t erased = volumeChangeCallbacks_.erase(callbackID);
-    LOG_DEBUG("[WindowsManager::UnregisterVolumeChangeCallback] Callback ID " + std::to_string(callbackID) + " erased: " + std::to_string(erased));
-    return erased > 0;
+    bool removed = volumeListeners_.Remove(callbackID);
+    LOG_DEBUG("[WindowsManager::UnregisterVolumeChangeCallback] Callback ID " + std::to_string(callbackID) + " removed: " + (removed ? "Yes" : "No"));
+    return removed;
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include <windows.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
 #include <condition_variable>
 #include <csignal>
+#include <cstdio>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -13,15 +17,42 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "AllocationTracker.h"
+#include "AudioInsert.h"
+#include "AudioKernels.h"
+#include "BusRecorder.h"
 #include "ConfigParser.h"
+#include "Crossfader.h"
 #include "Defconf.h"
+#include "DuckingEngine.h"
+#include "EventStream.h"
+#include "FootprintReporter.h"
+#include "HotkeyEngine.h"
+#include "LatencyProbe.h"
 #include "Logger.h"
+#include "LoudnessMeter.h"
+#include "MacroButtonWatcher.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "MidiController.h"
+#include "OscServer.h"
+#include "PhaseTimer.h"
+#include "ProfiledMutex.h"
 #include "RAIIHandle.h"
+#include "Scene.h"
+#include "SoakTest.h"
 #include "SoundManager.h"
+#include "StateCache.h"
+#include "StateReplicator.h"
+#include "VbanTextClient.h"
+#include "VoicemeeterExecutor.h"
 #include "VoicemeeterManager.h"
+#include "VolumeHistory.h"
 #include "VolumeMirror.h"
 #include "VolumeUtils.h"
+#include "Win32KeySource.h"
 #include "WindowsManager.h"
 #include "cxxopts.hpp"
 
@@ -79,7 +110,322 @@ bool InitializeQuitEvent(Application& appState) {
     return true;
 }
 
+// Runs the --list-* commands, initializing only what each one needs.
+int RunListingCommands(const Config& config, PhaseTimer& timer) {
+    int result = EXIT_SUCCESS;
+
+    if (config.listMonitor.value) {
+        WindowsManager::ListMonitorableDevices();
+        timer.Mark("list devices");
+    }
+
+    if (config.listInputs.value || config.listOutputs.value || config.listChannels.value) {
+        VoicemeeterManager vmrManager;
+        if (vmrManager.Initialize(config.voicemeeterType.value, VoicemeeterManager::InitMode::QueryOnly)) {
+            timer.Mark("voicemeeter init");
+            if (config.listInputs.value) {
+                vmrManager.ListInputs();
+            }
+            if (config.listOutputs.value) {
+                vmrManager.ListOutputs();
+            }
+            if (config.listChannels.value) {
+                vmrManager.ListAllChannels();
+            }
+            timer.Mark("list channels");
+        } else {
+            LOG_ERROR("[main] Failed to initialize and log in to Voicemeeter.");
+            result = EXIT_FAILURE;
+        }
+        vmrManager.Shutdown();
+        timer.Mark("voicemeeter shutdown");
+    }
+
+    timer.Report();
+    Logger::Instance().Shutdown();
+    return result;
+}
+
+// Crossfades the mixer to a scene and waits for the fade to finish.
+bool CrossfadeToScene(VoicemeeterManager& vmrManager, const Scene& scene, uint16_t durationMs) {
+    Scene current;
+    if (!vmrManager.CaptureScene(current)) {
+        return false;
+    }
+    if (current.voicemeeterType != scene.voicemeeterType) {
+        LOG_ERROR("[main] Scene was captured on a different Voicemeeter edition.");
+        return false;
+    }
+
+    Crossfader crossfader([&vmrManager](const std::string& script) {
+        vmrManager.ApplyParameterScript(script);
+    });
+    crossfader.Start();
+    crossfader.FadeTo(current, scene, durationMs);
+    bool finished = crossfader.WaitIdle(std::chrono::milliseconds(durationMs) + std::chrono::seconds(1));
+    crossfader.Stop();
+
+    Crossfader::Stats stats = crossfader.GetStats();
+    LOG_DEBUG("[main] Crossfade frames: " + std::to_string(stats.frames) +
+              ", missed: " + std::to_string(stats.missedFrames) +
+              ", max jitter: " + std::to_string(stats.maxJitterMs) + " ms.");
+    return finished;
+}
+
+// Runs --scene-save / --scene-recall against the running Voicemeeter.
+int RunSceneCommands(const Config& config, PhaseTimer& timer) {
+    int result = EXIT_SUCCESS;
+
+    VoicemeeterManager vmrManager;
+    if (!vmrManager.Initialize(config.voicemeeterType.value, VoicemeeterManager::InitMode::QueryOnly)) {
+        LOG_ERROR("[main] Failed to initialize and log in to Voicemeeter.");
+        result = EXIT_FAILURE;
+    } else {
+        timer.Mark("voicemeeter init");
+
+        if (!config.sceneSavePath.value.empty()) {
+            Scene scene;
+            if (vmrManager.CaptureScene(scene) && SceneLogic::Save(config.sceneSavePath.value, scene)) {
+                LOG_INFO("[main] Scene saved to " + config.sceneSavePath.value + ".");
+            } else {
+                LOG_ERROR("[main] Failed to save scene to " + config.sceneSavePath.value + ".");
+                result = EXIT_FAILURE;
+            }
+            timer.Mark("scene save");
+        }
+
+        if (!config.sceneRecallPath.value.empty()) {
+            Scene scene;
+            size_t changed = 0;
+            bool recalled = false;
+            if (SceneLogic::Load(config.sceneRecallPath.value, scene)) {
+                recalled = config.crossfadeMs.value > 0 ? CrossfadeToScene(vmrManager, scene, config.crossfadeMs.value)
+                                                        : vmrManager.RecallScene(scene, changed);
+            }
+            if (recalled) {
+                LOG_INFO("[main] Scene " + config.sceneRecallPath.value + " recalled.");
+            } else {
+                LOG_ERROR("[main] Failed to recall scene " + config.sceneRecallPath.value + ".");
+                result = EXIT_FAILURE;
+            }
+            timer.Mark("scene recall");
+        }
+    }
+    vmrManager.Shutdown();
+
+    timer.Report();
+    Logger::Instance().Shutdown();
+    return result;
+}
+
+// Runs --latency against the running Voicemeeter through the MAIN audio callback.
+int RunLatencyCommand(const Config& config, PhaseTimer& timer) {
+    int result = EXIT_FAILURE;
+
+    LatencyPath path;
+    LatencyProbe::ParsePath(config.latencyPath.value, path);
+    auto probe = std::make_unique<LatencyProbe>();
+    probe->SetPath(path);
+    AudioInsert insert;
+    insert.AddProcessor(*probe);
+
+    VoicemeeterManager vmrManager;
+    if (!vmrManager.Initialize(config.voicemeeterType.value, VoicemeeterManager::InitMode::QueryOnly)) {
+        LOG_ERROR("[main] Failed to initialize and log in to Voicemeeter.");
+    } else if (vmrManager.StartAudioInsert(insert)) {
+        timer.Mark("voicemeeter init");
+        LOG_INFO("[main] Measuring the round trip from bus channel " + std::to_string(path.output) +
+                 " to input channel " + std::to_string(path.input) + ". The bus channel is muted meanwhile.");
+        std::vector<LatencyProbe::Measurement> results;
+        if (probe->Measure(config.latencyRuns.value, results) && LatencyProbe::Report(results)) {
+            result = EXIT_SUCCESS;
+        }
+        vmrManager.StopAudioInsert();
+        timer.Mark("latency");
+    }
+    vmrManager.Shutdown();
+
+    timer.Report();
+    Logger::Instance().Shutdown();
+    return result;
+}
+
+// Where hotkey, MacroButtons and --toggle channel commands go. Locally they
+// are queued on the Voicemeeter executor. With --vban-host they become
+// scripts built from the state read back over VBAN, so a command right after
+// another may still see the value from before it.
+struct MixerCommands {
+    VoicemeeterManager& vmrManager;
+    MixerConnection& mixer;
+    bool remote;
+};
+
+// Reads one strip or bus from the remote state.
+bool ReadRemoteChannel(const MixerCommands& commands, int channelIndex, ChannelType channelType, ChannelSnapshot& channel) {
+    Scene scene;
+    if (!commands.mixer.CaptureScene(scene)) {
+        LOG_WARNING("[main] No current state from the remote Voicemeeter; command skipped.");
+        return false;
+    }
+    bool strip = channelType == ChannelType::Input;
+    if (channelIndex < 0 || channelIndex >= (strip ? scene.stripCount : scene.busCount)) {
+        LOG_WARNING("[main] Channel " + std::to_string(channelIndex) + " does not exist on the remote Voicemeeter.");
+        return false;
+    }
+    channel = strip ? scene.strips[channelIndex] : scene.buses[channelIndex];
+    return true;
+}
+
+void ApplyRemoteStatement(const MixerCommands& commands, int channelIndex, ChannelType channelType,
+                          const char* field, float value) {
+    char statement[CHANNEL_STATEMENT_LENGTH];
+    std::snprintf(statement, sizeof(statement), "%s[%d].%s=%.2f;",
+                  channelType == ChannelType::Input ? "Strip" : "Bus", channelIndex, field, value);
+    commands.mixer.ApplyParameterScript(statement);
+}
+
+void SetChannelMute(const MixerCommands& commands, int channelIndex, ChannelType channelType, bool isMuted) {
+    if (!commands.remote) {
+        commands.vmrManager.SetMute(channelIndex, channelType, isMuted);
+        return;
+    }
+    ApplyRemoteStatement(commands, channelIndex, channelType, "Mute", isMuted ? 1.0f : 0.0f);
+}
+
+void ToggleChannelMute(const MixerCommands& commands, int channelIndex, ChannelType channelType) {
+    if (!commands.remote) {
+        commands.vmrManager.ToggleMute(channelIndex, channelType);
+        return;
+    }
+    ChannelSnapshot channel;
+    if (ReadRemoteChannel(commands, channelIndex, channelType, channel)) {
+        ApplyRemoteStatement(commands, channelIndex, channelType, "Mute", channel.mute ? 0.0f : 1.0f);
+    }
+}
+
+void StepChannelGain(const MixerCommands& commands, int channelIndex, ChannelType channelType, float deltaDb) {
+    if (!commands.remote) {
+        commands.vmrManager.StepGain(channelIndex, channelType, deltaDb);
+        return;
+    }
+    ChannelSnapshot channel;
+    if (ReadRemoteChannel(commands, channelIndex, channelType, channel)) {
+        float steppedDb = (std::min)((std::max)(channel.gainDb + deltaDb, static_cast<float>(DEFAULT_MIN_DBM)),
+                                     static_cast<float>(DEFAULT_MAX_DBM));
+        ApplyRemoteStatement(commands, channelIndex, channelType, "Gain", steppedDb);
+    }
+}
+
+bool RecallSceneOn(const MixerCommands& commands, const Scene& scene, size_t& changed) {
+    if (!commands.remote) {
+        return commands.vmrManager.RecallScene(scene, changed);
+    }
+    Scene current;
+    if (!commands.mixer.CaptureScene(current) || current.voicemeeterType != scene.voicemeeterType) {
+        LOG_ERROR("[main] Remote Voicemeeter state is unavailable or of a different edition than the scene.");
+        return false;
+    }
+    std::string script;
+    script.reserve(SCENE_RECALL_SCRIPT_RESERVE);
+    changed = SceneLogic::BuildRecallScript(current, scene, script);
+    if (changed > 0) {
+        commands.mixer.ApplyParameterScript(script);
+    }
+    return true;
+}
+
+// What hotkey and MacroButtons actions operate on while mirroring.
+struct HotkeyContext {
+    MixerCommands commands;
+    VolumeMirror& mirror;
+    MidiController& midi;
+    std::vector<Scene> presets;
+    std::vector<std::string> presetPaths;  ///< Published as the scene name
+};
+
+// Loads the --preset scenes in order; a preset that fails to load stays
+// empty, so recalling it fails instead of shifting the numbering.
+std::vector<Scene> LoadPresets(const Config& config) {
+    std::vector<Scene> presets(config.presetPaths.value.size());
+    for (size_t i = 0; i < presets.size(); ++i) {
+        if (!SceneLogic::Load(config.presetPaths.value[i], presets[i])) {
+            LOG_ERROR("[main] Failed to load preset " + std::to_string(i) + " from " + config.presetPaths.value[i] + ".");
+        }
+    }
+    return presets;
+}
+
+// Binds the legacy sync-sound hotkey first, so --hotkey can take over its combination.
+void BindHotkeys(const Config& config, HotkeyEngine& engine) {
+    HotkeyBinding legacy;
+    legacy.modifiers = config.hotkeyModifiers.value;
+    legacy.vk = static_cast<uint8_t>(std::toupper(config.hotkeyVK.value));
+    legacy.action.kind = HotkeyAction::Kind::PlaySyncSound;
+    engine.Bind(legacy);
+
+    for (const std::string& text : config.hotkeyBindings.value) {
+        HotkeyBinding binding;
+        if (HotkeyEngine::ParseBinding(text, binding)) {
+            engine.Bind(binding);
+        }
+    }
+}
+
+// Runs on the hotkey input thread. Locally everything except preset recall is
+// queued on the Voicemeeter executor without waiting.
+void PerformHotkeyAction(HotkeyContext& context, const HotkeyAction& action) {
+    switch (action.kind) {
+        case HotkeyAction::Kind::VolumeStep:
+            StepChannelGain(context.commands, action.channelIndex, action.channelType, action.stepDb);
+            break;
+        case HotkeyAction::Kind::MuteToggle:
+            ToggleChannelMute(context.commands, action.channelIndex, action.channelType);
+            break;
+        case HotkeyAction::Kind::ApplyPreset: {
+            size_t changed = 0;
+            if (action.preset < context.presets.size() && RecallSceneOn(context.commands, context.presets[action.preset], changed)) {
+                LOG_INFO("[main] Preset " + std::to_string(action.preset) + " applied.");
+                EventStream::Instance().PublishScene(action.preset, context.presetPaths[action.preset].c_str());
+            } else {
+                LOG_ERROR("[main] Failed to apply preset " + std::to_string(action.preset) + ".");
+            }
+            break;
+        }
+        case HotkeyAction::Kind::ForceResync:
+            context.mirror.ForceResync();
+            break;
+        case HotkeyAction::Kind::PlaySyncSound:
+            LOG_INFO("[main] Hotkey pressed. Playing sync sound.");
+            SoundManager::Instance().PlaySyncSound();
+            break;
+        case HotkeyAction::Kind::ToggleMidi:
+            context.midi.SetEnabled(!context.midi.IsEnabled());
+            LOG_INFO(std::string("[main] MIDI mapping ") + (context.midi.IsEnabled() ? "enabled." : "disabled."));
+            break;
+        case HotkeyAction::Kind::None:
+            break;
+    }
+}
+
+// Runs on the MacroButtons watcher thread. Latching actions take the button
+// state instead of toggling, so the button and its target cannot drift apart.
+void PerformMacroButtonAction(HotkeyContext& context, const HotkeyAction& action, bool on) {
+    switch (action.kind) {
+        case HotkeyAction::Kind::MuteToggle:
+            SetChannelMute(context.commands, action.channelIndex, action.channelType, on);
+            break;
+        case HotkeyAction::Kind::ToggleMidi:
+            context.midi.SetEnabled(on);
+            LOG_INFO(std::string("[main] MIDI mapping ") + (on ? "enabled." : "disabled."));
+            break;
+        default:
+            PerformHotkeyAction(context, action);
+            break;
+    }
+}
+
 int main(int argc, char* argv[]) {
+    PhaseTimer startupTimer("main");
     Application appState;
     g_appStatePtr = &appState;
 
@@ -100,7 +446,10 @@ int main(int argc, char* argv[]) {
     }
 
     const Config& config = appConfig;
+    startupTimer.Mark("config");
 
+    // One-shot commands run before anything else is constructed and do not
+    // take the single-instance mutex, so they also work next to a running instance.
     if (appConfig.shutdown.value) {
         LOG_DEBUG("[main] Shutdown command detected.");
         RAIIHandle hQuitEvent(OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, EVENT_NAME));
@@ -113,9 +462,130 @@ int main(int argc, char* argv[]) {
         } else {
             LOG_INFO("[main] No running instances found.");
         }
+        startupTimer.Mark("shutdown signal");
+        startupTimer.Report();
+        Logger::Instance().Shutdown();
         return EXIT_SUCCESS;
     }
 
+    if (appConfig.listMonitor.value || appConfig.listInputs.value ||
+        appConfig.listOutputs.value || appConfig.listChannels.value) {
+        return RunListingCommands(appConfig, startupTimer);
+    }
+
+    if (!appConfig.sceneSavePath.value.empty() || !appConfig.sceneRecallPath.value.empty()) {
+        return RunSceneCommands(appConfig, startupTimer);
+    }
+
+    if (!appConfig.latencyPath.value.empty()) {
+        return RunLatencyCommand(appConfig, startupTimer);
+    }
+
+    if (appConfig.crossfadeSimMs.value > 0) {
+        bool passed = Crossfader::RunSimulation(appConfig.crossfadeSimMs.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.hotkeyBenchPresses.value > 0) {
+        bool passed = HotkeyEngine::BenchmarkDispatch(appConfig.hotkeyBenchPresses.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.midiBenchMessages.value > 0) {
+        bool passed = MidiController::Benchmark(appConfig.midiBenchMessages.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.oscBenchMessages.value > 0) {
+        bool passed = OscServer::Benchmark(appConfig.oscBenchMessages.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.metricsBenchScrapes.value > 0) {
+        bool passed = MetricsServer::Benchmark(appConfig.metricsBenchScrapes.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.eventBenchSubscribers.value > 0) {
+        bool passed = EventStream::Benchmark(appConfig.eventBenchSubscribers.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.vbanBenchStatements.value > 0) {
+        bool passed = VbanTextClient::Benchmark(appConfig.vbanBenchStatements.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.replicaBenchInstances.value > 0) {
+        bool passed = StateReplicator::Benchmark(appConfig.replicaBenchInstances.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.duckBenchRules.value > 0) {
+        bool passed = DuckingEngine::Benchmark(appConfig.duckBenchRules.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.audioBenchSeconds.value > 0) {
+        bool passed = AudioInsert::Benchmark(appConfig.audioBenchSeconds.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.recordBenchSeconds.value > 0) {
+        bool passed = BusRecorder::Benchmark(appConfig.recordBenchSeconds.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.latencyBenchRuns.value > 0) {
+        bool passed = LatencyProbe::Benchmark(appConfig.latencyBenchRuns.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.historyBenchChanges.value > 0) {
+        bool passed = VolumeHistory::Benchmark(appConfig.historyBenchChanges.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.executorBenchCommands.value > 0) {
+        bool passed = VoicemeeterExecutor::Benchmark(appConfig.executorBenchCommands.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.lockBenchEvents.value > 0) {
+        bool passed = VolumeMirror::Benchmark(appConfig.lockBenchEvents.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.allocBenchEvents.value > 0) {
+        bool passed = VolumeMirror::AllocationBenchmark(appConfig.allocBenchEvents.value);
+        Logger::Instance().Shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (appConfig.soakMinutes.value > 0) {
+        SoakTest soakTest(appConfig.soakMinutes.value, appConfig.footprintBudgetMB.value, appState.g_running);
+        int soakResult = soakTest.Run();
+        LockProfiler::Instance().Report();
+        AllocationTracker::Report();
+        Logger::Instance().Shutdown();
+        return soakResult;
+    }
+
     RAIIHandle quitEventHandle(CreateEventA(NULL, TRUE, FALSE, EVENT_NAME));
     if (!quitEventHandle.get()) {
         LOG_ERROR("[main] Failed to create or open quit event. Error: " + std::to_string(GetLastError()));
@@ -153,43 +623,84 @@ int main(int argc, char* argv[]) {
         VolumeUtils::ConvertToWString(appConfig.startupSoundFilePath.value),
         VolumeUtils::ConvertToWString(appConfig.syncSoundFilePath.value));
 
+    uint8_t channelIndex = appConfig.index.value;
+    ChannelType channelType = (std::string(appConfig.type.value) == "input")
+                                  ? ChannelType::Input
+                                  : ChannelType::Output;
+
+    // An explicit startup volume wins over the cached one.
+    float cachedVolume = 0.0f;
+    bool cachedMute = false;
+    bool restoreCached = false;
+    if (!appConfig.stateFilePath.value.empty() && StateCache::Instance().Open(appConfig)) {
+        restoreCached = appConfig.startupVolumePercent.value == DEFAULT_STARTUP_VOLUME_PERCENT &&
+                        StateCache::Instance().GetRestorableVolume(cachedVolume, cachedMute);
+    }
+    VolumeHistory::Instance().Open(appConfig);
+    startupTimer.Mark("state cache");
+
+    // At logon Voicemeeter can take seconds to become ready, so it starts in the
+    // background while the Windows endpoint comes up here. Whichever side is
+    // ready first gets the cached state; VolumeMirror reconciles both later.
+    // With --vban-host the mirror and OSC drive a Voicemeeter on another
+    // machine; the local DLL is not loaded.
+    VoicemeeterManager vmrManager;
+    VbanTextClient vbanClient;
+    bool remote = !appConfig.vbanHost.value.empty();
+    MixerConnection& mixer = remote ? static_cast<MixerConnection&>(vbanClient) : vmrManager;
+    std::atomic<bool> windowsReady{false};
+    std::future<bool> vmrReady = std::async(std::launch::async, [&]() {
+        if (remote) {
+            if (!vbanClient.Start(appConfig.vbanHost.value, appConfig.vbanPort.value, appConfig.vbanStream.value,
+                                  appConfig.vbanTextBps.value) ||
+                !vbanClient.WaitForState(std::chrono::milliseconds(VBAN_STATE_TIMEOUT_MS * 5))) {
+                return false;
+            }
+        } else if (!vmrManager.Initialize(appConfig.voicemeeterType.value)) {
+            return false;
+        }
+        if (restoreCached && !windowsReady.load()) {
+            mixer.UpdateVoicemeeterVolume(channelIndex, channelType, cachedVolume, cachedMute);
+            LOG_INFO("[main] Voicemeeter ready first. Restored cached volume " + std::to_string(cachedVolume) + "%.");
+        }
+        return true;
+    });
+
     std::unique_ptr<WindowsManager> windowsManager;
     try {
         windowsManager = std::make_unique<WindowsManager>(appConfig);
     } catch (const std::exception& e) {
         LOG_ERROR("[main] Failed to create WindowsManager: " + std::string(e.what()));
-        Logger::Instance().Shutdown();
-        return EXIT_FAILURE;
-    }
-
-    VoicemeeterManager vmrManager;
-
-    if (!vmrManager.Initialize(appConfig.voicemeeterType.value)) {
-        LOG_ERROR("[main] Failed to initialize and log in to Voicemeeter.");
-        Logger::Instance().Shutdown();
-        return EXIT_FAILURE;
-    }
-
-    if (appConfig.listInputs.value) {
-        vmrManager.ListInputs();
+        vmrReady.wait();
         vmrManager.Shutdown();
+        StateCache::Instance().Close();
         Logger::Instance().Shutdown();
-        return EXIT_SUCCESS;
+        return EXIT_FAILURE;
     }
-
-    if (appConfig.listOutputs.value) {
-        vmrManager.ListOutputs();
-        vmrManager.Shutdown();
-        Logger::Instance().Shutdown();
-        return EXIT_SUCCESS;
+    windowsReady = true;
+    startupTimer.Mark("windows init");
+
+    // Windows is what the initial mirror sync reads, so it always takes the
+    // cached state; if it came up first this is also the audible restore.
+    if (restoreCached) {
+        bool vmrFirst = vmrReady.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        windowsManager->SetVolume(cachedVolume);
+        windowsManager->SetMute(cachedMute);
+        if (!vmrFirst) {
+            LOG_INFO("[main] Windows ready first. Restored cached volume " + std::to_string(cachedVolume) + "%.");
+        }
     }
 
-    if (appConfig.listChannels.value) {
-        vmrManager.ListAllChannels();
+    if (!vmrReady.get()) {
+        LOG_ERROR(remote ? "[main] No state received from the remote Voicemeeter at " + appConfig.vbanHost.value + "."
+                         : std::string("[main] Failed to initialize and log in to Voicemeeter."));
+        vbanClient.Stop();
         vmrManager.Shutdown();
+        StateCache::Instance().Close();
         Logger::Instance().Shutdown();
-        return EXIT_SUCCESS;
+        return EXIT_FAILURE;
     }
+    startupTimer.Mark("voicemeeter init");
 
     if (!appConfig.toggleParam.value.empty()) {
         ToggleConfig toggleConfig;
@@ -202,12 +713,13 @@ int main(int argc, char* argv[]) {
             return EXIT_FAILURE;
         }
 
-        windowsManager->onDevicePluggedIn = [&vmrManager, &toggleConfig]() {
+        MixerCommands toggleCommands{vmrManager, mixer, remote};
+        windowsManager->onDevicePluggedIn = [toggleCommands, &toggleConfig]() {
             ChannelType channelType = (std::string(toggleConfig.type) == "input")
                                           ? ChannelType::Input
                                           : ChannelType::Output;
-            vmrManager.SetMute(toggleConfig.index1, channelType, false);
-            vmrManager.SetMute(toggleConfig.index2, channelType, true);
+            SetChannelMute(toggleCommands, toggleConfig.index1, channelType, false);
+            SetChannelMute(toggleCommands, toggleConfig.index2, channelType, true);
             LOG_INFO("[main] Applied toggle settings on startup: type=" +
                      std::to_string(static_cast<int>(toggleConfig.index1)) +
                      " unmuted, channel " +
@@ -215,34 +727,23 @@ int main(int argc, char* argv[]) {
                      " muted.");
         };
 
-        if (appConfig.listMonitor.value) {
-            windowsManager->ListMonitorableDevices();
-            vmrManager.Shutdown();
-            Logger::Instance().Shutdown();
-            return EXIT_SUCCESS;
-        }
-
         // Assign callbacks without using toggleMutex
-        windowsManager->onDevicePluggedIn = [&vmrManager, &toggleConfig]() {
+        windowsManager->onDevicePluggedIn = [toggleCommands, &toggleConfig]() {
             ChannelType channelType = (std::string(toggleConfig.type) == "input")
                                           ? ChannelType::Input
                                           : ChannelType::Output;
-            vmrManager.SetMute(toggleConfig.index1, channelType, false);
-            vmrManager.SetMute(toggleConfig.index2, channelType, true);
+            SetChannelMute(toggleCommands, toggleConfig.index1, channelType, false);
+            SetChannelMute(toggleCommands, toggleConfig.index2, channelType, true);
         };
 
-        windowsManager->onDeviceUnplugged = [&vmrManager, &toggleConfig]() {
+        windowsManager->onDeviceUnplugged = [toggleCommands, &toggleConfig]() {
             ChannelType channelType = (std::string(toggleConfig.type) == "input")
                                           ? ChannelType::Input
                                           : ChannelType::Output;
-            vmrManager.SetMute(toggleConfig.index1, channelType, true);
-            vmrManager.SetMute(toggleConfig.index2, channelType, false);
+            SetChannelMute(toggleCommands, toggleConfig.index1, channelType, true);
+            SetChannelMute(toggleCommands, toggleConfig.index2, channelType, false);
         };
 
-        uint8_t channelIndex = appConfig.index.value;
-        ChannelType channelType = (std::string(appConfig.type.value) == "input")
-                                      ? ChannelType::Input
-                                      : ChannelType::Output;
         int8_t minDbm = appConfig.minDbm.value;
         int8_t maxDbm = appConfig.maxDbm.value;
 
@@ -262,13 +763,134 @@ int main(int argc, char* argv[]) {
             VolumeMirror& mirror = VolumeMirror::Instance(
                 channelIndex,
                 channelType,
-                vmrManager,
+                mixer,
                 *windowsManager,
                 mirrorMode);
 
             mirror.Start();
+            startupTimer.Mark("mirror start");
+
+            // Remote states go to Windows; the mirror carries them on to Voicemeeter.
+            StateReplicator& replicator = StateReplicator::Instance();
+            if (appConfig.replicaPort.value > 0) {
+                WindowsManager* windows = windowsManager.get();
+                replicator.onRemoteVolume = [windows](float volumePercent, bool isMuted) {
+                    windows->SetVolume(volumePercent);
+                    windows->SetMute(isMuted);
+                };
+                const std::vector<std::string>& peers = appConfig.replicaPeers.value;
+                if (!replicator.Start(appConfig.replicaPort.value, peers, peers.empty() ? DEFAULT_REPLICA_GROUP : "")) {
+                    LOG_WARNING("[main] State replication could not be started.");
+                }
+            }
+            startupTimer.Mark("replication");
+
+            VoicemeeterMidiPort midiPort(vmrManager);
+            MidiController midi;
+            for (const std::string& text : appConfig.midiMappings.value) {
+                MidiMapping mapping;
+                if (MidiController::ParseMapping(text, mapping)) {
+                    midi.AddMapping(mapping);
+                }
+            }
+            if (remote && midi.MappingCount() > 0) {
+                LOG_WARNING("[main] MIDI mappings need the local Voicemeeter; ignored with --vban-host.");
+            } else if (midi.MappingCount() > 0 && !midi.Start(midiPort)) {
+                LOG_WARNING("[main] MIDI mapping could not be started.");
+            }
+            startupTimer.Mark("midi");
+
+            Win32KeySource keySource;
+            HotkeyContext hotkeyContext{{vmrManager, mixer, remote}, mirror, midi, LoadPresets(appConfig), appConfig.presetPaths.value};
+            HotkeyEngine hotkeys(keySource, [&hotkeyContext](const HotkeyAction& action) {
+                PerformHotkeyAction(hotkeyContext, action);
+            });
+            BindHotkeys(appConfig, hotkeys);
+            if (!hotkeys.Start()) {
+                LOG_WARNING("[main] No hotkeys could be registered.");
+            }
+            startupTimer.Mark("hotkeys");
+
+            MacroButtonWatcher macroButtons(vmrManager, [&hotkeyContext](const HotkeyAction& action, bool on) {
+                PerformMacroButtonAction(hotkeyContext, action, on);
+            });
+            for (const std::string& text : appConfig.macroButtonBindings.value) {
+                MacroButtonBinding binding;
+                if (MacroButtonWatcher::ParseBinding(text, binding)) {
+                    macroButtons.Bind(binding);
+                }
+            }
+            if (remote && macroButtons.BindingCount() > 0) {
+                LOG_WARNING("[main] MacroButtons bindings need the local Voicemeeter; ignored with --vban-host.");
+            } else if (macroButtons.BindingCount() > 0) {
+                macroButtons.Start();
+            }
+            startupTimer.Mark("macro buttons");
+
+            VoicemeeterDuckingPort duckingPort(vmrManager);
+            DuckingEngine ducking;
+            for (const std::string& text : appConfig.duckRules.value) {
+                DuckRule rule;
+                if (DuckingEngine::ParseRule(text, rule)) {
+                    if (rule.target.type == channelType && rule.target.index == channelIndex) {
+                        LOG_WARNING("[main] Ducking rule " + text + " lowers the mirrored channel; Windows volume will follow it.");
+                    }
+                    ducking.AddRule(rule);
+                }
+            }
+            if (remote && ducking.RuleCount() > 0) {
+                LOG_WARNING("[main] Ducking rules need the local Voicemeeter; ignored with --vban-host.");
+            } else if (ducking.RuleCount() > 0 && !ducking.Start(duckingPort)) {
+                LOG_WARNING("[main] Ducking could not be started.");
+            }
+            startupTimer.Mark("ducking");
+
+            BusRecorder recorder;
+            AudioInsert audioInsert;
+            if (appConfig.loudness.value) {
+                audioInsert.AddProcessor(LoudnessMeter::Instance(), true);
+            }
+            RecordTarget recordTarget;
+            if (!remote && BusRecorder::ParseTarget(appConfig.recordTarget.value, recordTarget) &&
+                recorder.Start(recordTarget, appConfig.recordDir.value)) {
+                audioInsert.AddProcessor(recorder);
+            }
+            bool audioInsertStarted = false;
+            if (remote && (audioInsert.ProcessorCount() > 0 || !appConfig.recordTarget.value.empty())) {
+                LOG_WARNING("[main] Loudness metering and recording need the local Voicemeeter; ignored with --vban-host.");
+            } else if (audioInsert.ProcessorCount() > 0) {
+                // Detect the kernel level here rather than on the first callback
+                LOG_INFO(std::string("[main] Audio kernels: ") + AudioKernels::LevelName(AudioKernels::Level()) + ".");
+                audioInsertStarted = vmrManager.StartAudioInsert(audioInsert);
+                if (!audioInsertStarted) {
+                    LOG_WARNING("[main] Audio insert could not be started.");
+                } else if (appConfig.loudness.value) {
+                    LoudnessMeter::RegisterMetrics();
+                }
+            }
+            startupTimer.Mark("audio insert");
+
+            VoicemeeterOscBackend oscBackend(mixer);
+            OscServer osc(oscBackend);
+            if (appConfig.oscPort.value > 0 && !osc.Start(appConfig.oscPort.value)) {
+                LOG_WARNING("[main] OSC server could not be started.");
+            }
+            startupTimer.Mark("osc");
+            startupTimer.Report();
             LOG_INFO("[main] Volume mirroring started.");
 
+            FootprintReporter::RegisterMetrics();
+            MetricsServer metricsServer;
+            if (appConfig.metricsPort.value > 0 && !metricsServer.Start(appConfig.metricsPort.value)) {
+                LOG_WARNING("[main] Metrics endpoint could not be started.");
+            }
+            if (appConfig.eventPort.value > 0 && !EventStream::Instance().Start(appConfig.eventPort.value)) {
+                LOG_WARNING("[main] Event stream could not be started.");
+            }
+            Footprint startupFootprint = FootprintReporter::Sample();
+            FootprintReporter::Log(startupFootprint);
+            FootprintReporter::CheckBudget(startupFootprint, appConfig.footprintBudgetMB.value);
+
             LOG_INFO("[main] VoiceMirror is running. Press Ctrl+C to exit.");
 
             std::thread quitThread;
@@ -315,11 +937,32 @@ int main(int argc, char* argv[]) {
                 appState.cv.wait(lock, [&appState] { return !appState.g_running.load(); });
             }
 
+            EventStream::Instance().Stop();
+            metricsServer.Stop();
+            osc.Stop();
+            if (audioInsertStarted) {
+                vmrManager.StopAudioInsert();
+            }
+            recorder.Stop();
+            ducking.Stop();
+            macroButtons.Stop();
+            hotkeys.Stop();
+            midi.Stop();
+            replicator.Stop();
             mirror.Stop();
             windowsManager.reset();
+            vbanClient.Stop();
             vmrManager.Shutdown();
+            StateCache::Instance().Close();
+            VolumeHistory::Instance().Close();
             LOG_INFO("[main] VoiceMirror has shut down gracefully.");
 
+            Footprint shutdownFootprint = FootprintReporter::Sample();
+            FootprintReporter::Log(shutdownFootprint);
+            FootprintReporter::CheckBudget(shutdownFootprint, appConfig.footprintBudgetMB.value);
+            LOG_DEBUG("[main] Metrics:\n" + MetricsRegistry::Instance().RenderText());
+            LockProfiler::Instance().Report();
+            AllocationTracker::Report();
             Logger::Instance().Shutdown();
 
             if (quitThread.joinable()) {
@@ -330,8 +973,11 @@ int main(int argc, char* argv[]) {
             LOG_ERROR("[main] An error occurred: " + std::string(ex.what()));
 
             // mirror.Stop();
+            StateReplicator::Instance().Stop();
             windowsManager.reset();
+            vbanClient.Stop();
             vmrManager.Shutdown();
+            StateCache::Instance().Close();
             Logger::Instance().Shutdown();
             return EXIT_FAILURE;
         }
@@ -0,0 +1,200 @@
+// AudioKernelsTest.cpp
+// Every SIMD level the CPU supports against the scalar kernels on awkward
+// lengths, clipping and rounding ties, then nanoseconds per sample of each.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AudioKernels.h"
+#include "Logger.h"
+
+namespace {
+constexpr size_t SAMPLES = 4096;
+constexpr uint32_t ITERATIONS = 2000;
+
+// Every length up to this one is checked, so each level's remainder loop runs.
+constexpr size_t TAIL_LENGTHS = 67;
+constexpr float RAMP_STEP = -1.0f / 4096.0f;
+constexpr float MIX_GAIN = 0.7071f;
+
+uint32_t NextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+/**
+ * Random samples up to +/-1.5, so conversions clip, with exact rounding ties
+ * (n + 0.5) / 32768 and the int16 extremes mixed in.
+ */
+std::vector<float> TestSignal(size_t count) {
+    std::vector<float> signal(count);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t random = NextRandom(state);
+        switch (random % 8) {
+        case 0:
+            signal[i] = (static_cast<float>(static_cast<int32_t>(random % 65536) - 32768) + 0.5f) / 32768.0f;
+            break;
+        case 1:
+            signal[i] = (random & 0x100) ? 1.0f : -1.0f;
+            break;
+        default:
+            signal[i] = (static_cast<float>(random) / 8388608.0f - 1.0f) * 1.5f;
+            break;
+        }
+    }
+    return signal;
+}
+
+bool SameBits(const float* a, const float* b, size_t count) {
+    return std::memcmp(a, b, count * sizeof(float)) == 0;
+}
+
+double RelativeError(double value, double reference) {
+    return reference == 0.0 ? std::fabs(value) : std::fabs(value - reference) / std::fabs(reference);
+}
+
+// Compares one level against the scalar kernels on every length up to TAIL_LENGTHS and the full buffer.
+uint32_t CheckLevel(const KernelTable& scalar, const KernelTable& kernels, const std::vector<float>& signal, const std::vector<int16_t>& pcm,
+                    const char* levelName) {
+    uint32_t failures = 0;
+    auto fail = [&](const char* kernel, size_t length) {
+        if (failures++ == 0) {
+            LOG_ERROR(std::string("[AudioKernelsTest] ") + levelName + " " + kernel +
+                      " differs from the scalar kernel at length " + std::to_string(length) + ".");
+        }
+    };
+
+    std::vector<float> expected(signal.size());
+    std::vector<float> actual(signal.size());
+    std::vector<int16_t> expectedPcm(signal.size());
+    std::vector<int16_t> actualPcm(signal.size());
+    std::vector<size_t> lengths;
+    for (size_t length = 0; length <= TAIL_LENGTHS; ++length) {
+        lengths.push_back(length);
+    }
+    lengths.push_back(signal.size() - 1);
+
+    for (size_t count : lengths) {
+        // Misaligned by one sample, so no level depends on aligned buffers.
+        const float* in = signal.data() + 1;
+
+        if (kernels.peakAbs(in, count) != scalar.peakAbs(in, count)) {
+            fail("peak", count);
+        }
+        if (RelativeError(kernels.sumSquares(in, count), scalar.sumSquares(in, count)) > 1e-12) {
+            fail("sum of squares", count);
+        }
+        // Terms of both signs may cancel, so the error is measured against the largest possible sum.
+        double dotBound = std::sqrt(scalar.sumSquares(in, count) * scalar.sumSquares(signal.data(), count));
+        if (std::fabs(kernels.dotProduct(in, signal.data(), count) - scalar.dotProduct(in, signal.data(), count)) >
+            1e-12 * dotBound) {
+            fail("dot product", count);
+        }
+
+        scalar.gainRamp(in, expected.data(), count, 1.0f, RAMP_STEP);
+        kernels.gainRamp(in, actual.data(), count, 1.0f, RAMP_STEP);
+        if (!SameBits(expected.data(), actual.data(), count)) {
+            fail("gain ramp", count);
+        }
+
+        std::copy(signal.begin(), signal.end(), expected.begin());
+        std::copy(signal.begin(), signal.end(), actual.begin());
+        scalar.mixAdd(in, expected.data(), count, MIX_GAIN);
+        kernels.mixAdd(in, actual.data(), count, MIX_GAIN);
+        if (!SameBits(expected.data(), actual.data(), count)) {
+            fail("mix-add", count);
+        }
+
+        scalar.floatToInt16(in, expectedPcm.data(), count);
+        kernels.floatToInt16(in, actualPcm.data(), count);
+        if (std::memcmp(expectedPcm.data(), actualPcm.data(), count * sizeof(int16_t)) != 0) {
+            fail("float to int16", count);
+        }
+
+        scalar.int16ToFloat(pcm.data() + 1, expected.data(), count);
+        kernels.int16ToFloat(pcm.data() + 1, actual.data(), count);
+        if (!SameBits(expected.data(), actual.data(), count)) {
+            fail("int16 to float", count);
+        }
+    }
+    return failures;
+}
+
+// Nanoseconds per sample of one kernel over the benchmark buffer
+template <typename Kernel>
+double TimeKernel(uint32_t iterations, size_t samples, Kernel kernel) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        kernel();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 1e9 * seconds / (static_cast<double>(iterations) * samples);
+}
+
+
+bool CompareAndTimeLevels(uint32_t iterations) {
+    LOG_INFO(std::string("[AudioKernelsTest] CPU supports ") + AudioKernels::LevelName(AudioKernels::Level()) + ".");
+
+    const KernelTable& scalar = *AudioKernels::Table(SimdLevel::Scalar);
+
+    // One spare sample, so checks and timings can run misaligned.
+    std::vector<float> signal = TestSignal(SAMPLES + 1);
+    std::vector<int16_t> pcm(signal.size());
+    scalar.floatToInt16(signal.data(), pcm.data(), pcm.size());
+    std::vector<float> out(signal.size());
+    std::vector<int16_t> pcmOut(signal.size());
+    const float* in = signal.data() + 1;
+    const size_t samples = SAMPLES;
+
+    uint32_t failures = 0;
+    double scalarNs[7] = {};
+    volatile double sink = 0.0;  // Keeps reductions from being optimized away
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        const KernelTable* kernels = AudioKernels::Table(level);
+        if (!kernels) {
+            LOG_INFO(std::string("[AudioKernelsTest] ") + AudioKernels::LevelName(level) + ": not supported, skipped.");
+            continue;
+        }
+        failures += level == SimdLevel::Scalar ? 0 : CheckLevel(scalar, *kernels, signal, pcm, AudioKernels::LevelName(level));
+
+        double ns[7] = {
+            TimeKernel(iterations, samples, [&]() { sink = sink + kernels->peakAbs(in, samples); }),
+            TimeKernel(iterations, samples, [&]() { sink = sink + kernels->sumSquares(in, samples); }),
+            TimeKernel(iterations, samples, [&]() { sink = sink + kernels->dotProduct(in, signal.data(), samples); }),
+            TimeKernel(iterations, samples, [&]() { kernels->gainRamp(in, out.data(), samples, 1.0f, RAMP_STEP); }),
+            TimeKernel(iterations, samples, [&]() { kernels->mixAdd(in, out.data(), samples, MIX_GAIN); }),
+            TimeKernel(iterations, samples, [&]() { kernels->floatToInt16(in, pcmOut.data(), samples); }),
+            TimeKernel(iterations, samples, [&]() { kernels->int16ToFloat(pcm.data() + 1, out.data(), samples); }),
+        };
+        if (level == SimdLevel::Scalar) {
+            std::copy(ns, ns + 7, scalarNs);
+        }
+        const char* names[7] = {"peak", "sum of squares", "dot product", "gain ramp", "mix-add", "float to int16",
+                                "int16 to float"};
+        std::string line = std::string("[AudioKernelsTest] ") + AudioKernels::LevelName(level) + " ns/sample:";
+        for (size_t k = 0; k < 7; ++k) {
+            line += std::string(k == 0 ? " " : ", ") + names[k] + " " + std::to_string(ns[k]) + " (x" +
+                    std::to_string(ns[k] > 0.0 ? scalarNs[k] / ns[k] : 0.0) + ")";
+        }
+        LOG_INFO(line + ".");
+    }
+
+    if (failures > 0) {
+        LOG_ERROR("[AudioKernelsTest] " + std::to_string(failures) + " kernel results differ from the scalar kernels.");
+        return false;
+    }
+    LOG_INFO(std::string("[AudioKernelsTest] Every supported level matches the scalar kernels. Using ") +
+             AudioKernels::LevelName(AudioKernels::Level()) + ".");
+    return true;
+}
+}  // namespace
+
+int main() {
+    return CompareAndTimeLevels(ITERATIONS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,60 @@
+// LockProfilerTest.cpp
+// LockProfiler's fixed table: names share an entry, and a full table says so
+// instead of quietly dropping locks.
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+#include "ProfiledMutex.h"
+
+namespace {
+uint32_t failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        LOG_ERROR("[LockProfilerTest] " + what);
+    }
+}
+
+void SameNameSharesEntry() {
+    LockProfiler& profiler = LockProfiler::Instance();
+    LockStats* first = profiler.Register("LockProfilerTest::shared");
+    LockStats* second = profiler.Register("LockProfilerTest::shared");
+    Check(first != nullptr && first == second, "Two registrations of one name got different entries.");
+}
+
+void FullTableIsCounted() {
+    LockProfiler& profiler = LockProfiler::Instance();
+    // Names must outlive the profiler, which keeps the pointers.
+    static std::vector<std::string> names;
+    names.reserve(LockProfiler::MAX_LOCKS + 2);
+
+    size_t registered = 0;
+    while (names.size() < LockProfiler::MAX_LOCKS + 2) {
+        names.push_back("LockProfilerTest::filler" + std::to_string(names.size()));
+        if (profiler.Register(names.back().c_str()) != nullptr) {
+            ++registered;
+        }
+    }
+    Check(registered < names.size(), "More locks were registered than the table holds.");
+    Check(profiler.Unprofiled() == names.size() - registered,
+          std::to_string(profiler.Unprofiled()) + " registrations were counted as dropped, not " +
+              std::to_string(names.size() - registered) + ".");
+    Check(profiler.Register("LockProfilerTest::shared") != nullptr,
+          "A name registered before the table filled lost its entry.");
+}
+}  // namespace
+
+int main() {
+    SameNameSharesEntry();
+    FullTableIsCounted();
+
+    if (failures > 0) {
+        LOG_ERROR("[LockProfilerTest] " + std::to_string(failures) + " checks failed.");
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[LockProfilerTest] All checks passed.");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,410 @@
+// LoudnessMeterTest.cpp
+// EBU Tech 3341 loudness cases, generated and from the EBU reference files,
+// and the cost of metering every bus.
+//
+// Usage: LoudnessMeterTest [directory with the EBU loudness test set]
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LoudnessMeter.h"
+#include "Logger.h"
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+constexpr unsigned int MXCSR_FTZ_DAZ = 0x8040;
+
+// A Potato stream as Voicemeeter usually runs it
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint32_t FRAMES = 512;
+
+// Tech 3341 (V4) signals, a 1 kHz sine at the given level per segment
+constexpr double TONE_HZ = 1000.0;
+constexpr float TOLERANCE_LU = 0.1f;
+constexpr float SILENT = -1000.0f;
+constexpr size_t MAX_SEGMENTS = 5;
+constexpr float TIMING_SECONDS = 30.0f;
+constexpr float TIMING_LEVEL_DBFS = -23.0f;
+
+struct Segment {
+    float dbfs;
+    float seconds;
+};
+
+struct SyntheticCase {
+    const char* name;
+    Segment segments[MAX_SEGMENTS];
+    size_t segmentCount;
+    const float* channelDb;  ///< Added to the segment level per bus channel; SILENT for none
+    float expectedLufs;
+    bool steady;  ///< Momentary and short-term must match too
+};
+
+constexpr float STEREO[AUDIO_CHANNELS_PER_BUS] = {0.0f, 0.0f, SILENT, SILENT, SILENT, SILENT, SILENT, SILENT};
+// L and R at -28 dBFS, C at -24 dBFS, Ls and Rs at -30 dBFS
+constexpr float SURROUND_5_0[AUDIO_CHANNELS_PER_BUS] = {-28.0f, -28.0f, -24.0f, SILENT, -30.0f, -30.0f, SILENT, SILENT};
+
+const SyntheticCase SYNTHETIC_CASES[] = {
+    {"Tech 3341 #1: stereo -23 dBFS", {{-23.0f, 20.0f}}, 1, STEREO, -23.0f, true},
+    {"Tech 3341 #2: stereo -33 dBFS", {{-33.0f, 20.0f}}, 1, STEREO, -33.0f, true},
+    {"Tech 3341 #3: -36/-23/-36 dBFS", {{-36.0f, 10.0f}, {-23.0f, 60.0f}, {-36.0f, 10.0f}}, 3, STEREO, -23.0f, false},
+    {"Tech 3341 #4: -72/-36/-23/-36/-72 dBFS",
+     {{-72.0f, 10.0f}, {-36.0f, 10.0f}, {-23.0f, 60.0f}, {-36.0f, 10.0f}, {-72.0f, 10.0f}}, 5, STEREO, -23.0f, false},
+    {"Tech 3341 #5: -26/-20/-26 dBFS", {{-26.0f, 20.0f}, {-20.0f, 20.1f}, {-26.0f, 20.0f}}, 3, STEREO, -23.0f, false},
+    {"Tech 3341 #6: 5.0 channels", {{0.0f, 20.0f}}, 1, SURROUND_5_0, -23.0f, false},
+};
+
+// The EBU loudness test set, Tech 3341 cases 1-8. Tech 3342 shares cases 7
+// and 8 but checks loudness range, which the meter does not measure.
+struct ReferenceCase {
+    const char* file;
+    float expectedLufs;
+    bool steady;  ///< Momentary and short-term must match too
+};
+
+const ReferenceCase REFERENCE_CASES[] = {
+    {"seq-3341-1-16bit.wav", -23.0f, true},
+    {"seq-3341-2-16bit.wav", -33.0f, true},
+    {"seq-3341-3-16bit-v02.wav", -23.0f, false},
+    {"seq-3341-4-16bit-v02.wav", -23.0f, false},
+    {"seq-3341-5-16bit-v02.wav", -23.0f, false},
+    {"seq-3341-6-5channels-16bit.wav", -23.0f, false},
+    {"seq-3341-6-6channels-WAVEEX-16bit.wav", -23.0f, false},
+    {"seq-3341-7_seq-3342-5-24bit.wav", -23.0f, false},
+    {"seq-3341-2011-8_seq-3342-6-24bit-v02.wav", -23.0f, false},
+};
+
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// WAVE_FORMAT_EXTENSIBLE speaker bits in 7.1 bus order
+constexpr uint32_t SPEAKER_BITS[AUDIO_CHANNELS_PER_BUS] = {0x1, 0x2, 0x4, 0x8, 0x200, 0x400, 0x10, 0x20};
+// Bus channel of each file channel when there is no speaker mask, by channel count
+constexpr int DEFAULT_LAYOUTS[7][6] = {
+    {},
+    {0},
+    {0, 1},
+    {0, 1, 2},
+    {0, 1, 4, 5},
+    {0, 1, 2, 4, 5},        // L R C Ls Rs
+    {0, 1, 2, 3, 4, 5},     // L R C LFE Ls Rs
+};
+
+float Amplitude(float db) {
+    return db <= SILENT ? 0.0f : static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+uint32_t ReadLe(const uint8_t* bytes, size_t size) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief A PCM (16, 24 or 32 bit) or float WAV file, read whole.
+ */
+struct WavFile {
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    uint16_t bits = 0;
+    bool isFloat = false;
+    uint32_t channelMask = 0;  ///< 0 if the file has none
+    std::vector<uint8_t> data;
+
+    size_t FrameBytes() const { return static_cast<size_t>(channels) * (bits / 8); }
+    size_t Frames() const { return data.size() / FrameBytes(); }
+
+    float Sample(size_t frame, size_t channel) const {
+        const uint8_t* bytes = &data[frame * FrameBytes() + channel * (bits / 8)];
+        if (isFloat) {
+            float value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+        // Shift the sample to the top of an int32 so the sign comes along.
+        int32_t value = static_cast<int32_t>(ReadLe(bytes, bits / 8) << (32 - bits));
+        return static_cast<float>(value / 2147483648.0);
+    }
+
+    /**
+     * @return Bus channel of a file channel in 7.1 order, -1 for none.
+     */
+    int BusChannel(size_t channel) const {
+        if (channelMask == 0) {
+            return channels < 7 && channel < channels ? DEFAULT_LAYOUTS[channels][channel] : -1;
+        }
+        // The n-th set bit of the mask is the speaker of channel n.
+        size_t n = 0;
+        for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+            if ((channelMask & bit) == 0) {
+                continue;
+            }
+            if (n++ == channel) {
+                for (size_t c = 0; c < AUDIO_CHANNELS_PER_BUS; ++c) {
+                    if (SPEAKER_BITS[c] == bit) {
+                        return static_cast<int>(c);
+                    }
+                }
+                return -1;
+            }
+        }
+        return -1;
+    }
+};
+
+bool ReadWav(const std::string& path, WavFile& wav) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("[LoudnessMeterTest] Failed to open " + path + ".");
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(&bytes[8], "WAVE", 4) != 0) {
+        LOG_ERROR("[LoudnessMeterTest] " + path + " is not a WAV file.");
+        return false;
+    }
+
+    bool haveFormat = false;
+    for (size_t offset = 12; offset + 8 <= bytes.size();) {
+        const uint8_t* chunk = &bytes[offset];
+        size_t size = (std::min)(static_cast<size_t>(ReadLe(chunk + 4, 4)), bytes.size() - offset - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t tag = static_cast<uint16_t>(ReadLe(chunk + 8, 2));
+            wav.channels = static_cast<uint16_t>(ReadLe(chunk + 10, 2));
+            wav.sampleRate = ReadLe(chunk + 12, 4);
+            wav.bits = static_cast<uint16_t>(ReadLe(chunk + 22, 2));
+            if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 40) {
+                wav.channelMask = ReadLe(chunk + 28, 4);
+                tag = static_cast<uint16_t>(ReadLe(chunk + 32, 2));  // First two bytes of the subformat GUID
+            }
+            wav.isFloat = tag == WAVE_FORMAT_IEEE_FLOAT;
+            haveFormat = (tag == WAVE_FORMAT_PCM && (wav.bits == 16 || wav.bits == 24 || wav.bits == 32)) ||
+                         (wav.isFloat && wav.bits == 32);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            wav.data.assign(chunk + 8, chunk + 8 + size);
+        }
+        offset += 8 + size + (size & 1);
+    }
+
+    if (!haveFormat || wav.channels == 0 || wav.sampleRate == 0 || wav.data.empty()) {
+        LOG_ERROR("[LoudnessMeterTest] " + path + " is not 16, 24 or 32-bit PCM or float audio.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Feeds a meter the way AudioInsert does: every bus channel of a
+ * Potato stream, one buffer at a time, with denormals flushed.
+ */
+class TestStream {
+public:
+    explicit TestStream(LoudnessMeter& meter, uint32_t sampleRate = SAMPLE_RATE)
+        : meter_(meter), samples_(AUDIO_MAX_BUS_CHANNELS * FRAMES) {
+        for (size_t c = 0; c < AUDIO_MAX_BUS_CHANNELS; ++c) {
+            channels_[c] = &samples_[c * FRAMES];
+        }
+        block_.sampleRate = sampleRate;
+        block_.frames = FRAMES;
+        block_.outputCount = static_cast<uint32_t>(AUDIO_MAX_BUS_CHANNELS);
+        block_.outputs = channels_;
+        meter_.Prepare(sampleRate, FRAMES);
+    }
+
+    float* Channel(size_t channel) { return channels_[channel]; }
+
+    /**
+     * @brief Meters the first @p frames frames of the current buffer.
+     * @return Microseconds spent in the meter.
+     */
+    double Run(uint32_t frames = FRAMES) {
+        block_.frames = frames;
+        unsigned int csr = _mm_getcsr();
+        _mm_setcsr(csr | MXCSR_FTZ_DAZ);
+        auto start = std::chrono::steady_clock::now();
+        meter_.Process(block_);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        _mm_setcsr(csr);
+        return micros;
+    }
+
+private:
+    LoudnessMeter& meter_;
+    std::vector<float> samples_;
+    float* channels_[AUDIO_MAX_BUS_CHANNELS] = {};
+    AudioBlock block_;
+};
+
+bool CheckReading(LoudnessMeter& meter, const std::string& name, float expected, bool steady) {
+    LoudnessReading reading;
+    if (!meter.Read(reading)) {
+        LOG_ERROR("[LoudnessMeterTest] " + name + ": no reading.");
+        return false;
+    }
+    bool correct = std::fabs(reading.integratedLufs[0] - expected) <= TOLERANCE_LU;
+    if (steady) {
+        correct = correct && std::fabs(reading.momentaryLufs[0] - expected) <= TOLERANCE_LU &&
+                  std::fabs(reading.shortTermLufs[0] - expected) <= TOLERANCE_LU;
+    }
+
+    std::string message = "[LoudnessMeterTest] " + name + ": M " + std::to_string(reading.momentaryLufs[0]) + ", S " +
+                          std::to_string(reading.shortTermLufs[0]) + ", I " +
+                          std::to_string(reading.integratedLufs[0]) + " LUFS, expected " + std::to_string(expected) +
+                          (steady ? " for all three." : " integrated.");
+    if (correct) {
+        LOG_INFO(message);
+    } else {
+        LOG_ERROR(message);
+    }
+    return correct;
+}
+
+// Plays one case into bus 0 and reads bus 0 back.
+bool RunSyntheticCase(const SyntheticCase& testCase) {
+    auto meter = std::make_unique<LoudnessMeter>();
+    TestStream stream(*meter);
+
+    std::vector<uint64_t> segmentEnds;
+    uint64_t total = 0;
+    for (size_t s = 0; s < testCase.segmentCount; ++s) {
+        total += static_cast<uint64_t>(std::llround(testCase.segments[s].seconds * SAMPLE_RATE));
+        segmentEnds.push_back(total);
+    }
+
+    size_t segment = 0;
+    for (uint64_t played = 0; played < total; played += FRAMES) {
+        for (uint32_t i = 0; i < FRAMES; ++i) {
+            uint64_t n = played + i;
+            while (segment + 1 < testCase.segmentCount && n >= segmentEnds[segment]) {
+                ++segment;
+            }
+            float tone = n < total ? static_cast<float>(std::sin(2.0 * PI * TONE_HZ * static_cast<double>(n) / SAMPLE_RATE))
+                                   : 0.0f;
+            for (size_t c = 0; c < AUDIO_CHANNELS_PER_BUS; ++c) {
+                stream.Channel(c)[i] = tone * Amplitude(testCase.segments[segment].dbfs + testCase.channelDb[c]);
+            }
+        }
+        stream.Run();
+    }
+    return CheckReading(*meter, testCase.name, testCase.expectedLufs, testCase.steady);
+}
+
+// Plays one reference file into bus 0, its channels placed by speaker, and reads bus 0 back.
+bool RunReferenceCase(const std::string& directory, const ReferenceCase& testCase) {
+    WavFile wav;
+    if (!ReadWav(directory + "/" + testCase.file, wav)) {
+        return false;
+    }
+
+    auto meter = std::make_unique<LoudnessMeter>();
+    TestStream stream(*meter, wav.sampleRate);
+    size_t total = wav.Frames();
+    for (size_t played = 0; played < total; played += FRAMES) {
+        // The last buffer is cut short rather than padded, so the final momentary reading is the file's.
+        uint32_t frames = static_cast<uint32_t>((std::min)(total - played, static_cast<size_t>(FRAMES)));
+        for (size_t channel = 0; channel < wav.channels; ++channel) {
+            int busChannel = wav.BusChannel(channel);
+            if (busChannel < 0) {
+                continue;
+            }
+            for (uint32_t i = 0; i < frames; ++i) {
+                stream.Channel(static_cast<size_t>(busChannel))[i] = wav.Sample(played + i, channel);
+            }
+        }
+        stream.Run(frames);
+    }
+    return CheckReading(*meter, testCase.file, testCase.expectedLufs, testCase.steady);
+}
+
+// Every bus metered, each carrying the stereo test tone, timed against the buffer period.
+bool TimeAllBuses() {
+    auto meter = std::make_unique<LoudnessMeter>();
+    TestStream stream(*meter);
+    float amplitude = Amplitude(TIMING_LEVEL_DBFS);
+
+    uint64_t buffers = static_cast<uint64_t>(TIMING_SECONDS * SAMPLE_RATE) / FRAMES;
+    std::vector<double> micros;
+    micros.reserve(static_cast<size_t>(buffers));
+    for (uint64_t b = 0; b < buffers; ++b) {
+        for (uint32_t i = 0; i < FRAMES; ++i) {
+            double n = static_cast<double>(b * FRAMES + i);
+            float tone = amplitude * static_cast<float>(std::sin(2.0 * PI * TONE_HZ * n / SAMPLE_RATE));
+            for (size_t c = 0; c < AUDIO_MAX_BUS_CHANNELS; ++c) {
+                stream.Channel(c)[i] = (c % AUDIO_CHANNELS_PER_BUS) < 2 ? tone : 0.0f;
+            }
+        }
+        micros.push_back(stream.Run());
+    }
+
+    LoudnessReading reading;
+    bool haveReading = meter->Read(reading);
+    uint32_t wrongBuses = 0;
+    for (uint32_t bus = 0; haveReading && bus < reading.busCount; ++bus) {
+        if (std::fabs(reading.momentaryLufs[bus] - TIMING_LEVEL_DBFS) > TOLERANCE_LU ||
+            std::fabs(reading.integratedLufs[bus] - TIMING_LEVEL_DBFS) > TOLERANCE_LU) {
+            ++wrongBuses;
+        }
+    }
+
+    std::sort(micros.begin(), micros.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    double budgetMicros = 1e6 * FRAMES / SAMPLE_RATE;
+    LOG_INFO("[LoudnessMeterTest] " + std::to_string(AUDIO_MAX_BUS_CHANNELS) + " bus channels metered, " +
+             std::to_string(micros.size()) + " buffers of " + std::to_string(FRAMES) + " frames at " +
+             std::to_string(SAMPLE_RATE) + " Hz. Process p50: " + std::to_string(at(micros, 0.5)) + " us, p99: " +
+             std::to_string(at(micros, 0.99)) + " us, max: " + std::to_string(at(micros, 1.0)) + " us, budget " +
+             std::to_string(budgetMicros) + " us.");
+
+    bool correct = haveReading && reading.busCount == AUDIO_MAX_BUSES && wrongBuses == 0 && at(micros, 0.99) < budgetMicros;
+    if (!correct) {
+        LOG_ERROR("[LoudnessMeterTest] " + std::to_string(wrongBuses) + " buses misread in the timing run" +
+                  (at(micros, 0.99) < budgetMicros ? "." : ", p99 over the buffer deadline."));
+    }
+    return correct;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t failed = 0;
+    for (const SyntheticCase& testCase : SYNTHETIC_CASES) {
+        if (!RunSyntheticCase(testCase)) {
+            ++failed;
+        }
+    }
+
+    // The reference files are not redistributable; they are checked when given.
+    if (argc > 1 && argv[1][0] != '\0') {
+        for (const ReferenceCase& testCase : REFERENCE_CASES) {
+            if (!RunReferenceCase(argv[1], testCase)) {
+                ++failed;
+            }
+        }
+    } else {
+        LOG_INFO("[LoudnessMeterTest] No EBU loudness test set given, reference files skipped.");
+    }
+    if (!TimeAllBuses()) {
+        ++failed;
+    }
+
+    if (failed > 0) {
+        LOG_ERROR("[LoudnessMeterTest] " + std::to_string(failed) + " checks failed.");
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[LoudnessMeterTest] All checks passed.");
+    return EXIT_SUCCESS;
+}
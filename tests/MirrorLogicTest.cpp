@@ -0,0 +1,108 @@
+// MirrorLogicTest.cpp
+// Echo suppression, Voicemeeter debounce and generations of MirrorLogic.
+#include <cstdlib>
+#include <string>
+
+#include "Logger.h"
+#include "MirrorState.h"
+
+namespace {
+using MirrorLogic::Action;
+using MirrorLogic::State;
+
+uint32_t failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        LOG_ERROR("[MirrorLogicTest] " + what);
+    }
+}
+
+bool Is(const Action& action, Action::Kind kind, float volume, bool mute) {
+    return action.kind == kind && VolumeUtils::IsFloatEqual(action.volume, volume) && action.mute == mute;
+}
+
+void WindowsChangeReachesVoicemeeterOnce() {
+    State state;
+    Action action = MirrorLogic::ApplyWindowsSample(state, 0.5f, false);
+    Check(Is(action, Action::Kind::UpdateVoicemeeter, 0.5f, false), "A Windows change was not pushed to Voicemeeter.");
+    Check(!action.playSyncSound, "A Windows change played the sync sound.");
+
+    Check(MirrorLogic::ApplyWindowsSample(state, 0.5f, false).kind == Action::Kind::None,
+          "A repeated Windows sample was pushed again.");
+    // The echo of our own write, seen twice so it would pass the debounce
+    Check(MirrorLogic::ApplyVoicemeeterSample(state, 0.5f, false).kind == Action::Kind::None &&
+              MirrorLogic::ApplyVoicemeeterSample(state, 0.5f, false).kind == Action::Kind::None,
+          "The Voicemeeter echo of a Windows change was mirrored back.");
+}
+
+void VoicemeeterChangeNeedsTwoPolls() {
+    State state;
+    Check(MirrorLogic::ApplyVoicemeeterSample(state, 0.3f, true).kind == Action::Kind::None,
+          "A Voicemeeter change was mirrored after one poll.");
+    Action action = MirrorLogic::ApplyVoicemeeterSample(state, 0.3f, true);
+    Check(Is(action, Action::Kind::UpdateWindows, 0.3f, true), "A Voicemeeter change seen twice was not mirrored.");
+    Check(action.playSyncSound, "A Voicemeeter change did not play the sync sound.");
+    Check(MirrorLogic::ApplyWindowsSample(state, 0.3f, true).kind == Action::Kind::None,
+          "The Windows echo of a Voicemeeter change was mirrored back.");
+
+    // A value that changes between polls is still moving and must restart the debounce.
+    MirrorLogic::ApplyVoicemeeterSample(state, 0.6f, true);
+    Check(MirrorLogic::ApplyVoicemeeterSample(state, 0.7f, true).kind == Action::Kind::None,
+          "A Voicemeeter value still moving was mirrored.");
+    Check(Is(MirrorLogic::ApplyVoicemeeterSample(state, 0.7f, true), Action::Kind::UpdateWindows, 0.7f, true),
+          "A Voicemeeter value that settled was not mirrored.");
+
+    // A change that reverts before the second poll is dropped.
+    MirrorLogic::ApplyVoicemeeterSample(state, 0.1f, true);
+    MirrorLogic::ApplyVoicemeeterSample(state, 0.7f, true);
+    Check(MirrorLogic::ApplyVoicemeeterSample(state, 0.1f, true).kind == Action::Kind::None,
+          "A reverted Voicemeeter change was mirrored.");
+}
+
+void WindowsWinsOverPendingVoicemeeterChange() {
+    State state;
+    MirrorLogic::ApplyVoicemeeterSample(state, 0.2f, false);
+    Check(Is(MirrorLogic::ApplyWindowsSample(state, 0.9f, false), Action::Kind::UpdateVoicemeeter, 0.9f, false),
+          "A Windows change was lost to a pending Voicemeeter change.");
+    Check(MirrorLogic::ApplyVoicemeeterSample(state, 0.2f, false).kind == Action::Kind::None,
+          "A Voicemeeter change overridden by Windows was still mirrored.");
+}
+
+void RoundsToHundredths() {
+    State state;
+    MirrorLogic::ApplyWindowsSample(state, 0.501f, false);
+    Check(MirrorLogic::ApplyWindowsSample(state, 0.499f, false).kind == Action::Kind::None,
+          "Volumes within rounding were treated as a change.");
+}
+
+void GenerationsIncrease() {
+    State state;
+    uint64_t first = MirrorLogic::ApplyWindowsSample(state, 0.4f, false).generation;
+    MirrorLogic::ApplyVoicemeeterSample(state, 0.8f, false);
+    uint64_t second = MirrorLogic::ApplyVoicemeeterSample(state, 0.8f, false).generation;
+    Action resync = MirrorLogic::ForceResync(state, 0.8f, false);
+    Check(first > 0 && second > first && resync.generation > second && state.generation == resync.generation,
+          "Action generations do not increase with every accepted change.");
+    Check(Is(resync, Action::Kind::UpdateVoicemeeter, 0.8f, false),
+          "A forced resync did not push Windows to Voicemeeter.");
+    Check(MirrorLogic::ApplyWindowsSample(state, 0.8f, false).kind == Action::Kind::None,
+          "A Windows sample equal to the resynced state was pushed again.");
+}
+}  // namespace
+
+int main() {
+    WindowsChangeReachesVoicemeeterOnce();
+    VoicemeeterChangeNeedsTwoPolls();
+    WindowsWinsOverPendingVoicemeeterChange();
+    RoundsToHundredths();
+    GenerationsIncrease();
+
+    if (failures > 0) {
+        LOG_ERROR("[MirrorLogicTest] " + std::to_string(failures) + " checks failed.");
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[MirrorLogicTest] All checks passed.");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+// SceneLogicTest.cpp
+// Recall scripts between two Potato scenes: every recall must end on the
+// target scene without growing the reserved script. Labels must survive the
+// script whatever they contain.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+#include "Scene.h"
+
+namespace {
+constexpr uint32_t RECALLS = 10000;
+
+bool RecallsReachTarget() {
+    using Clock = std::chrono::steady_clock;
+
+    const Scene scenes[2] = {SceneLogic::MakeSimulatedScene(0.0f, false), SceneLogic::MakeSimulatedScene(-12.0f, true)};
+    Scene mixer = scenes[0];
+    std::string script;
+    script.reserve(SCENE_RECALL_SCRIPT_RESERVE);
+    const size_t reserved = script.capacity();
+
+    std::vector<double> recallMicros;
+    recallMicros.reserve(RECALLS);
+    size_t parameters = 0;
+    uint32_t mismatches = 0;
+    Clock::time_point start = Clock::now();
+    for (uint32_t n = 0; n < RECALLS; ++n) {
+        const Scene& target = scenes[(n + 1) % 2];
+
+        Clock::time_point before = Clock::now();
+        Scene current = mixer;
+        script.clear();
+        parameters += SceneLogic::BuildRecallScript(current, target, script);
+        SceneLogic::ApplyScript(mixer, script);
+        recallMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+
+        std::string remaining;
+        if (SceneLogic::BuildRecallScript(mixer, target, remaining) != 0) {
+            ++mismatches;
+        }
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::sort(recallMicros.begin(), recallMicros.end());
+    auto at = [](const auto& sorted, double p) {
+        return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    };
+    LOG_INFO("[SceneLogicTest] " + std::to_string(RECALLS) + " Potato recalls of " +
+             std::to_string(parameters / RECALLS) + " parameters in " + std::to_string(elapsedMs) +
+             " ms, script " + std::to_string(script.size()) + " of " + std::to_string(reserved) +
+             " reserved bytes. Recall p50: " + std::to_string(at(recallMicros, 0.5)) + " us, p99: " +
+             std::to_string(at(recallMicros, 0.99)) + " us, max: " + std::to_string(at(recallMicros, 1.0)) + " us.");
+
+    bool correct = mismatches == 0 && script.capacity() == reserved;
+    if (!correct) {
+        LOG_ERROR("[SceneLogicTest] " + std::to_string(mismatches) + " recalls did not end on the scene; script capacity " +
+                  std::to_string(script.capacity()) + " bytes against " + std::to_string(reserved) + " reserved.");
+    }
+    return correct;
+}
+
+// Quotes and semicolons must not end a label statement early.
+bool LabelsCannotEndStatements() {
+    Scene current = SceneLogic::MakeSimulatedScene(0.0f, false);
+    Scene target = current;
+    const char* hostile = "Mic \"A\"; Strip[1].Mute=1";
+    SceneLogic::CopyLabel(target.strips[0].label, hostile, std::strlen(hostile));
+    // Written straight into the snapshot, as a hand-edited scene file could be
+    std::memcpy(target.strips[2].label, "x\";y", 5);
+    target.strips[3].gainDb = -7.0f;
+
+    std::string script;
+    SceneLogic::BuildRecallScript(current, target, script);
+    Scene mixer = current;
+    SceneLogic::ApplyScript(mixer, script);
+
+    bool correct = std::strcmp(mixer.strips[0].label, "Mic 'A', Strip[1].Mute=1") == 0 &&
+                   std::strcmp(mixer.strips[2].label, "x',y") == 0 && mixer.strips[1].mute == current.strips[1].mute &&
+                   mixer.strips[3].gainDb == -7.0f;
+
+    // A quoted semicolon from elsewhere must not split the statement either; the
+    // label is then stored like any captured label.
+    SceneLogic::ApplyScript(mixer, "Strip[4].Label=\"a;b\";Strip[4].Gain=-3.00;");
+    correct = correct && std::strcmp(mixer.strips[4].label, "a,b") == 0 && mixer.strips[4].gainDb == -3.0f;
+
+    if (!correct) {
+        LOG_ERROR("[SceneLogicTest] A label with quotes or semicolons broke the recall script: " + script);
+    }
+    return correct;
+}
+
+// Long labels are cut before a multi-byte character, never inside it.
+bool LongLabelsKeepWholeCharacters() {
+    std::string umlauts;
+    for (int i = 0; i < 20; ++i) {
+        umlauts += "\xC3\xA4";  // a with diaeresis, two bytes
+    }
+    char label[SCENE_LABEL_LENGTH];
+    SceneLogic::CopyLabel(label, umlauts.c_str(), umlauts.size());
+    bool correct = std::strlen(label) == 30 && umlauts.compare(0, 30, label) == 0;
+
+    // 30 ASCII bytes, then a three-byte character that does not fit
+    std::string mixed = std::string(30, 'a') + "\xE2\x82\xAC";
+    SceneLogic::CopyLabel(label, mixed.c_str(), mixed.size());
+    correct = correct && std::strlen(label) == 30;
+
+    // A label that fits is kept whole.
+    SceneLogic::CopyLabel(label, mixed.c_str(), 29);
+    correct = correct && std::strlen(label) == 29;
+
+    if (!correct) {
+        LOG_ERROR("[SceneLogicTest] A long label was not cut at a character boundary.");
+    }
+    return correct;
+}
+}  // namespace
+
+int main() {
+    bool passed = RecallsReachTarget();
+    passed = LabelsCannotEndStatements() && passed;
+    passed = LongLabelsKeepWholeCharacters() && passed;
+    if (!passed) {
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[SceneLogicTest] All checks passed.");
+    return EXIT_SUCCESS;
+}
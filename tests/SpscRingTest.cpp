@@ -0,0 +1,132 @@
+// SpscRingTest.cpp
+// The ring between BusRecorder's audio callback and its writer thread.
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "Logger.h"
+#include "SpscRing.h"
+
+namespace {
+// Whole buffers are committed or dropped, as BusRecorder does with audio buffers.
+constexpr size_t RING_CAPACITY = 1000;  // Rounded up to 1024
+constexpr size_t BUFFER_ELEMENTS = 96;
+constexpr uint64_t STRESS_BUFFERS = 200000;
+
+uint32_t failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        LOG_ERROR("[SpscRingTest] " + what);
+    }
+}
+
+void WrapsAndSplitsRuns() {
+    SpscRing<uint32_t> ring(RING_CAPACITY);
+    Check(ring.Capacity() == 1024, "Capacity was not rounded up to a power of two.");
+    Check(ring.Free() == 1024 && ring.Available() == 0, "A new ring is not empty.");
+
+    // Move both positions close to the end of the storage.
+    ring.Commit(1000);
+    ring.Release(1000);
+
+    size_t start = ring.WritePosition();
+    for (size_t i = 0; i < 100; ++i) {
+        ring.At(start + i) = static_cast<uint32_t>(i);
+    }
+    ring.Commit(100);
+    Check(ring.Available() == 100 && ring.Free() == 924, "Counts are wrong after a commit.");
+
+    size_t count = 0;
+    const uint32_t* run = ring.Contiguous(count);
+    Check(count == 24, "The first run did not stop at the end of the storage.");
+    bool inOrder = count == 24;
+    for (size_t i = 0; inOrder && i < count; ++i) {
+        inOrder = run[i] == i;
+    }
+    ring.Release(count);
+
+    run = ring.Contiguous(count);
+    Check(count == 76 && run == &ring.At(0), "The second run did not start at the beginning of the storage.");
+    for (size_t i = 0; inOrder && i < count; ++i) {
+        inOrder = run[i] == 24 + i;
+    }
+    ring.Release(count);
+    Check(inOrder, "Elements came out of the ring out of order.");
+    Check(ring.Available() == 0 && ring.Contiguous(count) && count == 0, "The ring is not empty after reading everything.");
+}
+
+void TwoThreadsKeepWholeBuffers() {
+    SpscRing<uint64_t> ring(RING_CAPACITY);
+    uint64_t dropped = 0;
+    uint64_t received = 0;
+    uint64_t torn = 0;
+
+    std::thread consumer([&]() {
+        uint64_t expected = 0;
+        while (true) {
+            size_t count = 0;
+            const uint64_t* run = ring.Contiguous(count);
+            if (count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                // Each element is its buffer number and index; a buffer may be skipped but not cut.
+                uint64_t value = run[i];
+                if (value == UINT64_MAX) {
+                    ring.Release(i + 1);
+                    return;
+                }
+                uint64_t index = value % BUFFER_ELEMENTS;
+                if (index != expected % BUFFER_ELEMENTS || value < expected) {
+                    ++torn;
+                }
+                expected = value + 1;
+                ++received;
+            }
+            ring.Release(count);
+        }
+    });
+
+    for (uint64_t buffer = 0; buffer < STRESS_BUFFERS; ++buffer) {
+        if (ring.Free() < BUFFER_ELEMENTS) {
+            // Give the consumer a chance, as the audio thread does between buffers.
+            ++dropped;
+            std::this_thread::yield();
+            continue;
+        }
+        size_t position = ring.WritePosition();
+        for (size_t i = 0; i < BUFFER_ELEMENTS; ++i) {
+            ring.At(position + i) = buffer * BUFFER_ELEMENTS + i;
+        }
+        ring.Commit(BUFFER_ELEMENTS);
+    }
+    while (ring.Free() == 0) {
+        std::this_thread::yield();
+    }
+    ring.At(ring.WritePosition()) = UINT64_MAX;
+    ring.Commit(1);
+    consumer.join();
+
+    LOG_INFO("[SpscRingTest] " + std::to_string(STRESS_BUFFERS) + " buffers of " + std::to_string(BUFFER_ELEMENTS) +
+             " elements, " + std::to_string(dropped) + " dropped while the consumer was behind.");
+    Check(torn == 0, std::to_string(torn) + " elements arrived out of order or from a partly written buffer.");
+    Check(received == (STRESS_BUFFERS - dropped) * BUFFER_ELEMENTS,
+          "The consumer received " + std::to_string(received) + " elements, not every committed buffer.");
+}
+}  // namespace
+
+int main() {
+    WrapsAndSplitsRuns();
+    TwoThreadsKeepWholeBuffers();
+
+    if (failures > 0) {
+        LOG_ERROR("[SpscRingTest] " + std::to_string(failures) + " checks failed.");
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[SpscRingTest] All checks passed.");
+    return EXIT_SUCCESS;
+}